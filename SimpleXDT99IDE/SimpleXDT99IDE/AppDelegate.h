@@ -27,6 +27,7 @@
 #define UserDefaultKeyDocumentOptionShowLog @"DocumentOptionShowLog"
 #define UserDefaultKeyDocumentOptionShowErrorsInLog @"DocumentOptionShowErrorsInLog"
 #define UserDefaultKeyDocumentOptionShowWarningsInLog @"DocumentOptionShowWarningsInLog"
+#define UserDefaultKeyMemoryBudgetByteLimit @"MemoryBudgetByteLimit"
 
 #define UserDefaultKeyAssemblerOptionOutputTypePopupIndex @"AssemblerOptionOutputFileTypePopupButtonIndex"
 #define UserDefaultKeyAssemblerOptionDisableXDTExtensions @"AssemblerOptionDisableXDTExtensions"
@@ -23,12 +23,13 @@
 //
 
 #import "AppDelegate.h"
+#import "OutputFileWriter.h"
 
 #import "XDTAssembler.h"
 #import "XDTAs99Objcode.h"
-#import "XDTZipFile.h"
 #import <XDTools99/XDBasic.h>
 #import <XDTools99/XDGPL.h>
+#import <XDTools99/XDTMemoryBudget.h>
 
 
 NSErrorDomain const IDEErrorDomain = @"IDEErrorDomain";
@@ -77,6 +78,7 @@ NS_ASSUME_NONNULL_END
                                    UserDefaultKeyDocumentOptionShowLog: @YES,
                                    UserDefaultKeyDocumentOptionShowErrorsInLog: @YES,
                                    UserDefaultKeyDocumentOptionShowWarningsInLog: @YES,
+                                   UserDefaultKeyMemoryBudgetByteLimit: [NSNumber numberWithUnsignedInteger:64 * 1024 * 1024],
 
                                    UserDefaultKeyAssemblerOptionOutputTypePopupIndex: @1,
                                    UserDefaultKeyAssemblerOptionDisableXDTExtensions: @NO,
@@ -99,6 +101,10 @@ NS_ASSUME_NONNULL_END
                                    UserDefaultKeyGPLOptionGROMAddress: @0x6000
                                    };
     [[NSUserDefaults standardUserDefaults] registerDefaults:defaultsDict];
+
+    /* Results of documents which were not assembled for a long time are detached when all results need too much memory */
+    NSUInteger byteLimit = [[[NSUserDefaults standardUserDefaults] objectForKey:UserDefaultKeyMemoryBudgetByteLimit] unsignedIntegerValue];
+    [[XDTMemoryBudget sharedBudget] setByteLimit:byteLimit];
 }
 
 
@@ -120,6 +126,7 @@ NS_ASSUME_NONNULL_END
     _actualOptionsView = _assemblerOptionsView;
     [self processSourceFileURL:assemblerFileURL withXDTprocess:^BOOL(NSURL *outputFileURL) {
         NSUserDefaults *defaults = [[NSUserDefaultsController sharedUserDefaultsController] defaults];
+        OutputFileWriter *outputFileWriter = [OutputFileWriter outputFileWriter];
         NSInteger selectedTypeIndenx = [defaults integerForKey:UserDefaultKeyAssemblerOptionOutputTypePopupIndex];
         XDTAs99TargetType xdtTargetType = XDTAs99TargetTypeObjectCode;
         BOOL compressedObjectCode = NO;
@@ -183,7 +190,7 @@ NS_ASSUME_NONNULL_END
                         break;
                     }
                     NSURL *countingFileURL = [[outputFileURL URLByDeletingLastPathComponent] URLByAppendingPathComponent:[countingFileName stringByAppendingPathExtension:[outputFileURL pathExtension]]];
-                    [data writeToURL:countingFileURL options:NSDataWritingAtomic error:&error];
+                    [outputFileWriter writeData:data toURL:countingFileURL error:&error];
                     if (nil != error) {
                         break;
                     }
@@ -211,7 +218,7 @@ NS_ASSUME_NONNULL_END
                     }
                     NSURL *newOutputFileURL = [NSURL fileURLWithPath:[[[[outputFileURL lastPathComponent] stringByDeletingPathExtension] stringByAppendingString:fileNameAddition] stringByAppendingPathExtension:[outputFileURL pathExtension]]
                                                      relativeToURL:[outputFileURL URLByDeletingLastPathComponent]];
-                    [data writeToURL:newOutputFileURL options:NSDataWritingAtomic error:&error];
+                    [outputFileWriter writeData:data toURL:newOutputFileURL error:&error];
                     if (nil != error) {
                         break;
                     }
@@ -236,21 +243,21 @@ NS_ASSUME_NONNULL_END
                                                                 withMode:mode + XDTGenerateTextModeOptionWord
                                                                    error:&error];
                 if (nil == error && nil != fileContent && [fileContent length] > 0) {
-                    [fileContent writeToURL:outputFileURL atomically:YES encoding:NSUTF8StringEncoding error:&error];
+                    [outputFileWriter writeString:fileContent toURL:outputFileURL error:&error];
                 }
                 break;
             }
             case XDTAs99TargetTypeObjectCode: {
                 NSData *data = [assemblingResult generateObjCode:compressedObjectCode error:&error];
                 if (nil == error && nil != data) {
-                    [data writeToURL:outputFileURL options:NSDataWritingAtomic error:&error];
+                    [outputFileWriter writeData:data toURL:outputFileURL error:&error];
                 }
                 break;
             }
             case XDTAs99TargetTypeEmbededXBasic: {
                 NSData *data = [assemblingResult generateBasicLoader:&error];
                 if (nil == error && nil != data) {
-                    [data writeToURL:outputFileURL options:NSDataWritingAtomic error:&error];
+                    [outputFileWriter writeData:data toURL:outputFileURL error:&error];
                 }
                 break;
             }
@@ -265,18 +272,9 @@ NS_ASSUME_NONNULL_END
                     return NO;
                 }
 
-                XDTZipFile *zipfile = [XDTZipFile zipFileForWritingToURL:outputFileURL error:&error];
-                if (nil == error && nil != zipfile) {
-                    NSDictionary *tripel = [assemblingResult generateMESSCartridgeWithName:cartName error:&error];
-                    if (nil == error && nil != tripel) {
-                        for (NSString *fName in [tripel keyEnumerator]) {
-                            NSData *data = [tripel objectForKey:fName];
-                            [zipfile writeFile:fName withData:data error:&error];
-                            if (nil != error) {
-                                break;
-                            }
-                        }
-                    }
+                NSDictionary *tripel = [assemblingResult generateMESSCartridgeWithName:cartName error:&error];
+                if (nil == error && nil != tripel) {
+                    [outputFileWriter writeZipFileWithContents:tripel toURL:outputFileURL error:&error];
                 }
                 if (nil != error) {
                     NSAlert *alert = [NSAlert alertWithError:error];
@@ -301,7 +299,7 @@ NS_ASSUME_NONNULL_END
                     [retVal appendFormat:@"\n%@\n", [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]];
                 }
                 if (nil == error && nil != retVal && [retVal length] > 0) {
-                    [retVal writeToURL:listingURL atomically:YES encoding:NSUTF8StringEncoding error:&error];
+                    [outputFileWriter writeString:retVal toURL:listingURL error:&error];
                 }
             }
         }
@@ -310,6 +308,7 @@ NS_ASSUME_NONNULL_END
             [[NSAlert alertWithError:error] runModal];
             return NO;
         }
+        NSLog(@"%@: %@", [outputFileURL lastPathComponent], [outputFileWriter localizedSummary]);
         return YES;
     }];
 }
@@ -325,6 +324,7 @@ NS_ASSUME_NONNULL_END
     _actualOptionsView = _gplAssemblerOptionsView;
     [self processSourceFileURL:gplFileURL withXDTprocess:^BOOL(NSURL * _Nonnull outputFileURL) {
         NSUserDefaults *defaults = [[NSUserDefaultsController sharedUserDefaultsController] defaults];
+        OutputFileWriter *outputFileWriter = [OutputFileWriter outputFileWriter];
         NSInteger selectedTypeIndex = [defaults integerForKey:UserDefaultKeyGPLOptionOutputTypePopupIndex];
         XDTGa99TargetType xdtTargetType = XDTGa99TargetTypePlainByteCode;
         switch (selectedTypeIndex) {
@@ -389,7 +389,7 @@ NS_ASSUME_NONNULL_END
                     }
                     NSURL *newOutputFileURL = [NSURL fileURLWithPath:[[[[outputFileURL lastPathComponent] stringByDeletingPathExtension] stringByAppendingString:fileNameAddition] stringByAppendingPathExtension:[outputFileURL pathExtension]]
                                                      relativeToURL:[outputFileURL URLByDeletingLastPathComponent]];
-                    [data writeToURL:newOutputFileURL options:NSDataWritingAtomic error:&error];
+                    [outputFileWriter writeData:data toURL:newOutputFileURL error:&error];
                     if (nil != error) {
                         break;
                     }
@@ -409,7 +409,7 @@ NS_ASSUME_NONNULL_END
 
                 NSData *data = [assemblingResult generateImageWithName:cartName error:&error];
                 if (nil == error && nil != data) {
-                    [data writeToURL:outputFileURL options:NSDataWritingAtomic error:&error];
+                    [outputFileWriter writeData:data toURL:outputFileURL error:&error];
                 }
                 break;
             }
@@ -425,18 +425,9 @@ NS_ASSUME_NONNULL_END
                     return NO;
                 }
 
-                XDTZipFile *zipfile = [XDTZipFile zipFileForWritingToURL:outputFileURL error:&error];
-                if (nil != zipfile) {
-                    NSDictionary *tripel = [assemblingResult generateMESSCartridgeWithName:cartName error:&error];
-                    if (nil == error && nil != tripel) {
-                        for (NSString *fName in [tripel keyEnumerator]) {
-                            NSData *data = [tripel objectForKey:fName];
-                            [zipfile writeFile:fName withData:data error:&error];
-                            if (nil != error) {
-                                break;
-                            }
-                        }
-                    }
+                NSDictionary *tripel = [assemblingResult generateMESSCartridgeWithName:cartName error:&error];
+                if (nil == error && nil != tripel) {
+                    [outputFileWriter writeZipFileWithContents:tripel toURL:outputFileURL error:&error];
                 }
                 if (nil != error) {
                     NSAlert *alert = [NSAlert alertWithError:error];
@@ -460,7 +451,7 @@ NS_ASSUME_NONNULL_END
                 [retVal appendFormat:@"\n%@\n", [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]];
             }
             if (nil == error && nil != retVal && [retVal length] > 0) {
-                [retVal writeToURL:listingURL atomically:YES encoding:NSUTF8StringEncoding error:&error];
+                [outputFileWriter writeString:retVal toURL:listingURL error:&error];
             }
         }
 
@@ -468,6 +459,7 @@ NS_ASSUME_NONNULL_END
             [[NSAlert alertWithError:error] runModal];
             return NO;
         }
+        NSLog(@"%@: %@", [outputFileURL lastPathComponent], [outputFileWriter localizedSummary]);
         return YES;
     }];
 }
@@ -483,6 +475,7 @@ NS_ASSUME_NONNULL_END
     _actualOptionsView = _basicOptionsView;
     [self processSourceFileURL:basicFileURL withXDTprocess:^BOOL(NSURL * _Nonnull outputFileURL) {
         NSUserDefaults *defaults = [[NSUserDefaultsController sharedUserDefaultsController] defaults];
+        OutputFileWriter *outputFileWriter = [OutputFileWriter outputFileWriter];
         NSDictionary *options = @{
                                   XDTBasicOptionProtectFile: [defaults objectForKey:UserDefaultKeyBasicOptionShouldProtectFile],
                                   XDTBasicOptionJoinLines: [defaults objectForKey:UserDefaultKeyBasicOptionShouldJoinSourceLines]
@@ -521,11 +514,11 @@ NS_ASSUME_NONNULL_END
         BOOL successfullySaved = NO;
         switch (selectedTypeIndenx) {
             case 0:
-                successfullySaved = [basic saveProgramFormatFile:outputFileURL error:&error];
-                break;
-            case 1:
-                successfullySaved = [basic saveLongFormatFile:outputFileURL error:&error];
+            case 1: {
+                NSData *program = [basic getImageUsingLongFormat:1 == selectedTypeIndenx error:&error];
+                successfullySaved = nil != program && nil == error && [outputFileWriter writeData:program toURL:outputFileURL error:&error];
                 break;
+            }
             case 2:
                 successfullySaved = [basic saveMergedFormatFile:outputFileURL error:&error];
                 break;
@@ -538,6 +531,9 @@ NS_ASSUME_NONNULL_END
             return NO;
         }
 
+        if (successfullySaved) {
+            NSLog(@"%@: %@", [outputFileURL lastPathComponent], [outputFileWriter localizedSummary]);
+        }
         return successfullySaved;
     }];
 }
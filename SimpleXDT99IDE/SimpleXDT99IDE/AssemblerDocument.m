@@ -25,8 +25,11 @@
 #import "AssemblerDocument.h"
 
 #import "AppDelegate.h"
+#import "OutputFileWriter.h"
+#import "BuildScheduler.h"
 
 #import <XDTools99/XDAssembler.h>
+#import <XDTools99/XDTDiskImage.h>
 
 
 @interface AssemblerDocument ()
@@ -66,8 +69,9 @@
 @property (readonly) NSString *symbolsOutput;
 
 @property (readonly) XDTAs99TargetType targetType;
-- (BOOL)assembleCode:(XDTAs99TargetType)xdtTargetType error:(NSError **)error;
+- (BOOL)assembleCodeForGenerating:(BOOL)isGenerating error:(NSError **)error;
 - (BOOL)exportBinaries:(XDTAs99TargetType)xdtTargetType compressObjectCode:(BOOL)shouldCompressObjectCode error:(NSError **)error;
+- (BOOL)exportDiskImageFiles:(XDTAs99TargetType)xdtTargetType compressObjectCode:(BOOL)shouldCompressObjectCode error:(NSError **)error;
 
 - (void)valueDidChangeForOutputFormatPopupButtonIndex:(XDTAs99TargetType)newTarget;
 
@@ -381,6 +385,67 @@
 }
 
 
+- (SyntaxHighlighterLanguage)syntaxHighlighterLanguage
+{
+    return SyntaxHighlighterLanguageAssembler;
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingBuildOptions
+{
+    return [NSSet setWithObjects:NSStringFromSelector(@selector(shouldUseRegisterSymbols)), NSStringFromSelector(@selector(shouldBeStrict)), NSStringFromSelector(@selector(shouldShowWarningsInLog)), NSStringFromSelector(@selector(targetType)), NSStringFromSelector(@selector(binaryTextMode)), nil];
+}
+
+
+- (NSDictionary<NSString *, id> *)buildOptions
+{
+    if (nil == [self fileURL]) {    // there must be a file which can be assembled
+        return nil;
+    }
+    return @{
+             XDTAs99OptionNativeAssembly: @YES,
+             XDTAs99OptionRegister: [NSNumber numberWithBool:[self shouldUseRegisterSymbols]],
+             XDTAs99OptionStrict: [NSNumber numberWithBool:[self shouldBeStrict]],
+             XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:[self targetType]],
+             XDTAs99OptionWarnings: [NSNumber numberWithBool:[self shouldShowWarningsInLog]],
+             XDTAs99OptionMessageAggregation: @{}
+             };
+}
+
+
+#pragma mark - Build Methods
+
+
+- (DocumentBuild *)buildSourceCode:(NSString *)sourceCode fileURL:(NSURL *)fileURL includeURL:(NSURL *)includeURL options:(NSDictionary<NSString *, id> *)options fingerprint:(NSData *)fingerprint
+{
+    XDTAssembler *assembler = [XDTAssembler assemblerWithOptions:options includeURL:includeURL];
+
+    NSError *error = nil;
+    XDTAs99Objcode *result = [assembler assembleSourceFile:fileURL error:&error];
+    /* The object code keeps the listing, so the log shows it without calling xas99 again */
+    [result generateListing:NO error:nil];
+    return [DocumentBuild buildWithFingerprint:fingerprint result:result messages:assembler.messages listing:nil error:error];
+}
+
+
+- (void)applyBuild:(DocumentBuild *)build
+{
+    [self setAssemblingResult:build.result];
+    [super applyBuild:build];
+
+    /* set the number of digits of line numbers in the superclass to configure the log format */
+    [super setValue:@4 forKey:@"lineNumberDigits"];
+}
+
+
+/* Detached object code of xas99 cannot generate the outputs which it has not generated before */
+- (BOOL)canReuseBuild:(DocumentBuild *)build forGenerating:(BOOL)isGenerating
+{
+    XDTAs99Objcode *result = build.result;
+    return !isGenerating || nil == result || !result.isDetached || result.isNative;
+}
+
+
 #pragma mark - Action Methods
 
 
@@ -392,8 +457,10 @@
     }
     NSError *error = nil;
 
-    XDTAs99TargetType xdtTargetType = [self targetType];
-    if (![self assembleCode:xdtTargetType error:&error]) {
+    BOOL isAssembled = [self assembleCodeForGenerating:NO error:&error];
+    /* Listing and symbols are captured now, the intermediate program of Python is not needed anymore */
+    [_assemblingResult materializeAndDetach:nil];
+    if (!isAssembled) {
         if (nil != error) {
             if (!self.shouldShowErrorsInLog || !self.shouldShowLog) {
                 [self presentError:error modalForWindow:[self windowForSheet] delegate:nil didPresentSelector:nil contextInfo:nil];
@@ -413,8 +480,12 @@
     NSError *error = nil;
 
     XDTAs99TargetType xdtTargetType = [self targetType];
-    if (![self assembleCode:xdtTargetType error:&error] || nil != error ||
-        ![self exportBinaries:xdtTargetType compressObjectCode:_shouldCompressObjectCode error:&error] || nil != error) {
+    [self.outputFileWriter resetCounters];
+    BOOL isGenerated = [self assembleCodeForGenerating:YES error:&error] && nil == error &&
+                       [self exportBinaries:xdtTargetType compressObjectCode:_shouldCompressObjectCode error:&error] && nil == error;
+    self.outputWriteSummary = (isGenerated && !self.isOutputDiskImage)? [self.outputFileWriter localizedSummary] : nil;
+    [_assemblingResult materializeAndDetach:nil];
+    if (!isGenerated) {
         if (nil != error) {
             if (!self.shouldShowErrorsInLog || !self.shouldShowLog) {
                 [self presentError:error modalForWindow:[self windowForSheet] delegate:nil didPresentSelector:nil contextInfo:nil];
@@ -493,36 +564,25 @@
 }
 
 
-- (BOOL)assembleCode:(XDTAs99TargetType)xdtTargetType error:(NSError **)error
+- (BOOL)assembleCodeForGenerating:(BOOL)isGenerating error:(NSError **)error
 {
-    if (nil == [self fileURL]) {    // there must be a file which can be assembled
+    DocumentBuild *build = [self latestBuildForGenerating:isGenerating];
+    if (nil == build) {
         return NO;
     }
-    NSDictionary *options = @{
-                              XDTAs99OptionRegister: [NSNumber numberWithBool:[self shouldUseRegisterSymbols]],
-                              XDTAs99OptionStrict: [NSNumber numberWithBool:[self shouldBeStrict]],
-                              XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:xdtTargetType],
-                              XDTAs99OptionWarnings: [NSNumber numberWithBool:[self shouldShowWarningsInLog]]
-                              };
-    XDTAssembler *assembler = [XDTAssembler assemblerWithOptions:options includeURL:[self fileURL]];
-
-    NSError *tempErr = nil;
-    XDTAs99Objcode *result = [assembler assembleSourceFile:[self fileURL] error:&tempErr];
-    [self setAssemblingResult:result];
-    [self setGeneratorMessages:assembler.messages];
-
-    /* set the number of digits of line numbers in the superclass to configure the log format */
-    [super setValue:@4 forKey:@"lineNumberDigits"];
-
     if (nil != error) {
-        *error = tempErr;
+        *error = build.error;
     }
-    return nil == tempErr;
+    return nil == build.error;
 }
 
 
 - (BOOL)exportBinaries:(XDTAs99TargetType)xdtTargetType compressObjectCode:(BOOL)shouldCompressObjectCode error:(NSError **)error
 {
+    if (self.isOutputDiskImage && (XDTAs99TargetTypeProgramImage == xdtTargetType || XDTAs99TargetTypeObjectCode == xdtTargetType)) {
+        return [self exportDiskImageFiles:xdtTargetType compressObjectCode:shouldCompressObjectCode error:error];
+    }
+
     BOOL retVal = YES;
 
     switch (xdtTargetType) {
@@ -534,7 +594,7 @@
                     break;
                 }
                 NSURL *newOutpuFileURL = [NSURL fileURLWithPath:newOutpuFileName relativeToURL:[self outputBasePathURL]];
-                [data writeToURL:newOutpuFileURL options:NSDataWritingAtomic error:error];
+                [self.outputFileWriter writeData:data toURL:newOutpuFileURL error:error];
                 if (nil != error && nil != *error) {
                     retVal = NO;
                     break;
@@ -564,7 +624,7 @@
                 }
                 NSURL *newOutputFileURL = [NSURL fileURLWithPath:[[[[self outputFileName] stringByDeletingPathExtension] stringByAppendingString:fileNameAddition] stringByAppendingPathExtension:[[self outputFileName] pathExtension]]
                                                  relativeToURL:[self outputBasePathURL]];
-                [data writeToURL:newOutputFileURL options:NSDataWritingAtomic error:error];
+                [self.outputFileWriter writeData:data toURL:newOutputFileURL error:error];
                 if (nil != error && nil != *error) {
                     retVal = NO;
                     break;
@@ -583,7 +643,7 @@
             NSString *fileContent = [_assemblingResult generateTextAt:_baseAddress withMode:_binaryTextMode error:&tempError];
             if (nil == tempError && nil != fileContent && [fileContent length] > 0) {
                 NSURL *newOutpuFileURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
-                [fileContent writeToURL:newOutpuFileURL atomically:YES encoding:NSUTF8StringEncoding error:&tempError];
+                [self.outputFileWriter writeString:fileContent toURL:newOutpuFileURL error:&tempError];
             } else {
                 retVal = NO;
             }
@@ -599,7 +659,7 @@
                 break;
             }
             NSURL *newOutputFileURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
-            [data writeToURL:newOutputFileURL options:NSDataWritingAtomic error:error];
+            [self.outputFileWriter writeData:data toURL:newOutputFileURL error:error];
             retVal = nil != error && nil == *error;
             break;
         }
@@ -610,7 +670,7 @@
                 break;
             }
             NSURL *newOutputFileURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
-            [data writeToURL:newOutputFileURL options:NSDataWritingAtomic error:error];
+            [self.outputFileWriter writeData:data toURL:newOutputFileURL error:error];
             retVal = nil != error && nil == *error;
             break;
         }
@@ -628,26 +688,13 @@
                 break;
             }
 
-            NSURL *newOutputFileURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
-            XDTZipFile *zipfile = [XDTZipFile zipFileForWritingToURL:newOutputFileURL error:error];
-            if ((nil != error && nil != *error) || nil == zipfile) {
-                retVal = NO;
-                break;
-            }
-
             NSDictionary *tripel = [_assemblingResult generateMESSCartridgeWithName:_cartridgeName error:error];
             if ((nil != error && nil != *error) || nil == tripel) {
                 retVal = NO;
                 break;
             }
-            for (NSString *fName in [tripel keyEnumerator]) {
-                NSData *data = [tripel objectForKey:fName];
-                [zipfile writeFile:fName withData:data error:error];
-                if (nil != error && nil != *error) {
-                    retVal = NO;
-                    break;
-                }
-            }
+            NSURL *newOutputFileURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
+            retVal = [self.outputFileWriter writeZipFileWithContents:tripel toURL:newOutputFileURL error:error];
             break;
         }
         /* TODO: Since version 1.7.0 of xas99, there is a new option to export an EQU listing to a text file.
@@ -661,4 +708,24 @@
     return retVal;
 }
 
+
+/* Program images and object code are written straight into the sectors of a disk image, without a host file */
+- (BOOL)exportDiskImageFiles:(XDTAs99TargetType)xdtTargetType compressObjectCode:(BOOL)shouldCompressObjectCode error:(NSError **)error
+{
+    XDTDiskImage *diskImage = [self outputDiskImage:error];
+    if (nil == diskImage) {
+        return NO;
+    }
+
+    BOOL retVal = NO;
+    if (XDTAs99TargetTypeProgramImage == xdtTargetType) {
+        NSArray<NSData *> *images = [_assemblingResult generateImageAt:_baseAddress error:error];
+        retVal = nil != images && [diskImage writeProgramImages:images fileName:[self diskFileName] error:error];
+    } else {
+        NSData *data = [_assemblingResult generateObjCode:shouldCompressObjectCode error:error];
+        retVal = nil != data && [diskImage writeObjectCode:data fileName:[self diskFileName] error:error];
+    }
+    return retVal && [diskImage writeToURL:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:error];
+}
+
 @end
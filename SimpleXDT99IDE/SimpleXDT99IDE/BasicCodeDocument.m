@@ -25,8 +25,11 @@
 #import "BasicCodeDocument.h"
 
 #import "AppDelegate.h"
+#import "OutputFileWriter.h"
+#import "BuildScheduler.h"
 
 #import <XDTools99/XDBasic.h>
+#import <XDTools99/XDTDiskImage.h>
 
 
 @interface BasicCodeDocument ()
@@ -302,6 +305,65 @@
 }
 
 
+- (SyntaxHighlighterLanguage)syntaxHighlighterLanguage
+{
+    return SyntaxHighlighterLanguageBasic;
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingBuildOptions
+{
+    return [NSSet setWithObjects:NSStringFromSelector(@selector(shouldJoinSourceLines)), NSStringFromSelector(@selector(lineDelta)), NSStringFromSelector(@selector(shouldProtectFile)), nil];
+}
+
+
+- (NSDictionary<NSString *, id> *)buildOptions
+{
+    return @{
+             XDTBasicOptionJoinLines: [NSNumber numberWithBool:_shouldJoinSourceLines],
+             XDTBasicOptionLineDelta: [NSNumber numberWithUnsignedInteger:_lineDelta],
+             XDTBasicOptionProtectFile: [NSNumber numberWithBool:_shouldProtectFile],
+             XDTBasicOptionMessageAggregation: @{}
+             };
+}
+
+
+/* The program is parsed from the source code in memory, it does not read any file */
+- (NSURL *)buildSourceURL
+{
+    return nil;
+}
+
+
+#pragma mark - Build Methods
+
+
+- (DocumentBuild *)buildSourceCode:(NSString *)sourceCode fileURL:(NSURL *)fileURL includeURL:(NSURL *)includeURL options:(NSDictionary<NSString *, id> *)options fingerprint:(NSData *)fingerprint
+{
+    XDTBasic *basic = [XDTBasic basicWithOptions:options];
+
+    NSError *error = nil;
+    if (![basic parseSourceCode:sourceCode error:&error]) {
+        return [DocumentBuild buildWithFingerprint:fingerprint result:nil messages:basic.messages listing:nil error:error];
+    }
+    NSString *tokenDump = [basic dumpTokenList:&error];
+    return [DocumentBuild buildWithFingerprint:fingerprint result:basic messages:basic.messages listing:tokenDump error:error];
+}
+
+
+- (void)applyBuild:(DocumentBuild *)build
+{
+    XDTBasic *basic = build.result;
+    if (nil != basic) {
+        NSNumber *maxLineNumber = [basic.lines.allKeys valueForKeyPath:@"@max.self"];
+        /* set the number of digits of line numbers in the superclass to configure the log format */
+        [super setValue:[NSNumber numberWithShort:floor(log10([maxLineNumber doubleValue])) + 1] forKey:@"lineNumberDigits"];
+        [self setTokenDump:build.listing];
+    }
+    [super applyBuild:build];
+}
+
+
 #pragma mark - Action Methods
 
 
@@ -345,20 +407,33 @@
     }
 
     BOOL successfullySaved = NO;
-    switch (_outputFormatPopupButtonIndex) {
-        case 0:
-            successfullySaved = [basic saveProgramFormatFile:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:&error];
-            break;
-        case 1:
-            successfullySaved = [basic saveLongFormatFile:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:&error];
-            break;
-        case 2:
-            successfullySaved = [basic saveMergedFormatFile:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:&error];
-            break;
+    [self.outputFileWriter resetCounters];
+    if (self.isOutputDiskImage && 2 > _outputFormatPopupButtonIndex) {
+        /* Programs in internal and in long format are written straight into the sectors of the disk image */
+        const BOOL useLongFormat = 1 == _outputFormatPopupButtonIndex;
+        XDTDiskImage *diskImage = [self outputDiskImage:&error];
+        NSData *program = (nil == diskImage)? nil : [basic getImageUsingLongFormat:useLongFormat error:&error];
+        successfullySaved = nil != program &&
+                            [diskImage writeBasicProgram:program longFormat:useLongFormat fileName:[self diskFileName] error:&error] &&
+                            [diskImage writeToURL:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:&error];
+    } else {
+        switch (_outputFormatPopupButtonIndex) {
+            case 0:
+            case 1: {
+                NSData *program = [basic getImageUsingLongFormat:1 == _outputFormatPopupButtonIndex error:&error];
+                successfullySaved = nil != program && nil == error &&
+                                    [self.outputFileWriter writeData:program toURL:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:&error];
+                break;
+            }
+            case 2:
+                successfullySaved = [basic saveMergedFormatFile:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:&error];
+                break;
 
-        default:
-            break;
+            default:
+                break;
+        }
     }
+    self.outputWriteSummary = (successfullySaved && !self.isOutputDiskImage)? [self.outputFileWriter localizedSummary] : nil;
     if (!successfullySaved) {
         if (nil != error) {
             if (!self.shouldShowErrorsInLog || !self.shouldShowLog) {
@@ -401,22 +476,11 @@
 
 - (XDTBasic *)parseCode:(NSError **)error
 {
-    XDTBasic *basic = [XDTBasic basicWithOptions:@{XDTBasicOptionJoinLines: [NSNumber numberWithBool:_shouldJoinSourceLines],
-                                                   XDTBasicOptionLineDelta: [NSNumber numberWithUnsignedInteger:_lineDelta],
-                                                   XDTBasicOptionProtectFile: [NSNumber numberWithBool:_shouldProtectFile]
-                                                   }];
-    if (![basic parseSourceCode:[self sourceCode] error:error]) {
-        return nil;
+    DocumentBuild *build = [self latestBuildForGenerating:NO];
+    if (nil != error) {
+        *error = build.error;
     }
-
-    NSNumber *maxLineNumber = [basic.lines.allKeys valueForKeyPath:@"@max.self"];
-    /* set the number of digits of line numbers in the superclass to configure the log format */
-    [super setValue:[NSNumber numberWithShort:floor(log10([maxLineNumber doubleValue])) + 1] forKey:@"lineNumberDigits"];
-
-    [self setGeneratorMessages:basic.messages];
-    [self setTokenDump:[basic dumpTokenList:error]];
-    
-    return basic;
+    return build.result;
 }
 
 @end
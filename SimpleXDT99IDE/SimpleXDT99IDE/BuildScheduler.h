@@ -0,0 +1,79 @@
+//
+//  BuildScheduler.h
+//  SimpleXDT99IDE
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  SimpleXDT99IDE a simple IDE based on xdt99 that shows how to use the XDTools99.framework
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+@class SourceCodeDocument, XDTMessage;
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The result of building a document, together with its messages and the listing for the log.
+
+ A build is identified by its fingerprint: the SHA-256 digest of the options, the source code and the path, size and
+ modification date of every entry in the directory of the source file, which covers all files it may copy. There is
+ no fingerprint for directories with too many entries.
+ */
+@interface DocumentBuild : NSObject
+
+@property (readonly, nullable) NSData *fingerprint;    /* nil if the build cannot be compared */
+@property (readonly, nullable) id result;               /* The object code or the parsed BASIC program */
+@property (readonly, nullable) XDTMessage *messages;
+@property (readonly, nullable) NSString *listing;       /* The listing or token dump, generated together with the result */
+@property (readonly, nullable) NSError *error;
+
++ (instancetype)buildWithFingerprint:(nullable NSData *)fingerprint result:(nullable id)result messages:(nullable XDTMessage *)messages listing:(nullable NSString *)listing error:(nullable NSError *)error;
+
+/* The file URL is the source file which is read by the build, nil if the source code in memory is built */
++ (nullable NSData *)fingerprintOfSourceCode:(NSString *)sourceCode fileURL:(nullable NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options;
+
+@end
+
+
+/**
+ Builds the opened documents speculatively in the background, so Check and Generate find an up-to-date build.
+
+ Documents are built when they are opened, edited or saved, when their options change and when the application
+ becomes active again, because the sources may have been edited elsewhere. Builds wait for an idle time, so a series of
+ changes or keystrokes leads to one build. The unsaved text of an edited document is built from a temporary file. They run one after the other in a priority queue: the document of the main window is
+ built first and with user-initiated quality of service, all other documents wait at least the idle interval and
+ run with background quality of service. A build is skipped when its fingerprint equals the one of the latest build.
+ */
+@interface BuildScheduler : NSObject
+
+@property (assign) NSTimeInterval idleInterval;         /* Default 1 second */
+@property (readonly) NSUInteger buildCount;             /* Speculative builds which were run */
+@property (readonly) NSUInteger skippedCount;           /* Speculative builds skipped for an unchanged fingerprint */
+
++ (instancetype)sharedScheduler;
+
+- (void)scheduleDocument:(SourceCodeDocument *)document afterDelay:(NSTimeInterval)delay;
+- (void)cancelDocument:(SourceCodeDocument *)document;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,339 @@
+//
+//  BuildScheduler.m
+//  SimpleXDT99IDE
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  SimpleXDT99IDE a simple IDE based on xdt99 that shows how to use the XDTools99.framework
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "BuildScheduler.h"
+
+#import "SourceCodeDocument.h"
+#import "OutputFileWriter.h"
+
+#import <XDTools99/XDTMessage.h>
+
+#include <CommonCrypto/CommonDigest.h>
+
+
+/* Directories with more entries are not compared, their documents are built at every Check and Generate */
+#define DocumentBuildMaxDirectoryEntries 512
+
+
+@interface DocumentBuild ()
+
+- (instancetype)initWithFingerprint:(nullable NSData *)fingerprint result:(nullable id)result messages:(nullable XDTMessage *)messages listing:(nullable NSString *)listing error:(nullable NSError *)error;
+
+@end
+
+
+@implementation DocumentBuild
+
++ (instancetype)buildWithFingerprint:(NSData *)fingerprint result:(id)result messages:(XDTMessage *)messages listing:(NSString *)listing error:(NSError *)error
+{
+    DocumentBuild *retVal = [[DocumentBuild alloc] initWithFingerprint:fingerprint result:result messages:messages listing:listing error:error];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithFingerprint:(NSData *)fingerprint result:(id)result messages:(XDTMessage *)messages listing:(NSString *)listing error:(NSError *)error
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _fingerprint = [fingerprint copy];
+    _result = result;
+    _messages = messages;
+    _listing = [listing copy];
+    _error = error;
+#if !__has_feature(objc_arc)
+    [_result retain];
+    [_messages retain];
+    [_error retain];
+#endif
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_fingerprint release];
+    [_result release];
+    [_messages release];
+    [_listing release];
+    [_error release];
+
+    [super dealloc];
+#endif
+}
+
+
+/*
+ Generated files are excluded from the directory, because they are written next to the source and would change the
+ fingerprint with every Generate. These are the files of the OutputFileWriter and all disk images.
+ */
++ (NSData *)fingerprintOfSourceCode:(NSString *)sourceCode fileURL:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options
+{
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    for (NSString *key in [[options allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        NSData *option = [[NSString stringWithFormat:@"%@=%@", key, [options objectForKey:key]] dataUsingEncoding:NSUTF8StringEncoding];
+        const uint32_t length = (uint32_t)[option length];
+        CC_SHA256_Update(&context, &length, sizeof(length));
+        CC_SHA256_Update(&context, [option bytes], length);
+    }
+    NSData *content = [sourceCode dataUsingEncoding:NSUTF8StringEncoding];
+    CC_SHA256_Update(&context, [content bytes], (CC_LONG)[content length]);
+
+    if (nil != fileURL) {
+        const char *path = [[fileURL path] fileSystemRepresentation];
+        CC_SHA256_Update(&context, path, (CC_LONG)strlen(path) + 1);
+
+        NSArray<NSString *> *propertyKeys = @[NSURLFileSizeKey, NSURLContentModificationDateKey];
+        NSDirectoryEnumerator<NSURL *> *entries = [[NSFileManager defaultManager] enumeratorAtURL:[fileURL URLByDeletingLastPathComponent]
+                                                                       includingPropertiesForKeys:propertyKeys
+                                                                                          options:0
+                                                                                     errorHandler:nil];
+        NSUInteger entryCount = 0;
+        for (NSURL *entry in entries) {
+            if (DocumentBuildMaxDirectoryEntries < ++entryCount) {
+                return nil;
+            }
+            if (NSOrderedSame == [@"dsk" caseInsensitiveCompare:[entry pathExtension]] || [OutputFileWriter hasWrittenFileAtURL:entry]) {
+                continue;
+            }
+            NSDictionary<NSString *, id> *properties = [entry resourceValuesForKeys:propertyKeys error:nil];
+            const char *entryPath = [[entry path] fileSystemRepresentation];
+            const int64_t entrySize = [[properties objectForKey:NSURLFileSizeKey] longLongValue];
+            const double entryDate = [[properties objectForKey:NSURLContentModificationDateKey] timeIntervalSinceReferenceDate];
+            CC_SHA256_Update(&context, entryPath, (CC_LONG)strlen(entryPath) + 1);
+            CC_SHA256_Update(&context, &entrySize, sizeof(entrySize));
+            CC_SHA256_Update(&context, &entryDate, sizeof(entryDate));
+        }
+    }
+
+    NSMutableData *retVal = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final([retVal mutableBytes], &context);
+    return retVal;
+}
+
+@end
+
+
+@interface BuildScheduler () {
+    NSOperationQueue *_queue;
+    NSMapTable<SourceCodeDocument *, NSNumber *> *_generations;     /* Increased by every schedule, older builds are dropped */
+    NSMapTable<SourceCodeDocument *, NSOperation *> *_operations;
+}
+
+@property NSUInteger buildCount;
+@property NSUInteger skippedCount;
+
+- (BOOL)isMainDocument:(SourceCodeDocument *)document;
+- (void)enqueueDocument:(SourceCodeDocument *)document generation:(NSUInteger)generation;
+
+- (void)windowDidBecomeMain:(NSNotification *)notification;
+- (void)applicationDidBecomeActive:(NSNotification *)notification;
+
+@end
+
+
+@implementation BuildScheduler
+
++ (instancetype)sharedScheduler
+{
+    static BuildScheduler *sharedScheduler = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedScheduler = [BuildScheduler new];
+    });
+    return sharedScheduler;
+}
+
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _idleInterval = 1.0;
+    _queue = [NSOperationQueue new];
+    [_queue setName:@"SimpleXDT99IDE.BuildScheduler"];
+    [_queue setMaxConcurrentOperationCount:1];
+    _generations = [NSMapTable weakToStrongObjectsMapTable];
+    _operations = [NSMapTable weakToStrongObjectsMapTable];
+#if !__has_feature(objc_arc)
+    [_generations retain];
+    [_operations retain];
+#endif
+
+    NSNotificationCenter *notificationCenter = [NSNotificationCenter defaultCenter];
+    [notificationCenter addObserver:self selector:@selector(windowDidBecomeMain:) name:NSWindowDidBecomeMainNotification object:nil];
+    [notificationCenter addObserver:self selector:@selector(applicationDidBecomeActive:) name:NSApplicationDidBecomeActiveNotification object:nil];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [_queue cancelAllOperations];
+#if !__has_feature(objc_arc)
+    [_queue release];
+    [_generations release];
+    [_operations release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Scheduling
+
+
+/* Must be called on the main thread, like all methods of the documents besides building */
+- (void)scheduleDocument:(SourceCodeDocument *)document afterDelay:(NSTimeInterval)delay
+{
+    const NSUInteger generation = [[_generations objectForKey:document] unsignedIntegerValue] + 1;
+    [_generations setObject:[NSNumber numberWithUnsignedInteger:generation] forKey:document];
+    [[_operations objectForKey:document] cancel];
+    [_operations removeObjectForKey:document];
+
+    if (![self isMainDocument:document]) {
+        delay = MAX(delay, _idleInterval);
+    }
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        if (generation == [[self->_generations objectForKey:document] unsignedIntegerValue]) {
+            [self enqueueDocument:document generation:generation];
+        }
+    });
+}
+
+
+- (void)cancelDocument:(SourceCodeDocument *)document
+{
+    [[_operations objectForKey:document] cancel];
+    [_operations removeObjectForKey:document];
+    [_generations removeObjectForKey:document];
+}
+
+
+- (BOOL)isMainDocument:(SourceCodeDocument *)document
+{
+    return [[[[NSApp mainWindow] windowController] document] isEqual:document];
+}
+
+
+/*
+ The options and the source are taken on the main thread, the fingerprint is computed by the build operation, because
+ it reads the directory of the source file. The unsaved text of an edited document is written to a temporary file with
+ the name of the document, which is built instead, so copied files are still found next to the document file.
+ */
+- (void)enqueueDocument:(SourceCodeDocument *)document generation:(NSUInteger)generation
+{
+    NSDictionary<NSString *, id> *options = [document buildOptions];
+    if (nil == options) {
+        return;
+    }
+    NSString *sourceCode = [document sourceCode];
+    NSURL *fileURL = [document fileURL];
+    NSURL *buildSourceURL = [document buildSourceURL];
+    NSData *latestFingerprint = [[document currentBuild] fingerprint];
+    const BOOL isEdited = [document isDocumentEdited] && nil != buildSourceURL;
+
+    NSBlockOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
+        NSData *fingerprint = [DocumentBuild fingerprintOfSourceCode:sourceCode fileURL:buildSourceURL options:options];
+        if (nil == fingerprint || [fingerprint isEqualToData:latestFingerprint]) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                self.skippedCount++;
+            });
+            return;
+        }
+        NSURL *temporaryURL = nil;
+        if (isEdited) {
+            NSURL *directoryURL = [[NSFileManager defaultManager] URLForDirectory:NSItemReplacementDirectory inDomain:NSUserDomainMask
+                                                                appropriateForURL:fileURL create:YES error:nil];
+            temporaryURL = [directoryURL URLByAppendingPathComponent:[fileURL lastPathComponent]];
+            if (nil == temporaryURL || ![sourceCode writeToURL:temporaryURL atomically:NO encoding:NSUTF8StringEncoding error:nil]) {
+                [[NSFileManager defaultManager] removeItemAtURL:directoryURL error:nil];
+                return;
+            }
+        }
+        DocumentBuild *build = [document buildSourceCode:sourceCode fileURL:(nil != temporaryURL)? temporaryURL : fileURL includeURL:fileURL
+                                                 options:options fingerprint:fingerprint];
+        if (nil != temporaryURL) {
+            [[NSFileManager defaultManager] removeItemAtURL:[temporaryURL URLByDeletingLastPathComponent] error:nil];
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            self.buildCount++;
+            if (generation != [[self->_generations objectForKey:document] unsignedIntegerValue] || nil == build ||
+                [build.fingerprint isEqualToData:[[document currentBuild] fingerprint]]) {
+                return;
+            }
+            [self->_operations removeObjectForKey:document];
+            [document applyBuild:build];
+        });
+    }];
+    if ([self isMainDocument:document]) {
+        [operation setQueuePriority:NSOperationQueuePriorityHigh];
+        [operation setQualityOfService:NSQualityOfServiceUserInitiated];
+    } else {
+        [operation setQueuePriority:NSOperationQueuePriorityVeryLow];
+        [operation setQualityOfService:NSQualityOfServiceBackground];
+    }
+    [_operations setObject:operation forKey:document];
+    [_queue addOperation:operation];
+}
+
+
+#pragma mark - Notifications
+
+
+/* The document of the new main window moves to the front of the queue */
+- (void)windowDidBecomeMain:(NSNotification *)notification
+{
+    NSDocument *document = [[(NSWindow *)[notification object] windowController] document];
+    if ([document isKindOfClass:[SourceCodeDocument class]]) {
+        [self scheduleDocument:(SourceCodeDocument *)document afterDelay:0];
+    }
+}
+
+
+/* Sources may have been edited in another application meanwhile */
+- (void)applicationDidBecomeActive:(NSNotification *)notification
+{
+    for (NSDocument *document in [[NSDocumentController sharedDocumentController] documents]) {
+        if ([document isKindOfClass:[SourceCodeDocument class]]) {
+            [self scheduleDocument:(SourceCodeDocument *)document afterDelay:_idleInterval];
+        }
+    }
+}
+
+@end
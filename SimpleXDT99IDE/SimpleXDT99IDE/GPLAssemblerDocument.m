@@ -23,6 +23,8 @@
 #import "GPLAssemblerDocument.h"
 
 #import "AppDelegate.h"
+#import "OutputFileWriter.h"
+#import "BuildScheduler.h"
 
 #import <XDTools99/XDGPL.h>
 
@@ -49,7 +51,7 @@
 @property (readonly) XDTGa99TargetType targetType;
 @property (readonly) XDTGa99SyntaxType syntaxType;
 
-- (BOOL)assembleCode:(XDTGa99TargetType)xdtTargetType error:(NSError **)error;
+- (BOOL)assembleCodeForGenerating:(BOOL)isGenerating error:(NSError **)error;
 - (BOOL)exportBinaries:(XDTGa99TargetType)xdtTargetType error:(NSError **)error;
 
 - (void)valueDidChangeForOutputFormatPopupButtonIndex:(XDTGa99TargetType)newTarget;
@@ -331,6 +333,75 @@
 }
 
 
++ (NSSet *)keyPathsForValuesAffectingSyntaxHighlighterLanguage
+{
+    return [NSSet setWithObject:NSStringFromSelector(@selector(syntaxFormatPopupButtonIndex))];
+}
+
+
+- (SyntaxHighlighterLanguage)syntaxHighlighterLanguage
+{
+    /* The RAG syntax differs from the native one only in directives which are highlighted the same way. */
+    return (XDTGa99SyntaxTypeTIImageTool == [self syntaxType])? SyntaxHighlighterLanguageGPLMizapf : SyntaxHighlighterLanguageGPLNative;
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingBuildOptions
+{
+    return [NSSet setWithObjects:NSStringFromSelector(@selector(aorgAddress)), NSStringFromSelector(@selector(gromAddress)), NSStringFromSelector(@selector(syntaxType)), NSStringFromSelector(@selector(targetType)), NSStringFromSelector(@selector(shouldShowWarningsInLog)), nil];
+}
+
+
+- (NSDictionary<NSString *, id> *)buildOptions
+{
+    if (nil == [self fileURL]) {    // there must be a file which can be assembled
+        return nil;
+    }
+    return @{
+             XDTGa99OptionAORG: [NSNumber numberWithUnsignedInteger:[self aorgAddress]],
+             XDTGa99OptionGROM: [NSNumber numberWithUnsignedInteger:[self gromAddress]],
+             XDTGa99OptionNativeAssembly: @YES,
+             XDTGa99OptionStyle: [NSNumber numberWithUnsignedInteger:[self syntaxType]],
+             XDTGa99OptionTarget: [NSNumber numberWithUnsignedInteger:[self targetType]],
+             XDTGa99OptionWarnings: [NSNumber numberWithBool:[self shouldShowWarningsInLog]],
+             XDTGa99OptionMessageAggregation: @{}
+             };
+}
+
+
+#pragma mark - Build Methods
+
+
+- (DocumentBuild *)buildSourceCode:(NSString *)sourceCode fileURL:(NSURL *)fileURL includeURL:(NSURL *)includeURL options:(NSDictionary<NSString *, id> *)options fingerprint:(NSData *)fingerprint
+{
+    XDTGPLAssembler *assembler = [XDTGPLAssembler gplAssemblerWithOptions:options includeURL:includeURL];
+
+    NSError *error = nil;
+    XDTGa99Objcode *result = [assembler assembleSourceFile:fileURL error:&error];
+    /* The object code keeps the listing, so the log shows it without calling xga99 again */
+    [result generateListing:NO error:nil];
+    return [DocumentBuild buildWithFingerprint:fingerprint result:result messages:assembler.messages listing:nil error:error];
+}
+
+
+- (void)applyBuild:(DocumentBuild *)build
+{
+    [self setAssemblingResult:build.result];
+    [super applyBuild:build];
+
+    /* set the number of digits of line numbers in the superclass to configure the log format */
+    [super setValue:@4 forKey:@"lineNumberDigits"];
+}
+
+
+/* Detached object code of xga99 cannot generate the outputs which it has not generated before */
+- (BOOL)canReuseBuild:(DocumentBuild *)build forGenerating:(BOOL)isGenerating
+{
+    XDTGa99Objcode *result = build.result;
+    return !isGenerating || nil == result || !result.isDetached || result.isNative;
+}
+
+
 #pragma mark - Action Methods
 
 
@@ -342,8 +413,10 @@
     }
     NSError *error = nil;
 
-    XDTGa99TargetType xdtTargetType = [self targetType];
-    if (![self assembleCode:xdtTargetType error:&error]) {
+    BOOL isAssembled = [self assembleCodeForGenerating:NO error:&error];
+    /* Listing and symbols are captured now, the intermediate program of Python is not needed anymore */
+    [_assemblingResult materializeAndDetach:nil];
+    if (!isAssembled) {
         if (nil != error) {
             if (!self.shouldShowErrorsInLog || !self.shouldShowLog) {
                 [self presentError:error modalForWindow:[self windowForSheet] delegate:nil didPresentSelector:nil contextInfo:nil];
@@ -363,8 +436,12 @@
     NSError *error = nil;
 
     XDTGa99TargetType xdtTargetType = [self targetType];
-    if (![self assembleCode:xdtTargetType error:&error] || nil != error ||
-        ![self exportBinaries:xdtTargetType error:&error] || nil != error) {
+    [self.outputFileWriter resetCounters];
+    BOOL isGenerated = [self assembleCodeForGenerating:YES error:&error] && nil == error &&
+                       [self exportBinaries:xdtTargetType error:&error] && nil == error;
+    self.outputWriteSummary = isGenerated? [self.outputFileWriter localizedSummary] : nil;
+    [_assemblingResult materializeAndDetach:nil];
+    if (!isGenerated) {
         if (nil != error) {
             if (!self.shouldShowErrorsInLog || !self.shouldShowLog) {
                 [self presentError:error modalForWindow:[self windowForSheet] delegate:nil didPresentSelector:nil contextInfo:nil];
@@ -432,32 +509,16 @@
 }
 
 
-- (BOOL)assembleCode:(XDTGa99TargetType)xdtTargetType error:(NSError **)error
+- (BOOL)assembleCodeForGenerating:(BOOL)isGenerating error:(NSError **)error
 {
-    if (nil == [self fileURL]) {    // there must be a file which can be assembled
+    DocumentBuild *build = [self latestBuildForGenerating:isGenerating];
+    if (nil == build) {
         return NO;
     }
-    NSDictionary *options = @{
-                              XDTGa99OptionAORG: [NSNumber numberWithUnsignedInteger:[self aorgAddress]],
-                              XDTGa99OptionGROM: [NSNumber numberWithUnsignedInteger:[self gromAddress]],
-                              XDTGa99OptionStyle: [NSNumber numberWithUnsignedInteger:[self syntaxType]],
-                              XDTGa99OptionTarget: [NSNumber numberWithUnsignedInteger:[self targetType]],
-                              XDTGa99OptionWarnings: [NSNumber numberWithBool:[self shouldShowWarningsInLog]]
-                              };
-    XDTGPLAssembler *assembler = [XDTGPLAssembler gplAssemblerWithOptions:options includeURL:[self fileURL]];
-
-    NSError *tempErr = nil;
-    XDTGa99Objcode *result = [assembler assembleSourceFile:[self fileURL] error:&tempErr];
-    [self setAssemblingResult:result];
-    [self setGeneratorMessages:assembler.messages];
-
-    /* set the number of digits of line numbers in the superclass to configure the log format */
-    [super setValue:@4 forKey:@"lineNumberDigits"];
-
     if (nil != error) {
-        *error = tempErr;
+        *error = build.error;
     }
-    return nil == tempErr;
+    return nil == build.error;
 }
 
 
@@ -484,7 +545,7 @@
                 }
                 NSURL *newOutputFileURL = [NSURL fileURLWithPath:[[[[self outputFileName] stringByDeletingPathExtension] stringByAppendingString:fileNameAddition] stringByAppendingPathExtension:[[self outputFileName] pathExtension]]
                                                  relativeToURL:[self outputBasePathURL]];
-                [data writeToURL:newOutputFileURL options:NSDataWritingAtomic error:error];
+                [self.outputFileWriter writeData:data toURL:newOutputFileURL error:error];
                 if (nil != error && nil != *error) {
                     retVal = NO;
                     break;
@@ -509,7 +570,7 @@
             NSData *data = [_assemblingResult generateImageWithName:_cartridgeName error:error];
             if ((nil != error && nil == *error) && nil != data) {
                 NSURL *newOutpuFileURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
-                [data writeToURL:newOutpuFileURL options:NSDataWritingAtomic error:error];
+                [self.outputFileWriter writeData:data toURL:newOutpuFileURL error:error];
             }
             retVal = nil != error && nil == *error;
             break;
@@ -529,25 +590,12 @@
                 break;
             }
 
-            XDTZipFile *zipfile = [XDTZipFile zipFileForWritingToURL:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:error];
-            if ((nil != error && nil != *error) || nil == zipfile) {
-                retVal = NO;
-                break;
-            }
-
             NSDictionary *tripel = [_assemblingResult generateMESSCartridgeWithName:_cartridgeName error:error];
             if ((nil != error && nil != *error) || nil == tripel) {
                 retVal = NO;
                 break;
             }
-            for (NSString *fName in [tripel keyEnumerator]) {
-                NSData *data = [tripel objectForKey:fName];
-                [zipfile writeFile:fName withData:data error:error];
-                if (nil != error && nil != *error) {
-                    retVal = NO;
-                    break;
-                }
-            }
+            retVal = [self.outputFileWriter writeZipFileWithContents:tripel toURL:[NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]] error:error];
             break;
         }
 
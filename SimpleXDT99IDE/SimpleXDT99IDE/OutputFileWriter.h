@@ -0,0 +1,63 @@
+//
+//  OutputFileWriter.h
+//  SimpleXDT99IDE
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  SimpleXDT99IDE a simple IDE based on xdt99 that shows how to use the XDTools99.framework
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Writes generated files only when their content has changed.
+
+ The SHA-256 digest of every written file is kept in a manifest shared by all writers, together with the size and the
+ modification date of the file. A file which still has this size and date and whose new content has the same digest
+ is not touched. Files which are not in the manifest, e.g. after a restart, are compared with the file on disk.
+ The writes of one export are counted, so the documents can report how much has actually been written.
+ */
+@interface OutputFileWriter : NSObject
+
+@property (readonly) NSUInteger writtenFileCount;
+@property (readonly) NSUInteger skippedFileCount;
+@property (readonly) unsigned long long writtenByteCount;
+@property (readonly) unsigned long long skippedByteCount;
+
++ (instancetype)outputFileWriter;
+
+- (void)resetCounters;
+
+- (BOOL)writeData:(NSData *)data toURL:(NSURL *)fileURL error:(NSError **)error;
+- (BOOL)writeString:(NSString *)string toURL:(NSURL *)fileURL error:(NSError **)error;   /* UTF-8 encoded */
+/* The files of a MESS cartridge: the zip file is written again when any of them has changed */
+- (BOOL)writeZipFileWithContents:(NSDictionary<NSString *, NSData *> *)contents toURL:(NSURL *)fileURL error:(NSError **)error;
+
+/* Whether any writer has written the file, generated files are no sources of a build */
++ (BOOL)hasWrittenFileAtURL:(NSURL *)fileURL;
+
+/* e.g. "2 files written (8192 bytes), 3 unchanged files skipped (24576 bytes)" */
+- (NSString *)localizedSummary;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,235 @@
+//
+//  OutputFileWriter.m
+//  SimpleXDT99IDE
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  SimpleXDT99IDE a simple IDE based on xdt99 that shows how to use the XDTools99.framework
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "OutputFileWriter.h"
+
+#import <XDTools99/XDTCartridgeBuilder.h>
+
+#include <CommonCrypto/CommonDigest.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/* Keys of the manifest entries */
+static NSString * const OutputFileWriterDigestKey = @"digest";
+static NSString * const OutputFileWriterSizeKey = @"size";
+static NSString * const OutputFileWriterModificationDateKey = @"date";
+
+
+@interface OutputFileWriter ()
+
+@property NSUInteger writtenFileCount;
+@property NSUInteger skippedFileCount;
+@property unsigned long long writtenByteCount;
+@property unsigned long long skippedByteCount;
+
++ (NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *)manifest;
+
+- (BOOL)isUnchangedFileAtURL:(NSURL *)fileURL digest:(NSData *)digest newContent:(nullable NSData *)content;
+- (void)recordWrittenFileAtURL:(NSURL *)fileURL digest:(NSData *)digest;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static NSData *OutputFileWriterDigestOfData(NSData *data)
+{
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([data bytes], (CC_LONG)[data length], digest);
+    return [NSData dataWithBytes:digest length:sizeof(digest)];
+}
+
+
+@implementation OutputFileWriter
+
++ (instancetype)outputFileWriter
+{
+    OutputFileWriter *retVal = [[OutputFileWriter alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
++ (NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *)manifest
+{
+    static NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *manifest = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        manifest = [NSMutableDictionary dictionary];
+#if !__has_feature(objc_arc)
+        [manifest retain];
+#endif
+    });
+    return manifest;
+}
+
+
+- (void)resetCounters
+{
+    self.writtenFileCount = 0;
+    self.skippedFileCount = 0;
+    self.writtenByteCount = 0;
+    self.skippedByteCount = 0;
+}
+
+
+#pragma mark - Writing
+
+
+- (BOOL)writeData:(NSData *)data toURL:(NSURL *)fileURL error:(NSError **)error
+{
+    NSData *digest = OutputFileWriterDigestOfData(data);
+    if ([self isUnchangedFileAtURL:fileURL digest:digest newContent:data]) {
+        self.skippedFileCount++;
+        self.skippedByteCount += [data length];
+        return YES;
+    }
+
+    if (![data writeToURL:fileURL options:NSDataWritingAtomic error:error]) {
+        return NO;
+    }
+    [self recordWrittenFileAtURL:fileURL digest:digest];
+    self.writtenFileCount++;
+    self.writtenByteCount += [data length];
+    return YES;
+}
+
+
+- (BOOL)writeString:(NSString *)string toURL:(NSURL *)fileURL error:(NSError **)error
+{
+    return [self writeData:[string dataUsingEncoding:NSUTF8StringEncoding] toURL:fileURL error:error];
+}
+
+
+- (BOOL)writeZipFileWithContents:(NSDictionary<NSString *, NSData *> *)contents toURL:(NSURL *)fileURL error:(NSError **)error
+{
+    /* A zip file cannot be compared to its contents, so only the manifest knows whether they have changed */
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    unsigned long long byteCount = 0;
+    for (NSString *fileName in [[contents allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        NSData *data = [contents objectForKey:fileName];
+        const char *name = [fileName UTF8String];
+        CC_SHA256_Update(&context, name, (CC_LONG)strlen(name) + 1);
+        NSData *memberDigest = OutputFileWriterDigestOfData(data);
+        CC_SHA256_Update(&context, [memberDigest bytes], (CC_LONG)[memberDigest length]);
+        byteCount += [data length];
+    }
+    unsigned char digestBytes[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digestBytes, &context);
+    NSData *digest = [NSData dataWithBytes:digestBytes length:sizeof(digestBytes)];
+    if ([self isUnchangedFileAtURL:fileURL digest:digest newContent:nil]) {
+        self.skippedFileCount++;
+        self.skippedByteCount += byteCount;
+        return YES;
+    }
+
+    if (![XDTCartridgeBuilder writePackageContents:contents toURL:fileURL error:error]) {
+        return NO;
+    }
+    self.writtenFileCount++;
+    self.writtenByteCount += byteCount;
+    [self recordWrittenFileAtURL:fileURL digest:digest];
+    return YES;
+}
+
+
+#pragma mark - Manifest
+
+
++ (BOOL)hasWrittenFileAtURL:(NSURL *)fileURL
+{
+    NSString *path = [[fileURL URLByStandardizingPath] path];
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *manifest = [self manifest];
+    @synchronized (manifest) {
+        return nil != [manifest objectForKey:path];
+    }
+}
+
+
+/* Content is the new data of a file, it is compared with the file on disk when the manifest does not know the file */
+- (BOOL)isUnchangedFileAtURL:(NSURL *)fileURL digest:(NSData *)digest newContent:(NSData *)content
+{
+    NSString *path = [[fileURL URLByStandardizingPath] path];
+    NSDictionary<NSFileAttributeKey, id> *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+    if (nil == attributes) {
+        return NO;
+    }
+
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *manifest = [[self class] manifest];
+    NSDictionary<NSString *, id> *entry = nil;
+    @synchronized (manifest) {
+        entry = [manifest objectForKey:path];
+    }
+    if (nil != entry && [[entry objectForKey:OutputFileWriterSizeKey] isEqualToNumber:[attributes objectForKey:NSFileSize]] &&
+        [[entry objectForKey:OutputFileWriterModificationDateKey] isEqualToDate:[attributes fileModificationDate]]) {
+        return [digest isEqualToData:[entry objectForKey:OutputFileWriterDigestKey]];
+    }
+
+    /* Unknown or modified by others: only a file of the same size can be equal */
+    if (nil == content || [attributes fileSize] != [content length]) {
+        return NO;
+    }
+    NSData *existingContent = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil];
+    if (nil == existingContent || ![digest isEqualToData:OutputFileWriterDigestOfData(existingContent)]) {
+        return NO;
+    }
+    [self recordWrittenFileAtURL:fileURL digest:digest];
+    return YES;
+}
+
+
+- (void)recordWrittenFileAtURL:(NSURL *)fileURL digest:(NSData *)digest
+{
+    NSString *path = [[fileURL URLByStandardizingPath] path];
+    NSDictionary<NSFileAttributeKey, id> *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:nil];
+    if (nil == attributes) {
+        return;
+    }
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *manifest = [[self class] manifest];
+    @synchronized (manifest) {
+        [manifest setObject:@{
+                              OutputFileWriterDigestKey: digest,
+                              OutputFileWriterSizeKey: [attributes objectForKey:NSFileSize],
+                              OutputFileWriterModificationDateKey: [attributes fileModificationDate]
+                              }
+                     forKey:path];
+    }
+}
+
+
+#pragma mark - Report
+
+
+- (NSString *)localizedSummary
+{
+    return [NSString stringWithFormat:NSLocalizedString(@"%lu files written (%llu bytes), %lu unchanged files skipped (%llu bytes)", @"Summary of the generated files, with the number and the size of the written and of the unchanged files"),
+            (unsigned long)self.writtenFileCount, self.writtenByteCount, (unsigned long)self.skippedFileCount, self.skippedByteCount];
+}
+
+@end
@@ -24,8 +24,13 @@
 
 #import <Cocoa/Cocoa.h>
 
+#import "SyntaxHighlighter.h"
+
 
 @class XDTMessage;
+@class XDTDiskImage;
+@class OutputFileWriter;
+@class DocumentBuild;
 
 @interface SourceCodeDocument : NSDocument <NSTextViewDelegate>
 
@@ -37,6 +42,10 @@
 
 @property (retain) NSURL *outputBasePathURL;
 @property (retain) NSString *outputFileName;
+@property (readonly) BOOL isOutputDiskImage;    /* Generated files are written into the disk image, if the output file has the extension dsk */
+@property (readonly) NSString *diskFileName;
+@property (readonly) OutputFileWriter *outputFileWriter;   /* Skips the generated files which have not changed */
+@property (retain) NSString *outputWriteSummary;           /* Written and skipped files of the last generation, shown in the log */
 
 @property (retain) IBOutlet NSToolbarItem *xdt99OptionsToolbarItem;
 @property (retain) IBOutlet NSView *xdt99OptionsToolbarView;
@@ -51,12 +60,31 @@
 @property (retain) IBOutlet NSTextView *logView;
 @property (readonly) BOOL hasLogContentToSave;
 
+@property (readonly) SyntaxHighlighterLanguage syntaxHighlighterLanguage;    /* This property should be overridden from specialized class */
+
 @property (readonly) NSImage *statusImage;
 @property (retain) XDTMessage *generatorMessages;
 @property (readonly) NSMutableAttributedString *generatedLogMessage;
 
+/*
+ Speculative builds of the BuildScheduler. The specialized class returns the options of its tool, which are nil when
+ the document cannot be built, and builds the document with them on any thread. Check and Generate take the latest
+ build, which is only built again when the source, a copied file or an option has changed.
+ */
+@property (readonly) NSDictionary<NSString *, id> *buildOptions;
+@property (readonly) NSURL *buildSourceURL;         /* The file read by the build, nil if the source code is built from memory */
+@property (readonly) DocumentBuild *currentBuild;
+
+/* The file URL is the file to build, a temporary copy while the document has unsaved changes, the include URL the document file */
+- (DocumentBuild *)buildSourceCode:(NSString *)sourceCode fileURL:(NSURL *)fileURL includeURL:(NSURL *)includeURL options:(NSDictionary<NSString *, id> *)options fingerprint:(NSData *)fingerprint;
+- (void)applyBuild:(DocumentBuild *)build;          /* Takes the build on the main thread, the specialized class must call super */
+- (BOOL)canReuseBuild:(DocumentBuild *)build forGenerating:(BOOL)isGenerating;
+- (DocumentBuild *)latestBuildForGenerating:(BOOL)isGenerating;
+
 - (IBAction)checkCode:(id)sender;
 - (IBAction)generateCode:(id)sender;
 
+- (XDTDiskImage *)outputDiskImage:(NSError **)error;
+
 @end
 
@@ -26,6 +26,8 @@
 
 #import "NSViewAutolayoutAdditions.h"
 #import "NSColorAdditions.h"
+#import "OutputFileWriter.h"
+#import "BuildScheduler.h"
 
 #import "AppDelegate.h"
 
@@ -33,14 +35,17 @@
 
 #import "XDTObject.h"
 #import "XDTMessage.h"
+#import "XDTDiskImage.h"
 
 
 
 @interface SourceCodeDocument () {
     NoodleLineNumberView *_lineNumberRulerView;
+    SyntaxHighlighter *_syntaxHighlighter;
 }
 
 @property (retain) NSNumber *lineNumberDigits;
+@property (retain) DocumentBuild *currentBuild;
 
 - (IBAction)generateCode:(nullable id)sender;
 - (IBAction)selectOutputFile:(nullable id)sender;
@@ -63,8 +68,12 @@
     _outputFileName = nil;
     _generatorMessages = nil;
     _lineNumberRulerView = nil;
+    _syntaxHighlighter = nil;
 
     _lineNumberDigits = nil;
+    _outputFileWriter = [OutputFileWriter new];
+    _outputWriteSummary = nil;
+    _currentBuild = nil;
 
     return self;
 }
@@ -77,7 +86,11 @@
     [_outputFileName release];
     [_generatorMessages release];
     [_lineNumberRulerView release];
+    [_syntaxHighlighter release];
     [_lineNumberDigits release];
+    [_outputFileWriter release];
+    [_outputWriteSummary release];
+    [_currentBuild release];
     
     [super dealloc];
 #endif
@@ -108,6 +121,13 @@
     [_sourceScrollView setHasHorizontalRuler:NO];
     [_sourceScrollView setHasVerticalRuler:YES];
     [_sourceScrollView setRulersVisible:YES];
+
+    _syntaxHighlighter = [[SyntaxHighlighter alloc] initWithTextView:_sourceView language:[self syntaxHighlighterLanguage]];
+    [self addObserver:self forKeyPath:NSStringFromSelector(@selector(syntaxHighlighterLanguage)) options:NSKeyValueObservingOptionNew context:nil];
+
+    /* The specialized class sets up its options after this, they are taken when the build is enqueued */
+    [self addObserver:self forKeyPath:NSStringFromSelector(@selector(buildOptions)) options:NSKeyValueObservingOptionNew context:nil];
+    [[BuildScheduler sharedScheduler] scheduleDocument:self afterDelay:0];
 }
 
 
@@ -123,6 +143,36 @@
 }
 
 
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (object == self && [NSStringFromSelector(@selector(syntaxHighlighterLanguage)) isEqualToString:keyPath]) {
+        [_syntaxHighlighter setLanguage:[self syntaxHighlighterLanguage]];
+    } else if (object == self && [NSStringFromSelector(@selector(buildOptions)) isEqualToString:keyPath]) {
+        BuildScheduler *scheduler = [BuildScheduler sharedScheduler];
+        [scheduler scheduleDocument:self afterDelay:scheduler.idleInterval];
+    } else {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+    }
+}
+
+
+/* The user may still cancel closing in canCloseDocumentWithDelegate:..., so the highlighting and builds end here */
+- (void)close
+{
+    [[BuildScheduler sharedScheduler] cancelDocument:self];
+    if (nil != _syntaxHighlighter) {    /* the observers are added along with it, once the window is loaded */
+        [self removeObserver:self forKeyPath:NSStringFromSelector(@selector(syntaxHighlighterLanguage))];
+        [self removeObserver:self forKeyPath:NSStringFromSelector(@selector(buildOptions))];
+        [_syntaxHighlighter invalidate];
+#if !__has_feature(objc_arc)
+        [_syntaxHighlighter release];
+#endif
+        _syntaxHighlighter = nil;
+    }
+    [super close];
+}
+
+
 /* This method should be overridden from specialized class */
 - (NSData *)dataOfType:(NSString *)typeName error:(NSError **)outError {
     [NSException raise:@"UnimplementedMethod" format:@"%@ is unimplemented", NSStringFromSelector(_cmd)];
@@ -139,6 +189,37 @@
 }
 
 
+/* Every edit builds the document again, once the typing has paused for the idle interval */
+- (void)updateChangeCount:(NSDocumentChangeType)change
+{
+    [super updateChangeCount:change];
+    switch (change & ~NSChangeDiscardable) {
+        case NSChangeDone:
+        case NSChangeUndone:
+        case NSChangeRedone: {
+            BuildScheduler *scheduler = [BuildScheduler sharedScheduler];
+            [scheduler scheduleDocument:self afterDelay:scheduler.idleInterval];
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+/* Every save builds the document again, as soon as possible */
+- (void)saveToURL:(NSURL *)url ofType:(NSString *)typeName forSaveOperation:(NSSaveOperationType)saveOperation completionHandler:(void (^)(NSError *))completionHandler
+{
+    [super saveToURL:url ofType:typeName forSaveOperation:saveOperation completionHandler:^(NSError *errorOrNil) {
+        if (nil == errorOrNil) {
+            [[BuildScheduler sharedScheduler] scheduleDocument:self afterDelay:0];
+        }
+        completionHandler(errorOrNil);
+    }];
+}
+
+
 /*
  Interesting delegate protocols are NSTextDelegate or its sub protocol NSTextViewDelegate i.e. for
  - grammar and spell checking for assembler nmemonics
@@ -234,7 +315,7 @@
 
 + (NSSet<NSString *> *)keyPathsForValuesAffectingGeneratedLogMessage
 {
-    return [NSSet setWithObjects:NSStringFromSelector(@selector(shouldShowWarningsInLog)), NSStringFromSelector(@selector(shouldShowErrorsInLog)), NSStringFromSelector(@selector(shouldShowLog)), NSStringFromSelector(@selector(generatorMessages)), NSStringFromSelector(@selector(lineNumberDigits)), nil];
+    return [NSSet setWithObjects:NSStringFromSelector(@selector(shouldShowWarningsInLog)), NSStringFromSelector(@selector(shouldShowErrorsInLog)), NSStringFromSelector(@selector(shouldShowLog)), NSStringFromSelector(@selector(generatorMessages)), NSStringFromSelector(@selector(lineNumberDigits)), NSStringFromSelector(@selector(outputWriteSummary)), nil];
 }
 
 
@@ -289,6 +370,37 @@
             [formattedlogEntry appendAttributedString:[[NSAttributedString alloc] initWithString:[NSString stringWithFormat:@" - %@", codeLine] attributes:fontAttributeMonaco]];
         }
 
+        /* Aggregated messages are logged once with the number of all messages of the group and links to their first lines */
+        NSMutableAttributedString *groupEntry = nil;
+        NSNumber *groupCount = (NSNumber *)[obj valueForKey:XDTMessageCount];
+        if (nil != groupCount && 1 < [groupCount unsignedIntegerValue]) {
+            groupEntry = [[NSMutableAttributedString alloc] initWithString:[NSString stringWithFormat:NSLocalizedString(@"(%lu times", @"Log entry of an aggregated message, with the number of messages of its group"), [groupCount unsignedIntegerValue]]];
+            NSString *separator = NSLocalizedString(@", also in line ", @"Log entry of an aggregated message, introducing the further line numbers of its group");
+            NSArray<NSDictionary<XDTMessageTypeKey, id> *> *locations = [obj valueForKey:XDTMessageLocations];
+            for (NSUInteger locationIndex = 1; locationIndex < locations.count; locationIndex++) {
+                NSDictionary<XDTMessageTypeKey, id> *location = [locations objectAtIndex:locationIndex];
+                NSNumber *locationLine = [location objectForKey:XDTMessageLineNumber];
+                if (nil == locationLine || [[NSNull null] isEqualTo:locationLine]) {
+                    continue;
+                }
+                NSString *locationFileName = [(NSURL *)[location objectForKey:XDTMessageFileURL] lastPathComponent];
+                if (nil == locationFileName) {
+                    locationFileName = fileName;
+                }
+                NSURLComponents *urlComponents = [NSURLComponents new];
+                [urlComponents setScheme:@"xdt99"];
+                [urlComponents setPath:[@"/" stringByAppendingString:locationFileName]];
+                [urlComponents setQueryItems:@[[NSURLQueryItem queryItemWithName:@"line" value:[locationLine stringValue]]]];
+                [groupEntry appendAttributedString:[[NSAttributedString alloc] initWithString:separator]];
+                [groupEntry appendAttributedString:[[NSAttributedString alloc] initWithString:[locationLine stringValue] attributes:@{NSLinkAttributeName: [urlComponents URL]}]];
+                separator = @", ";
+            }
+            if (locations.count < [groupCount unsignedIntegerValue]) {
+                [groupEntry appendAttributedString:[[NSAttributedString alloc] initWithString:@", …"]];
+            }
+            [groupEntry appendAttributedString:[[NSAttributedString alloc] initWithString:@")\n"]];
+        }
+
         NSString *messageText = (NSString *)[obj valueForKey:XDTMessageText];
         switch (messageType) {
             case XDTMessageTypeError:
@@ -298,6 +410,9 @@
                         messageText = [messageText substringFromIndex:NSMaxRange(prefixRange)];
                     }
                     [formattedlogEntry appendAttributedString:[[NSAttributedString alloc] initWithString:[NSString stringWithFormat:@"\nError: %@\n", messageText]]];
+                    if (nil != groupEntry) {
+                        [formattedlogEntry appendAttributedString:groupEntry];
+                    }
                     [formattedlogEntry addAttribute:NSForegroundColorAttributeName value:errorForeColor range:NSMakeRange(0, formattedlogEntry.length)];
                     [retVal appendAttributedString:formattedlogEntry];
                 }
@@ -310,6 +425,9 @@
                         messageText = [messageText substringFromIndex:NSMaxRange(prefixRange)];
                     }
                     [formattedlogEntry appendAttributedString:[[NSAttributedString alloc] initWithString:[NSString stringWithFormat:@"\nWarning: %@\n", messageText]]];
+                    if (nil != groupEntry) {
+                        [formattedlogEntry appendAttributedString:groupEntry];
+                    }
 
                     [formattedlogEntry addAttribute:NSForegroundColorAttributeName value:warningForeColor range:NSMakeRange(0, formattedlogEntry.length)];
                     [retVal appendAttributedString:formattedlogEntry];
@@ -322,10 +440,43 @@
         }
     }];
 
+    if (nil != _outputWriteSummary) {
+        NSString *summaryLine = (0 < retVal.length)? [NSString stringWithFormat:@"\n%@\n", _outputWriteSummary] : [_outputWriteSummary stringByAppendingString:@"\n"];
+        [retVal appendAttributedString:[[NSAttributedString alloc] initWithString:summaryLine attributes:@{NSForegroundColorAttributeName: [NSColor systemGrayColor]}]];
+    }
+
     return retVal;
 }
 
 
++ (NSSet *)keyPathsForValuesAffectingIsOutputDiskImage
+{
+    return [NSSet setWithObject:NSStringFromSelector(@selector(outputFileName))];
+}
+
+
+- (BOOL)isOutputDiskImage
+{
+    return NSOrderedSame == [@"dsk" caseInsensitiveCompare:[[self outputFileName] pathExtension]];
+}
+
+
+/* The name of the document in capitals, cut to the 10 characters of a TI file name */
+- (NSString *)diskFileName
+{
+    NSString *documentName = [[[[self fileURL] lastPathComponent] stringByDeletingPathExtension] uppercaseString];
+    NSString *retVal = [[documentName componentsSeparatedByCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@". "]] componentsJoinedByString:@""];
+    return (10 < [retVal length])? [retVal substringToIndex:10] : retVal;
+}
+
+
+/* This method should be overridden from specialized class */
+- (SyntaxHighlighterLanguage)syntaxHighlighterLanguage
+{
+    return SyntaxHighlighterLanguageNone;
+}
+
+
 + (NSSet *)keyPathsForValuesAffectingHasLogContentToSave
 {
     return [NSSet setWithObject:@"logView.string"];
@@ -392,6 +543,63 @@
 }
 
 
+/* This method should be overridden from specialized class */
+- (NSDictionary<NSString *, id> *)buildOptions
+{
+    return nil;
+}
+
+
+- (NSURL *)buildSourceURL
+{
+    return [self fileURL];
+}
+
+
+#pragma mark - Build Methods
+
+
+/* This method should be overridden from specialized class, it is called on any thread */
+- (DocumentBuild *)buildSourceCode:(NSString *)sourceCode fileURL:(NSURL *)fileURL includeURL:(NSURL *)includeURL options:(NSDictionary<NSString *, id> *)options fingerprint:(NSData *)fingerprint
+{
+    return nil;
+}
+
+
+- (void)applyBuild:(DocumentBuild *)build
+{
+    [self setCurrentBuild:build];
+    [self setGeneratorMessages:build.messages];
+}
+
+
+/* This method could be overridden from specialized class, when results may not be usable for generating */
+- (BOOL)canReuseBuild:(DocumentBuild *)build forGenerating:(BOOL)isGenerating
+{
+    return YES;
+}
+
+
+/* The latest build if nothing has changed since, otherwise the document is built now */
+- (DocumentBuild *)latestBuildForGenerating:(BOOL)isGenerating
+{
+    NSDictionary<NSString *, id> *options = [self buildOptions];
+    if (nil == options) {
+        return nil;
+    }
+
+    NSData *fingerprint = [DocumentBuild fingerprintOfSourceCode:[self sourceCode] fileURL:[self buildSourceURL] options:options];
+    if (nil != fingerprint && [fingerprint isEqualToData:[_currentBuild fingerprint]] && [self canReuseBuild:_currentBuild forGenerating:isGenerating]) {
+        return _currentBuild;
+    }
+    DocumentBuild *retVal = [self buildSourceCode:[self sourceCode] fileURL:[self fileURL] includeURL:[self fileURL] options:options fingerprint:fingerprint];
+    if (nil != retVal) {
+        [self applyBuild:retVal];
+    }
+    return retVal;
+}
+
+
 #pragma mark - Action Methods
 
 
@@ -448,6 +656,17 @@
 }
 
 
+/* Opens the disk image of the output file to update it, or creates a new one if it does not exist yet */
+- (XDTDiskImage *)outputDiskImage:(NSError **)error
+{
+    NSURL *diskImageURL = [NSURL fileURLWithPath:[self outputFileName] relativeToURL:[self outputBasePathURL]];
+    if ([diskImageURL checkResourceIsReachableAndReturnError:nil]) {
+        return [XDTDiskImage diskImageWithContentsOfURL:diskImageURL error:error];
+    }
+    return [XDTDiskImage diskImageWithVolumeName:[[[self outputFileName] stringByDeletingPathExtension] uppercaseString] format:XDTDiskFormatDSSD];
+}
+
+
 - (void)hideShowLog:(id)sender
 {
     [self setShouldShowLog:[sender state] == NSOnState];
@@ -0,0 +1,59 @@
+//
+//  SyntaxHighlighter.h
+//  SimpleXDT99IDE
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  SimpleXDT99IDE a simple IDE based on xdt99 that shows how to use the XDTools99.framework
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Cocoa/Cocoa.h>
+
+
+typedef NS_ENUM(NSUInteger, SyntaxHighlighterLanguage) {
+    SyntaxHighlighterLanguageNone,
+    SyntaxHighlighterLanguageAssembler,     /* TMS9900 assembler as used by xas99 */
+    SyntaxHighlighterLanguageGPLNative,     /* GPL in the xdt99 (and RAG) syntax of xga99 */
+    SyntaxHighlighterLanguageGPLMizapf,     /* GPL in the TI Image Tool syntax of xga99 */
+    SyntaxHighlighterLanguageBasic,         /* TI (Extended) BASIC as used by xbas99 */
+};
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Highlights the source code of a text view with an incremental lexer.
+
+ The highlighter keeps the lexer state at the start and the end of every line. After an edit only the damaged lines
+ are lexed again, followed by the subsequent lines until the lexer state at a line end matches the state that was
+ stored before. The colors are set as temporary attributes of the layout manager and only for the visible range of
+ the text view, so neither the text storage nor the undo manager are touched.
+ */
+@interface SyntaxHighlighter : NSObject
+
+@property (nonatomic, assign) SyntaxHighlighterLanguage language;
+@property (readonly) NSUInteger numberOfLines;
+@property (readonly) NSUInteger numberOfLexedLines;    /* lines lexed since the highlighter was created, useful for checking the incremental behaviour */
+
+- (instancetype)initWithTextView:(NSTextView *)textView language:(SyntaxHighlighterLanguage)language;
+
+- (void)invalidate;     /* stops observing the text view, has to be called before the text view goes away */
+
+@end
+
+NS_ASSUME_NONNULL_END
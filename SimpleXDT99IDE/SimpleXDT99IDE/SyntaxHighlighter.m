@@ -0,0 +1,808 @@
+//
+//  SyntaxHighlighter.m
+//  SimpleXDT99IDE
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  SimpleXDT99IDE a simple IDE based on xdt99 that shows how to use the XDTools99.framework
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "SyntaxHighlighter.h"
+
+
+#define SyntaxMaxWordLength 24
+
+/* Lexer states at the end of a line */
+#define SyntaxStateInitial 0
+#define SyntaxStateAssemblerMacroDefinition 0x01    /* between .DEFM and .ENDM */
+#define SyntaxStateGPLFormatDepthMask 0xFF          /* nesting of FMT and its repeat blocks */
+
+
+typedef NS_ENUM(uint8_t, SyntaxTokenKind) {
+    SyntaxTokenKindComment,
+    SyntaxTokenKindLabel,
+    SyntaxTokenKindMnemonic,
+    SyntaxTokenKindDirective,
+    SyntaxTokenKindRegister,
+    SyntaxTokenKindNumber,
+    SyntaxTokenKindString,
+    SyntaxTokenKindKeyword,
+    SyntaxTokenKindLineNumber,
+    SyntaxTokenKindCount
+};
+
+typedef struct {
+    uint32_t start;     /* relative to the start of the line */
+    uint32_t length;
+    SyntaxTokenKind kind;
+} SyntaxToken;
+
+typedef struct {
+    SyntaxToken *tokens;
+    NSUInteger count;
+    NSUInteger capacity;
+} SyntaxTokenBuffer;
+
+typedef struct {
+    NSUInteger location;
+    NSUInteger length;      /* including the line terminator */
+    uint32_t startState;
+    uint32_t endState;
+    SyntaxToken *tokens;
+    uint32_t tokenCount;
+    BOOL isLexed;
+    BOOL isColored;
+} SyntaxLine;
+
+
+#pragma mark - Keyword Tables
+
+
+static const char *SyntaxAssemblerMnemonics[] = {
+    "A", "AB", "ABS", "AI", "ANDI", "B", "BL", "BLWP", "C", "CB", "CI", "CKOF", "CKON", "CLR", "COC", "CZC", "DEC",
+    "DECT", "DIV", "IDLE", "INC", "INCT", "INV", "JEQ", "JGT", "JH", "JHE", "JL", "JLE", "JLT", "JMP", "JNC", "JNE",
+    "JNO", "JOC", "JOP", "LDCR", "LI", "LIMI", "LREX", "LWPI", "MOV", "MOVB", "MPY", "NEG", "NOP", "ORI", "RSET", "RT",
+    "RTWP", "S", "SB", "SBO", "SBZ", "SETO", "SLA", "SOC", "SOCB", "SRA", "SRC", "SRL", "STCR", "STST", "STWP", "SWPB",
+    "SZC", "SZCB", "TB", "X", "XOP", "XOR"
+};
+
+static const char *SyntaxAssemblerDirectives[] = {
+    "AORG", "BCOPY", "BES", "BSS", "BYTE", "CEND", "COPY", "CSEG", "DATA", "DEF", "DEND", "DORG", "DSEG", "DXOP", "END",
+    "EQU", "EVEN", "IDT", "LIST", "LOAD", "PAGE", "PEND", "PSEG", "REF", "RORG", "SAVE", "SREF", "TEXT", "TITL", "UNL",
+    "XORG"
+};
+
+static const char *SyntaxAssemblerNoOperands[] = {
+    ".ELSE", ".ENDIF", ".ENDM", "CEND", "CKOF", "CKON", "DEND", "EVEN", "IDLE", "LIST", "LREX", "NOP", "PAGE", "PEND",
+    "RSET", "RT", "RTWP", "UNL"
+};
+
+static const char *SyntaxGPLMnemonics[] = {
+    "ABS", "ADD", "ALL", "AND", "B", "BACK", "BR", "BS", "CALL", "CARRY", "CASE", "CEQ", "CGE", "CGT", "CH", "CHE",
+    "CLOG", "CLR", "COINC", "CONT", "CZ", "DABS", "DADD", "DAND", "DCASE", "DCEQ", "DCGE", "DCGT", "DCH", "DCHE",
+    "DCLOG", "DCLR", "DCOINC", "DCZ", "DDEC", "DDECT", "DDIV", "DEC", "DECT", "DEX", "DINC", "DINCT", "DINV", "DIV",
+    "DMUL", "DNEG", "DOR", "DSLL", "DSRA", "DSRC", "DSRL", "DST", "DSUB", "DSWGR", "DXOR", "EX", "EXEC", "EXIT", "FETCH",
+    "FMT", "GT", "H", "I/O", "INC", "INCT", "INV", "MOVE", "MUL", "NEG", "OR", "OVF", "PARSE", "PUSH", "RAND", "RB",
+    "RTGR", "RTN", "RTNB", "RTNC", "SB", "SCAN", "SLL", "SRA", "SRC", "SRL", "ST", "SUB", "SWGR", "TBR", "XML", "XOR"
+};
+
+static const char *SyntaxGPLDirectives[] = {
+    "AORG", "BSS", "BYTE", "COPY", "DATA", "END", "EQU", "EVEN", "FLOAT", "GROM", "IDT", "LIST", "PAGE", "STRI", "TEXT",
+    "TITL", "TITLE", "UNL"
+};
+
+static const char *SyntaxGPLNoOperands[] = {
+    "CARRY", "CONT", "EXEC", "EXIT", "FEND", "FMT", "GT", "H", "OVF", "RTGR", "RTN", "RTNB", "RTNC", "SCAN"
+};
+
+/* FMT sub language, the long names are used by the TI Image Tool syntax */
+static const char *SyntaxGPLFormatMnemonics[] = {
+    "BIAS", "COL", "COL+", "FEND", "FOR", "HCHA", "HCHAR", "HMOVE", "HSTR", "HTEX", "HTEXT", "ROW", "ROW+", "RPT",
+    "SCRO", "VCHA", "VCHAR", "VMOVE", "VTEX", "VTEXT", "XGPL"
+};
+
+/* Operand keywords of the TI Image Tool syntax */
+static const char *SyntaxGPLMizapfKeywords[] = {
+    "BYTES", "FROM", "GROM", "TO", "VDP", "VREG"
+};
+
+static const char *SyntaxBasicKeywords[] = {
+    "ABS", "ACCEPT", "ALL", "AND", "APPEND", "ASC", "AT", "ATN", "BASE", "BEEP", "BREAK", "BYE", "CALL", "CHR$", "CLOSE",
+    "CON", "CONTINUE", "COS", "DATA", "DEF", "DELETE", "DIGIT", "DIM", "DISPLAY", "ELSE", "END", "EOF", "ERASE",
+    "ERROR", "EXP", "FIXED", "FOR", "GO", "GOSUB", "GOTO", "IF", "IMAGE", "INPUT", "INT", "INTERNAL", "LEN", "LET",
+    "LINPUT", "LIST", "LOG", "MAX", "MERGE", "MIN", "NEXT", "NOT", "NUM", "NUMBER", "NUMERIC", "OLD", "ON", "OPEN",
+    "OPTION", "OR", "OUTPUT", "PERMANENT", "PI", "POS", "PRINT", "RANDOMIZE", "READ", "REC", "RELATIVE", "REM", "RES",
+    "RESEQUENCE", "RESTORE", "RETURN", "RND", "RPT$", "RUN", "SAVE", "SEG$", "SEQUENTIAL", "SGN", "SIN", "SIZE", "SQR",
+    "STEP", "STOP", "STR$", "SUB", "SUBEND", "SUBEXIT", "TAB", "TAN", "THEN", "TO", "TRACE", "UALPHA", "UNBREAK",
+    "UNTRACE", "UPDATE", "USING", "VAL", "VALIDATE", "VARIABLE", "WARNING", "XOR"
+};
+
+#define SyntaxTableCount(table) (sizeof(table) / sizeof(table[0]))
+
+
+static int SyntaxCompareStrings(const void *string1, const void *string2)
+{
+    return strcmp(*(const char * const *)string1, *(const char * const *)string2);
+}
+
+
+static BOOL SyntaxTableContains(const char **table, size_t count, const char *word)
+{
+    return NULL != bsearch(&word, table, count, sizeof(const char *), SyntaxCompareStrings);
+}
+
+
+#pragma mark - Lexers
+
+
+static inline BOOL SyntaxIsBlank(unichar c)
+{
+    return ' ' == c || '\t' == c;
+}
+
+
+static inline BOOL SyntaxIsDigit(unichar c)
+{
+    return '0' <= c && c <= '9';
+}
+
+
+static inline BOOL SyntaxIsHexDigit(unichar c)
+{
+    return SyntaxIsDigit(c) || ('A' <= c && c <= 'F') || ('a' <= c && c <= 'f');
+}
+
+
+static inline BOOL SyntaxIsLetter(unichar c)
+{
+    return ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z') || '_' == c;
+}
+
+
+static void SyntaxAddToken(SyntaxTokenBuffer *buffer, NSUInteger start, NSUInteger length, SyntaxTokenKind kind)
+{
+    if (0 == length) {
+        return;
+    }
+    if (buffer->count == buffer->capacity) {
+        buffer->capacity = (0 == buffer->capacity)? 16 : 2 * buffer->capacity;
+        buffer->tokens = reallocf(buffer->tokens, buffer->capacity * sizeof(SyntaxToken));
+        if (NULL == buffer->tokens) {
+            buffer->count = buffer->capacity = 0;
+            return;
+        }
+    }
+    SyntaxToken *token = &buffer->tokens[buffer->count++];
+    token->start = (uint32_t)start;
+    token->length = (uint32_t)length;
+    token->kind = kind;
+}
+
+
+/* Copies the word in upper case into the buffer, returns NO if it is too long for any keyword */
+static BOOL SyntaxUpperWord(const unichar *chars, NSUInteger start, NSUInteger end, char *word)
+{
+    if (SyntaxMaxWordLength <= end - start) {
+        return NO;
+    }
+    for (NSUInteger i = start; i < end; i++) {
+        unichar c = chars[i];
+        if (127 < c) {
+            return NO;
+        }
+        word[i - start] = (char)toupper(c);
+    }
+    word[end - start] = '\0';
+    return YES;
+}
+
+
+static NSUInteger SyntaxSkipBlanks(const unichar *chars, NSUInteger i, NSUInteger length)
+{
+    while (i < length && SyntaxIsBlank(chars[i])) {
+        i++;
+    }
+    return i;
+}
+
+
+/* Lexes the operand field of assembler and GPL sources, returns the index behind the field */
+static NSUInteger SyntaxLexOperands(SyntaxHighlighterLanguage language, const unichar *chars, NSUInteger i, NSUInteger length, SyntaxTokenBuffer *tokens)
+{
+    BOOL isGPL = SyntaxHighlighterLanguageAssembler != language;
+    /* operands of the TI Image Tool syntax are separated by blanks, so only a semicolon starts a comment */
+    BOOL hasBlankOperands = SyntaxHighlighterLanguageGPLMizapf == language;
+    char word[SyntaxMaxWordLength];
+    while (i < length && (hasBlankOperands || !SyntaxIsBlank(chars[i]))) {
+        unichar c = chars[i];
+        NSUInteger start = i;
+        if (';' == c) {
+            break;
+        }
+        if (SyntaxIsBlank(c)) {
+            i++;
+            continue;
+        }
+        if ('\'' == c || (isGPL && '"' == c)) {
+            /* a quote within a string is written twice */
+            for (i++; i < length; i++) {
+                if (c == chars[i]) {
+                    if (i + 1 < length && c == chars[i + 1]) {
+                        i++;
+                    } else {
+                        i++;
+                        break;
+                    }
+                }
+            }
+            SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindString);
+        } else if ('>' == c && i + 1 < length && SyntaxIsHexDigit(chars[i + 1])) {
+            for (i++; i < length && SyntaxIsHexDigit(chars[i]); i++);
+            SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindNumber);
+        } else if (':' == c && i + 1 < length && ('0' == chars[i + 1] || '1' == chars[i + 1])) {
+            for (i++; i < length && ('0' == chars[i] || '1' == chars[i]); i++);
+            SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindNumber);
+        } else if (SyntaxIsDigit(c)) {
+            for (i++; i < length && SyntaxIsDigit(chars[i]); i++);
+            SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindNumber);
+        } else if (SyntaxIsLetter(c) || '!' == c || '$' == c) {
+            for (i++; i < length && (SyntaxIsLetter(chars[i]) || SyntaxIsDigit(chars[i]) || '!' == chars[i] || '$' == chars[i] || '.' == chars[i]); i++);
+            if (!SyntaxUpperWord(chars, start, i, word)) {
+                continue;
+            }
+            if (!isGPL && 'R' == word[0] && SyntaxIsDigit((unichar)word[1]) && ('\0' == word[2] || (SyntaxIsDigit((unichar)word[2]) && '\0' == word[3]))) {
+                if (atoi(word + 1) < 16) {
+                    SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindRegister);
+                }
+            } else if (SyntaxHighlighterLanguageGPLMizapf == language &&
+                       SyntaxTableContains(SyntaxGPLMizapfKeywords, SyntaxTableCount(SyntaxGPLMizapfKeywords), word)) {
+                SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindKeyword);
+            }
+        } else {
+            i++;
+        }
+    }
+    return i;
+}
+
+
+/* Lexer for xas99 and xga99 sources: [label] mnemonic [operands] [comment] */
+static uint32_t SyntaxLexAssemblerLine(SyntaxHighlighterLanguage language, const unichar *chars, NSUInteger length, uint32_t state, SyntaxTokenBuffer *tokens)
+{
+    BOOL isGPL = SyntaxHighlighterLanguageAssembler != language;
+    if (0 == length) {
+        return state;
+    }
+    if ('*' == chars[0] || ';' == chars[0]) {
+        SyntaxAddToken(tokens, 0, length, SyntaxTokenKindComment);
+        return state;
+    }
+
+    NSUInteger i = 0;
+    if (!SyntaxIsBlank(chars[0])) {
+        while (i < length && !SyntaxIsBlank(chars[i])) {
+            i++;
+        }
+        SyntaxAddToken(tokens, 0, i, SyntaxTokenKindLabel);
+    }
+    i = SyntaxSkipBlanks(chars, i, length);
+    if (i < length && ';' == chars[i]) {
+        SyntaxAddToken(tokens, i, length - i, SyntaxTokenKindComment);
+        return state;
+    }
+
+    NSUInteger start = i;
+    while (i < length && !SyntaxIsBlank(chars[i])) {
+        i++;
+    }
+    if (start == i) {
+        return state;
+    }
+    char word[SyntaxMaxWordLength];
+    BOOL isKnownWord = SyntaxUpperWord(chars, start, i, word);
+    SyntaxTokenKind kind = SyntaxTokenKindCount;
+    BOOL hasNoOperands = NO;
+    if (!isKnownWord) {
+        /* a macro call or an unknown mnemonic */
+    } else if (!isGPL) {
+        if (SyntaxTableContains(SyntaxAssemblerMnemonics, SyntaxTableCount(SyntaxAssemblerMnemonics), word)) {
+            kind = SyntaxTokenKindMnemonic;
+        } else if ('.' == word[0] || SyntaxTableContains(SyntaxAssemblerDirectives, SyntaxTableCount(SyntaxAssemblerDirectives), word)) {
+            kind = SyntaxTokenKindDirective;
+        }
+        hasNoOperands = SyntaxTableContains(SyntaxAssemblerNoOperands, SyntaxTableCount(SyntaxAssemblerNoOperands), word);
+        if (0 == strcmp(word, ".DEFM")) {
+            state |= SyntaxStateAssemblerMacroDefinition;
+        } else if (0 == strcmp(word, ".ENDM")) {
+            state &= ~SyntaxStateAssemblerMacroDefinition;
+        }
+    } else {
+        uint32_t depth = state & SyntaxStateGPLFormatDepthMask;
+        if (0 < depth && SyntaxTableContains(SyntaxGPLFormatMnemonics, SyntaxTableCount(SyntaxGPLFormatMnemonics), word)) {
+            kind = SyntaxTokenKindMnemonic;
+            if (0 == strcmp(word, "RPT") || 0 == strcmp(word, "FOR")) {
+                depth = MIN(depth + 1, SyntaxStateGPLFormatDepthMask);
+            } else if (0 == strcmp(word, "FEND")) {
+                depth--;
+                hasNoOperands = YES;
+            }
+        } else if (SyntaxTableContains(SyntaxGPLMnemonics, SyntaxTableCount(SyntaxGPLMnemonics), word)) {
+            kind = SyntaxTokenKindMnemonic;
+            hasNoOperands = SyntaxTableContains(SyntaxGPLNoOperands, SyntaxTableCount(SyntaxGPLNoOperands), word);
+            if (0 == strcmp(word, "FMT")) {
+                depth = 1;
+            }
+        } else if (SyntaxTableContains(SyntaxGPLDirectives, SyntaxTableCount(SyntaxGPLDirectives), word)) {
+            kind = SyntaxTokenKindDirective;
+        }
+        state = (state & ~SyntaxStateGPLFormatDepthMask) | depth;
+    }
+    if (SyntaxTokenKindCount != kind) {
+        SyntaxAddToken(tokens, start, i - start, kind);
+    }
+
+    i = SyntaxSkipBlanks(chars, i, length);
+    if (!hasNoOperands) {
+        i = SyntaxLexOperands(language, chars, i, length, tokens);
+        i = SyntaxSkipBlanks(chars, i, length);
+    }
+    if (i < length) {
+        SyntaxAddToken(tokens, i, length - i, SyntaxTokenKindComment);
+    }
+    return state;
+}
+
+
+/* Lexer for xbas99 sources: line number followed by statements */
+static uint32_t SyntaxLexBasicLine(const unichar *chars, NSUInteger length, uint32_t state, SyntaxTokenBuffer *tokens)
+{
+    NSUInteger i = SyntaxSkipBlanks(chars, 0, length);
+    NSUInteger start = i;
+    while (i < length && SyntaxIsDigit(chars[i])) {
+        i++;
+    }
+    SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindLineNumber);
+
+    char word[SyntaxMaxWordLength];
+    while (i < length) {
+        unichar c = chars[i];
+        start = i;
+        if ('"' == c) {
+            for (i++; i < length; i++) {
+                if ('"' == chars[i]) {
+                    if (i + 1 < length && '"' == chars[i + 1]) {
+                        i++;
+                    } else {
+                        i++;
+                        break;
+                    }
+                }
+            }
+            SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindString);
+        } else if (SyntaxIsDigit(c) || ('.' == c && i + 1 < length && SyntaxIsDigit(chars[i + 1]))) {
+            for (i++; i < length && (SyntaxIsDigit(chars[i]) || '.' == chars[i]); i++);
+            if (i < length && ('E' == chars[i] || 'e' == chars[i])) {
+                i++;
+                if (i < length && ('+' == chars[i] || '-' == chars[i])) {
+                    i++;
+                }
+                for (; i < length && SyntaxIsDigit(chars[i]); i++);
+            }
+            SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindNumber);
+        } else if (SyntaxIsLetter(c)) {
+            for (i++; i < length && (SyntaxIsLetter(chars[i]) || SyntaxIsDigit(chars[i]) || '@' == chars[i]); i++);
+            if (i < length && '$' == chars[i]) {
+                i++;
+            }
+            if (SyntaxUpperWord(chars, start, i, word) && SyntaxTableContains(SyntaxBasicKeywords, SyntaxTableCount(SyntaxBasicKeywords), word)) {
+                SyntaxAddToken(tokens, start, i - start, SyntaxTokenKindKeyword);
+                if (0 == strcmp(word, "REM")) {
+                    SyntaxAddToken(tokens, i, length - i, SyntaxTokenKindComment);
+                    break;
+                }
+            }
+        } else if ('!' == c) {
+            /* tail comment of Extended BASIC */
+            SyntaxAddToken(tokens, i, length - i, SyntaxTokenKindComment);
+            break;
+        } else {
+            i++;
+        }
+    }
+    return state;
+}
+
+
+static uint32_t SyntaxLexLine(SyntaxHighlighterLanguage language, const unichar *chars, NSUInteger length, uint32_t state, SyntaxTokenBuffer *tokens)
+{
+    tokens->count = 0;
+    switch (language) {
+        case SyntaxHighlighterLanguageAssembler:
+        case SyntaxHighlighterLanguageGPLNative:
+        case SyntaxHighlighterLanguageGPLMizapf:
+            return SyntaxLexAssemblerLine(language, chars, length, state, tokens);
+        case SyntaxHighlighterLanguageBasic:
+            return SyntaxLexBasicLine(chars, length, state, tokens);
+        default:
+            return state;
+    }
+}
+
+
+static NSColor *SyntaxColorForTokenKind(SyntaxTokenKind kind)
+{
+    static NSArray<NSColor *> *colors = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        colors = @[
+                   [NSColor systemGreenColor],      /* comment */
+                   [NSColor systemBrownColor],      /* label */
+                   [NSColor systemBlueColor],       /* mnemonic */
+                   [NSColor systemPurpleColor],     /* directive */
+                   [NSColor systemOrangeColor],     /* register */
+                   [NSColor systemPinkColor],       /* number */
+                   [NSColor systemRedColor],        /* string */
+                   [NSColor systemBlueColor],       /* keyword */
+                   [NSColor systemGrayColor],       /* line number */
+                   ];
+#if !__has_feature(objc_arc)
+        [colors retain];
+#endif
+    });
+    return [colors objectAtIndex:kind];
+}
+
+
+#pragma mark -
+
+
+@interface SyntaxHighlighter () {
+    __unsafe_unretained NSTextView *_textView;  /* NSTextView does not support weak references */
+    SyntaxLine *_lines;
+    NSUInteger _lineCapacity;
+    SyntaxTokenBuffer _tokenBuffer;
+    unichar *_characterBuffer;
+    NSUInteger _characterBufferLength;
+}
+
+@property (readwrite) NSUInteger numberOfLines;
+@property (readwrite) NSUInteger numberOfLexedLines;
+
+- (void)textStorageDidProcessEditing:(NSNotification *)notification;
+- (void)visibleRectDidChange:(NSNotification *)notification;
+
+@end
+
+
+@implementation SyntaxHighlighter
+
++ (void)initialize
+{
+    if (self != [SyntaxHighlighter class]) {
+        return;
+    }
+    /* The keyword tables are searched binary, so they must be sorted by the same function. */
+    qsort(SyntaxAssemblerMnemonics, SyntaxTableCount(SyntaxAssemblerMnemonics), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxAssemblerDirectives, SyntaxTableCount(SyntaxAssemblerDirectives), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxAssemblerNoOperands, SyntaxTableCount(SyntaxAssemblerNoOperands), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxGPLMnemonics, SyntaxTableCount(SyntaxGPLMnemonics), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxGPLDirectives, SyntaxTableCount(SyntaxGPLDirectives), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxGPLNoOperands, SyntaxTableCount(SyntaxGPLNoOperands), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxGPLFormatMnemonics, SyntaxTableCount(SyntaxGPLFormatMnemonics), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxGPLMizapfKeywords, SyntaxTableCount(SyntaxGPLMizapfKeywords), sizeof(const char *), SyntaxCompareStrings);
+    qsort(SyntaxBasicKeywords, SyntaxTableCount(SyntaxBasicKeywords), sizeof(const char *), SyntaxCompareStrings);
+}
+
+
+- (instancetype)initWithTextView:(NSTextView *)textView language:(SyntaxHighlighterLanguage)language
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _textView = textView;
+    _language = language;
+    _lines = NULL;
+    _numberOfLines = 0;
+    _numberOfLexedLines = 0;
+
+    NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+    [center addObserver:self selector:@selector(textStorageDidProcessEditing:) name:NSTextStorageDidProcessEditingNotification object:[textView textStorage]];
+    NSClipView *clipView = [[textView enclosingScrollView] contentView];
+    if (nil != clipView) {
+        [clipView setPostsBoundsChangedNotifications:YES];
+        [center addObserver:self selector:@selector(visibleRectDidChange:) name:NSViewBoundsDidChangeNotification object:clipView];
+    }
+    [textView setPostsFrameChangedNotifications:YES];
+    [center addObserver:self selector:@selector(visibleRectDidChange:) name:NSViewFrameDidChangeNotification object:textView];
+
+    [self relexAllLines];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [NSObject cancelPreviousPerformRequestsWithTarget:self];
+    [self removeLinesInRange:NSMakeRange(0, _numberOfLines)];
+    free(_lines);
+    free(_tokenBuffer.tokens);
+    free(_characterBuffer);
+#if !__has_feature(objc_arc)
+    [super dealloc];
+#endif
+}
+
+
+- (void)invalidate
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [NSObject cancelPreviousPerformRequestsWithTarget:self];
+    NSTextView *textView = _textView;
+    NSLayoutManager *layoutManager = [textView layoutManager];
+    [layoutManager removeTemporaryAttribute:NSForegroundColorAttributeName forCharacterRange:NSMakeRange(0, [[textView textStorage] length])];
+    _textView = nil;
+}
+
+
+- (void)setLanguage:(SyntaxHighlighterLanguage)language
+{
+    if (language == _language) {
+        return;
+    }
+    _language = language;
+    [self relexAllLines];
+}
+
+
+#pragma mark - Line Table
+
+
+- (void)removeLinesInRange:(NSRange)range
+{
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+        free(_lines[i].tokens);
+    }
+    memmove(_lines + range.location, _lines + NSMaxRange(range), (_numberOfLines - NSMaxRange(range)) * sizeof(SyntaxLine));
+    _numberOfLines -= range.length;
+}
+
+
+- (BOOL)insertLines:(const SyntaxLine *)lines count:(NSUInteger)count atIndex:(NSUInteger)index
+{
+    if (_lineCapacity < _numberOfLines + count) {
+        NSUInteger newCapacity = MAX(2 * _lineCapacity, _numberOfLines + count);
+        SyntaxLine *newLines = realloc(_lines, newCapacity * sizeof(SyntaxLine));
+        if (NULL == newLines) {
+            return NO;
+        }
+        _lines = newLines;
+        _lineCapacity = newCapacity;
+    }
+    memmove(_lines + index + count, _lines + index, (_numberOfLines - index) * sizeof(SyntaxLine));
+    memcpy(_lines + index, lines, count * sizeof(SyntaxLine));
+    _numberOfLines += count;
+    return YES;
+}
+
+
+/* Returns the index of the line that contains the character location */
+- (NSUInteger)lineIndexForLocation:(NSUInteger)location
+{
+    NSUInteger low = 0, high = _numberOfLines;
+    while (low < high) {
+        NSUInteger middle = (low + high) / 2;
+        if (_lines[middle].location <= location) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return (0 < low)? low - 1 : 0;
+}
+
+
+/* Splits the characters of the range into new (unlexed) lines, the last line of the text may be empty */
+- (NSMutableData *)linesOfString:(NSString *)text inRange:(NSRange)range isEndOfText:(BOOL)isEndOfText
+{
+    NSMutableData *retVal = [NSMutableData data];
+    SyntaxLine line;
+    memset(&line, 0, sizeof(line));
+    NSUInteger location = range.location;
+    while (location < NSMaxRange(range)) {
+        NSUInteger lineEnd = 0;
+        [text getLineStart:NULL end:&lineEnd contentsEnd:NULL forRange:NSMakeRange(location, 0)];
+        line.location = location;
+        line.length = MIN(lineEnd, NSMaxRange(range)) - location;
+        [retVal appendBytes:&line length:sizeof(line)];
+        location += line.length;
+    }
+    if (isEndOfText) {
+        NSUInteger textLength = [text length];
+        NSUInteger contentsEnd = textLength;
+        if (0 < textLength) {
+            [text getLineStart:NULL end:NULL contentsEnd:&contentsEnd forRange:NSMakeRange(textLength - 1, 0)];
+        }
+        if (0 == textLength || contentsEnd < textLength) {
+            /* the text ends with a line terminator, so there is an empty last line */
+            line.location = textLength;
+            line.length = 0;
+            [retVal appendBytes:&line length:sizeof(line)];
+        }
+    }
+    return retVal;
+}
+
+
+- (void)relexAllLines
+{
+    [self removeLinesInRange:NSMakeRange(0, _numberOfLines)];
+    NSString *text = [[_textView textStorage] string];
+    if (nil == text) {
+        return;
+    }
+    NSData *newLines = [self linesOfString:text inRange:NSMakeRange(0, [text length]) isEndOfText:YES];
+    [self insertLines:[newLines bytes] count:[newLines length] / sizeof(SyntaxLine) atIndex:0];
+    [self lexLinesFromIndex:0 minimumCount:_numberOfLines ofString:text];
+    [self scheduleColoring];
+}
+
+
+/*
+ Lexes the lines beginning at the given index. At least count lines are lexed, then lexing continues until the
+ start state of the next line is the same as before, which means all following lines are still valid.
+ */
+- (void)lexLinesFromIndex:(NSUInteger)index minimumCount:(NSUInteger)count ofString:(NSString *)text
+{
+    uint32_t state = (0 < index)? _lines[index - 1].endState : SyntaxStateInitial;
+    for (NSUInteger i = index; i < _numberOfLines; i++) {
+        SyntaxLine *line = &_lines[i];
+        if (index + count <= i && line->isLexed && line->startState == state) {
+            break;
+        }
+
+        NSUInteger contentsEnd = line->location + line->length;
+        if (0 < line->length) {
+            [text getLineStart:NULL end:NULL contentsEnd:&contentsEnd forRange:NSMakeRange(line->location, 0)];
+        }
+        NSUInteger contentsLength = MIN(contentsEnd, line->location + line->length) - line->location;
+        if (_characterBufferLength < contentsLength) {
+            free(_characterBuffer);
+            _characterBufferLength = MAX(contentsLength, 256);
+            _characterBuffer = malloc(_characterBufferLength * sizeof(unichar));
+            if (NULL == _characterBuffer) {
+                _characterBufferLength = 0;
+                return;
+            }
+        }
+        [text getCharacters:_characterBuffer range:NSMakeRange(line->location, contentsLength)];
+
+        line->startState = state;
+        state = SyntaxLexLine(_language, _characterBuffer, contentsLength, state, &_tokenBuffer);
+        line->endState = state;
+        free(line->tokens);
+        line->tokens = NULL;
+        line->tokenCount = (uint32_t)_tokenBuffer.count;
+        if (0 < _tokenBuffer.count) {
+            line->tokens = malloc(_tokenBuffer.count * sizeof(SyntaxToken));
+            if (NULL == line->tokens) {
+                line->tokenCount = 0;
+            } else {
+                memcpy(line->tokens, _tokenBuffer.tokens, _tokenBuffer.count * sizeof(SyntaxToken));
+            }
+        }
+        line->isLexed = YES;
+        line->isColored = NO;
+        _numberOfLexedLines++;
+    }
+}
+
+
+- (void)textStorageDidProcessEditing:(NSNotification *)notification
+{
+    NSTextStorage *textStorage = [notification object];
+    if (0 == ([textStorage editedMask] & NSTextStorageEditedCharacters)) {
+        return;
+    }
+    NSString *text = [textStorage string];
+    NSRange editedRange = [textStorage editedRange];
+    NSInteger changeInLength = [textStorage changeInLength];
+    if (0 == _numberOfLines || NSNotFound == editedRange.location) {
+        [self relexAllLines];
+        return;
+    }
+
+    /* the damaged lines in the coordinates before the edit */
+    NSUInteger oldEditEnd = editedRange.location + editedRange.length - changeInLength;
+    NSUInteger firstIndex = [self lineIndexForLocation:editedRange.location];
+    NSUInteger lastIndex = [self lineIndexForLocation:oldEditEnd];
+    NSUInteger regionStart = _lines[firstIndex].location;
+    NSUInteger regionEnd = _lines[lastIndex].location + _lines[lastIndex].length + changeInLength;
+    BOOL isEndOfText = lastIndex + 1 == _numberOfLines;
+
+    NSData *newLines = [self linesOfString:text inRange:NSMakeRange(regionStart, regionEnd - regionStart) isEndOfText:isEndOfText];
+    NSUInteger newLineCount = [newLines length] / sizeof(SyntaxLine);
+    [self removeLinesInRange:NSMakeRange(firstIndex, lastIndex - firstIndex + 1)];
+    if (![self insertLines:[newLines bytes] count:newLineCount atIndex:firstIndex]) {
+        [self relexAllLines];
+        return;
+    }
+    for (NSUInteger i = firstIndex + newLineCount; i < _numberOfLines; i++) {
+        _lines[i].location += changeInLength;
+    }
+
+    [self lexLinesFromIndex:firstIndex minimumCount:newLineCount ofString:text];
+    [self scheduleColoring];
+}
+
+
+#pragma mark - Coloring
+
+
+- (void)visibleRectDidChange:(NSNotification *)notification
+{
+    [self scheduleColoring];
+}
+
+
+- (void)scheduleColoring
+{
+    /* Layout is not finished while the text storage processes an edit, so coloring is deferred to the next run loop cycle. */
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(colorVisibleLines) object:nil];
+    [self performSelector:@selector(colorVisibleLines) withObject:nil afterDelay:0.0];
+}
+
+
+- (void)colorVisibleLines
+{
+    NSTextView *textView = _textView;
+    NSLayoutManager *layoutManager = [textView layoutManager];
+    NSTextContainer *textContainer = [textView textContainer];
+    if (nil == layoutManager || nil == textContainer || 0 == _numberOfLines) {
+        return;
+    }
+
+    NSRect visibleRect = [textView visibleRect];
+    NSPoint containerOrigin = [textView textContainerOrigin];
+    visibleRect = NSOffsetRect(visibleRect, -containerOrigin.x, -containerOrigin.y);
+    NSRange glyphRange = [layoutManager glyphRangeForBoundingRectWithoutAdditionalLayout:visibleRect inTextContainer:textContainer];
+    NSRange characterRange = [layoutManager characterRangeForGlyphRange:glyphRange actualGlyphRange:NULL];
+    NSUInteger textLength = [[textView textStorage] length];
+
+    for (NSUInteger i = [self lineIndexForLocation:characterRange.location]; i < _numberOfLines; i++) {
+        SyntaxLine *line = &_lines[i];
+        if (NSMaxRange(characterRange) < line->location) {
+            break;
+        }
+        if (line->isColored || NSMaxRange(NSMakeRange(line->location, line->length)) > textLength) {
+            continue;
+        }
+        [layoutManager removeTemporaryAttribute:NSForegroundColorAttributeName forCharacterRange:NSMakeRange(line->location, line->length)];
+        for (uint32_t t = 0; t < line->tokenCount; t++) {
+            const SyntaxToken *token = &line->tokens[t];
+            [layoutManager addTemporaryAttribute:NSForegroundColorAttributeName value:SyntaxColorForTokenKind(token->kind)
+                               forCharacterRange:NSMakeRange(line->location + token->start, token->length)];
+        }
+        line->isColored = YES;
+    }
+}
+
+@end
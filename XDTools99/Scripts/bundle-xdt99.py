@@ -0,0 +1,112 @@
+#!/usr/bin/env python2.7
+#
+#  bundle-xdt99.py
+#  XDTools99
+#
+#  Created by Henrik Wedekind on 19.10.26.
+#
+#  XDTools99.framework a collection of Objective-C wrapper for xdt99
+#  Copyright (c) 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+#
+#
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU Lesser General Public License as
+#  published by the Free Software Foundation; either version 2.1 of the
+#  License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+#  Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public
+#  License along with this program; if not, see <http://www.gnu.org/licenses/>
+#
+
+"""Builds the module bundle xdt99.zip of the XDTools99 framework.
+
+The bundle contains the compiled byte code of the given xdt99 tools and of all pure Python modules of the standard
+library they import, so the framework can start Python with a minimal sys.path, without the site module and without
+compiling any source at run time (see +[XDTObject reinitializeWithXDTModuleBundle:]).
+
+The byte code has to match the Python which is linked into the framework, so this script must run with the
+Python 2.7 of Python.framework, i.e. /usr/bin/python2.7.
+"""
+
+import argparse
+import imp
+import marshal
+import modulefinder
+import os
+import struct
+import sys
+import time
+import zipfile
+
+
+# Only imported by debugging or testing code of the standard library, never when the tools run in the framework.
+# If one of them is needed anyway, it is still found in the standard library which is the last entry of sys.path.
+DEFAULT_EXCLUDES = ['doctest', 'pdb', 'pydoc', 'unittest', 'Tkinter', 'tkinter', 'idlelib', 'lib2to3', 'distutils']
+
+# The codec search function imports its encodings by name, which modulefinder cannot see.
+EXTRA_PACKAGES = ['encodings']
+
+
+def compile_module(path, name, mtime):
+    """returns the content of a .pyc file for the source at path"""
+    with open(path, 'rU') as f:
+        source = f.read()
+    if source and not source.endswith('\n'):
+        source += '\n'
+    code = compile(source, name, 'exec')
+    return imp.get_magic() + struct.pack('<I', mtime) + marshal.dumps(code)
+
+
+def archive_name(module):
+    """returns the path of the byte code of a module inside the bundle"""
+    base = module.__name__.replace('.', '/')
+    if module.__path__:
+        base += '/__init__'
+    return base + '.pyc'
+
+
+def find_modules(scripts, excludes):
+    paths = [os.path.dirname(os.path.abspath(script)) for script in scripts] + sys.path
+    finder = modulefinder.ModuleFinder(path=paths, excludes=excludes)
+    for script in scripts:
+        finder.load_file(script)
+    for package in EXTRA_PACKAGES:
+        finder.import_hook(package)
+        package_dir = finder.modules[package].__path__[0]
+        for entry in sorted(os.listdir(package_dir)):
+            name, ext = os.path.splitext(entry)
+            if ext == '.py' and name != '__init__':
+                finder.import_hook(package + '.' + name)
+    # only pure Python modules, extension modules are loaded from lib-dynload
+    return [m for m in finder.modules.values() if m.__file__ and m.__file__.endswith('.py')]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Builds the precompiled xdt99 module bundle of the framework.')
+    parser.add_argument('scripts', nargs='+', metavar='tool.py', help='the xdt99 tools to bundle, i.e. xas99.py')
+    parser.add_argument('-o', '--output', dest='output', required=True, help='path of the zip archive to create')
+    parser.add_argument('-x', '--exclude', dest='excludes', action='append', default=list(DEFAULT_EXCLUDES),
+                        help='module to leave out of the bundle')
+    opts = parser.parse_args()
+
+    modules = find_modules(opts.scripts, opts.excludes)
+    mtime = int(time.time())
+    temp_output = opts.output + '.tmp'
+    total = 0
+    with zipfile.ZipFile(temp_output, 'w', zipfile.ZIP_DEFLATED) as bundle:
+        for module in sorted(modules, key=lambda m: m.__name__):
+            name = archive_name(module)
+            data = compile_module(module.__file__, name[:-1], mtime)
+            bundle.writestr(name, data)
+            total += len(data)
+    os.rename(temp_output, opts.output)
+    sys.stdout.write('%s: %d modules, %d bytes of byte code\n' % (opts.output, len(modules), total))
+
+
+if __name__ == '__main__':
+    main()
@@ -26,12 +26,14 @@
 
 #import "NSDataPythonAdditions.h"
 #import "NSStringPythonAdditions.h"
+#import "XDTPythonGIL.h"
 
 
 @implementation NSArray (NSArrayPythonAdditions)
 
 + (nullable instancetype)arrayWithPyTuple:(PyObject *)dataTuple
 {
+    XDTAcquireGIL();
     assert(NULL != dataTuple);
 
     const Py_ssize_t dataCount = PyTuple_Size(dataTuple);
@@ -73,6 +75,7 @@
 
 + (nullable instancetype)arrayWithPyList:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList);
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
@@ -114,6 +117,7 @@
 
 + (nullable instancetype)arrayWithPyListOfTuple:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList);
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
@@ -142,6 +146,7 @@
 
 + (nullable instancetype)arrayWithPyListOfData:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList);
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
@@ -172,6 +177,7 @@
 
 + (nullable instancetype)arrayWithPyListOfString:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList);
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
@@ -23,12 +23,14 @@
 //
 
 #import "NSDataPythonAdditions.h"
+#import "XDTPythonGIL.h"
 
 
 @implementation NSData (NSDataPythonAdditions)
 
 + (instancetype)dataWithPythonString:(PyObject *)data
 {
+    XDTAcquireGIL();
     Py_ssize_t byteSize = PyString_Size(data);
     if (0 > byteSize) { // this happens when the type of data is not a Python string
         return nil;
@@ -26,18 +26,21 @@
 #import "NSStringPythonAdditions.h"
 
 #import "XDTObject.h"
+#import "XDTPythonGIL.h"
 
 
 @implementation NSError (NSErrorPythonAdditions)
 
 + (instancetype)errorWithPythonError:(PyObject *)error localizedRecoverySuggestion:(NSString *)recoverySuggestion
 {
+    XDTAcquireGIL();
     return [self errorWithPythonError:error localizedRecoverySuggestion:recoverySuggestion clearErrorIndicator:NO];
 }
 
 
 + (instancetype)errorWithPythonError:(PyObject *)error localizedRecoverySuggestion:(NSString *)recoverySuggestion clearErrorIndicator:(BOOL)clearIndicator
 {
+    XDTAcquireGIL();
     XDTErrorCode errorCode = XDTErrorCodePythonException;
     NSString *errorString = nil;
     NSString *errorDescription = nil;
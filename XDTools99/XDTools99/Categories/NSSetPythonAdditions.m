@@ -27,12 +27,14 @@
 #import "NSDataPythonAdditions.h"
 #import "NSArrayPythonAdditions.h"
 #import "NSStringPythonAdditions.h"
+#import "XDTPythonGIL.h"
 
 
 @implementation NSSet (NSSetPythonAdditions)
 
 + (nullable NSSet<id> *)setWithPyTuple:(PyObject *)dataTuple
 {
+    XDTAcquireGIL();
     assert(NULL != dataTuple && PyTuple_Check(dataTuple));
 
     const Py_ssize_t dataCount = PyTuple_Size(dataTuple);
@@ -71,6 +73,7 @@
 
 + (nullable NSSet<id> *)setWithPyList:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList && PyList_Check(dataList));
 
     const Py_ssize_t dataCount = PyTuple_Size(dataList);
@@ -109,6 +112,7 @@
 
 + (nullable NSSet<NSArray<id> *> *)setWithPyListOfTuple:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList && PyList_Check(dataList));
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
@@ -138,6 +142,7 @@
 
 + (nullable NSMutableSet<NSData *> *)setWithPyListOfData:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList && PyList_Check(dataList));
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
@@ -162,6 +167,7 @@
 
 + (nullable NSMutableSet<NSString *> *)setWithPyListOfString:(PyObject *)dataList
 {
+    XDTAcquireGIL();
     assert(NULL != dataList && PyList_Check(dataList));
 
     const Py_ssize_t dataCount = PyList_Size(dataList);
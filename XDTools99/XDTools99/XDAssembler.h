@@ -26,12 +26,16 @@
 #define XDAssembler_h
 
 #import "XDTObject.h"
+#import "XDTInstrumentation.h"
+#import "XDTPythonProfiler.h"
 
 #import "XDTAs99Symbols.h"
 #import "XDTAs99Objcode.h"
 #import "XDTAssembler.h"
+#import "XDTDisassembler.h"
 
 #import "XDTZipFile.h"
+#import "XDTCartridgeBuilder.h"
 
 #import "XDTMessage.h"
 
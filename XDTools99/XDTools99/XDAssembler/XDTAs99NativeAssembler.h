@@ -0,0 +1,106 @@
+//
+//  XDTAs99NativeAssembler.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The program of a native assembling run: the code of all segments with their relocation and the symbol table.
+
+ Relocatable segments start at offset 0 and are placed at the base address only when a binary is generated, like
+ xas99 does it. All source files which were read are kept with their modification date, so the Python assembler can
+ assemble the same sources again for outputs which are not generated natively.
+
+ The code and relocation of object code of xas99 can be captured into a program as well, so further base addresses
+ are relocated natively. Such a program has no symbols and no source files, but keeps the banks.
+ */
+@interface XDTAs99NativeProgram : NSObject
+
+@property (readonly) NSDictionary<NSString *, NSNumber *> *symbols;
+@property (readonly) NSArray<NSString *> *refdefs;
+@property (readonly) NSArray<NSURL *> *sourceFiles;     /* The assembled source file first, followed by all copied files */
+@property (readonly, getter=hasUnchangedSources) BOOL unchangedSources;
+@property (readonly) NSUInteger byteCount;              /* Memory of the segments and their relocation bits */
+@property (readonly, getter=isRelocatable) BOOL relocatable;   /* Without code in AORG segments */
+@property (readonly, getter=isBanked) BOOL banked;
+
+/* A program without symbols from two results of generate_binaries() of xas99, nil if they differ in more than relocation */
++ (nullable instancetype)programWithBinaries:(NSArray<NSArray<id> *> *)binaries at:(NSUInteger)baseAddr binaries:(NSArray<NSArray<id> *> *)otherBinaries at:(NSUInteger)otherBaseAddr;
+
+/* The address of END relocated to the base address, NSNotFound if END has no address */
+- (NSUInteger)entryAddressAt:(NSUInteger)baseAddr;
+
+/* The binaries in the format of generate_binaries() of xas99: address, bank (NSNull without banks) and the data of each segment */
+- (NSArray<NSArray<id> *> *)binariesAt:(NSUInteger)baseAddr;
+/* The binaries of generate_binaries() with saves: one for each address range and bank */
+- (NSArray<NSArray<id> *> *)binariesAt:(NSUInteger)baseAddr ranges:(NSArray<NSValue *> *)ranges;
+/* The files of a program image (Editor/Assembler Option 5) like generate_image() of xas99 */
+- (NSArray<NSData *> *)imagesAt:(NSUInteger)baseAddr chunkSize:(NSUInteger)chunkSize;
+
+@end
+
+
+/**
+ The parsed lines of all source files of an assembler session, shared by its native assembling runs.
+
+ Every file is split into the fields of its lines once. Later runs reuse these lines as long as the file has the same
+ modification date and size, or the same SHA-256 digest of its content when only the date has changed, so large
+ copied files with equates or tables are neither read nor parsed again. A file which does not exist anymore is
+ removed when it is looked up, all others remain until removeAllFiles. The cache may be used from any thread.
+ */
+@interface XDTAs99NativeSourceCache : NSObject
+
+@property (readonly) NSUInteger fileCount;
+@property (readonly) NSUInteger hitCount;       /* Files whose lines were reused */
+@property (readonly) NSUInteger missCount;      /* Files which were parsed, also again after a change */
+@property (readonly) NSUInteger byteCount;      /* Estimated memory of the cached lines */
+
++ (instancetype)sourceCache;
+
+- (void)removeAllFiles;
+
+@end
+
+
+/**
+ A native two-pass assembler for the common subset of xas99: all TMS9900 instructions, AORG, EQU, DATA, BYTE, TEXT,
+ BSS, BES, EVEN, DEF, COPY, END and the directives without effect on the code (IDT, TITL, PAGE, LIST, UNL).
+
+ Everything else makes the assembler give up with a reason instead of a program: macros, conditionals, local labels,
+ REF, RORG, banks, operators beyond + - * / and parentheses, and every error. The caller assembles such sources with
+ xas99 then, which also generates the messages. With warnings enabled, registers in R notation are required, because
+ xas99 warns about all other registers.
+ */
+@interface XDTAs99NativeAssembler : NSObject
+
++ (instancetype)nativeAssemblerWithIncludeURLs:(NSArray<NSURL *> *)includeURLs useRegisterSymbols:(BOOL)useRegisterSymbols outputWarnings:(BOOL)outputWarnings sourceCache:(nullable XDTAs99NativeSourceCache *)sourceCache;
+
+- (nullable XDTAs99NativeProgram *)assembleSourceFile:(NSURL *)srcFile unsupportedReason:(NSString * _Nullable * _Nullable)reason;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1805 @@
+//
+//  XDTAs99NativeAssembler.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTAs99NativeAssembler.h"
+
+#include <CommonCrypto/CommonDigest.h>
+#include <ctype.h>
+#include <sys/stat.h>
+
+
+#define XDTNativeMemorySize 0x10000
+#define XDTNativeCopyDepth 16
+
+
+typedef NS_ENUM(NSUInteger, XDTNativeFormat) {
+    XDTNativeFormatTwoGeneral,          /* Format I: two general addresses */
+    XDTNativeFormatGeneralRegister,     /* Format III: a general source address and a register */
+    XDTNativeFormatGeneralCount,        /* Format IV and IX: a general source address and a number from 0 to 15 */
+    XDTNativeFormatJump,                /* Format II: a jump target */
+    XDTNativeFormatCRU,                 /* Format II: a signed 8 bit CRU displacement */
+    XDTNativeFormatShift,               /* Format V: a register and a shift count */
+    XDTNativeFormatGeneral,             /* Format VI: a single general address */
+    XDTNativeFormatRegisterImmediate,   /* Format VIII: a register and an immediate value */
+    XDTNativeFormatRegister,            /* Format VIII: a single register */
+    XDTNativeFormatImmediate,           /* LWPI and LIMI */
+    XDTNativeFormatNone,                /* Format VII and the pseudo instructions NOP and RT */
+};
+
+typedef NS_ENUM(NSUInteger, XDTNativeEvaluation) {
+    XDTNativeEvaluationDone,
+    XDTNativeEvaluationUndefined,       /* a symbol is not defined (yet) */
+    XDTNativeEvaluationUnsupported,
+};
+
+typedef struct {
+    const char *mnemonic;
+    uint16_t opcode;
+    XDTNativeFormat format;
+} XDTNativeInstruction;
+
+typedef struct {
+    int64_t value;
+    int relocation;     /* 1 for an address of a relocatable segment, 0 for absolute values */
+} XDTNativeValue;
+
+/* A segment of code, placed by AORG or by the relocatable start of the program */
+typedef struct {
+    BOOL relocatable;
+    uint32_t low;           /* the first written byte */
+    uint32_t high;          /* the byte after the last written byte, 0 if nothing is written */
+    uint8_t *memory;        /* XDTNativeMemorySize bytes */
+    uint8_t *relocations;   /* one bit for each word, set if the word is relocated */
+    NSInteger bank;         /* the bank of xas99, negative without a bank */
+} XDTNativeSegment;
+
+
+/* Directives without effect on the code, the first ones also take the rest of the line as comment */
+static const char * const XDTNativeListingDirectives[] = {"EVEN", "PAGE", "LIST", "UNL", NULL};
+static const char * const XDTNativeIgnoredDirectives[] = {"PAGE", "LIST", "UNL", "IDT", "TITL", NULL};
+
+static const XDTNativeInstruction XDTNativeInstructions[] = {
+    {"SZC", 0x4000, XDTNativeFormatTwoGeneral}, {"SZCB", 0x5000, XDTNativeFormatTwoGeneral},
+    {"S", 0x6000, XDTNativeFormatTwoGeneral}, {"SB", 0x7000, XDTNativeFormatTwoGeneral},
+    {"C", 0x8000, XDTNativeFormatTwoGeneral}, {"CB", 0x9000, XDTNativeFormatTwoGeneral},
+    {"A", 0xA000, XDTNativeFormatTwoGeneral}, {"AB", 0xB000, XDTNativeFormatTwoGeneral},
+    {"MOV", 0xC000, XDTNativeFormatTwoGeneral}, {"MOVB", 0xD000, XDTNativeFormatTwoGeneral},
+    {"SOC", 0xE000, XDTNativeFormatTwoGeneral}, {"SOCB", 0xF000, XDTNativeFormatTwoGeneral},
+    {"COC", 0x2000, XDTNativeFormatGeneralRegister}, {"CZC", 0x2400, XDTNativeFormatGeneralRegister},
+    {"XOR", 0x2800, XDTNativeFormatGeneralRegister}, {"MPY", 0x3800, XDTNativeFormatGeneralRegister},
+    {"DIV", 0x3C00, XDTNativeFormatGeneralRegister},
+    {"XOP", 0x2C00, XDTNativeFormatGeneralCount}, {"LDCR", 0x3000, XDTNativeFormatGeneralCount},
+    {"STCR", 0x3400, XDTNativeFormatGeneralCount},
+    {"JMP", 0x1000, XDTNativeFormatJump}, {"JLT", 0x1100, XDTNativeFormatJump}, {"JLE", 0x1200, XDTNativeFormatJump},
+    {"JEQ", 0x1300, XDTNativeFormatJump}, {"JHE", 0x1400, XDTNativeFormatJump}, {"JGT", 0x1500, XDTNativeFormatJump},
+    {"JNE", 0x1600, XDTNativeFormatJump}, {"JNC", 0x1700, XDTNativeFormatJump}, {"JOC", 0x1800, XDTNativeFormatJump},
+    {"JNO", 0x1900, XDTNativeFormatJump}, {"JL", 0x1A00, XDTNativeFormatJump}, {"JH", 0x1B00, XDTNativeFormatJump},
+    {"JOP", 0x1C00, XDTNativeFormatJump},
+    {"SBO", 0x1D00, XDTNativeFormatCRU}, {"SBZ", 0x1E00, XDTNativeFormatCRU}, {"TB", 0x1F00, XDTNativeFormatCRU},
+    {"SRA", 0x0800, XDTNativeFormatShift}, {"SRL", 0x0900, XDTNativeFormatShift},
+    {"SLA", 0x0A00, XDTNativeFormatShift}, {"SRC", 0x0B00, XDTNativeFormatShift},
+    {"BLWP", 0x0400, XDTNativeFormatGeneral}, {"B", 0x0440, XDTNativeFormatGeneral}, {"X", 0x0480, XDTNativeFormatGeneral},
+    {"CLR", 0x04C0, XDTNativeFormatGeneral}, {"NEG", 0x0500, XDTNativeFormatGeneral}, {"INV", 0x0540, XDTNativeFormatGeneral},
+    {"INC", 0x0580, XDTNativeFormatGeneral}, {"INCT", 0x05C0, XDTNativeFormatGeneral}, {"DEC", 0x0600, XDTNativeFormatGeneral},
+    {"DECT", 0x0640, XDTNativeFormatGeneral}, {"BL", 0x0680, XDTNativeFormatGeneral}, {"SWPB", 0x06C0, XDTNativeFormatGeneral},
+    {"SETO", 0x0700, XDTNativeFormatGeneral}, {"ABS", 0x0740, XDTNativeFormatGeneral},
+    {"LI", 0x0200, XDTNativeFormatRegisterImmediate}, {"AI", 0x0220, XDTNativeFormatRegisterImmediate},
+    {"ANDI", 0x0240, XDTNativeFormatRegisterImmediate}, {"ORI", 0x0260, XDTNativeFormatRegisterImmediate},
+    {"CI", 0x0280, XDTNativeFormatRegisterImmediate},
+    {"STWP", 0x02A0, XDTNativeFormatRegister}, {"STST", 0x02C0, XDTNativeFormatRegister},
+    {"LWPI", 0x02E0, XDTNativeFormatImmediate}, {"LIMI", 0x0300, XDTNativeFormatImmediate},
+    {"IDLE", 0x0340, XDTNativeFormatNone}, {"RSET", 0x0360, XDTNativeFormatNone}, {"RTWP", 0x0380, XDTNativeFormatNone},
+    {"CKON", 0x03A0, XDTNativeFormatNone}, {"CKOF", 0x03C0, XDTNativeFormatNone}, {"LREX", 0x03E0, XDTNativeFormatNone},
+    {"NOP", 0x1000, XDTNativeFormatNone}, {"RT", 0x045B, XDTNativeFormatNone},
+};
+
+
+static const XDTNativeInstruction *XDTNativeInstructionNamed(const char *mnemonic)
+{
+    for (NSUInteger i = 0; i < sizeof(XDTNativeInstructions) / sizeof(XDTNativeInstructions[0]); i++) {
+        if (0 == strcmp(XDTNativeInstructions[i].mnemonic, mnemonic)) {
+            return &XDTNativeInstructions[i];
+        }
+    }
+    return NULL;
+}
+
+
+static BOOL XDTNativeIsSymbolName(const char *name, NSUInteger length)
+{
+    if (0 == length || (!isalpha((unsigned char)name[0]) && '_' != name[0])) {
+        return NO;
+    }
+    for (NSUInteger i = 1; i < length; i++) {
+        if (!isalnum((unsigned char)name[i]) && '_' != name[i]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+static BOOL XDTNativeIsListed(const char *mnemonic, const char * const *names)
+{
+    for (NSUInteger i = 0; NULL != names[i]; i++) {
+        if (0 == strcmp(names[i], mnemonic)) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+
+/* Number of bytes of a general address operand after the instruction word */
+static inline uint32_t XDTNativeGeneralLength(NSString *operand)
+{
+    return [operand hasPrefix:@"@"]? 2 : 0;
+}
+
+
+#pragma mark - Private Classes
+
+
+/* A line with code or a directive, as it is collected in the first pass */
+@interface XDTAs99NativeStatement : NSObject
+
+@property (copy) NSString *mnemonic;
+@property (retain) NSArray<NSString *> *operands;
+@property (retain) NSURL *fileURL;
+@property NSUInteger lineNumber;
+@property NSUInteger segment;
+@property uint32_t location;
+
+@end
+
+
+@implementation XDTAs99NativeStatement
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_mnemonic release];
+    [_operands release];
+    [_fileURL release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+/* The fields of a source line, split independently of symbols and locations, so the lines of a file can be cached */
+@interface XDTAs99NativeLine : NSObject
+
+@property NSUInteger lineNumber;
+@property (copy) NSString *label;
+@property (copy) NSString *mnemonic;            /* nil for a line with a label only */
+@property (retain) NSArray<NSString *> *operands;
+@property (copy) NSString *failure;             /* The reason to give up on when this line is reached */
+
+@end
+
+
+@implementation XDTAs99NativeLine
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_label release];
+    [_mnemonic release];
+    [_operands release];
+    [_failure release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+static XDTAs99NativeLine *XDTNativeFailedLine(NSUInteger lineNumber, NSString *reason)
+{
+    XDTAs99NativeLine *retVal = [[XDTAs99NativeLine alloc] init];
+    retVal.lineNumber = lineNumber;
+    retVal.failure = reason;
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+/* A file of the source cache with the date, size and digest of the content its lines were parsed from */
+@interface XDTAs99NativeSourceFile : NSObject
+
+@property (retain) NSArray<XDTAs99NativeLine *> *lines;
+@property (retain) NSData *digest;
+@property struct timespec modificationTime;
+@property off_t size;
+@property NSUInteger byteCount;
+
+@end
+
+
+@implementation XDTAs99NativeSourceFile
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_lines release];
+    [_digest release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface XDTAs99NativeSourceCache () {
+    NSMutableDictionary<NSString *, XDTAs99NativeSourceFile *> *_files;   /* key is the standardized path */
+}
+
+/* The lines of a file, the block parses the content only if the file is not cached or has changed */
+- (nullable NSArray<XDTAs99NativeLine *> *)linesOfFileAtURL:(NSURL *)fileURL parsingContentWithBlock:(NSArray<XDTAs99NativeLine *> *(^)(NSData *content))parseBlock;
+
+@end
+
+
+@interface XDTAs99NativeProgram () {
+    NSData *_segments;      /* XDTNativeSegment, the program owns their memory */
+    NSArray<NSDate *> *_modificationDates;
+    XDTNativeValue _entry;  /* The address of END, a negative value without an address */
+}
+
+- (instancetype)initWithSegments:(NSData *)segments symbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs sourceFiles:(NSArray<NSURL *> *)sourceFiles entry:(XDTNativeValue)entry;
+
++ (nullable NSDate *)modificationDateOfURL:(NSURL *)url;
+
+@end
+
+
+@interface XDTAs99NativeAssembler () {
+    NSArray<NSURL *> *_includeURLs;
+    BOOL _useRegisterSymbols;
+    BOOL _outputWarnings;
+    XDTAs99NativeSourceCache *_sourceCache;
+
+    /* State of the current run */
+    NSMutableDictionary<NSString *, NSNumber *> *_symbols;
+    NSMutableSet<NSString *> *_relocatableSymbols;
+    NSMutableArray<NSString *> *_refdefs;
+    NSMutableArray<NSArray *> *_pendingEquates;    /* label, expression, location, segment of EQU with forward references */
+    NSMutableArray<XDTAs99NativeStatement *> *_statements;
+    NSMutableArray<NSURL *> *_sourceFiles;
+    NSMutableData *_segments;
+    NSUInteger _segment;
+    uint32_t _location;
+    NSString *_entryExpression;
+    BOOL _ended;
+    NSString *_reason;
+    NSURL *_currentFile;
+    NSUInteger _currentLine;
+}
+
+- (instancetype)initWithIncludeURLs:(NSArray<NSURL *> *)includeURLs useRegisterSymbols:(BOOL)useRegisterSymbols outputWarnings:(BOOL)outputWarnings sourceCache:(nullable XDTAs99NativeSourceCache *)sourceCache;
+
+- (BOOL)giveUp:(NSString *)reason;
+- (void)releaseSegments;
+- (void)beginSegmentAt:(uint32_t)location relocatable:(BOOL)isRelocatable;
+- (BOOL)isRelocatableLocation;
+
+- (BOOL)readFileAtURL:(NSURL *)fileURL depth:(NSUInteger)depth;
+- (nullable NSURL *)URLOfCopiedFile:(NSString *)name includingURL:(NSURL *)fileURL;
++ (NSArray<XDTAs99NativeLine *> *)linesOfContent:(NSData *)content;
++ (nullable XDTAs99NativeLine *)lineOfText:(const char *)text number:(NSUInteger)lineNumber;
++ (nullable NSArray<NSString *> *)operandsOfField:(NSString *)field;
+- (BOOL)processLine:(XDTAs99NativeLine *)line depth:(NSUInteger)depth;
+- (BOOL)defineLabel:(nullable NSString *)label value:(int64_t)value relocatable:(BOOL)isRelocatable;
+- (BOOL)collectStatement:(NSString *)mnemonic operands:(NSArray<NSString *> *)operands label:(nullable NSString *)label depth:(NSUInteger)depth;
+- (BOOL)resolvePendingEquates;
+
+- (XDTNativeEvaluation)evaluate:(NSString *)expression value:(XDTNativeValue *)value;
+- (XDTNativeEvaluation)evaluateExpression:(const char **)position value:(XDTNativeValue *)value;
+- (XDTNativeEvaluation)evaluateTerm:(const char **)position value:(XDTNativeValue *)value;
+
+- (BOOL)encodeStatement:(XDTAs99NativeStatement *)statement;
+- (BOOL)valueOf:(NSString *)expression value:(XDTNativeValue *)value;
+- (BOOL)register:(NSString *)operand number:(uint16_t *)number;
+- (BOOL)number:(NSString *)operand minimum:(int64_t)minimum maximum:(int64_t)maximum value:(int64_t *)number;
+- (BOOL)general:(NSString *)operand field:(uint16_t *)field word:(XDTNativeValue *)word hasWord:(BOOL *)hasWord;
+- (BOOL)emitWord:(int64_t)value relocation:(int)relocation;
+- (BOOL)emitByte:(int64_t)value;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+#pragma mark - Implementation of class XDTAs99NativeProgram
+
+
+@implementation XDTAs99NativeProgram
+
+- (instancetype)initWithSegments:(NSData *)segments symbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs sourceFiles:(NSArray<NSURL *> *)sourceFiles entry:(XDTNativeValue)entry
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _segments = [segments copy];
+    _symbols = [symbols copy];
+    _refdefs = [refdefs copy];
+    _sourceFiles = [sourceFiles copy];
+    NSMutableArray<NSDate *> *modificationDates = [NSMutableArray arrayWithCapacity:[sourceFiles count]];
+    for (NSURL *sourceFile in sourceFiles) {
+        NSDate *modificationDate = [XDTAs99NativeProgram modificationDateOfURL:sourceFile];
+        [modificationDates addObject:(nil == modificationDate)? [NSDate distantPast] : modificationDate];
+    }
+    _modificationDates = [modificationDates copy];
+    _entry = entry;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    const XDTNativeSegment *segments = [_segments bytes];
+    for (NSUInteger i = 0; i < [_segments length] / sizeof(XDTNativeSegment); i++) {
+        free(segments[i].memory);
+        free(segments[i].relocations);
+    }
+#if !__has_feature(objc_arc)
+    [_segments release];
+    [_symbols release];
+    [_refdefs release];
+    [_sourceFiles release];
+    [_modificationDates release];
+
+    [super dealloc];
+#endif
+}
+
+
++ (NSDate *)modificationDateOfURL:(NSURL *)url
+{
+    NSDate *retVal = nil;
+    [[url URLByResolvingSymlinksInPath] getResourceValue:&retVal forKey:NSURLContentModificationDateKey error:nil];
+    return retVal;
+}
+
+
+- (BOOL)isRelocatable
+{
+    const XDTNativeSegment *segments = [_segments bytes];
+    for (NSUInteger i = 0; i < [_segments length] / sizeof(XDTNativeSegment); i++) {
+        if (!segments[i].relocatable && segments[i].low < segments[i].high) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+- (NSUInteger)entryAddressAt:(NSUInteger)baseAddr
+{
+    if (0 > _entry.value) {
+        return NSNotFound;
+    }
+    return (_entry.relocation * baseAddr + (NSUInteger)_entry.value) & 0xFFFF;
+}
+
+
+- (NSUInteger)byteCount
+{
+    NSUInteger segmentCount = [_segments length] / sizeof(XDTNativeSegment);
+    return [_segments length] + segmentCount * (XDTNativeMemorySize + XDTNativeMemorySize / 16);
+}
+
+
+- (BOOL)hasUnchangedSources
+{
+    for (NSUInteger i = 0; i < [_sourceFiles count]; i++) {
+        NSDate *modificationDate = [XDTAs99NativeProgram modificationDateOfURL:[_sourceFiles objectAtIndex:i]];
+        if (nil == modificationDate || ![modificationDate isEqualToDate:[_modificationDates objectAtIndex:i]]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+- (BOOL)isBanked
+{
+    const XDTNativeSegment *segments = [_segments bytes];
+    for (NSUInteger i = 0; i < [_segments length] / sizeof(XDTNativeSegment); i++) {
+        if (0 <= segments[i].bank) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+
+/*
+ The code is the same for both base addresses except for the relocated words, which differ by the distance of the
+ base addresses. Relocatable segments start at the base address plus their offset, absolute segments at the same
+ address. Every other difference means that the binaries do not belong to one relocatable program.
+ */
++ (instancetype)programWithBinaries:(NSArray<NSArray<id> *> *)binaries at:(NSUInteger)baseAddr binaries:(NSArray<NSArray<id> *> *)otherBinaries at:(NSUInteger)otherBaseAddr
+{
+    const uint16_t distance = (uint16_t)(otherBaseAddr - baseAddr);
+    if (0 == distance || [binaries count] != [otherBinaries count]) {
+        return nil;
+    }
+
+    NSMutableData *segmentData = [NSMutableData dataWithCapacity:[binaries count] * sizeof(XDTNativeSegment)];
+    BOOL isMatching = YES;
+    for (NSUInteger i = 0; isMatching && i < [binaries count]; i++) {
+        NSArray<id> *binary = [binaries objectAtIndex:i];
+        NSArray<id> *otherBinary = [otherBinaries objectAtIndex:i];
+        const NSUInteger address = [[binary objectAtIndex:0] unsignedIntegerValue] & 0xFFFF;
+        const NSUInteger otherAddress = [[otherBinary objectAtIndex:0] unsignedIntegerValue] & 0xFFFF;
+        id bank = [binary objectAtIndex:1];
+        NSData *data = [binary objectAtIndex:2];
+        NSData *otherData = [otherBinary objectAtIndex:2];
+        const BOOL isRelocatable = address != otherAddress;
+        const uint32_t low = (uint32_t)(isRelocatable? (address - baseAddr) & 0xFFFF : address);
+        if ((isRelocatable && ((address + distance) & 0xFFFF) != otherAddress) || ![bank isEqual:[otherBinary objectAtIndex:1]] ||
+            [data length] != [otherData length] || XDTNativeMemorySize < low + [data length]) {
+            isMatching = NO;
+            break;
+        }
+
+        XDTNativeSegment segment = {isRelocatable, low, low + (uint32_t)[data length], calloc(XDTNativeMemorySize, 1), calloc(XDTNativeMemorySize / 16, 1),
+                                    [bank isKindOfClass:[NSNumber class]]? [bank integerValue] : -1};
+        [segmentData appendBytes:&segment length:sizeof(segment)];
+        const uint8_t *bytes = [data bytes];
+        const uint8_t *otherBytes = [otherData bytes];
+        memcpy(segment.memory + low, bytes, [data length]);
+        for (uint32_t offset = 0; isMatching && offset < [data length]; offset++) {
+            const uint32_t wordAddress = (low + offset) & ~1U;
+            if (bytes[offset] == otherBytes[offset] || 0 != (segment.relocations[wordAddress >> 4] & (1 << ((wordAddress >> 1) & 7)))) {
+                continue;
+            }
+            /* relocated words are always written completely, so both bytes are part of the data */
+            if (wordAddress < low || wordAddress + 2 > segment.high) {
+                isMatching = NO;
+                break;
+            }
+            const uint32_t wordOffset = wordAddress - low;
+            const uint16_t word = (uint16_t)((bytes[wordOffset] << 8) | bytes[wordOffset + 1]);
+            const uint16_t otherWord = (uint16_t)((otherBytes[wordOffset] << 8) | otherBytes[wordOffset + 1]);
+            if ((uint16_t)(word + distance) != otherWord) {
+                isMatching = NO;
+                break;
+            }
+            const uint16_t relocatedWord = (uint16_t)(word - baseAddr);
+            segment.memory[wordAddress] = relocatedWord >> 8;
+            segment.memory[wordAddress + 1] = relocatedWord & 0xFF;
+            segment.relocations[wordAddress >> 4] |= 1 << ((wordAddress >> 1) & 7);
+        }
+    }
+
+    if (!isMatching) {
+        const XDTNativeSegment *segments = [segmentData bytes];
+        for (NSUInteger i = 0; i < [segmentData length] / sizeof(XDTNativeSegment); i++) {
+            free(segments[i].memory);
+            free(segments[i].relocations);
+        }
+        return nil;
+    }
+    XDTNativeValue entry = {-1, 0};
+    XDTAs99NativeProgram *retVal = [[XDTAs99NativeProgram alloc] initWithSegments:segmentData symbols:@{} refdefs:@[] sourceFiles:@[] entry:entry];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+#pragma mark - Generator Methods
+
+
+- (NSArray<NSArray<id> *> *)binariesAt:(NSUInteger)baseAddr
+{
+    const XDTNativeSegment *segments = [_segments bytes];
+    const NSUInteger segmentCount = [_segments length] / sizeof(XDTNativeSegment);
+    NSMutableArray<NSArray<id> *> *retVal = [NSMutableArray arrayWithCapacity:segmentCount];
+    for (NSUInteger i = 0; i < segmentCount; i++) {
+        const XDTNativeSegment *segment = &segments[i];
+        if (segment->high <= segment->low) {
+            continue;
+        }
+        NSMutableData *data = [NSMutableData dataWithBytes:segment->memory + segment->low length:segment->high - segment->low];
+        uint8_t *bytes = [data mutableBytes];
+        for (uint32_t address = segment->low & ~1U; address < segment->high; address += 2) {
+            if (0 == (segment->relocations[address >> 4] & (1 << ((address >> 1) & 7)))) {
+                continue;
+            }
+            /* relocated words are always written completely, so both bytes are part of the data */
+            const uint32_t offset = address - segment->low;
+            const uint16_t word = (uint16_t)(((bytes[offset] << 8) | bytes[offset + 1]) + baseAddr);
+            bytes[offset] = word >> 8;
+            bytes[offset + 1] = word & 0xFF;
+        }
+        const NSUInteger address = segment->relocatable? (baseAddr + segment->low) & 0xFFFF : segment->low;
+        id bank = (0 > segment->bank)? [NSNull null] : [NSNumber numberWithInteger:segment->bank];
+        [retVal addObject:@[[NSNumber numberWithUnsignedInteger:address], bank, data]];
+    }
+    return retVal;
+}
+
+
+/* Every range is filled with the code of each bank which has code in it, and with zeros elsewhere */
+- (NSArray<NSArray<id> *> *)binariesAt:(NSUInteger)baseAddr ranges:(NSArray<NSValue *> *)ranges
+{
+    NSArray<NSArray<id> *> *binaries = [self binariesAt:baseAddr];
+    NSMutableArray<NSArray<id> *> *retVal = [NSMutableArray arrayWithCapacity:[ranges count]];
+    for (NSValue *rangeValue in ranges) {
+        const NSRange range = [rangeValue rangeValue];
+        NSMutableArray<id> *banks = [NSMutableArray array];
+        NSMutableDictionary<id, NSMutableData *> *blobs = [NSMutableDictionary dictionary];
+        for (NSArray<id> *binary in binaries) {
+            const NSUInteger address = [[binary objectAtIndex:0] unsignedIntegerValue];
+            id bank = [binary objectAtIndex:1];
+            NSData *data = [binary objectAtIndex:2];
+            const NSRange overlap = NSIntersectionRange(range, NSMakeRange(address, [data length]));
+            if (0 == overlap.length) {
+                continue;
+            }
+            NSMutableData *blob = [blobs objectForKey:bank];
+            if (nil == blob) {
+                blob = [NSMutableData dataWithLength:range.length];
+                [blobs setObject:blob forKey:bank];
+                [banks addObject:bank];
+            }
+            memcpy((uint8_t *)[blob mutableBytes] + overlap.location - range.location, (const uint8_t *)[data bytes] + overlap.location - address, overlap.length);
+        }
+        for (id bank in banks) {
+            [retVal addObject:@[[NSNumber numberWithUnsignedInteger:range.location], bank, [blobs objectForKey:bank]]];
+        }
+    }
+    return retVal;
+}
+
+
+- (NSArray<NSData *> *)imagesAt:(NSUInteger)baseAddr chunkSize:(NSUInteger)chunkSize
+{
+    if (6 >= chunkSize) {
+        return @[];
+    }
+
+    /* every file holds up to chunkSize bytes: a header with more-files flag, length and load address, then the code */
+    NSMutableArray<NSArray<id> *> *chunks = [NSMutableArray array];
+    for (NSArray<id> *binary in [self binariesAt:baseAddr]) {
+        const NSUInteger address = [[binary objectAtIndex:0] unsignedIntegerValue];
+        NSData *data = [binary objectAtIndex:2];
+        for (NSUInteger offset = 0; offset < [data length]; offset += chunkSize - 6) {
+            NSRange range = NSMakeRange(offset, MIN(chunkSize - 6, [data length] - offset));
+            [chunks addObject:@[[NSNumber numberWithUnsignedInteger:address + offset], [data subdataWithRange:range]]];
+        }
+    }
+
+    NSMutableArray<NSData *> *retVal = [NSMutableArray arrayWithCapacity:[chunks count]];
+    [chunks enumerateObjectsUsingBlock:^(NSArray<id> *chunk, NSUInteger idx, BOOL *stop) {
+        NSData *code = [chunk objectAtIndex:1];
+        const uint16_t flag = (idx + 1 < [chunks count])? 0xFFFF : 0x0000;
+        const uint16_t length = (uint16_t)([code length] + 6);
+        const uint16_t address = (uint16_t)[[chunk objectAtIndex:0] unsignedIntegerValue];
+        const uint8_t header[6] = {flag >> 8, flag & 0xFF, length >> 8, length & 0xFF, address >> 8, address & 0xFF};
+        NSMutableData *image = [NSMutableData dataWithBytes:header length:sizeof(header)];
+        [image appendData:code];
+        [retVal addObject:image];
+    }];
+    return retVal;
+}
+
+@end
+
+
+#pragma mark - Implementation of class XDTAs99NativeSourceCache
+
+
+@implementation XDTAs99NativeSourceCache
+
++ (instancetype)sourceCache
+{
+    XDTAs99NativeSourceCache *retVal = [[XDTAs99NativeSourceCache alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _files = [[NSMutableDictionary alloc] init];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_files release];
+
+    [super dealloc];
+#endif
+}
+
+
+- (NSUInteger)fileCount
+{
+    @synchronized (self) {
+        return [_files count];
+    }
+}
+
+
+- (NSUInteger)byteCount
+{
+    @synchronized (self) {
+        NSUInteger retVal = 0;
+        for (XDTAs99NativeSourceFile *file in [_files objectEnumerator]) {
+            retVal += file.byteCount;
+        }
+        return retVal;
+    }
+}
+
+
+- (void)removeAllFiles
+{
+    @synchronized (self) {
+        [_files removeAllObjects];
+    }
+}
+
+
+/*
+ The file is read and parsed outside of the lock, so other threads are not blocked while a large file is parsed. When
+ two threads parse the same changed file, the last one wins, which is as good as the first.
+ */
+- (NSArray<XDTAs99NativeLine *> *)linesOfFileAtURL:(NSURL *)fileURL parsingContentWithBlock:(NSArray<XDTAs99NativeLine *> *(^)(NSData *))parseBlock
+{
+    NSString *path = [[fileURL URLByStandardizingPath] path];
+    struct stat status;
+    if (0 != stat([path fileSystemRepresentation], &status)) {
+        /* a deleted or renamed file is never hit again */
+        @synchronized (self) {
+            [_files removeObjectForKey:path];
+        }
+        return nil;
+    }
+
+    XDTAs99NativeSourceFile *file = nil;
+    @synchronized (self) {
+        file = [_files objectForKey:path];
+#if !__has_feature(objc_arc)
+        [[file retain] autorelease];
+#endif
+    }
+    if (nil != file && file.size == status.st_size &&
+        file.modificationTime.tv_sec == status.st_mtimespec.tv_sec && file.modificationTime.tv_nsec == status.st_mtimespec.tv_nsec) {
+        @synchronized (self) {
+            _hitCount++;
+        }
+        return file.lines;
+    }
+
+    NSData *content = [NSData dataWithContentsOfFile:path];
+    if (nil == content) {
+        return nil;
+    }
+    NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([content bytes], (CC_LONG)[content length], [digest mutableBytes]);
+    if (nil != file && [file.digest isEqualToData:digest]) {
+        /* only touched, the new date saves reading the file next time */
+        @synchronized (self) {
+            file.modificationTime = status.st_mtimespec;
+            file.size = status.st_size;
+            _hitCount++;
+        }
+        return file.lines;
+    }
+
+    NSArray<XDTAs99NativeLine *> *lines = parseBlock(content);
+    XDTAs99NativeSourceFile *newFile = [[XDTAs99NativeSourceFile alloc] init];
+    newFile.lines = lines;
+    newFile.digest = digest;
+    newFile.modificationTime = status.st_mtimespec;
+    newFile.size = status.st_size;
+    /* the text of the fields is about the content, and each line is an object with an array */
+    newFile.byteCount = [content length] + [lines count] * 6 * sizeof(void *) + [digest length];
+    @synchronized (self) {
+        [_files setObject:newFile forKey:path];
+        _missCount++;
+    }
+#if !__has_feature(objc_arc)
+    [newFile release];
+#endif
+    return lines;
+}
+
+@end
+
+
+#pragma mark - Implementation of class XDTAs99NativeAssembler
+
+
+@implementation XDTAs99NativeAssembler
+
+#pragma mark Initializers
+
++ (instancetype)nativeAssemblerWithIncludeURLs:(NSArray<NSURL *> *)includeURLs useRegisterSymbols:(BOOL)useRegisterSymbols outputWarnings:(BOOL)outputWarnings sourceCache:(XDTAs99NativeSourceCache *)sourceCache
+{
+    XDTAs99NativeAssembler *retVal = [[XDTAs99NativeAssembler alloc] initWithIncludeURLs:includeURLs useRegisterSymbols:useRegisterSymbols outputWarnings:outputWarnings sourceCache:sourceCache];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithIncludeURLs:(NSArray<NSURL *> *)includeURLs useRegisterSymbols:(BOOL)useRegisterSymbols outputWarnings:(BOOL)outputWarnings sourceCache:(XDTAs99NativeSourceCache *)sourceCache
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _includeURLs = [includeURLs copy];
+    _useRegisterSymbols = useRegisterSymbols;
+    _outputWarnings = outputWarnings;
+#if !__has_feature(objc_arc)
+    [sourceCache retain];
+#endif
+    _sourceCache = sourceCache;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    [self releaseSegments];
+#if !__has_feature(objc_arc)
+    [_includeURLs release];
+    [_sourceCache release];
+    [_symbols release];
+    [_relocatableSymbols release];
+    [_refdefs release];
+    [_pendingEquates release];
+    [_statements release];
+    [_sourceFiles release];
+    [_segments release];
+    [_entryExpression release];
+    [_reason release];
+    [_currentFile release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Assembling
+
+
+- (XDTAs99NativeProgram *)assembleSourceFile:(NSURL *)srcFile unsupportedReason:(NSString **)reason
+{
+    [self releaseSegments];
+#if !__has_feature(objc_arc)
+    [_symbols release];
+    [_relocatableSymbols release];
+    [_refdefs release];
+    [_pendingEquates release];
+    [_statements release];
+    [_sourceFiles release];
+    [_segments release];
+    [_entryExpression release];
+    [_reason release];
+    [_currentFile release];
+#endif
+    _currentFile = nil;
+    _currentLine = 0;
+    _symbols = [[NSMutableDictionary alloc] init];
+    _relocatableSymbols = [[NSMutableSet alloc] init];
+    _refdefs = [[NSMutableArray alloc] init];
+    _pendingEquates = [[NSMutableArray alloc] init];
+    _statements = [[NSMutableArray alloc] init];
+    _sourceFiles = [[NSMutableArray alloc] init];
+    _segments = [[NSMutableData alloc] init];
+    _entryExpression = nil;
+    _ended = NO;
+    _reason = nil;
+
+    if (_useRegisterSymbols) {
+        for (NSUInteger i = 0; i < 16; i++) {
+            [_symbols setObject:[NSNumber numberWithUnsignedInteger:i] forKey:[NSString stringWithFormat:@"R%lu", (unsigned long)i]];
+        }
+    }
+    [self beginSegmentAt:0 relocatable:YES];
+
+    /* first pass: reading all lines, collecting the statements and defining the labels */
+    BOOL isSupported = [self readFileAtURL:srcFile depth:0] && [self resolvePendingEquates];
+    for (NSUInteger i = 0; isSupported && i < [_refdefs count]; i++) {
+        if (nil == [_symbols objectForKey:[_refdefs objectAtIndex:i]]) {
+            isSupported = [self giveUp:[NSString stringWithFormat:@"DEF of the undefined symbol %@", [_refdefs objectAtIndex:i]]];
+        }
+    }
+    XDTNativeValue entry = {-1, 0};
+    if (isSupported && nil != _entryExpression) {
+        isSupported = [self valueOf:_entryExpression value:&entry];
+    }
+
+    /* second pass: encoding the statements */
+    for (XDTAs99NativeStatement *statement in _statements) {
+        if (!isSupported) {
+            break;
+        }
+        _segment = statement.segment;
+        _location = statement.location;
+#if !__has_feature(objc_arc)
+        [statement.fileURL retain];
+        [_currentFile release];
+#endif
+        _currentFile = statement.fileURL;
+        _currentLine = statement.lineNumber;
+        isSupported = [self encodeStatement:statement];
+    }
+
+    if (!isSupported) {
+        if (NULL != reason) {
+#if !__has_feature(objc_arc)
+            [[_reason retain] autorelease];
+#endif
+            *reason = _reason;
+        }
+        return nil;
+    }
+
+    XDTAs99NativeProgram *retVal = [[XDTAs99NativeProgram alloc] initWithSegments:_segments symbols:_symbols refdefs:_refdefs sourceFiles:_sourceFiles entry:entry];
+    /* the program owns the memory of the segments now */
+    [_segments setLength:0];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (BOOL)giveUp:(NSString *)reason
+{
+    if (nil == _reason) {
+        NSString *location = (nil == _currentFile)? @"" : [NSString stringWithFormat:@"%@:%lu: ", [_currentFile lastPathComponent], (unsigned long)_currentLine];
+        _reason = [[location stringByAppendingString:reason] copy];
+    }
+    return NO;
+}
+
+
+- (void)releaseSegments
+{
+    XDTNativeSegment *segments = [_segments mutableBytes];
+    for (NSUInteger i = 0; i < [_segments length] / sizeof(XDTNativeSegment); i++) {
+        free(segments[i].memory);
+        free(segments[i].relocations);
+    }
+    [_segments setLength:0];
+}
+
+
+- (void)beginSegmentAt:(uint32_t)location relocatable:(BOOL)isRelocatable
+{
+    XDTNativeSegment segment = {isRelocatable, XDTNativeMemorySize, 0, calloc(XDTNativeMemorySize, 1), calloc(XDTNativeMemorySize / 16, 1), -1};
+    [_segments appendBytes:&segment length:sizeof(segment)];
+    _segment = [_segments length] / sizeof(XDTNativeSegment) - 1;
+    _location = location;
+}
+
+
+- (BOOL)isRelocatableLocation
+{
+    return ((const XDTNativeSegment *)[_segments bytes])[_segment].relocatable;
+}
+
+
+#pragma mark - First Pass
+
+
+- (BOOL)readFileAtURL:(NSURL *)fileURL depth:(NSUInteger)depth
+{
+    if (XDTNativeCopyDepth <= depth) {
+        return [self giveUp:@"COPY nested too deep"];
+    }
+    NSArray<XDTAs99NativeLine *> *lines = nil;
+    if (nil == _sourceCache) {
+        NSData *content = [NSData dataWithContentsOfURL:fileURL];
+        lines = (nil == content)? nil : [XDTAs99NativeAssembler linesOfContent:content];
+    } else {
+        lines = [_sourceCache linesOfFileAtURL:fileURL parsingContentWithBlock:^NSArray<XDTAs99NativeLine *> *(NSData *content) {
+            return [XDTAs99NativeAssembler linesOfContent:content];
+        }];
+    }
+    if (nil == lines) {
+        return [self giveUp:[NSString stringWithFormat:@"cannot read %@", [fileURL path]]];
+    }
+    [_sourceFiles addObject:fileURL];
+
+    NSURL *outerFile = _currentFile;
+    const NSUInteger outerLine = _currentLine;
+    _currentFile = [fileURL copy];
+    _currentLine = 0;
+    BOOL retVal = YES;
+    for (XDTAs99NativeLine *line in lines) {
+        if (!retVal || _ended) {
+            break;
+        }
+        _currentLine = line.lineNumber;
+        retVal = [self processLine:line depth:depth];
+    }
+#if !__has_feature(objc_arc)
+    [_currentFile release];
+#endif
+    _currentFile = outerFile;
+    _currentLine = outerLine;
+    return retVal;
+}
+
+
+- (NSURL *)URLOfCopiedFile:(NSString *)name includingURL:(NSURL *)fileURL
+{
+    NSMutableArray<NSURL *> *directories = [NSMutableArray arrayWithObject:[fileURL URLByDeletingLastPathComponent]];
+    [directories addObjectsFromArray:_includeURLs];
+    for (NSURL *directory in directories) {
+        NSURL *candidateURL = [directory URLByAppendingPathComponent:name];
+        if ([[NSFileManager defaultManager] fileExistsAtPath:[candidateURL path]]) {
+            return candidateURL;
+        }
+    }
+    return nil;
+}
+
+
+/*
+ All lines of a file are split, also those after END, which are not processed. So a line which cannot be split
+ becomes a failure which is given up on only when the line is processed.
+ */
++ (NSArray<XDTAs99NativeLine *> *)linesOfContent:(NSData *)content
+{
+    /* xas99 reads the sources byte by byte, ISO Latin 1 keeps every byte as one character */
+    NSMutableArray<XDTAs99NativeLine *> *retVal = [NSMutableArray array];
+    NSMutableData *text = [NSMutableData data];
+    const char *bytes = [content bytes];
+    const NSUInteger length = [content length];
+    NSUInteger lineNumber = 0;
+    for (NSUInteger start = 0, end = 0; start < length; start = end + 1) {
+        for (end = start; end < length && '\n' != bytes[end]; end++);
+        NSUInteger lineLength = end - start;
+        if (0 < lineLength && '\r' == bytes[start + lineLength - 1]) {
+            lineLength--;
+        }
+        lineNumber++;
+        XDTAs99NativeLine *line = nil;
+        if (NULL != memchr(bytes + start, '\0', lineLength)) {
+            line = XDTNativeFailedLine(lineNumber, @"NUL character in the source");
+        } else {
+            [text setLength:0];
+            [text appendBytes:bytes + start length:lineLength];
+            [text appendBytes:"" length:1];
+            line = [self lineOfText:[text bytes] number:lineNumber];
+        }
+        if (nil != line) {
+            [retVal addObject:line];
+        }
+    }
+    return retVal;
+}
+
+
+/*
+ A line consists of the fields label (starting in the first column), mnemonic, operands and comment, separated by
+ white space. The operand field ends at the first blank outside of quotes. A comment which starts like the
+ continuation of an expression may be part of the operands for xas99, so the assembler gives up on it.
+ Empty lines and comment lines have no fields and return nil.
+ */
++ (XDTAs99NativeLine *)lineOfText:(const char *)text number:(NSUInteger)lineNumber
+{
+    if ('\0' == text[0] || '*' == text[0] || ';' == text[0]) {
+        return nil;
+    }
+
+    XDTAs99NativeLine *retVal = [[XDTAs99NativeLine alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    retVal.lineNumber = lineNumber;
+    const char *position = text;
+    if (!isspace((unsigned char)*position)) {
+        const char *start = position;
+        while ('\0' != *position && !isspace((unsigned char)*position)) {
+            position++;
+        }
+        if (!XDTNativeIsSymbolName(start, position - start)) {
+            return XDTNativeFailedLine(lineNumber, @"label with special characters");
+        }
+        NSString *label = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+        retVal.label = label;
+#if !__has_feature(objc_arc)
+        [label release];
+#endif
+    }
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+    if ('\0' == *position || ';' == *position) {
+        return (nil == retVal.label)? nil : retVal;
+    }
+
+    const char *start = position;
+    while ('\0' != *position && !isspace((unsigned char)*position)) {
+        position++;
+    }
+    NSString *mnemonicField = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+    retVal.mnemonic = [mnemonicField uppercaseString];
+#if !__has_feature(objc_arc)
+    [mnemonicField release];
+#endif
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+
+    start = position;
+    char quote = '\0';
+    while ('\0' != *position && ('\0' != quote || (!isspace((unsigned char)*position) && ';' != *position))) {
+        if ('\0' == quote && ('\'' == *position || '"' == *position)) {
+            quote = *position;
+        } else if (quote == *position) {
+            quote = '\0';
+        }
+        position++;
+    }
+    if ('\0' != quote) {
+        return XDTNativeFailedLine(lineNumber, @"unterminated quote");
+    }
+    NSString *operandField = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+#if !__has_feature(objc_arc)
+    [operandField autorelease];
+#endif
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+    const BOOL hasContinuation = '\0' != *position && NULL != strchr("+-*/,()", *position);
+
+    /* instructions without operands and a few directives take the rest of the line as comment */
+    const XDTNativeInstruction *instruction = XDTNativeInstructionNamed([retVal.mnemonic UTF8String]);
+    const BOOL takesComment = (NULL != instruction && XDTNativeFormatNone == instruction->format) || XDTNativeIsListed([retVal.mnemonic UTF8String], XDTNativeListingDirectives);
+    retVal.operands = @[];
+    if (!takesComment && 0 < [operandField length]) {
+        if (hasContinuation) {
+            return XDTNativeFailedLine(lineNumber, @"blanks in the operand field");
+        }
+        retVal.operands = [self operandsOfField:operandField];
+        if (nil == retVal.operands) {
+            return XDTNativeFailedLine(lineNumber, @"empty operand");
+        }
+    }
+    return retVal;
+}
+
+
+/* Splits the operand field at the commas outside of quotes and parentheses */
++ (NSArray<NSString *> *)operandsOfField:(NSString *)field
+{
+    NSMutableArray<NSString *> *retVal = [NSMutableArray array];
+    const char *text = [field cStringUsingEncoding:NSISOLatin1StringEncoding];
+    const char *start = text;
+    char quote = '\0';
+    NSInteger depth = 0;
+    for (const char *position = text; ; position++) {
+        if ('\0' != quote) {
+            if (quote == *position) {
+                quote = '\0';
+            }
+            continue;
+        }
+        if ('\'' == *position || '"' == *position) {
+            quote = *position;
+        } else if ('(' == *position) {
+            depth++;
+        } else if (')' == *position) {
+            depth--;
+        } else if ('\0' == *position || (',' == *position && 0 == depth)) {
+            if (position == start) {
+                return nil;
+            }
+            NSString *operand = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+            [retVal addObject:operand];
+#if !__has_feature(objc_arc)
+            [operand release];
+#endif
+            if ('\0' == *position) {
+                break;
+            }
+            start = position + 1;
+        }
+    }
+    return retVal;
+}
+
+- (BOOL)processLine:(XDTAs99NativeLine *)line depth:(NSUInteger)depth
+{
+    if (nil != line.failure) {
+        return [self giveUp:line.failure];
+    }
+    if (nil == line.mnemonic) {
+        return [self defineLabel:line.label value:_location relocatable:[self isRelocatableLocation]];
+    }
+    return [self collectStatement:line.mnemonic operands:line.operands label:line.label depth:depth];
+}
+
+
+- (BOOL)defineLabel:(NSString *)label value:(int64_t)value relocatable:(BOOL)isRelocatable
+{
+    if (nil == label) {
+        return YES;
+    }
+    if (nil != [_symbols objectForKey:label]) {
+        return [self giveUp:[NSString stringWithFormat:@"duplicate symbol %@", label]];
+    }
+    if (0 > value || 0xFFFF < value) {
+        return [self giveUp:[NSString stringWithFormat:@"value of %@ out of range", label]];
+    }
+    [_symbols setObject:[NSNumber numberWithLongLong:value] forKey:label];
+    if (isRelocatable) {
+        [_relocatableSymbols addObject:label];
+    }
+    return YES;
+}
+
+
+- (BOOL)collectStatement:(NSString *)mnemonic operands:(NSArray<NSString *> *)operands label:(NSString *)label depth:(NSUInteger)depth
+{
+    const NSUInteger operandCount = [operands count];
+    const XDTNativeInstruction *instruction = XDTNativeInstructionNamed([mnemonic UTF8String]);
+    uint32_t length = 0;
+    BOOL isWordAligned = NO;
+    XDTNativeValue value;
+
+    if (NULL != instruction) {
+        static const NSUInteger operandCounts[] = {2, 2, 2, 1, 1, 2, 1, 2, 1, 1, 0};
+        if (operandCounts[instruction->format] != operandCount) {
+            return [self giveUp:[NSString stringWithFormat:@"wrong number of operands for %@", mnemonic]];
+        }
+        isWordAligned = YES;
+        length = 2;
+        switch (instruction->format) {
+            case XDTNativeFormatTwoGeneral:
+                length += XDTNativeGeneralLength(operands[0]) + XDTNativeGeneralLength(operands[1]);
+                break;
+            case XDTNativeFormatGeneralRegister:
+            case XDTNativeFormatGeneralCount:
+            case XDTNativeFormatGeneral:
+                length += XDTNativeGeneralLength(operands[0]);
+                break;
+            case XDTNativeFormatRegisterImmediate:
+            case XDTNativeFormatImmediate:
+                length += 2;
+                break;
+            default:
+                break;
+        }
+    } else if ([@"DATA" isEqualToString:mnemonic]) {
+        if (0 == operandCount) {
+            return [self giveUp:@"DATA without values"];
+        }
+        isWordAligned = YES;
+        length = 2 * (uint32_t)operandCount;
+    } else if ([@"BYTE" isEqualToString:mnemonic]) {
+        if (0 == operandCount) {
+            return [self giveUp:@"BYTE without values"];
+        }
+        length = (uint32_t)operandCount;
+    } else if ([@"TEXT" isEqualToString:mnemonic]) {
+        NSString *text = [operands firstObject];
+        if (1 != operandCount || 2 > [text length] || ![text hasPrefix:@"'"] || ![text hasSuffix:@"'"] ||
+            NSNotFound != [text rangeOfString:@"'" options:0 range:NSMakeRange(1, [text length] - 2)].location) {
+            return [self giveUp:@"TEXT other than a single simple string"];
+        }
+        length = (uint32_t)[text length] - 2;
+    } else if ([@"EVEN" isEqualToString:mnemonic]) {
+        isWordAligned = YES;
+    } else if ([@"BSS" isEqualToString:mnemonic] || [@"BES" isEqualToString:mnemonic]) {
+        if (1 != operandCount || XDTNativeEvaluationDone != [self evaluate:operands[0] value:&value] ||
+            0 != value.relocation || 0 > value.value || XDTNativeMemorySize < value.value) {
+            return [self giveUp:[NSString stringWithFormat:@"%@ of an unknown size", mnemonic]];
+        }
+        if ([@"BES" isEqualToString:mnemonic]) {
+            _location += (uint32_t)value.value;
+            return (XDTNativeMemorySize >= _location)? [self defineLabel:label value:_location relocatable:[self isRelocatableLocation]] : [self giveUp:@"location out of range"];
+        }
+        length = (uint32_t)value.value;
+    } else if ([@"AORG" isEqualToString:mnemonic]) {
+        if (nil != label || 1 != operandCount || XDTNativeEvaluationDone != [self evaluate:operands[0] value:&value] ||
+            0 != value.relocation || 0 > value.value || 0xFFFF < value.value) {
+            return [self giveUp:@"AORG with a label or an unknown address"];
+        }
+        [self beginSegmentAt:(uint32_t)value.value relocatable:NO];
+        return YES;
+    } else if ([@"EQU" isEqualToString:mnemonic]) {
+        if (nil == label || 1 != operandCount) {
+            return [self giveUp:@"EQU without a label"];
+        }
+        switch ([self evaluate:operands[0] value:&value]) {
+            case XDTNativeEvaluationDone:
+                if (0 != value.relocation && 1 != value.relocation) {
+                    return [self giveUp:@"EQU of a complex relocatable value"];
+                }
+                return [self defineLabel:label value:value.value relocatable:1 == value.relocation];
+            case XDTNativeEvaluationUndefined:
+                if (nil != [_symbols objectForKey:label]) {
+                    return [self giveUp:[NSString stringWithFormat:@"duplicate symbol %@", label]];
+                }
+                [_pendingEquates addObject:@[label, operands[0], [NSNumber numberWithUnsignedInt:_location], [NSNumber numberWithUnsignedInteger:_segment]]];
+                return YES;
+            default:
+                return [self giveUp:@"unsupported expression"];
+        }
+    } else if ([@"END" isEqualToString:mnemonic]) {
+        if (nil != label || 1 < operandCount) {
+            return [self giveUp:@"END with a label"];
+        }
+        _entryExpression = [[operands firstObject] copy];
+        _ended = YES;
+        return YES;
+    } else if ([@"DEF" isEqualToString:mnemonic]) {
+        for (NSString *name in operands) {
+            const char *nameText = [name cStringUsingEncoding:NSISOLatin1StringEncoding];
+            if (!XDTNativeIsSymbolName(nameText, strlen(nameText))) {
+                return [self giveUp:@"DEF of an invalid name"];
+            }
+            [_refdefs addObject:name];
+        }
+        return (nil == label)? YES : [self giveUp:@"DEF with a label"];
+    } else if ([@"COPY" isEqualToString:mnemonic]) {
+        NSString *name = [operands firstObject];
+        if (nil != label || 1 != operandCount || 3 > [name length] || ![name hasPrefix:@"\""] || ![name hasSuffix:@"\""]) {
+            return [self giveUp:@"COPY other than a quoted file name"];
+        }
+        NSURL *copiedURL = [self URLOfCopiedFile:[name substringWithRange:NSMakeRange(1, [name length] - 2)] includingURL:_currentFile];
+        if (nil == copiedURL) {
+            return [self giveUp:[NSString stringWithFormat:@"copied file %@ not found", name]];
+        }
+        return [self readFileAtURL:copiedURL depth:depth + 1];
+    } else if (XDTNativeIsListed([mnemonic UTF8String], XDTNativeIgnoredDirectives)) {
+        return (nil == label)? YES : [self giveUp:[NSString stringWithFormat:@"%@ with a label", mnemonic]];
+    } else {
+        return [self giveUp:[NSString stringWithFormat:@"%@ is not supported natively", mnemonic]];
+    }
+
+    if (isWordAligned && 0 != (_location & 1)) {
+        if (nil != label) {
+            return [self giveUp:@"label at an odd location"];
+        }
+        _location++;
+    }
+    if (![self defineLabel:label value:_location relocatable:[self isRelocatableLocation]]) {
+        return NO;
+    }
+    if (0 < length || NULL != instruction || [@"DATA" isEqualToString:mnemonic] || [@"BYTE" isEqualToString:mnemonic]) {
+        XDTAs99NativeStatement *statement = [[XDTAs99NativeStatement alloc] init];
+        statement.mnemonic = mnemonic;
+        statement.operands = operands;
+        statement.segment = _segment;
+        statement.location = _location;
+        statement.fileURL = _currentFile;
+        statement.lineNumber = _currentLine;
+        [_statements addObject:statement];
+#if !__has_feature(objc_arc)
+        [statement release];
+#endif
+    }
+    _location += length;
+    return (XDTNativeMemorySize >= _location)? YES : [self giveUp:@"location out of range"];
+}
+
+
+/* EQU may refer to symbols which are defined later, they are resolved as soon as all their symbols are known */
+- (BOOL)resolvePendingEquates
+{
+    const NSUInteger savedSegment = _segment;
+    const uint32_t savedLocation = _location;
+    BOOL isResolving = YES;
+    while (0 < [_pendingEquates count] && isResolving) {
+        isResolving = NO;
+        for (NSArray *equate in [NSArray arrayWithArray:_pendingEquates]) {
+            XDTNativeValue value;
+            _segment = [[equate objectAtIndex:3] unsignedIntegerValue];
+            _location = [[equate objectAtIndex:2] unsignedIntValue];
+            XDTNativeEvaluation evaluation = [self evaluate:[equate objectAtIndex:1] value:&value];
+            if (XDTNativeEvaluationUndefined == evaluation) {
+                continue;
+            }
+            if (XDTNativeEvaluationDone != evaluation || (0 != value.relocation && 1 != value.relocation) ||
+                ![self defineLabel:[equate objectAtIndex:0] value:value.value relocatable:1 == value.relocation]) {
+                _segment = savedSegment;
+                _location = savedLocation;
+                return [self giveUp:@"unsupported EQU"];
+            }
+            [_pendingEquates removeObject:equate];
+            isResolving = YES;
+        }
+    }
+    _segment = savedSegment;
+    _location = savedLocation;
+    return (0 == [_pendingEquates count])? YES : [self giveUp:@"EQU of undefined symbols"];
+}
+
+
+#pragma mark - Expressions
+
+
+/*
+ Expressions are evaluated strictly from left to right like xas99 does, only parentheses change the order. Terms are
+ decimal numbers, hexadecimal numbers with ">", binary numbers with ":", characters in quotes, "$" and symbols.
+ */
+- (XDTNativeEvaluation)evaluate:(NSString *)expression value:(XDTNativeValue *)value
+{
+    const char *text = [expression cStringUsingEncoding:NSISOLatin1StringEncoding];
+    if (NULL == text || '\0' == *text) {
+        return XDTNativeEvaluationUnsupported;
+    }
+    const char *position = text;
+    XDTNativeEvaluation retVal = [self evaluateExpression:&position value:value];
+    if ('\0' != *position) {
+        return XDTNativeEvaluationUnsupported;
+    }
+    return retVal;
+}
+
+
+- (XDTNativeEvaluation)evaluateExpression:(const char **)position value:(XDTNativeValue *)value
+{
+    XDTNativeEvaluation retVal = [self evaluateTerm:position value:value];
+    while (XDTNativeEvaluationUnsupported != retVal && '\0' != **position && ')' != **position) {
+        const char operator = **position;
+        if (NULL == strchr("+-*/", operator)) {
+            return XDTNativeEvaluationUnsupported;
+        }
+        (*position)++;
+        XDTNativeValue term;
+        XDTNativeEvaluation evaluation = [self evaluateTerm:position value:&term];
+        if (XDTNativeEvaluationDone != evaluation) {
+            retVal = (XDTNativeEvaluationUnsupported == evaluation)? evaluation : XDTNativeEvaluationUndefined;
+            continue;
+        }
+        if (XDTNativeEvaluationUndefined == retVal) {
+            continue;
+        }
+        switch (operator) {
+            case '+':
+                value->value += term.value;
+                value->relocation += term.relocation;
+                break;
+            case '-':
+                value->value -= term.value;
+                value->relocation -= term.relocation;
+                break;
+            case '*':
+                if (0 != value->relocation || 0 != term.relocation) {
+                    return XDTNativeEvaluationUnsupported;
+                }
+                value->value *= term.value;
+                break;
+            default:
+                /* Python rounds divisions of negative numbers down, and values above 16 bits may have been cut before */
+                if (0 != value->relocation || 0 != term.relocation || 0 >= term.value || 0 > value->value || 0xFFFF < value->value) {
+                    return XDTNativeEvaluationUnsupported;
+                }
+                value->value /= term.value;
+                break;
+        }
+        if (0x7FFFFFFF < llabs(value->value)) {
+            return XDTNativeEvaluationUnsupported;
+        }
+    }
+    return retVal;
+}
+
+
+- (XDTNativeEvaluation)evaluateTerm:(const char **)position value:(XDTNativeValue *)value
+{
+    const char *text = *position;
+    value->value = 0;
+    value->relocation = 0;
+
+    if ('-' == *text || '+' == *text) {
+        (*position)++;
+        XDTNativeEvaluation retVal = [self evaluateTerm:position value:value];
+        if ('-' == *text) {
+            value->value = -value->value;
+            value->relocation = -value->relocation;
+        }
+        return retVal;
+    }
+    if ('(' == *text) {
+        (*position)++;
+        XDTNativeEvaluation retVal = [self evaluateExpression:position value:value];
+        if (')' != **position) {
+            return XDTNativeEvaluationUnsupported;
+        }
+        (*position)++;
+        return retVal;
+    }
+    if ('>' == *text || ':' == *text || isdigit((unsigned char)*text)) {
+        const int base = ('>' == *text)? 16 : ((':' == *text)? 2 : 10);
+        const char *digits = isdigit((unsigned char)*text)? text : text + 1;
+        const char *end = digits;
+        while (isalnum((unsigned char)*end)) {
+            end++;
+        }
+        if (end == digits || 8 < end - digits) {
+            return XDTNativeEvaluationUnsupported;
+        }
+        char *parsedEnd = NULL;
+        char buffer[9] = {0};
+        memcpy(buffer, digits, end - digits);
+        value->value = strtol(buffer, &parsedEnd, base);
+        if ('\0' != *parsedEnd) {
+            return XDTNativeEvaluationUnsupported;
+        }
+        *position = end;
+        return XDTNativeEvaluationDone;
+    }
+    if ('\'' == *text) {
+        const char *end = strchr(text + 1, '\'');
+        if (NULL == end || '\'' == end[1] || end == text + 1 || 2 < end - text - 1) {
+            return XDTNativeEvaluationUnsupported;
+        }
+        for (const char *c = text + 1; c < end; c++) {
+            value->value = (value->value << 8) | (unsigned char)*c;
+        }
+        *position = end + 1;
+        return XDTNativeEvaluationDone;
+    }
+    if ('$' == *text) {
+        if (isalnum((unsigned char)text[1]) || '_' == text[1]) {
+            return XDTNativeEvaluationUnsupported;
+        }
+        value->value = _location;
+        value->relocation = [self isRelocatableLocation]? 1 : 0;
+        *position = text + 1;
+        return XDTNativeEvaluationDone;
+    }
+    if (isalpha((unsigned char)*text) || '_' == *text) {
+        const char *end = text;
+        while (isalnum((unsigned char)*end) || '_' == *end) {
+            end++;
+        }
+        NSString *name = [[NSString alloc] initWithBytes:text length:end - text encoding:NSISOLatin1StringEncoding];
+#if !__has_feature(objc_arc)
+        [name autorelease];
+#endif
+        *position = end;
+        NSNumber *symbolValue = [_symbols objectForKey:name];
+        if (nil == symbolValue) {
+            return XDTNativeEvaluationUndefined;
+        }
+        value->value = [symbolValue longLongValue];
+        value->relocation = [_relocatableSymbols containsObject:name]? 1 : 0;
+        return XDTNativeEvaluationDone;
+    }
+    return XDTNativeEvaluationUnsupported;
+}
+
+
+#pragma mark - Second Pass
+
+
+- (BOOL)encodeStatement:(XDTAs99NativeStatement *)statement
+{
+    NSString *mnemonic = statement.mnemonic;
+    NSArray<NSString *> *operands = statement.operands;
+    XDTNativeValue value;
+
+    if ([@"DATA" isEqualToString:mnemonic]) {
+        for (NSString *operand in operands) {
+            if (![self valueOf:operand value:&value] || -0x8000 > value.value || 0xFFFF < value.value || ![self emitWord:value.value relocation:value.relocation]) {
+                return [self giveUp:@"DATA out of range"];
+            }
+        }
+        return YES;
+    }
+    if ([@"BYTE" isEqualToString:mnemonic]) {
+        for (NSString *operand in operands) {
+            if (![self valueOf:operand value:&value] || 0 != value.relocation || -0x80 > value.value || 0xFF < value.value || ![self emitByte:value.value]) {
+                return [self giveUp:@"BYTE out of range"];
+            }
+        }
+        return YES;
+    }
+    if ([@"TEXT" isEqualToString:mnemonic]) {
+        const char *text = [operands[0] cStringUsingEncoding:NSISOLatin1StringEncoding];
+        for (NSUInteger i = 1; '\0' != text[i + 1]; i++) {
+            if (![self emitByte:(unsigned char)text[i]]) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+    if ([@"BSS" isEqualToString:mnemonic]) {
+        return YES;
+    }
+
+    const XDTNativeInstruction *instruction = XDTNativeInstructionNamed([mnemonic UTF8String]);
+    uint16_t word = instruction->opcode;
+    XDTNativeValue words[2];
+    BOOL hasWords[2] = {NO, NO};
+    uint16_t field, number;
+    int64_t count;
+    switch (instruction->format) {
+        case XDTNativeFormatTwoGeneral:
+            if (![self general:operands[0] field:&field word:&words[0] hasWord:&hasWords[0]]) {
+                return NO;
+            }
+            word |= field;
+            if (![self general:operands[1] field:&field word:&words[1] hasWord:&hasWords[1]]) {
+                return NO;
+            }
+            word |= field << 6;
+            break;
+        case XDTNativeFormatGeneralRegister:
+        case XDTNativeFormatGeneralCount:
+            if (![self general:operands[0] field:&field word:&words[0] hasWord:&hasWords[0]]) {
+                return NO;
+            }
+            word |= field;
+            if (XDTNativeFormatGeneralRegister == instruction->format) {
+                if (![self register:operands[1] number:&number]) {
+                    return NO;
+                }
+                word |= number << 6;
+            } else {
+                /* a count of 16 is encoded as 0 by the assembler of TI, which is left to xas99 */
+                if (![self number:operands[1] minimum:0 maximum:15 value:&count]) {
+                    return NO;
+                }
+                word |= (uint16_t)count << 6;
+            }
+            break;
+        case XDTNativeFormatJump: {
+            if (![self valueOf:operands[0] value:&value]) {
+                return NO;
+            }
+            const int64_t displacement = value.value - (_location + 2);
+            if (value.relocation != ([self isRelocatableLocation]? 1 : 0) || 0 != (displacement & 1) || -256 > displacement || 254 < displacement) {
+                return [self giveUp:@"jump out of range"];
+            }
+            word |= (uint16_t)((displacement / 2) & 0xFF);
+            break;
+        }
+        case XDTNativeFormatCRU:
+            if (![self number:operands[0] minimum:-128 maximum:127 value:&count]) {
+                return NO;
+            }
+            word |= (uint16_t)(count & 0xFF);
+            break;
+        case XDTNativeFormatShift:
+            if (![self register:operands[0] number:&number] || ![self number:operands[1] minimum:0 maximum:15 value:&count]) {
+                return NO;
+            }
+            word |= number | (uint16_t)count << 4;
+            break;
+        case XDTNativeFormatGeneral:
+            if (![self general:operands[0] field:&field word:&words[0] hasWord:&hasWords[0]]) {
+                return NO;
+            }
+            word |= field;
+            break;
+        case XDTNativeFormatRegisterImmediate:
+            if (![self register:operands[0] number:&number] || ![self valueOf:operands[1] value:&words[0]]) {
+                return NO;
+            }
+            word |= number;
+            hasWords[0] = YES;
+            break;
+        case XDTNativeFormatRegister:
+            if (![self register:operands[0] number:&number]) {
+                return NO;
+            }
+            word |= number;
+            break;
+        case XDTNativeFormatImmediate:
+            if (![self valueOf:operands[0] value:&words[0]]) {
+                return NO;
+            }
+            hasWords[0] = YES;
+            break;
+        case XDTNativeFormatNone:
+            break;
+    }
+
+    if (![self emitWord:word relocation:0]) {
+        return NO;
+    }
+    for (NSUInteger i = 0; i < 2; i++) {
+        if (hasWords[i] && (-0x8000 > words[i].value || 0xFFFF < words[i].value || ![self emitWord:words[i].value relocation:words[i].relocation])) {
+            return [self giveUp:@"value out of range"];
+        }
+    }
+    return YES;
+}
+
+
+/* A value of the second pass, where all symbols must be defined */
+- (BOOL)valueOf:(NSString *)expression value:(XDTNativeValue *)value
+{
+    switch ([self evaluate:expression value:value]) {
+        case XDTNativeEvaluationDone:
+            if (0 != value->relocation && 1 != value->relocation) {
+                return [self giveUp:@"complex relocatable expression"];
+            }
+            return YES;
+        case XDTNativeEvaluationUndefined:
+            return [self giveUp:[NSString stringWithFormat:@"undefined symbol in %@", expression]];
+        default:
+            return [self giveUp:[NSString stringWithFormat:@"unsupported expression %@", expression]];
+    }
+}
+
+
+- (BOOL)register:(NSString *)operand number:(uint16_t *)number
+{
+    /* xas99 warns about every other register notation, when the R option is set */
+    if (_useRegisterSymbols && _outputWarnings) {
+        NSUInteger registerNumber = [[operand substringFromIndex:MIN(1, [operand length])] integerValue];
+        if (![operand isEqualToString:[NSString stringWithFormat:@"R%lu", (unsigned long)registerNumber]]) {
+            return [self giveUp:@"register without R"];
+        }
+    }
+    int64_t value;
+    if (![self number:operand minimum:0 maximum:15 value:&value]) {
+        return NO;
+    }
+    *number = (uint16_t)value;
+    return YES;
+}
+
+
+- (BOOL)number:(NSString *)operand minimum:(int64_t)minimum maximum:(int64_t)maximum value:(int64_t *)number
+{
+    XDTNativeValue value;
+    if (![self valueOf:operand value:&value]) {
+        return NO;
+    }
+    if (0 != value.relocation || minimum > value.value || maximum < value.value) {
+        return [self giveUp:[NSString stringWithFormat:@"%@ out of range", operand]];
+    }
+    *number = value.value;
+    return YES;
+}
+
+
+/* Encodes a general address operand into the mode and register bits (Ts, S) and the additional word */
+- (BOOL)general:(NSString *)operand field:(uint16_t *)field word:(XDTNativeValue *)word hasWord:(BOOL *)hasWord
+{
+    uint16_t number;
+    *hasWord = NO;
+    if ([operand hasPrefix:@"*"]) {
+        const BOOL isIncrement = [operand hasSuffix:@"+"];
+        NSString *registerText = [operand substringWithRange:NSMakeRange(1, [operand length] - (isIncrement? 2 : 1))];
+        if (0 == [registerText length]) {
+            return [self giveUp:@"indirect address without register"];
+        }
+        if (![self register:registerText number:&number]) {
+            return NO;
+        }
+        *field = (isIncrement? 0x30 : 0x10) | number;
+        return YES;
+    }
+    if ([operand hasPrefix:@"@"]) {
+        NSString *address = [operand substringFromIndex:1];
+        number = 0;
+        if ([address hasSuffix:@")"]) {
+            /* the index register is the last parenthesized part, "@(A+B)" has none */
+            NSInteger depth = 0;
+            NSUInteger index = [address length];
+            while (0 < index) {
+                unichar c = [address characterAtIndex:--index];
+                if (')' == c) {
+                    depth++;
+                } else if ('(' == c && 0 == --depth) {
+                    break;
+                }
+            }
+            if (0 < index) {
+                if (![self register:[address substringWithRange:NSMakeRange(index + 1, [address length] - index - 2)] number:&number]) {
+                    return NO;
+                }
+                if (0 == number) {
+                    return [self giveUp:@"index register R0"];
+                }
+                address = [address substringToIndex:index];
+            }
+        }
+        if (![self valueOf:address value:word]) {
+            return NO;
+        }
+        *field = 0x20 | number;
+        *hasWord = YES;
+        return YES;
+    }
+    if (![self register:operand number:&number]) {
+        return NO;
+    }
+    *field = number;
+    return YES;
+}
+
+
+- (BOOL)emitWord:(int64_t)value relocation:(int)relocation
+{
+    if (XDTNativeMemorySize < _location + 2) {
+        return [self giveUp:@"location out of range"];
+    }
+    XDTNativeSegment *segment = (XDTNativeSegment *)[_segments mutableBytes] + _segment;
+    segment->memory[_location] = (value >> 8) & 0xFF;
+    segment->memory[_location + 1] = value & 0xFF;
+    if (0 != relocation) {
+        segment->relocations[_location >> 4] |= 1 << ((_location >> 1) & 7);
+    }
+    segment->low = MIN(segment->low, _location);
+    segment->high = MAX(segment->high, _location + 2);
+    _location += 2;
+    return YES;
+}
+
+
+- (BOOL)emitByte:(int64_t)value
+{
+    if (XDTNativeMemorySize < _location + 1) {
+        return [self giveUp:@"location out of range"];
+    }
+    XDTNativeSegment *segment = (XDTNativeSegment *)[_segments mutableBytes] + _segment;
+    segment->memory[_location] = value & 0xFF;
+    segment->low = MIN(segment->low, _location);
+    segment->high = MAX(segment->high, _location + 1);
+    _location++;
+    return YES;
+}
+
+@end
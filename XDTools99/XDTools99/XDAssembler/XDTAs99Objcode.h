@@ -37,7 +37,7 @@ typedef NS_ENUM(NSUInteger, XDTGenerateTextMode) {
     XDTGenerateTextModeOptionReverse = 1 << 3,  /* reverse byte order for target platforms with different endianness */
 };
 
-@class XDTAs99Symbols;
+@class XDTAs99Symbols, XDTCrossReference, XDTAddressMap, XDTCartridgeBuilder;
 
 
 NS_ASSUME_NONNULL_BEGIN
@@ -45,6 +45,7 @@ NS_ASSUME_NONNULL_BEGIN
 @interface XDTAs99Objcode : XDTObject
 
 @property (retain) XDTAs99Symbols *symbols;
+@property (readonly, nullable, retain) XDTCrossReference *crossReference;   /* Only built when the assembler has the cross-reference option set */
 
 /**
  *
@@ -55,16 +56,48 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable NSData *)generateDump:(NSError **)error;
 - (nullable NSData *)generateObjCode:(BOOL)shouldCompress error:(NSError **)error;
 - (nullable NSArray<NSArray<id> *> *)generateRawBinaryAt:(NSUInteger)baseAddr error:(NSError **)error;
+/* Ranges are NSRange values of addresses: one zero-filled binary for each range and bank, like the save option of xas99 */
 - (nullable NSArray<NSArray<id> *> *)generateRawBinaryAt:(NSUInteger)baseAddr withRanges:(NSArray<NSValue *> *)ranges error:(NSError **)error;
+/* The binaries of all base addresses, relocated natively in parallel once two of them are known */
+- (nullable NSDictionary<NSNumber *, NSArray<NSArray<id> *> *> *)generateRawBinariesAt:(NSArray<NSNumber *> *)baseAddrs error:(NSError **)error;
 - (nullable NSString *)generateTextAt:(NSUInteger)baseAddr withMode:(XDTGenerateTextMode)mode error:(NSError **)error;
 - (nullable NSArray<NSData *> *)generateImageAt:(NSUInteger)baseAddr error:(NSError **)error;
 - (nullable NSArray<NSData *> *)generateImageAt:(NSUInteger)baseAddr withChunkSize:(NSUInteger)chunkSize error:(NSError **)error;
+- (nullable NSDictionary<NSNumber *, NSArray<NSData *> *> *)generateImagesAt:(NSArray<NSNumber *> *)baseAddrs withChunkSize:(NSUInteger)chunkSize error:(NSError **)error;
 - (nullable NSData *)generateBasicLoader:(NSError **)error;
 - (nullable NSDictionary<NSString *, NSData *> *)generateMESSCartridgeWithName:(NSString *)cartridgeName error:(NSError **)error;
+/* Streams the cartridge into the package file, natively built for relocatable programs of the native assembler */
+- (BOOL)writeMESSCartridgeWithName:(NSString *)cartridgeName toURL:(NSURL *)url error:(NSError **)error;
 
 - (nullable NSData *)generateListing:(BOOL)outputSymbols error:(NSError **)error;
 - (nullable NSData *)generateSymbols:(BOOL)useEqu error:(NSError **)error;
 
+/* Source lines by address and addresses by source line, built once from the listing and kept afterwards */
+- (nullable XDTAddressMap *)addressMap:(NSError **)error;
+/* The symbols, XOPs, REF/DEF flags and the address map as the content of an XDTDebugInfo file, also after detaching */
+- (nullable NSData *)generateDebugInfo:(NSError **)error;
+
+/*
+ The Python object code holds the whole intermediate program as long as it is referenced. Detaching captures the
+ listings, the symbol tables and the symbols into native buffers and releases the Python objects. All outputs which
+ were generated before are kept as well, so generate the binaries first which are needed afterwards. Any other
+ output fails with XDTErrorCodeDetachedObject once the object is detached.
+
+ Object code of the native assembler generates program images and raw binaries natively, also after detaching.
+ For all other outputs the source is assembled by xas99 at their first use, unless a source file has changed.
+ Once xas99 has generated the raw binaries at two base addresses, the relocation of the program is known and all
+ further base addresses are relocated natively as well, also after detaching.
+
+ Until detaching, the memory budget may remove the captured outputs, because they are generated again at their next
+ use. Detaching captures only the listings and symbols anew, so generate the needed binaries right before detaching.
+ */
+@property (readonly, getter=isDetached) BOOL detached;
+@property (readonly, getter=isNative) BOOL native;
+@property (readonly, nullable) NSArray<NSURL *> *sourceFiles;   /* The source file and all copied files, nil unless assembled natively */
+
+- (BOOL)materializeAndDetach:(NSError **)error;
+- (NSUInteger)removeRegenerableOutputs;    /* Returns the freed bytes, nothing is freed once detached */
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -28,7 +28,16 @@
 #import "NSArrayPythonAdditions.h"
 #import "NSDataPythonAdditions.h"
 #import "NSErrorPythonAdditions.h"
+#import "XDTInstrumentation.h"
 #import "XDTAs99Symbols.h"
+#import "XDTCrossReference.h"
+#import "XDTAddressMap.h"
+#import "XDTDebugInfo.h"
+#import "XDTCartridgeBuilder.h"
+#import "XDTAssembler.h"
+#import "XDTAs99NativeAssembler.h"
+#import "XDTMemoryBudget.h"
+#import "XDTPythonGIL.h"
 
 
 #define XDTClassNameObjcode "Objcode"
@@ -36,15 +45,64 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@interface XDTObject ()
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
+
+@end
+
+
+@interface XDTAssembler ()
+
+- (nullable PyObject *)pythonResultOfSourceFile:(NSString *)baseName pathName:(NSString *)dirName error:(NSError **)error;
+
+@end
+
+
+@interface XDTAs99Symbols ()
+
++ (instancetype)symbolsWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs;
+
+@end
+
+
 @interface XDTAs99Objcode () {
     PyObject *objectcodePythonClass;
+
+    /* Program of the native assembler, and the assembler and source for the outputs which xas99 generates */
+    XDTAs99NativeProgram *nativeProgram;
+    XDTAssembler *fallbackAssembler;
+    NSURL *fallbackSourceFile;
+
+    /* Code and relocation captured from the raw binaries of two base addresses, which relocates all others natively */
+    XDTAs99NativeProgram *capturedProgram;
+    NSNumber *firstBinariesAddress;
+    BOOL hasUnrelocatableBinaries;
+
+    /* Outputs of the generators by their Python call, so they remain available when detached */
+    NSMutableDictionary<NSString *, id> *capturedOutputs;
+    XDTAs99Symbols *capturedSymbols;
+    XDTAddressMap *capturedAddressMap;
 }
 
+@property (nullable, retain) XDTCrossReference *crossReference;
+
 + (nullable instancetype)objectcodeWithPythonInstance:(void *)object;
++ (nullable instancetype)objectcodeWithNativeProgram:(XDTAs99NativeProgram *)program assembler:(XDTAssembler *)assembler sourceFile:(NSURL *)srcFile;
 
 - (nullable instancetype)initWithPythonInstance:(PyObject *)object;
+- (nullable instancetype)initWithNativeProgram:(XDTAs99NativeProgram *)program assembler:(XDTAssembler *)assembler sourceFile:(NSURL *)srcFile;
+
+- (BOOL)loadPythonObjectcode:(NSError **)error;
 
 - (nullable PyObject *)generateBinariesAt:(NSUInteger)baseAddr error:(NSError **)error;
+- (nullable XDTAs99NativeProgram *)relocatableProgram;
+- (void)captureProgramWithBinaries:(NSArray<NSArray<id> *> *)binaries at:(NSUInteger)baseAddr;
+- (void)captureOutputsForKeys:(NSArray<NSString *> *)outputKeys at:(NSArray<NSNumber *> *)baseAddrs ofProgram:(XDTAs99NativeProgram *)program phase:(NSString *)phaseName generator:(id (^)(XDTAs99NativeProgram *program, NSUInteger baseAddr))generator;
+- (nullable XDTCartridgeBuilder *)nativeCartridgeBuilderWithName:(NSString *)cartridgeName;
+
+- (nullable id)capturedOutputForKey:(NSString *)outputKey error:(NSError **)error;
+- (void)captureOutput:(nullable id)output forKey:(NSString *)outputKey;
 
 @end
 
@@ -66,6 +124,7 @@ NS_ASSUME_NONNULL_END
 
 + (nullable instancetype)objectcodeWithPythonInstance:(void *)object
 {
+    XDTAcquireGIL();
     XDTAs99Objcode *retVal = [[XDTAs99Objcode alloc] initWithPythonInstance:(PyObject *)object];
 #if !__has_feature(objc_arc)
     [retVal autorelease];
@@ -76,6 +135,7 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithPythonInstance:(PyObject *)object
 {
+    XDTAcquireGIL();
     self = [super init];
     if (nil == self) {
         return nil;
@@ -83,6 +143,43 @@ NS_ASSUME_NONNULL_END
 
     objectcodePythonClass = object;
     Py_INCREF(objectcodePythonClass);
+    capturedOutputs = [[NSMutableDictionary alloc] init];
+    capturedSymbols = nil;
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
+
+    return self;
+}
+
+
++ (nullable instancetype)objectcodeWithNativeProgram:(XDTAs99NativeProgram *)program assembler:(XDTAssembler *)assembler sourceFile:(NSURL *)srcFile
+{
+    XDTAs99Objcode *retVal = [[XDTAs99Objcode alloc] initWithNativeProgram:program assembler:assembler sourceFile:srcFile];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithNativeProgram:(XDTAs99NativeProgram *)program assembler:(XDTAssembler *)assembler sourceFile:(NSURL *)srcFile
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    objectcodePythonClass = NULL;
+    capturedOutputs = [[NSMutableDictionary alloc] init];
+    capturedSymbols = [XDTAs99Symbols symbolsWithSymbols:[program symbols] refdefs:[program refdefs]];
+    nativeProgram = program;
+    fallbackAssembler = assembler;
+    fallbackSourceFile = [srcFile copy];
+#if !__has_feature(objc_arc)
+    [capturedSymbols retain];
+    [nativeProgram retain];
+    [fallbackAssembler retain];
+#endif
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
 
     return self;
 }
@@ -90,8 +187,19 @@ NS_ASSUME_NONNULL_END
 
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(objectcodePythonClass);
 #if !__has_feature(objc_arc)
+    [capturedOutputs release];
+    [capturedSymbols release];
+    [capturedAddressMap release];
+    [nativeProgram release];
+    [capturedProgram release];
+    [firstBinariesAddress release];
+    [fallbackAssembler release];
+    [fallbackSourceFile release];
+    [_crossReference release];
+
     [super dealloc];
 #endif
 }
@@ -102,8 +210,14 @@ NS_ASSUME_NONNULL_END
 
 - (XDTAs99Symbols *)symbols
 {
+    XDTAcquireGIL();
+    if (nil != capturedSymbols) {
+        return capturedSymbols;
+    }
+
     PyObject *symbolObject = PyObject_GetAttrString(objectcodePythonClass, "symbols");
     XDTAs99Symbols *codeSymbols = [XDTAs99Symbols symbolsWithPythonInstance:symbolObject];
+    codeSymbols.instrumentation = self.instrumentation;
     Py_XDECREF(symbolObject);
 
     return codeSymbols;
@@ -116,6 +230,173 @@ NS_ASSUME_NONNULL_END
 }
 
 
+#pragma mark - Detaching
+
+
+- (BOOL)isDetached
+{
+    return NULL == objectcodePythonClass && nil == fallbackAssembler;
+}
+
+
+- (BOOL)isNative
+{
+    return nil != nativeProgram;
+}
+
+
+- (NSArray<NSURL *> *)sourceFiles
+{
+    return nativeProgram.sourceFiles;
+}
+
+
+/*
+ Object code of the native assembler has no Python object until an output is needed which only xas99 generates.
+ The source is assembled again then, but only if none of the source files has changed since the native assembling,
+ otherwise the outputs would not belong together.
+ */
+- (BOOL)loadPythonObjectcode:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (NULL != objectcodePythonClass) {
+        return YES;
+    }
+    if (nil == fallbackAssembler || ![nativeProgram hasUnchangedSources]) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            NSDictionary *errorDict = @{
+                                        NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Output not available", nil, myBundle, @"Description for an error object, discribing that an output of a detached object code cannot be generated anymore."),
+                                        NSLocalizedRecoverySuggestionErrorKey: NSLocalizedStringFromTableInBundle(@"The source files have changed since assembling. Assemble the source again.", nil, myBundle, @"Recovery suggestion for an error object, which explains that the output of natively assembled code cannot be generated by xas99 anymore.")
+                                        };
+            *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeDetachedObject userInfo:errorDict];
+        }
+        return NO;
+    }
+
+    PyObject *pValueTupel = [fallbackAssembler pythonResultOfSourceFile:[fallbackSourceFile lastPathComponent] pathName:[[fallbackSourceFile URLByDeletingLastPathComponent] path] error:error];
+    if (NULL == pValueTupel) {
+        return NO;
+    }
+    objectcodePythonClass = PyTuple_GetItem(pValueTupel, 0);
+    Py_XINCREF(objectcodePythonClass);
+    Py_DECREF(pValueTupel);
+
+    return NULL != objectcodePythonClass;
+}
+
+
+/*
+ Generating the same output twice returns the same result, because the object code does not change after
+ assembling. So every generated output is kept by the key of its Python call, e.g. "generate_list:1", and the
+ generators look it up first. This is also the only source of outputs after detaching.
+ */
+- (id)capturedOutputForKey:(NSString *)outputKey error:(NSError **)error
+{
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
+    id retVal = [capturedOutputs objectForKey:outputKey];
+    if (nil == retVal && self.isDetached && nil != error) {
+        NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+        NSDictionary *errorDict = @{
+                                    NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Output not available", nil, myBundle, @"Description for an error object, discribing that an output of a detached object code cannot be generated anymore."),
+                                    NSLocalizedRecoverySuggestionErrorKey: [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"%@ was not generated before the object code was detached from Python. Assemble the source again.", nil, myBundle, @"Recovery suggestion for an error object, which explains that the given output was not captured before detaching."), outputKey]
+                                    };
+        *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeDetachedObject userInfo:errorDict];
+    }
+
+    return retVal;
+}
+
+
+- (void)captureOutput:(id)output forKey:(NSString *)outputKey
+{
+    if (nil != output) {
+        [capturedOutputs setObject:output forKey:outputKey];
+    }
+}
+
+
+- (BOOL)materializeAndDetach:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (self.isDetached) {
+        return YES;
+    }
+    if (NULL == objectcodePythonClass) {
+        /* native object code keeps its program, only xas99 is not used anymore */
+#if !__has_feature(objc_arc)
+        [fallbackAssembler release];
+#endif
+        fallbackAssembler = nil;
+        return YES;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"materialize" category:XDTInstrumentationCategoryConversion];
+    const BOOL isMaterialized = nil != [self generateListing:NO error:error] && nil != [self generateListing:YES error:error] &&
+                                nil != [self generateSymbols:NO error:error] && nil != [self generateSymbols:YES error:error];
+    if (isMaterialized && nil == capturedSymbols) {
+        XDTAs99Symbols *symbols = [self symbols];
+        [symbols detach];
+        capturedSymbols = symbols;
+#if !__has_feature(objc_arc)
+        [capturedSymbols retain];
+#endif
+    }
+    [self.instrumentation endPhase:phase convertingObjects:[capturedOutputs count]];
+    if (!isMaterialized) {
+        return NO;
+    }
+
+    Py_CLEAR(objectcodePythonClass);
+#if !__has_feature(objc_arc)
+    [fallbackAssembler release];
+#endif
+    fallbackAssembler = nil;
+    return YES;
+}
+
+
+/*
+ As long as the object code is not detached, every captured output is generated again at its next use, either by
+ the Python object code or by the native program. The binaries of the first base address are only kept for capturing
+ the program, so that capture starts over with the next binaries.
+ */
+- (NSUInteger)removeRegenerableOutputs
+{
+    XDTAcquireGIL();
+    if (self.isDetached || 0 == [capturedOutputs count]) {
+        return 0;
+    }
+
+    const NSUInteger retVal = [XDTObject nativeByteCountOfObject:capturedOutputs];
+    [capturedOutputs removeAllObjects];
+    if (nil == capturedProgram) {
+#if !__has_feature(objc_arc)
+        [firstBinariesAddress release];
+#endif
+        firstBinariesAddress = nil;
+    }
+    return retVal;
+}
+
+
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return (NULL == objectcodePythonClass)? @[] : @[[NSValue valueWithPointer:objectcodePythonClass]];
+}
+
+
+/* The native program shares its symbols with the captured symbols, and the fallback assembler is counted itself */
+- (NSUInteger)nativeByteCount
+{
+    return [XDTObject nativeByteCountOfObject:capturedOutputs] + [XDTObject nativeByteCountOfObject:capturedSymbols] +
+           [nativeProgram byteCount] + [capturedProgram byteCount] + [capturedAddressMap byteCount] + [_crossReference byteCount];
+}
+
+
 #pragma mark - Generator Method Wrapper
 
 
@@ -142,13 +423,22 @@ NS_ASSUME_NONNULL_END
 
 - (NSData *)generateObjCode:(BOOL)shouldCompress error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_object_code:%d", shouldCompress];
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      generate_object_code(compressed=False)
      */
     PyObject *methodName = PyString_FromString("generate_object_code");
     PyObject *pCompressed = PyBool_FromLong(shouldCompress);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_object_code" category:XDTInstrumentationCategoryPython];
     PyObject *binaryString = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pCompressed, NULL);
+    [self.instrumentation endPhase:phase returning:binaryString passing:pCompressed, NULL];
     Py_XDECREF(pCompressed);
     Py_XDECREF(methodName);
     if (NULL == binaryString) {
@@ -163,7 +453,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_object_code" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:binaryString];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(binaryString);
 
     return retVal;
@@ -172,13 +465,16 @@ NS_ASSUME_NONNULL_END
 
 - (PyObject *)generateBinariesAt:(NSUInteger)baseAddr error:(NSError **)error
 {
+    XDTAcquireGIL();
     /*
      Function call in Python:
      (addr, bank, blob) = generate_binaries(baseAddr, saves=None)
      */
     PyObject *methodName = PyString_FromString("generate_binaries");
     PyObject *pBaseAddr = PyInt_FromLong(baseAddr);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_binaries" category:XDTInstrumentationCategoryPython];
     PyObject *binaryList = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pBaseAddr, NULL);
+    [self.instrumentation endPhase:phase returning:binaryList passing:pBaseAddr, NULL];
     Py_XDECREF(pBaseAddr);
     Py_XDECREF(methodName);
     if (NULL == binaryList) {
@@ -196,13 +492,112 @@ NS_ASSUME_NONNULL_END
 }
 
 
+/* The program which relocates natively: of the native assembler or captured from the binaries of xas99 */
+- (XDTAs99NativeProgram *)relocatableProgram
+{
+    return (nil != nativeProgram)? nativeProgram : capturedProgram;
+}
+
+
+/*
+ The raw binaries of the first base address are kept until xas99 generates them for another one, then the program is
+ captured from both. When they differ in more than the relocated words, xas99 generates every base address.
+ */
+- (void)captureProgramWithBinaries:(NSArray<NSArray<id> *> *)binaries at:(NSUInteger)baseAddr
+{
+    if (nil != [self relocatableProgram] || hasUnrelocatableBinaries || 0 == [binaries count]) {
+        return;
+    }
+    if (nil == firstBinariesAddress) {
+        firstBinariesAddress = [[NSNumber alloc] initWithUnsignedInteger:baseAddr];
+        return;
+    }
+    const NSUInteger firstBaseAddr = [firstBinariesAddress unsignedIntegerValue];
+    NSArray<NSArray<id> *> *firstBinaries = [capturedOutputs objectForKey:[NSString stringWithFormat:@"generate_binaries:%lu", (unsigned long)firstBaseAddr]];
+    if (nil == firstBinaries || 0 == ((baseAddr - firstBaseAddr) & 0xFFFF)) {
+        return;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"capture_program" category:XDTInstrumentationCategoryConversion];
+    XDTAs99NativeProgram *program = nil;
+    XDTBeginNativeWork();
+    program = [XDTAs99NativeProgram programWithBinaries:firstBinaries at:firstBaseAddr binaries:binaries at:baseAddr];
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[binaries count]];
+    capturedProgram = program;
+#if !__has_feature(objc_arc)
+    [capturedProgram retain];
+#endif
+    hasUnrelocatableBinaries = nil == program;
+}
+
+
+/*
+ The outputs of all base addresses which were not generated before are relocated in parallel. The generator runs on
+ several threads without the GIL, so it may only read the program.
+ */
+- (void)captureOutputsForKeys:(NSArray<NSString *> *)outputKeys at:(NSArray<NSNumber *> *)baseAddrs ofProgram:(XDTAs99NativeProgram *)program phase:(NSString *)phaseName generator:(id (^)(XDTAs99NativeProgram *, NSUInteger))generator
+{
+    NSMutableArray<NSNumber *> *missingAddrs = [NSMutableArray arrayWithCapacity:[baseAddrs count]];
+    NSMutableArray<NSString *> *missingKeys = [NSMutableArray arrayWithCapacity:[baseAddrs count]];
+    for (NSUInteger i = 0; i < [baseAddrs count]; i++) {
+        if (nil == [capturedOutputs objectForKey:[outputKeys objectAtIndex:i]] && ![missingKeys containsObject:[outputKeys objectAtIndex:i]]) {
+            [missingAddrs addObject:[baseAddrs objectAtIndex:i]];
+            [missingKeys addObject:[outputKeys objectAtIndex:i]];
+        }
+    }
+    if (0 == [missingKeys count]) {
+        return;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:phaseName category:XDTInstrumentationCategoryConversion];
+    NSMutableArray<id> *outputs = [NSMutableArray arrayWithCapacity:[missingKeys count]];
+    for (NSUInteger i = 0; i < [missingKeys count]; i++) {
+        [outputs addObject:[NSNull null]];
+    }
+    XDTBeginNativeWork();
+    dispatch_apply([missingAddrs count], dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        id output = generator(program, [[missingAddrs objectAtIndex:i] unsignedIntegerValue]);
+        @synchronized (outputs) {
+            [outputs replaceObjectAtIndex:i withObject:output];
+        }
+    });
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[outputs count]];
+    for (NSUInteger i = 0; i < [missingKeys count]; i++) {
+        [self captureOutput:[outputs objectAtIndex:i] forKey:[missingKeys objectAtIndex:i]];
+    }
+}
+
+
 - (NSArray<NSArray<id> *> *)generateRawBinaryAt:(NSUInteger)baseAddr error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_binaries:%lu", (unsigned long)baseAddr];
+    XDTAs99NativeProgram *program = [self relocatableProgram];
+    if (nil != program && nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_binaries_native" category:XDTInstrumentationCategoryConversion];
+        NSArray<NSArray<id> *> *binaries = nil;
+        XDTBeginNativeWork();
+        binaries = [program binariesAt:baseAddr];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[binaries count]];
+        [self captureOutput:binaries forKey:outputKey];
+    }
+    NSArray<NSArray<id> *> *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     NSArray<NSArray<id> *> *retVal = nil;
     PyObject *binaryList = [self generateBinariesAt:baseAddr error:error];
     if (NULL != binaryList) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_binaries" category:XDTInstrumentationCategoryConversion];
         retVal = [NSArray arrayWithPyListOfTuple:binaryList];
+        [self.instrumentation endPhase:phase convertingObjects:[retVal count]];
+        [self captureOutput:retVal forKey:outputKey];
         Py_DECREF(binaryList);
+        [self captureProgramWithBinaries:retVal at:baseAddr];
     }
 
     return retVal;
@@ -211,19 +606,55 @@ NS_ASSUME_NONNULL_END
 
 - (NSArray<NSArray<id> *> *)generateRawBinaryAt:(NSUInteger)baseAddr withRanges:(NSArray<NSValue *> *)ranges error:(NSError **)error
 {
+    XDTAcquireGIL();
+    if (0 == [ranges count]) {
+        return [self generateRawBinaryAt:baseAddr error:error];
+    }
+    NSMutableArray<NSString *> *rangeNames = [NSMutableArray arrayWithCapacity:[ranges count]];
+    for (NSValue *rangeValue in ranges) {
+        const NSRange range = [rangeValue rangeValue];
+        [rangeNames addObject:[NSString stringWithFormat:@"%lx-%lx", (unsigned long)range.location, (unsigned long)NSMaxRange(range)]];
+    }
+    NSString *outputKey = [NSString stringWithFormat:@"generate_binaries:%lu:%@", (unsigned long)baseAddr, [rangeNames componentsJoinedByString:@","]];
+    XDTAs99NativeProgram *program = [self relocatableProgram];
+    if (nil != program && nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_binaries_native" category:XDTInstrumentationCategoryConversion];
+        NSArray<NSArray<id> *> *binaries = nil;
+        XDTBeginNativeWork();
+        binaries = [program binariesAt:baseAddr ranges:ranges];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[binaries count]];
+        [self captureOutput:binaries forKey:outputKey];
+    }
+    NSArray<NSArray<id> *> *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      (addr, bank, blob) = generate_binaries(baseAddr, saves)
+     with saves as a list of tuples (from, to) of addresses
      */
     PyObject *methodName = PyString_FromString("generate_binaries");
     PyObject *pBaseAddr = PyInt_FromLong(baseAddr);
-    PyObject *pSaves = NULL;    // TODO: PyInt_FromLong(saves);
+    PyObject *pSaves = PyList_New(0);
+    for (NSValue *rangeValue in ranges) {
+        const NSRange range = [rangeValue rangeValue];
+        PyObject *pSave = Py_BuildValue("(kk)", (unsigned long)range.location, (unsigned long)NSMaxRange(range));
+        if (NULL != pSave) {
+            PyList_Append(pSaves, pSave);
+            Py_DECREF(pSave);
+        }
+    }
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_binaries" category:XDTInstrumentationCategoryPython];
     PyObject *binaryList = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pBaseAddr, pSaves, NULL);
+    [self.instrumentation endPhase:phase returning:binaryList passing:pBaseAddr, pSaves, NULL];
     Py_XDECREF(pSaves);
     Py_XDECREF(pBaseAddr);
     Py_XDECREF(methodName);
     if (NULL == binaryList) {
-        NSLog(@"%s ERROR: generate_binaries(0x%lxd) returns NULL!", __FUNCTION__, baseAddr);
+        NSLog(@"%s ERROR: generate_binaries(0x%lxd, [%@]) returns NULL!", __FUNCTION__, baseAddr, [rangeNames componentsJoinedByString:@", "]);
         PyObject *exeption = PyErr_Occurred();
         if (NULL != exeption) {
             if (nil != error) {
@@ -234,15 +665,56 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_binaries" category:XDTInstrumentationCategoryConversion];
     NSArray<NSArray<id> *> *retVal = [NSArray arrayWithPyListOfTuple:binaryList];
+    [self.instrumentation endPhase:phase convertingObjects:[retVal count]];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(binaryList);
 
     return retVal;
 }
 
 
+/*
+ xas99 generates the binaries of the first two base addresses only, the program captured from them relocates all
+ others. When the binaries cannot be captured, xas99 generates every base address.
+ */
+- (NSDictionary<NSNumber *, NSArray<NSArray<id> *> *> *)generateRawBinariesAt:(NSArray<NSNumber *> *)baseAddrs error:(NSError **)error
+{
+    XDTAcquireGIL();
+    NSMutableArray<NSString *> *outputKeys = [NSMutableArray arrayWithCapacity:[baseAddrs count]];
+    for (NSNumber *baseAddr in baseAddrs) {
+        [outputKeys addObject:[NSString stringWithFormat:@"generate_binaries:%lu", [baseAddr unsignedLongValue]]];
+    }
+
+    NSMutableDictionary<NSNumber *, NSArray<NSArray<id> *> *> *retVal = [NSMutableDictionary dictionaryWithCapacity:[baseAddrs count]];
+    for (NSNumber *baseAddr in baseAddrs) {
+        XDTAs99NativeProgram *program = [self relocatableProgram];
+        if (nil != program) {
+            [self captureOutputsForKeys:outputKeys at:baseAddrs ofProgram:program phase:@"generate_binaries_native" generator:^id(XDTAs99NativeProgram *relocatedProgram, NSUInteger relocatedAddr) {
+                return [relocatedProgram binariesAt:relocatedAddr];
+            }];
+        }
+        NSArray<NSArray<id> *> *binaries = [self generateRawBinaryAt:[baseAddr unsignedIntegerValue] error:error];
+        if (nil == binaries) {
+            return nil;
+        }
+        [retVal setObject:binaries forKey:baseAddr];
+    }
+
+    return retVal;
+}
+
+
 - (NSString *)generateTextAt:(NSUInteger)baseAddr withMode:(XDTGenerateTextMode)mode error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_text:%lu:%lu", (unsigned long)baseAddr, (unsigned long)mode];
+    NSString *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     PyObject *binaryList = [self generateBinariesAt:baseAddr error:error];
     if (NULL == binaryList || (nil != error && nil != *error)) {
         Py_XDECREF(binaryList);
@@ -311,7 +783,9 @@ NS_ASSUME_NONNULL_END
      */
     PyObject *methodName = PyString_FromString("generate_text");
     PyObject *pMode = PyString_FromString(textConfig);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_text" category:XDTInstrumentationCategoryPython];
     PyObject *dataText = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, binaryData, pMode, NULL);
+    [self.instrumentation endPhase:phase returning:dataText passing:binaryData, pMode, NULL];
     Py_DECREF(binaryData);
     Py_XDECREF(pMode);
     Py_XDECREF(methodName);
@@ -328,7 +802,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_text" category:XDTInstrumentationCategoryConversion];
     NSString *retVal = [NSString stringWithPythonString:dataText encoding:NSUTF8StringEncoding];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(dataText);
     return retVal;
 }
@@ -342,6 +819,23 @@ NS_ASSUME_NONNULL_END
 
 - (NSArray<NSData *> *)generateImageAt:(NSUInteger)baseAddr withChunkSize:(NSUInteger)chunkSize error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_image:%lu:%lu", (unsigned long)baseAddr, (unsigned long)chunkSize];
+    XDTAs99NativeProgram *program = [self relocatableProgram];
+    if (nil != program && !program.isBanked && nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_image_native" category:XDTInstrumentationCategoryConversion];
+        NSArray<NSData *> *images = nil;
+        XDTBeginNativeWork();
+        images = [program imagesAt:baseAddr chunkSize:chunkSize];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[images count]];
+        [self captureOutput:images forKey:outputKey];
+    }
+    NSArray<NSData *> *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      generate_image(baseAddr, chunkSize=0x2000)
@@ -349,7 +843,9 @@ NS_ASSUME_NONNULL_END
     PyObject *methodName = PyString_FromString("generate_image");
     PyObject *pBaseAddr = PyInt_FromLong(baseAddr);
     PyObject *pChunkSize = PyInt_FromLong(chunkSize);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_image" category:XDTInstrumentationCategoryPython];
     PyObject *imageList = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pBaseAddr, pChunkSize, NULL);
+    [self.instrumentation endPhase:phase returning:imageList passing:pBaseAddr, pChunkSize, NULL];
     Py_XDECREF(pChunkSize);
     Py_XDECREF(pBaseAddr);
     Py_XDECREF(methodName);
@@ -365,21 +861,71 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_image" category:XDTInstrumentationCategoryConversion];
     NSArray<NSData *> *retVal = [NSArray arrayWithPyListOfData:imageList];
+    [self.instrumentation endPhase:phase convertingObjects:[retVal count]];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(imageList);
 
     return retVal;
 }
 
 
+/*
+ Like the raw binaries, the images of the first two base addresses are generated from the binaries of xas99, so the
+ program is captured for all others. Images of banked programs are always generated by xas99.
+ */
+- (NSDictionary<NSNumber *, NSArray<NSData *> *> *)generateImagesAt:(NSArray<NSNumber *> *)baseAddrs withChunkSize:(NSUInteger)chunkSize error:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (nil == [self relocatableProgram] && 2 < [baseAddrs count] && !self.isDetached && !hasUnrelocatableBinaries) {
+        for (NSUInteger i = 0; i < 2; i++) {
+            if (nil == [self generateRawBinaryAt:[[baseAddrs objectAtIndex:i] unsignedIntegerValue] error:error]) {
+                return nil;
+            }
+        }
+    }
+    XDTAs99NativeProgram *program = [self relocatableProgram];
+    if (nil != program && !program.isBanked) {
+        NSMutableArray<NSString *> *outputKeys = [NSMutableArray arrayWithCapacity:[baseAddrs count]];
+        for (NSNumber *baseAddr in baseAddrs) {
+            [outputKeys addObject:[NSString stringWithFormat:@"generate_image:%lu:%lu", [baseAddr unsignedLongValue], (unsigned long)chunkSize]];
+        }
+        [self captureOutputsForKeys:outputKeys at:baseAddrs ofProgram:program phase:@"generate_image_native" generator:^id(XDTAs99NativeProgram *relocatedProgram, NSUInteger relocatedAddr) {
+            return [relocatedProgram imagesAt:relocatedAddr chunkSize:chunkSize];
+        }];
+    }
+
+    NSMutableDictionary<NSNumber *, NSArray<NSData *> *> *retVal = [NSMutableDictionary dictionaryWithCapacity:[baseAddrs count]];
+    for (NSNumber *baseAddr in baseAddrs) {
+        NSArray<NSData *> *images = [self generateImageAt:[baseAddr unsignedIntegerValue] withChunkSize:chunkSize error:error];
+        if (nil == images) {
+            return nil;
+        }
+        [retVal setObject:images forKey:baseAddr];
+    }
+
+    return retVal;
+}
+
+
 - (NSData *)generateBasicLoader:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = @"generate_XB_loader";
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      generate_XB_loader()
      */
     PyObject *methodName = PyString_FromString("generate_XB_loader");
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_XB_loader" category:XDTInstrumentationCategoryPython];
     PyObject *basicString = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, NULL);
+    [self.instrumentation endPhase:phase returning:basicString passing:NULL];
     Py_XDECREF(methodName);
     if (NULL == basicString) {
         NSLog(@"%s ERROR: generate_XB_loader() returns NULL!", __FUNCTION__);
@@ -393,7 +939,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_XB_loader" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:basicString];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(basicString);
 
     return retVal;
@@ -408,16 +957,34 @@ NS_ASSUME_NONNULL_END
  */
 - (NSDictionary<NSString *, NSData *> *)generateMESSCartridgeWithName:(NSString *)cartridgeName error:(NSError **)error
 {
+    XDTAcquireGIL();
     if (nil == cartridgeName || [cartridgeName length] == 0) {
         return nil;
     }
+    NSString *outputKey = [NSString stringWithFormat:@"generate_cartridge:%@", cartridgeName];
+    if (nil != nativeProgram && nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_cartridge_native" category:XDTInstrumentationCategoryConversion];
+        NSDictionary<NSString *, NSData *> *contents = nil;
+        XDTBeginNativeWork();
+        contents = [[self nativeCartridgeBuilderWithName:cartridgeName] packageContents];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[contents count]];
+        [self captureOutput:contents forKey:outputKey];
+    }
+    NSDictionary<NSString *, NSData *> *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      data, layout, metainf = code.generate_cartridge(name)
      */
     PyObject *methodName = PyString_FromString("generate_cartridge");
     PyObject *pCartName = PyString_FromString([cartridgeName UTF8String]);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_cartridge" category:XDTInstrumentationCategoryPython];
     PyObject *cartTuple = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pCartName, NULL);
+    [self.instrumentation endPhase:phase returning:cartTuple passing:pCartName, NULL];
     Py_XDECREF(pCartName);
     Py_XDECREF(methodName);
     if (NULL == cartTuple) {
@@ -441,12 +1008,15 @@ NS_ASSUME_NONNULL_END
     PyObject *cartLayout = PyTuple_GetItem(cartTuple, 1);
     PyObject *cartMetaInf = PyTuple_GetItem(cartTuple, 2);
 
+    phase = [self.instrumentation beginPhase:@"generate_cartridge" category:XDTInstrumentationCategoryConversion];
     NSString *cartridgeFileName = [cartridgeName stringByAppendingPathExtension:@"bin"];
     NSDictionary<NSString *, NSData *> *retVal =@{
                                                   cartridgeFileName: [NSData dataWithPythonString:cartData],
                                                   @"layout.xml": [NSData dataWithPythonString:cartLayout],
                                                   @"meta-inf.xml": [NSData dataWithPythonString:cartMetaInf]
                                                   };
+    [self.instrumentation endPhase:phase convertingObjects:[retVal count]];
+    [self captureOutput:retVal forKey:outputKey];
 
     Py_DECREF(cartTuple);
 
@@ -454,8 +1024,73 @@ NS_ASSUME_NONNULL_END
 }
 
 
+/*
+ The native cartridge holds the relocatable program right behind the cartridge header, started at the address of END
+ or at its first byte. Programs with AORG segments or which do not fit into one bank are built by xas99.
+ */
+- (XDTCartridgeBuilder *)nativeCartridgeBuilderWithName:(NSString *)cartridgeName
+{
+    if (nil == nativeProgram || ![nativeProgram isRelocatable]) {
+        return nil;
+    }
+    const NSUInteger codeAddress = [XDTCartridgeBuilder codeAddressAfterROMHeaderWithName:cartridgeName];
+    const NSUInteger entryAddress = [nativeProgram entryAddressAt:codeAddress];
+    NSData *header = [XDTCartridgeBuilder romHeaderWithName:cartridgeName entryAddress:(NSNotFound == entryAddress)? codeAddress : entryAddress];
+    if (nil == header) {
+        return nil;
+    }
+
+    NSMutableData *bank = [NSMutableData dataWithData:header];
+    for (NSArray<id> *binary in [nativeProgram binariesAt:codeAddress]) {
+        const NSUInteger offset = [[binary objectAtIndex:0] unsignedIntegerValue] - XDTCartridgeROMAddress;
+        NSData *data = [binary objectAtIndex:2];
+        if (XDTCartridgeBankSize < offset + [data length]) {
+            return nil;
+        }
+        if ([bank length] < offset + [data length]) {
+            [bank setLength:offset + [data length]];
+        }
+        [bank replaceBytesInRange:NSMakeRange(offset, [data length]) withBytes:[data bytes]];
+    }
+
+    XDTCartridgeBuilder *retVal = [XDTCartridgeBuilder cartridgeBuilderWithName:cartridgeName];
+    return [retVal addROMBank:bank error:nil]? retVal : nil;
+}
+
+
+- (BOOL)writeMESSCartridgeWithName:(NSString *)cartridgeName toURL:(NSURL *)url error:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (nil == cartridgeName || [cartridgeName length] == 0) {
+        return NO;
+    }
+    NSString *outputKey = [NSString stringWithFormat:@"generate_cartridge:%@", cartridgeName];
+    if (nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTCartridgeBuilder *builder = nil;
+        BOOL isWritten = NO;
+        XDTBeginNativeWork();
+        builder = [self nativeCartridgeBuilderWithName:cartridgeName];
+        isWritten = nil != builder && [builder writeToURL:url error:error];
+        XDTEndNativeWork();
+        if (nil != builder) {
+            return isWritten;
+        }
+    }
+
+    NSDictionary<NSString *, NSData *> *contents = [self generateMESSCartridgeWithName:cartridgeName error:error];
+    return nil != contents && [XDTCartridgeBuilder writePackageContents:contents toURL:url error:error];
+}
+
+
 - (NSData *)generateListing:(BOOL)outputSymbols error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_list:%d", outputSymbols];
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      In the Python class all methods which generates output calling self.prepare() before they do their actual work,
      but the only generator which does not call prepare is the list generator. A bug?
@@ -465,7 +1100,9 @@ NS_ASSUME_NONNULL_END
      prepare()
      */
     PyObject *methodName = PyString_FromString("prepare");
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"prepare" category:XDTInstrumentationCategoryPython];
     PyObject *pNonValue = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, NULL);
+    [self.instrumentation endPhase:phase returning:pNonValue passing:NULL];
     Py_XDECREF(methodName);
     if (NULL == pNonValue) {
         return nil;
@@ -477,7 +1114,9 @@ NS_ASSUME_NONNULL_END
      */
     methodName = PyString_FromString("generate_list");
     PyObject *pOutputSymbols = PyBool_FromLong(outputSymbols);
+    phase = [self.instrumentation beginPhase:@"generate_list" category:XDTInstrumentationCategoryPython];
     PyObject *listingString = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pOutputSymbols, NULL);
+    [self.instrumentation endPhase:phase returning:listingString passing:pOutputSymbols, NULL];
     Py_XDECREF(pOutputSymbols);
     Py_XDECREF(methodName);
     if (NULL == listingString) {
@@ -492,7 +1131,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_list" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:listingString];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(listingString);
 
     return retVal;
@@ -501,13 +1143,22 @@ NS_ASSUME_NONNULL_END
 
 - (NSData *)generateSymbols:(BOOL)useEqu error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_symbols:%d", useEqu];
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      generate_symbols(useEqu)
      */
     PyObject *methodName = PyString_FromString("generate_symbols");
     PyObject *pUseEqu = PyBool_FromLong(useEqu);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_symbols" category:XDTInstrumentationCategoryPython];
     PyObject *symbolsString = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pUseEqu, NULL);
+    [self.instrumentation endPhase:phase returning:symbolsString passing:pUseEqu, NULL];
     Py_XDECREF(pUseEqu);
     Py_XDECREF(methodName);
     if (NULL == symbolsString) {
@@ -522,10 +1173,75 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_symbols" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:symbolsString];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(symbolsString);
 
     return retVal;
 }
 
+
+#pragma mark - Address Map
+
+
+- (XDTAddressMap *)addressMap:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (nil != capturedAddressMap) {
+        return capturedAddressMap;
+    }
+    /* the listing is captured, so the map is also built after detaching */
+    NSData *listing = [self generateListing:NO error:error];
+    if (nil == listing) {
+        return nil;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"address_map" category:XDTInstrumentationCategoryConversion];
+    XDTAddressMap *addressMap = nil;
+    XDTBeginNativeWork();
+    addressMap = [XDTAddressMap addressMapOfListing:listing];
+    XDTEndNativeWork();
+    capturedAddressMap = addressMap;
+#if !__has_feature(objc_arc)
+    [capturedAddressMap retain];
+#endif
+    [self.instrumentation endPhase:phase convertingObjects:[capturedAddressMap rangeCount]];
+    return capturedAddressMap;
+}
+
+
+- (NSData *)generateDebugInfo:(NSError **)error
+{
+    XDTAcquireGIL();
+    NSData *capturedOutput = [self capturedOutputForKey:@"generate_debug_info" error:nil];
+    if (nil != capturedOutput) {
+        return capturedOutput;
+    }
+    XDTAddressMap *addressMap = [self addressMap:error];
+    if (nil == addressMap) {
+        return nil;
+    }
+
+    /* the symbols are captured when detached or natively assembled, so only the tables are converted from Python */
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_debug_info" category:XDTInstrumentationCategoryConversion];
+    XDTAs99Symbols *symbols = [self symbols];
+    NSDictionary<NSString *, NSNumber *> *symbolTable = [symbols symbols];
+    NSArray<NSString *> *refdefs = [symbols refdefs];
+    NSDictionary<NSString *, NSNumber *> *xops = [symbols xops];
+    NSDictionary<NSString *, NSNumber *> *locations = [symbols locations];
+    if (PyErr_Occurred()) {
+        PyErr_Clear();  /* the REF symbols of xas99 have no integer value */
+    }
+    NSData *retVal = nil;
+    XDTBeginNativeWork();
+    retVal = [XDTDebugInfo dataWithSymbols:(nil == symbolTable)? @{} : symbolTable refdefs:refdefs xops:xops locations:locations addressMap:addressMap];
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[symbolTable count] + [xops count]];
+    [self captureOutput:retVal forKey:@"generate_debug_info"];
+
+    return retVal;
+}
+
 @end
@@ -38,6 +38,11 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nullable, readonly) NSDictionary *xops;
 @property (nullable, readonly) NSDictionary *locations;
 
+/* A detached object answers from native copies of the tables above, it cannot be modified anymore. */
+@property (readonly, getter=isDetached) BOOL detached;
+
+- (void)detach;
+
 - (void)resetLineCounter;
 - (NSUInteger)effectiveLineCounter;
 
@@ -26,17 +26,37 @@
 
 #import <Python/Python.h>
 
+#import "XDTInstrumentation.h"
+#import "XDTPythonGIL.h"
+
 
 #define XDTClassNameSymbols "Symbols"
 
 
 NS_ASSUME_NONNULL_BEGIN
 
+@interface XDTObject ()
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
+
+@end
+
+
 @interface XDTAs99Symbols () {
     PyObject *symbolsPythonClass;
+
+    /* Native copies of the tables, only set when detached */
+    NSDictionary *capturedSymbols;
+    NSArray *capturedRefdefs;
+    NSDictionary *capturedXops;
+    NSDictionary *capturedLocations;
 }
 
+/* Package private for the native assembler of XDTAs99Objcode, the symbols are detached from the start */
++ (instancetype)symbolsWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs;
+
 - (nullable instancetype)initWithPythonInstance:(void *)object;
+- (instancetype)initWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs;
 
 @end
 
@@ -47,6 +67,7 @@ NS_ASSUME_NONNULL_END
 
 + (instancetype)symbolsWithPythonInstance:(void *)object
 {
+    XDTAcquireGIL();
     XDTAs99Symbols *retVal = [[XDTAs99Symbols alloc] initWithPythonInstance:object];
 #if !__has_feature(objc_arc)
     [retVal autorelease];
@@ -57,6 +78,7 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithPythonInstance:(void *)object
 {
+    XDTAcquireGIL();
     self = [super init];
     if (nil == self) {
         return nil;
@@ -69,21 +91,102 @@ NS_ASSUME_NONNULL_END
 }
 
 
++ (instancetype)symbolsWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs
+{
+    XDTAs99Symbols *retVal = [[XDTAs99Symbols alloc] initWithSymbols:symbols refdefs:refdefs];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    symbolsPythonClass = NULL;
+    capturedSymbols = [symbols copy];
+    capturedRefdefs = [refdefs copy];
+    capturedXops = [[NSDictionary alloc] init];
+    capturedLocations = [[NSDictionary alloc] init];
+
+    return self;
+}
+
+
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(symbolsPythonClass);
 
 #if !__has_feature(objc_arc)
+    [capturedSymbols release];
+    [capturedRefdefs release];
+    [capturedXops release];
+    [capturedLocations release];
+
     [super dealloc];
 #endif
 }
 
 
+#pragma mark - Detaching
+
+
+- (BOOL)isDetached
+{
+    return NULL == symbolsPythonClass;
+}
+
+
+- (void)detach
+{
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"detach" category:XDTInstrumentationCategoryConversion];
+    capturedSymbols = [[self symbols] copy];
+    capturedRefdefs = [[self refdefs] copy];
+    capturedXops = [[self xops] copy];
+    capturedLocations = [[self locations] copy];
+    [self.instrumentation endPhase:phase convertingObjects:[capturedSymbols count] + [capturedRefdefs count] + [capturedXops count] + [capturedLocations count]];
+
+    Py_CLEAR(symbolsPythonClass);
+}
+
+
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return (NULL == symbolsPythonClass)? @[] : @[[NSValue valueWithPointer:symbolsPythonClass]];
+}
+
+
+- (NSUInteger)nativeByteCount
+{
+    return [XDTObject nativeByteCountOfObject:capturedSymbols] + [XDTObject nativeByteCountOfObject:capturedRefdefs] +
+           [XDTObject nativeByteCountOfObject:capturedXops] + [XDTObject nativeByteCountOfObject:capturedLocations];
+}
+
+
 #pragma mark - Property Wrapper
 
 
 - (NSDictionary *)symbols
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return capturedSymbols;
+    }
+
     PyObject *symbolDict = PyObject_GetAttrString(symbolsPythonClass, "symbols");
     if (NULL == symbolDict) {
         return nil;
@@ -109,6 +212,11 @@ NS_ASSUME_NONNULL_END
 
 - (NSArray *)refdefs
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return capturedRefdefs;
+    }
+
     PyObject *refdefsList = PyObject_GetAttrString(symbolsPythonClass, "refdefs");
     if (NULL == refdefsList) {
         return nil;
@@ -133,6 +241,11 @@ NS_ASSUME_NONNULL_END
 
 - (NSDictionary *)xops
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return capturedXops;
+    }
+
     PyObject *xopDict = PyObject_GetAttrString(symbolsPythonClass, "xops");
     if (NULL == xopDict) {
         return nil;
@@ -158,6 +271,11 @@ NS_ASSUME_NONNULL_END
 
 - (NSDictionary *)locations
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return capturedLocations;
+    }
+
     PyObject *locationsList = PyObject_GetAttrString(symbolsPythonClass, "locations");
     if (NULL == locationsList) {
         return nil;
@@ -187,6 +305,11 @@ NS_ASSUME_NONNULL_END
 
 - (void)resetLineCounter
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return;
+    }
+
     /*
      Function call in Python:
      reset_LC()
@@ -200,6 +323,11 @@ NS_ASSUME_NONNULL_END
 
 - (NSUInteger)effectiveLineCounter
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NSNotFound;
+    }
+
     /*
      Function call in Python:
      effective_LC()
@@ -220,6 +348,11 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)addSymbolName:(NSString *)name withValue:(NSUInteger)value
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NO;
+    }
+
     /*
      Function call in Python:
      add_symbol(name, value)
@@ -245,6 +378,11 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)addLabel:(NSString *)label withLineIndex:(NSUInteger)lineIdx usingEffectiveLineCount:(BOOL)realLineCount
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NO;
+    }
+
     /*
      Function call in Python:
      add_label(lidx, label, realLC=False)
@@ -266,6 +404,11 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)addLocalLabel:(NSString *)label withLineIndex:(NSUInteger)lineIdx
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NO;
+    }
+
     /*
      Function call in Python:
      add_local_label(lidx, label)
@@ -285,6 +428,11 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)addDef:(NSString *)name
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NO;
+    }
+
     /*
      Function call in Python:
      add_def(name)
@@ -302,6 +450,11 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)addRef:(NSString *)name
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NO;
+    }
+
     /*
      Function call in Python:
      add_ref(name)
@@ -319,6 +472,11 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)addXop:(NSString *)name mode:(NSUInteger)mode
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NO;
+    }
+
     /*
      Function call in Python:
      add_XOP(name, mode)
@@ -338,6 +496,12 @@ NS_ASSUME_NONNULL_END
 
 - (NSUInteger)getSymbol:(NSString *)name
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        NSNumber *value = [capturedSymbols objectForKey:name];
+        return (nil == value)? NSNotFound : [value unsignedIntegerValue];
+    }
+
     /*
      Function call in Python:
      get_symbol(name)
@@ -360,6 +524,11 @@ NS_ASSUME_NONNULL_END
 
 - (NSUInteger)getLocal:(NSString *)name position:(NSUInteger)lpos distance:(NSUInteger)distance
 {
+    XDTAcquireGIL();
+    if (NULL == symbolsPythonClass) {
+        return NSNotFound;   /* the positions of local labels are not captured */
+    }
+
     /*
      Function call in Python:
      get_local(name, lpos, distance)
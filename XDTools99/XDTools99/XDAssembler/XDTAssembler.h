@@ -49,6 +49,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 typedef NSString * XDTAs99OptionKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
 
+FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionCrossReference;   /* (NSNumber) A BOOL to build the XDTCrossReference of the assembled sources */
+FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionInstrumentation;   /* (XDTInstrumentation) Records all phases from the module import on */
+FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionMessageAggregation; /* (NSDictionary) XDTMessageAggregationKey options to group repeated messages, default is one message for each */
+FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionModuleVersion;  /* (NSString) A version registered at XDTObject to use its xas99 instead of the one of the framework */
+FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionPythonProfiler;   /* (XDTPythonProfiler) Profiles xas99 while assembling and generating, set to the instrumentation */
+FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionNativeAssembly;  /* (NSNumber) A BOOL to assemble the common subset natively, other sources are assembled by xas99 */
 FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionRegister;   /* (NSNumber) A BOOL to enable R notaion for registers */
 FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionStrict;     /* (NSNumber) A BOOL to indicate the strict mode */
 FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionTarget;     /* (NSNumber) A XDTAs99TargetType to choose the generated result */
@@ -63,12 +69,14 @@ FOUNDATION_EXPORT XDTAs99OptionKey const XDTAs99OptionWarnings;   /* (NSNumber)
 @property (readonly) BOOL outputWarnings;
 @property (readonly, nullable) XDTMessage *messages;
 @property (readonly) XDTAs99TargetType targetType;
+@property (readonly, nullable) NSString *nativeFallbackReason;  /* Why the last source was assembled by xas99 despite the native assembly option */
 
 + (BOOL)checkRequiredModuleVersion;
 
 + (nullable instancetype)assemblerWithOptions:(NSDictionary<XDTAs99OptionKey, id> *)options includeURL:(NSURL *)url;
 
 - (nullable XDTAs99Objcode *)assembleSourceFile:(NSURL *)srcFile error:(NSError **)error;
+- (NSUInteger)removeCachedSources;    /* Returns the freed bytes, the native assembler reads all sources again */
 
 @end
 
@@ -29,7 +29,14 @@
 #import "NSErrorPythonAdditions.h"
 #import "NSArrayPythonAdditions.h"
 #import "XDTMessage.h"
+#import "XDTInstrumentation.h"
+#import "XDTPythonProfiler.h"
 #import "XDTAs99Objcode.h"
+#import "XDTAs99Symbols.h"
+#import "XDTCrossReference.h"
+#import "XDTAs99NativeAssembler.h"
+#import "XDTMemoryBudget.h"
+#import "XDTPythonGIL.h"
 
 
 #define XDTModuleNameAssembler "xas99"
@@ -38,6 +45,14 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@interface XDTObject ()
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
++ (nullable PyObject *)importXDTModule:(const char *)moduleName version:(nullable NSString *)version;
+
+@end
+
+
 @interface XDTAs99Objcode () {
     PyObject *objectcodePythonClass;
 }
@@ -51,9 +66,12 @@ NS_ASSUME_NONNULL_BEGIN
  **/
 
 + (nullable instancetype)objectcodeWithPythonInstance:(void *)object;
++ (nullable instancetype)objectcodeWithNativeProgram:(XDTAs99NativeProgram *)program assembler:(XDTAssembler *)assembler sourceFile:(NSURL *)srcFile;
 
 - (nullable instancetype)initWithPythonInstance:(PyObject *)object;
 
+- (void)setCrossReference:(nullable XDTCrossReference *)crossReference;
+
 - (XDTAs99Objcode *)assembleSourceFile:(NSString *)basename pathName:(NSString *)dirname error:(NSError **)error;
 
 @end
@@ -63,16 +81,28 @@ NS_ASSUME_NONNULL_END
 
 NS_ASSUME_NONNULL_BEGIN
 
+XDTAs99OptionKey const XDTAs99OptionCrossReference = @"XDTAs99OptionCrossReference";
+XDTAs99OptionKey const XDTAs99OptionInstrumentation = @"XDTAs99OptionInstrumentation";
+XDTAs99OptionKey const XDTAs99OptionMessageAggregation = @"XDTAs99OptionMessageAggregation";
+XDTAs99OptionKey const XDTAs99OptionModuleVersion = @"XDTAs99OptionModuleVersion";
+XDTAs99OptionKey const XDTAs99OptionPythonProfiler = @"XDTAs99OptionPythonProfiler";
+XDTAs99OptionKey const XDTAs99OptionNativeAssembly = @"XDTAs99OptionNativeAssembly";
 XDTAs99OptionKey const XDTAs99OptionRegister = @"XDTAs99OptionRegister";
 XDTAs99OptionKey const XDTAs99OptionStrict = @"XDTAs99OptionStrict";
 XDTAs99OptionKey const XDTAs99OptionTarget = @"XDTAs99OptionTarget";
 XDTAs99OptionKey const XDTAs99OptionWarnings = @"XDTAs99OptionWarnings";
 
 
-@interface XDTAssembler () {
+@interface XDTAssembler () <XDTMessageSource> {
     const PyObject *assemblerPythonModule;
     PyObject *assemblerPythonClass;
     XDTMessage *_messages;
+    NSDictionary<XDTMessageAggregationKey, id> *_messageAggregation;
+    NSArray<NSURL *> *_includeURLs;
+    BOOL _buildsCrossReference;
+    BOOL _assemblesNatively;
+    BOOL _hasNativeResult;      /* The messages of the Python assembler belong to an earlier source then */
+    XDTAs99NativeSourceCache *_sourceCache;     /* The parsed lines of all sources the native assembler has read */
 }
 
 @property NSString *version;
@@ -81,9 +111,15 @@ XDTAs99OptionKey const XDTAs99OptionWarnings = @"XDTAs99OptionWarnings";
 @property BOOL outputWarnings;
 @property XDTAs99TargetType targetType;
 @property (readonly, nullable) const char *targetTypeAsCString;
+@property (nullable, copy) NSString *nativeFallbackReason;
 
 - (nullable instancetype)initWithOptions:(NSDictionary<XDTAs99OptionKey, id> *)options forModule:(PyObject *)pModule includeURL:(NSArray<NSURL *> *)url;
 
+/* Package private for the fallback of XDTAs99Objcode: returns a new reference to the tuple of assemble() */
+- (nullable PyObject *)pythonResultOfSourceFile:(NSString *)baseName pathName:(NSString *)dirName error:(NSError **)error;
+- (nullable XDTAs99Objcode *)nativeObjcodeOfSourceFile:(NSURL *)srcFile;
+- (nullable XDTCrossReference *)crossReferenceOfSourceFile:(NSURL *)srcFile symbols:(XDTAs99Symbols *)symbols;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -93,6 +129,7 @@ NS_ASSUME_NONNULL_END
 
 + (BOOL)checkRequiredModuleVersion
 {
+    XDTAcquireGIL();
     PyObject *pName = PyString_FromString(XDTModuleNameAssembler);
     PyObject *pModule = PyImport_Import(pName);
     if (NULL == pModule) {
@@ -142,11 +179,15 @@ NS_ASSUME_NONNULL_END
 /* This class method initialize this singleton. It takes care of all python module related things. */
 + (instancetype)assemblerWithOptions:(NSDictionary<XDTAs99OptionKey, id> *)options includeURL:(NSURL *)url
 {
+    XDTAcquireGIL();
     assert(NULL != options);
     assert(nil != url);
 
     @synchronized (self) {
-        PyObject *pModule = PyImport_ImportModuleNoBlock(XDTModuleNameAssembler);
+        XDTInstrumentation *instrumentation = [options valueForKey:XDTAs99OptionInstrumentation];
+        XDTInstrumentationPhase *phase = [instrumentation beginPhase:@XDTModuleNameAssembler category:XDTInstrumentationCategoryImport];
+        PyObject *pModule = [self importXDTModule:XDTModuleNameAssembler version:[options valueForKey:XDTAs99OptionModuleVersion]];
+        [instrumentation endPhase:phase returning:NULL passing:NULL];
         if (NULL == pModule) {
             NSLog(@"%s ERROR: Importing module '%s' failed! Python path: %s", __FUNCTION__, XDTModuleNameAssembler, Py_GetPath());
             PyObject *exeption = PyErr_Occurred();
@@ -177,6 +218,7 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithOptions:(NSDictionary<XDTAs99OptionKey, id> *)options forModule:(PyObject *)pModule includeURL:(NSArray<NSURL *> *)urls
 {
+    XDTAcquireGIL();
     assert(NULL != pModule);
     assert(nil != urls);
 
@@ -197,7 +239,10 @@ NS_ASSUME_NONNULL_END
 #endif
         return nil;
     }
-    if (0 != strcmp(PyString_AsString(pVar), XDTAssemblerVersionRequired)) {
+    /* A module of a registered version has the version of its own release, only the module of the framework is checked */
+    NSString *moduleVersion = [options valueForKey:XDTAs99OptionModuleVersion];
+    const BOOL isRegisteredVersion = nil != moduleVersion && [[XDTObject registeredXDTModuleVersions] containsObject:moduleVersion];
+    if (!isRegisteredVersion && 0 != strcmp(PyString_AsString(pVar), XDTAssemblerVersionRequired)) {
         NSLog(@"%s ERROR: Wrong Assembler version %s! Required is %s", __FUNCTION__, PyString_AsString(pVar), XDTAssemblerVersionRequired);
         Py_XDECREF(pVar);
 #if !__has_feature(objc_arc)
@@ -221,6 +266,21 @@ NS_ASSUME_NONNULL_END
     }
 
     /* reading option from dictionary */
+    self.instrumentation = [options valueForKey:XDTAs99OptionInstrumentation];
+    XDTPythonProfiler *pythonProfiler = [options valueForKey:XDTAs99OptionPythonProfiler];
+    if (nil != pythonProfiler) {
+        if (nil == self.instrumentation) {
+            self.instrumentation = [XDTInstrumentation instrumentation];
+        }
+        self.instrumentation.pythonProfiler = pythonProfiler;
+    }
+    _messageAggregation = [[options valueForKey:XDTAs99OptionMessageAggregation] copy];
+    _buildsCrossReference = [[options valueForKey:XDTAs99OptionCrossReference] boolValue];
+    _assemblesNatively = [[options valueForKey:XDTAs99OptionNativeAssembly] boolValue];
+    if (_assemblesNatively) {
+        _sourceCache = [[XDTAs99NativeSourceCache alloc] init];
+    }
+    _includeURLs = [urls copy];
     _targetType = [[options valueForKey:XDTAs99OptionTarget] unsignedIntegerValue];
     _beStrict = [[options valueForKey:XDTAs99OptionStrict] boolValue];
     _useRegisterSymbols = [[options valueForKey:XDTAs99OptionRegister] boolValue];
@@ -248,7 +308,9 @@ NS_ASSUME_NONNULL_END
                         warnings=outputWarnings)
      */
     PyObject *pArgs = PyTuple_Pack(6, target, addRegisters, defs, includePath, strictMode, outputWarnings);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@XDTClassNameAssembler category:XDTInstrumentationCategoryPython];
     PyObject *assembler = PyObject_CallObject(pFunc, pArgs);
+    [self.instrumentation endPhase:phase returning:NULL passing:pArgs, NULL];
     Py_XDECREF(pArgs);
     Py_XDECREF(pFunc);
     if (NULL == assembler) {
@@ -278,10 +340,15 @@ NS_ASSUME_NONNULL_END
 
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(assemblerPythonClass);
     Py_CLEAR(assemblerPythonModule);
 
 #if !__has_feature(objc_arc)
+    [_messageAggregation release];
+    [_includeURLs release];
+    [_nativeFallbackReason release];
+    [_sourceCache release];
     [super dealloc];
 #endif
 }
@@ -316,7 +383,8 @@ NS_ASSUME_NONNULL_END
 
 - (XDTMessage *)messages
 {
-    if (nil != _messages) {
+    XDTAcquireGIL();
+    if (nil != _messages || _hasNativeResult) {
         return _messages;
     }
 
@@ -325,17 +393,65 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
-    XDTMutableMessage *retVal = [XDTMutableMessage messageWithPythonList:messageList];
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"messages" category:XDTInstrumentationCategoryConversion];
+    XDTMutableMessage *retVal = [XDTMutableMessage messageWithPythonList:messageList treatingAs:XDTMessageTypeAll aggregation:_messageAggregation];
+    [self.instrumentation endPhase:phase convertingObjects:retVal.count];
     if (0 >= retVal.count) {
         return nil;
     }
     [retVal sortByPriorityAscendingType];
+    if ([retVal isAggregated]) {
+        retVal.messageSource = self;
+    }
 
     _messages = retVal;
     return _messages;
 }
 
 
+/* The console still holds the messages of the last run, so the aggregated ones are converted again one by one */
+- (XDTMessage *)expandedMessagesOfMessages:(XDTMessage *)messages
+{
+    XDTAcquireGIL();
+    if (messages != _messages || NULL == assemblerPythonClass) {
+        return nil;
+    }
+
+    PyObject *messageList = PyObject_GetAttrString(assemblerPythonClass, "console");
+    if (NULL == messageList) {
+        return nil;
+    }
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"expand_messages" category:XDTInstrumentationCategoryConversion];
+    XDTMessage *retVal = [XDTMessage messageWithPythonList:messageList treatingAs:XDTMessageTypeAll];
+    [self.instrumentation endPhase:phase convertingObjects:retVal.count];
+    Py_DECREF(messageList);
+    return retVal;
+}
+
+
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return (NULL == assemblerPythonClass)? @[] : @[[NSValue valueWithPointer:assemblerPythonClass]];
+}
+
+
+- (NSUInteger)nativeByteCount
+{
+    return [XDTObject nativeByteCountOfObject:_messages] + [XDTObject nativeByteCountOfObject:_includeURLs] + [_sourceCache byteCount];
+}
+
+
+- (NSUInteger)removeCachedSources
+{
+    const NSUInteger retVal = [_sourceCache byteCount];
+    [_sourceCache removeAllFiles];
+    return retVal;
+}
+
+
 #pragma mark - Parsing Methods
 
 
@@ -347,25 +463,18 @@ NS_ASSUME_NONNULL_END
 
 - (XDTAs99Objcode *)assembleSourceFile:(NSString *)baseName pathName:(NSString *)dirName error:(NSError **)error
 {
-    /* calling assembler:
-        code, errors, warnings = asm.assemble(dirname, basename)
-     */
-    PyObject *methodName = PyString_FromString("assemble");
-    PyObject *pDirName = PyString_FromString([dirName UTF8String]);
-    PyObject *pbaseName = PyString_FromString([baseName UTF8String]);
-    PyObject *pValueTupel = PyObject_CallMethodObjArgs(assemblerPythonClass, methodName, pDirName, pbaseName, NULL);
-    Py_XDECREF(pbaseName);
-    Py_XDECREF(pDirName);
-    Py_XDECREF(methodName);
-    if (NULL == pValueTupel) {
-        NSLog(@"%s ERROR: assemble(\"%@\", \"%@\") returns NULL!", __FUNCTION__, dirName, baseName);
-        PyObject *exeption = PyErr_Occurred();
-        if (NULL != exeption) {
-            if (nil != error) {
-                *error = [NSError errorWithPythonError:exeption localizedRecoverySuggestion:nil];
-            }
-            PyErr_Print();
+    XDTAcquireGIL();
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
+    if (_assemblesNatively) {
+        XDTAs99Objcode *retVal = [self nativeObjcodeOfSourceFile:[NSURL fileURLWithPath:[dirName stringByAppendingPathComponent:baseName]]];
+        if (nil != retVal) {
+            [[XDTMemoryBudget sharedBudget] enforceLimitSparingObject:retVal];
+            return retVal;
         }
+    }
+
+    PyObject *pValueTupel = [self pythonResultOfSourceFile:baseName pathName:dirName error:error];
+    if (NULL == pValueTupel) {
         return nil;
     }
 
@@ -380,6 +489,7 @@ NS_ASSUME_NONNULL_END
 
     [self willChangeValueForKey:NSStringFromSelector(@selector(messages))];
     _messages = nil;
+    _hasNativeResult = NO;
     [self didChangeValueForKey:NSStringFromSelector(@selector(messages))];
 
     XDTMessage *newMessages = self.messages;
@@ -401,10 +511,104 @@ NS_ASSUME_NONNULL_END
     PyObject *objectCodeObject = PyTuple_GetItem(pValueTupel, 0);
     if (NULL != objectCodeObject) {
         retVal = [XDTAs99Objcode objectcodeWithPythonInstance:objectCodeObject];
+        retVal.instrumentation = self.instrumentation;
+    }
+
+    if (nil != retVal && _buildsCrossReference) {
+        NSURL *srcFile = [NSURL fileURLWithPath:[dirName stringByAppendingPathComponent:baseName]];
+        [retVal setCrossReference:[self crossReferenceOfSourceFile:srcFile symbols:[retVal symbols]]];
     }
 
     Py_DECREF(pValueTupel);
+    [[XDTMemoryBudget sharedBudget] enforceLimitSparingObject:retVal];
+
+    return retVal;
+}
+
+
+- (PyObject *)pythonResultOfSourceFile:(NSString *)baseName pathName:(NSString *)dirName error:(NSError **)error
+{
+    XDTAcquireGIL();
+    /* calling assembler:
+        code, errors, warnings = asm.assemble(dirname, basename)
+     */
+    PyObject *methodName = PyString_FromString("assemble");
+    PyObject *pDirName = PyString_FromString([dirName UTF8String]);
+    PyObject *pbaseName = PyString_FromString([baseName UTF8String]);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"assemble" category:XDTInstrumentationCategoryPython];
+    PyObject *pValueTupel = PyObject_CallMethodObjArgs(assemblerPythonClass, methodName, pDirName, pbaseName, NULL);
+    [self.instrumentation endPhase:phase returning:pValueTupel passing:pDirName, pbaseName, NULL];
+    Py_XDECREF(pbaseName);
+    Py_XDECREF(pDirName);
+    Py_XDECREF(methodName);
+    if (NULL == pValueTupel) {
+        NSLog(@"%s ERROR: assemble(\"%@\", \"%@\") returns NULL!", __FUNCTION__, dirName, baseName);
+        PyObject *exeption = PyErr_Occurred();
+        if (NULL != exeption) {
+            if (nil != error) {
+                *error = [NSError errorWithPythonError:exeption localizedRecoverySuggestion:nil];
+            }
+            PyErr_Print();
+        }
+    }
+
+    return pValueTupel;
+}
+
 
+/*
+ The native assembler handles the common subset of xas99 only and gives up on everything else, e.g. macros or any
+ error, so the source is assembled by xas99 then. It never generates messages, strict mode always uses xas99.
+ All runs of this assembler share the source cache, so unchanged copied files are parsed only once per session.
+ */
+- (XDTAs99Objcode *)nativeObjcodeOfSourceFile:(NSURL *)srcFile
+{
+    XDTAcquireGIL();
+    if (_beStrict) {
+        self.nativeFallbackReason = @"strict mode";
+        return nil;
+    }
+
+    NSString *reason = nil;
+    XDTAs99NativeAssembler *nativeAssembler = [XDTAs99NativeAssembler nativeAssemblerWithIncludeURLs:_includeURLs useRegisterSymbols:_useRegisterSymbols outputWarnings:_outputWarnings sourceCache:_sourceCache];
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"assemble_native" category:XDTInstrumentationCategoryConversion];
+    XDTAs99NativeProgram *program = nil;
+    XDTBeginNativeWork();
+    program = [nativeAssembler assembleSourceFile:srcFile unsupportedReason:&reason];
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[[program symbols] count]];
+    self.nativeFallbackReason = reason;
+    if (nil == program) {
+        return nil;
+    }
+
+    [self willChangeValueForKey:NSStringFromSelector(@selector(messages))];
+    _messages = nil;
+    _hasNativeResult = YES;
+    [self didChangeValueForKey:NSStringFromSelector(@selector(messages))];
+
+    XDTAs99Objcode *retVal = [XDTAs99Objcode objectcodeWithNativeProgram:program assembler:self sourceFile:srcFile];
+    retVal.instrumentation = self.instrumentation;
+    if (nil != retVal && _buildsCrossReference) {
+        [retVal setCrossReference:[self crossReferenceOfSourceFile:srcFile symbols:[retVal symbols]]];
+    }
+
+    return retVal;
+}
+
+
+- (XDTCrossReference *)crossReferenceOfSourceFile:(NSURL *)srcFile symbols:(XDTAs99Symbols *)symbols
+{
+    XDTAcquireGIL();
+    /* Only names of the symbol table are indexed, so mnemonics, registers without R option and comments are skipped */
+    NSMutableSet<NSString *> *symbolNames = [NSMutableSet setWithArray:[[symbols symbols] allKeys]];
+    [symbolNames addObjectsFromArray:[symbols refdefs]];
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"cross_reference" category:XDTInstrumentationCategoryConversion];
+    XDTCrossReference *retVal = nil;
+    XDTBeginNativeWork();
+    retVal = [XDTCrossReference crossReferenceOfSourceFile:srcFile includeURLs:_includeURLs symbolNames:symbolNames syntax:XDTCrossReferenceSyntaxAs99 strict:_beStrict error:nil];
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[retVal occurrenceCount]];
     return retVal;
 }
 
@@ -0,0 +1,71 @@
+//
+//  XDTDisassembler.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTDisassemblerOptionKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
+
+FOUNDATION_EXPORT XDTDisassemblerOptionKey const XDTDisassemblerOptionRunAddresses;  /* (NSArray<NSNumber *>) Addresses where the disassembler follows the program flow */
+FOUNDATION_EXPORT XDTDisassemblerOptionKey const XDTDisassemblerOptionFromAddresses; /* (NSArray<NSNumber *>) Addresses from which the disassembler decodes top-down up to the end of the segment */
+FOUNDATION_EXPORT XDTDisassemblerOptionKey const XDTDisassemblerOptionRegister;      /* (NSNumber) A BOOL to use R notation for registers (the assembler needs the same option) */
+
+
+/**
+ A native disassembler for TMS9900 machine code.
+
+ The disassembler reads raw binaries or program images (the format used by the Editor/Assembler Option 5) and
+ generates assembler source code, which will be assembled by the XDTAssembler into exactly the same bytes again.
+ Everything that is not identified as code is written as DATA (or BYTE) directives.
+
+ Without any run or from address, program images are disassembled by following the program flow from the load
+ address of the first image, and raw binaries are disassembled top-down from their start address.
+
+ An instance can be used for any number of disassemblies, also concurrently, as long as no symbols are loaded meanwhile.
+ */
+@interface XDTDisassembler : NSObject
+
+@property (readonly) NSArray<NSNumber *> *runAddresses;
+@property (readonly) NSArray<NSNumber *> *fromAddresses;
+@property (readonly) BOOL useRegisterSymbols;
+
++ (instancetype)disassemblerWithOptions:(NSDictionary<XDTDisassemblerOptionKey, id> *)options;
+
+/**
+ Imports symbols which are used as labels and as names for addresses in the generated source.
+
+ @param symbols The symbol table as generated by -[XDTAs99Objcode generateSymbols:error:]
+ @return YES if the data contains a text, NO otherwise.
+ */
+- (BOOL)loadSymbols:(NSData *)symbols;
+
+- (nullable NSData *)disassembleBinary:(NSData *)binary atAddress:(NSUInteger)address error:(NSError **)error;
+- (nullable NSData *)disassembleProgramImage:(NSData *)image error:(NSError **)error;
+- (nullable NSData *)disassembleProgramImages:(NSArray<NSData *> *)images error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
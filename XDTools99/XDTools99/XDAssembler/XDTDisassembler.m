@@ -0,0 +1,718 @@
+//
+//  XDTDisassembler.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTDisassembler.h"
+
+#import "XDTObject.h"
+
+
+XDTDisassemblerOptionKey const XDTDisassemblerOptionRunAddresses = @"XDTDisassemblerOptionRunAddresses";
+XDTDisassemblerOptionKey const XDTDisassemblerOptionFromAddresses = @"XDTDisassemblerOptionFromAddresses";
+XDTDisassemblerOptionKey const XDTDisassemblerOptionRegister = @"XDTDisassemblerOptionRegister";
+
+
+#define XDTDisMemorySize 0x10000
+#define XDTDisLineLength 128
+
+/* Flags for every byte of the address space */
+#define XDTDisMarkLoaded 0x01
+#define XDTDisMarkCodeStart 0x02
+#define XDTDisMarkCodeContinued 0x04
+#define XDTDisMarkLineStart 0x08
+#define XDTDisMarkLabel 0x10
+#define XDTDisMarkEquate 0x20
+
+
+typedef NS_ENUM(NSUInteger, XDTDisOperandKind) {
+    XDTDisOperandKindNone,
+    XDTDisOperandKindRegister,
+    XDTDisOperandKindGeneral,
+    XDTDisOperandKindImmediate,
+    XDTDisOperandKindNumber,
+    XDTDisOperandKindJumpTarget,
+    XDTDisOperandKindCRUOffset,
+};
+
+typedef NS_ENUM(NSUInteger, XDTDisFlow) {
+    XDTDisFlowNext,     /* continue with the next instruction */
+    XDTDisFlowBranch,   /* conditional jump: follow the target and continue with the next instruction */
+    XDTDisFlowCall,     /* subroutine call: follow the target and continue with the next instruction */
+    XDTDisFlowVector,   /* BLWP: follow the PC of the vector and continue with the next instruction */
+    XDTDisFlowGoto,     /* unconditional jump: follow the target only */
+    XDTDisFlowStop,     /* return or computed branch */
+};
+
+typedef struct {
+    XDTDisOperandKind kind;
+    uint8_t mode;       /* the addressing mode (Ts / Td) of a general operand */
+    uint8_t reg;
+    int32_t value;
+} XDTDisOperand;
+
+typedef struct {
+    const char *mnemonic;
+    uint16_t length;
+    XDTDisOperand operands[2];
+    XDTDisFlow flow;
+    uint16_t target;
+} XDTDisInstruction;
+
+typedef struct {
+    uint8_t memory[XDTDisMemorySize];
+    uint8_t marks[XDTDisMemorySize];
+    uint16_t *pending;
+    NSUInteger pendingCount;
+    NSUInteger pendingCapacity;
+} XDTDisContext;
+
+
+#pragma mark - Decoder
+
+
+static inline uint16_t XDTDisWordAt(const XDTDisContext *ctx, uint32_t address)
+{
+    return (uint16_t)((ctx->memory[address & 0xFFFF] << 8) | ctx->memory[(address + 1) & 0xFFFF]);
+}
+
+
+static inline BOOL XDTDisIsLoaded(const XDTDisContext *ctx, uint32_t address, uint32_t length)
+{
+    if (XDTDisMemorySize < address + length) {
+        return NO;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        if (0 == (ctx->marks[address + i] & XDTDisMarkLoaded)) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+/* Decodes a general address operand, returns NO if the additional word is not loaded */
+static BOOL XDTDisDecodeGeneral(const XDTDisContext *ctx, uint16_t mode, uint16_t reg, uint32_t address, XDTDisInstruction *instruction, XDTDisOperand *operand)
+{
+    operand->kind = XDTDisOperandKindGeneral;
+    operand->mode = (uint8_t)mode;
+    operand->reg = (uint8_t)reg;
+    if (2 == mode) {
+        uint32_t wordAddress = address + instruction->length;
+        if (!XDTDisIsLoaded(ctx, wordAddress, 2)) {
+            return NO;
+        }
+        operand->value = XDTDisWordAt(ctx, wordAddress);
+        instruction->length += 2;
+    }
+    return YES;
+}
+
+
+/*
+ Decodes the instruction at the given address. Only opcodes which the assembler generates with exactly the same
+ bits are accepted, so every decoded instruction reassembles identically. Returns NO for illegal opcodes.
+ */
+static BOOL XDTDisDecode(const XDTDisContext *ctx, uint32_t address, XDTDisInstruction *instruction)
+{
+    static const char *formatI[] = { "SZC", "SZCB", "S", "SB", "C", "CB", "A", "AB", "MOV", "MOVB", "SOC", "SOCB" };
+    static const char *formatIII[] = { "COC", "CZC", "XOR", "XOP", "LDCR", "STCR", "MPY", "DIV" };
+    static const char *formatII[] = { "JMP", "JLT", "JLE", "JEQ", "JHE", "JGT", "JNE", "JNC", "JOC", "JNO", "JL", "JH", "JOP", "SBO", "SBZ", "TB" };
+    static const char *formatV[] = { "SRA", "SRL", "SLA", "SRC" };
+    static const char *formatVI[] = { "BLWP", "B", "X", "CLR", "NEG", "INV", "INC", "INCT", "DEC", "DECT", "BL", "SWPB", "SETO", "ABS" };
+    static const char *formatVIII[] = { "LI", "AI", "ANDI", "ORI", "CI", "STWP", "STST" };
+    static const char *formatVII[] = { "IDLE", "RSET", "RTWP", "CKON", "CKOF", "LREX" };
+
+    memset(instruction, 0, sizeof(XDTDisInstruction));
+    if (0 != (address & 1) || !XDTDisIsLoaded(ctx, address, 2)) {
+        return NO;
+    }
+    uint16_t word = XDTDisWordAt(ctx, address);
+    instruction->length = 2;
+    instruction->flow = XDTDisFlowNext;
+
+    if (0x4000 <= word) {
+        /* Format I: two general addresses */
+        instruction->mnemonic = formatI[(word >> 12) - 4];
+        return XDTDisDecodeGeneral(ctx, (word >> 4) & 0x3, word & 0xF, address, instruction, &instruction->operands[0]) &&
+               XDTDisDecodeGeneral(ctx, (word >> 10) & 0x3, (word >> 6) & 0xF, address, instruction, &instruction->operands[1]);
+    }
+    if (0x2000 <= word) {
+        /* Format III, IV and IX: a general source address and a register, count or XOP number */
+        NSUInteger index = (word - 0x2000) >> 10;
+        instruction->mnemonic = formatIII[index];
+        XDTDisOperand *second = &instruction->operands[1];
+        second->value = (word >> 6) & 0xF;
+        second->reg = (uint8_t)second->value;
+        second->kind = (3 <= index && index <= 5)? XDTDisOperandKindNumber : XDTDisOperandKindRegister;
+        return XDTDisDecodeGeneral(ctx, (word >> 4) & 0x3, word & 0xF, address, instruction, &instruction->operands[0]);
+    }
+    if (0x1000 <= word) {
+        /* Format II: jumps and CRU bit instructions with a signed 8 bit displacement */
+        NSUInteger index = (word >> 8) & 0xF;
+        int8_t displacement = (int8_t)(word & 0xFF);
+        instruction->mnemonic = formatII[index];
+        if (0xD <= index) {
+            instruction->operands[0].kind = XDTDisOperandKindCRUOffset;
+            instruction->operands[0].value = displacement;
+        } else {
+            instruction->target = (uint16_t)(address + 2 + 2 * displacement);
+            instruction->operands[0].kind = XDTDisOperandKindJumpTarget;
+            instruction->operands[0].value = instruction->target;
+            instruction->flow = (0 == index)? XDTDisFlowGoto : XDTDisFlowBranch;
+        }
+        return YES;
+    }
+    if (0x0C00 <= word) {
+        return NO;      /* 0x0C00 to 0x0FFF are no TMS9900 instructions */
+    }
+    if (0x0800 <= word) {
+        /* Format V: shifts */
+        instruction->mnemonic = formatV[(word >> 8) & 0x3];
+        instruction->operands[0].kind = XDTDisOperandKindRegister;
+        instruction->operands[0].reg = word & 0xF;
+        instruction->operands[1].kind = XDTDisOperandKindNumber;
+        instruction->operands[1].value = (word >> 4) & 0xF;
+        return YES;
+    }
+    if (0x0400 <= word) {
+        /* Format VI: a single general address */
+        NSUInteger index = (word - 0x0400) >> 6;
+        if (sizeof(formatVI) / sizeof(formatVI[0]) <= index) {
+            return NO;
+        }
+        instruction->mnemonic = formatVI[index];
+        XDTDisOperand *operand = &instruction->operands[0];
+        if (!XDTDisDecodeGeneral(ctx, (word >> 4) & 0x3, word & 0xF, address, instruction, operand)) {
+            return NO;
+        }
+        BOOL isSymbolic = 2 == operand->mode && 0 == operand->reg;
+        switch (index) {
+            case 0: /* BLWP */
+                if (isSymbolic && XDTDisIsLoaded(ctx, (uint32_t)operand->value + 2, 2)) {
+                    instruction->flow = XDTDisFlowVector;
+                    instruction->target = XDTDisWordAt(ctx, (uint32_t)operand->value + 2);
+                }
+                break;
+            case 1: /* B */
+                instruction->flow = isSymbolic? XDTDisFlowGoto : XDTDisFlowStop;
+                instruction->target = (uint16_t)operand->value;
+                break;
+            case 10: /* BL */
+                if (isSymbolic) {
+                    instruction->flow = XDTDisFlowCall;
+                    instruction->target = (uint16_t)operand->value;
+                }
+                break;
+            default:
+                break;
+        }
+        return YES;
+    }
+    if (0x0200 <= word) {
+        /* Format VIII and VII: immediates and control instructions */
+        NSUInteger index = (word - 0x0200) >> 5;
+        if (index < 7) {
+            if (0 != (word & 0x0010)) {
+                return NO;
+            }
+            instruction->mnemonic = formatVIII[index];
+            instruction->operands[0].kind = XDTDisOperandKindRegister;
+            instruction->operands[0].reg = word & 0xF;
+            if (5 <= index) {
+                return YES;     /* STWP, STST */
+            }
+        } else if (7 == index || 8 == index) {
+            if (0 != (word & 0x001F)) {
+                return NO;
+            }
+            instruction->mnemonic = (7 == index)? "LWPI" : "LIMI";
+        } else {
+            if (0 != (word & 0x001F) || index < 10) {
+                return NO;
+            }
+            instruction->mnemonic = formatVII[index - 10];
+            if (0x0380 == word) {
+                instruction->flow = XDTDisFlowStop;  /* RTWP */
+            }
+            return YES;
+        }
+        /* the immediate value */
+        if (!XDTDisIsLoaded(ctx, address + 2, 2)) {
+            return NO;
+        }
+        XDTDisOperand *immediate = &instruction->operands[(5 <= index)? 0 : 1];
+        immediate->kind = XDTDisOperandKindImmediate;
+        immediate->value = XDTDisWordAt(ctx, address + 2);
+        instruction->length = 4;
+        return YES;
+    }
+    return NO;
+}
+
+
+#pragma mark - Code Detection
+
+
+static void XDTDisPush(XDTDisContext *ctx, uint32_t address)
+{
+    if (0 != (address & 1) || XDTDisMemorySize <= address) {
+        return;
+    }
+    if (ctx->pendingCount == ctx->pendingCapacity) {
+        ctx->pendingCapacity = (0 == ctx->pendingCapacity)? 256 : 2 * ctx->pendingCapacity;
+        ctx->pending = reallocf(ctx->pending, ctx->pendingCapacity * sizeof(uint16_t));
+        if (NULL == ctx->pending) {
+            ctx->pendingCount = ctx->pendingCapacity = 0;
+            return;
+        }
+    }
+    ctx->pending[ctx->pendingCount++] = (uint16_t)address;
+}
+
+
+/* Marks the instruction as code, unless its bytes overlap with an already detected instruction */
+static BOOL XDTDisMarkInstruction(XDTDisContext *ctx, uint32_t address, const XDTDisInstruction *instruction)
+{
+    for (uint32_t i = 0; i < instruction->length; i++) {
+        if (0 != (ctx->marks[address + i] & (XDTDisMarkCodeStart | XDTDisMarkCodeContinued))) {
+            return NO;
+        }
+    }
+    ctx->marks[address] |= XDTDisMarkCodeStart;
+    for (uint32_t i = 1; i < instruction->length; i++) {
+        ctx->marks[address + i] |= XDTDisMarkCodeContinued;
+    }
+    return YES;
+}
+
+
+/* Follows the program flow from all pending addresses */
+static void XDTDisRun(XDTDisContext *ctx)
+{
+    while (0 < ctx->pendingCount) {
+        uint32_t address = ctx->pending[--ctx->pendingCount];
+        XDTDisInstruction instruction;
+        while (XDTDisDecode(ctx, address, &instruction) && XDTDisMarkInstruction(ctx, address, &instruction)) {
+            if (XDTDisFlowNext != instruction.flow && XDTDisFlowStop != instruction.flow) {
+                XDTDisPush(ctx, instruction.target);
+            }
+            if (XDTDisFlowGoto == instruction.flow || XDTDisFlowStop == instruction.flow) {
+                break;
+            }
+            address += instruction.length;
+        }
+    }
+}
+
+
+/* Decodes top-down from the given address up to the end of the loaded segment */
+static void XDTDisFrom(XDTDisContext *ctx, uint32_t address)
+{
+    address &= ~1U;
+    while (XDTDisIsLoaded(ctx, address, 2)) {
+        XDTDisInstruction instruction;
+        if (0 != (ctx->marks[address] & XDTDisMarkCodeStart)) {
+            XDTDisDecode(ctx, address, &instruction);
+            address += instruction.length;
+        } else if (XDTDisDecode(ctx, address, &instruction) && XDTDisMarkInstruction(ctx, address, &instruction)) {
+            address += instruction.length;
+        } else {
+            address += 2;
+        }
+    }
+}
+
+
+/* Splits the memory into lines: one per instruction, DATA word or single BYTE */
+static void XDTDisMarkLines(XDTDisContext *ctx)
+{
+    uint32_t address = 0;
+    while (address < XDTDisMemorySize) {
+        uint8_t mark = ctx->marks[address];
+        if (0 == (mark & XDTDisMarkLoaded)) {
+            address++;
+            continue;
+        }
+        ctx->marks[address] |= XDTDisMarkLineStart;
+        if (0 != (mark & XDTDisMarkCodeStart)) {
+            XDTDisInstruction instruction;
+            XDTDisDecode(ctx, address, &instruction);
+            address += instruction.length;
+        } else if (0 == (address & 1) && XDTDisIsLoaded(ctx, address + 1, 1) &&
+                   0 == (ctx->marks[address + 1] & XDTDisMarkCodeStart)) {
+            address += 2;
+        } else {
+            address++;
+        }
+    }
+}
+
+
+NS_ASSUME_NONNULL_BEGIN
+@interface XDTDisassembler () {
+    char * _Nullable * _Nullable _symbolNames;
+}
+
+- (instancetype)initWithOptions:(NSDictionary<XDTDisassemblerOptionKey, id> *)options;
+
+@end
+NS_ASSUME_NONNULL_END
+
+
+@implementation XDTDisassembler
+
++ (instancetype)disassemblerWithOptions:(NSDictionary<XDTDisassemblerOptionKey, id> *)options
+{
+    XDTDisassembler *retVal = [[XDTDisassembler alloc] initWithOptions:options];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithOptions:(NSDictionary<XDTDisassemblerOptionKey, id> *)options
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    NSArray<NSNumber *> *runAddresses = [options objectForKey:XDTDisassemblerOptionRunAddresses];
+    NSArray<NSNumber *> *fromAddresses = [options objectForKey:XDTDisassemblerOptionFromAddresses];
+    _runAddresses = (nil == runAddresses)? @[] : [runAddresses copy];
+    _fromAddresses = (nil == fromAddresses)? @[] : [fromAddresses copy];
+    _useRegisterSymbols = [[options objectForKey:XDTDisassemblerOptionRegister] boolValue];
+    _symbolNames = NULL;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    [self freeSymbols];
+#if !__has_feature(objc_arc)
+    [_runAddresses release];
+    [_fromAddresses release];
+
+    [super dealloc];
+#endif
+}
+
+
+- (void)freeSymbols
+{
+    if (NULL == _symbolNames) {
+        return;
+    }
+    for (NSUInteger i = 0; i < XDTDisMemorySize; i++) {
+        free(_symbolNames[i]);
+    }
+    free(_symbolNames);
+    _symbolNames = NULL;
+}
+
+
+- (BOOL)loadSymbols:(NSData *)symbols
+{
+    NSString *symbolText = [[NSString alloc] initWithData:symbols encoding:NSUTF8StringEncoding];
+    if (nil == symbolText) {
+        return NO;
+    }
+#if !__has_feature(objc_arc)
+    [symbolText autorelease];
+#endif
+
+    [self freeSymbols];
+    _symbolNames = calloc(XDTDisMemorySize, sizeof(char *));
+    if (NULL == _symbolNames) {
+        return NO;
+    }
+
+    /* Symbol files look like "NAME  EQU  >A010", the name is the first word, the value the last hex number */
+    NSRegularExpression *symbolRegex = [NSRegularExpression regularExpressionWithPattern:@"^\\s*([^\\s:*]+):?\\s.*>([0-9A-Fa-f]{1,4})\\s*$"
+                                                                                 options:NSRegularExpressionAnchorsMatchLines error:nil];
+    char **symbolNames = _symbolNames;
+    [symbolRegex enumerateMatchesInString:symbolText options:0 range:NSMakeRange(0, [symbolText length])
+                               usingBlock:^(NSTextCheckingResult *result, NSMatchingFlags flags, BOOL *stop) {
+                                   unsigned int value = 0;
+                                   [[NSScanner scannerWithString:[symbolText substringWithRange:[result rangeAtIndex:2]]] scanHexInt:&value];
+                                   /* the first symbol for an address wins */
+                                   if (NULL == symbolNames[value & 0xFFFF]) {
+                                       symbolNames[value & 0xFFFF] = strdup([[symbolText substringWithRange:[result rangeAtIndex:1]] UTF8String]);
+                                   }
+                               }];
+    return YES;
+}
+
+
+#pragma mark - Disassembling
+
+
+- (NSData *)disassembleBinary:(NSData *)binary atAddress:(NSUInteger)address error:(NSError **)error
+{
+    if (0 == [binary length] || XDTDisMemorySize < address + [binary length]) {
+        [self invalidInput:NSLocalizedStringFromTableInBundle(@"The binary does not fit into the address space of the TMS9900.", nil, [NSBundle bundleForClass:[self class]], @"Recovery suggestion for an error object, which explains that the binary to disassemble is empty or exceeds the 64K address space.") error:error];
+        return nil;
+    }
+    XDTDisContext *ctx = calloc(1, sizeof(XDTDisContext));
+    if (NULL == ctx) {
+        return nil;
+    }
+    [self loadData:binary atAddress:address intoContext:ctx];
+    NSData *retVal = [self disassembleContext:ctx defaultRunAddress:NSNotFound defaultFromAddress:address];
+    free(ctx->pending);
+    free(ctx);
+    return retVal;
+}
+
+
+- (NSData *)disassembleProgramImage:(NSData *)image error:(NSError **)error
+{
+    return [self disassembleProgramImages:@[image] error:error];
+}
+
+
+- (NSData *)disassembleProgramImages:(NSArray<NSData *> *)images error:(NSError **)error
+{
+    XDTDisContext *ctx = calloc(1, sizeof(XDTDisContext));
+    if (NULL == ctx) {
+        return nil;
+    }
+    NSUInteger entryAddress = NSNotFound;
+    for (NSData *image in images) {
+        /* header of every image: flag for more images, length of the image including the header, load address */
+        const uint8_t *bytes = [image bytes];
+        NSUInteger imageLength = [image length];
+        NSUInteger length = (6 <= imageLength)? (NSUInteger)((bytes[2] << 8) | bytes[3]) : 0;
+        NSUInteger loadAddress = (6 <= imageLength)? (NSUInteger)((bytes[4] << 8) | bytes[5]) : 0;
+        if (length == imageLength - 6) {
+            length = imageLength;   /* some tools store the length without the header */
+        }
+        if (imageLength < 6 || length < 6 || imageLength < length || XDTDisMemorySize < loadAddress + length - 6) {
+            free(ctx->pending);
+            free(ctx);
+            [self invalidInput:NSLocalizedStringFromTableInBundle(@"The data is not a valid program image.", nil, [NSBundle bundleForClass:[self class]], @"Recovery suggestion for an error object, which explains that the header of a program image is invalid.") error:error];
+            return nil;
+        }
+        if (NSNotFound == entryAddress) {
+            entryAddress = loadAddress;
+        }
+        [self loadData:[image subdataWithRange:NSMakeRange(6, length - 6)] atAddress:loadAddress intoContext:ctx];
+    }
+    NSData *retVal = [self disassembleContext:ctx defaultRunAddress:entryAddress defaultFromAddress:NSNotFound];
+    free(ctx->pending);
+    free(ctx);
+    return retVal;
+}
+
+
+- (void)invalidInput:(NSString *)recoverySuggestion error:(NSError **)error
+{
+    NSLog(@"%s ERROR: %@", __FUNCTION__, recoverySuggestion);
+    if (nil != error) {
+        NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+        NSDictionary *errorDict = @{
+                                    NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Invalid machine code", nil, myBundle, @"Description for an error object, discribing that the data to disassemble is not valid."),
+                                    NSLocalizedRecoverySuggestionErrorKey: recoverySuggestion
+                                    };
+        *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException userInfo:errorDict];
+    }
+}
+
+
+- (void)loadData:(NSData *)data atAddress:(NSUInteger)address intoContext:(XDTDisContext *)ctx
+{
+    NSUInteger length = [data length];
+    [data getBytes:ctx->memory + address length:length];
+    memset(ctx->marks + address, XDTDisMarkLoaded, length);
+}
+
+
+- (NSData *)disassembleContext:(XDTDisContext *)ctx defaultRunAddress:(NSUInteger)runAddress defaultFromAddress:(NSUInteger)fromAddress
+{
+    if (0 == [_runAddresses count] && 0 == [_fromAddresses count]) {
+        if (NSNotFound != runAddress) {
+            XDTDisPush(ctx, (uint32_t)runAddress);
+        }
+        if (NSNotFound != fromAddress) {
+            XDTDisFrom(ctx, (uint32_t)fromAddress);
+        }
+    } else {
+        for (NSNumber *address in _runAddresses) {
+            XDTDisPush(ctx, [address unsignedIntValue]);
+        }
+        for (NSNumber *address in _fromAddresses) {
+            XDTDisFrom(ctx, [address unsignedIntValue]);
+        }
+    }
+    XDTDisRun(ctx);
+    XDTDisMarkLines(ctx);
+    [self resolveReferencesInContext:ctx];
+    return [self sourceForContext:ctx];
+}
+
+
+/* Decides for every referenced address if it becomes a label or an equate of an imported symbol */
+- (void)resolveReferencesInContext:(XDTDisContext *)ctx
+{
+    for (uint32_t address = 0; address < XDTDisMemorySize; address++) {
+        if (NULL != _symbolNames && NULL != _symbolNames[address] && 0 != (ctx->marks[address] & XDTDisMarkLineStart)) {
+            ctx->marks[address] |= XDTDisMarkLabel;
+        }
+        if (0 == (ctx->marks[address] & XDTDisMarkCodeStart)) {
+            continue;
+        }
+        XDTDisInstruction instruction;
+        XDTDisDecode(ctx, address, &instruction);
+        for (NSUInteger i = 0; i < 2; i++) {
+            const XDTDisOperand *operand = &instruction.operands[i];
+            BOOL isAddress = XDTDisOperandKindJumpTarget == operand->kind ||
+                             (XDTDisOperandKindGeneral == operand->kind && 2 == operand->mode && 0 == operand->reg);
+            if (!isAddress) {
+                continue;
+            }
+            uint16_t reference = (uint16_t)operand->value;
+            if (0 != (ctx->marks[reference] & XDTDisMarkLineStart)) {
+                ctx->marks[reference] |= XDTDisMarkLabel;
+            } else if (NULL != _symbolNames && NULL != _symbolNames[reference]) {
+                ctx->marks[reference] |= XDTDisMarkEquate;
+            }
+        }
+    }
+}
+
+
+- (const char *)nameForAddress:(uint16_t)address inContext:(const XDTDisContext *)ctx buffer:(char *)buffer
+{
+    if (NULL != _symbolNames && NULL != _symbolNames[address]) {
+        return _symbolNames[address];
+    }
+    if (0 != (ctx->marks[address] & XDTDisMarkLabel)) {
+        snprintf(buffer, 16, "L%04X", address);
+    } else {
+        snprintf(buffer, 16, ">%04X", address);
+    }
+    return buffer;
+}
+
+
+- (void)formatOperand:(const XDTDisOperand *)operand inContext:(const XDTDisContext *)ctx into:(char *)buffer
+{
+    const char *registerPrefix = _useRegisterSymbols? "R" : "";
+    char nameBuffer[16];
+    switch (operand->kind) {
+        case XDTDisOperandKindNone:
+            buffer[0] = '\0';
+            break;
+        case XDTDisOperandKindRegister:
+            snprintf(buffer, 32, "%s%d", registerPrefix, operand->reg);
+            break;
+        case XDTDisOperandKindGeneral:
+            switch (operand->mode) {
+                case 0:
+                    snprintf(buffer, 32, "%s%d", registerPrefix, operand->reg);
+                    break;
+                case 1:
+                    snprintf(buffer, 32, "*%s%d", registerPrefix, operand->reg);
+                    break;
+                case 2:
+                    if (0 == operand->reg) {
+                        snprintf(buffer, 32, "@%s", [self nameForAddress:(uint16_t)operand->value inContext:ctx buffer:nameBuffer]);
+                    } else {
+                        snprintf(buffer, 32, "@>%04X(%s%d)", (unsigned int)operand->value, registerPrefix, operand->reg);
+                    }
+                    break;
+                default:
+                    snprintf(buffer, 32, "*%s%d+", registerPrefix, operand->reg);
+                    break;
+            }
+            break;
+        case XDTDisOperandKindImmediate:
+            snprintf(buffer, 32, ">%04X", (unsigned int)operand->value);
+            break;
+        case XDTDisOperandKindNumber:
+        case XDTDisOperandKindCRUOffset:
+            snprintf(buffer, 32, "%d", (int)operand->value);
+            break;
+        case XDTDisOperandKindJumpTarget:
+            snprintf(buffer, 32, "%s", [self nameForAddress:(uint16_t)operand->value inContext:ctx buffer:nameBuffer]);
+            break;
+    }
+}
+
+
+- (NSData *)sourceForContext:(const XDTDisContext *)ctx
+{
+    NSMutableData *retVal = [NSMutableData dataWithCapacity:XDTDisMemorySize];
+    char line[XDTDisLineLength];
+    char label[16];
+    char operands[2][32];
+
+    /* imported symbols, which are referenced, but not defined by a label */
+    for (uint32_t address = 0; address < XDTDisMemorySize; address++) {
+        if (0 != (ctx->marks[address] & XDTDisMarkEquate)) {
+            int length = snprintf(line, sizeof(line), "%-6s EQU  >%04X\n", _symbolNames[address], address);
+            [retVal appendBytes:line length:MIN((size_t)length, sizeof(line) - 1)];
+        }
+    }
+
+    uint32_t nextAddress = XDTDisMemorySize;
+    for (uint32_t address = 0; address < XDTDisMemorySize; address++) {
+        uint8_t mark = ctx->marks[address];
+        if (0 == (mark & XDTDisMarkLineStart)) {
+            continue;
+        }
+        if (address != nextAddress) {
+            int length = snprintf(line, sizeof(line), "       AORG >%04X\n", address);
+            [retVal appendBytes:line length:MIN((size_t)length, sizeof(line) - 1)];
+        }
+
+        const char *labelName = (0 != (mark & XDTDisMarkLabel))? [self nameForAddress:(uint16_t)address inContext:ctx buffer:label] : "";
+        int length = 0;
+        if (0 != (mark & XDTDisMarkCodeStart)) {
+            XDTDisInstruction instruction;
+            XDTDisDecode(ctx, address, &instruction);
+            [self formatOperand:&instruction.operands[0] inContext:ctx into:operands[0]];
+            [self formatOperand:&instruction.operands[1] inContext:ctx into:operands[1]];
+            length = snprintf(line, sizeof(line), "%-6s %-4s %s%s%s\n", labelName, instruction.mnemonic, operands[0],
+                              (XDTDisOperandKindNone == instruction.operands[1].kind)? "" : ",", operands[1]);
+            nextAddress = address + instruction.length;
+        } else if (address + 1 < XDTDisMemorySize && 0 != (ctx->marks[address + 1] & XDTDisMarkLoaded) &&
+                   0 == (ctx->marks[address + 1] & XDTDisMarkLineStart)) {
+            length = snprintf(line, sizeof(line), "%-6s DATA >%04X\n", labelName, XDTDisWordAt(ctx, address));
+            nextAddress = address + 2;
+        } else {
+            length = snprintf(line, sizeof(line), "%-6s BYTE >%02X\n", labelName, ctx->memory[address]);
+            nextAddress = address + 1;
+        }
+        [retVal appendBytes:line length:MIN((size_t)length, sizeof(line) - 1)];
+    }
+
+    const char *endLine = "       END\n";
+    [retVal appendBytes:endLine length:strlen(endLine)];
+    return retVal;
+}
+
+@end
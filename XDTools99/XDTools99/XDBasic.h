@@ -26,6 +26,7 @@
 #define XDBasic_h
 
 #import "XDTObject.h"
+#import "XDTInstrumentation.h"
 
 #import "XDTBasic.h"
 
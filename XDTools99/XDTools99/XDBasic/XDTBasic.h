@@ -43,16 +43,22 @@ NS_ASSUME_NONNULL_BEGIN
 
 typedef NSString * XDTBasicOptionKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
 
+FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionInstrumentation;
+FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionMessageAggregation;
+FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionModuleVersion;
 FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionJoinLines;
 FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionLineDelta;
 FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionProtectFile;
 FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionTarget;
+FOUNDATION_EXPORT XDTBasicOptionKey const XDTBasicOptionPythonProfiler;
 
 @interface XDTBasic : XDTObject
 
 @property (readonly) NSString *version;
 @property (readonly) BOOL join;
-@property (readonly) NSUInteger lineDelta;
+@property (readonly) NSUInteger lineDelta;     /* 0 infers the line delta and the width of wrapped lines when joining */
+@property (readonly) NSUInteger joinedLineDelta;    /* The line delta of the last join, inferred or fixed */
+@property (readonly) NSUInteger joinedWrapWidth;    /* The inferred width of the wrapped lines of the last join */
 @property (readonly) BOOL protect;
 @property (readonly) XDTBasicTargetType targetType;
 
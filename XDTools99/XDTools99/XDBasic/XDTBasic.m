@@ -31,6 +31,11 @@
 #import "NSDataPythonAdditions.h"
 
 #import "XDTMessage.h"
+#import "XDTBasicLineJoiner.h"
+#import "XDTInstrumentation.h"
+#import "XDTPythonProfiler.h"
+#import "XDTMemoryBudget.h"
+#import "XDTPythonGIL.h"
 
 
 #define XDTModuleNameBasic "xbas99"
@@ -39,10 +44,29 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+XDTBasicOptionKey const XDTBasicOptionInstrumentation = @"XDTBasicOptionInstrumentation";
+XDTBasicOptionKey const XDTBasicOptionMessageAggregation = @"XDTBasicOptionMessageAggregation";
+XDTBasicOptionKey const XDTBasicOptionModuleVersion = @"XDTBasicOptionModuleVersion";
 XDTBasicOptionKey const XDTBasicOptionJoinLines = @"XDTBasicOptionJoinLines";
 XDTBasicOptionKey const XDTBasicOptionLineDelta = @"XDTBasicOptionLineDelta";
 XDTBasicOptionKey const XDTBasicOptionProtectFile = @"XDTBasicOptionProtectFile";
 XDTBasicOptionKey const XDTBasicOptionTarget = @"XDTBasicOptionTarget";
+XDTBasicOptionKey const XDTBasicOptionPythonProfiler = @"XDTBasicOptionPythonProfiler";
+
+
+@interface XDTObject ()
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
++ (nullable PyObject *)importXDTModule:(const char *)moduleName version:(nullable NSString *)version;
+
+@end
+
+
+@interface XDTMessage ()
+
+- (instancetype)initWithSet:(NSOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *)messageArray;
+
+@end
 
 
 @interface XDTBasic () {
@@ -50,6 +74,8 @@ XDTBasicOptionKey const XDTBasicOptionTarget = @"XDTBasicOptionTarget";
     PyObject *basicProgramPythonClass;
 
     NSArray<NSString *>*_codeLines;
+    NSDictionary<XDTMessageAggregationKey, id> *_messageAggregation;
+    NSArray<NSDictionary<XDTMessageTypeKey, id> *> *_joinMessages;   /* Ambiguous lines of the last native join */
 }
 
 @property NSString *version;
@@ -67,6 +93,7 @@ NS_ASSUME_NONNULL_END
 
 + (BOOL)checkRequiredModuleVersion
 {
+    XDTAcquireGIL();
     PyObject *pName = PyString_FromString(XDTModuleNameBasic);
     PyObject *pModule = PyImport_Import(pName);
     if (NULL == pModule) {
@@ -116,10 +143,14 @@ NS_ASSUME_NONNULL_END
 /* This class method initialize this singleton. It takes care of all python module related things. */
 + (instancetype)basicWithOptions:(NSDictionary<XDTBasicOptionKey, id> *)options
 {
+    XDTAcquireGIL();
     assert(NULL != options);
 
     @synchronized (self) {
-        PyObject *pModule = PyImport_ImportModuleNoBlock(XDTModuleNameBasic);
+        XDTInstrumentation *instrumentation = [options valueForKey:XDTBasicOptionInstrumentation];
+        XDTInstrumentationPhase *phase = [instrumentation beginPhase:@XDTModuleNameBasic category:XDTInstrumentationCategoryImport];
+        PyObject *pModule = [self importXDTModule:XDTModuleNameBasic version:[options valueForKey:XDTBasicOptionModuleVersion]];
+        [instrumentation endPhase:phase returning:NULL passing:NULL];
         if (NULL == pModule) {
             NSLog(@"%s ERROR: Importing module '%s' failed! Python path: %s", __FUNCTION__, XDTModuleNameBasic, Py_GetPath());
             PyObject *exeption = PyErr_Occurred();
@@ -143,6 +174,7 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithOptions:(NSDictionary<XDTBasicOptionKey, id> *)options forModule:(PyObject *)pModule
 {
+    XDTAcquireGIL();
     assert(NULL != pModule);
 
     self = [super init];
@@ -162,7 +194,10 @@ NS_ASSUME_NONNULL_END
 #endif
         return nil;
     }
-    if (0 != strcmp(PyString_AsString(pVar), XDTBasicVersionRequired)) {
+    /* A module of a registered version has the version of its own release, only the module of the framework is checked */
+    NSString *moduleVersion = [options valueForKey:XDTBasicOptionModuleVersion];
+    const BOOL isRegisteredVersion = nil != moduleVersion && [[XDTObject registeredXDTModuleVersions] containsObject:moduleVersion];
+    if (!isRegisteredVersion && 0 != strcmp(PyString_AsString(pVar), XDTBasicVersionRequired)) {
         NSLog(@"%s ERROR: Wrong Basic version %s! Required is %s", __FUNCTION__, PyString_AsString(pVar), XDTBasicVersionRequired);
         Py_XDECREF(pVar);
 #if !__has_feature(objc_arc)
@@ -186,10 +221,19 @@ NS_ASSUME_NONNULL_END
     }
 
     /* reading options from dictionary */
+    self.instrumentation = [options valueForKey:XDTBasicOptionInstrumentation];
+    XDTPythonProfiler *pythonProfiler = [options valueForKey:XDTBasicOptionPythonProfiler];
+    if (nil != pythonProfiler) {
+        if (nil == self.instrumentation) {
+            self.instrumentation = [XDTInstrumentation instrumentation];
+        }
+        self.instrumentation.pythonProfiler = pythonProfiler;
+    }
+    _messageAggregation = [[options valueForKey:XDTBasicOptionMessageAggregation] copy];
     _protect = [[options valueForKey:XDTBasicOptionProtectFile] boolValue];
     _join = [[options valueForKey:XDTBasicOptionJoinLines] boolValue];
     NSNumber *number = [options valueForKey:XDTBasicOptionLineDelta];
-    _lineDelta = (nil == number)? 3 : [number unsignedIntegerValue];
+    _lineDelta = (nil == number)? 0 : [number unsignedIntegerValue];
     _version = [NSString stringWithCString:PyString_AsString(pVar) encoding:NSUTF8StringEncoding];
     Py_XDECREF(pVar);
 
@@ -202,7 +246,9 @@ NS_ASSUME_NONNULL_END
      Behavior: If data is set, longFlag is also used and data will be loaded. If data is not set but source is set,
         the program code in it will be parsed. If non of these parameter are set, a normal initializing is done.
      */
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@XDTClassNameBasic category:XDTInstrumentationCategoryPython];
     PyObject *basicObject = PyObject_CallObject(pFunc, NULL);
+    [self.instrumentation endPhase:phase returning:NULL passing:NULL];
     Py_XDECREF(pFunc);
     if (NULL == basicObject) {
         NSLog(@"%s ERROR: calling constructor %@(None, None, False) failed!", __FUNCTION__, pFunc);
@@ -231,20 +277,39 @@ NS_ASSUME_NONNULL_END
 
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(basicProgramPythonClass);
     Py_CLEAR(basicPythonModule);
 
 #if !__has_feature(objc_arc)
+    [_messageAggregation release];
+    [_joinMessages release];
     [super dealloc];
 #endif
 }
 
 
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return (NULL == basicProgramPythonClass)? @[] : @[[NSValue valueWithPointer:basicProgramPythonClass]];
+}
+
+
+- (NSUInteger)nativeByteCount
+{
+    return [XDTObject nativeByteCountOfObject:_codeLines];
+}
+
+
 #pragma mark - Property Wrapper
 
 
 - (NSDictionary<NSNumber *, NSArray *> *)lines
 {
+    XDTAcquireGIL();
     PyObject *linesObject = PyObject_GetAttrString(basicProgramPythonClass, "lines");
     if (NULL == linesObject) {
         return nil;
@@ -268,6 +333,7 @@ NS_ASSUME_NONNULL_END
 
 - (XDTMessage *)messages
 {
+    XDTAcquireGIL();
     PyObject *warningsObject = PyObject_GetAttrString(basicProgramPythonClass, "warnings");
     if (NULL == warningsObject) {
         return nil;
@@ -276,9 +342,22 @@ NS_ASSUME_NONNULL_END
     XDTMutableMessage *retVal = nil;
     const Py_ssize_t warningCount = PyList_Size(warningsObject);
     if (0 < warningCount) {
-        retVal = [XDTMutableMessage messageWithPythonList:warningsObject treatingAs:XDTMessageTypeWarning];    /* there is no automatic type detection possible, so treat all messages as warnings */
-        [retVal sortByPriorityAscendingType];
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"messages" category:XDTInstrumentationCategoryConversion];
+        retVal = [XDTMutableMessage messageWithPythonList:warningsObject treatingAs:XDTMessageTypeWarning aggregation:_messageAggregation];    /* there is no automatic type detection possible, so treat all messages as warnings */
+        [self.instrumentation endPhase:phase convertingObjects:retVal.count];
+    }
+    if (0 < [_joinMessages count]) {
+        XDTMutableMessage *joinMessages = [[XDTMutableMessage alloc] initWithSet:[NSOrderedSet orderedSetWithArray:_joinMessages]];
+#if !__has_feature(objc_arc)
+        [joinMessages autorelease];
+#endif
+        if (nil == retVal) {
+            retVal = joinMessages;
+        } else {
+            [retVal addMessages:joinMessages];
+        }
     }
+    [retVal sortByPriorityAscendingType];
 
     Py_DECREF(warningsObject);
 
@@ -305,13 +384,17 @@ NS_ASSUME_NONNULL_END
 
 - (BOOL)loadData:(NSData *)data usingLongFormat:(BOOL)useLongFormat error:(NSError **)error
 {
+    XDTAcquireGIL();
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
     /* calling loader:
      load(data, long_)
      */
     PyObject *methodName = PyString_FromString("load");
     PyObject *pData = PyString_FromStringAndSize([data bytes], [data length]);
     PyObject *pLong = PyBool_FromLong(useLongFormat);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"load" category:XDTInstrumentationCategoryPython];
     PyObject *pNonValue = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, pData, pLong, NULL);
+    [self.instrumentation endPhase:phase returning:pNonValue passing:pData, pLong, NULL];
     Py_XDECREF(pLong);
     Py_XDECREF(pData);
     Py_XDECREF(methodName);
@@ -335,12 +418,16 @@ NS_ASSUME_NONNULL_END
 /* load tokenized BASIC program in merge format */
 - (BOOL)loadMergedData:(NSData *)data error:(NSError **)error
 {
+    XDTAcquireGIL();
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
     /* calling loader:
      merge(data)
      */
     PyObject *methodName = PyString_FromString("merge");
     PyObject *pData = PyString_FromStringAndSize([data bytes], [data length]);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"merge" category:XDTInstrumentationCategoryPython];
     PyObject *pNonValue = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, pData, NULL);
+    [self.instrumentation endPhase:phase returning:pNonValue passing:pData, NULL];
     Py_XDECREF(pData);
     Py_XDECREF(methodName);
     if (NULL == pNonValue) {
@@ -363,11 +450,14 @@ NS_ASSUME_NONNULL_END
 /* textual representation of token sequence */
 - (NSString *)getSource:(NSError **)error
 {
+    XDTAcquireGIL();
     /* calling:
      text = get_source()
      */
     PyObject *methodName = PyString_FromString("get_source");
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"get_source" category:XDTInstrumentationCategoryPython];
     PyObject *pSourceCode = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, NULL);
+    [self.instrumentation endPhase:phase returning:pSourceCode passing:NULL];
     Py_XDECREF(methodName);
     if (NULL == pSourceCode) {
         NSLog(@"%s ERROR: get_source() returns NULL!", __FUNCTION__);
@@ -381,20 +471,25 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"get_source" category:XDTInstrumentationCategoryConversion];
     NSString *retVal = [NSString stringWithCString:PyString_AsString(pSourceCode) encoding:NSUTF8StringEncoding];
+    [self.instrumentation endPhase:phase convertingObjects:1];
     return retVal;
 }
 
 
 - (NSData *)getImageUsingLongFormat:(BOOL)useLongFormat error:(NSError **)error
 {
+    XDTAcquireGIL();
     /* calling:
      data = get_image(long_=opts.long_, protected=opts.protect)
      */
     PyObject *methodName = PyString_FromString("get_image");
     PyObject *pLongOpt = PyBool_FromLong(useLongFormat);
     PyObject *pProtectOpt = PyBool_FromLong(_protect);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"get_image" category:XDTInstrumentationCategoryPython];
     PyObject *pProgramData = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, pLongOpt, pProtectOpt, NULL);
+    [self.instrumentation endPhase:phase returning:pProgramData passing:pLongOpt, pProtectOpt, NULL];
     Py_XDECREF(pProtectOpt);
     Py_XDECREF(pLongOpt);
     Py_XDECREF(methodName);
@@ -410,7 +505,9 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"get_image" category:XDTInstrumentationCategoryConversion];
     NSData *imageData = [NSData dataWithPythonString:pProgramData];
+    [self.instrumentation endPhase:phase convertingObjects:1];
 
     Py_DECREF(pProgramData);
 
@@ -424,12 +521,30 @@ NS_ASSUME_NONNULL_END
 /* parse and tokenize BASIC source code */
 - (BOOL)parseSourceCode:(NSString *)sourceCode error:(NSError **)error
 {
+    XDTAcquireGIL();
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
     if (0 == [sourceCode length]) {
         return YES; // an empty source code always parsed into an empty result
     }
 
     /* preparing source code matching Pythons data structure */
     NSArray<NSString *> *lines = [sourceCode componentsSeparatedByString:@"\n"];    /* TODO: respect other line endings... */
+#if !__has_feature(objc_arc)
+    [_joinMessages release];
+#endif
+    _joinMessages = nil;
+    if (_join) {
+        /* the line delta and the wrap width are inferred natively, so a wrong delta does not fail the whole source */
+        XDTBasicLineJoiner *lineJoiner = [XDTBasicLineJoiner lineJoinerWithLineDelta:_lineDelta];
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"join" category:XDTInstrumentationCategoryConversion];
+        XDTBeginNativeWork();
+        lines = [lineJoiner joinLines:lines];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[lines count]];
+        _joinMessages = [[lineJoiner messages] copy];
+        _joinedLineDelta = [lineJoiner lineDelta];
+        _joinedWrapWidth = [lineJoiner wrapWidth];
+    }
     PyObject *pLinesList = PyList_New(0);
     if (NULL == pLinesList) {
         return NO;
@@ -440,39 +555,13 @@ NS_ASSUME_NONNULL_END
         PyList_Append(pLinesList, pLine);
     }
 
-    if (_join) {
-        /* calling static method join:
-         lines = BasicProgram.join(lines, min_lino_delta=1, max_lino_delta=delta)
-         */
-        /* TODO: Make the line delta (here fixed to the default value of 3) configurable by UI */
-        PyObject *methodName = PyString_FromString("join");
-        PyObject *pMinLineDelta = PyInt_FromLong(1);
-        PyObject *pMaxLineDelta = PyInt_FromLong(_lineDelta);
-        PyObject *joinedLines = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, pLinesList, pMinLineDelta, pMaxLineDelta, NULL);
-        Py_XDECREF(pMaxLineDelta);
-        Py_XDECREF(pMinLineDelta);
-        Py_XDECREF(methodName);
-        if (NULL == joinedLines) {  /* if result is null, the line delta could be wrong configured. */
-            NSLog(@"%s ERROR: join(%@, 10) returns NULL!", __FUNCTION__, lines);
-            PyObject *exeption = PyErr_Occurred();
-            if (NULL != exeption) {
-                if (nil != error) {
-                    NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
-                    *error = [NSError errorWithPythonError:exeption localizedRecoverySuggestion:NSLocalizedStringFromTableInBundle(@"Choose another value for the Line Delta, unwrap lines by hand in the integrated source code editor or fix the source file with an external text editor application and reload the file.", nil, myBundle, @"Recovery suggestion for an error object, to choose an other Line Delta for the JOIN operation of the xbas99.")];
-                }
-                PyErr_Print();
-            }
-            return NO;
-        }
-        Py_DECREF(pLinesList);
-        pLinesList = joinedLines;
-    }
-
     /* calling parser:
      parse(lines)
      */
     PyObject *methodName = PyString_FromString("parse");
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"parse" category:XDTInstrumentationCategoryPython];
     PyObject *pNonValue = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, pLinesList, NULL);
+    [self.instrumentation endPhase:phase returning:pNonValue passing:pLinesList, NULL];
     Py_DECREF(pLinesList);
     Py_XDECREF(methodName);
     if (NULL == pNonValue) {
@@ -530,11 +619,14 @@ NS_ASSUME_NONNULL_END
 
 - (NSString *)dumpTokenList:(NSError **)error
 {
+    XDTAcquireGIL();
     /* calling:
      result = dump_tokens()
      */
     PyObject *methodName = PyString_FromString("dump_tokens");
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"dump_tokens" category:XDTInstrumentationCategoryPython];
     PyObject *pDumpString = PyObject_CallMethodObjArgs(basicProgramPythonClass, methodName, NULL);
+    [self.instrumentation endPhase:phase returning:pDumpString passing:NULL];
     Py_XDECREF(methodName);
     if (NULL == pDumpString) {
         NSLog(@"%s ERROR: dump_tokens() returns NULL!", __FUNCTION__);
@@ -548,7 +640,9 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"dump_tokens" category:XDTInstrumentationCategoryConversion];
     NSString *retVal = [NSString stringWithUTF8String:PyString_AsString(pDumpString)];
+    [self.instrumentation endPhase:phase convertingObjects:1];
     return retVal;
 }
 
@@ -0,0 +1,58 @@
+//
+//  XDTBasicLineJoiner.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+#import "XDTMessage.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Joins the wrapped lines of a BASIC listing natively, before xbas99 tokenizes them.
+
+ With a fixed line delta a line is a new program line, when it begins with a number which is greater than the
+ previous line number by at most the delta, like the join of xbas99. With a line delta of 0 the delta and the width
+ of the wrapped lines are inferred from the source: the delta is the most frequent step between the line numbers,
+ and the width the most frequent length of lines which are continued by a line without number. A line which
+ begins with a number then continues the previous line only when that one has the full width. Behind a line of
+ full width every ascending number is ambiguous: it is taken as a new line when it is within the inferred delta or
+ a multiple of it, otherwise it is joined, and either way it is reported as a warning with its line in the source,
+ instead of failing the whole source. Only lines behind shorter lines are new lines without a warning.
+ */
+@interface XDTBasicLineJoiner : NSObject
+
+@property (readonly) NSUInteger lineDelta;      /* The fixed or inferred line delta of the last join */
+@property (readonly) NSUInteger wrapWidth;      /* The inferred width of wrapped lines, 0 without wrapped lines or with a fixed line delta */
+@property (readonly) NSArray<NSDictionary<XDTMessageTypeKey, id> *> *messages;
+
++ (instancetype)lineJoinerWithLineDelta:(NSUInteger)lineDelta;
+
+/* The joined lines, trimmed of white space */
+- (NSArray<NSString *> *)joinLines:(NSArray<NSString *> *)lines;
+
+@end
+
+NS_ASSUME_NONNULL_END
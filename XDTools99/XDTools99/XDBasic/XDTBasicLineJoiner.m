@@ -0,0 +1,256 @@
+//
+//  XDTBasicLineJoiner.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTBasicLineJoiner.h"
+
+
+#define XDTBasicMaxLineNumber 32767
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/* One line of the source as seen by the join */
+typedef struct {
+    NSUInteger length;      /* Without the line break, with trailing spaces */
+    NSInteger number;       /* The line number it begins with, -1 if none */
+    BOOL isBlank;
+} XDTBasicSourceLine;
+
+
+@interface XDTBasicLineJoiner () {
+    NSUInteger _fixedLineDelta;
+    NSMutableArray<NSDictionary<XDTMessageTypeKey, id> *> *_messages;
+}
+
+- (instancetype)initWithLineDelta:(NSUInteger)lineDelta;
+
+- (void)inferFromLines:(const XDTBasicSourceLine *)sourceLines count:(NSUInteger)count;
+- (void)addAmbiguousLine:(NSString *)line atIndex:(NSUInteger)index number:(NSInteger)number joined:(BOOL)isNewLine;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+/* The number at the begin of the line, if it is followed by a space like in a listing */
+static NSInteger XDTBasicLineNumber(NSString *line, NSUInteger length)
+{
+    NSUInteger i = 0;
+    while (i < length && (' ' == [line characterAtIndex:i] || '\t' == [line characterAtIndex:i])) {
+        i++;
+    }
+    const NSUInteger start = i;
+    NSInteger retVal = 0;
+    while (i < length && '0' <= [line characterAtIndex:i] && '9' >= [line characterAtIndex:i] && XDTBasicMaxLineNumber >= retVal) {
+        retVal = retVal * 10 + ([line characterAtIndex:i] - '0');
+        i++;
+    }
+    if (start == i || 0 == retVal || XDTBasicMaxLineNumber < retVal || (i < length && ' ' != [line characterAtIndex:i])) {
+        return -1;
+    }
+    return retVal;
+}
+
+
+/* The most frequent object of the set, of several the smallest or the greatest */
+static NSUInteger XDTBasicMostFrequent(NSCountedSet<NSNumber *> *counts, BOOL preferGreatest)
+{
+    NSUInteger retVal = 0, retCount = 0;
+    for (NSNumber *value in counts) {
+        const NSUInteger count = [counts countForObject:value];
+        const NSUInteger number = [value unsignedIntegerValue];
+        if (count > retCount || (count == retCount && (preferGreatest? number > retVal : number < retVal))) {
+            retVal = number;
+            retCount = count;
+        }
+    }
+    return retVal;
+}
+
+
+@implementation XDTBasicLineJoiner
+
+#pragma mark Initializers
+
++ (instancetype)lineJoinerWithLineDelta:(NSUInteger)lineDelta
+{
+    XDTBasicLineJoiner *retVal = [[XDTBasicLineJoiner alloc] initWithLineDelta:lineDelta];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithLineDelta:(NSUInteger)lineDelta
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _fixedLineDelta = lineDelta;
+    _lineDelta = lineDelta;
+    _messages = [[NSMutableArray alloc] init];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_messages release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSArray<NSDictionary<XDTMessageTypeKey, id> *> *)messages
+{
+    return [NSArray arrayWithArray:_messages];
+}
+
+
+#pragma mark - Joining
+
+
+- (NSArray<NSString *> *)joinLines:(NSArray<NSString *> *)lines
+{
+    [_messages removeAllObjects];
+    const NSUInteger lineCount = [lines count];
+    NSMutableData *sourceData = [NSMutableData dataWithLength:MAX(lineCount, 1) * sizeof(XDTBasicSourceLine)];
+    XDTBasicSourceLine *sourceLines = [sourceData mutableBytes];
+    NSCharacterSet *whitespace = [NSCharacterSet characterSetWithCharactersInString:@" \t\r\n"];
+    for (NSUInteger i = 0; i < lineCount; i++) {
+        NSString *line = [lines objectAtIndex:i];
+        NSUInteger length = [line length];
+        if (0 < length && '\r' == [line characterAtIndex:length - 1]) {
+            length--;
+        }
+        sourceLines[i].length = length;
+        sourceLines[i].number = XDTBasicLineNumber(line, length);
+        sourceLines[i].isBlank = 0 == [[line stringByTrimmingCharactersInSet:whitespace] length];
+    }
+    if (0 == _fixedLineDelta) {
+        [self inferFromLines:sourceLines count:lineCount];
+    }
+
+    /* the continued lines are joined untrimmed, so the spaces at a wrap are kept */
+    NSMutableArray<NSString *> *retVal = [NSMutableArray arrayWithCapacity:lineCount];
+    NSMutableString *joinedLine = nil;
+    NSInteger previousNumber = -1;
+    for (NSUInteger i = 0; i < lineCount; i++) {
+        NSString *line = [[lines objectAtIndex:i] substringToIndex:sourceLines[i].length];
+        const XDTBasicSourceLine *sourceLine = &sourceLines[i];
+        const XDTBasicSourceLine *previousLine = (0 < i)? &sourceLines[i - 1] : NULL;
+
+        BOOL isNewLine = YES;
+        if (sourceLine->isBlank || nil == joinedLine || NULL == previousLine || previousLine->isBlank) {
+            isNewLine = YES;
+        } else if (0 > sourceLine->number) {
+            isNewLine = NO;
+        } else {
+            const NSInteger step = sourceLine->number - previousNumber;
+            if (0 < _fixedLineDelta) {
+                isNewLine = 0 < step && (NSInteger)_fixedLineDelta >= step;
+            } else if (0 == _wrapWidth || previousLine->length < _wrapWidth) {
+                isNewLine = YES;    /* a line shorter than the width has not been wrapped */
+            } else if (0 >= step) {
+                isNewLine = NO;     /* the numbers of a wrapped listing are ascending */
+            } else {
+                /* a wrapped line may begin with any number, so every number behind a full line is ambiguous */
+                isNewLine = 0 == _lineDelta || (NSInteger)_lineDelta >= step || 0 == step % _lineDelta;
+                [self addAmbiguousLine:line atIndex:i number:sourceLine->number joined:isNewLine];
+            }
+        }
+
+        if (!isNewLine) {
+            [joinedLine appendString:line];
+            continue;
+        }
+        if (nil != joinedLine) {
+            [retVal addObject:[joinedLine stringByTrimmingCharactersInSet:whitespace]];
+        }
+        joinedLine = [NSMutableString stringWithString:line];
+        if (0 <= sourceLine->number) {
+            previousNumber = sourceLine->number;
+        }
+    }
+    if (nil != joinedLine) {
+        [retVal addObject:[joinedLine stringByTrimmingCharactersInSet:whitespace]];
+    }
+
+    return retVal;
+}
+
+
+#pragma mark - Private Methods
+
+
+/*
+ The steps between the numbers of consecutive numbered lines give the delta, even if some of them are continued
+ lines which begin with digits. Lines followed by a line without a number are wrapped for sure, so their lengths
+ give the width. Both are the most frequent values, which does not depend on the order of the lines.
+ */
+- (void)inferFromLines:(const XDTBasicSourceLine *)sourceLines count:(NSUInteger)count
+{
+    NSCountedSet<NSNumber *> *steps = [NSCountedSet set];
+    NSCountedSet<NSNumber *> *widths = [NSCountedSet set];
+    NSInteger previousNumber = -1;
+    for (NSUInteger i = 0; i < count; i++) {
+        const XDTBasicSourceLine *sourceLine = &sourceLines[i];
+        if (0 <= sourceLine->number) {
+            if (0 <= previousNumber && previousNumber < sourceLine->number) {
+                [steps addObject:[NSNumber numberWithInteger:sourceLine->number - previousNumber]];
+            }
+            previousNumber = sourceLine->number;
+        } else if (0 < i && !sourceLine->isBlank && !sourceLines[i - 1].isBlank) {
+            [widths addObject:[NSNumber numberWithUnsignedInteger:sourceLines[i - 1].length]];
+        }
+    }
+    _lineDelta = XDTBasicMostFrequent(steps, NO);
+    _wrapWidth = XDTBasicMostFrequent(widths, YES);
+}
+
+
+- (void)addAmbiguousLine:(NSString *)line atIndex:(NSUInteger)index number:(NSInteger)number joined:(BOOL)isNewLine
+{
+    NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+    NSString *format = isNewLine? NSLocalizedStringFromTableInBundle(@"Ambiguous line number %ld, taken as a new line", nil, myBundle, @"Warning of the join of BASIC lines, that a wrapped line begins with a number which may be a line number, and which is taken as a new program line.") :
+                                  NSLocalizedStringFromTableInBundle(@"Ambiguous line number %ld, joined to the previous line", nil, myBundle, @"Warning of the join of BASIC lines, that a wrapped line begins with a number which may be a line number, but which is joined to the previous program line.");
+    [_messages addObject:@{
+                           XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:index + 1],
+                           XDTMessageCodeLine: line,
+                           XDTMessageText: [NSString stringWithFormat:format, (long)number],
+                           XDTMessageType: [NSNumber numberWithUnsignedInteger:XDTMessageTypeWarning]
+                           }];
+}
+
+@end
@@ -26,11 +26,14 @@
 #define XDGPL_h
 
 #import "XDTObject.h"
+#import "XDTInstrumentation.h"
 
 #import "XDTGa99Objcode.h"
 #import "XDTGPLAssembler.h"
+#import "XDTGPLInterpreter.h"
 
 #import "XDTZipFile.h"
+#import "XDTCartridgeBuilder.h"
 
 #import "XDTMessage.h"
 
@@ -52,6 +52,12 @@ FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionAORG;
 FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionStyle;
 FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionTarget;
 FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionWarnings;
+FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionInstrumentation;
+FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionMessageAggregation;
+FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionModuleVersion;
+FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionCrossReference;
+FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionNativeAssembly;
+FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionPythonProfiler;
 
 
 @interface XDTGPLAssembler : XDTObject
@@ -63,6 +69,7 @@ FOUNDATION_EXPORT XDTGa99OptionKey const XDTGa99OptionWarnings;
 @property (readonly) XDTGa99SyntaxType syntaxType;
 @property (readonly) BOOL outputWarnings;
 @property (readonly, nullable) XDTMessage *messages;    /* Object that contains all messages (Error, Warning, etc) after the assembler run */
+@property (readonly, nullable) NSString *nativeFallbackReason;  /* Why the last source was assembled by xga99 despite the native assembly option */
 
 + (BOOL)checkRequiredModuleVersion;
 
@@ -31,7 +31,13 @@
 
 #import "XDTException.h"
 #import "XDTMessage.h"
+#import "XDTInstrumentation.h"
+#import "XDTPythonProfiler.h"
 #import "XDTGa99Objcode.h"
+#import "XDTCrossReference.h"
+#import "XDTGa99NativeAssembler.h"
+#import "XDTMemoryBudget.h"
+#import "XDTPythonGIL.h"
 
 
 #define XDTModuleNameGPLAssembler "xga99"
@@ -40,6 +46,14 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@interface XDTObject ()
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
++ (nullable PyObject *)importXDTModule:(const char *)moduleName version:(nullable NSString *)version;
+
+@end
+
+
 @interface XDTGa99Objcode () {
     PyObject *objectcodePythonClass;
 }
@@ -53,9 +67,12 @@ NS_ASSUME_NONNULL_BEGIN
  **/
 
 + (nullable instancetype)gplObjectcodeWithPythonInstance:(void *)object;
++ (nullable instancetype)gplObjectcodeWithNativeProgram:(XDTGa99NativeProgram *)program assembler:(XDTGPLAssembler *)assembler sourceFile:(NSURL *)srcFile;
 
 - (nullable instancetype)initWithPythonInstance:(PyObject *)object;
 
+- (void)setCrossReference:(nullable XDTCrossReference *)crossReference;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -68,23 +85,40 @@ XDTGa99OptionKey const XDTGa99OptionAORG = @"XDTGa99OptionAORG";
 XDTGa99OptionKey const XDTGa99OptionStyle = @"XDTGa99OptionStyle";
 XDTGa99OptionKey const XDTGa99OptionTarget = @"XDTGa99OptionTarget";
 XDTGa99OptionKey const XDTGa99OptionWarnings = @"XDTGa99OptionWarnings";
+XDTGa99OptionKey const XDTGa99OptionInstrumentation = @"XDTGa99OptionInstrumentation";
+XDTGa99OptionKey const XDTGa99OptionMessageAggregation = @"XDTGa99OptionMessageAggregation";
+XDTGa99OptionKey const XDTGa99OptionModuleVersion = @"XDTGa99OptionModuleVersion";
+XDTGa99OptionKey const XDTGa99OptionCrossReference = @"XDTGa99OptionCrossReference";
+XDTGa99OptionKey const XDTGa99OptionNativeAssembly = @"XDTGa99OptionNativeAssembly";
+XDTGa99OptionKey const XDTGa99OptionPythonProfiler = @"XDTGa99OptionPythonProfiler";
 
 
-@interface XDTGPLAssembler () {
+@interface XDTGPLAssembler () <XDTMessageSource> {
     const PyObject *assemblerPythonModule;
     PyObject *assemblerPythonClass;
     XDTMessage *_messages;
+    NSDictionary<XDTMessageAggregationKey, id> *_messageAggregation;
+    NSArray<NSURL *> *_includeURLs;
+    BOOL _buildsCrossReference;
+    BOOL _assemblesNatively;
+    BOOL _hasNativeResult;      /* The messages of the Python assembler belong to an earlier source then */
 }
 
 @property NSString *version;
 @property XDTGa99TargetType targetType;
 @property XDTGa99SyntaxType syntaxType;
+@property (nullable, copy) NSString *nativeFallbackReason;
 
 - (nullable instancetype)initWithOptions:(NSDictionary<XDTGa99OptionKey, id> *)options forModule:(PyObject *)pModule includeURL:(NSArray<NSURL *> *)urls;
 
 - (nullable const char *)syntaxTypeAsCString;
 - (nullable const char *)targetTypeAsCString;
 
+/* Package private for the fallback of XDTGa99Objcode: returns a new reference to the tuple of assemble() */
+- (nullable PyObject *)pythonResultOfSourceFile:(NSURL *)srcname error:(NSError **)error;
+- (nullable XDTGa99Objcode *)nativeObjcodeOfSourceFile:(NSURL *)srcname;
+- (nullable XDTCrossReference *)crossReferenceOfSourceFile:(NSURL *)srcname symbolNames:(NSSet<NSString *> *)symbolNames;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -94,6 +128,7 @@ NS_ASSUME_NONNULL_END
 
 + (BOOL)checkRequiredModuleVersion
 {
+    XDTAcquireGIL();
     PyObject *pName = PyString_FromString(XDTModuleNameGPLAssembler);
     PyObject *pModule = PyImport_Import(pName);
     if (NULL == pModule) {
@@ -142,11 +177,15 @@ NS_ASSUME_NONNULL_END
 
 + (instancetype)gplAssemblerWithOptions:(NSDictionary<XDTGa99OptionKey, id> *)options includeURL:(NSURL *)url
 {
+    XDTAcquireGIL();
     assert(NULL != options);
     assert(nil != url);
 
     @synchronized (self) {
-        PyObject *pModule = PyImport_ImportModuleNoBlock(XDTModuleNameGPLAssembler);
+        XDTInstrumentation *instrumentation = [options valueForKey:XDTGa99OptionInstrumentation];
+        XDTInstrumentationPhase *phase = [instrumentation beginPhase:@XDTModuleNameGPLAssembler category:XDTInstrumentationCategoryImport];
+        PyObject *pModule = [self importXDTModule:XDTModuleNameGPLAssembler version:[options valueForKey:XDTGa99OptionModuleVersion]];
+        [instrumentation endPhase:phase returning:NULL passing:NULL];
         if (NULL == pModule) {
             NSLog(@"%s ERROR: Importing module '%s' failed! Python path: %s", __FUNCTION__, XDTModuleNameGPLAssembler, Py_GetPath());
             PyObject *exeption = PyErr_Occurred();
@@ -178,6 +217,7 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithOptions:(NSDictionary<XDTGa99OptionKey, id> *)options forModule:(PyObject *)pModule includeURL:(NSArray<NSURL *> *)urls
 {
+    XDTAcquireGIL();
     assert(NULL != pModule);
     assert(nil != urls);
 
@@ -198,7 +238,10 @@ NS_ASSUME_NONNULL_END
 #endif
         return nil;
     }
-    if (0 != strcmp(PyString_AsString(pVar), XDTGPLAssemblerVersionRequired)) {
+    /* A module of a registered version has the version of its own release, only the module of the framework is checked */
+    NSString *moduleVersion = [options valueForKey:XDTGa99OptionModuleVersion];
+    const BOOL isRegisteredVersion = nil != moduleVersion && [[XDTObject registeredXDTModuleVersions] containsObject:moduleVersion];
+    if (!isRegisteredVersion && 0 != strcmp(PyString_AsString(pVar), XDTGPLAssemblerVersionRequired)) {
         NSLog(@"%s ERROR: Wrong GPL Assembler version %s! Required is %s", __FUNCTION__, PyString_AsString(pVar), XDTGPLAssemblerVersionRequired);
         Py_XDECREF(pVar);
 #if !__has_feature(objc_arc)
@@ -222,6 +265,18 @@ NS_ASSUME_NONNULL_END
     }
 
     /* reading option from dictionary */
+    self.instrumentation = [options valueForKey:XDTGa99OptionInstrumentation];
+    XDTPythonProfiler *pythonProfiler = [options valueForKey:XDTGa99OptionPythonProfiler];
+    if (nil != pythonProfiler) {
+        if (nil == self.instrumentation) {
+            self.instrumentation = [XDTInstrumentation instrumentation];
+        }
+        self.instrumentation.pythonProfiler = pythonProfiler;
+    }
+    _messageAggregation = [[options valueForKey:XDTGa99OptionMessageAggregation] copy];
+    _buildsCrossReference = [[options valueForKey:XDTGa99OptionCrossReference] boolValue];
+    _assemblesNatively = [[options valueForKey:XDTGa99OptionNativeAssembly] boolValue];
+    _includeURLs = [urls copy];
     _targetType = [[options valueForKey:XDTGa99OptionTarget] unsignedIntegerValue];
     _syntaxType = [[options valueForKey:XDTGa99OptionStyle] unsignedIntegerValue];
     _aorgAddress = [[options valueForKey:XDTGa99OptionAORG] unsignedIntegerValue];
@@ -246,7 +301,9 @@ NS_ASSUME_NONNULL_END
         asm = Assembler(syntax, grom, aorg, target="", include_path=None, defs=(), warnings=True):
      */
     PyObject *pArgs = PyTuple_Pack(7, syntax, grom, aorg, target, includePath, defs, outputWarnings);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@XDTClassNameGPLAssembler category:XDTInstrumentationCategoryPython];
     PyObject *assembler = PyObject_CallObject(pFunc, pArgs);
+    [self.instrumentation endPhase:phase returning:NULL passing:pArgs, NULL];
     Py_XDECREF(pArgs);
     Py_XDECREF(pFunc);
     if (NULL == assembler) {
@@ -276,10 +333,14 @@ NS_ASSUME_NONNULL_END
 
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(assemblerPythonClass);
     Py_CLEAR(assemblerPythonModule);
 
 #if !__has_feature(objc_arc)
+    [_messageAggregation release];
+    [_includeURLs release];
+    [_nativeFallbackReason release];
     [super dealloc];
 #endif
 }
@@ -322,7 +383,8 @@ NS_ASSUME_NONNULL_END
 
 - (XDTMessage *)messages
 {
-    if (nil != _messages) {
+    XDTAcquireGIL();
+    if (nil != _messages || _hasNativeResult) {
         return _messages;
     }
 
@@ -331,17 +393,57 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
-    XDTMutableMessage *retVal = [XDTMutableMessage messageWithPythonList:messageList];
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"messages" category:XDTInstrumentationCategoryConversion];
+    XDTMutableMessage *retVal = [XDTMutableMessage messageWithPythonList:messageList treatingAs:XDTMessageTypeAll aggregation:_messageAggregation];
+    [self.instrumentation endPhase:phase convertingObjects:retVal.count];
     if (0 >= retVal.count) {
         return nil;
     }
     [retVal sortByPriorityAscendingType];
+    if ([retVal isAggregated]) {
+        retVal.messageSource = self;
+    }
 
     _messages = retVal;
     return _messages;
 }
 
 
+/* The console still holds the messages of the last run, so the aggregated ones are converted again one by one */
+- (XDTMessage *)expandedMessagesOfMessages:(XDTMessage *)messages
+{
+    XDTAcquireGIL();
+    if (messages != _messages || NULL == assemblerPythonClass) {
+        return nil;
+    }
+
+    PyObject *messageList = PyObject_GetAttrString(assemblerPythonClass, "console");
+    if (NULL == messageList) {
+        return nil;
+    }
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"expand_messages" category:XDTInstrumentationCategoryConversion];
+    XDTMessage *retVal = [XDTMessage messageWithPythonList:messageList treatingAs:XDTMessageTypeAll];
+    [self.instrumentation endPhase:phase convertingObjects:retVal.count];
+    Py_DECREF(messageList);
+    return retVal;
+}
+
+
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return (NULL == assemblerPythonClass)? @[] : @[[NSValue valueWithPointer:assemblerPythonClass]];
+}
+
+
+- (NSUInteger)nativeByteCount
+{
+    return [XDTObject nativeByteCountOfObject:_messages] + [XDTObject nativeByteCountOfObject:_includeURLs];
+}
+
+
 #pragma mark - Parsing Methods
 
 
@@ -353,25 +455,19 @@ NS_ASSUME_NONNULL_END
 
 - (XDTGa99Objcode *)assembleSourceFile:(NSURL *)srcname pathName:(NSURL *)pathName error:(NSError **)error
 {
-    NSString *basename = [srcname lastPathComponent];
+    XDTAcquireGIL();
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
+    if (_assemblesNatively) {
+        XDTGa99Objcode *retVal = [self nativeObjcodeOfSourceFile:srcname];
+        if (nil != retVal) {
+            [[XDTMemoryBudget sharedBudget] enforceLimitSparingObject:retVal];
+            return retVal;
+        }
+    }
 
-    /* calling assembler:
-     code, errors, warnings = asm.assemble(basename)
-     */
-    PyObject *methodName = PyString_FromString("assemble");
-    PyObject *pbaseName = PyString_FromString([basename UTF8String]);
-    PyObject *pValueTupel = PyObject_CallMethodObjArgs(assemblerPythonClass, methodName, pbaseName, NULL);
-    Py_XDECREF(pbaseName);
-    Py_XDECREF(methodName);
+    NSString *basename = [srcname lastPathComponent];
+    PyObject *pValueTupel = [self pythonResultOfSourceFile:srcname error:error];
     if (NULL == pValueTupel) {
-        NSLog(@"%s ERROR: assemble(\"%@\") returns NULL!", __FUNCTION__, basename);
-        PyObject *exeption = PyErr_Occurred();
-        if (NULL != exeption) {
-            if (nil != error) {
-                *error = [NSError errorWithPythonError:exeption localizedRecoverySuggestion:nil];
-            }
-            PyErr_Print();
-        }
         return nil;
     }
 
@@ -386,6 +482,7 @@ NS_ASSUME_NONNULL_END
 
     [self willChangeValueForKey:NSStringFromSelector(@selector(messages))];
     _messages = nil;
+    _hasNativeResult = NO;
     [self didChangeValueForKey:NSStringFromSelector(@selector(messages))];
 
     XDTMessage *newMessages = self.messages;
@@ -407,10 +504,110 @@ NS_ASSUME_NONNULL_END
     PyObject *objectCodeObject = PyTuple_GetItem(pValueTupel, 0);
     if (NULL != objectCodeObject) {
         retVal = [XDTGa99Objcode gplObjectcodeWithPythonInstance:objectCodeObject];
+        retVal.instrumentation = self.instrumentation;
+    }
+
+    if (nil != retVal && _buildsCrossReference) {
+        /*
+         The GPL object code has no symbols wrapper, so the names are taken from its symbol file:
+            NAME     EQU  >6010
+         */
+        NSMutableSet<NSString *> *symbolNames = [NSMutableSet set];
+        NSData *symbolData = [retVal generateSymbols:YES error:nil];
+        NSString *symbolText = (nil == symbolData)? nil : [[NSString alloc] initWithData:symbolData encoding:NSISOLatin1StringEncoding];
+#if !__has_feature(objc_arc)
+        [symbolText autorelease];
+#endif
+        [symbolText enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+            NSArray<NSString *> *fields = [[line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+            if (1 < [fields count] && [fields containsObject:@"EQU"]) {
+                [symbolNames addObject:[[fields firstObject] stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@":"]]];
+            }
+        }];
+        [retVal setCrossReference:[self crossReferenceOfSourceFile:srcname symbolNames:symbolNames]];
     }
 
     Py_DECREF(pValueTupel);
+    [[XDTMemoryBudget sharedBudget] enforceLimitSparingObject:retVal];
+
+    return retVal;
+}
+
+
+- (PyObject *)pythonResultOfSourceFile:(NSURL *)srcname error:(NSError **)error
+{
+    XDTAcquireGIL();
+    NSString *basename = [srcname lastPathComponent];
 
+    /* calling assembler:
+     code, errors, warnings = asm.assemble(basename)
+     */
+    PyObject *methodName = PyString_FromString("assemble");
+    PyObject *pbaseName = PyString_FromString([basename UTF8String]);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"assemble" category:XDTInstrumentationCategoryPython];
+    PyObject *pValueTupel = PyObject_CallMethodObjArgs(assemblerPythonClass, methodName, pbaseName, NULL);
+    [self.instrumentation endPhase:phase returning:pValueTupel passing:pbaseName, NULL];
+    Py_XDECREF(pbaseName);
+    Py_XDECREF(methodName);
+    if (NULL == pValueTupel) {
+        NSLog(@"%s ERROR: assemble(\"%@\") returns NULL!", __FUNCTION__, basename);
+        PyObject *exeption = PyErr_Occurred();
+        if (NULL != exeption) {
+            if (nil != error) {
+                *error = [NSError errorWithPythonError:exeption localizedRecoverySuggestion:nil];
+            }
+            PyErr_Print();
+        }
+    }
+
+    return pValueTupel;
+}
+
+
+/*
+ The native assembler handles the common subset of xga99 only and gives up on everything else, e.g. macros or any
+ error, so the source is assembled by xga99 then. It never generates messages.
+ */
+- (XDTGa99Objcode *)nativeObjcodeOfSourceFile:(NSURL *)srcname
+{
+    XDTAcquireGIL();
+    NSString *reason = nil;
+    XDTGa99NativeAssembler *nativeAssembler = [XDTGa99NativeAssembler nativeAssemblerWithIncludeURLs:_includeURLs syntax:[self syntaxTypeAsCString] gromAddress:_gromAddress aorgAddress:_aorgAddress];
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"assemble_native" category:XDTInstrumentationCategoryConversion];
+    XDTGa99NativeProgram *program = nil;
+    XDTBeginNativeWork();
+    program = [nativeAssembler assembleSourceFile:srcname unsupportedReason:&reason];
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[[program symbols] count]];
+    self.nativeFallbackReason = reason;
+    if (nil == program) {
+        return nil;
+    }
+
+    [self willChangeValueForKey:NSStringFromSelector(@selector(messages))];
+    _messages = nil;
+    _hasNativeResult = YES;
+    [self didChangeValueForKey:NSStringFromSelector(@selector(messages))];
+
+    XDTGa99Objcode *retVal = [XDTGa99Objcode gplObjectcodeWithNativeProgram:program assembler:self sourceFile:srcname];
+    retVal.instrumentation = self.instrumentation;
+    if (nil != retVal && _buildsCrossReference) {
+        [retVal setCrossReference:[self crossReferenceOfSourceFile:srcname symbolNames:[NSSet setWithArray:[[program symbols] allKeys]]]];
+    }
+
+    return retVal;
+}
+
+
+- (XDTCrossReference *)crossReferenceOfSourceFile:(NSURL *)srcname symbolNames:(NSSet<NSString *> *)symbolNames
+{
+    XDTAcquireGIL();
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"cross_reference" category:XDTInstrumentationCategoryConversion];
+    XDTCrossReference *retVal = nil;
+    XDTBeginNativeWork();
+    retVal = [XDTCrossReference crossReferenceOfSourceFile:srcname includeURLs:_includeURLs symbolNames:symbolNames syntax:XDTCrossReferenceSyntaxGa99 strict:NO error:nil];
+    XDTEndNativeWork();
+    [self.instrumentation endPhase:phase convertingObjects:[retVal occurrenceCount]];
     return retVal;
 }
 
@@ -0,0 +1,111 @@
+//
+//  XDTGPLInterpreter.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+
+typedef NS_ENUM(NSUInteger, XDTGPLInterpreterState) {
+    XDTGPLInterpreterStateReady,        /* Memory is loaded, nothing has been executed so far */
+    XDTGPLInterpreterStateExited,       /* The program executed EXIT or returned from its top level subroutine */
+    XDTGPLInterpreterStateCycleLimit,   /* The execution stopped because the cycle budget is exhausted */
+    XDTGPLInterpreterStateBreakpoint,   /* The execution stopped at a breakpoint address */
+    XDTGPLInterpreterStateUnsupported,  /* An opcode was found that cannot be executed by this interpreter */
+};
+
+
+typedef struct {
+    NSUInteger instruction;     /* base cost of decoding and dispatching any instruction */
+    NSUInteger gromFetch;       /* cost for every byte read from the GROM, including the instruction bytes */
+    NSUInteger cpuAccess;       /* cost for every byte read or written in CPU RAM */
+    NSUInteger vdpAccess;       /* cost for every byte read or written in VDP RAM */
+    NSUInteger indirection;     /* additional cost of indirect or indexed addressing */
+    NSUInteger multiply;        /* additional cost of MUL */
+    NSUInteger divide;          /* additional cost of DIV */
+} XDTGPLCycleCosts;
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTGPLProfileKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionary of a hot spot */
+
+FOUNDATION_EXPORT XDTGPLProfileKey const XDTGPLProfileLabel;        /* Name of the label of the code section as NSString */
+FOUNDATION_EXPORT XDTGPLProfileKey const XDTGPLProfileAddress;      /* GROM address of the label as NSNumber */
+FOUNDATION_EXPORT XDTGPLProfileKey const XDTGPLProfileExecutions;   /* Number of executed instructions within the section as NSNumber */
+FOUNDATION_EXPORT XDTGPLProfileKey const XDTGPLProfileEntries;      /* Number of executions of the first instruction of the section as NSNumber */
+FOUNDATION_EXPORT XDTGPLProfileKey const XDTGPLProfileCycles;       /* Sum of all cycles spent within the section as NSNumber */
+FOUNDATION_EXPORT XDTGPLProfileKey const XDTGPLProfilePercentage;   /* Share of all cycles as NSNumber with a double value */
+
+
+/**
+ A native interpreter for GPL byte code as it is generated by XDTGa99Objcode.
+
+ The interpreter models the 64K GROM, 16K VDP RAM and the CPU address space (including the scratch pad at >8300)
+ of the TI 99/4A. It executes GPL instructions using a simple cycle cost model and counts for every GROM address how
+ often it was executed and how many cycles were spent there. With the labels of the assembled program these counts are
+ aggregated into a hot spot report.
+ Assembly language subroutines (XML), sound and keyboard I/O are not emulated; they are counted but have no effect.
+ */
+@interface XDTGPLInterpreter : NSObject
+
+@property (readonly) XDTGPLInterpreterState state;
+@property (readonly) NSUInteger programCounter;
+@property (readonly) unsigned long long cycles;
+@property (readonly) unsigned long long instructions;
+@property (assign) XDTGPLCycleCosts cycleCosts;
+@property (nullable, readonly) NSString *stateDescription;  /* Textual explanation why the interpreter has stopped */
+
+@property (nullable, copy) NSDictionary<NSString *, NSNumber *> *labels;    /* label names and their GROM addresses */
+
++ (instancetype)interpreter;
++ (XDTGPLCycleCosts)defaultCycleCosts;
+
+/* Loading memory */
+- (BOOL)loadByteCode:(NSArray<NSArray<id> *> *)byteCode error:(NSError **)error;    /* the result of -[XDTGa99Objcode generateByteCode:] */
+- (BOOL)loadImage:(NSData *)image atGROMAddress:(NSUInteger)gromAddress error:(NSError **)error;   /* the result of -[XDTGa99Objcode generateImageWithName:error:] */
+- (BOOL)loadSymbols:(NSData *)symbols;   /* the result of -[XDTGa99Objcode generateSymbols:error:] */
+- (void)reset;  /* clears RAM, counters and the profile, but keeps the loaded GROM content and labels */
+
+- (uint8_t)gromByteAtAddress:(NSUInteger)address;
+- (uint8_t)cpuByteAtAddress:(NSUInteger)address;
+- (uint8_t)vdpByteAtAddress:(NSUInteger)address;
+- (void)setCPUByte:(uint8_t)value atAddress:(NSUInteger)address;
+- (void)setVDPByte:(uint8_t)value atAddress:(NSUInteger)address;
+
+/* Execution */
+- (NSUInteger)entryAddressOfImage;  /* the address of the first program in the GROM header at the load address, or NSNotFound */
+- (XDTGPLInterpreterState)runFromAddress:(NSUInteger)address maximumCycles:(unsigned long long)maxCycles;
+- (XDTGPLInterpreterState)continueWithMaximumCycles:(unsigned long long)maxCycles;
+- (void)addBreakpointAtAddress:(NSUInteger)address;
+- (void)removeAllBreakpoints;
+
+/* Profiling */
+- (unsigned long long)executionCountAtAddress:(NSUInteger)address;
+- (unsigned long long)cycleCountAtAddress:(NSUInteger)address;
+- (NSDictionary<NSString *, NSNumber *> *)executionCountsPerLabel;
+- (NSArray<NSDictionary<XDTGPLProfileKey, id> *> *)hotSpots;    /* sorted by descending cycles */
+- (NSString *)hotSpotReportWithLimit:(NSUInteger)maxLines;
+
+@end
+
+NS_ASSUME_NONNULL_END
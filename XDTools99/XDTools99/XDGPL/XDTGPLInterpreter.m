@@ -0,0 +1,1148 @@
+//
+//  XDTGPLInterpreter.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTGPLInterpreter.h"
+
+#import "XDTObject.h"
+
+
+XDTGPLProfileKey const XDTGPLProfileLabel = @"XDTGPLProfileLabel";
+XDTGPLProfileKey const XDTGPLProfileAddress = @"XDTGPLProfileAddress";
+XDTGPLProfileKey const XDTGPLProfileExecutions = @"XDTGPLProfileExecutions";
+XDTGPLProfileKey const XDTGPLProfileEntries = @"XDTGPLProfileEntries";
+XDTGPLProfileKey const XDTGPLProfileCycles = @"XDTGPLProfileCycles";
+XDTGPLProfileKey const XDTGPLProfilePercentage = @"XDTGPLProfilePercentage";
+
+
+#define XDTGPLMemorySize 0x10000
+#define XDTGPLVDPMemorySize 0x4000
+#define XDTGPLPadBase 0x8300
+
+/* Locations in the scratch pad, which are used by the GPL interpreter of the console */
+#define XDTGPLDataStackPointer 0x8372
+#define XDTGPLSubStackPointer 0x8373
+#define XDTGPLKeyCode 0x8375
+#define XDTGPLRandomNumber 0x8378
+#define XDTGPLStatus 0x837C
+#define XDTGPLScreenRow 0x837E
+#define XDTGPLScreenColumn 0x837F
+
+/* Bits of the GPL status byte */
+#define XDTGPLStatusHigh 0x80
+#define XDTGPLStatusGreater 0x40
+#define XDTGPLStatusCondition 0x20
+#define XDTGPLStatusCarry 0x10
+#define XDTGPLStatusOverflow 0x08
+
+#define XDTGPLMaxRepeatNesting 8
+
+
+typedef NS_ENUM(NSUInteger, XDTGPLOperandSpace) {
+    XDTGPLOperandSpaceCPU,
+    XDTGPLOperandSpaceVDP,
+    XDTGPLOperandSpaceGROM,
+    XDTGPLOperandSpaceVDPRegister,
+    XDTGPLOperandSpaceImmediate,
+};
+
+typedef struct {
+    XDTGPLOperandSpace space;
+    uint16_t address;
+    uint16_t value;     /* only used for immediate operands */
+} XDTGPLOperand;
+
+
+NS_ASSUME_NONNULL_BEGIN
+@interface XDTGPLInterpreter () {
+    uint8_t *_grom;
+    uint8_t *_vdp;
+    uint8_t *_cpu;
+    uint8_t _vdpRegisters[8];
+
+    unsigned long long *_executionCounts;
+    unsigned long long *_cycleCounts;
+    unsigned long long _instructionCost;
+
+    NSMutableIndexSet *_loadedAddresses;
+    NSMutableIndexSet *_breakpoints;
+    NSUInteger _imageAddress;
+    NSUInteger _callDepth;
+    uint32_t _randomSeed;
+}
+
+@property (readwrite) XDTGPLInterpreterState state;
+@property (readwrite) NSUInteger programCounter;
+@property (readwrite) unsigned long long cycles;
+@property (readwrite) unsigned long long instructions;
+@property (nullable, readwrite) NSString *stateDescription;
+
+- (BOOL)executeInstruction;
+
+@end
+NS_ASSUME_NONNULL_END
+
+
+@implementation XDTGPLInterpreter
+
++ (XDTGPLCycleCosts)defaultCycleCosts
+{
+    /*
+     The numbers are a rough approximation of the work the GPL interpreter in the console ROM does. They are not
+     cycle exact, but they preserve the relation between the cheap scratch pad and the expensive GROM / VDP access.
+     */
+    XDTGPLCycleCosts costs = {
+        .instruction = 60,
+        .gromFetch = 24,
+        .cpuAccess = 4,
+        .vdpAccess = 20,
+        .indirection = 30,
+        .multiply = 100,
+        .divide = 180,
+    };
+    return costs;
+}
+
+
++ (instancetype)interpreter
+{
+    XDTGPLInterpreter *retVal = [[XDTGPLInterpreter alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _grom = calloc(XDTGPLMemorySize, sizeof(uint8_t));
+    _vdp = calloc(XDTGPLVDPMemorySize, sizeof(uint8_t));
+    _cpu = calloc(XDTGPLMemorySize, sizeof(uint8_t));
+    _executionCounts = calloc(XDTGPLMemorySize, sizeof(unsigned long long));
+    _cycleCounts = calloc(XDTGPLMemorySize, sizeof(unsigned long long));
+    if (NULL == _grom || NULL == _vdp || NULL == _cpu || NULL == _executionCounts || NULL == _cycleCounts) {
+#if !__has_feature(objc_arc)
+        [self release];
+#endif
+        return nil;
+    }
+    _loadedAddresses = [NSMutableIndexSet new];
+    _breakpoints = [NSMutableIndexSet new];
+    _imageAddress = NSNotFound;
+    _cycleCosts = [XDTGPLInterpreter defaultCycleCosts];
+    [self reset];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    free(_grom);
+    free(_vdp);
+    free(_cpu);
+    free(_executionCounts);
+    free(_cycleCounts);
+#if !__has_feature(objc_arc)
+    [_loadedAddresses release];
+    [_breakpoints release];
+    [_labels release];
+    [_stateDescription release];
+
+    [super dealloc];
+#endif
+}
+
+
+- (void)reset
+{
+    memset(_vdp, 0, XDTGPLVDPMemorySize);
+    memset(_cpu, 0, XDTGPLMemorySize);
+    memset(_vdpRegisters, 0, sizeof(_vdpRegisters));
+    memset(_executionCounts, 0, XDTGPLMemorySize * sizeof(unsigned long long));
+    memset(_cycleCounts, 0, XDTGPLMemorySize * sizeof(unsigned long long));
+
+    /* Stacks grow upwards, the pointers are offsets into the scratch pad. */
+    _cpu[XDTGPLSubStackPointer] = 0x7E;
+    _cpu[XDTGPLDataStackPointer] = 0x9E;
+    _callDepth = 0;
+    _randomSeed = 0x1234;
+
+    self.programCounter = 0;
+    self.cycles = 0;
+    self.instructions = 0;
+    self.stateDescription = nil;
+    self.state = XDTGPLInterpreterStateReady;
+}
+
+
+#pragma mark - Loading Memory
+
+
+- (BOOL)loadByteCode:(NSArray<NSArray<id> *> *)byteCode error:(NSError **)error
+{
+    for (NSArray<id> *gromEntry in byteCode) {
+        /* Every element consists of the GROM address, the base (if any) and the data of the chunk */
+        id address = (3 == [gromEntry count])? [gromEntry objectAtIndex:0] : nil;
+        id data = (3 == [gromEntry count])? [gromEntry objectAtIndex:2] : nil;
+        if (![address isKindOfClass:[NSNumber class]] || ![data isKindOfClass:[NSData class]]) {
+            if (nil != error) {
+                NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+                NSDictionary *errorDict = @{
+                                            NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Invalid byte code", nil, myBundle, @"Description for an error object, discribing that the given byte code has an unexpected structure."),
+                                            NSLocalizedRecoverySuggestionErrorKey: NSLocalizedStringFromTableInBundle(@"The byte code must be the result of generating byte code from a GPL object code.", nil, myBundle, @"Recovery suggestion for an error object, which explains where valid byte code comes from.")
+                                            };
+                *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException userInfo:errorDict];
+            }
+            return NO;
+        }
+        if (![self loadImage:data atGROMAddress:[address unsignedIntegerValue] error:error]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+- (BOOL)loadImage:(NSData *)image atGROMAddress:(NSUInteger)gromAddress error:(NSError **)error
+{
+    NSUInteger length = [image length];
+    if (gromAddress >= XDTGPLMemorySize || length > XDTGPLMemorySize - gromAddress) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            NSDictionary *errorDict = @{
+                                        NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Invalid byte code", nil, myBundle, @"Description for an error object, discribing that the given byte code has an unexpected structure."),
+                                        NSLocalizedRecoverySuggestionErrorKey: [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"The code of %lu bytes at address >%04lX does not fit into the GROM.", nil, myBundle, @"Recovery suggestion for an error object, which explains that the code with the given length at the given address exceeds the GROM address space."), (unsigned long)length, (unsigned long)gromAddress]
+                                        };
+            *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException userInfo:errorDict];
+        }
+        return NO;
+    }
+
+    [image getBytes:_grom + gromAddress length:length];
+    if (0 < length) {
+        [_loadedAddresses addIndexesInRange:NSMakeRange(gromAddress, length)];
+    }
+    if (NSNotFound == _imageAddress || gromAddress < _imageAddress) {
+        _imageAddress = gromAddress;
+    }
+    return YES;
+}
+
+
+- (BOOL)loadSymbols:(NSData *)symbols
+{
+    NSString *symbolText = [[NSString alloc] initWithData:symbols encoding:NSUTF8StringEncoding];
+    if (nil == symbolText) {
+        return NO;
+    }
+#if !__has_feature(objc_arc)
+    [symbolText autorelease];
+#endif
+
+    /* Symbol files look like "NAME  EQU  >6010" or "NAME ..... >6010", the name is the first word, the value the last hex number */
+    NSRegularExpression *symbolRegex = [NSRegularExpression regularExpressionWithPattern:@"^\\s*([^\\s:]+):?\\s.*>([0-9A-Fa-f]{1,4})\\s*$"
+                                                                                 options:NSRegularExpressionAnchorsMatchLines error:nil];
+    NSMutableDictionary<NSString *, NSNumber *> *newLabels = [NSMutableDictionary dictionaryWithDictionary:(nil == _labels)? @{} : _labels];
+    [symbolRegex enumerateMatchesInString:symbolText options:0 range:NSMakeRange(0, [symbolText length])
+                               usingBlock:^(NSTextCheckingResult *result, NSMatchingFlags flags, BOOL *stop) {
+                                   NSString *name = [symbolText substringWithRange:[result rangeAtIndex:1]];
+                                   unsigned int value = 0;
+                                   [[NSScanner scannerWithString:[symbolText substringWithRange:[result rangeAtIndex:2]]] scanHexInt:&value];
+                                   /* only symbols pointing into the loaded code are labels, all others are constants */
+                                   if ([self->_loadedAddresses containsIndex:value]) {
+                                       [newLabels setObject:@(value) forKey:name];
+                                   }
+                               }];
+    self.labels = newLabels;
+    return YES;
+}
+
+
+- (uint8_t)gromByteAtAddress:(NSUInteger)address
+{
+    return _grom[address & 0xFFFF];
+}
+
+
+- (uint8_t)cpuByteAtAddress:(NSUInteger)address
+{
+    return _cpu[address & 0xFFFF];
+}
+
+
+- (uint8_t)vdpByteAtAddress:(NSUInteger)address
+{
+    return _vdp[address & 0x3FFF];
+}
+
+
+- (void)setCPUByte:(uint8_t)value atAddress:(NSUInteger)address
+{
+    _cpu[address & 0xFFFF] = value;
+}
+
+
+- (void)setVDPByte:(uint8_t)value atAddress:(NSUInteger)address
+{
+    _vdp[address & 0x3FFF] = value;
+}
+
+
+#pragma mark - Memory Access
+
+
+- (uint8_t)fetchByte
+{
+    uint8_t retVal = _grom[_programCounter & 0xFFFF];
+    _programCounter = (_programCounter + 1) & 0xFFFF;
+    _instructionCost += _cycleCosts.gromFetch;
+    return retVal;
+}
+
+
+- (uint16_t)fetchWord
+{
+    uint16_t high = [self fetchByte];
+    return (uint16_t)((high << 8) | [self fetchByte]);
+}
+
+
+- (uint16_t)cpuWordAtAddress:(uint16_t)address
+{
+    _instructionCost += 2 * _cycleCosts.cpuAccess;
+    return (uint16_t)((_cpu[address] << 8) | _cpu[(uint16_t)(address + 1)]);
+}
+
+
+- (void)setCPUWord:(uint16_t)value atAddress:(uint16_t)address
+{
+    _instructionCost += 2 * _cycleCosts.cpuAccess;
+    _cpu[address] = (uint8_t)(value >> 8);
+    _cpu[(uint16_t)(address + 1)] = (uint8_t)value;
+}
+
+
+/*
+ The General Address Specification (GAS) of GPL:
+ 0aaaaaaa                           CPU RAM >8300 + a
+ 1XVIaaaa aaaaaaaa [index]          12 bit offset, X = indexed, V = VDP RAM, I = indirect
+ 1XVI1111 aaaaaaaa aaaaaaaa [index] extended: 16 bit offset
+ The offset of CPU RAM addresses is relative to >8300, indirect pointers are always located in CPU RAM.
+ */
+- (XDTGPLOperand)decodeGeneralAddress
+{
+    XDTGPLOperand retVal = { XDTGPLOperandSpaceCPU, 0, 0 };
+    uint8_t gas = [self fetchByte];
+    if (0 == (gas & 0x80)) {
+        retVal.address = (uint16_t)(XDTGPLPadBase + gas);
+        return retVal;
+    }
+
+    BOOL indexed = 0 != (gas & 0x40);
+    BOOL vdp = 0 != (gas & 0x20);
+    BOOL indirect = 0 != (gas & 0x10);
+    uint16_t offset = (0x0F == (gas & 0x0F))? [self fetchWord] : (uint16_t)(((gas & 0x0F) << 8) | [self fetchByte]);
+    uint16_t address = 0;
+    if (indirect) {
+        _instructionCost += _cycleCosts.indirection;
+        address = [self cpuWordAtAddress:(uint16_t)(XDTGPLPadBase + offset)];
+    } else {
+        address = vdp? offset : (uint16_t)(XDTGPLPadBase + offset);
+    }
+    if (indexed) {
+        _instructionCost += _cycleCosts.indirection;
+        address += [self cpuWordAtAddress:(uint16_t)(XDTGPLPadBase + [self fetchByte])];
+    }
+    retVal.space = vdp? XDTGPLOperandSpaceVDP : XDTGPLOperandSpaceCPU;
+    retVal.address = address;
+    return retVal;
+}
+
+
+- (XDTGPLOperand)decodeImmediate:(BOOL)isWord
+{
+    XDTGPLOperand retVal = { XDTGPLOperandSpaceImmediate, 0, 0 };
+    retVal.value = isWord? [self fetchWord] : [self fetchByte];
+    return retVal;
+}
+
+
+- (uint8_t)readByteFromOperand:(XDTGPLOperand)operand atOffset:(uint16_t)offset
+{
+    uint16_t address = (uint16_t)(operand.address + offset);
+    switch (operand.space) {
+        case XDTGPLOperandSpaceCPU:
+            _instructionCost += _cycleCosts.cpuAccess;
+            return _cpu[address];
+        case XDTGPLOperandSpaceVDP:
+            _instructionCost += _cycleCosts.vdpAccess;
+            return _vdp[address & 0x3FFF];
+        case XDTGPLOperandSpaceGROM:
+            _instructionCost += _cycleCosts.gromFetch;
+            return _grom[address];
+        case XDTGPLOperandSpaceVDPRegister:
+            return _vdpRegisters[address & 0x07];
+        case XDTGPLOperandSpaceImmediate:
+            return (uint8_t)((0 == offset)? operand.value >> 8 : operand.value);
+    }
+    return 0;
+}
+
+
+- (void)writeByte:(uint8_t)value toOperand:(XDTGPLOperand)operand atOffset:(uint16_t)offset
+{
+    uint16_t address = (uint16_t)(operand.address + offset);
+    switch (operand.space) {
+        case XDTGPLOperandSpaceCPU:
+            _instructionCost += _cycleCosts.cpuAccess;
+            _cpu[address] = value;
+            break;
+        case XDTGPLOperandSpaceVDP:
+            _instructionCost += _cycleCosts.vdpAccess;
+            _vdp[address & 0x3FFF] = value;
+            break;
+        case XDTGPLOperandSpaceGROM:
+            /* GRAM is not modelled, writes into the GROM are ignored */
+            _instructionCost += _cycleCosts.gromFetch;
+            break;
+        case XDTGPLOperandSpaceVDPRegister:
+            _vdpRegisters[address & 0x07] = value;
+            break;
+        case XDTGPLOperandSpaceImmediate:
+            break;
+    }
+}
+
+
+- (uint16_t)readValueFromOperand:(XDTGPLOperand)operand isWord:(BOOL)isWord
+{
+    if (XDTGPLOperandSpaceImmediate == operand.space) {
+        return operand.value;
+    }
+    if (!isWord) {
+        return [self readByteFromOperand:operand atOffset:0];
+    }
+    uint16_t high = [self readByteFromOperand:operand atOffset:0];
+    return (uint16_t)((high << 8) | [self readByteFromOperand:operand atOffset:1]);
+}
+
+
+- (void)writeValue:(uint16_t)value toOperand:(XDTGPLOperand)operand isWord:(BOOL)isWord
+{
+    if (isWord) {
+        [self writeByte:(uint8_t)(value >> 8) toOperand:operand atOffset:0];
+        [self writeByte:(uint8_t)value toOperand:operand atOffset:1];
+    } else {
+        [self writeByte:(uint8_t)value toOperand:operand atOffset:0];
+    }
+}
+
+
+- (void)setCondition:(BOOL)condition
+{
+    if (condition) {
+        _cpu[XDTGPLStatus] |= XDTGPLStatusCondition;
+    } else {
+        _cpu[XDTGPLStatus] &= ~XDTGPLStatusCondition;
+    }
+}
+
+
+- (BOOL)condition
+{
+    return 0 != (_cpu[XDTGPLStatus] & XDTGPLStatusCondition);
+}
+
+
+- (void)setStatusForResult:(uint32_t)result isWord:(BOOL)isWord carry:(BOOL)carry overflow:(BOOL)overflow
+{
+    uint32_t mask = isWord? 0xFFFF : 0xFF;
+    uint32_t signBit = isWord? 0x8000 : 0x80;
+    uint8_t status = _cpu[XDTGPLStatus] & XDTGPLStatusCondition;
+    if (0 != (result & mask)) {
+        status |= XDTGPLStatusHigh;
+        if (0 == (result & signBit)) {
+            status |= XDTGPLStatusGreater;
+        }
+    }
+    if (carry) {
+        status |= XDTGPLStatusCarry;
+    }
+    if (overflow) {
+        status |= XDTGPLStatusOverflow;
+    }
+    _cpu[XDTGPLStatus] = status;
+}
+
+
+#pragma mark - Execution
+
+
+- (NSUInteger)entryAddressOfImage
+{
+    if (NSNotFound == _imageAddress || 0xAA != _grom[_imageAddress]) {
+        return NSNotFound;
+    }
+    /* standard GROM header: >AA, version, number of programs, reserved, power up list, program list, ... */
+    NSUInteger programList = (_grom[(_imageAddress + 6) & 0xFFFF] << 8) | _grom[(_imageAddress + 7) & 0xFFFF];
+    if (0 == programList) {
+        return NSNotFound;
+    }
+    return (_grom[(programList + 2) & 0xFFFF] << 8) | _grom[(programList + 3) & 0xFFFF];
+}
+
+
+- (void)addBreakpointAtAddress:(NSUInteger)address
+{
+    [_breakpoints addIndex:address & 0xFFFF];
+}
+
+
+- (void)removeAllBreakpoints
+{
+    [_breakpoints removeAllIndexes];
+}
+
+
+- (XDTGPLInterpreterState)runFromAddress:(NSUInteger)address maximumCycles:(unsigned long long)maxCycles
+{
+    self.programCounter = address & 0xFFFF;
+    _callDepth = 0;
+    self.state = XDTGPLInterpreterStateReady;
+    self.stateDescription = nil;
+    return [self continueWithMaximumCycles:maxCycles];
+}
+
+
+- (XDTGPLInterpreterState)continueWithMaximumCycles:(unsigned long long)maxCycles
+{
+    if (XDTGPLInterpreterStateExited == _state || XDTGPLInterpreterStateUnsupported == _state) {
+        return _state;
+    }
+
+    unsigned long long cycleLimit = _cycles + maxCycles;
+    BOOL isFirstInstruction = YES;
+    while (_cycles < cycleLimit) {
+        if (!isFirstInstruction && [_breakpoints containsIndex:_programCounter]) {
+            self.stateDescription = [NSString stringWithFormat:@"Breakpoint at G@>%04lX", (unsigned long)_programCounter];
+            self.state = XDTGPLInterpreterStateBreakpoint;
+            return _state;
+        }
+        isFirstInstruction = NO;
+
+        NSUInteger instructionAddress = _programCounter;
+        _instructionCost = _cycleCosts.instruction;
+        BOOL proceed = [self executeInstruction];
+        if (XDTGPLInterpreterStateUnsupported == _state) {
+            /* do not count the instruction which couldn't be executed */
+            self.programCounter = instructionAddress;
+            return _state;
+        }
+
+        _executionCounts[instructionAddress]++;
+        _cycleCounts[instructionAddress] += _instructionCost;
+        self.instructions = _instructions + 1;
+        self.cycles = _cycles + _instructionCost;
+        if (!proceed) {
+            return _state;
+        }
+    }
+    self.stateDescription = [NSString stringWithFormat:@"Cycle limit reached at G@>%04lX", (unsigned long)_programCounter];
+    self.state = XDTGPLInterpreterStateCycleLimit;
+    return _state;
+}
+
+
+- (BOOL)stopWithUnsupportedOpcode:(uint8_t)opcode atAddress:(NSUInteger)address
+{
+    self.stateDescription = [NSString stringWithFormat:@"Unsupported opcode >%02X at G@>%04lX", opcode, (unsigned long)address];
+    self.state = XDTGPLInterpreterStateUnsupported;
+    return NO;
+}
+
+
+- (BOOL)exitWithDescription:(NSString *)description
+{
+    self.stateDescription = description;
+    self.state = XDTGPLInterpreterStateExited;
+    return NO;
+}
+
+
+- (void)pushSubroutineAddress:(uint16_t)address
+{
+    uint8_t stackPointer = (uint8_t)(_cpu[XDTGPLSubStackPointer] + 2);
+    _cpu[XDTGPLSubStackPointer] = stackPointer;
+    [self setCPUWord:address atAddress:(uint16_t)(XDTGPLPadBase + stackPointer)];
+    _callDepth++;
+}
+
+
+- (uint16_t)popSubroutineAddress
+{
+    uint8_t stackPointer = _cpu[XDTGPLSubStackPointer];
+    uint16_t retVal = [self cpuWordAtAddress:(uint16_t)(XDTGPLPadBase + stackPointer)];
+    _cpu[XDTGPLSubStackPointer] = (uint8_t)(stackPointer - 2);
+    if (0 < _callDepth) {
+        _callDepth--;
+    }
+    return retVal;
+}
+
+
+- (BOOL)executeInstruction
+{
+    NSUInteger instructionAddress = _programCounter;
+    uint8_t opcode = [self fetchByte];
+
+    if (0xA0 <= opcode) {
+        return [self executeDoubleOperandInstruction:opcode];
+    }
+    if (0x80 <= opcode) {
+        return [self executeSingleOperandInstruction:opcode];
+    }
+    if (0x40 <= opcode) {
+        /* BR and BS: 13 bit address within the current 8K GROM */
+        uint16_t target = (uint16_t)((_programCounter & 0xE000) | ((opcode & 0x1F) << 8) | [self fetchByte]);
+        BOOL branchOnSet = 0x60 <= opcode;
+        if ([self condition] == branchOnSet) {
+            _programCounter = target;
+        }
+        [self setCondition:NO];
+        return YES;
+    }
+    if (0x20 <= opcode) {
+        return [self executeMoveInstruction:opcode];
+    }
+
+    switch (opcode) {
+        case 0x00:  /* RTN */
+        case 0x01:  /* RTNC */
+            if (0 == _callDepth) {
+                return [self exitWithDescription:[NSString stringWithFormat:@"Returned from top level at G@>%04lX", (unsigned long)instructionAddress]];
+            }
+            _programCounter = [self popSubroutineAddress];
+            if (0x00 == opcode) {
+                [self setCondition:NO];
+            }
+            return YES;
+        case 0x02: {    /* RAND */
+            uint8_t limit = [self fetchByte];
+            _randomSeed = _randomSeed * 1103515245 + 12345;
+            _cpu[XDTGPLRandomNumber] = (uint8_t)((_randomSeed >> 16) % ((uint32_t)limit + 1));
+            return YES;
+        }
+        case 0x03:  /* SCAN: no key is ever pressed */
+            _cpu[XDTGPLKeyCode] = 0xFF;
+            [self setCondition:NO];
+            return YES;
+        case 0x04:  /* BACK */
+            _vdpRegisters[7] = [self fetchByte];
+            return YES;
+        case 0x05:  /* B */
+            _programCounter = [self fetchWord];
+            return YES;
+        case 0x06: {    /* CALL */
+            uint16_t target = [self fetchWord];
+            [self pushSubroutineAddress:(uint16_t)_programCounter];
+            _programCounter = target;
+            return YES;
+        }
+        case 0x07: {    /* ALL */
+            uint8_t character = [self fetchByte];
+            memset(_vdp, character, 768);
+            _instructionCost += 768 * _cycleCosts.vdpAccess;
+            return YES;
+        }
+        case 0x08:  /* FMT */
+            return [self executeFormatInstruction];
+        case 0x09:  /* H */
+        case 0x0A:  /* GT */
+        case 0x0C:  /* CARRY */
+        case 0x0D: {    /* OVF */
+            static const uint8_t statusBits[] = { XDTGPLStatusHigh, XDTGPLStatusGreater, 0, XDTGPLStatusCarry, XDTGPLStatusOverflow };
+            [self setCondition:0 != (_cpu[XDTGPLStatus] & statusBits[opcode - 0x09])];
+            return YES;
+        }
+        case 0x0B:  /* EXIT */
+            return [self exitWithDescription:[NSString stringWithFormat:@"EXIT at G@>%04lX", (unsigned long)instructionAddress]];
+        case 0x0F:  /* XML: assembly language is not emulated */
+            [self fetchByte];
+            return YES;
+        default:
+            /* PARSE, CONT, EXEC, RTNB and RTGR belong to the BASIC interpreter */
+            return [self stopWithUnsupportedOpcode:opcode atAddress:instructionAddress];
+    }
+}
+
+
+- (BOOL)executeSingleOperandInstruction:(uint8_t)opcode
+{
+    NSUInteger instructionAddress = _programCounter - 1;
+    BOOL isWord = 0 != (opcode & 0x01);
+    uint32_t mask = isWord? 0xFFFF : 0xFF;
+    XDTGPLOperand destination = [self decodeGeneralAddress];
+
+    switch (opcode & 0xFE) {
+        case 0x80: {    /* ABS */
+            uint32_t value = [self readValueFromOperand:destination isWord:isWord];
+            uint32_t signBit = isWord? 0x8000 : 0x80;
+            if (0 != (value & signBit)) {
+                value = (~value + 1) & mask;
+                [self writeValue:(uint16_t)value toOperand:destination isWord:isWord];
+            }
+            [self setStatusForResult:value isWord:isWord carry:NO overflow:value == signBit];
+            return YES;
+        }
+        case 0x82: {    /* NEG */
+            uint32_t value = (~(uint32_t)[self readValueFromOperand:destination isWord:isWord] + 1) & mask;
+            [self writeValue:(uint16_t)value toOperand:destination isWord:isWord];
+            [self setStatusForResult:value isWord:isWord carry:NO overflow:NO];
+            return YES;
+        }
+        case 0x84: {    /* INV */
+            uint32_t value = ~(uint32_t)[self readValueFromOperand:destination isWord:isWord] & mask;
+            [self writeValue:(uint16_t)value toOperand:destination isWord:isWord];
+            [self setStatusForResult:value isWord:isWord carry:NO overflow:NO];
+            return YES;
+        }
+        case 0x86:  /* CLR */
+            [self writeValue:0 toOperand:destination isWord:isWord];
+            return YES;
+        case 0x88: {    /* FETCH: reads the byte following the CALL of the current subroutine */
+            uint8_t stackPointer = _cpu[XDTGPLSubStackPointer];
+            uint16_t returnAddress = [self cpuWordAtAddress:(uint16_t)(XDTGPLPadBase + stackPointer)];
+            _instructionCost += _cycleCosts.gromFetch;
+            [self writeValue:_grom[returnAddress] toOperand:destination isWord:NO];
+            [self setCPUWord:(uint16_t)(returnAddress + 1) atAddress:(uint16_t)(XDTGPLPadBase + stackPointer)];
+            return YES;
+        }
+        case 0x8A:  /* CASE: skip the given number of branch instructions */
+            _programCounter = (_programCounter + 2 * [self readValueFromOperand:destination isWord:isWord]) & 0xFFFF;
+            return YES;
+        case 0x8C: {    /* PUSH */
+            uint8_t stackPointer = (uint8_t)(_cpu[XDTGPLDataStackPointer] + 1);
+            _cpu[XDTGPLDataStackPointer] = stackPointer;
+            _cpu[XDTGPLPadBase + stackPointer] = (uint8_t)[self readValueFromOperand:destination isWord:NO];
+            return YES;
+        }
+        case 0x8E:  /* CZ */
+            [self setCondition:0 == [self readValueFromOperand:destination isWord:isWord]];
+            return YES;
+        case 0x90:  /* INC */
+        case 0x92:  /* DEC */
+        case 0x94:  /* INCT */
+        case 0x96: {    /* DECT */
+            static const int32_t deltas[] = { 1, -1, 2, -2 };
+            uint32_t value = [self readValueFromOperand:destination isWord:isWord];
+            uint32_t result = (uint32_t)((int32_t)value + deltas[((opcode & 0xFE) - 0x90) >> 1]);
+            [self writeValue:(uint16_t)(result & mask) toOperand:destination isWord:isWord];
+            [self setStatusForResult:result isWord:isWord carry:0 != (result & ~mask) overflow:NO];
+            return YES;
+        }
+        default:
+            return [self stopWithUnsupportedOpcode:opcode atAddress:instructionAddress];
+    }
+}
+
+
+- (BOOL)executeDoubleOperandInstruction:(uint8_t)opcode
+{
+    NSUInteger instructionAddress = _programCounter - 1;
+    BOOL isWord = 0 != (opcode & 0x01);
+    BOOL isImmediate = 0 != (opcode & 0x02);
+    uint32_t mask = isWord? 0xFFFF : 0xFF;
+    uint32_t signBit = isWord? 0x8000 : 0x80;
+
+    /* the destination comes first in the byte stream */
+    XDTGPLOperand destination = [self decodeGeneralAddress];
+    XDTGPLOperand source = isImmediate? [self decodeImmediate:isWord] : [self decodeGeneralAddress];
+    uint32_t src = [self readValueFromOperand:source isWord:isWord];
+
+    uint8_t operation = opcode & 0xFC;
+    if (0xBC == operation) {    /* ST does not read the destination */
+        [self writeValue:(uint16_t)src toOperand:destination isWord:isWord];
+        return YES;
+    }
+    uint32_t dst = [self readValueFromOperand:destination isWord:isWord];
+    int32_t signedSrc = (int32_t)((src ^ signBit) - signBit);
+    int32_t signedDst = (int32_t)((dst ^ signBit) - signBit);
+    uint32_t result = 0;
+
+    switch (operation) {
+        case 0xA0:  /* ADD */
+            result = dst + src;
+            [self setStatusForResult:result isWord:isWord carry:0 != (result & ~mask)
+                            overflow:0 != (~(dst ^ src) & (dst ^ result) & signBit)];
+            break;
+        case 0xA4:  /* SUB */
+            result = dst - src;
+            [self setStatusForResult:result isWord:isWord carry:dst >= src
+                            overflow:0 != ((dst ^ src) & (dst ^ result) & signBit)];
+            break;
+        case 0xA8: {    /* MUL: the result has the double width of the operands */
+            _instructionCost += _cycleCosts.multiply;
+            uint32_t product = dst * src;
+            if (isWord) {
+                [self writeValue:(uint16_t)(product >> 16) toOperand:destination isWord:YES];
+                XDTGPLOperand low = destination;
+                low.address += 2;
+                [self writeValue:(uint16_t)product toOperand:low isWord:YES];
+            } else {
+                [self writeValue:(uint16_t)product toOperand:destination isWord:YES];
+            }
+            return YES;
+        }
+        case 0xAC: {    /* DIV: dividend has the double width, quotient and remainder are stored in place */
+            _instructionCost += _cycleCosts.divide;
+            XDTGPLOperand remainderOperand = destination;
+            remainderOperand.address += isWord? 2 : 1;
+            uint32_t dividend = (dst << (isWord? 16 : 8)) | [self readValueFromOperand:remainderOperand isWord:isWord];
+            if (0 == src || (dividend / src) > mask) {
+                [self setStatusForResult:dst isWord:isWord carry:NO overflow:YES];
+                return YES;
+            }
+            [self writeValue:(uint16_t)(dividend / src) toOperand:destination isWord:isWord];
+            [self writeValue:(uint16_t)(dividend % src) toOperand:remainderOperand isWord:isWord];
+            return YES;
+        }
+        case 0xB0:  /* AND */
+            result = dst & src;
+            [self setStatusForResult:result isWord:isWord carry:NO overflow:NO];
+            break;
+        case 0xB4:  /* OR */
+            result = dst | src;
+            [self setStatusForResult:result isWord:isWord carry:NO overflow:NO];
+            break;
+        case 0xB8:  /* XOR */
+            result = dst ^ src;
+            [self setStatusForResult:result isWord:isWord carry:NO overflow:NO];
+            break;
+        case 0xC0:  /* EX */
+            [self writeValue:(uint16_t)dst toOperand:source isWord:isWord];
+            [self writeValue:(uint16_t)src toOperand:destination isWord:isWord];
+            return YES;
+        case 0xC4:  /* CH */
+            [self setCondition:dst > src];
+            return YES;
+        case 0xC8:  /* CHE */
+            [self setCondition:dst >= src];
+            return YES;
+        case 0xCC:  /* CGT */
+            [self setCondition:signedDst > signedSrc];
+            return YES;
+        case 0xD0:  /* CGE */
+            [self setCondition:signedDst >= signedSrc];
+            return YES;
+        case 0xD4:  /* CEQ */
+            [self setCondition:dst == src];
+            return YES;
+        case 0xD8:  /* CLOG */
+            [self setCondition:0 == (dst & src)];
+            return YES;
+        case 0xDC:  /* SRA */
+            result = (uint32_t)(signedDst >> (src & 0x1F));
+            break;
+        case 0xE0:  /* SLL */
+            result = dst << (src & 0x1F);
+            break;
+        case 0xE4:  /* SRL */
+            result = dst >> (src & 0x1F);
+            break;
+        case 0xE8: {    /* SRC */
+            uint32_t bits = isWord? 16 : 8;
+            uint32_t count = src % bits;
+            result = (dst >> count) | (dst << (bits - count));
+            break;
+        }
+        case 0xEC:  /* COINC: sprites are not emulated, there is never a coincidence */
+            [self setCondition:NO];
+            return YES;
+        case 0xF4:  /* I/O: sound, CRU and cassette are not emulated */
+            return YES;
+        case 0xF8:  /* SWGR: only one GROM base is emulated */
+            return YES;
+        default:
+            return [self stopWithUnsupportedOpcode:opcode atAddress:instructionAddress];
+    }
+
+    [self writeValue:(uint16_t)(result & mask) toOperand:destination isWord:isWord];
+    return YES;
+}
+
+
+/*
+ MOVE count, source, destination is encoded as 001GRVCN, followed by the count, the destination and the source.
+ N = 1: the count is an immediate word, otherwise it is a GAS
+ G = 0: the destination is a GROM address, R = 1: the destination is a VDP register, else the destination is a GAS
+ C = 1: the source is a GAS, otherwise it is a GROM address, which is indexed if V = 1
+ */
+- (BOOL)executeMoveInstruction:(uint8_t)opcode
+{
+    uint16_t count = (0 != (opcode & 0x01))? [self fetchWord] : [self readValueFromOperand:[self decodeGeneralAddress] isWord:YES];
+
+    XDTGPLOperand destination = { XDTGPLOperandSpaceGROM, 0, 0 };
+    if (0 == (opcode & 0x10)) {
+        destination.address = [self fetchWord];
+    } else if (0 != (opcode & 0x08)) {
+        destination.space = XDTGPLOperandSpaceVDPRegister;
+        destination.address = [self fetchByte];
+    } else {
+        destination = [self decodeGeneralAddress];
+    }
+
+    XDTGPLOperand source = { XDTGPLOperandSpaceGROM, 0, 0 };
+    if (0 != (opcode & 0x02)) {
+        source = [self decodeGeneralAddress];
+    } else {
+        source.address = [self fetchWord];
+        if (0 != (opcode & 0x04)) {
+            _instructionCost += _cycleCosts.indirection;
+            source.address += [self cpuWordAtAddress:(uint16_t)(XDTGPLPadBase + [self fetchByte])];
+        }
+    }
+
+    for (uint16_t offset = 0; offset < count; offset++) {
+        [self writeByte:[self readByteFromOperand:source atOffset:offset] toOperand:destination atOffset:offset];
+    }
+    return YES;
+}
+
+
+/*
+ FMT is a sub language for writing to the screen. The cursor is kept in the scratch pad at >837E (row) and >837F (column).
+ The FEND of a repetition is followed by the GROM address to loop back to, only the FEND of FMT itself stands alone.
+ */
+- (BOOL)executeFormatInstruction
+{
+    NSUInteger instructionAddress = _programCounter - 1;
+    uint8_t row = _cpu[XDTGPLScreenRow];
+    uint8_t column = _cpu[XDTGPLScreenColumn];
+    uint8_t bias = 0;
+    NSUInteger repeatCount[XDTGPLMaxRepeatNesting];
+    NSUInteger repeatDepth = 0;
+
+    while (YES) {
+        uint8_t subcode = [self fetchByte];
+        uint8_t count = (subcode & 0x1F) + 1;
+        switch (subcode & 0xE0) {
+            case 0x00:  /* HTEX */
+            case 0x20:  /* VTEX */
+            case 0x40:  /* HCHA */
+            case 0x60: {    /* VCHA */
+                BOOL vertical = 0 != (subcode & 0x20);
+                BOOL isCharacterRepeat = 0 != (subcode & 0x40);
+                uint8_t character = isCharacterRepeat? [self fetchByte] : 0;
+                for (uint8_t i = 0; i < count; i++) {
+                    if (!isCharacterRepeat) {
+                        character = [self fetchByte];
+                    }
+                    _vdp[((row % 24) * 32 + (column % 32)) & 0x3FFF] = (uint8_t)(character + bias);
+                    _instructionCost += _cycleCosts.vdpAccess;
+                    if (vertical) {
+                        row = (uint8_t)((row + 1) % 24);
+                    } else if (32 <= ++column) {
+                        column = 0;
+                        row = (uint8_t)((row + 1) % 24);
+                    }
+                }
+                break;
+            }
+            case 0x80:  /* COL+ */
+                column = (uint8_t)(column + count);
+                row = (uint8_t)((row + column / 32) % 24);
+                column %= 32;
+                break;
+            case 0xA0:  /* ROW+ */
+                row = (uint8_t)((row + count) % 24);
+                break;
+            case 0xC0:  /* RPT */
+                if (XDTGPLMaxRepeatNesting <= repeatDepth) {
+                    return [self stopWithUnsupportedOpcode:subcode atAddress:instructionAddress];
+                }
+                repeatCount[repeatDepth] = count;
+                repeatDepth++;
+                break;
+            default:
+                switch (subcode) {
+                    case 0xFB: {    /* FEND */
+                        if (0 == repeatDepth) {
+                            _cpu[XDTGPLScreenRow] = row;
+                            _cpu[XDTGPLScreenColumn] = column;
+                            return YES;
+                        }
+                        uint16_t repeatAddress = [self fetchWord];
+                        if (0 < --repeatCount[repeatDepth - 1]) {
+                            _programCounter = repeatAddress;
+                        } else {
+                            repeatDepth--;
+                        }
+                        break;
+                    }
+                    case 0xFC:  /* BIAS immediate */
+                        bias = [self fetchByte];
+                        break;
+                    case 0xFD:  /* BIAS from GAS */
+                        bias = (uint8_t)[self readValueFromOperand:[self decodeGeneralAddress] isWord:NO];
+                        break;
+                    case 0xFE:  /* ROW */
+                        row = [self fetchByte];
+                        break;
+                    case 0xFF:  /* COL */
+                        column = [self fetchByte];
+                        break;
+                    default:
+                        return [self stopWithUnsupportedOpcode:subcode atAddress:instructionAddress];
+                }
+                break;
+        }
+    }
+}
+
+
+#pragma mark - Profiling
+
+
+- (unsigned long long)executionCountAtAddress:(NSUInteger)address
+{
+    return _executionCounts[address & 0xFFFF];
+}
+
+
+- (unsigned long long)cycleCountAtAddress:(NSUInteger)address
+{
+    return _cycleCounts[address & 0xFFFF];
+}
+
+
+/* Returns the label names sorted by their addresses */
+- (NSArray<NSString *> *)sortedLabelNames
+{
+    NSDictionary<NSString *, NSNumber *> *labels = _labels;
+    return [[labels allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString *name1, NSString *name2) {
+        NSComparisonResult result = [[labels objectForKey:name1] compare:[labels objectForKey:name2]];
+        return (NSOrderedSame == result)? [name1 compare:name2] : result;
+    }];
+}
+
+
+- (NSArray<NSDictionary<XDTGPLProfileKey, id> *> *)hotSpots
+{
+    NSArray<NSString *> *labelNames = [self sortedLabelNames];
+    NSUInteger labelCount = [labelNames count];
+    NSUInteger *labelAddresses = malloc((labelCount + 1) * sizeof(NSUInteger));
+    for (NSUInteger i = 0; i < labelCount; i++) {
+        labelAddresses[i] = [[_labels objectForKey:[labelNames objectAtIndex:i]] unsignedIntegerValue];
+    }
+
+    /* Every executed address belongs to the section of the nearest label in front of it. */
+    NSMutableDictionary<NSString *, NSMutableDictionary<XDTGPLProfileKey, id> *> *sections = [NSMutableDictionary dictionary];
+    for (NSUInteger address = 0; address < XDTGPLMemorySize; address++) {
+        if (0 == _executionCounts[address]) {
+            continue;
+        }
+        NSUInteger low = 0, high = labelCount;
+        while (low < high) {
+            NSUInteger middle = (low + high) / 2;
+            if (labelAddresses[middle] <= address) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        NSString *sectionName = nil;
+        NSUInteger sectionAddress = 0;
+        if (0 < low) {
+            sectionName = [labelNames objectAtIndex:low - 1];
+            sectionAddress = labelAddresses[low - 1];
+        } else {
+            sectionAddress = address & 0xE000;
+            sectionName = [NSString stringWithFormat:@">%04lX", (unsigned long)sectionAddress];
+        }
+
+        NSMutableDictionary<XDTGPLProfileKey, id> *section = [sections objectForKey:sectionName];
+        if (nil == section) {
+            section = [NSMutableDictionary dictionaryWithDictionary:@{
+                                                                      XDTGPLProfileLabel: sectionName,
+                                                                      XDTGPLProfileAddress: @(sectionAddress),
+                                                                      XDTGPLProfileExecutions: @0ULL,
+                                                                      XDTGPLProfileEntries: @(_executionCounts[sectionAddress]),
+                                                                      XDTGPLProfileCycles: @0ULL
+                                                                      }];
+            [sections setObject:section forKey:sectionName];
+        }
+        [section setObject:@([[section objectForKey:XDTGPLProfileExecutions] unsignedLongLongValue] + _executionCounts[address]) forKey:XDTGPLProfileExecutions];
+        [section setObject:@([[section objectForKey:XDTGPLProfileCycles] unsignedLongLongValue] + _cycleCounts[address]) forKey:XDTGPLProfileCycles];
+    }
+    free(labelAddresses);
+
+    double totalCycles = (0 < _cycles)? (double)_cycles : 1.0;
+    NSMutableArray<NSDictionary<XDTGPLProfileKey, id> *> *retVal = [NSMutableArray arrayWithCapacity:[sections count]];
+    for (NSMutableDictionary<XDTGPLProfileKey, id> *section in [sections allValues]) {
+        [section setObject:@(100.0 * [[section objectForKey:XDTGPLProfileCycles] doubleValue] / totalCycles) forKey:XDTGPLProfilePercentage];
+        [retVal addObject:section];
+    }
+    [retVal sortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:XDTGPLProfileCycles ascending:NO],
+                                   [NSSortDescriptor sortDescriptorWithKey:XDTGPLProfileAddress ascending:YES]]];
+    return retVal;
+}
+
+
+- (NSDictionary<NSString *, NSNumber *> *)executionCountsPerLabel
+{
+    NSMutableDictionary<NSString *, NSNumber *> *retVal = [NSMutableDictionary dictionary];
+    for (NSDictionary<XDTGPLProfileKey, id> *hotSpot in [self hotSpots]) {
+        [retVal setObject:[hotSpot objectForKey:XDTGPLProfileExecutions] forKey:[hotSpot objectForKey:XDTGPLProfileLabel]];
+    }
+    return retVal;
+}
+
+
+- (NSString *)hotSpotReportWithLimit:(NSUInteger)maxLines
+{
+    NSMutableString *retVal = [NSMutableString stringWithFormat:@"%llu instructions, %llu cycles\n", _instructions, _cycles];
+    [retVal appendFormat:@"%12s %7s %12s %10s  %-5s  %s\n", "Cycles", "%", "Instructions", "Entries", "Addr", "Label"];
+    NSUInteger line = 0;
+    for (NSDictionary<XDTGPLProfileKey, id> *hotSpot in [self hotSpots]) {
+        if (0 < maxLines && maxLines <= line++) {
+            break;
+        }
+        [retVal appendFormat:@"%12llu %7.2f %12llu %10llu  >%04lX  %@\n",
+         [[hotSpot objectForKey:XDTGPLProfileCycles] unsignedLongLongValue],
+         [[hotSpot objectForKey:XDTGPLProfilePercentage] doubleValue],
+         [[hotSpot objectForKey:XDTGPLProfileExecutions] unsignedLongLongValue],
+         [[hotSpot objectForKey:XDTGPLProfileEntries] unsignedLongLongValue],
+         (unsigned long)[[hotSpot objectForKey:XDTGPLProfileAddress] unsignedIntegerValue],
+         [hotSpot objectForKey:XDTGPLProfileLabel]];
+    }
+    return retVal;
+}
+
+@end
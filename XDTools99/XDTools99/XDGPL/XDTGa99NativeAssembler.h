@@ -0,0 +1,68 @@
+//
+//  XDTGa99NativeAssembler.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The program of a native GPL assembling run: the code of all GROMs and the symbol table.
+
+ All source files which were read are kept with their modification date, so the Python assembler can assemble the
+ same sources again for outputs which are not generated natively.
+ */
+@interface XDTGa99NativeProgram : NSObject
+
+@property (readonly) NSDictionary<NSString *, NSNumber *> *symbols;
+@property (readonly) NSArray<NSURL *> *sourceFiles;     /* The assembled source file first, followed by all copied files */
+@property (readonly, getter=hasUnchangedSources) BOOL unchangedSources;
+@property (readonly) NSUInteger byteCount;              /* Memory of the GROM and its written bits */
+@property (readonly) NSUInteger gromAddress;            /* Start of the image with the GPL header */
+
+/* The byte code in the format of generate_byte_code() of xga99: address, base (always NSNull) and the data of each GROM */
+- (NSArray<NSArray<id> *> *)byteCode;
+/* The code with a GPL header in front like generate_image() of xga99, nil if the header does not fit in front of the code */
+- (nullable NSData *)imageWithName:(NSString *)name;
+
+@end
+
+
+/**
+ A native two-pass assembler for the common subset of xga99 in the syntaxes "xdt99" and "mizapf": all GPL
+ instructions except I/O, SWGR and COINC, FMT blocks, GROM, AORG, EQU, DATA, BYTE, TEXT, STRI, COPY and END.
+
+ Everything else makes the assembler give up with a reason instead of a program: macros, conditionals, local labels,
+ forward references in general addresses, branches into another GROM, operators beyond + - * / and parentheses, and
+ every error. The caller assembles such sources with xga99 then, which also generates the messages.
+ */
+@interface XDTGa99NativeAssembler : NSObject
+
++ (instancetype)nativeAssemblerWithIncludeURLs:(NSArray<NSURL *> *)includeURLs syntax:(nullable const char *)syntaxName gromAddress:(NSUInteger)gromAddress aorgAddress:(NSUInteger)aorgAddress;
+
+- (nullable XDTGa99NativeProgram *)assembleSourceFile:(NSURL *)srcFile unsupportedReason:(NSString * _Nullable * _Nullable)reason;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,1507 @@
+//
+//  XDTGa99NativeAssembler.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTGa99NativeAssembler.h"
+
+#include <ctype.h>
+
+
+#define XDTGa99NativeMemorySize 0x10000
+#define XDTGa99NativeGROMSize 0x2000
+#define XDTGa99NativeCopyDepth 16
+#define XDTGa99NativePadBase 0x8300
+
+
+typedef NS_ENUM(NSUInteger, XDTGa99NativeFormat) {
+    XDTGa99NativeFormatNone,            /* the opcode only */
+    XDTGa99NativeFormatByte,            /* an immediate byte */
+    XDTGa99NativeFormatAddress,         /* a GROM address word (B, CALL) */
+    XDTGa99NativeFormatBranch,          /* a 13 bit address within the GROM of the instruction (BR, BS) */
+    XDTGa99NativeFormatSingle,          /* a general address, the D variants work on words */
+    XDTGa99NativeFormatDouble,          /* source (general address or immediate value) and destination */
+    XDTGa99NativeFormatMove,            /* count, source and destination */
+    XDTGa99NativeFormatFormat,          /* FMT, sub instructions follow up to the matching FEND */
+};
+
+typedef NS_ENUM(NSUInteger, XDTGa99NativeFormatKind) {
+    XDTGa99NativeFormatKindText,        /* a string of up to 32 characters */
+    XDTGa99NativeFormatKindCharacter,   /* a count and a character */
+    XDTGa99NativeFormatKindSkip,        /* a count of columns or rows */
+    XDTGa99NativeFormatKindRepeat,      /* a count of repetitions up to the matching FEND */
+    XDTGa99NativeFormatKindEnd,         /* the end of a repetition, followed by the address of its body, or of FMT */
+    XDTGa99NativeFormatKindBias,        /* an immediate byte or a general address */
+    XDTGa99NativeFormatKindPosition,    /* an immediate row or column */
+};
+
+typedef NS_ENUM(NSUInteger, XDTGa99NativeEvaluation) {
+    XDTGa99NativeEvaluationDone,
+    XDTGa99NativeEvaluationUndefined,   /* a symbol is not defined (yet) */
+    XDTGa99NativeEvaluationUnsupported,
+};
+
+typedef struct {
+    const char *mnemonic;
+    uint8_t opcode;
+    XDTGa99NativeFormat format;
+} XDTGa99NativeInstruction;
+
+typedef struct {
+    const char *mnemonic;
+    uint8_t subcode;
+    XDTGa99NativeFormatKind kind;
+} XDTGa99NativeFormatInstruction;
+
+
+static const XDTGa99NativeInstruction XDTGa99NativeInstructions[] = {
+    {"RTN", 0x00, XDTGa99NativeFormatNone}, {"RTNC", 0x01, XDTGa99NativeFormatNone}, {"SCAN", 0x03, XDTGa99NativeFormatNone},
+    {"H", 0x09, XDTGa99NativeFormatNone}, {"GT", 0x0A, XDTGa99NativeFormatNone}, {"EXIT", 0x0B, XDTGa99NativeFormatNone},
+    {"CARRY", 0x0C, XDTGa99NativeFormatNone}, {"OVF", 0x0D, XDTGa99NativeFormatNone}, {"CONT", 0x10, XDTGa99NativeFormatNone},
+    {"EXEC", 0x11, XDTGa99NativeFormatNone}, {"RTNB", 0x12, XDTGa99NativeFormatNone}, {"RTGR", 0x13, XDTGa99NativeFormatNone},
+    {"RAND", 0x02, XDTGa99NativeFormatByte}, {"BACK", 0x04, XDTGa99NativeFormatByte}, {"ALL", 0x07, XDTGa99NativeFormatByte},
+    {"PARSE", 0x0E, XDTGa99NativeFormatByte}, {"XML", 0x0F, XDTGa99NativeFormatByte},
+    {"B", 0x05, XDTGa99NativeFormatAddress}, {"CALL", 0x06, XDTGa99NativeFormatAddress},
+    {"FMT", 0x08, XDTGa99NativeFormatFormat},
+    {"MOVE", 0x20, XDTGa99NativeFormatMove},
+    {"BR", 0x40, XDTGa99NativeFormatBranch}, {"BS", 0x60, XDTGa99NativeFormatBranch},
+    {"ABS", 0x80, XDTGa99NativeFormatSingle}, {"DABS", 0x81, XDTGa99NativeFormatSingle},
+    {"NEG", 0x82, XDTGa99NativeFormatSingle}, {"DNEG", 0x83, XDTGa99NativeFormatSingle},
+    {"INV", 0x84, XDTGa99NativeFormatSingle}, {"DINV", 0x85, XDTGa99NativeFormatSingle},
+    {"CLR", 0x86, XDTGa99NativeFormatSingle}, {"DCLR", 0x87, XDTGa99NativeFormatSingle},
+    {"FETCH", 0x88, XDTGa99NativeFormatSingle}, {"CASE", 0x8A, XDTGa99NativeFormatSingle},
+    {"DCASE", 0x8B, XDTGa99NativeFormatSingle}, {"PUSH", 0x8C, XDTGa99NativeFormatSingle},
+    {"CZ", 0x8E, XDTGa99NativeFormatSingle}, {"DCZ", 0x8F, XDTGa99NativeFormatSingle},
+    {"INC", 0x90, XDTGa99NativeFormatSingle}, {"DINC", 0x91, XDTGa99NativeFormatSingle},
+    {"DEC", 0x92, XDTGa99NativeFormatSingle}, {"DDEC", 0x93, XDTGa99NativeFormatSingle},
+    {"INCT", 0x94, XDTGa99NativeFormatSingle}, {"DINCT", 0x95, XDTGa99NativeFormatSingle},
+    {"DECT", 0x96, XDTGa99NativeFormatSingle}, {"DDECT", 0x97, XDTGa99NativeFormatSingle},
+    {"ADD", 0xA0, XDTGa99NativeFormatDouble}, {"DADD", 0xA1, XDTGa99NativeFormatDouble},
+    {"SUB", 0xA4, XDTGa99NativeFormatDouble}, {"DSUB", 0xA5, XDTGa99NativeFormatDouble},
+    {"MUL", 0xA8, XDTGa99NativeFormatDouble}, {"DMUL", 0xA9, XDTGa99NativeFormatDouble},
+    {"DIV", 0xAC, XDTGa99NativeFormatDouble}, {"DDIV", 0xAD, XDTGa99NativeFormatDouble},
+    {"AND", 0xB0, XDTGa99NativeFormatDouble}, {"DAND", 0xB1, XDTGa99NativeFormatDouble},
+    {"OR", 0xB4, XDTGa99NativeFormatDouble}, {"DOR", 0xB5, XDTGa99NativeFormatDouble},
+    {"XOR", 0xB8, XDTGa99NativeFormatDouble}, {"DXOR", 0xB9, XDTGa99NativeFormatDouble},
+    {"ST", 0xBC, XDTGa99NativeFormatDouble}, {"DST", 0xBD, XDTGa99NativeFormatDouble},
+    {"EX", 0xC0, XDTGa99NativeFormatDouble}, {"DEX", 0xC1, XDTGa99NativeFormatDouble},
+    {"CH", 0xC4, XDTGa99NativeFormatDouble}, {"DCH", 0xC5, XDTGa99NativeFormatDouble},
+    {"CHE", 0xC8, XDTGa99NativeFormatDouble}, {"DCHE", 0xC9, XDTGa99NativeFormatDouble},
+    {"CGT", 0xCC, XDTGa99NativeFormatDouble}, {"DCGT", 0xCD, XDTGa99NativeFormatDouble},
+    {"CGE", 0xD0, XDTGa99NativeFormatDouble}, {"DCGE", 0xD1, XDTGa99NativeFormatDouble},
+    {"CEQ", 0xD4, XDTGa99NativeFormatDouble}, {"DCEQ", 0xD5, XDTGa99NativeFormatDouble},
+    {"CLOG", 0xD8, XDTGa99NativeFormatDouble}, {"DCLOG", 0xD9, XDTGa99NativeFormatDouble},
+    {"SRA", 0xDC, XDTGa99NativeFormatDouble}, {"DSRA", 0xDD, XDTGa99NativeFormatDouble},
+    {"SLL", 0xE0, XDTGa99NativeFormatDouble}, {"DSLL", 0xE1, XDTGa99NativeFormatDouble},
+    {"SRL", 0xE4, XDTGa99NativeFormatDouble}, {"DSRL", 0xE5, XDTGa99NativeFormatDouble},
+    {"SRC", 0xE8, XDTGa99NativeFormatDouble}, {"DSRC", 0xE9, XDTGa99NativeFormatDouble},
+};
+
+/* The syntaxes differ in the names of the FMT sub instructions, the mizapf names are those of TIImageTool */
+static const XDTGa99NativeFormatInstruction XDTGa99NativeFormatInstructionsXDT99[] = {
+    {"HTEX", 0x00, XDTGa99NativeFormatKindText}, {"VTEX", 0x20, XDTGa99NativeFormatKindText},
+    {"HCHA", 0x40, XDTGa99NativeFormatKindCharacter}, {"VCHA", 0x60, XDTGa99NativeFormatKindCharacter},
+    {"COL+", 0x80, XDTGa99NativeFormatKindSkip}, {"ROW+", 0xA0, XDTGa99NativeFormatKindSkip},
+    {"RPTB", 0xC0, XDTGa99NativeFormatKindRepeat}, {"FEND", 0xFB, XDTGa99NativeFormatKindEnd},
+    {"BIAS", 0xFC, XDTGa99NativeFormatKindBias}, {"ROW", 0xFE, XDTGa99NativeFormatKindPosition},
+    {"COL", 0xFF, XDTGa99NativeFormatKindPosition}, {NULL, 0, 0},
+};
+
+static const XDTGa99NativeFormatInstruction XDTGa99NativeFormatInstructionsMizapf[] = {
+    {"HSTR", 0x00, XDTGa99NativeFormatKindText}, {"VSTR", 0x20, XDTGa99NativeFormatKindText},
+    {"HCHR", 0x40, XDTGa99NativeFormatKindCharacter}, {"VCHR", 0x60, XDTGa99NativeFormatKindCharacter},
+    {"COL+", 0x80, XDTGa99NativeFormatKindSkip}, {"ROW+", 0xA0, XDTGa99NativeFormatKindSkip},
+    {"FOR", 0xC0, XDTGa99NativeFormatKindRepeat}, {"FEND", 0xFB, XDTGa99NativeFormatKindEnd},
+    {"SCRO", 0xFC, XDTGa99NativeFormatKindBias}, {"ROW", 0xFE, XDTGa99NativeFormatKindPosition},
+    {"COL", 0xFF, XDTGa99NativeFormatKindPosition}, {NULL, 0, 0},
+};
+
+
+static const XDTGa99NativeInstruction *XDTGa99NativeInstructionNamed(const char *mnemonic)
+{
+    for (NSUInteger i = 0; i < sizeof(XDTGa99NativeInstructions) / sizeof(XDTGa99NativeInstructions[0]); i++) {
+        if (0 == strcmp(XDTGa99NativeInstructions[i].mnemonic, mnemonic)) {
+            return &XDTGa99NativeInstructions[i];
+        }
+    }
+    return NULL;
+}
+
+
+static const XDTGa99NativeFormatInstruction *XDTGa99NativeFormatInstructionNamed(const XDTGa99NativeFormatInstruction *instructions, const char *mnemonic)
+{
+    for (NSUInteger i = 0; NULL != instructions[i].mnemonic; i++) {
+        if (0 == strcmp(instructions[i].mnemonic, mnemonic)) {
+            return &instructions[i];
+        }
+    }
+    return NULL;
+}
+
+
+static BOOL XDTGa99NativeIsSymbolName(const char *name, NSUInteger length)
+{
+    if (0 == length || (!isalpha((unsigned char)name[0]) && '_' != name[0])) {
+        return NO;
+    }
+    for (NSUInteger i = 1; i < length; i++) {
+        if (!isalnum((unsigned char)name[i]) && '_' != name[i]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+/* General addresses start with @ or * for CPU RAM and with V@ or V* for VDP RAM, everything else is a value */
+static BOOL XDTGa99NativeIsGeneralAddress(NSString *operand)
+{
+    if ([operand hasPrefix:@"@"] || [operand hasPrefix:@"*"]) {
+        return YES;
+    }
+    return 2 <= [operand length] && 'V' == toupper([operand characterAtIndex:0]) &&
+           ('@' == [operand characterAtIndex:1] || '*' == [operand characterAtIndex:1]);
+}
+
+
+static BOOL XDTGa99NativeIsGROMAddress(NSString *operand)
+{
+    return 2 <= [operand length] && 'G' == toupper([operand characterAtIndex:0]) && '@' == [operand characterAtIndex:1];
+}
+
+
+static inline BOOL XDTGa99NativeIsWritten(const uint8_t *writtenBits, NSUInteger address)
+{
+    return 0 != (writtenBits[address >> 3] & (1 << (address & 7)));
+}
+
+
+#pragma mark - Private Classes
+
+
+/* A line with code or a directive, as it is collected in the first pass */
+@interface XDTGa99NativeStatement : NSObject
+
+@property (copy) NSString *mnemonic;
+@property (retain) NSArray<NSString *> *operands;
+@property (retain) NSURL *fileURL;
+@property NSUInteger lineNumber;
+@property uint32_t location;
+@property uint32_t length;
+@property (getter=isFormatInstruction) BOOL formatInstruction;
+@property (getter=isRepeatEnd) BOOL repeatEnd;
+@property uint32_t repeatAddress;   /* the address of the repeated sub instructions, if the statement ends them */
+
+@end
+
+
+@implementation XDTGa99NativeStatement
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_mnemonic release];
+    [_operands release];
+    [_fileURL release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface XDTGa99NativeProgram () {
+    NSData *_memory;        /* XDTGa99NativeMemorySize bytes of GROM */
+    NSData *_writtenBits;   /* one bit for each byte of the GROM, set if the byte is part of the code */
+    NSUInteger _gromAddress;
+    NSUInteger _entryAddress;
+    NSArray<NSDate *> *_modificationDates;
+}
+
+- (instancetype)initWithMemory:(NSData *)memory writtenBits:(NSData *)writtenBits gromAddress:(NSUInteger)gromAddress entryAddress:(NSUInteger)entryAddress symbols:(NSDictionary<NSString *, NSNumber *> *)symbols sourceFiles:(NSArray<NSURL *> *)sourceFiles;
+
++ (nullable NSDate *)modificationDateOfURL:(NSURL *)url;
+
+@end
+
+
+@interface XDTGa99NativeAssembler () {
+    NSArray<NSURL *> *_includeURLs;
+    const XDTGa99NativeFormatInstruction *_formatInstructions;
+    NSUInteger _gromAddress;
+    NSUInteger _aorgAddress;
+
+    /* State of the current run */
+    NSMutableDictionary<NSString *, NSNumber *> *_symbols;
+    NSMutableArray<NSArray *> *_pendingEquates;    /* label, expression and location of EQU with forward references */
+    NSMutableArray<XDTGa99NativeStatement *> *_statements;
+    NSMutableArray<NSURL *> *_sourceFiles;
+    NSMutableData *_memory;
+    NSMutableData *_writtenBits;
+    uint32_t _gromBase;
+    uint32_t _location;
+    NSString *_entryExpression;
+    BOOL _ended;
+    BOOL _isInFormat;
+    NSMutableArray<NSNumber *> *_repeatAddresses;  /* the addresses of the open repetitions within FMT */
+    NSString *_reason;
+    NSURL *_currentFile;
+    NSUInteger _currentLine;
+}
+
+- (instancetype)initWithIncludeURLs:(NSArray<NSURL *> *)includeURLs syntax:(nullable const char *)syntaxName gromAddress:(NSUInteger)gromAddress aorgAddress:(NSUInteger)aorgAddress;
+
+- (BOOL)giveUp:(NSString *)reason;
+
+- (BOOL)readFileAtURL:(NSURL *)fileURL depth:(NSUInteger)depth;
+- (nullable NSURL *)URLOfCopiedFile:(NSString *)name includingURL:(NSURL *)fileURL;
+- (BOOL)parseLine:(const char *)line depth:(NSUInteger)depth;
+- (BOOL)takesNoOperands:(NSString *)mnemonic;
+- (nullable NSArray<NSString *> *)operandsOfField:(NSString *)field;
+- (BOOL)defineLabel:(nullable NSString *)label value:(int64_t)value;
+- (BOOL)collectStatement:(NSString *)mnemonic operands:(NSArray<NSString *> *)operands label:(nullable NSString *)label depth:(NSUInteger)depth;
+- (BOOL)collectDirective:(NSString *)mnemonic operands:(NSArray<NSString *> *)operands label:(nullable NSString *)label depth:(NSUInteger)depth;
+- (BOOL)resolvePendingEquates;
+
+- (XDTGa99NativeEvaluation)evaluate:(NSString *)expression value:(int64_t *)value;
+- (XDTGa99NativeEvaluation)evaluateExpression:(const char **)position value:(int64_t *)value;
+- (XDTGa99NativeEvaluation)evaluateTerm:(const char **)position value:(int64_t *)value;
+
+- (BOOL)encodeStatement:(XDTGa99NativeStatement *)statement code:(NSMutableData *)code final:(BOOL)isFinal;
+- (BOOL)encodeFormatStatement:(XDTGa99NativeStatement *)statement code:(NSMutableData *)code final:(BOOL)isFinal;
+- (BOOL)encodeMoveOperands:(NSArray<NSString *> *)operands code:(NSMutableData *)code final:(BOOL)isFinal;
+- (BOOL)valueOf:(NSString *)expression minimum:(int64_t)minimum maximum:(int64_t)maximum final:(BOOL)isFinal value:(int64_t *)value;
+- (nullable NSString *)addressOfOperand:(NSString *)operand index:(NSString * _Nullable * _Nonnull)index;
+- (BOOL)generalAddress:(NSString *)operand code:(NSMutableData *)code;
+- (BOOL)indexOf:(NSString *)index code:(NSMutableData *)code;
+- (BOOL)string:(NSString *)operand maximumLength:(NSUInteger)maximumLength code:(NSMutableData *)code;
+- (BOOL)emitCode:(NSData *)code;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static void XDTGa99NativeAppendByte(NSMutableData *code, int64_t value)
+{
+    const uint8_t byte = value & 0xFF;
+    [code appendBytes:&byte length:1];
+}
+
+
+static void XDTGa99NativeAppendWord(NSMutableData *code, int64_t value)
+{
+    const uint8_t word[2] = {(value >> 8) & 0xFF, value & 0xFF};
+    [code appendBytes:word length:2];
+}
+
+
+#pragma mark - Implementation of class XDTGa99NativeProgram
+
+
+@implementation XDTGa99NativeProgram
+
+- (instancetype)initWithMemory:(NSData *)memory writtenBits:(NSData *)writtenBits gromAddress:(NSUInteger)gromAddress entryAddress:(NSUInteger)entryAddress symbols:(NSDictionary<NSString *, NSNumber *> *)symbols sourceFiles:(NSArray<NSURL *> *)sourceFiles
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _memory = [memory copy];
+    _writtenBits = [writtenBits copy];
+    _gromAddress = gromAddress;
+    _entryAddress = entryAddress;
+    _symbols = [symbols copy];
+    _sourceFiles = [sourceFiles copy];
+    NSMutableArray<NSDate *> *modificationDates = [NSMutableArray arrayWithCapacity:[sourceFiles count]];
+    for (NSURL *sourceFile in sourceFiles) {
+        NSDate *modificationDate = [XDTGa99NativeProgram modificationDateOfURL:sourceFile];
+        [modificationDates addObject:(nil == modificationDate)? [NSDate distantPast] : modificationDate];
+    }
+    _modificationDates = [modificationDates copy];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_memory release];
+    [_writtenBits release];
+    [_symbols release];
+    [_sourceFiles release];
+    [_modificationDates release];
+
+    [super dealloc];
+#endif
+}
+
+
++ (NSDate *)modificationDateOfURL:(NSURL *)url
+{
+    NSDate *retVal = nil;
+    [[url URLByResolvingSymlinksInPath] getResourceValue:&retVal forKey:NSURLContentModificationDateKey error:nil];
+    return retVal;
+}
+
+
+- (NSUInteger)gromAddress
+{
+    return _gromAddress;
+}
+
+
+- (NSUInteger)byteCount
+{
+    return [_memory length] + [_writtenBits length];
+}
+
+
+- (BOOL)hasUnchangedSources
+{
+    for (NSUInteger i = 0; i < [_sourceFiles count]; i++) {
+        NSDate *modificationDate = [XDTGa99NativeProgram modificationDateOfURL:[_sourceFiles objectAtIndex:i]];
+        if (nil == modificationDate || ![modificationDate isEqualToDate:[_modificationDates objectAtIndex:i]]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+#pragma mark - Generator Methods
+
+
+- (NSArray<NSArray<id> *> *)byteCode
+{
+    /* every GROM of 8K gets one entry from its first to its last byte of code */
+    const uint8_t *memory = [_memory bytes];
+    const uint8_t *writtenBits = [_writtenBits bytes];
+    NSMutableArray<NSArray<id> *> *retVal = [NSMutableArray array];
+    for (NSUInteger grom = 0; grom < XDTGa99NativeMemorySize; grom += XDTGa99NativeGROMSize) {
+        NSUInteger low = grom + XDTGa99NativeGROMSize, high = grom;
+        for (NSUInteger address = grom; address < grom + XDTGa99NativeGROMSize; address++) {
+            if (XDTGa99NativeIsWritten(writtenBits, address)) {
+                low = MIN(low, address);
+                high = address + 1;
+            }
+        }
+        if (low < high) {
+            [retVal addObject:@[[NSNumber numberWithUnsignedInteger:low], [NSNull null], [NSData dataWithBytes:memory + low length:high - low]]];
+        }
+    }
+    return retVal;
+}
+
+
+/*
+ The image starts at the GROM address with the standard header, the program list follows at offset >10:
+    >AA, version 1, one program, reserved, power up list, program list, DSR list, subprogram list, interrupt list
+    link to the next program (none), entry address, length of the name, name
+ */
+- (NSData *)imageWithName:(NSString *)name
+{
+    NSData *nameData = [name dataUsingEncoding:NSISOLatin1StringEncoding];
+    const NSUInteger headerLength = 0x10 + 5 + [nameData length];
+    const uint8_t *writtenBits = [_writtenBits bytes];
+    if (nil == nameData || 0xFF < [nameData length] || XDTGa99NativeMemorySize < _gromAddress + headerLength ||
+        !XDTGa99NativeIsWritten(writtenBits, _entryAddress)) {
+        return nil;
+    }
+    NSUInteger high = _gromAddress + headerLength;
+    for (NSUInteger address = 0; address < XDTGa99NativeMemorySize; address++) {
+        if (!XDTGa99NativeIsWritten(writtenBits, address)) {
+            continue;
+        }
+        if (address < _gromAddress + headerLength) {
+            /* the code overlaps the header, xga99 reports that */
+            return nil;
+        }
+        high = address + 1;
+    }
+
+    NSMutableData *retVal = [NSMutableData dataWithBytes:(const uint8_t *)[_memory bytes] + _gromAddress length:high - _gromAddress];
+    uint8_t *image = [retVal mutableBytes];
+    const NSUInteger programList = _gromAddress + 0x10;
+    const uint8_t header[8] = {0xAA, 0x01, 0x01, 0x00, 0x00, 0x00, (programList >> 8) & 0xFF, programList & 0xFF};
+    memset(image, 0, headerLength);
+    memcpy(image, header, sizeof(header));
+    image[0x12] = (_entryAddress >> 8) & 0xFF;
+    image[0x13] = _entryAddress & 0xFF;
+    image[0x14] = (uint8_t)[nameData length];
+    memcpy(image + 0x15, [nameData bytes], [nameData length]);
+    return retVal;
+}
+
+@end
+
+
+#pragma mark - Implementation of class XDTGa99NativeAssembler
+
+
+@implementation XDTGa99NativeAssembler
+
+#pragma mark Initializers
+
++ (instancetype)nativeAssemblerWithIncludeURLs:(NSArray<NSURL *> *)includeURLs syntax:(const char *)syntaxName gromAddress:(NSUInteger)gromAddress aorgAddress:(NSUInteger)aorgAddress
+{
+    XDTGa99NativeAssembler *retVal = [[XDTGa99NativeAssembler alloc] initWithIncludeURLs:includeURLs syntax:syntaxName gromAddress:gromAddress aorgAddress:aorgAddress];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithIncludeURLs:(NSArray<NSURL *> *)includeURLs syntax:(const char *)syntaxName gromAddress:(NSUInteger)gromAddress aorgAddress:(NSUInteger)aorgAddress
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _includeURLs = [includeURLs copy];
+    if (NULL != syntaxName && 0 == strcmp("xdt99", syntaxName)) {
+        _formatInstructions = XDTGa99NativeFormatInstructionsXDT99;
+    } else if (NULL != syntaxName && 0 == strcmp("mizapf", syntaxName)) {
+        _formatInstructions = XDTGa99NativeFormatInstructionsMizapf;
+    } else {
+        _formatInstructions = NULL;
+    }
+    _gromAddress = gromAddress;
+    _aorgAddress = aorgAddress;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_includeURLs release];
+    [_symbols release];
+    [_pendingEquates release];
+    [_statements release];
+    [_repeatAddresses release];
+    [_sourceFiles release];
+    [_memory release];
+    [_writtenBits release];
+    [_entryExpression release];
+    [_reason release];
+    [_currentFile release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Assembling
+
+
+- (XDTGa99NativeProgram *)assembleSourceFile:(NSURL *)srcFile unsupportedReason:(NSString **)reason
+{
+#if !__has_feature(objc_arc)
+    [_symbols release];
+    [_pendingEquates release];
+    [_statements release];
+    [_repeatAddresses release];
+    [_sourceFiles release];
+    [_memory release];
+    [_writtenBits release];
+    [_entryExpression release];
+    [_reason release];
+    [_currentFile release];
+#endif
+    _currentFile = nil;
+    _currentLine = 0;
+    _symbols = [[NSMutableDictionary alloc] init];
+    _pendingEquates = [[NSMutableArray alloc] init];
+    _statements = [[NSMutableArray alloc] init];
+    _repeatAddresses = [[NSMutableArray alloc] init];
+    _sourceFiles = [[NSMutableArray alloc] init];
+    _memory = [[NSMutableData alloc] initWithLength:XDTGa99NativeMemorySize];
+    _writtenBits = [[NSMutableData alloc] initWithLength:XDTGa99NativeMemorySize / 8];
+    _gromBase = (uint32_t)(_gromAddress & 0xFFFF);
+    _location = (uint32_t)((_gromAddress + _aorgAddress) & 0xFFFF);
+    _entryExpression = nil;
+    _ended = NO;
+    _isInFormat = NO;
+    _reason = nil;
+
+    /* first pass: reading all lines, collecting the statements with their length and defining the labels */
+    const uint32_t startLocation = _location;
+    BOOL isSupported = (NULL != _formatInstructions)? YES : [self giveUp:@"syntax not supported natively"];
+    isSupported = isSupported && [self readFileAtURL:srcFile depth:0] && [self resolvePendingEquates];
+    if (isSupported && _isInFormat) {
+        isSupported = [self giveUp:@"FMT without FEND"];
+    }
+    int64_t entry = startLocation;
+    if (isSupported && nil != _entryExpression) {
+        isSupported = [self valueOf:_entryExpression minimum:0 maximum:0xFFFF final:YES value:&entry];
+    }
+
+    /* second pass: encoding the statements, now with all symbols */
+    NSMutableData *code = [NSMutableData data];
+    for (XDTGa99NativeStatement *statement in _statements) {
+        if (!isSupported) {
+            break;
+        }
+        _location = statement.location;
+#if !__has_feature(objc_arc)
+        [statement.fileURL retain];
+        [_currentFile release];
+#endif
+        _currentFile = statement.fileURL;
+        _currentLine = statement.lineNumber;
+        [code setLength:0];
+        isSupported = [self encodeStatement:statement code:code final:YES];
+        if (isSupported && statement.length != [code length]) {
+            isSupported = [self giveUp:@"length differs between the passes"];
+        }
+        isSupported = isSupported && [self emitCode:code];
+    }
+
+    if (!isSupported) {
+        if (NULL != reason) {
+#if !__has_feature(objc_arc)
+            [[_reason retain] autorelease];
+#endif
+            *reason = _reason;
+        }
+        return nil;
+    }
+
+    XDTGa99NativeProgram *retVal = [[XDTGa99NativeProgram alloc] initWithMemory:_memory writtenBits:_writtenBits gromAddress:_gromAddress & 0xFFFF entryAddress:(NSUInteger)entry symbols:_symbols sourceFiles:_sourceFiles];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (BOOL)giveUp:(NSString *)reason
+{
+    if (nil == _reason) {
+        NSString *location = (nil == _currentFile)? @"" : [NSString stringWithFormat:@"%@:%lu: ", [_currentFile lastPathComponent], (unsigned long)_currentLine];
+        _reason = [[location stringByAppendingString:reason] copy];
+    }
+    return NO;
+}
+
+
+#pragma mark - First Pass
+
+
+- (BOOL)readFileAtURL:(NSURL *)fileURL depth:(NSUInteger)depth
+{
+    if (XDTGa99NativeCopyDepth <= depth) {
+        return [self giveUp:@"COPY nested too deep"];
+    }
+    NSData *content = [NSData dataWithContentsOfURL:fileURL];
+    if (nil == content) {
+        return [self giveUp:[NSString stringWithFormat:@"cannot read %@", [fileURL path]]];
+    }
+    [_sourceFiles addObject:fileURL];
+
+    /* xga99 reads the sources byte by byte, ISO Latin 1 keeps every byte as one character */
+    NSMutableData *line = [NSMutableData data];
+    const char *bytes = [content bytes];
+    const NSUInteger length = [content length];
+    NSURL *outerFile = _currentFile;
+    const NSUInteger outerLine = _currentLine;
+    _currentFile = [fileURL copy];
+    _currentLine = 0;
+    BOOL retVal = YES;
+    for (NSUInteger start = 0, end = 0; retVal && !_ended && start < length; start = end + 1) {
+        for (end = start; end < length && '\n' != bytes[end]; end++);
+        NSUInteger lineLength = end - start;
+        if (0 < lineLength && '\r' == bytes[start + lineLength - 1]) {
+            lineLength--;
+        }
+        if (NULL != memchr(bytes + start, '\0', lineLength)) {
+            retVal = [self giveUp:@"NUL character in the source"];
+            break;
+        }
+        [line setLength:0];
+        [line appendBytes:bytes + start length:lineLength];
+        [line appendBytes:"" length:1];
+        _currentLine++;
+        retVal = [self parseLine:[line bytes] depth:depth];
+    }
+#if !__has_feature(objc_arc)
+    [_currentFile release];
+#endif
+    _currentFile = outerFile;
+    _currentLine = outerLine;
+    return retVal;
+}
+
+
+- (NSURL *)URLOfCopiedFile:(NSString *)name includingURL:(NSURL *)fileURL
+{
+    NSMutableArray<NSURL *> *directories = [NSMutableArray arrayWithObject:[fileURL URLByDeletingLastPathComponent]];
+    [directories addObjectsFromArray:_includeURLs];
+    for (NSURL *directory in directories) {
+        NSURL *candidateURL = [directory URLByAppendingPathComponent:name];
+        if ([[NSFileManager defaultManager] fileExistsAtPath:[candidateURL path]]) {
+            return candidateURL;
+        }
+    }
+    return nil;
+}
+
+
+/*
+ Lines have the same fields as those of xas99: label (starting in the first column), mnemonic, operands and comment,
+ separated by white space. The operand field ends at the first blank outside of quotes. A comment which starts like
+ the continuation of an expression may be part of the operands for xga99, so the assembler gives up on it.
+ */
+- (BOOL)parseLine:(const char *)line depth:(NSUInteger)depth
+{
+    if ('\0' == line[0] || '*' == line[0] || ';' == line[0]) {
+        return YES;
+    }
+
+    const char *position = line;
+    NSString *label = nil;
+    if (!isspace((unsigned char)*position)) {
+        const char *start = position;
+        while ('\0' != *position && !isspace((unsigned char)*position)) {
+            position++;
+        }
+        if (!XDTGa99NativeIsSymbolName(start, position - start)) {
+            return [self giveUp:@"label with special characters"];
+        }
+        label = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+#if !__has_feature(objc_arc)
+        [label autorelease];
+#endif
+    }
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+    if ('\0' == *position || ';' == *position) {
+        return [self defineLabel:label value:_location];
+    }
+
+    const char *start = position;
+    while ('\0' != *position && !isspace((unsigned char)*position)) {
+        position++;
+    }
+    NSString *mnemonicField = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+    NSString *mnemonic = [mnemonicField uppercaseString];
+#if !__has_feature(objc_arc)
+    [mnemonicField release];
+#endif
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+
+    start = position;
+    char quote = '\0';
+    while ('\0' != *position && ('\0' != quote || (!isspace((unsigned char)*position) && ';' != *position))) {
+        if ('\0' == quote && ('\'' == *position || '"' == *position)) {
+            quote = *position;
+        } else if (quote == *position) {
+            quote = '\0';
+        }
+        position++;
+    }
+    if ('\0' != quote) {
+        return [self giveUp:@"unterminated quote"];
+    }
+    NSString *operandField = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+#if !__has_feature(objc_arc)
+    [operandField autorelease];
+#endif
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+    const BOOL hasContinuation = '\0' != *position && NULL != strchr("+-*/,()", *position);
+
+    /* instructions without operands take the rest of the line as comment */
+    NSArray<NSString *> *operands = @[];
+    if (![self takesNoOperands:mnemonic] && 0 < [operandField length]) {
+        if (hasContinuation) {
+            return [self giveUp:@"blanks in the operand field"];
+        }
+        operands = [self operandsOfField:operandField];
+        if (nil == operands) {
+            return [self giveUp:@"empty operand"];
+        }
+    }
+    return [self collectStatement:mnemonic operands:operands label:label depth:depth];
+}
+
+
+- (BOOL)takesNoOperands:(NSString *)mnemonic
+{
+    if (_isInFormat) {
+        const XDTGa99NativeFormatInstruction *formatInstruction = XDTGa99NativeFormatInstructionNamed(_formatInstructions, [mnemonic UTF8String]);
+        return NULL != formatInstruction && XDTGa99NativeFormatKindEnd == formatInstruction->kind;
+    }
+    const XDTGa99NativeInstruction *instruction = XDTGa99NativeInstructionNamed([mnemonic UTF8String]);
+    return NULL != instruction && (XDTGa99NativeFormatNone == instruction->format || XDTGa99NativeFormatFormat == instruction->format);
+}
+
+
+/* Splits the operand field at the commas outside of quotes and parentheses */
+- (NSArray<NSString *> *)operandsOfField:(NSString *)field
+{
+    NSMutableArray<NSString *> *retVal = [NSMutableArray array];
+    const char *text = [field cStringUsingEncoding:NSISOLatin1StringEncoding];
+    const char *start = text;
+    char quote = '\0';
+    NSInteger depth = 0;
+    for (const char *position = text; ; position++) {
+        if ('\0' != quote) {
+            if (quote == *position) {
+                quote = '\0';
+            }
+            continue;
+        }
+        if ('\'' == *position || '"' == *position) {
+            quote = *position;
+        } else if ('(' == *position) {
+            depth++;
+        } else if (')' == *position) {
+            depth--;
+        } else if ('\0' == *position || (',' == *position && 0 == depth)) {
+            if (position == start) {
+                return nil;
+            }
+            NSString *operand = [[NSString alloc] initWithBytes:start length:position - start encoding:NSISOLatin1StringEncoding];
+            [retVal addObject:operand];
+#if !__has_feature(objc_arc)
+            [operand release];
+#endif
+            if ('\0' == *position) {
+                break;
+            }
+            start = position + 1;
+        }
+    }
+    return retVal;
+}
+
+
+- (BOOL)defineLabel:(NSString *)label value:(int64_t)value
+{
+    if (nil == label) {
+        return YES;
+    }
+    if (nil != [_symbols objectForKey:label]) {
+        return [self giveUp:[NSString stringWithFormat:@"duplicate symbol %@", label]];
+    }
+    if (0 > value || 0xFFFF < value) {
+        return [self giveUp:[NSString stringWithFormat:@"value of %@ out of range", label]];
+    }
+    [_symbols setObject:[NSNumber numberWithLongLong:value] forKey:label];
+    return YES;
+}
+
+
+/*
+ The length of every statement is known in the first pass: general addresses must not refer to symbols which are
+ defined later, because their length depends on their value. All other values are encoded as 0 for now.
+ */
+- (BOOL)collectStatement:(NSString *)mnemonic operands:(NSArray<NSString *> *)operands label:(NSString *)label depth:(NSUInteger)depth
+{
+    const XDTGa99NativeFormatInstruction *formatInstruction = NULL;
+    if (_isInFormat) {
+        formatInstruction = XDTGa99NativeFormatInstructionNamed(_formatInstructions, [mnemonic UTF8String]);
+        if (NULL == formatInstruction) {
+            return [self giveUp:[NSString stringWithFormat:@"%@ in a FMT block", mnemonic]];
+        }
+    } else if (NULL == XDTGa99NativeInstructionNamed([mnemonic UTF8String]) && ![@"DATA" isEqualToString:mnemonic] &&
+               ![@"BYTE" isEqualToString:mnemonic] && ![@"TEXT" isEqualToString:mnemonic] && ![@"STRI" isEqualToString:mnemonic]) {
+        return [self collectDirective:mnemonic operands:operands label:label depth:depth];
+    }
+
+    if (![self defineLabel:label value:_location]) {
+        return NO;
+    }
+    XDTGa99NativeStatement *statement = [[XDTGa99NativeStatement alloc] init];
+#if !__has_feature(objc_arc)
+    [statement autorelease];
+#endif
+    statement.mnemonic = mnemonic;
+    statement.operands = operands;
+    statement.fileURL = _currentFile;
+    statement.lineNumber = _currentLine;
+    statement.location = _location;
+    statement.formatInstruction = _isInFormat;
+    if (NULL != formatInstruction && XDTGa99NativeFormatKindEnd == formatInstruction->kind && 0 < [_repeatAddresses count]) {
+        statement.repeatEnd = YES;
+        statement.repeatAddress = [[_repeatAddresses lastObject] unsignedIntValue];
+    }
+    NSMutableData *code = [NSMutableData data];
+    if (![self encodeStatement:statement code:code final:NO]) {
+        return NO;
+    }
+    statement.length = (uint32_t)[code length];
+    [_statements addObject:statement];
+    _location += statement.length;
+    if (XDTGa99NativeMemorySize < _location) {
+        return [self giveUp:@"location out of range"];
+    }
+
+    if (NULL == formatInstruction) {
+        const XDTGa99NativeInstruction *instruction = XDTGa99NativeInstructionNamed([mnemonic UTF8String]);
+        _isInFormat = NULL != instruction && XDTGa99NativeFormatFormat == instruction->format;
+        [_repeatAddresses removeAllObjects];
+    } else if (XDTGa99NativeFormatKindRepeat == formatInstruction->kind) {
+        [_repeatAddresses addObject:[NSNumber numberWithUnsignedInt:_location]];
+    } else if (XDTGa99NativeFormatKindEnd == formatInstruction->kind) {
+        if (statement.isRepeatEnd) {
+            [_repeatAddresses removeLastObject];
+        } else {
+            _isInFormat = NO;
+        }
+    }
+    return YES;
+}
+
+
+- (BOOL)collectDirective:(NSString *)mnemonic operands:(NSArray<NSString *> *)operands label:(NSString *)label depth:(NSUInteger)depth
+{
+    const NSUInteger operandCount = [operands count];
+    int64_t value;
+
+    if ([@"GROM" isEqualToString:mnemonic] || [@"AORG" isEqualToString:mnemonic]) {
+        /* GROM selects the GROM by its address, AORG sets the location within the current GROM */
+        const BOOL isGROM = [@"GROM" isEqualToString:mnemonic];
+        if (nil != label || 1 != operandCount || XDTGa99NativeEvaluationDone != [self evaluate:operands[0] value:&value] ||
+            0 > value || (isGROM && (0xFFFF < value || 0 != (value % XDTGa99NativeGROMSize))) || (!isGROM && XDTGa99NativeGROMSize <= value)) {
+            return [self giveUp:[NSString stringWithFormat:@"%@ with a label or an unknown address", mnemonic]];
+        }
+        if (isGROM) {
+            _gromBase = (uint32_t)value;
+            _location = _gromBase;
+        } else {
+            _location = _gromBase + (uint32_t)value;
+        }
+        return YES;
+    }
+    if ([@"EQU" isEqualToString:mnemonic]) {
+        if (nil == label || 1 != operandCount) {
+            return [self giveUp:@"EQU without a label"];
+        }
+        switch ([self evaluate:operands[0] value:&value]) {
+            case XDTGa99NativeEvaluationDone:
+                return [self defineLabel:label value:value];
+            case XDTGa99NativeEvaluationUndefined:
+                if (nil != [_symbols objectForKey:label]) {
+                    return [self giveUp:[NSString stringWithFormat:@"duplicate symbol %@", label]];
+                }
+                [_pendingEquates addObject:@[label, operands[0], [NSNumber numberWithUnsignedInt:_location]]];
+                return YES;
+            default:
+                return [self giveUp:@"unsupported expression"];
+        }
+    }
+    if ([@"END" isEqualToString:mnemonic]) {
+        if (nil != label || 1 < operandCount) {
+            return [self giveUp:@"END with a label"];
+        }
+        _entryExpression = [[operands firstObject] copy];
+        _ended = YES;
+        return YES;
+    }
+    if ([@"COPY" isEqualToString:mnemonic]) {
+        NSString *name = [operands firstObject];
+        if (nil != label || 1 != operandCount || 3 > [name length] || ![name hasPrefix:@"\""] || ![name hasSuffix:@"\""]) {
+            return [self giveUp:@"COPY other than a quoted file name"];
+        }
+        NSURL *copiedURL = [self URLOfCopiedFile:[name substringWithRange:NSMakeRange(1, [name length] - 2)] includingURL:_currentFile];
+        if (nil == copiedURL) {
+            return [self giveUp:[NSString stringWithFormat:@"copied file %@ not found", name]];
+        }
+        return [self readFileAtURL:copiedURL depth:depth + 1];
+    }
+    return [self giveUp:[NSString stringWithFormat:@"%@ is not supported natively", mnemonic]];
+}
+
+
+/* EQU may refer to symbols which are defined later, they are resolved as soon as all their symbols are known */
+- (BOOL)resolvePendingEquates
+{
+    const uint32_t savedLocation = _location;
+    BOOL isResolving = YES;
+    while (0 < [_pendingEquates count] && isResolving) {
+        isResolving = NO;
+        for (NSArray *equate in [NSArray arrayWithArray:_pendingEquates]) {
+            int64_t value;
+            _location = [[equate objectAtIndex:2] unsignedIntValue];
+            XDTGa99NativeEvaluation evaluation = [self evaluate:[equate objectAtIndex:1] value:&value];
+            if (XDTGa99NativeEvaluationUndefined == evaluation) {
+                continue;
+            }
+            if (XDTGa99NativeEvaluationDone != evaluation || ![self defineLabel:[equate objectAtIndex:0] value:value]) {
+                _location = savedLocation;
+                return [self giveUp:@"unsupported EQU"];
+            }
+            [_pendingEquates removeObject:equate];
+            isResolving = YES;
+        }
+    }
+    _location = savedLocation;
+    return (0 == [_pendingEquates count])? YES : [self giveUp:@"EQU of undefined symbols"];
+}
+
+
+#pragma mark - Expressions
+
+
+/*
+ Expressions are evaluated strictly from left to right like xga99 does, only parentheses change the order. Terms are
+ decimal numbers, hexadecimal numbers with ">", binary numbers with ":", characters in quotes, "$" and symbols.
+ */
+- (XDTGa99NativeEvaluation)evaluate:(NSString *)expression value:(int64_t *)value
+{
+    const char *text = [expression cStringUsingEncoding:NSISOLatin1StringEncoding];
+    if (NULL == text || '\0' == *text) {
+        return XDTGa99NativeEvaluationUnsupported;
+    }
+    const char *position = text;
+    XDTGa99NativeEvaluation retVal = [self evaluateExpression:&position value:value];
+    if ('\0' != *position) {
+        return XDTGa99NativeEvaluationUnsupported;
+    }
+    return retVal;
+}
+
+
+- (XDTGa99NativeEvaluation)evaluateExpression:(const char **)position value:(int64_t *)value
+{
+    XDTGa99NativeEvaluation retVal = [self evaluateTerm:position value:value];
+    while (XDTGa99NativeEvaluationUnsupported != retVal && '\0' != **position && ')' != **position) {
+        const char operator = **position;
+        if (NULL == strchr("+-*/", operator)) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+        (*position)++;
+        int64_t term;
+        XDTGa99NativeEvaluation evaluation = [self evaluateTerm:position value:&term];
+        if (XDTGa99NativeEvaluationDone != evaluation) {
+            retVal = (XDTGa99NativeEvaluationUnsupported == evaluation)? evaluation : XDTGa99NativeEvaluationUndefined;
+            continue;
+        }
+        if (XDTGa99NativeEvaluationUndefined == retVal) {
+            continue;
+        }
+        switch (operator) {
+            case '+':
+                *value += term;
+                break;
+            case '-':
+                *value -= term;
+                break;
+            case '*':
+                *value *= term;
+                break;
+            default:
+                /* Python rounds divisions of negative numbers down, and values above 16 bits may have been cut before */
+                if (0 >= term || 0 > *value || 0xFFFF < *value) {
+                    return XDTGa99NativeEvaluationUnsupported;
+                }
+                *value /= term;
+                break;
+        }
+        if (0x7FFFFFFF < llabs(*value)) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+    }
+    return retVal;
+}
+
+
+- (XDTGa99NativeEvaluation)evaluateTerm:(const char **)position value:(int64_t *)value
+{
+    const char *text = *position;
+    *value = 0;
+
+    if ('-' == *text || '+' == *text) {
+        (*position)++;
+        XDTGa99NativeEvaluation retVal = [self evaluateTerm:position value:value];
+        if ('-' == *text) {
+            *value = -*value;
+        }
+        return retVal;
+    }
+    if ('(' == *text) {
+        (*position)++;
+        XDTGa99NativeEvaluation retVal = [self evaluateExpression:position value:value];
+        if (')' != **position) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+        (*position)++;
+        return retVal;
+    }
+    if ('>' == *text || ':' == *text || isdigit((unsigned char)*text)) {
+        const int base = ('>' == *text)? 16 : ((':' == *text)? 2 : 10);
+        const char *digits = isdigit((unsigned char)*text)? text : text + 1;
+        const char *end = digits;
+        while (isalnum((unsigned char)*end)) {
+            end++;
+        }
+        if (end == digits || 8 < end - digits) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+        char *parsedEnd = NULL;
+        char buffer[9] = {0};
+        memcpy(buffer, digits, end - digits);
+        *value = strtol(buffer, &parsedEnd, base);
+        if ('\0' != *parsedEnd) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+        *position = end;
+        return XDTGa99NativeEvaluationDone;
+    }
+    if ('\'' == *text) {
+        const char *end = strchr(text + 1, '\'');
+        if (NULL == end || '\'' == end[1] || end == text + 1 || 2 < end - text - 1) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+        for (const char *c = text + 1; c < end; c++) {
+            *value = (*value << 8) | (unsigned char)*c;
+        }
+        *position = end + 1;
+        return XDTGa99NativeEvaluationDone;
+    }
+    if ('$' == *text) {
+        if (isalnum((unsigned char)text[1]) || '_' == text[1]) {
+            return XDTGa99NativeEvaluationUnsupported;
+        }
+        *value = _location;
+        *position = text + 1;
+        return XDTGa99NativeEvaluationDone;
+    }
+    if (isalpha((unsigned char)*text) || '_' == *text) {
+        const char *end = text;
+        while (isalnum((unsigned char)*end) || '_' == *end) {
+            end++;
+        }
+        NSString *name = [[NSString alloc] initWithBytes:text length:end - text encoding:NSISOLatin1StringEncoding];
+#if !__has_feature(objc_arc)
+        [name autorelease];
+#endif
+        *position = end;
+        NSNumber *symbolValue = [_symbols objectForKey:name];
+        if (nil == symbolValue) {
+            return XDTGa99NativeEvaluationUndefined;
+        }
+        *value = [symbolValue longLongValue];
+        return XDTGa99NativeEvaluationDone;
+    }
+    return XDTGa99NativeEvaluationUnsupported;
+}
+
+
+#pragma mark - Encoding
+
+
+/* Encodes a statement at the current location, the first pass only needs the length of the code */
+- (BOOL)encodeStatement:(XDTGa99NativeStatement *)statement code:(NSMutableData *)code final:(BOOL)isFinal
+{
+    if (statement.isFormatInstruction) {
+        return [self encodeFormatStatement:statement code:code final:isFinal];
+    }
+
+    NSString *mnemonic = statement.mnemonic;
+    NSArray<NSString *> *operands = statement.operands;
+    const NSUInteger operandCount = [operands count];
+    int64_t value;
+
+    if ([@"DATA" isEqualToString:mnemonic] || [@"BYTE" isEqualToString:mnemonic]) {
+        const BOOL isWord = [@"DATA" isEqualToString:mnemonic];
+        if (0 == operandCount) {
+            return [self giveUp:[NSString stringWithFormat:@"%@ without values", mnemonic]];
+        }
+        for (NSString *operand in operands) {
+            if (![self valueOf:operand minimum:isWord? -0x8000 : -0x80 maximum:isWord? 0xFFFF : 0xFF final:isFinal value:&value]) {
+                return NO;
+            }
+            if (isWord) {
+                XDTGa99NativeAppendWord(code, value);
+            } else {
+                XDTGa99NativeAppendByte(code, value);
+            }
+        }
+        return YES;
+    }
+    if ([@"TEXT" isEqualToString:mnemonic] || [@"STRI" isEqualToString:mnemonic]) {
+        if (1 != operandCount) {
+            return [self giveUp:[NSString stringWithFormat:@"%@ other than a single simple string", mnemonic]];
+        }
+        if ([@"STRI" isEqualToString:mnemonic]) {
+            /* the string is preceded by its length */
+            XDTGa99NativeAppendByte(code, [operands[0] length] - 2);
+        }
+        return [self string:operands[0] maximumLength:0xFF code:code];
+    }
+
+    const XDTGa99NativeInstruction *instruction = XDTGa99NativeInstructionNamed([mnemonic UTF8String]);
+    static const NSUInteger operandCounts[] = {0, 1, 1, 1, 1, 2, 3, 0};
+    if (operandCounts[instruction->format] != operandCount) {
+        return [self giveUp:[NSString stringWithFormat:@"wrong number of operands for %@", mnemonic]];
+    }
+    switch (instruction->format) {
+        case XDTGa99NativeFormatNone:
+        case XDTGa99NativeFormatFormat:
+            XDTGa99NativeAppendByte(code, instruction->opcode);
+            return YES;
+        case XDTGa99NativeFormatByte:
+            if (![self valueOf:operands[0] minimum:-0x80 maximum:0xFF final:isFinal value:&value]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->opcode);
+            XDTGa99NativeAppendByte(code, value);
+            return YES;
+        case XDTGa99NativeFormatAddress:
+            if (![self valueOf:operands[0] minimum:0 maximum:0xFFFF final:isFinal value:&value]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->opcode);
+            XDTGa99NativeAppendWord(code, value);
+            return YES;
+        case XDTGa99NativeFormatBranch:
+            if (![self valueOf:operands[0] minimum:0 maximum:0xFFFF final:isFinal value:&value]) {
+                return NO;
+            }
+            if (isFinal && (value & 0xE000) != ((_location + 2) & 0xE000)) {
+                return [self giveUp:@"branch into another GROM"];
+            }
+            XDTGa99NativeAppendByte(code, instruction->opcode | ((value >> 8) & 0x1F));
+            XDTGa99NativeAppendByte(code, value);
+            return YES;
+        case XDTGa99NativeFormatSingle:
+            if (!XDTGa99NativeIsGeneralAddress(operands[0])) {
+                return [self giveUp:[NSString stringWithFormat:@"operand of %@ is not a general address", mnemonic]];
+            }
+            XDTGa99NativeAppendByte(code, instruction->opcode);
+            return [self generalAddress:operands[0] code:code];
+        case XDTGa99NativeFormatDouble: {
+            /* the source comes first in the source code, but the destination first in the byte code */
+            const BOOL isWord = 0 != (instruction->opcode & 0x01);
+            const BOOL isImmediate = !XDTGa99NativeIsGeneralAddress(operands[0]);
+            if (!XDTGa99NativeIsGeneralAddress(operands[1]) || (isImmediate && 0xC0 == (instruction->opcode & 0xFE))) {
+                return [self giveUp:[NSString stringWithFormat:@"operands of %@ are not supported", mnemonic]];
+            }
+            XDTGa99NativeAppendByte(code, instruction->opcode | (isImmediate? 0x02 : 0x00));
+            if (![self generalAddress:operands[1] code:code]) {
+                return NO;
+            }
+            if (!isImmediate) {
+                return [self generalAddress:operands[0] code:code];
+            }
+            if (![self valueOf:operands[0] minimum:isWord? -0x8000 : -0x80 maximum:isWord? 0xFFFF : 0xFF final:isFinal value:&value]) {
+                return NO;
+            }
+            if (isWord) {
+                XDTGa99NativeAppendWord(code, value);
+            } else {
+                XDTGa99NativeAppendByte(code, value);
+            }
+            return YES;
+        }
+        case XDTGa99NativeFormatMove:
+            return [self encodeMoveOperands:operands code:code final:isFinal];
+    }
+    return NO;
+}
+
+
+- (BOOL)encodeFormatStatement:(XDTGa99NativeStatement *)statement code:(NSMutableData *)code final:(BOOL)isFinal
+{
+    NSString *mnemonic = statement.mnemonic;
+    NSArray<NSString *> *operands = statement.operands;
+    const XDTGa99NativeFormatInstruction *instruction = XDTGa99NativeFormatInstructionNamed(_formatInstructions, [mnemonic UTF8String]);
+    static const NSUInteger operandCounts[] = {1, 2, 1, 1, 0, 1, 1};
+    if (operandCounts[instruction->kind] != [operands count]) {
+        return [self giveUp:[NSString stringWithFormat:@"wrong number of operands for %@", mnemonic]];
+    }
+    int64_t value;
+
+    switch (instruction->kind) {
+        case XDTGa99NativeFormatKindText: {
+            /* the sub instruction holds the length of the text, which follows */
+            NSMutableData *text = [NSMutableData data];
+            if (![self string:operands[0] maximumLength:32 code:text]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->subcode | ([text length] - 1));
+            [code appendData:text];
+            return YES;
+        }
+        case XDTGa99NativeFormatKindCharacter: {
+            int64_t count;
+            if (![self valueOf:operands[0] minimum:1 maximum:32 final:isFinal value:&count] ||
+                ![self valueOf:operands[1] minimum:-0x80 maximum:0xFF final:isFinal value:&value]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->subcode | ((0 < count)? count - 1 : 0));
+            XDTGa99NativeAppendByte(code, value);
+            return YES;
+        }
+        case XDTGa99NativeFormatKindSkip:
+        case XDTGa99NativeFormatKindRepeat:
+            if (![self valueOf:operands[0] minimum:1 maximum:32 final:isFinal value:&value]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->subcode | ((0 < value)? value - 1 : 0));
+            return YES;
+        case XDTGa99NativeFormatKindEnd:
+            /* like xga99, the end of a repetition holds the GROM address to loop back to */
+            XDTGa99NativeAppendByte(code, instruction->subcode);
+            if (statement.isRepeatEnd) {
+                XDTGa99NativeAppendByte(code, statement.repeatAddress >> 8);
+                XDTGa99NativeAppendByte(code, statement.repeatAddress);
+            }
+            return YES;
+        case XDTGa99NativeFormatKindBias:
+            /* the bias is either immediate or read from a general address with the next sub code */
+            if (XDTGa99NativeIsGeneralAddress(operands[0])) {
+                XDTGa99NativeAppendByte(code, instruction->subcode + 1);
+                return [self generalAddress:operands[0] code:code];
+            }
+            if (![self valueOf:operands[0] minimum:-0x80 maximum:0xFF final:isFinal value:&value]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->subcode);
+            XDTGa99NativeAppendByte(code, value);
+            return YES;
+        case XDTGa99NativeFormatKindPosition:
+            if (![self valueOf:operands[0] minimum:0 maximum:0xFF final:isFinal value:&value]) {
+                return NO;
+            }
+            XDTGa99NativeAppendByte(code, instruction->subcode);
+            XDTGa99NativeAppendByte(code, value);
+            return YES;
+    }
+    return NO;
+}
+
+
+/*
+ MOVE count,source,destination is encoded as 001GRVCN, followed by the count, the destination and the source:
+ N = 1: the count is an immediate word, otherwise it is a general address
+ G = 0: the destination is a GROM address (G@), R = 1: the destination is a VDP register (#), else a general address
+ C = 1: the source is a general address, otherwise it is a GROM address, which is indexed if V = 1
+ */
+- (BOOL)encodeMoveOperands:(NSArray<NSString *> *)operands code:(NSMutableData *)code final:(BOOL)isFinal
+{
+    NSString *count = operands[0];
+    NSString *source = operands[1];
+    NSString *destination = operands[2];
+    NSString *sourceIndex = nil;
+    NSString *destinationIndex = nil;
+    NSString *sourceAddress = XDTGa99NativeIsGROMAddress(source)? [self addressOfOperand:[source substringFromIndex:2] index:&sourceIndex] : nil;
+    NSString *destinationAddress = XDTGa99NativeIsGROMAddress(destination)? [self addressOfOperand:[destination substringFromIndex:2] index:&destinationIndex] : nil;
+    const BOOL isRegisterDestination = [destination hasPrefix:@"#"];
+    if ((nil == sourceAddress && !XDTGa99NativeIsGeneralAddress(source)) || nil != destinationIndex ||
+        (nil == destinationAddress && !isRegisterDestination && !XDTGa99NativeIsGeneralAddress(destination))) {
+        return [self giveUp:@"operands of MOVE are not supported"];
+    }
+
+    uint8_t opcode = 0x20;
+    opcode |= XDTGa99NativeIsGeneralAddress(count)? 0x00 : 0x01;
+    opcode |= (nil != destinationAddress)? 0x00 : (isRegisterDestination? 0x18 : 0x10);
+    opcode |= (nil != sourceAddress)? ((nil != sourceIndex)? 0x04 : 0x00) : 0x02;
+    XDTGa99NativeAppendByte(code, opcode);
+
+    int64_t value;
+    if (0 != (opcode & 0x01)) {
+        if (![self valueOf:count minimum:0 maximum:0xFFFF final:isFinal value:&value]) {
+            return NO;
+        }
+        XDTGa99NativeAppendWord(code, value);
+    } else if (![self generalAddress:count code:code]) {
+        return NO;
+    }
+
+    if (nil != destinationAddress) {
+        if (![self valueOf:destinationAddress minimum:0 maximum:0xFFFF final:isFinal value:&value]) {
+            return NO;
+        }
+        XDTGa99NativeAppendWord(code, value);
+    } else if (isRegisterDestination) {
+        if (![self valueOf:[destination substringFromIndex:1] minimum:0 maximum:7 final:isFinal value:&value]) {
+            return NO;
+        }
+        XDTGa99NativeAppendByte(code, value);
+    } else if (![self generalAddress:destination code:code]) {
+        return NO;
+    }
+
+    if (nil == sourceAddress) {
+        return [self generalAddress:source code:code];
+    }
+    if (![self valueOf:sourceAddress minimum:0 maximum:0xFFFF final:isFinal value:&value]) {
+        return NO;
+    }
+    XDTGa99NativeAppendWord(code, value);
+    return (nil == sourceIndex)? YES : [self indexOf:sourceIndex code:code];
+}
+
+
+/* A value of the first pass may refer to symbols which are defined later, the second pass needs all symbols */
+- (BOOL)valueOf:(NSString *)expression minimum:(int64_t)minimum maximum:(int64_t)maximum final:(BOOL)isFinal value:(int64_t *)value
+{
+    switch ([self evaluate:expression value:value]) {
+        case XDTGa99NativeEvaluationDone:
+            if (minimum > *value || maximum < *value) {
+                return [self giveUp:[NSString stringWithFormat:@"%@ out of range", expression]];
+            }
+            return YES;
+        case XDTGa99NativeEvaluationUndefined:
+            if (!isFinal) {
+                *value = 0;
+                return YES;
+            }
+            return [self giveUp:[NSString stringWithFormat:@"undefined symbol in %@", expression]];
+        default:
+            return [self giveUp:[NSString stringWithFormat:@"unsupported expression %@", expression]];
+    }
+}
+
+
+/* Splits "address(@index)" into the address and the index, "(A+B)" has no index */
+- (NSString *)addressOfOperand:(NSString *)operand index:(NSString **)index
+{
+    *index = nil;
+    if (![operand hasSuffix:@")"]) {
+        return operand;
+    }
+    NSInteger depth = 0;
+    NSUInteger position = [operand length];
+    while (0 < position) {
+        unichar c = [operand characterAtIndex:--position];
+        if (')' == c) {
+            depth++;
+        } else if ('(' == c && 0 == --depth) {
+            break;
+        }
+    }
+    NSString *indexOperand = [operand substringWithRange:NSMakeRange(position + 1, [operand length] - position - 2)];
+    if (0 == position || ![indexOperand hasPrefix:@"@"]) {
+        return operand;
+    }
+    *index = [indexOperand substringFromIndex:1];
+    return [operand substringToIndex:position];
+}
+
+
+/*
+ The General Address Specification (GAS) of GPL:
+ 0aaaaaaa                           CPU RAM >8300 + a
+ 1XVIaaaa aaaaaaaa [index]          12 bit offset, X = indexed, V = VDP RAM, I = indirect
+ 1XVI1111 aaaaaaaa aaaaaaaa [index] extended: 16 bit offset
+ The offset of CPU RAM addresses is relative to >8300, indirect pointers are always located in CPU RAM. The length
+ depends on the address, so it must be known in the first pass already.
+ */
+- (BOOL)generalAddress:(NSString *)operand code:(NSMutableData *)code
+{
+    const BOOL isVDP = '@' != [operand characterAtIndex:0] && '*' != [operand characterAtIndex:0];
+    NSString *address = isVDP? [operand substringFromIndex:1] : operand;
+    const BOOL isIndirect = [address hasPrefix:@"*"];
+    NSString *index = nil;
+    address = [self addressOfOperand:[address substringFromIndex:1] index:&index];
+
+    int64_t value;
+    if (![self valueOf:address minimum:0 maximum:0xFFFF final:YES value:&value]) {
+        return NO;
+    }
+    const uint16_t offset = (isVDP && !isIndirect)? (uint16_t)value : (uint16_t)(value - XDTGa99NativePadBase);
+    if (!isVDP && !isIndirect && nil == index && 0x80 > offset) {
+        XDTGa99NativeAppendByte(code, offset);
+        return YES;
+    }
+    const uint8_t flags = 0x80 | ((nil != index)? 0x40 : 0x00) | (isVDP? 0x20 : 0x00) | (isIndirect? 0x10 : 0x00);
+    if (0x0F00 > offset) {
+        XDTGa99NativeAppendByte(code, flags | (offset >> 8));
+        XDTGa99NativeAppendByte(code, offset);
+    } else {
+        XDTGa99NativeAppendByte(code, flags | 0x0F);
+        XDTGa99NativeAppendWord(code, offset);
+    }
+    return (nil == index)? YES : [self indexOf:index code:code];
+}
+
+
+/* The index is a word in the scratch pad, encoded as offset to >8300 */
+- (BOOL)indexOf:(NSString *)index code:(NSMutableData *)code
+{
+    int64_t value;
+    if (![self valueOf:index minimum:XDTGa99NativePadBase maximum:XDTGa99NativePadBase + 0xFF final:YES value:&value]) {
+        return NO;
+    }
+    XDTGa99NativeAppendByte(code, value - XDTGa99NativePadBase);
+    return YES;
+}
+
+
+- (BOOL)string:(NSString *)operand maximumLength:(NSUInteger)maximumLength code:(NSMutableData *)code
+{
+    const NSUInteger length = [operand length];
+    if (3 > length || ![operand hasPrefix:@"'"] || ![operand hasSuffix:@"'"] || maximumLength + 2 < length ||
+        NSNotFound != [operand rangeOfString:@"'" options:0 range:NSMakeRange(1, length - 2)].location) {
+        return [self giveUp:@"text other than a simple string"];
+    }
+    NSData *text = [[operand substringWithRange:NSMakeRange(1, length - 2)] dataUsingEncoding:NSISOLatin1StringEncoding];
+    if (nil == text) {
+        return [self giveUp:@"text other than a simple string"];
+    }
+    [code appendData:text];
+    return YES;
+}
+
+
+- (BOOL)emitCode:(NSData *)code
+{
+    const NSUInteger length = [code length];
+    if (0 == length) {
+        return YES;
+    }
+    if (XDTGa99NativeMemorySize < _location + length || (_location & 0xE000) != ((_location + length - 1) & 0xE000)) {
+        return [self giveUp:@"code crosses a GROM boundary"];
+    }
+    uint8_t *memory = [_memory mutableBytes];
+    uint8_t *writtenBits = [_writtenBits mutableBytes];
+    for (NSUInteger i = 0; i < length; i++) {
+        const NSUInteger address = _location + i;
+        if (XDTGa99NativeIsWritten(writtenBits, address)) {
+            return [self giveUp:@"overlapping code"];
+        }
+        writtenBits[address >> 3] |= 1 << (address & 7);
+    }
+    memcpy(memory + _location, [code bytes], length);
+    _location += (uint32_t)length;
+    return YES;
+}
+
+@end
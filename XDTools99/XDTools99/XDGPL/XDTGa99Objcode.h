@@ -25,6 +25,9 @@
 #import "XDTObject.h"
 
 
+@class XDTCrossReference, XDTAddressMap, XDTCartridgeBuilder;
+
+
 NS_ASSUME_NONNULL_BEGIN
 @interface XDTGa99Objcode : XDTObject
 
@@ -34,13 +37,35 @@ NS_ASSUME_NONNULL_BEGIN
  *
  **/
 
+@property (readonly, nullable, retain) XDTCrossReference *crossReference;   /* Only built when the assembler has the cross-reference option set */
+
 - (nullable NSData *)generateDump:(NSError **)error;
 - (nullable NSArray<NSArray<id> *> *)generateByteCode:(NSError **)error;
 - (nullable NSData *)generateImageWithName:(NSString *)cartridgeName error:(NSError **)error;
 - (nullable NSDictionary<NSString *, NSData *> *)generateMESSCartridgeWithName:(NSString *)cartridgeName error:(NSError **)error;
+/* Streams the cartridge into the package file, natively built for programs of the native assembler */
+- (BOOL)writeMESSCartridgeWithName:(NSString *)cartridgeName toURL:(NSURL *)url error:(NSError **)error;
 
 - (nullable NSData *)generateListing:(BOOL)outputSymbols error:(NSError **)error;
 - (nullable NSData *)generateSymbols:(BOOL)useEqu error:(NSError **)error;
 
+/* Source lines by address and addresses by source line, built once from the listing and kept afterwards */
+- (nullable XDTAddressMap *)addressMap:(NSError **)error;
+
+/*
+ Detaching captures the listings and the symbol tables into native buffers and releases the Python object code.
+ Outputs which were generated before are kept as well, any other fails with XDTErrorCodeDetachedObject afterwards.
+
+ Object code of the native assembler generates the byte code and images natively, also after detaching. For all
+ other outputs the source is assembled by xga99 at their first use, unless a source file has changed.
+ Until detaching, the memory budget may remove the captured outputs, they are generated again at their next use.
+ */
+@property (readonly, getter=isDetached) BOOL detached;
+@property (readonly, getter=isNative) BOOL native;
+@property (readonly, nullable) NSArray<NSURL *> *sourceFiles;   /* The source file and all copied files, nil unless assembled natively */
+
+- (BOOL)materializeAndDetach:(NSError **)error;
+- (NSUInteger)removeRegenerableOutputs;    /* Returns the freed bytes, nothing is freed once detached */
+
 @end
 NS_ASSUME_NONNULL_END
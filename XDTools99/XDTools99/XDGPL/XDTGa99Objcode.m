@@ -27,19 +27,60 @@
 #import "NSArrayPythonAdditions.h"
 #import "NSDataPythonAdditions.h"
 #import "NSErrorPythonAdditions.h"
+#import "XDTInstrumentation.h"
+#import "XDTCrossReference.h"
+#import "XDTAddressMap.h"
+#import "XDTCartridgeBuilder.h"
+#import "XDTGPLAssembler.h"
+#import "XDTGa99NativeAssembler.h"
+#import "XDTMemoryBudget.h"
+#import "XDTPythonGIL.h"
 
 
 #define XDTClassNameObjcode "Objcode"
 
 
 NS_ASSUME_NONNULL_BEGIN
+@interface XDTObject ()
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
+
+@end
+
+
+@interface XDTGPLAssembler ()
+
+- (nullable PyObject *)pythonResultOfSourceFile:(NSURL *)srcname error:(NSError **)error;
+
+@end
+
+
 @interface XDTGa99Objcode () {
     PyObject *objectcodePythonClass;
+
+    /* Program of the native assembler, and the assembler and source for the outputs which xga99 generates */
+    XDTGa99NativeProgram *nativeProgram;
+    XDTGPLAssembler *fallbackAssembler;
+    NSURL *fallbackSourceFile;
+
+    /* Outputs of the generators by their Python call, so they remain available when detached */
+    NSMutableDictionary<NSString *, id> *capturedOutputs;
+    XDTAddressMap *capturedAddressMap;
 }
 
+@property (nullable, retain) XDTCrossReference *crossReference;
+
 + (nullable instancetype)gplObjectcodeWithPythonInstance:(void *)object;
++ (nullable instancetype)gplObjectcodeWithNativeProgram:(XDTGa99NativeProgram *)program assembler:(XDTGPLAssembler *)assembler sourceFile:(NSURL *)srcFile;
 
 - (nullable instancetype)initWithPythonInstance:(PyObject *)object;
+- (nullable instancetype)initWithNativeProgram:(XDTGa99NativeProgram *)program assembler:(XDTGPLAssembler *)assembler sourceFile:(NSURL *)srcFile;
+
+- (BOOL)loadPythonObjectcode:(NSError **)error;
+- (nullable XDTCartridgeBuilder *)nativeCartridgeBuilderWithName:(NSString *)cartridgeName;
+
+- (nullable id)capturedOutputForKey:(NSString *)outputKey error:(NSError **)error;
+- (void)captureOutput:(nullable id)output forKey:(NSString *)outputKey;
 
 @end
 NS_ASSUME_NONNULL_END
@@ -60,6 +101,7 @@ NS_ASSUME_NONNULL_END
 
 + (instancetype)gplObjectcodeWithPythonInstance:(void *)object
 {
+    XDTAcquireGIL();
     XDTGa99Objcode *retVal = [[XDTGa99Objcode alloc] initWithPythonInstance:(PyObject *)object];
 #if !__has_feature(objc_arc)
     [retVal autorelease];
@@ -70,6 +112,7 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithPythonInstance:(PyObject *)object
 {
+    XDTAcquireGIL();
     self = [super init];
     if (nil == self) {
         return nil;
@@ -77,6 +120,40 @@ NS_ASSUME_NONNULL_END
 
     objectcodePythonClass = object;
     Py_INCREF(objectcodePythonClass);
+    capturedOutputs = [[NSMutableDictionary alloc] init];
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
+
+    return self;
+}
+
+
++ (instancetype)gplObjectcodeWithNativeProgram:(XDTGa99NativeProgram *)program assembler:(XDTGPLAssembler *)assembler sourceFile:(NSURL *)srcFile
+{
+    XDTGa99Objcode *retVal = [[XDTGa99Objcode alloc] initWithNativeProgram:program assembler:assembler sourceFile:srcFile];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithNativeProgram:(XDTGa99NativeProgram *)program assembler:(XDTGPLAssembler *)assembler sourceFile:(NSURL *)srcFile
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    objectcodePythonClass = NULL;
+    capturedOutputs = [[NSMutableDictionary alloc] init];
+    nativeProgram = program;
+    fallbackAssembler = assembler;
+    fallbackSourceFile = [srcFile copy];
+#if !__has_feature(objc_arc)
+    [nativeProgram retain];
+    [fallbackAssembler retain];
+#endif
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
 
     return self;
 }
@@ -84,13 +161,168 @@ NS_ASSUME_NONNULL_END
 
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(objectcodePythonClass);
 #if !__has_feature(objc_arc)
+    [capturedOutputs release];
+    [capturedAddressMap release];
+    [nativeProgram release];
+    [fallbackAssembler release];
+    [fallbackSourceFile release];
+    [_crossReference release];
+
     [super dealloc];
 #endif
 }
 
 
+#pragma mark - Detaching
+
+
+- (BOOL)isDetached
+{
+    return NULL == objectcodePythonClass && nil == fallbackAssembler;
+}
+
+
+- (BOOL)isNative
+{
+    return nil != nativeProgram;
+}
+
+
+- (NSArray<NSURL *> *)sourceFiles
+{
+    return nativeProgram.sourceFiles;
+}
+
+
+/*
+ Object code of the native assembler has no Python object until an output is needed which only xga99 generates.
+ The source is assembled again then, but only if none of the source files has changed since the native assembling.
+ */
+- (BOOL)loadPythonObjectcode:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (NULL != objectcodePythonClass) {
+        return YES;
+    }
+    if (nil == fallbackAssembler || ![nativeProgram hasUnchangedSources]) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            NSDictionary *errorDict = @{
+                                        NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Output not available", nil, myBundle, @"Description for an error object, discribing that an output of a detached object code cannot be generated anymore."),
+                                        NSLocalizedRecoverySuggestionErrorKey: NSLocalizedStringFromTableInBundle(@"The source files have changed since assembling. Assemble the source again.", nil, myBundle, @"Recovery suggestion for an error object, which explains that the output of natively assembled code cannot be generated by xas99 anymore.")
+                                        };
+            *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeDetachedObject userInfo:errorDict];
+        }
+        return NO;
+    }
+
+    PyObject *pValueTupel = [fallbackAssembler pythonResultOfSourceFile:fallbackSourceFile error:error];
+    if (NULL == pValueTupel) {
+        return NO;
+    }
+    objectcodePythonClass = PyTuple_GetItem(pValueTupel, 0);
+    Py_XINCREF(objectcodePythonClass);
+    Py_DECREF(pValueTupel);
+
+    return NULL != objectcodePythonClass;
+}
+
+
+/*
+ Like for the objcode of xas99, every generated output is kept by the key of its Python call and looked up first.
+ */
+- (id)capturedOutputForKey:(NSString *)outputKey error:(NSError **)error
+{
+    [[XDTMemoryBudget sharedBudget] noteUseOfObject:self];
+    id retVal = [capturedOutputs objectForKey:outputKey];
+    if (nil == retVal && self.isDetached && nil != error) {
+        NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+        NSDictionary *errorDict = @{
+                                    NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Output not available", nil, myBundle, @"Description for an error object, discribing that an output of a detached object code cannot be generated anymore."),
+                                    NSLocalizedRecoverySuggestionErrorKey: [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"%@ was not generated before the object code was detached from Python. Assemble the source again.", nil, myBundle, @"Recovery suggestion for an error object, which explains that the given output was not captured before detaching."), outputKey]
+                                    };
+        *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeDetachedObject userInfo:errorDict];
+    }
+
+    return retVal;
+}
+
+
+- (void)captureOutput:(id)output forKey:(NSString *)outputKey
+{
+    if (nil != output) {
+        [capturedOutputs setObject:output forKey:outputKey];
+    }
+}
+
+
+- (BOOL)materializeAndDetach:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (self.isDetached) {
+        return YES;
+    }
+    if (NULL == objectcodePythonClass) {
+        /* native object code keeps its program, only xga99 is not used anymore */
+#if !__has_feature(objc_arc)
+        [fallbackAssembler release];
+#endif
+        fallbackAssembler = nil;
+        return YES;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"materialize" category:XDTInstrumentationCategoryConversion];
+    const BOOL isMaterialized = nil != [self generateListing:NO error:error] && nil != [self generateListing:YES error:error] &&
+                                nil != [self generateSymbols:NO error:error] && nil != [self generateSymbols:YES error:error];
+    [self.instrumentation endPhase:phase convertingObjects:[capturedOutputs count]];
+    if (!isMaterialized) {
+        return NO;
+    }
+
+    Py_CLEAR(objectcodePythonClass);
+#if !__has_feature(objc_arc)
+    [fallbackAssembler release];
+#endif
+    fallbackAssembler = nil;
+    return YES;
+}
+
+
+/*
+ Like for the objcode of xas99, captured outputs are generated again as long as the object code is not detached.
+ */
+- (NSUInteger)removeRegenerableOutputs
+{
+    XDTAcquireGIL();
+    if (self.isDetached || 0 == [capturedOutputs count]) {
+        return 0;
+    }
+
+    const NSUInteger retVal = [XDTObject nativeByteCountOfObject:capturedOutputs];
+    [capturedOutputs removeAllObjects];
+    return retVal;
+}
+
+
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return (NULL == objectcodePythonClass)? @[] : @[[NSValue valueWithPointer:objectcodePythonClass]];
+}
+
+
+- (NSUInteger)nativeByteCount
+{
+    return [XDTObject nativeByteCountOfObject:capturedOutputs] + [nativeProgram byteCount] +
+           [capturedAddressMap byteCount] + [_crossReference byteCount];
+}
+
+
 #pragma mark - Property Wrapper
 
 
@@ -117,12 +349,30 @@ NS_ASSUME_NONNULL_END
 
 - (NSArray<NSArray<id> *> *)generateByteCode:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = @"generate_byte_code";
+    if (nil != nativeProgram && nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_byte_code_native" category:XDTInstrumentationCategoryConversion];
+        NSArray<NSArray<id> *> *groms = nil;
+        XDTBeginNativeWork();
+        groms = [nativeProgram byteCode];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[groms count]];
+        [self captureOutput:groms forKey:outputKey];
+    }
+    NSArray<NSArray<id> *> *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      groms = self.generate_byte_code()
      */
     PyObject *methodName = PyString_FromString("generate_byte_code");
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_byte_code" category:XDTInstrumentationCategoryPython];
     PyObject *gromList = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, NULL);
+    [self.instrumentation endPhase:phase returning:gromList passing:NULL];
     Py_XDECREF(methodName);
     if (NULL == gromList) {
         NSLog(@"%s ERROR: generate_byte_code() returns NULL!", __FUNCTION__);
@@ -136,7 +386,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_byte_code" category:XDTInstrumentationCategoryConversion];
     NSArray<NSArray<id> *> *retVal = [NSArray arrayWithPyListOfTuple:gromList];
+    [self.instrumentation endPhase:phase convertingObjects:[retVal count]];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(gromList);
 
     return retVal;
@@ -145,16 +398,35 @@ NS_ASSUME_NONNULL_END
 
 - (NSData *)generateImageWithName:(NSString *)cartridgeName error:(NSError **)error
 {
+    XDTAcquireGIL();
     if (nil == cartridgeName || [cartridgeName length] == 0) {
         return nil;
     }
+    NSString *outputKey = [NSString stringWithFormat:@"generate_image:%@", cartridgeName];
+    if (nil != nativeProgram && nil == [capturedOutputs objectForKey:outputKey]) {
+        /* xga99 reports the names and programs which do not fit the header */
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_image_native" category:XDTInstrumentationCategoryConversion];
+        NSData *image = nil;
+        XDTBeginNativeWork();
+        image = [nativeProgram imageWithName:cartridgeName];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:(nil == image)? 0 : 1];
+        [self captureOutput:image forKey:outputKey];
+    }
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      image = self.generate_image(name)
      */
     PyObject *methodName = PyString_FromString("generate_image");
     PyObject *pCartName = PyString_FromString([cartridgeName UTF8String]);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_image" category:XDTInstrumentationCategoryPython];
     PyObject *cartImage = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pCartName, NULL);
+    [self.instrumentation endPhase:phase returning:cartImage passing:pCartName, NULL];
     Py_XDECREF(pCartName);
     Py_XDECREF(methodName);
     if (NULL == cartImage) {
@@ -169,7 +441,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_image" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:cartImage];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
 
     Py_DECREF(cartImage);
 
@@ -185,16 +460,34 @@ NS_ASSUME_NONNULL_END
  */
 - (NSDictionary<NSString *, NSData *> *)generateMESSCartridgeWithName:(NSString *)cartridgeName error:(NSError **)error
 {
+    XDTAcquireGIL();
     if (nil == cartridgeName || [cartridgeName length] == 0) {
         return nil;
     }
+    NSString *outputKey = [NSString stringWithFormat:@"generate_cart:%@", cartridgeName];
+    if (nil != nativeProgram && nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_cart_native" category:XDTInstrumentationCategoryConversion];
+        NSDictionary<NSString *, NSData *> *contents = nil;
+        XDTBeginNativeWork();
+        contents = [[self nativeCartridgeBuilderWithName:cartridgeName] packageContents];
+        XDTEndNativeWork();
+        [self.instrumentation endPhase:phase convertingObjects:[contents count]];
+        [self captureOutput:contents forKey:outputKey];
+    }
+    NSDictionary<NSString *, NSData *> *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      data, layout, metainf = code.generate_cart(name)
      */
     PyObject *methodName = PyString_FromString("generate_cart");
     PyObject *pCartName = PyString_FromString([cartridgeName UTF8String]);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_cart" category:XDTInstrumentationCategoryPython];
     PyObject *cartTuple = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pCartName, NULL);
+    [self.instrumentation endPhase:phase returning:cartTuple passing:pCartName, NULL];
     Py_XDECREF(pCartName);
     Py_XDECREF(methodName);
     if (NULL == cartTuple) {
@@ -218,12 +511,15 @@ NS_ASSUME_NONNULL_END
     PyObject *cartLayout = PyTuple_GetItem(cartTuple, 1);
     PyObject *cartMetaInf = PyTuple_GetItem(cartTuple, 2);
 
+    phase = [self.instrumentation beginPhase:@"generate_cart" category:XDTInstrumentationCategoryConversion];
     NSString *cartridgeFileName = [cartridgeName stringByAppendingPathExtension:@"bin"];
     NSDictionary<NSString *, NSData *> *retVal =@{
                                                   cartridgeFileName: [NSData dataWithPythonString:cartData],
                                                   @"layout.xml": [NSData dataWithPythonString:cartLayout],
                                                   @"meta-inf.xml": [NSData dataWithPythonString:cartMetaInf]
                                                   };
+    [self.instrumentation endPhase:phase convertingObjects:[retVal count]];
+    [self captureOutput:retVal forKey:outputKey];
 
     Py_DECREF(cartTuple);
 
@@ -231,15 +527,60 @@ NS_ASSUME_NONNULL_END
 }
 
 
+/* The GROM image of the native assembler with its GPL header, the GROMs before its address stay empty */
+- (XDTCartridgeBuilder *)nativeCartridgeBuilderWithName:(NSString *)cartridgeName
+{
+    NSData *image = [nativeProgram imageWithName:cartridgeName];
+    if (nil == image) {
+        return nil;
+    }
+    XDTCartridgeBuilder *retVal = [XDTCartridgeBuilder cartridgeBuilderWithName:cartridgeName];
+    return [retVal setGROMImage:image address:[nativeProgram gromAddress] error:nil]? retVal : nil;
+}
+
+
+- (BOOL)writeMESSCartridgeWithName:(NSString *)cartridgeName toURL:(NSURL *)url error:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (nil == cartridgeName || [cartridgeName length] == 0) {
+        return NO;
+    }
+    NSString *outputKey = [NSString stringWithFormat:@"generate_cart:%@", cartridgeName];
+    if (nil == [capturedOutputs objectForKey:outputKey]) {
+        XDTCartridgeBuilder *builder = nil;
+        BOOL isWritten = NO;
+        XDTBeginNativeWork();
+        builder = [self nativeCartridgeBuilderWithName:cartridgeName];
+        isWritten = nil != builder && [builder writeToURL:url error:error];
+        XDTEndNativeWork();
+        if (nil != builder) {
+            return isWritten;
+        }
+    }
+
+    NSDictionary<NSString *, NSData *> *contents = [self generateMESSCartridgeWithName:cartridgeName error:error];
+    return nil != contents && [XDTCartridgeBuilder writePackageContents:contents toURL:url error:error];
+}
+
+
 - (NSData *)generateListing:(BOOL)outputSymbols error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_list:%d", outputSymbols];
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      generate_list(gensymbols)
      */
     PyObject *methodName = PyString_FromString("generate_list");
     PyObject *pOutputSymbols = PyBool_FromLong(outputSymbols);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_list" category:XDTInstrumentationCategoryPython];
     PyObject *listingString = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pOutputSymbols, NULL);
+    [self.instrumentation endPhase:phase returning:listingString passing:pOutputSymbols, NULL];
     Py_XDECREF(pOutputSymbols);
     Py_XDECREF(methodName);
     if (NULL == listingString) {
@@ -254,7 +595,10 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_list" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:listingString];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(listingString);
 
     return retVal;
@@ -263,13 +607,22 @@ NS_ASSUME_NONNULL_END
 
 - (NSData *)generateSymbols:(BOOL)useEqu error:(NSError **)error
 {
+    XDTAcquireGIL();
+    NSString *outputKey = [NSString stringWithFormat:@"generate_symbols:%d", useEqu];
+    NSData *capturedOutput = [self capturedOutputForKey:outputKey error:error];
+    if (nil != capturedOutput || self.isDetached || ![self loadPythonObjectcode:error]) {
+        return capturedOutput;
+    }
+
     /*
      Function call in Python:
      generate_symbols(useEqu)
      */
     PyObject *methodName = PyString_FromString("generate_symbols");
     PyObject *pUseEqu = PyBool_FromLong(useEqu);
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"generate_symbols" category:XDTInstrumentationCategoryPython];
     PyObject *symbolsString = PyObject_CallMethodObjArgs(objectcodePythonClass, methodName, pUseEqu, NULL);
+    [self.instrumentation endPhase:phase returning:symbolsString passing:pUseEqu, NULL];
     Py_XDECREF(pUseEqu);
     Py_XDECREF(methodName);
     if (NULL == symbolsString) {
@@ -284,10 +637,42 @@ NS_ASSUME_NONNULL_END
         return nil;
     }
 
+    phase = [self.instrumentation beginPhase:@"generate_symbols" category:XDTInstrumentationCategoryConversion];
     NSData *retVal = [NSData dataWithPythonString:symbolsString];
+    [self.instrumentation endPhase:phase convertingObjects:1];
+    [self captureOutput:retVal forKey:outputKey];
     Py_DECREF(symbolsString);
 
     return retVal;
 }
 
+
+#pragma mark - Address Map
+
+
+- (XDTAddressMap *)addressMap:(NSError **)error
+{
+    XDTAcquireGIL();
+    if (nil != capturedAddressMap) {
+        return capturedAddressMap;
+    }
+    /* the listing is captured, so the map is also built after detaching */
+    NSData *listing = [self generateListing:NO error:error];
+    if (nil == listing) {
+        return nil;
+    }
+
+    XDTInstrumentationPhase *phase = [self.instrumentation beginPhase:@"address_map" category:XDTInstrumentationCategoryConversion];
+    XDTAddressMap *addressMap = nil;
+    XDTBeginNativeWork();
+    addressMap = [XDTAddressMap addressMapOfListing:listing];
+    XDTEndNativeWork();
+    capturedAddressMap = addressMap;
+#if !__has_feature(objc_arc)
+    [capturedAddressMap retain];
+#endif
+    [self.instrumentation endPhase:phase convertingObjects:[capturedAddressMap rangeCount]];
+    return capturedAddressMap;
+}
+
 @end
@@ -0,0 +1,64 @@
+//
+//  XDTAddressMap.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTAddressMapKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
+
+FOUNDATION_EXPORT XDTAddressMapKey const XDTAddressMapFileName;     /* Name of the source file like in the listing as NSString */
+FOUNDATION_EXPORT XDTAddressMapKey const XDTAddressMapLineNumber;   /* The line number of the source file, starting at 1, as NSNumber */
+FOUNDATION_EXPORT XDTAddressMapKey const XDTAddressMapBank;         /* The bank of the address, 0 for code which is not banked, as NSNumber */
+FOUNDATION_EXPORT XDTAddressMapKey const XDTAddressMapAddress;      /* The first address of the range as NSNumber */
+FOUNDATION_EXPORT XDTAddressMapKey const XDTAddressMapLength;       /* Number of bytes of the range as NSNumber */
+
+
+/**
+ The addresses of an assembled program by the lines of its sources, and the source lines by their addresses.
+
+ The map is built once from the listing of the assembler, including the lines of all copied files, and needs no
+ Python afterwards. Every source line which generates code or data has one or more ranges of contiguous bytes,
+ stored natively in 12 bytes each. The ranges are kept sorted by file and line and by bank and address, so both
+ directions are a binary search, e.g. for breakpoints of a debugger, samples of a profiler or an editor gutter.
+ */
+@interface XDTAddressMap : NSObject
+
+@property (readonly) NSArray<NSString *> *fileNames;    /* The source file and all copied files in the order of the listing */
+@property (readonly) NSUInteger rangeCount;
+@property (readonly) NSUInteger byteCount;      /* Memory of the ranges and of their order by address */
+
++ (instancetype)addressMapOfListing:(NSData *)listing;
+
+/* The range which contains the address of the bank. Of ranges at the same address (several AORG to it), the one of the last line is found. */
+- (nullable NSDictionary<XDTAddressMapKey, id> *)locationOfAddress:(NSUInteger)address bank:(NSUInteger)bank;
+
+/* All ranges of the line in ascending order of their addresses. A file name of nil means the main source file. */
+- (NSArray<NSDictionary<XDTAddressMapKey, id> *> *)rangesOfLine:(NSUInteger)line fileName:(nullable NSString *)fileName;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,448 @@
+//
+//  XDTAddressMap.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTAddressMap.h"
+
+#include <stdlib.h>
+
+
+/*
+ The listings of xas99 and xga99 start every line with a column of 18 characters, like the sample IDE shows them:
+    "0012 A01C 0200  "      line number, address and a word of code, followed by the text of the source line
+    "     A01E 1234  "      continuation with the next word of the same source line
+    "0013 6010 02 07 "      GPL code and BYTE directives list single bytes
+ A bank is appended to the address with a colon ("6000:1") and widens the column by its length. Lines without
+ address or without code (comments, EQU, AORG, labels) have no range. Copying a file, and returning from it,
+ lists the name of the file in a line like "**** **** ****     > name".
+ */
+#define XDTAddressMapListingPrefixLength 18
+#define XDTAddressMapFileMarker "****"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+XDTAddressMapKey const XDTAddressMapFileName = @"XDTAddressMapFileName";
+XDTAddressMapKey const XDTAddressMapLineNumber = @"XDTAddressMapLineNumber";
+XDTAddressMapKey const XDTAddressMapBank = @"XDTAddressMapBank";
+XDTAddressMapKey const XDTAddressMapAddress = @"XDTAddressMapAddress";
+XDTAddressMapKey const XDTAddressMapLength = @"XDTAddressMapLength";
+
+
+/* One range of contiguous bytes generated by a source line */
+typedef struct {
+    uint32_t line;
+    uint16_t file;      /* Index into the file names */
+    uint16_t bank;
+    uint16_t address;
+    uint16_t length;
+} XDTAddressMapRange;
+
+
+@interface XDTAddressMap () {
+    NSData *_ranges;            /* XDTAddressMapRange, sorted by file, line and address */
+    NSData *_addressOrder;      /* uint32_t index of each range, sorted by bank and address, and then by line order */
+    NSData *_storage;           /* The mapped file of an XDTDebugInfo, which holds the bytes of both tables */
+}
+
+- (instancetype)initWithFileNames:(NSArray<NSString *> *)fileNames ranges:(NSData *)ranges;
+
+/* Package private for XDTDebugInfo, which writes the sorted ranges into its file and maps them back without copying */
+- (instancetype)initWithFileNames:(NSArray<NSString *> *)fileNames sortedRanges:(NSData *)ranges addressOrder:(NSData *)addressOrder storage:(NSData *)storage;
+- (NSData *)rangeData;
+- (NSData *)addressOrderData;
+
+- (NSDictionary<XDTAddressMapKey, id> *)locationOfRange:(const XDTAddressMapRange *)range;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static int XDTAddressMapCompareLines(const XDTAddressMapRange *rangeA, uint16_t file, uint32_t line, uint16_t address)
+{
+    if (rangeA->file != file) {
+        return (rangeA->file < file)? -1 : 1;
+    }
+    if (rangeA->line != line) {
+        return (rangeA->line < line)? -1 : 1;
+    }
+    return (int)rangeA->address - (int)address;
+}
+
+
+static int XDTAddressMapCompareAddresses(const XDTAddressMapRange *rangeA, uint16_t bank, uint16_t address)
+{
+    if (rangeA->bank != bank) {
+        return (rangeA->bank < bank)? -1 : 1;
+    }
+    return (int)rangeA->address - (int)address;
+}
+
+
+/* Returns the value of the hex digits, or -1 if the text is not a hex number of the length. */
+static long XDTAddressMapHexValue(const char *text, NSUInteger length)
+{
+    long retVal = 0;
+    for (NSUInteger i = 0; i < length; i++) {
+        const char c = text[i];
+        if ('0' <= c && '9' >= c) {
+            retVal = (retVal << 4) | (c - '0');
+        } else if ('A' <= c && 'F' >= c) {
+            retVal = (retVal << 4) | (c - 'A' + 10);
+        } else if ('a' <= c && 'f' >= c) {
+            retVal = (retVal << 4) | (c - 'a' + 10);
+        } else {
+            return -1;
+        }
+    }
+    return retVal;
+}
+
+
+@implementation XDTAddressMap
+
+#pragma mark Initializers
+
++ (instancetype)addressMapOfListing:(NSData *)listing
+{
+    NSMutableArray<NSString *> *fileNames = [NSMutableArray array];
+    NSMutableData *ranges = [NSMutableData data];
+    uint16_t file = 0;
+    uint32_t lastLine = 0;
+
+    const char *bytes = [listing bytes];
+    const NSUInteger length = [listing length];
+    for (NSUInteger start = 0, end = 0; start < length; start = end + 1) {
+        for (end = start; end < length && '\n' != bytes[end]; end++);
+        NSUInteger lineLength = end - start;
+        const char *text = bytes + start;
+        if (0 < lineLength && '\r' == text[lineLength - 1]) {
+            lineLength--;
+        }
+
+        if (lineLength > strlen(XDTAddressMapFileMarker) && 0 == strncmp(text, XDTAddressMapFileMarker, strlen(XDTAddressMapFileMarker))) {
+            const char *marker = memchr(text, '>', lineLength);
+            if (NULL != marker) {
+                NSString *markedName = [[NSString alloc] initWithBytes:marker + 1 length:text + lineLength - marker - 1 encoding:NSUTF8StringEncoding];
+                NSString *name = [markedName stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+#if !__has_feature(objc_arc)
+                [markedName autorelease];
+#endif
+                if (nil == name) {
+                    continue;
+                }
+                NSUInteger index = [fileNames indexOfObject:name];
+                if (NSNotFound == index) {
+                    index = [fileNames count];
+                    [fileNames addObject:name];
+                }
+                file = (uint16_t)MIN(index, UINT16_MAX);
+                lastLine = 0;
+            }
+            continue;
+        }
+        /* the line number has four digits and grows beyond, or is blank for the continuation of the last line */
+        NSUInteger numberLength = 0;
+        while (numberLength < lineLength && '0' <= text[numberLength] && '9' >= text[numberLength]) {
+            numberLength++;
+        }
+        uint32_t line = lastLine;
+        if (0 == numberLength && 4 <= lineLength && 0 == strncmp(text, "    ", 4)) {
+            numberLength = 4;
+        } else if (4 <= numberLength && 9 >= numberLength) {
+            line = 0;
+            for (NSUInteger i = 0; i < numberLength; i++) {
+                line = line * 10 + (text[i] - '0');
+            }
+            lastLine = line;
+        } else {
+            continue;
+        }
+        if (numberLength + 5 > lineLength || ' ' != text[numberLength]) {
+            continue;
+        }
+        const long address = XDTAddressMapHexValue(text + numberLength + 1, 4);
+        if (0 == line || 0 > address) {
+            continue;
+        }
+
+        /* the columns right of a longer line number are shifted by its additional digits */
+        NSUInteger position = numberLength + 5;
+        NSUInteger prefixLength = XDTAddressMapListingPrefixLength + numberLength - 4;
+        long bank = 0;
+        if (position < lineLength && ':' == text[position]) {
+            NSUInteger bankEnd = position + 1;
+            while (bankEnd < lineLength && ' ' != text[bankEnd]) {
+                bankEnd++;
+            }
+            bank = XDTAddressMapHexValue(text + position + 1, bankEnd - position - 1);
+            if (0 > bank || bankEnd == position + 1) {
+                continue;
+            }
+            prefixLength += bankEnd - position;
+            position = bankEnd;
+        }
+
+        /* words or bytes of the code, up to the text of the source line */
+        NSUInteger codeLength = 0;
+        const NSUInteger prefixEnd = MIN(prefixLength, lineLength);
+        while (position < prefixEnd) {
+            if (' ' == text[position]) {
+                position++;
+                continue;
+            }
+            NSUInteger tokenEnd = position;
+            while (tokenEnd < prefixEnd && ' ' != text[tokenEnd]) {
+                tokenEnd++;
+            }
+            const NSUInteger tokenLength = tokenEnd - position;
+            if ((2 != tokenLength && 4 != tokenLength) || 0 > XDTAddressMapHexValue(text + position, tokenLength)) {
+                break;
+            }
+            codeLength += tokenLength / 2;
+            position = tokenEnd;
+        }
+        if (0 == codeLength) {
+            continue;
+        }
+        if (0 == [fileNames count]) {
+            [fileNames addObject:@""];  /* a listing without the name of its source file */
+        }
+
+        /* continue the range of the line if the code follows immediately */
+        const NSUInteger rangeCount = [ranges length] / sizeof(XDTAddressMapRange);
+        if (0 < rangeCount) {
+            XDTAddressMapRange *previous = (XDTAddressMapRange *)[ranges mutableBytes] + rangeCount - 1;
+            if (previous->file == file && previous->line == line && previous->bank == bank &&
+                (long)previous->address + previous->length == address && UINT16_MAX >= previous->length + codeLength) {
+                previous->length += codeLength;
+                continue;
+            }
+        }
+        const XDTAddressMapRange range = {line, file, (uint16_t)bank, (uint16_t)address, (uint16_t)codeLength};
+        [ranges appendBytes:&range length:sizeof(range)];
+    }
+
+    XDTAddressMap *retVal = [[XDTAddressMap alloc] initWithFileNames:fileNames ranges:ranges];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithFileNames:(NSArray<NSString *> *)fileNames ranges:(NSData *)ranges
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    /* the listing order is the order of assembling, which is the tie breaker of equal addresses */
+    NSMutableData *sortedRanges = [NSMutableData dataWithData:ranges];
+    XDTAddressMapRange *range = [sortedRanges mutableBytes];
+    const NSUInteger rangeCount = [sortedRanges length] / sizeof(XDTAddressMapRange);
+    NSMutableData *addressOrder = [NSMutableData dataWithLength:rangeCount * sizeof(uint32_t)];
+    uint32_t *order = [addressOrder mutableBytes];
+    for (NSUInteger i = 0; i < rangeCount; i++) {
+        order[i] = (uint32_t)i;
+    }
+    qsort_b(order, rangeCount, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        const uint32_t indexA = *(const uint32_t *)a;
+        const uint32_t indexB = *(const uint32_t *)b;
+        const int retVal = XDTAddressMapCompareAddresses(&range[indexA], range[indexB].bank, range[indexB].address);
+        return (0 != retVal)? retVal : ((indexA < indexB)? -1 : 1);
+    });
+
+    /* sort the ranges by their lines and renumber the address order */
+    NSMutableData *lineOrders = [NSMutableData dataWithLength:rangeCount * sizeof(uint32_t)];
+    uint32_t *lineOrder = [lineOrders mutableBytes];
+    for (NSUInteger i = 0; i < rangeCount; i++) {
+        lineOrder[i] = (uint32_t)i;
+    }
+    qsort_b(lineOrder, rangeCount, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        const uint32_t indexA = *(const uint32_t *)a;
+        const uint32_t indexB = *(const uint32_t *)b;
+        const int retVal = XDTAddressMapCompareLines(&range[indexA], range[indexB].file, range[indexB].line, range[indexB].address);
+        return (0 != retVal)? retVal : ((indexA < indexB)? -1 : 1);
+    });
+    NSMutableData *linesSorted = [NSMutableData dataWithLength:rangeCount * sizeof(XDTAddressMapRange)];
+    XDTAddressMapRange *lineRange = [linesSorted mutableBytes];
+    NSMutableData *newIndexes = [NSMutableData dataWithLength:rangeCount * sizeof(uint32_t)];
+    uint32_t *newIndex = [newIndexes mutableBytes];
+    for (NSUInteger i = 0; i < rangeCount; i++) {
+        lineRange[i] = range[lineOrder[i]];
+        newIndex[lineOrder[i]] = (uint32_t)i;
+    }
+    for (NSUInteger i = 0; i < rangeCount; i++) {
+        order[i] = newIndex[order[i]];
+    }
+
+    _fileNames = [fileNames copy];
+    _ranges = [linesSorted copy];
+    _addressOrder = [addressOrder copy];
+
+    return self;
+}
+
+
+- (instancetype)initWithFileNames:(NSArray<NSString *> *)fileNames sortedRanges:(NSData *)ranges addressOrder:(NSData *)addressOrder storage:(NSData *)storage
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    /* the tables point into the storage, copying them would copy the bytes */
+    _fileNames = [fileNames copy];
+    _ranges = ranges;
+    _addressOrder = addressOrder;
+    _storage = storage;
+#if !__has_feature(objc_arc)
+    [_ranges retain];
+    [_addressOrder retain];
+    [_storage retain];
+#endif
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_fileNames release];
+    [_ranges release];
+    [_addressOrder release];
+    [_storage release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSUInteger)rangeCount
+{
+    return [_ranges length] / sizeof(XDTAddressMapRange);
+}
+
+
+- (NSUInteger)byteCount
+{
+    return [_ranges length] + [_addressOrder length];
+}
+
+
+- (NSDictionary<XDTAddressMapKey, id> *)locationOfAddress:(NSUInteger)address bank:(NSUInteger)bank
+{
+    if (UINT16_MAX < address || UINT16_MAX < bank) {
+        return nil;
+    }
+
+    /* the last range which starts at or before the address */
+    /* the order of a mapped debug info file is not checked when it is opened, so every index is checked here */
+    const XDTAddressMapRange *ranges = [_ranges bytes];
+    const NSUInteger rangeCount = [self rangeCount];
+    const uint32_t *order = [_addressOrder bytes];
+    NSUInteger low = 0, high = [_addressOrder length] / sizeof(uint32_t);
+    while (low < high) {
+        const NSUInteger mid = (low + high) / 2;
+        if (rangeCount <= order[mid]) {
+            return nil;
+        }
+        if (0 >= XDTAddressMapCompareAddresses(&ranges[order[mid]], (uint16_t)bank, (uint16_t)address)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (0 == low || rangeCount <= order[low - 1]) {
+        return nil;
+    }
+    const XDTAddressMapRange *range = &ranges[order[low - 1]];
+    if (bank != range->bank || address >= (NSUInteger)range->address + range->length) {
+        return nil;
+    }
+    return [self locationOfRange:range];
+}
+
+
+- (NSArray<NSDictionary<XDTAddressMapKey, id> *> *)rangesOfLine:(NSUInteger)line fileName:(NSString *)fileName
+{
+    const NSUInteger file = (nil == fileName)? 0 : [_fileNames indexOfObject:fileName];
+    if (NSNotFound == file || UINT16_MAX < file || UINT32_MAX < line) {
+        return @[];
+    }
+
+    /* the first range of the line */
+    const XDTAddressMapRange *ranges = [_ranges bytes];
+    const NSUInteger rangeCount = [self rangeCount];
+    NSUInteger low = 0, high = rangeCount;
+    while (low < high) {
+        const NSUInteger mid = (low + high) / 2;
+        if (0 > XDTAddressMapCompareLines(&ranges[mid], (uint16_t)file, (uint32_t)line, 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    NSMutableArray<NSDictionary<XDTAddressMapKey, id> *> *retVal = [NSMutableArray array];
+    for (NSUInteger i = low; i < rangeCount && file == ranges[i].file && line == ranges[i].line; i++) {
+        [retVal addObject:[self locationOfRange:&ranges[i]]];
+    }
+    return retVal;
+}
+
+
+- (NSData *)rangeData
+{
+    return _ranges;
+}
+
+
+- (NSData *)addressOrderData
+{
+    return _addressOrder;
+}
+
+
+#pragma mark - Private Methods
+
+
+- (NSDictionary<XDTAddressMapKey, id> *)locationOfRange:(const XDTAddressMapRange *)range
+{
+    return @{
+             XDTAddressMapFileName: (range->file < [_fileNames count])? [_fileNames objectAtIndex:range->file] : @"",
+             XDTAddressMapLineNumber: [NSNumber numberWithUnsignedInt:range->line],
+             XDTAddressMapBank: [NSNumber numberWithUnsignedShort:range->bank],
+             XDTAddressMapAddress: [NSNumber numberWithUnsignedShort:range->address],
+             XDTAddressMapLength: [NSNumber numberWithUnsignedShort:range->length]
+             };
+}
+
+@end
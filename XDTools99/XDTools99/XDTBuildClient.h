@@ -0,0 +1,79 @@
+//
+//  XDTBuildClient.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+
+@class XDTMessage;
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTBuildOptionKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry, besides the option keys of the tools */
+
+FOUNDATION_EXPORT XDTBuildOptionKey const XDTBuildOptionBaseAddress;      /* (NSNumber) Address of images, raw and text binaries of xas99, default is 0xa000 */
+FOUNDATION_EXPORT XDTBuildOptionKey const XDTBuildOptionCartridgeName;    /* (NSString) Name of GPL images and of MESS cartridges, default is the name of the source file */
+FOUNDATION_EXPORT XDTBuildOptionKey const XDTBuildOptionCompressObjectCode; /* (NSNumber) A BOOL to compress the object code of xas99 */
+FOUNDATION_EXPORT XDTBuildOptionKey const XDTBuildOptionTextMode;         /* (NSNumber) The XDTGenerateTextMode of text binaries of xas99 */
+FOUNDATION_EXPORT XDTBuildOptionKey const XDTBuildOptionListing;          /* (NSNumber) A BOOL to get the listing of the assembler too */
+
+FOUNDATION_EXPORT NSString * const XDTBuildErrorMessagesKey;  /* (XDTMessage) User info key of errors, with the messages of the failed tool */
+
+
+@interface XDTBuildResult : NSObject
+
+@property (readonly) NSArray<NSData *> *outputs;        /* Large outputs are mapped from the memory shared with the server */
+@property (readonly) NSArray<NSString *> *outputNames;  /* File name suffix of raw binaries, file name of cartridge parts or empty */
+@property (readonly, nullable) NSData *listing;
+@property (readonly, nullable) XDTMessage *messages;
+@property (readonly, getter=isCached) BOOL cached;
+
+@end
+
+
+/**
+ Client of the build server xdt99d, which keeps warm sessions of the tools and a cache of results for all its clients.
+
+ A client does not start Python, the options of the tools and the build option keys above are sent to the server,
+ which generates the output of the target option like the sample IDE does. The methods block until the reply is
+ received and may be called from any thread, but the requests of one client are sent one after another.
+ */
+@interface XDTBuildClient : NSObject
+
+@property (readonly) NSString *socketPath;
+
++ (NSString *)defaultSocketPath;
+
++ (nullable instancetype)buildClientWithSocketPath:(nullable NSString *)socketPath error:(NSError **)error;
+
+- (nullable XDTBuildResult *)assembleSourceFile:(NSURL *)srcFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error;
+- (nullable XDTBuildResult *)assembleGPLSourceFile:(NSURL *)srcFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error;
+- (nullable XDTBuildResult *)parseBasicSourceFile:(NSURL *)srcFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error;
+- (nullable XDTBuildResult *)loadBasicProgramFile:(NSURL *)programFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error;
+
+- (nullable NSDictionary<NSString *, NSNumber *> *)serverStatus:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,288 @@
+//
+//  XDTBuildClient.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTBuildClient.h"
+
+#import "XDTObject.h"
+#import "XDTBuildMessage.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+XDTBuildOptionKey const XDTBuildOptionBaseAddress = @"XDTBuildOptionBaseAddress";
+XDTBuildOptionKey const XDTBuildOptionCartridgeName = @"XDTBuildOptionCartridgeName";
+XDTBuildOptionKey const XDTBuildOptionCompressObjectCode = @"XDTBuildOptionCompressObjectCode";
+XDTBuildOptionKey const XDTBuildOptionTextMode = @"XDTBuildOptionTextMode";
+XDTBuildOptionKey const XDTBuildOptionListing = @"XDTBuildOptionListing";
+
+NSString * const XDTBuildErrorMessagesKey = @"XDTBuildErrorMessagesKey";
+
+
+@interface XDTBuildResult ()
+
+- (instancetype)initWithReply:(XDTBuildMessage *)reply;
+
+@end
+
+
+@interface XDTBuildClient () {
+    int _socket;
+    uint32_t _lastRequestID;
+}
+
+- (nullable instancetype)initWithSocketPath:(NSString *)socketPath error:(NSError **)error;
+
+- (nullable XDTBuildMessage *)sendRequest:(XDTBuildMessage *)request error:(NSError **)error;
+- (nullable XDTBuildResult *)resultOfRequest:(XDTBuildMessageType)type forFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+@implementation XDTBuildResult
+
+- (instancetype)initWithReply:(XDTBuildMessage *)reply
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _outputs = [reply dataOfField:XDTBuildFieldOutput];
+    NSMutableArray<NSString *> *names = [NSMutableArray arrayWithCapacity:[_outputs count]];
+    for (NSData *name in [reply dataOfField:XDTBuildFieldOutputName]) {
+        NSString *nameString = [[NSString alloc] initWithData:name encoding:NSUTF8StringEncoding];
+        [names addObject:(nil == nameString)? @"" : nameString];
+#if !__has_feature(objc_arc)
+        [nameString release];
+#endif
+    }
+    _outputNames = names;
+    _listing = [reply firstDataOfField:XDTBuildFieldListing];
+    _messages = [reply messages];
+    _cached = 0 != [reply integerOfField:XDTBuildFieldCached defaultValue:0];
+#if !__has_feature(objc_arc)
+    [_outputs retain];
+    [_outputNames retain];
+    [_listing retain];
+    [_messages retain];
+#endif
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_outputs release];
+    [_outputNames release];
+    [_listing release];
+    [_messages release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+@implementation XDTBuildClient
+
+#pragma mark Initializers
+
++ (NSString *)defaultSocketPath
+{
+    /* The temporary directory is private to the user, so is the server which listens there */
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"xdt99d.sock"];
+}
+
+
++ (instancetype)buildClientWithSocketPath:(NSString *)socketPath error:(NSError **)error
+{
+    XDTBuildClient *retVal = [[XDTBuildClient alloc] initWithSocketPath:(nil == socketPath)? [self defaultSocketPath] : socketPath error:error];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithSocketPath:(NSString *)socketPath error:(NSError **)error
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _socketPath = [socketPath copy];
+    _lastRequestID = 0;
+    _socket = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    const char *path = [socketPath fileSystemRepresentation];
+    if (sizeof(address.sun_path) <= strlen(path)) {
+        errno = ENAMETOOLONG;
+    } else {
+        strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+        if (0 <= _socket && 0 == connect(_socket, (struct sockaddr *)&address, sizeof(address))) {
+            const int noSigPipe = 1;
+            setsockopt(_socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+            return self;
+        }
+    }
+
+    if (nil != error) {
+        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey: socketPath}];
+    }
+#if !__has_feature(objc_arc)
+    [self release];
+#endif
+    return nil;
+}
+
+
+- (void)dealloc
+{
+    if (0 <= _socket) {
+        close(_socket);
+    }
+#if !__has_feature(objc_arc)
+    [_socketPath release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Request Methods
+
+
+- (XDTBuildResult *)assembleSourceFile:(NSURL *)srcFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error
+{
+    return [self resultOfRequest:XDTBuildMessageTypeAssemble forFile:srcFile options:options error:error];
+}
+
+
+- (XDTBuildResult *)assembleGPLSourceFile:(NSURL *)srcFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error
+{
+    return [self resultOfRequest:XDTBuildMessageTypeAssembleGPL forFile:srcFile options:options error:error];
+}
+
+
+- (XDTBuildResult *)parseBasicSourceFile:(NSURL *)srcFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error
+{
+    return [self resultOfRequest:XDTBuildMessageTypeParseBasic forFile:srcFile options:options error:error];
+}
+
+
+- (XDTBuildResult *)loadBasicProgramFile:(NSURL *)programFile options:(NSDictionary<NSString *, id> *)options error:(NSError **)error
+{
+    return [self resultOfRequest:XDTBuildMessageTypeLoadBasic forFile:programFile options:options error:error];
+}
+
+
+- (NSDictionary<NSString *, NSNumber *> *)serverStatus:(NSError **)error
+{
+    XDTBuildMessage *reply = [self sendRequest:[XDTBuildMessage messageWithType:XDTBuildMessageTypeStatus requestID:0] error:error];
+    NSData *data = [reply firstDataOfField:XDTBuildFieldStatus];
+    if (nil == data) {
+        return nil;
+    }
+    return [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:error];
+}
+
+
+#pragma mark - Private Methods
+
+
+- (XDTBuildResult *)resultOfRequest:(XDTBuildMessageType)type forFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options error:(NSError **)error
+{
+    XDTBuildMessage *request = [XDTBuildMessage messageWithType:type requestID:0];
+    [request addField:XDTBuildFieldSourcePath string:[[fileURL URLByStandardizingPath] path]];
+    [request addOptions:options];
+
+    XDTBuildMessage *reply = [self sendRequest:request error:error];
+    if (nil == reply) {
+        return nil;
+    }
+    XDTBuildResult *retVal = [[XDTBuildResult alloc] initWithReply:reply];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+/* Returns the reply to the request, or nil when the transport failed or the server reported an error. */
+- (XDTBuildMessage *)sendRequest:(XDTBuildMessage *)request error:(NSError **)error
+{
+    XDTBuildMessage *reply = nil;
+    @synchronized (self) {
+        XDTBuildMessage *numberedRequest = [XDTBuildMessage messageWithMessage:request requestID:++_lastRequestID];
+        if (![numberedRequest writeToSocket:_socket error:error]) {
+            return nil;
+        }
+        reply = [XDTBuildMessage messageReadFromSocket:_socket error:error];
+        if (nil == reply) {
+            return nil;
+        }
+        if (XDTBuildMessageTypeReply != reply.type || _lastRequestID != reply.requestID) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            NSDictionary *errorDict = @{
+                                        NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Invalid build server message", nil, myBundle, @"Description for an error object, discribing that a message on the socket of the build server does not follow its protocol."),
+                                        NSLocalizedRecoverySuggestionErrorKey: NSLocalizedStringFromTableInBundle(@"Client and build server must use the same version of XDTools99.", nil, myBundle, @"Recovery suggestion for an error object, which explains that client and build server must use the same protocol.")
+                                        };
+            if (nil != error) {
+                *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException userInfo:errorDict];
+            }
+            return nil;
+        }
+    }
+
+    NSError *replyError = [reply error];
+    if (nil != replyError) {
+        if (nil != error) {
+            XDTMessage *messages = [reply messages];
+            if (nil != messages) {
+                NSMutableDictionary *errorDict = [NSMutableDictionary dictionaryWithDictionary:[replyError userInfo]];
+                [errorDict setObject:messages forKey:XDTBuildErrorMessagesKey];
+                replyError = [NSError errorWithDomain:[replyError domain] code:[replyError code] userInfo:errorDict];
+            }
+            *error = replyError;
+        }
+        return nil;
+    }
+    return reply;
+}
+
+@end
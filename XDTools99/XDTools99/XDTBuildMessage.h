@@ -0,0 +1,104 @@
+//
+//  XDTBuildMessage.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+
+#define XDTBuildProtocolVersion 1
+
+/* Fields with more bytes are handed over in shared memory instead of being copied through the socket */
+#define XDTBuildSharedMemoryThreshold (64 * 1024)
+
+
+typedef NS_ENUM(uint16_t, XDTBuildMessageType) {
+    XDTBuildMessageTypeStatus = 1,          /* Counters of the server, the request has no fields */
+    XDTBuildMessageTypeAssemble = 2,        /* Assembling a source file with xas99 and generating its target */
+    XDTBuildMessageTypeAssembleGPL = 3,     /* Assembling a source file with xga99 and generating its target */
+    XDTBuildMessageTypeParseBasic = 4,      /* Tokenizing a BASIC source file with xbas99 */
+    XDTBuildMessageTypeLoadBasic = 5,       /* Listing a tokenized BASIC program file with xbas99 */
+
+    XDTBuildMessageTypeReply = 0x80,        /* The answer to any of the requests above */
+};
+
+typedef NS_ENUM(uint16_t, XDTBuildField) {
+    XDTBuildFieldSourcePath = 1,            /* UTF-8 path of the file to process */
+    XDTBuildFieldOption = 2,                /* UTF-8 option key, NUL, a type character 'i' or 's', the int64 or UTF-8 value */
+    XDTBuildFieldOutput = 3,                /* A generated file, repeated in the order of generation */
+    XDTBuildFieldOutputName = 4,            /* UTF-8 name (or name suffix) of the output with the same index */
+    XDTBuildFieldListing = 5,               /* The listing of the assembler */
+    XDTBuildFieldMessages = 6,              /* Binary property list with the errors and warnings of the tool */
+    XDTBuildFieldCached = 7,                /* int64, 1 if the reply was taken from the cache of the server */
+    XDTBuildFieldErrorCode = 8,             /* int64 XDTErrorCode, only present if the request failed */
+    XDTBuildFieldErrorDescription = 9,      /* UTF-8 localized description of the error */
+    XDTBuildFieldErrorSuggestion = 10,      /* UTF-8 localized recovery suggestion of the error */
+    XDTBuildFieldStatus = 11,               /* Binary property list with the counters of the server */
+};
+
+
+@class XDTMessage;
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A request to or a reply from the build server xdt99d.
+
+ On the socket every message starts with a header of 16 bytes, all numbers are little endian:
+    "XDT", version (uint8), type (uint16), field count (uint16), request ID (uint32), payload length (uint32)
+ The payload follows with the fields one after another, each with a header of 8 bytes:
+    tag (uint16), flags (uint16), data length (uint32), data
+ Fields which are larger than XDTBuildSharedMemoryThreshold have the flag 1 set and no data in the payload. Their
+ data is written into an anonymous shared memory object instead, whose file descriptor is passed along with the
+ header (SCM_RIGHTS) in the order of the fields. The receiver maps it read only, so a large image is not copied.
+ */
+@interface XDTBuildMessage : NSObject
+
+@property (readonly) XDTBuildMessageType type;
+@property (readonly) uint32_t requestID;
+@property (readonly) NSUInteger payloadLength;    /* All data of the fields, also that in shared memory */
+
++ (instancetype)messageWithType:(XDTBuildMessageType)type requestID:(uint32_t)requestID;
++ (instancetype)messageWithMessage:(XDTBuildMessage *)message requestID:(uint32_t)requestID;
++ (nullable instancetype)messageReadFromSocket:(int)socket error:(NSError **)error;
+
+- (void)addField:(XDTBuildField)field data:(NSData *)data;
+- (void)addField:(XDTBuildField)field string:(NSString *)string;
+- (void)addField:(XDTBuildField)field integer:(int64_t)value;
+- (void)addOptions:(NSDictionary<NSString *, id> *)options;   /* Only values of NSNumber and NSString are sent */
+- (void)addMessages:(nullable XDTMessage *)messages;
+- (void)addError:(NSError *)error;
+
+- (NSArray<NSData *> *)dataOfField:(XDTBuildField)field;
+- (nullable NSData *)firstDataOfField:(XDTBuildField)field;
+- (nullable NSString *)stringOfField:(XDTBuildField)field;
+- (int64_t)integerOfField:(XDTBuildField)field defaultValue:(int64_t)defaultValue;
+- (NSDictionary<NSString *, id> *)options;
+- (nullable XDTMessage *)messages;
+- (nullable NSError *)error;
+
+- (BOOL)writeToSocket:(int)socket error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
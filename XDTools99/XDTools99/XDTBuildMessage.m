@@ -0,0 +1,707 @@
+//
+//  XDTBuildMessage.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTBuildMessage.h"
+
+#import "XDTObject.h"
+#import "XDTMessage.h"
+
+#include <libkern/OSAtomic.h>
+#include <libkern/OSByteOrder.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+
+#define XDTBuildHeaderSize 16
+#define XDTBuildFieldHeaderSize 8
+#define XDTBuildFieldFlagShared 1
+#define XDTBuildMaxSharedFields 16
+#define XDTBuildMaxPayloadLength (256 * 1024 * 1024)
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface XDTMessage ()
+
+- (instancetype)initWithSet:(NSOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *)messageArray;
+
+@end
+
+
+/* Read only mapping of a shared memory object, unmapped when the data is released. */
+@interface XDTBuildMappedData : NSData {
+    void *_mappedBytes;
+    NSUInteger _mappedLength;
+}
+
+- (nullable instancetype)initWithFileDescriptor:(int)fd length:(NSUInteger)length;
+
+@end
+
+
+@interface XDTBuildMessage () {
+    NSMutableArray<NSNumber *> *_fieldTags;
+    NSMutableArray<NSData *> *_fieldValues;
+}
+
+- (instancetype)initWithType:(XDTBuildMessageType)type requestID:(uint32_t)requestID;
+
++ (NSMutableDictionary<NSString *, id> *)propertyListOfMessage:(NSDictionary<XDTMessageTypeKey, id> *)message;
++ (NSMutableDictionary<XDTMessageTypeKey, id> *)messageOfPropertyList:(NSDictionary<NSString *, id> *)entry;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static NSError *XDTBuildPOSIXError(void)
+{
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+}
+
+
+static NSError *XDTBuildProtocolError(void)
+{
+    NSBundle *myBundle = [NSBundle bundleForClass:[XDTBuildMessage class]];
+    NSDictionary *errorDict = @{
+                                NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Invalid build server message", nil, myBundle, @"Description for an error object, discribing that a message on the socket of the build server does not follow its protocol."),
+                                NSLocalizedRecoverySuggestionErrorKey: NSLocalizedStringFromTableInBundle(@"Client and build server must use the same version of XDTools99.", nil, myBundle, @"Recovery suggestion for an error object, which explains that client and build server must use the same protocol.")
+                                };
+    return [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException userInfo:errorDict];
+}
+
+
+/* Reads exactly length bytes, a closed connection is reported as ECONNRESET. */
+static BOOL XDTBuildReadFully(int socket, void *buffer, size_t length)
+{
+    uint8_t *bytes = buffer;
+    while (0 < length) {
+        const ssize_t count = read(socket, bytes, length);
+        if (0 > count && EINTR == errno) {
+            continue;
+        }
+        if (0 >= count) {
+            if (0 == count) {
+                errno = ECONNRESET;
+            }
+            return NO;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return YES;
+}
+
+
+static BOOL XDTBuildWriteFully(int socket, const void *buffer, size_t length)
+{
+    const uint8_t *bytes = buffer;
+    while (0 < length) {
+        const ssize_t count = write(socket, bytes, length);
+        if (0 > count && EINTR == errno) {
+            continue;
+        }
+        if (0 > count) {
+            return NO;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return YES;
+}
+
+
+/* Returns a descriptor of an anonymous shared memory object with a copy of the data, or -1. */
+static int XDTBuildCreateSharedMemory(NSData *data)
+{
+    static int32_t sequenceNumber = 0;
+    char name[32];
+    snprintf(name, sizeof(name), "/xdt99d.%d.%d", getpid(), OSAtomicIncrement32(&sequenceNumber));
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (0 > fd) {
+        return -1;
+    }
+    shm_unlink(name);   /* only the descriptor keeps the object alive */
+
+    if (0 != ftruncate(fd, [data length])) {
+        close(fd);
+        return -1;
+    }
+    void *bytes = mmap(NULL, [data length], PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == bytes) {
+        close(fd);
+        return -1;
+    }
+    memcpy(bytes, [data bytes], [data length]);
+    munmap(bytes, [data length]);
+
+    return fd;
+}
+
+
+@implementation XDTBuildMappedData
+
+- (instancetype)initWithFileDescriptor:(int)fd length:(NSUInteger)length
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    /* A shared memory object shorter than the length its peer claims would raise SIGBUS on the first read */
+    struct stat fileStat;
+    BOOL isValid = (0 < length && 0 == fstat(fd, &fileStat));    /* fstat() sets errno when it fails */
+    if (isValid && (0 > fileStat.st_size || (unsigned long long)fileStat.st_size < length)) {
+        isValid = NO;
+        errno = EINVAL;
+    } else if (0 == length) {
+        errno = EINVAL;
+    }
+    if (!isValid) {
+#if !__has_feature(objc_arc)
+        [self release];
+#endif
+        return nil;
+    }
+
+    _mappedLength = length;
+    _mappedBytes = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == _mappedBytes) {
+        _mappedBytes = NULL;
+#if !__has_feature(objc_arc)
+        [self release];
+#endif
+        return nil;
+    }
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    if (NULL != _mappedBytes) {
+        munmap(_mappedBytes, _mappedLength);
+    }
+#if !__has_feature(objc_arc)
+    [super dealloc];
+#endif
+}
+
+
+- (NSUInteger)length
+{
+    return _mappedLength;
+}
+
+
+- (const void *)bytes
+{
+    return _mappedBytes;
+}
+
+@end
+
+
+@implementation XDTBuildMessage
+
+#pragma mark Initializers
+
++ (instancetype)messageWithType:(XDTBuildMessageType)type requestID:(uint32_t)requestID
+{
+    XDTBuildMessage *retVal = [[XDTBuildMessage alloc] initWithType:type requestID:requestID];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
++ (instancetype)messageWithMessage:(XDTBuildMessage *)message requestID:(uint32_t)requestID
+{
+    XDTBuildMessage *retVal = [XDTBuildMessage messageWithType:message.type requestID:requestID];
+    [retVal->_fieldTags addObjectsFromArray:message->_fieldTags];
+    [retVal->_fieldValues addObjectsFromArray:message->_fieldValues];
+    return retVal;
+}
+
+
+- (instancetype)initWithType:(XDTBuildMessageType)type requestID:(uint32_t)requestID
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _type = type;
+    _requestID = requestID;
+    _fieldTags = [[NSMutableArray alloc] init];
+    _fieldValues = [[NSMutableArray alloc] init];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_fieldTags release];
+    [_fieldValues release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Socket I/O
+
+
++ (instancetype)messageReadFromSocket:(int)socket error:(NSError **)error
+{
+    uint8_t header[XDTBuildHeaderSize];
+    int sharedFDs[XDTBuildMaxSharedFields];
+    NSUInteger sharedCount = 0;
+
+    /* The descriptors of the shared memory arrive with the first bytes of the header */
+    union {
+        struct cmsghdr header;
+        uint8_t buffer[CMSG_SPACE(sizeof(sharedFDs))];
+    } control;
+    struct iovec iov = { .iov_base = header, .iov_len = sizeof(header) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1, .msg_control = control.buffer, .msg_controllen = sizeof(control.buffer) };
+    ssize_t count;
+    do {
+        count = recvmsg(socket, &msg, 0);
+    } while (0 > count && EINTR == errno);
+    if (0 >= count) {
+        if (0 == count) {
+            errno = ECONNRESET;
+        }
+        if (nil != error) {
+            *error = XDTBuildPOSIXError();
+        }
+        return nil;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); NULL != cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (SOL_SOCKET == cmsg->cmsg_level && SCM_RIGHTS == cmsg->cmsg_type) {
+            const NSUInteger fdCount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (NSUInteger i = 0; i < fdCount && sharedCount < XDTBuildMaxSharedFields; i++) {
+                memcpy(&sharedFDs[sharedCount++], CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            }
+        }
+    }
+
+    XDTBuildMessage *retVal = nil;
+    NSError *tempError = nil;
+    NSUInteger sharedIndex = 0;
+    do {
+        if (XDTBuildHeaderSize > count && !XDTBuildReadFully(socket, header + count, XDTBuildHeaderSize - count)) {
+            tempError = XDTBuildPOSIXError();
+            break;
+        }
+        const uint32_t payloadLength = OSReadLittleInt32(header, 12);
+        if (0 != memcmp(header, "XDT", 3) || XDTBuildProtocolVersion != header[3] || XDTBuildMaxPayloadLength < payloadLength) {
+            tempError = XDTBuildProtocolError();
+            break;
+        }
+        NSMutableData *payload = [NSMutableData dataWithLength:payloadLength];
+        if (!XDTBuildReadFully(socket, [payload mutableBytes], payloadLength)) {
+            tempError = XDTBuildPOSIXError();
+            break;
+        }
+
+        retVal = [XDTBuildMessage messageWithType:OSReadLittleInt16(header, 4) requestID:OSReadLittleInt32(header, 8)];
+        const NSUInteger fieldCount = OSReadLittleInt16(header, 6);
+        const uint8_t *bytes = [payload bytes];
+        NSUInteger offset = 0;
+        for (NSUInteger i = 0; i < fieldCount && nil == tempError; i++) {
+            if (payloadLength < offset + XDTBuildFieldHeaderSize) {
+                tempError = XDTBuildProtocolError();
+                break;
+            }
+            const uint16_t tag = OSReadLittleInt16(bytes, offset);
+            const uint16_t flags = OSReadLittleInt16(bytes, offset + 2);
+            const uint32_t length = OSReadLittleInt32(bytes, offset + 4);
+            offset += XDTBuildFieldHeaderSize;
+
+            NSData *value = nil;
+            if (XDTBuildFieldFlagShared & flags) {
+                if (sharedIndex >= sharedCount) {
+                    tempError = XDTBuildProtocolError();
+                    break;
+                }
+                value = [[XDTBuildMappedData alloc] initWithFileDescriptor:sharedFDs[sharedIndex++] length:length];
+#if !__has_feature(objc_arc)
+                [value autorelease];
+#endif
+                if (nil == value) {
+                    tempError = XDTBuildPOSIXError();
+                }
+            } else if (payloadLength < offset + length) {
+                tempError = XDTBuildProtocolError();
+            } else {
+                value = [payload subdataWithRange:NSMakeRange(offset, length)];
+                offset += length;
+            }
+            if (nil != value) {
+                [retVal addField:tag data:value];
+            }
+        }
+    } while (NO);
+
+    /* The mappings stay valid without the descriptors */
+    for (NSUInteger i = 0; i < sharedCount; i++) {
+        close(sharedFDs[i]);
+    }
+    if (nil != tempError) {
+        if (nil != error) {
+            *error = tempError;
+        }
+        return nil;
+    }
+    return retVal;
+}
+
+
+- (BOOL)writeToSocket:(int)socket error:(NSError **)error
+{
+    int sharedFDs[XDTBuildMaxSharedFields];
+    NSUInteger sharedCount = 0;
+
+    NSMutableData *payload = [NSMutableData data];
+    const NSUInteger fieldCount = [_fieldTags count];
+    for (NSUInteger i = 0; i < fieldCount; i++) {
+        NSData *value = [_fieldValues objectAtIndex:i];
+        uint16_t flags = 0;
+        if (XDTBuildSharedMemoryThreshold < [value length] && XDTBuildMaxSharedFields > sharedCount) {
+            const int fd = XDTBuildCreateSharedMemory(value);
+            if (0 <= fd) {
+                sharedFDs[sharedCount++] = fd;
+                flags = XDTBuildFieldFlagShared;
+            }
+        }
+
+        uint8_t fieldHeader[XDTBuildFieldHeaderSize];
+        OSWriteLittleInt16(fieldHeader, 0, [[_fieldTags objectAtIndex:i] unsignedShortValue]);
+        OSWriteLittleInt16(fieldHeader, 2, flags);
+        OSWriteLittleInt32(fieldHeader, 4, (uint32_t)[value length]);
+        [payload appendBytes:fieldHeader length:sizeof(fieldHeader)];
+        if (0 == (XDTBuildFieldFlagShared & flags)) {
+            [payload appendData:value];
+        }
+    }
+
+    uint8_t header[XDTBuildHeaderSize];
+    memcpy(header, "XDT", 3);
+    header[3] = XDTBuildProtocolVersion;
+    OSWriteLittleInt16(header, 4, _type);
+    OSWriteLittleInt16(header, 6, (uint16_t)fieldCount);
+    OSWriteLittleInt32(header, 8, _requestID);
+    OSWriteLittleInt32(header, 12, (uint32_t)[payload length]);
+
+    union {
+        struct cmsghdr header;
+        uint8_t buffer[CMSG_SPACE(sizeof(sharedFDs))];
+    } control;
+    struct iovec iov = { .iov_base = header, .iov_len = sizeof(header) };
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+    if (0 < sharedCount) {
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = (socklen_t)CMSG_SPACE(sharedCount * sizeof(int));
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = (socklen_t)CMSG_LEN(sharedCount * sizeof(int));
+        memcpy(CMSG_DATA(cmsg), sharedFDs, sharedCount * sizeof(int));
+    }
+
+    ssize_t count;
+    do {
+        count = sendmsg(socket, &msg, 0);
+    } while (0 > count && EINTR == errno);
+    BOOL retVal = 0 <= count;
+    if (retVal && XDTBuildHeaderSize > count) {
+        retVal = XDTBuildWriteFully(socket, header + count, XDTBuildHeaderSize - count);
+    }
+    if (retVal) {
+        retVal = XDTBuildWriteFully(socket, [payload bytes], [payload length]);
+    }
+    if (!retVal && nil != error) {
+        *error = XDTBuildPOSIXError();
+    }
+
+    /* The receiver got its own descriptors */
+    for (NSUInteger i = 0; i < sharedCount; i++) {
+        close(sharedFDs[i]);
+    }
+    return retVal;
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSUInteger)payloadLength
+{
+    return [[_fieldValues valueForKeyPath:@"@sum.length"] unsignedIntegerValue];
+}
+
+
+- (void)addField:(XDTBuildField)field data:(NSData *)data
+{
+    [_fieldTags addObject:[NSNumber numberWithUnsignedShort:field]];
+    [_fieldValues addObject:data];
+}
+
+
+- (void)addField:(XDTBuildField)field string:(NSString *)string
+{
+    [self addField:field data:[string dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+
+- (void)addField:(XDTBuildField)field integer:(int64_t)value
+{
+    uint8_t bytes[sizeof(int64_t)];
+    OSWriteLittleInt64(bytes, 0, value);
+    [self addField:field data:[NSData dataWithBytes:bytes length:sizeof(bytes)]];
+}
+
+
+/*
+ Options are sorted by their key, so the same options always give the same request. The server uses the request
+ as part of the key for its cache of results.
+ */
+- (void)addOptions:(NSDictionary<NSString *, id> *)options
+{
+    for (NSString *key in [[options allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        id value = [options objectForKey:key];
+        NSMutableData *data = [NSMutableData dataWithData:[key dataUsingEncoding:NSUTF8StringEncoding]];
+        if ([value isKindOfClass:[NSNumber class]]) {
+            uint8_t bytes[2 + sizeof(int64_t)] = { 0, 'i' };
+            OSWriteLittleInt64(bytes, 2, [value longLongValue]);
+            [data appendBytes:bytes length:sizeof(bytes)];
+        } else if ([value isKindOfClass:[NSString class]]) {
+            [data appendBytes:"\0s" length:2];
+            [data appendData:[value dataUsingEncoding:NSUTF8StringEncoding]];
+        } else {
+            continue;   /* i.e. an instrumentation object, which cannot cross the process boundary */
+        }
+        [self addField:XDTBuildFieldOption data:data];
+    }
+}
+
+
+- (void)addMessages:(XDTMessage *)messages
+{
+    if (nil == messages || 0 == [messages count]) {
+        return;
+    }
+
+    NSMutableArray<NSDictionary<NSString *, id> *> *messageList = [NSMutableArray arrayWithCapacity:[messages count]];
+    [messages enumerateMessagesUsingBlock:^(NSDictionary<XDTMessageTypeKey, id> *obj, BOOL *stop) {
+        NSMutableDictionary<NSString *, id> *entry = [XDTBuildMessage propertyListOfMessage:obj];
+        NSArray<NSDictionary<XDTMessageTypeKey, id> *> *locations = [obj objectForKey:XDTMessageLocations];
+        if (nil != locations) {
+            /* The locations of aggregated messages are messages of their own */
+            NSMutableArray<NSDictionary<NSString *, id> *> *locationList = [NSMutableArray arrayWithCapacity:[locations count]];
+            for (NSDictionary<XDTMessageTypeKey, id> *location in locations) {
+                [locationList addObject:[XDTBuildMessage propertyListOfMessage:location]];
+            }
+            [entry setObject:locationList forKey:XDTMessageLocations];
+        }
+        [messageList addObject:entry];
+    }];
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:messageList format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    if (nil != data) {
+        [self addField:XDTBuildFieldMessages data:data];
+    }
+}
+
+
+- (void)addError:(NSError *)error
+{
+    /* Errors of other domains, i.e. of reading the source file, are reported as exception of the tool */
+    [self addField:XDTBuildFieldErrorCode integer:[XDTErrorDomain isEqualToString:[error domain]]? [error code] : XDTErrorCodeToolException];
+    [self addField:XDTBuildFieldErrorDescription string:[error localizedDescription]];
+    if (nil != [error localizedRecoverySuggestion]) {
+        [self addField:XDTBuildFieldErrorSuggestion string:[error localizedRecoverySuggestion]];
+    } else if (nil != [error localizedFailureReason]) {
+        [self addField:XDTBuildFieldErrorSuggestion string:[error localizedFailureReason]];
+    }
+}
+
+
+- (NSArray<NSData *> *)dataOfField:(XDTBuildField)field
+{
+    NSMutableArray<NSData *> *retVal = [NSMutableArray array];
+    const NSUInteger fieldCount = [_fieldTags count];
+    for (NSUInteger i = 0; i < fieldCount; i++) {
+        if (field == [[_fieldTags objectAtIndex:i] unsignedShortValue]) {
+            [retVal addObject:[_fieldValues objectAtIndex:i]];
+        }
+    }
+    return retVal;
+}
+
+
+- (NSData *)firstDataOfField:(XDTBuildField)field
+{
+    NSUInteger index = [_fieldTags indexOfObject:[NSNumber numberWithUnsignedShort:field]];
+    return (NSNotFound == index)? nil : [_fieldValues objectAtIndex:index];
+}
+
+
+- (NSString *)stringOfField:(XDTBuildField)field
+{
+    NSData *data = [self firstDataOfField:field];
+    if (nil == data) {
+        return nil;
+    }
+    NSString *retVal = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (int64_t)integerOfField:(XDTBuildField)field defaultValue:(int64_t)defaultValue
+{
+    NSData *data = [self firstDataOfField:field];
+    if (sizeof(int64_t) != [data length]) {
+        return defaultValue;
+    }
+    return OSReadLittleInt64([data bytes], 0);
+}
+
+
+- (NSDictionary<NSString *, id> *)options
+{
+    NSMutableDictionary<NSString *, id> *retVal = [NSMutableDictionary dictionary];
+    for (NSData *data in [self dataOfField:XDTBuildFieldOption]) {
+        const char *bytes = [data bytes];
+        const char *separator = memchr(bytes, '\0', [data length]);
+        if (NULL == separator || (NSUInteger)(separator - bytes) + 2 > [data length]) {
+            continue;
+        }
+        NSString *key = [[NSString alloc] initWithBytes:bytes length:separator - bytes encoding:NSUTF8StringEncoding];
+#if !__has_feature(objc_arc)
+        [key autorelease];
+#endif
+        const char *value = separator + 2;
+        const NSUInteger valueLength = [data length] - (value - bytes);
+        if ('i' == separator[1] && sizeof(int64_t) == valueLength) {
+            [retVal setValue:[NSNumber numberWithLongLong:OSReadLittleInt64(value, 0)] forKey:key];
+        } else if ('s' == separator[1]) {
+            NSString *string = [[NSString alloc] initWithBytes:value length:valueLength encoding:NSUTF8StringEncoding];
+#if !__has_feature(objc_arc)
+            [string autorelease];
+#endif
+            [retVal setValue:string forKey:key];
+        }
+    }
+    return retVal;
+}
+
+
+- (XDTMessage *)messages
+{
+    NSData *data = [self firstDataOfField:XDTBuildFieldMessages];
+    if (nil == data) {
+        return nil;
+    }
+    NSArray<NSDictionary<NSString *, id> *> *messageList = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil];
+    if (![messageList isKindOfClass:[NSArray class]]) {
+        return nil;
+    }
+
+    NSMutableOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *messageSet = [NSMutableOrderedSet orderedSetWithCapacity:[messageList count]];
+    for (NSDictionary<NSString *, id> *entry in messageList) {
+        NSMutableDictionary<XDTMessageTypeKey, id> *message = [XDTBuildMessage messageOfPropertyList:entry];
+        NSArray<NSDictionary<NSString *, id> *> *locationList = [entry objectForKey:XDTMessageLocations];
+        if ([locationList isKindOfClass:[NSArray class]]) {
+            NSMutableArray<NSDictionary<XDTMessageTypeKey, id> *> *locations = [NSMutableArray arrayWithCapacity:[locationList count]];
+            for (NSDictionary<NSString *, id> *location in locationList) {
+                [locations addObject:[XDTBuildMessage messageOfPropertyList:location]];
+            }
+            [message setObject:locations forKey:XDTMessageLocations];
+        }
+        [messageSet addObject:message];
+    }
+    XDTMessage *retVal = [[XDTMessage alloc] initWithSet:messageSet];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (NSError *)error
+{
+    NSData *data = [self firstDataOfField:XDTBuildFieldErrorCode];
+    if (nil == data) {
+        return nil;
+    }
+
+    NSMutableDictionary *errorDict = [NSMutableDictionary dictionaryWithCapacity:2];
+    [errorDict setValue:[self stringOfField:XDTBuildFieldErrorDescription] forKey:NSLocalizedDescriptionKey];
+    [errorDict setValue:[self stringOfField:XDTBuildFieldErrorSuggestion] forKey:NSLocalizedRecoverySuggestionErrorKey];
+    return [NSError errorWithDomain:XDTErrorDomain code:[self integerOfField:XDTBuildFieldErrorCode defaultValue:XDTErrorCodeToolException] userInfo:errorDict];
+}
+
+
+#pragma mark - Private Methods
+
+
+/* Property lists cannot contain URLs and nulls, so file URLs are sent as paths and nulls are left out. */
++ (NSMutableDictionary<NSString *, id> *)propertyListOfMessage:(NSDictionary<XDTMessageTypeKey, id> *)message
+{
+    NSMutableDictionary<NSString *, id> *retVal = [NSMutableDictionary dictionaryWithCapacity:[message count]];
+    [message enumerateKeysAndObjectsUsingBlock:^(XDTMessageTypeKey key, id value, BOOL *stop) {
+        if ([value isKindOfClass:[NSURL class]]) {
+            [retVal setObject:[(NSURL *)value path] forKey:key];
+        } else if (![value isKindOfClass:[NSNull class]] && ![XDTMessageLocations isEqualToString:key]) {
+            [retVal setObject:value forKey:key];
+        }
+    }];
+    return retVal;
+}
+
+
++ (NSMutableDictionary<XDTMessageTypeKey, id> *)messageOfPropertyList:(NSDictionary<NSString *, id> *)entry
+{
+    NSMutableDictionary<XDTMessageTypeKey, id> *retVal = [NSMutableDictionary dictionaryWithDictionary:entry];
+    NSString *path = [entry objectForKey:XDTMessageFileURL];
+    if (nil != path) {
+        [retVal setObject:[NSURL fileURLWithPath:path] forKey:XDTMessageFileURL];
+    }
+    return retVal;
+}
+
+@end
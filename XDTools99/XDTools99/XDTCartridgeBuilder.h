@@ -0,0 +1,82 @@
+//
+//  XDTCartridgeBuilder.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+#define XDTCartridgeROMAddress 0x6000
+#define XDTCartridgeBankSize 0x2000         /* Every ROM bank is mapped to >6000->7FFF */
+#define XDTCartridgeGROMSize 0xA000         /* GROM 3 to 7, from >6000 to >FFFF */
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Builds a cartridge package (RPK) for MESS from ROM banks and a GROM image, without Python.
+
+ The package is a zip archive with the images of the ROM and the GROM, `layout.xml`, which tells MESS the type of
+ the board and which image belongs into which socket, and `meta-inf.xml` with the name of the cartridge. One ROM bank
+ is a standard board, two banks are the paged board of TI with one image for each bank, and more banks are a paged
+ 378 board with all banks in one image, padded to a power of two.
+
+ Writing streams the images bank by bank into the package, so neither the images nor the package are copied into
+ one buffer. The CRC of each file is computed while it is written and patched into its header afterwards.
+ */
+@interface XDTCartridgeBuilder : NSObject
+
+@property (readonly) NSString *name;
+@property (readonly) NSUInteger romBankCount;
+@property (readonly, nullable) NSData *gromImage;
+
++ (instancetype)cartridgeBuilderWithName:(NSString *)name;
+
+/*
+ Header of a ROM cartridge at >6000 with a program list of one program, like the header of GPL images:
+    >AA, version 1, one program, reserved, power up list, program list at >6010, DSR list, subprogram list, interrupt list
+    link to the next program (none), entry address, length of the name, name
+ The code of relocatable programs follows at the next even address, returns nil if the name does not fit.
+ */
++ (nullable NSData *)romHeaderWithName:(NSString *)name entryAddress:(NSUInteger)entryAddress;
++ (NSUInteger)codeAddressAfterROMHeaderWithName:(NSString *)name;
+
+- (BOOL)addROMBank:(NSData *)bank error:(NSError **)error;         /* Up to 8 KB, shorter banks are padded */
+/* Binaries in the format of -[XDTAs99Objcode generateRawBinaryAt:error:], segments outside of >6000->7FFF are refused */
+- (BOOL)addROMBinaries:(NSArray<NSArray<id> *> *)binaries error:(NSError **)error;
+- (BOOL)setGROMImage:(NSData *)image address:(NSUInteger)address error:(NSError **)error;
+
+- (NSData *)layoutData;
+- (NSData *)metaInfData;
+
+/* File names and contents of the package, as -[XDTAs99Objcode generateMESSCartridgeWithName:error:] returns them */
+- (NSDictionary<NSString *, NSData *> *)packageContents;
+
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error;
+
+/* Writes the package contents of the Python tools the same way */
++ (BOOL)writePackageContents:(NSDictionary<NSString *, NSData *> *)contents toURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,530 @@
+//
+//  XDTCartridgeBuilder.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTCartridgeBuilder.h"
+
+#import "XDTObject.h"
+
+#include <libkern/OSByteOrder.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+
+#define XDTCartridgeProgramList 0x6010
+#define XDTCartridgeMaxBanks 64             /* 512 KB on a paged 378 board */
+
+#define XDTZipLocalHeaderSize 30
+#define XDTZipCentralHeaderSize 46
+#define XDTZipEndRecordSize 22
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface XDTCartridgeBuilder () {
+    NSMutableArray<NSData *> *_romBanks;
+    NSUInteger _gromAddress;
+}
+
+- (instancetype)initWithName:(NSString *)name;
+
+/*
+ Each file of the package: its name and its parts, which are NSData or NSNumber with a number of zero bytes.
+ The images are followed by the identifier of their resource and of their socket on the board.
+ */
+- (NSArray<NSArray *> *)imageFiles;
+- (NSArray<NSArray *> *)packageFiles;
+
++ (BOOL)writePackageFiles:(NSArray<NSArray *> *)files toURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static NSError *XDTCartridgeError(NSString *description, NSString *suggestion)
+{
+    return [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeCartridge
+                           userInfo:@{NSLocalizedDescriptionKey: description, NSLocalizedRecoverySuggestionErrorKey: suggestion}];
+}
+
+
+static const uint8_t XDTZeroBytes[4096] = {0};
+
+
+static uint32_t XDTUpdateCRC32(uint32_t crc, const uint8_t *bytes, size_t length)
+{
+    static uint32_t table[256];
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1)? 0xEDB88320 ^ (value >> 1) : value >> 1;
+            }
+            table[i] = value;
+        }
+    });
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+
+/* Writes all bytes, also when the system writes them in several parts */
+static BOOL XDTWriteBytes(int fd, const void *bytes, size_t length)
+{
+    const uint8_t *next = bytes;
+    while (0 < length) {
+        const ssize_t count = write(fd, next, length);
+        if (0 > count) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return NO;
+        }
+        next += count;
+        length -= count;
+    }
+    return YES;
+}
+
+
+/* Escapes the name for the attributes and elements of the XML files */
+static NSString *XDTEscapedXMLString(NSString *string)
+{
+    NSMutableString *retVal = [NSMutableString stringWithString:string];
+    [retVal replaceOccurrencesOfString:@"&" withString:@"&amp;" options:0 range:NSMakeRange(0, [retVal length])];
+    [retVal replaceOccurrencesOfString:@"<" withString:@"&lt;" options:0 range:NSMakeRange(0, [retVal length])];
+    [retVal replaceOccurrencesOfString:@">" withString:@"&gt;" options:0 range:NSMakeRange(0, [retVal length])];
+    [retVal replaceOccurrencesOfString:@"\"" withString:@"&quot;" options:0 range:NSMakeRange(0, [retVal length])];
+    return retVal;
+}
+
+
+@implementation XDTCartridgeBuilder
+
+#pragma mark Initializers
+
+
++ (instancetype)cartridgeBuilderWithName:(NSString *)name
+{
+    XDTCartridgeBuilder *retVal = [[XDTCartridgeBuilder alloc] initWithName:name];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithName:(NSString *)name
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _name = [name copy];
+    _romBanks = [[NSMutableArray alloc] init];
+    _gromImage = nil;
+    _gromAddress = XDTCartridgeROMAddress;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_name release];
+    [_romBanks release];
+    [_gromImage release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - ROM Header
+
+
++ (NSUInteger)codeAddressAfterROMHeaderWithName:(NSString *)name
+{
+    NSData *nameData = [name dataUsingEncoding:NSISOLatin1StringEncoding allowLossyConversion:YES];
+    return (XDTCartridgeProgramList + 5 + [nameData length] + 1) & ~1UL;
+}
+
+
++ (NSData *)romHeaderWithName:(NSString *)name entryAddress:(NSUInteger)entryAddress
+{
+    NSData *nameData = [name dataUsingEncoding:NSISOLatin1StringEncoding allowLossyConversion:YES];
+    const NSUInteger headerLength = [self codeAddressAfterROMHeaderWithName:name] - XDTCartridgeROMAddress;
+    if (nil == nameData || 0xFF < [nameData length] || XDTCartridgeBankSize < headerLength) {
+        return nil;
+    }
+
+    NSMutableData *retVal = [NSMutableData dataWithLength:headerLength];
+    uint8_t *header = [retVal mutableBytes];
+    const uint8_t standardHeader[8] = {0xAA, 0x01, 0x01, 0x00, 0x00, 0x00, XDTCartridgeProgramList >> 8, XDTCartridgeProgramList & 0xFF};
+    memcpy(header, standardHeader, sizeof(standardHeader));
+    header[0x12] = (entryAddress >> 8) & 0xFF;
+    header[0x13] = entryAddress & 0xFF;
+    header[0x14] = (uint8_t)[nameData length];
+    memcpy(header + 0x15, [nameData bytes], [nameData length]);
+    return retVal;
+}
+
+
+#pragma mark - Adding Images
+
+
+- (NSUInteger)romBankCount
+{
+    return [_romBanks count];
+}
+
+
+- (BOOL)addROMBank:(NSData *)bank error:(NSError **)error
+{
+    if (XDTCartridgeBankSize < [bank length] || XDTCartridgeMaxBanks <= [_romBanks count]) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            *error = XDTCartridgeError(NSLocalizedStringFromTableInBundle(@"ROM bank does not fit", nil, myBundle, @"Description for an error object, discribing that a ROM bank is too large for a cartridge."),
+                                       NSLocalizedStringFromTableInBundle(@"Cartridges have up to 64 ROM banks of 8 KB, which are mapped to >6000->7FFF.", nil, myBundle, @"Recovery suggestion for an error object, which explains the size of ROM banks of cartridges."));
+        }
+        return NO;
+    }
+    [_romBanks addObject:[bank copy]];
+#if !__has_feature(objc_arc)
+    [[_romBanks lastObject] release];
+#endif
+    return YES;
+}
+
+
+/* Segments of the same bank are combined into one bank, the banks follow the banks which were added before */
+- (BOOL)addROMBinaries:(NSArray<NSArray<id> *> *)binaries error:(NSError **)error
+{
+    NSMutableDictionary<NSNumber *, NSMutableData *> *banks = [NSMutableDictionary dictionary];
+    NSUInteger bankCount = 0;
+    for (NSArray<id> *binary in binaries) {
+        const NSUInteger address = [[binary objectAtIndex:0] unsignedIntegerValue];
+        id bankNumber = [binary objectAtIndex:1];
+        NSData *data = [binary objectAtIndex:2];
+        const NSUInteger bank = ([bankNumber isKindOfClass:[NSNumber class]])? [bankNumber unsignedIntegerValue] : 0;
+        if (XDTCartridgeROMAddress > address || XDTCartridgeROMAddress + XDTCartridgeBankSize < address + [data length] ||
+            XDTCartridgeMaxBanks <= [_romBanks count] + bank) {
+            if (nil != error) {
+                NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+                *error = XDTCartridgeError(NSLocalizedStringFromTableInBundle(@"Code outside of the cartridge ROM", nil, myBundle, @"Description for an error object, discribing that code is not placed into the ROM of a cartridge."),
+                                           [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"The segment at >%04lX with %lu bytes is not placed into >6000->7FFF of one of the 64 ROM banks.", nil, myBundle, @"Recovery suggestion for an error object, which tells the address and length of a segment which is not placed into a ROM bank."), address, [data length]]);
+            }
+            return NO;
+        }
+        NSNumber *bankKey = [NSNumber numberWithUnsignedInteger:bank];
+        NSMutableData *bankData = [banks objectForKey:bankKey];
+        if (nil == bankData) {
+            bankData = [NSMutableData data];
+            [banks setObject:bankData forKey:bankKey];
+        }
+        const NSUInteger offset = address - XDTCartridgeROMAddress;
+        if ([bankData length] < offset + [data length]) {
+            [bankData setLength:offset + [data length]];
+        }
+        [bankData replaceBytesInRange:NSMakeRange(offset, [data length]) withBytes:[data bytes]];
+        bankCount = MAX(bankCount, bank + 1);
+    }
+
+    for (NSUInteger bank = 0; bank < bankCount; bank++) {
+        NSData *bankData = [banks objectForKey:[NSNumber numberWithUnsignedInteger:bank]];
+        [_romBanks addObject:(nil == bankData)? [NSData data] : bankData];
+    }
+    return YES;
+}
+
+
+- (BOOL)setGROMImage:(NSData *)image address:(NSUInteger)address error:(NSError **)error
+{
+    if (XDTCartridgeROMAddress > address || XDTCartridgeROMAddress + XDTCartridgeGROMSize < address + [image length]) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            *error = XDTCartridgeError(NSLocalizedStringFromTableInBundle(@"GROM image does not fit", nil, myBundle, @"Description for an error object, discribing that a GROM image is too large for a cartridge."),
+                                       NSLocalizedStringFromTableInBundle(@"The GROMs of cartridges are GROM 3 to 7 at >6000->FFFF.", nil, myBundle, @"Recovery suggestion for an error object, which explains the addresses of the GROMs of cartridges."));
+        }
+        return NO;
+    }
+#if !__has_feature(objc_arc)
+    [_gromImage release];
+#endif
+    _gromImage = [image copy];
+    _gromAddress = address;
+    return YES;
+}
+
+
+#pragma mark - Package Contents
+
+
+/*
+ The names of the images follow the convention of TI: C for the CPU ROM, D for its second bank and G for the GROM.
+ A cartridge with only one image uses the name of the cartridge, like xas99 and xga99 do.
+ */
+- (NSArray<NSArray *> *)imageFiles
+{
+    NSMutableArray<NSArray *> *retVal = [NSMutableArray array];
+    const BOOL hasOneImage = (nil == _gromImage) != (0 == [_romBanks count]) && 1 >= [_romBanks count];
+    NSString *baseName = [_name stringByAppendingPathExtension:@"bin"];
+
+    if (nil != _gromImage) {
+        NSString *fileName = hasOneImage? baseName : [[_name stringByAppendingString:@"G"] stringByAppendingPathExtension:@"bin"];
+        [retVal addObject:@[fileName, @[[NSNumber numberWithUnsignedInteger:_gromAddress - XDTCartridgeROMAddress], _gromImage], @"gromimage", @"grom_socket"]];
+    }
+
+    if (1 == [_romBanks count]) {
+        NSString *fileName = hasOneImage? baseName : [[_name stringByAppendingString:@"C"] stringByAppendingPathExtension:@"bin"];
+        [retVal addObject:@[fileName, @[[_romBanks firstObject]], @"romimage", @"rom_socket"]];
+    } else if (2 == [_romBanks count]) {
+        NSArray<NSString *> *suffixes = @[@"C", @"D"];
+        NSArray<NSString *> *identifiers = @[@"rom", @"rom2"];
+        for (NSUInteger bank = 0; bank < 2; bank++) {
+            NSData *bankData = [_romBanks objectAtIndex:bank];
+            NSString *fileName = [[_name stringByAppendingString:suffixes[bank]] stringByAppendingPathExtension:@"bin"];
+            NSArray *parts = @[bankData, [NSNumber numberWithUnsignedInteger:XDTCartridgeBankSize - [bankData length]]];
+            [retVal addObject:@[fileName, parts, [identifiers[bank] stringByAppendingString:@"image"], [identifiers[bank] stringByAppendingString:@"_socket"]]];
+        }
+    } else if (2 < [_romBanks count]) {
+        NSUInteger bankCount = 1;
+        while (bankCount < [_romBanks count]) {
+            bankCount <<= 1;
+        }
+        NSMutableArray *parts = [NSMutableArray arrayWithCapacity:2 * [_romBanks count] + 1];
+        for (NSData *bankData in _romBanks) {
+            [parts addObject:bankData];
+            [parts addObject:[NSNumber numberWithUnsignedInteger:XDTCartridgeBankSize - [bankData length]]];
+        }
+        [parts addObject:[NSNumber numberWithUnsignedInteger:(bankCount - [_romBanks count]) * XDTCartridgeBankSize]];
+        NSString *fileName = [[_name stringByAppendingString:@"C"] stringByAppendingPathExtension:@"bin"];
+        [retVal addObject:@[fileName, parts, @"romimage", @"rom_socket"]];
+    }
+    return retVal;
+}
+
+
+- (NSArray<NSArray *> *)packageFiles
+{
+    NSMutableArray<NSArray *> *retVal = [NSMutableArray arrayWithArray:[self imageFiles]];
+    [retVal addObject:@[@"layout.xml", @[[self layoutData]]]];
+    [retVal addObject:@[@"meta-inf.xml", @[[self metaInfData]]]];
+    return retVal;
+}
+
+
+- (NSData *)layoutData
+{
+    NSString *pcbType = (2 < [_romBanks count])? @"paged378" : (2 == [_romBanks count])? @"paged" : @"standard";
+    NSMutableString *resources = [NSMutableString string];
+    NSMutableString *sockets = [NSMutableString string];
+    for (NSArray *file in [self imageFiles]) {
+        [resources appendFormat:@"        <rom id=\"%@\" file=\"%@\"/>\n", file[2], XDTEscapedXMLString(file[0])];
+        [sockets appendFormat:@"            <socket id=\"%@\" uses=\"%@\"/>\n", file[3], file[2]];
+    }
+
+    NSString *layout = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+                        "<romset version=\"1.0\">\n"
+                        "    <resources>\n%@    </resources>\n"
+                        "    <configuration>\n"
+                        "        <pcb type=\"%@\">\n%@        </pcb>\n"
+                        "    </configuration>\n"
+                        "</romset>\n", resources, pcbType, sockets];
+    return [layout dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+
+- (NSData *)metaInfData
+{
+    NSString *metaInf = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+                         "<meta-inf>\n"
+                         "    <name>%@</name>\n"
+                         "</meta-inf>\n", XDTEscapedXMLString(_name)];
+    return [metaInf dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+
+- (NSDictionary<NSString *, NSData *> *)packageContents
+{
+    NSMutableDictionary<NSString *, NSData *> *retVal = [NSMutableDictionary dictionary];
+    for (NSArray *file in [self packageFiles]) {
+        NSMutableData *content = [NSMutableData data];
+        for (id part in file[1]) {
+            if ([part isKindOfClass:[NSData class]]) {
+                [content appendData:part];
+            } else {
+                [content increaseLengthBy:[part unsignedIntegerValue]];
+            }
+        }
+        [retVal setObject:content forKey:file[0]];
+    }
+    return retVal;
+}
+
+
+#pragma mark - Writing
+
+
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error
+{
+    return [XDTCartridgeBuilder writePackageFiles:[self packageFiles] toURL:url error:error];
+}
+
+
++ (BOOL)writePackageContents:(NSDictionary<NSString *, NSData *> *)contents toURL:(NSURL *)url error:(NSError **)error
+{
+    NSMutableArray<NSArray *> *files = [NSMutableArray arrayWithCapacity:[contents count]];
+    for (NSString *fileName in [[contents allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        [files addObject:@[fileName, @[[contents objectForKey:fileName]]]];
+    }
+    return [self writePackageFiles:files toURL:url error:error];
+}
+
+
+/*
+ The files are stored without compression, which MESS reads like any other zip archive. The package is written into
+ a temporary file next to the destination, which replaces the destination when it is complete.
+ */
++ (BOOL)writePackageFiles:(NSArray<NSArray *> *)files toURL:(NSURL *)url error:(NSError **)error
+{
+    NSString *path = [[url URLByStandardizingPath] path];
+    NSString *temporaryPath = [[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:[NSString stringWithFormat:@".%@.%d", [path lastPathComponent], getpid()]];
+    const int fd = open([temporaryPath fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (0 > fd) {
+        if (nil != error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSURLErrorKey: url}];
+        }
+        return NO;
+    }
+
+    /* MS-DOS time and date of the files */
+    NSDateComponents *now = [[NSCalendar currentCalendar] components:NSCalendarUnitYear | NSCalendarUnitMonth | NSCalendarUnitDay | NSCalendarUnitHour | NSCalendarUnitMinute | NSCalendarUnitSecond fromDate:[NSDate date]];
+    const uint16_t dosTime = (uint16_t)(([now hour] << 11) | ([now minute] << 5) | ([now second] / 2));
+    const uint16_t dosDate = (uint16_t)(((MAX([now year], 1980) - 1980) << 9) | ([now month] << 5) | [now day]);
+
+    NSMutableData *centralDirectory = [NSMutableData data];
+    off_t offset = 0;
+    BOOL isWritten = YES;
+    for (NSUInteger i = 0; isWritten && i < [files count]; i++) {
+        NSArray *file = [files objectAtIndex:i];
+        NSData *nameData = [(NSString *)file[0] dataUsingEncoding:NSUTF8StringEncoding];
+        uint64_t size = 0;
+        for (id part in file[1]) {
+            size += ([part isKindOfClass:[NSData class]])? [(NSData *)part length] : [part unsignedIntegerValue];
+        }
+        if (UINT32_MAX <= size || UINT16_MAX < [nameData length]) {
+            errno = EFBIG;
+            isWritten = NO;
+            break;
+        }
+
+        uint8_t localHeader[XDTZipLocalHeaderSize] = {0};
+        OSWriteLittleInt32(localHeader, 0, 0x04034B50);
+        OSWriteLittleInt16(localHeader, 4, 10);                 /* version needed to extract: stored files */
+        OSWriteLittleInt16(localHeader, 10, dosTime);
+        OSWriteLittleInt16(localHeader, 12, dosDate);
+        OSWriteLittleInt32(localHeader, 18, (uint32_t)size);
+        OSWriteLittleInt32(localHeader, 22, (uint32_t)size);
+        OSWriteLittleInt16(localHeader, 26, (uint16_t)[nameData length]);
+        isWritten = XDTWriteBytes(fd, localHeader, sizeof(localHeader)) && XDTWriteBytes(fd, [nameData bytes], [nameData length]);
+
+        uint32_t crc = 0;
+        for (id part in file[1]) {
+            if (!isWritten) {
+                break;
+            }
+            if ([part isKindOfClass:[NSData class]]) {
+                crc = XDTUpdateCRC32(crc, [(NSData *)part bytes], [(NSData *)part length]);
+                isWritten = XDTWriteBytes(fd, [(NSData *)part bytes], [(NSData *)part length]);
+                continue;
+            }
+            for (NSUInteger zeroCount = [part unsignedIntegerValue]; isWritten && 0 < zeroCount; ) {
+                const size_t length = MIN(zeroCount, sizeof(XDTZeroBytes));
+                crc = XDTUpdateCRC32(crc, XDTZeroBytes, length);
+                isWritten = XDTWriteBytes(fd, XDTZeroBytes, length);
+                zeroCount -= length;
+            }
+        }
+
+        /* the CRC is known when the data is written */
+        uint8_t crcBytes[4];
+        OSWriteLittleInt32(crcBytes, 0, crc);
+        isWritten = isWritten && (ssize_t)sizeof(crcBytes) == pwrite(fd, crcBytes, sizeof(crcBytes), offset + 14);
+
+        uint8_t centralHeader[XDTZipCentralHeaderSize] = {0};
+        OSWriteLittleInt32(centralHeader, 0, 0x02014B50);
+        OSWriteLittleInt16(centralHeader, 4, 20);               /* version made by: MS-DOS attributes, zip 2.0 */
+        OSWriteLittleInt16(centralHeader, 6, 10);
+        OSWriteLittleInt16(centralHeader, 12, dosTime);
+        OSWriteLittleInt16(centralHeader, 14, dosDate);
+        OSWriteLittleInt32(centralHeader, 16, crc);
+        OSWriteLittleInt32(centralHeader, 20, (uint32_t)size);
+        OSWriteLittleInt32(centralHeader, 24, (uint32_t)size);
+        OSWriteLittleInt16(centralHeader, 28, (uint16_t)[nameData length]);
+        OSWriteLittleInt32(centralHeader, 42, (uint32_t)offset);
+        [centralDirectory appendBytes:centralHeader length:sizeof(centralHeader)];
+        [centralDirectory appendData:nameData];
+        offset += XDTZipLocalHeaderSize + [nameData length] + size;
+    }
+
+    if (isWritten) {
+        uint8_t endRecord[XDTZipEndRecordSize] = {0};
+        OSWriteLittleInt32(endRecord, 0, 0x06054B50);
+        OSWriteLittleInt16(endRecord, 8, (uint16_t)[files count]);
+        OSWriteLittleInt16(endRecord, 10, (uint16_t)[files count]);
+        OSWriteLittleInt32(endRecord, 12, (uint32_t)[centralDirectory length]);
+        OSWriteLittleInt32(endRecord, 16, (uint32_t)offset);
+        isWritten = XDTWriteBytes(fd, [centralDirectory bytes], [centralDirectory length]) &&
+                    XDTWriteBytes(fd, endRecord, sizeof(endRecord));
+    }
+
+    if (isWritten) {
+        isWritten = 0 == close(fd) && 0 == rename([temporaryPath fileSystemRepresentation], [path fileSystemRepresentation]);
+    } else {
+        const int writeError = errno;
+        close(fd);
+        errno = writeError;
+    }
+    if (!isWritten) {
+        const int writeError = errno;
+        unlink([temporaryPath fileSystemRepresentation]);
+        if (nil != error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:writeError userInfo:@{NSURLErrorKey: url}];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+@end
@@ -0,0 +1,78 @@
+//
+//  XDTCrossReference.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+typedef NS_ENUM(NSUInteger, XDTCrossReferenceSyntax) {
+    XDTCrossReferenceSyntaxAs99,    /* Sources of xas99, with local labels */
+    XDTCrossReferenceSyntaxGa99,    /* Sources of xga99 */
+};
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTCrossReferenceKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
+
+FOUNDATION_EXPORT XDTCrossReferenceKey const XDTCrossReferenceSymbol;       /* Name of the symbol as NSString */
+FOUNDATION_EXPORT XDTCrossReferenceKey const XDTCrossReferenceFileURL;      /* The source file of type NSURL */
+FOUNDATION_EXPORT XDTCrossReferenceKey const XDTCrossReferenceLineNumber;   /* The line number of the source file, starting at 1, as NSNumber */
+FOUNDATION_EXPORT XDTCrossReferenceKey const XDTCrossReferenceColumn;       /* The column of the first character of the symbol, starting at 1, as NSNumber */
+FOUNDATION_EXPORT XDTCrossReferenceKey const XDTCrossReferenceLength;       /* Number of characters of the symbol in the line as NSNumber */
+FOUNDATION_EXPORT XDTCrossReferenceKey const XDTCrossReferenceDefinition;   /* A BOOL NSNumber, YES for the definition of the symbol */
+
+
+/**
+ The cross-reference index of an assembled program: every symbol with its definition and all its uses.
+
+ The assemblers build the index right after assembling when the cross-reference option is set, from the same
+ source files including those copied with COPY. Only names in the symbol table of the result are indexed, together
+ with macros (named with their leading dot) and the local labels of xas99. Every definition of a local label is a
+ symbol of its own, named by the label and its ordinal number, i.e. "!loop#2" for the second "!loop", so a
+ reference always points to the definition the assembler chooses.
+
+ The index is native and compact: 16 bytes for each occurrence and one string for each symbol. Symbols are found
+ by a binary search over the sorted names, and occurrences at a position by a binary search over their positions.
+ */
+@interface XDTCrossReference : NSObject
+
+@property (readonly) NSArray<NSURL *> *fileURLs;        /* The source file and all included files */
+@property (readonly) NSArray<NSString *> *symbolNames;  /* Sorted */
+@property (readonly) NSUInteger occurrenceCount;
+@property (readonly) NSUInteger byteCount;              /* Memory of the occurrences and of both indexes */
+
+/* In strict mode, like the strict option of xas99, a single blank ends the operand field */
++ (nullable instancetype)crossReferenceOfSourceFile:(NSURL *)srcFile includeURLs:(NSArray<NSURL *> *)includeURLs symbolNames:(NSSet<NSString *> *)symbolNames syntax:(XDTCrossReferenceSyntax)syntax strict:(BOOL)isStrict error:(NSError **)error;
+
+- (nullable NSDictionary<XDTCrossReferenceKey, id> *)definitionOfSymbol:(NSString *)name;
+- (NSArray<NSDictionary<XDTCrossReferenceKey, id> *> *)usesOfSymbol:(NSString *)name;
+- (NSArray<NSDictionary<XDTCrossReferenceKey, id> *> *)occurrencesOfSymbol:(NSString *)name;   /* The definition first, then all uses */
+
+/* The definition or use which covers the column of the line, i.e. the symbol under the cursor of an editor. */
+- (nullable NSDictionary<XDTCrossReferenceKey, id> *)occurrenceAtFileURL:(NSURL *)fileURL line:(NSUInteger)line column:(NSUInteger)column;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,757 @@
+//
+//  XDTCrossReference.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTCrossReference.h"
+
+#include <stdlib.h>
+
+
+#define XDTCrossReferenceFlagDefinition 1
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+XDTCrossReferenceKey const XDTCrossReferenceSymbol = @"XDTCrossReferenceSymbol";
+XDTCrossReferenceKey const XDTCrossReferenceFileURL = @"XDTCrossReferenceFileURL";
+XDTCrossReferenceKey const XDTCrossReferenceLineNumber = @"XDTCrossReferenceLineNumber";
+XDTCrossReferenceKey const XDTCrossReferenceColumn = @"XDTCrossReferenceColumn";
+XDTCrossReferenceKey const XDTCrossReferenceLength = @"XDTCrossReferenceLength";
+XDTCrossReferenceKey const XDTCrossReferenceDefinition = @"XDTCrossReferenceDefinition";
+
+
+/* One occurrence of a symbol. Columns and lengths beyond 65535 are cut, no assembler line is that long. */
+typedef struct {
+    uint32_t symbol;    /* Index into the sorted symbol names */
+    uint32_t line;
+    uint16_t column;
+    uint16_t length;
+    uint16_t file;      /* Index into the file URLs */
+    uint16_t flags;
+} XDTCrossReferenceEntry;
+
+/* A reference to a local label, resolved when all definitions of the label are known */
+typedef struct {
+    uint32_t sequence;  /* Number of the line counted over all files in the order of assembling */
+    uint32_t line;
+    uint16_t column;
+    uint16_t length;
+    uint16_t file;
+    uint16_t distance;  /* Number of the exclamation marks, i.e. 2 for the second next definition */
+    uint32_t backward;  /* Non-zero for references with a leading minus */
+} XDTCrossReferenceLocalUse;
+
+
+@interface XDTCrossReference () {
+    NSData *_entries;           /* XDTCrossReferenceEntry, sorted by symbol, definitions first, and then by position */
+    NSData *_symbolStarts;      /* uint32_t index of the first entry of each symbol, followed by the number of entries */
+    NSData *_positions;         /* uint32_t index of each entry, sorted by file, line and column */
+    NSArray<NSString *> *_filePaths;
+}
+
+- (instancetype)initWithFileURLs:(NSArray<NSURL *> *)fileURLs symbolNames:(NSArray<NSString *> *)symbolNames entries:(NSData *)entries symbolStarts:(NSData *)symbolStarts positions:(NSData *)positions;
+
+- (NSUInteger)indexOfSymbol:(NSString *)name;
+- (NSDictionary<XDTCrossReferenceKey, id> *)occurrenceOfEntry:(const XDTCrossReferenceEntry *)entry;
+
+@end
+
+
+/* Scans the source files line by line and collects the occurrences with a temporary index of their symbols. */
+@interface XDTCrossReferenceBuilder : NSObject {
+    XDTCrossReferenceSyntax _syntax;
+    BOOL _isStrict;
+    NSSet<NSString *> *_knownNames;
+    NSArray<NSURL *> *_includeURLs;
+
+    NSMutableArray<NSURL *> *_fileURLs;
+    NSMutableSet<NSString *> *_scannedPaths;
+    NSMutableDictionary<NSString *, NSNumber *> *_symbolIndexes;
+    NSMutableArray<NSString *> *_names;
+    NSMutableData *_entries;
+    NSMutableSet<NSString *> *_macroNames;
+    NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *_localDefinitions;   /* Line sequences of the definitions of each local label */
+    NSMutableData *_localUses;
+    NSMutableArray<NSString *> *_localUseNames;
+    NSMutableData *_lineBuffer;
+    uint32_t _sequence;
+}
+
+- (instancetype)initWithIncludeURLs:(NSArray<NSURL *> *)includeURLs symbolNames:(NSSet<NSString *> *)symbolNames syntax:(XDTCrossReferenceSyntax)syntax strict:(BOOL)isStrict;
+
+- (BOOL)scanFileAtURL:(NSURL *)fileURL error:(NSError **)error;
+- (void)scanLine:(NSString *)line ofFile:(uint16_t)file lineNumber:(uint32_t)lineNumber fileURL:(NSURL *)fileURL;
+- (nullable NSURL *)URLOfCopiedFile:(NSString *)name includingURL:(NSURL *)fileURL;
+
+- (void)addOccurrenceOfSymbol:(NSString *)name file:(uint16_t)file line:(uint32_t)line column:(NSUInteger)column length:(NSUInteger)length definition:(BOOL)isDefinition;
+- (void)addLocalDefinition:(NSString *)label file:(uint16_t)file line:(uint32_t)line length:(NSUInteger)length;
+- (void)resolveLocalUses;
+
+- (XDTCrossReference *)crossReference;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static BOOL XDTCrossReferenceIsBlank(unichar c)
+{
+    return ' ' == c || '\t' == c;
+}
+
+
+/* Instructions and directives of both assemblers which take no operands, so anything behind them is a comment */
+static BOOL XDTCrossReferenceHasNoOperands(NSString *upperMnemonic, XDTCrossReferenceSyntax syntax)
+{
+    static NSSet<NSString *> *as99Mnemonics = nil;
+    static NSSet<NSString *> *ga99Mnemonics = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        as99Mnemonics = [[NSSet alloc] initWithObjects:@"RT", @"RTWP", @"NOP", @"IDLE", @"RSET", @"CKON", @"CKOF", @"LREX",
+                         @"EVEN", @"PSEG", @"PEND", @"CEND", @"DSEG", @"DEND", @"UNL", @"LIST", @"PAGE",
+                         @".ELSE", @".ENDIF", @".ENDM", nil];
+        ga99Mnemonics = [[NSSet alloc] initWithObjects:@"RTN", @"RTNC", @"RTNB", @"RTGR", @"SCAN", @"H", @"GT", @"EXIT",
+                         @"CARRY", @"OVF", @"CONT", @"EXEC", @"EVEN", @"UNL", @"LIST", @"PAGE",
+                         @".ELSE", @".ENDIF", @".ENDM", nil];
+    });
+    NSSet<NSString *> *mnemonics = (XDTCrossReferenceSyntaxAs99 == syntax)? as99Mnemonics : ga99Mnemonics;
+    return [mnemonics containsObject:upperMnemonic];
+}
+
+
+/* Characters which separate the names in the operand field, everything else belongs to a name */
+static BOOL XDTCrossReferenceIsDelimiter(unichar c)
+{
+    return XDTCrossReferenceIsBlank(c) || (128 > c && NULL != strchr(",+-*/()@#<>&|^%=\"';[]\\~", (int)c));
+}
+
+
+static int XDTCrossReferenceCompareEntries(const void *a, const void *b)
+{
+    const XDTCrossReferenceEntry *entryA = a;
+    const XDTCrossReferenceEntry *entryB = b;
+    if (entryA->symbol != entryB->symbol) {
+        return (entryA->symbol < entryB->symbol)? -1 : 1;
+    }
+    if (entryA->flags != entryB->flags) {
+        return (entryA->flags > entryB->flags)? -1 : 1;  /* the definition first */
+    }
+    if (entryA->file != entryB->file) {
+        return (entryA->file < entryB->file)? -1 : 1;
+    }
+    if (entryA->line != entryB->line) {
+        return (entryA->line < entryB->line)? -1 : 1;
+    }
+    return (int)entryA->column - (int)entryB->column;
+}
+
+
+static int XDTCrossReferenceComparePositions(const XDTCrossReferenceEntry *entryA, uint16_t file, uint32_t line, uint16_t column)
+{
+    if (entryA->file != file) {
+        return (entryA->file < file)? -1 : 1;
+    }
+    if (entryA->line != line) {
+        return (entryA->line < line)? -1 : 1;
+    }
+    return (int)entryA->column - (int)column;
+}
+
+
+#pragma mark - Implementation of class XDTCrossReferenceBuilder
+
+
+@implementation XDTCrossReferenceBuilder
+
+- (instancetype)initWithIncludeURLs:(NSArray<NSURL *> *)includeURLs symbolNames:(NSSet<NSString *> *)symbolNames syntax:(XDTCrossReferenceSyntax)syntax strict:(BOOL)isStrict
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _syntax = syntax;
+    _isStrict = isStrict;
+    _knownNames = [symbolNames copy];
+    _includeURLs = [includeURLs copy];
+    _fileURLs = [[NSMutableArray alloc] init];
+    _scannedPaths = [[NSMutableSet alloc] init];
+    _symbolIndexes = [[NSMutableDictionary alloc] init];
+    _names = [[NSMutableArray alloc] init];
+    _entries = [[NSMutableData alloc] init];
+    _macroNames = [[NSMutableSet alloc] init];
+    _localDefinitions = [[NSMutableDictionary alloc] init];
+    _localUses = [[NSMutableData alloc] init];
+    _localUseNames = [[NSMutableArray alloc] init];
+    _lineBuffer = [[NSMutableData alloc] init];
+    _sequence = 0;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_knownNames release];
+    [_includeURLs release];
+    [_fileURLs release];
+    [_scannedPaths release];
+    [_symbolIndexes release];
+    [_names release];
+    [_entries release];
+    [_macroNames release];
+    [_localDefinitions release];
+    [_localUses release];
+    [_localUseNames release];
+    [_lineBuffer release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Scanning
+
+
+- (BOOL)scanFileAtURL:(NSURL *)fileURL error:(NSError **)error
+{
+    NSString *path = [[fileURL URLByStandardizingPath] path];
+    if ([_scannedPaths containsObject:path] || UINT16_MAX <= [_fileURLs count]) {
+        return YES;    /* A file copied twice adds no other symbols, and a recursive COPY would never end */
+    }
+    NSData *data = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:error];
+    if (nil == data) {
+        return NO;
+    }
+    /* xdt99 reads the sources as bytes, so any 8 bit text which is no UTF-8 is taken as Latin 1 */
+    NSString *text = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+    if (nil == text) {
+        text = [[NSString alloc] initWithData:data encoding:NSISOLatin1StringEncoding];
+    }
+#if !__has_feature(objc_arc)
+    [text autorelease];
+#endif
+
+    const uint16_t file = (uint16_t)[_fileURLs count];
+    [_fileURLs addObject:fileURL];
+    [_scannedPaths addObject:path];
+
+    __block uint32_t lineNumber = 0;
+    [text enumerateLinesUsingBlock:^(NSString *line, BOOL *stop) {
+        lineNumber++;
+        self->_sequence++;
+        [self scanLine:line ofFile:file lineNumber:lineNumber fileURL:fileURL];
+    }];
+    return YES;
+}
+
+
+/*
+ A line has the fields label, mnemonic and operands, separated by blanks, and a comment at last:
+    LABEL  MOV  @TABLE(R1),!next   ; comment
+ A comment also starts with an asterisk in the first column. The operand field ends at a semicolon, a tab or at
+ two blanks outside of a string, in strict mode already at one blank. Mnemonics without operands are followed by
+ the comment only, and the optional operand of END is a single name, so the operand field ends at one blank there.
+ */
+- (void)scanLine:(NSString *)line ofFile:(uint16_t)file lineNumber:(uint32_t)lineNumber fileURL:(NSURL *)fileURL
+{
+    const NSUInteger length = [line length];
+    if (0 == length) {
+        return;
+    }
+    if ([_lineBuffer length] < length * sizeof(unichar)) {
+        [_lineBuffer setLength:length * sizeof(unichar)];
+    }
+    unichar *c = [_lineBuffer mutableBytes];
+    [line getCharacters:c range:NSMakeRange(0, length)];
+    if ('*' == c[0] || ';' == c[0]) {
+        return;
+    }
+
+    /* label field */
+    NSUInteger pos = 0;
+    while (pos < length && !XDTCrossReferenceIsBlank(c[pos])) {
+        pos++;
+    }
+    if (0 < pos) {
+        NSUInteger labelLength = pos;
+        if (1 < labelLength && ':' == c[labelLength - 1]) {
+            labelLength--;
+        }
+        NSString *label = [NSString stringWithCharacters:c length:labelLength];
+        if (XDTCrossReferenceSyntaxAs99 == _syntax && '!' == c[0]) {
+            [self addLocalDefinition:label file:file line:lineNumber length:labelLength];
+        } else if ([_knownNames containsObject:label]) {
+            [self addOccurrenceOfSymbol:label file:file line:lineNumber column:1 length:labelLength definition:YES];
+        }
+    }
+
+    /* mnemonic field */
+    while (pos < length && XDTCrossReferenceIsBlank(c[pos])) {
+        pos++;
+    }
+    const NSUInteger mnemonicStart = pos;
+    while (pos < length && !XDTCrossReferenceIsBlank(c[pos])) {
+        pos++;
+    }
+    if (mnemonicStart == pos) {
+        return;
+    }
+    NSString *mnemonic = [NSString stringWithCharacters:c + mnemonicStart length:pos - mnemonicStart];
+    if ('.' == c[mnemonicStart] && [_macroNames containsObject:mnemonic]) {
+        [self addOccurrenceOfSymbol:mnemonic file:file line:lineNumber column:mnemonicStart + 1 length:pos - mnemonicStart definition:NO];
+    }
+    while (pos < length && XDTCrossReferenceIsBlank(c[pos])) {
+        pos++;
+    }
+
+    NSString *upperMnemonic = [mnemonic uppercaseString];
+    if ([@"COPY" isEqualToString:upperMnemonic]) {
+        if (pos < length && ('"' == c[pos] || '\'' == c[pos])) {
+            const unichar quote = c[pos++];
+            const NSUInteger nameStart = pos;
+            while (pos < length && quote != c[pos]) {
+                pos++;
+            }
+            NSString *name = [NSString stringWithCharacters:c + nameStart length:pos - nameStart];
+            NSURL *copiedURL = [self URLOfCopiedFile:name includingURL:fileURL];
+            if (nil != copiedURL) {
+                /* The line buffer is reused by the copied file, but this line is done */
+                [self scanFileAtURL:copiedURL error:nil];
+            }
+        }
+        return;
+    }
+    if ([@".DEFM" isEqualToString:upperMnemonic]) {
+        const NSUInteger nameStart = pos;
+        while (pos < length && !XDTCrossReferenceIsDelimiter(c[pos])) {
+            pos++;
+        }
+        if (nameStart < pos) {
+            NSString *macroName = [@"." stringByAppendingString:[NSString stringWithCharacters:c + nameStart length:pos - nameStart]];
+            [_macroNames addObject:macroName];
+            [self addOccurrenceOfSymbol:macroName file:file line:lineNumber column:nameStart + 1 length:pos - nameStart definition:YES];
+        }
+        return;
+    }
+    if (XDTCrossReferenceHasNoOperands(upperMnemonic, _syntax)) {
+        return;
+    }
+
+    /* operand field */
+    const BOOL isEndingAtBlank = _isStrict || [@"END" isEqualToString:upperMnemonic];
+    unichar quote = 0;
+    NSUInteger blanks = 0;
+    while (pos < length) {
+        const unichar ch = c[pos];
+        if (0 != quote) {
+            if (quote == ch) {
+                quote = 0;
+            }
+            pos++;
+            continue;
+        }
+        if ('\'' == ch || '"' == ch) {
+            quote = ch;
+            blanks = 0;
+            pos++;
+            continue;
+        }
+        if (';' == ch || '\t' == ch || (' ' == ch && (isEndingAtBlank || 0 < blanks))) {
+            break;
+        }
+        if (' ' == ch) {
+            blanks++;
+            pos++;
+            continue;
+        }
+        blanks = 0;
+        if (XDTCrossReferenceIsDelimiter(ch)) {
+            pos++;
+            continue;
+        }
+
+        const NSUInteger tokenStart = pos;
+        while (pos < length && !XDTCrossReferenceIsDelimiter(c[pos])) {
+            pos++;
+        }
+        const NSUInteger tokenLength = pos - tokenStart;
+        const unichar previous = (0 < tokenStart)? c[tokenStart - 1] : ' ';
+        if ('>' == previous || ('0' <= ch && '9' >= ch)) {
+            continue;   /* hexadecimal or decimal number */
+        }
+        if (XDTCrossReferenceSyntaxAs99 == _syntax && '!' == ch) {
+            uint16_t distance = 0;
+            while (distance < tokenLength && '!' == c[tokenStart + distance]) {
+                distance++;
+            }
+            XDTCrossReferenceLocalUse use = {
+                .sequence = _sequence, .line = lineNumber,
+                .column = (uint16_t)MIN(tokenStart + 1, UINT16_MAX), .length = (uint16_t)MIN(tokenLength, UINT16_MAX),
+                .file = file, .distance = distance, .backward = ('-' == previous)
+            };
+            [_localUses appendBytes:&use length:sizeof(use)];
+            [_localUseNames addObject:[@"!" stringByAppendingString:[NSString stringWithCharacters:c + tokenStart + distance length:tokenLength - distance]]];
+            continue;
+        }
+        NSString *token = [NSString stringWithCharacters:c + tokenStart length:tokenLength];
+        if ([_knownNames containsObject:token]) {
+            [self addOccurrenceOfSymbol:token file:file line:lineNumber column:tokenStart + 1 length:tokenLength definition:NO];
+        }
+    }
+}
+
+
+- (NSURL *)URLOfCopiedFile:(NSString *)name includingURL:(NSURL *)fileURL
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if ([name isAbsolutePath]) {
+        return ([fileManager fileExistsAtPath:name])? [NSURL fileURLWithPath:name] : nil;
+    }
+
+    /* TI style names like DSK1.FILE are looked up as FILE, also with the extension of the including file */
+    NSMutableArray<NSString *> *names = [NSMutableArray arrayWithObject:name];
+    NSRange dotRange = [name rangeOfString:@"."];
+    if ([[name uppercaseString] hasPrefix:@"DSK"] && NSNotFound != dotRange.location) {
+        NSString *fileName = [name substringFromIndex:NSMaxRange(dotRange)];
+        [names addObject:fileName];
+        if (0 < [[fileURL pathExtension] length]) {
+            [names addObject:[fileName stringByAppendingPathExtension:[fileURL pathExtension]]];
+        }
+    }
+
+    NSMutableArray<NSURL *> *directories = [NSMutableArray arrayWithObject:[fileURL URLByDeletingLastPathComponent]];
+    [directories addObjectsFromArray:_includeURLs];
+    for (NSURL *directory in directories) {
+        for (NSString *candidate in names) {
+            NSURL *candidateURL = [directory URLByAppendingPathComponent:candidate];
+            if ([fileManager fileExistsAtPath:[candidateURL path]]) {
+                return candidateURL;
+            }
+        }
+    }
+    return nil;
+}
+
+
+#pragma mark - Collecting
+
+
+- (void)addOccurrenceOfSymbol:(NSString *)name file:(uint16_t)file line:(uint32_t)line column:(NSUInteger)column length:(NSUInteger)length definition:(BOOL)isDefinition
+{
+    NSNumber *symbolIndex = [_symbolIndexes objectForKey:name];
+    if (nil == symbolIndex) {
+        symbolIndex = [NSNumber numberWithUnsignedInteger:[_names count]];
+        [_symbolIndexes setObject:symbolIndex forKey:name];
+        [_names addObject:name];
+    }
+    XDTCrossReferenceEntry entry = {
+        .symbol = [symbolIndex unsignedIntValue], .line = line,
+        .column = (uint16_t)MIN(column, UINT16_MAX), .length = (uint16_t)MIN(length, UINT16_MAX),
+        .file = file, .flags = isDefinition? XDTCrossReferenceFlagDefinition : 0
+    };
+    [_entries appendBytes:&entry length:sizeof(entry)];
+}
+
+
+- (void)addLocalDefinition:(NSString *)label file:(uint16_t)file line:(uint32_t)line length:(NSUInteger)length
+{
+    NSMutableArray<NSNumber *> *definitions = [_localDefinitions objectForKey:label];
+    if (nil == definitions) {
+        definitions = [NSMutableArray array];
+        [_localDefinitions setObject:definitions forKey:label];
+    }
+    [definitions addObject:[NSNumber numberWithUnsignedInt:_sequence]];
+    NSString *name = [NSString stringWithFormat:@"%@#%lu", label, (unsigned long)[definitions count]];
+    [self addOccurrenceOfSymbol:name file:file line:line column:1 length:length definition:YES];
+}
+
+
+/*
+ A reference !name points to the next definition of !name after its line, !!name to the second next and so on.
+ With a leading minus it points backwards, where -!name is the last definition up to and including its line.
+ */
+- (void)resolveLocalUses
+{
+    const XDTCrossReferenceLocalUse *uses = [_localUses bytes];
+    const NSUInteger useCount = [_localUses length] / sizeof(XDTCrossReferenceLocalUse);
+    for (NSUInteger i = 0; i < useCount; i++) {
+        const XDTCrossReferenceLocalUse *use = &uses[i];
+        NSString *label = [_localUseNames objectAtIndex:i];
+        NSArray<NSNumber *> *definitions = [_localDefinitions objectForKey:label];
+        if (nil == definitions) {
+            continue;
+        }
+        /* index of the first definition behind the line of the reference */
+        NSUInteger low = 0, high = [definitions count];
+        while (low < high) {
+            const NSUInteger mid = (low + high) / 2;
+            if ([[definitions objectAtIndex:mid] unsignedIntValue] <= use->sequence) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        NSInteger target = use->backward? (NSInteger)low - (NSInteger)use->distance : (NSInteger)low + (NSInteger)use->distance - 1;
+        if (0 > target || (NSInteger)[definitions count] <= target) {
+            continue;
+        }
+        NSString *name = [NSString stringWithFormat:@"%@#%ld", label, (long)target + 1];
+        [self addOccurrenceOfSymbol:name file:use->file line:use->line column:use->column length:use->length definition:NO];
+    }
+}
+
+
+- (XDTCrossReference *)crossReference
+{
+    [self resolveLocalUses];
+
+    NSArray<NSString *> *sortedNames = [_names sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+        return [a compare:b options:NSLiteralSearch];
+    }];
+    const NSUInteger symbolCount = [sortedNames count];
+    NSMutableData *finalIndexes = [NSMutableData dataWithLength:symbolCount * sizeof(uint32_t)];
+    uint32_t *finalIndex = [finalIndexes mutableBytes];
+    for (NSUInteger i = 0; i < symbolCount; i++) {
+        finalIndex[[[_symbolIndexes objectForKey:[sortedNames objectAtIndex:i]] unsignedIntegerValue]] = (uint32_t)i;
+    }
+
+    XDTCrossReferenceEntry *entries = [_entries mutableBytes];
+    const NSUInteger entryCount = [_entries length] / sizeof(XDTCrossReferenceEntry);
+    for (NSUInteger i = 0; i < entryCount; i++) {
+        entries[i].symbol = finalIndex[entries[i].symbol];
+    }
+    qsort(entries, entryCount, sizeof(XDTCrossReferenceEntry), XDTCrossReferenceCompareEntries);
+
+    NSMutableData *symbolStarts = [NSMutableData dataWithLength:(symbolCount + 1) * sizeof(uint32_t)];
+    uint32_t *starts = [symbolStarts mutableBytes];
+    for (NSUInteger i = 0, symbol = 0; symbol <= symbolCount; symbol++) {
+        while (i < entryCount && entries[i].symbol < symbol) {
+            i++;
+        }
+        starts[symbol] = (uint32_t)i;
+    }
+
+    NSMutableData *positions = [NSMutableData dataWithLength:entryCount * sizeof(uint32_t)];
+    uint32_t *position = [positions mutableBytes];
+    for (NSUInteger i = 0; i < entryCount; i++) {
+        position[i] = (uint32_t)i;
+    }
+    qsort_b(position, entryCount, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        const XDTCrossReferenceEntry *entryB = &entries[*(const uint32_t *)b];
+        return XDTCrossReferenceComparePositions(&entries[*(const uint32_t *)a], entryB->file, entryB->line, entryB->column);
+    });
+
+    XDTCrossReference *retVal = [[XDTCrossReference alloc] initWithFileURLs:_fileURLs symbolNames:sortedNames entries:_entries symbolStarts:symbolStarts positions:positions];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+@end
+
+
+#pragma mark - Implementation of class XDTCrossReference
+
+
+@implementation XDTCrossReference
+
+#pragma mark Initializers
+
++ (instancetype)crossReferenceOfSourceFile:(NSURL *)srcFile includeURLs:(NSArray<NSURL *> *)includeURLs symbolNames:(NSSet<NSString *> *)symbolNames syntax:(XDTCrossReferenceSyntax)syntax strict:(BOOL)isStrict error:(NSError **)error
+{
+    XDTCrossReferenceBuilder *builder = [[XDTCrossReferenceBuilder alloc] initWithIncludeURLs:includeURLs symbolNames:symbolNames syntax:syntax strict:isStrict];
+#if !__has_feature(objc_arc)
+    [builder autorelease];
+#endif
+    if (![[NSFileManager defaultManager] fileExistsAtPath:[srcFile path]]) {
+        /* The GPL Assembler gets just the name of its source file, which is found in the include path */
+        for (NSURL *includeURL in includeURLs) {
+            NSURL *candidateURL = [includeURL URLByAppendingPathComponent:[srcFile lastPathComponent]];
+            if ([[NSFileManager defaultManager] fileExistsAtPath:[candidateURL path]]) {
+                srcFile = candidateURL;
+                break;
+            }
+        }
+    }
+    if (![builder scanFileAtURL:srcFile error:error]) {
+        return nil;
+    }
+    return [builder crossReference];
+}
+
+
+- (instancetype)initWithFileURLs:(NSArray<NSURL *> *)fileURLs symbolNames:(NSArray<NSString *> *)symbolNames entries:(NSData *)entries symbolStarts:(NSData *)symbolStarts positions:(NSData *)positions
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _fileURLs = [fileURLs copy];
+    _symbolNames = [symbolNames copy];
+    _entries = [entries copy];
+    _symbolStarts = [symbolStarts copy];
+    _positions = [positions copy];
+    NSMutableArray<NSString *> *filePaths = [NSMutableArray arrayWithCapacity:[fileURLs count]];
+    for (NSURL *fileURL in fileURLs) {
+        [filePaths addObject:[[fileURL URLByStandardizingPath] path]];
+    }
+    _filePaths = [filePaths copy];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_fileURLs release];
+    [_symbolNames release];
+    [_entries release];
+    [_symbolStarts release];
+    [_positions release];
+    [_filePaths release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSUInteger)occurrenceCount
+{
+    return [_entries length] / sizeof(XDTCrossReferenceEntry);
+}
+
+
+- (NSUInteger)byteCount
+{
+    return [_entries length] + [_symbolStarts length] + [_positions length];
+}
+
+
+- (NSDictionary<XDTCrossReferenceKey, id> *)definitionOfSymbol:(NSString *)name
+{
+    const NSUInteger symbol = [self indexOfSymbol:name];
+    if (NSNotFound == symbol) {
+        return nil;
+    }
+    const uint32_t *starts = [_symbolStarts bytes];
+    const XDTCrossReferenceEntry *entry = (const XDTCrossReferenceEntry *)[_entries bytes] + starts[symbol];
+    if (starts[symbol] == starts[symbol + 1] || 0 == (entry->flags & XDTCrossReferenceFlagDefinition)) {
+        return nil;    /* an external symbol, or one of the assembler like a register */
+    }
+    return [self occurrenceOfEntry:entry];
+}
+
+
+- (NSArray<NSDictionary<XDTCrossReferenceKey, id> *> *)usesOfSymbol:(NSString *)name
+{
+    NSArray<NSDictionary<XDTCrossReferenceKey, id> *> *occurrences = [self occurrencesOfSymbol:name];
+    if (0 < [occurrences count] && [[[occurrences firstObject] objectForKey:XDTCrossReferenceDefinition] boolValue]) {
+        return [occurrences subarrayWithRange:NSMakeRange(1, [occurrences count] - 1)];
+    }
+    return occurrences;
+}
+
+
+- (NSArray<NSDictionary<XDTCrossReferenceKey, id> *> *)occurrencesOfSymbol:(NSString *)name
+{
+    const NSUInteger symbol = [self indexOfSymbol:name];
+    if (NSNotFound == symbol) {
+        return @[];
+    }
+    const uint32_t *starts = [_symbolStarts bytes];
+    const XDTCrossReferenceEntry *entries = [_entries bytes];
+    NSMutableArray<NSDictionary<XDTCrossReferenceKey, id> *> *retVal = [NSMutableArray arrayWithCapacity:starts[symbol + 1] - starts[symbol]];
+    for (uint32_t i = starts[symbol]; i < starts[symbol + 1]; i++) {
+        [retVal addObject:[self occurrenceOfEntry:&entries[i]]];
+    }
+    return retVal;
+}
+
+
+- (NSDictionary<XDTCrossReferenceKey, id> *)occurrenceAtFileURL:(NSURL *)fileURL line:(NSUInteger)line column:(NSUInteger)column
+{
+    const NSUInteger file = [_filePaths indexOfObject:[[fileURL URLByStandardizingPath] path]];
+    if (NSNotFound == file || UINT32_MAX < line) {
+        return nil;
+    }
+
+    /* the last occurrence which starts at or before the column */
+    const XDTCrossReferenceEntry *entries = [_entries bytes];
+    const uint32_t *positions = [_positions bytes];
+    const uint16_t searchColumn = (uint16_t)MIN(column, UINT16_MAX);
+    NSUInteger low = 0, high = [_positions length] / sizeof(uint32_t);
+    while (low < high) {
+        const NSUInteger mid = (low + high) / 2;
+        if (0 >= XDTCrossReferenceComparePositions(&entries[positions[mid]], (uint16_t)file, (uint32_t)line, searchColumn)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (0 == low) {
+        return nil;
+    }
+    const XDTCrossReferenceEntry *entry = &entries[positions[low - 1]];
+    if (file != entry->file || line != entry->line || column >= (NSUInteger)entry->column + entry->length) {
+        return nil;
+    }
+    return [self occurrenceOfEntry:entry];
+}
+
+
+#pragma mark - Private Methods
+
+
+- (NSUInteger)indexOfSymbol:(NSString *)name
+{
+    return [_symbolNames indexOfObject:name
+                         inSortedRange:NSMakeRange(0, [_symbolNames count])
+                               options:NSBinarySearchingFirstEqual
+                       usingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+                           return [a compare:b options:NSLiteralSearch];
+                       }];
+}
+
+
+- (NSDictionary<XDTCrossReferenceKey, id> *)occurrenceOfEntry:(const XDTCrossReferenceEntry *)entry
+{
+    return @{
+             XDTCrossReferenceSymbol: [_symbolNames objectAtIndex:entry->symbol],
+             XDTCrossReferenceFileURL: [_fileURLs objectAtIndex:entry->file],
+             XDTCrossReferenceLineNumber: [NSNumber numberWithUnsignedInt:entry->line],
+             XDTCrossReferenceColumn: [NSNumber numberWithUnsignedShort:entry->column],
+             XDTCrossReferenceLength: [NSNumber numberWithUnsignedShort:entry->length],
+             XDTCrossReferenceDefinition: [NSNumber numberWithBool:0 != (entry->flags & XDTCrossReferenceFlagDefinition)]
+             };
+}
+
+@end
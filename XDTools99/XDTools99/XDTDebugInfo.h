@@ -0,0 +1,89 @@
+//
+//  XDTDebugInfo.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+@class XDTAddressMap;
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTDebugInfoKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
+
+FOUNDATION_EXPORT XDTDebugInfoKey const XDTDebugInfoSymbolName;     /* Name of the symbol as NSString */
+FOUNDATION_EXPORT XDTDebugInfoKey const XDTDebugInfoSymbolValue;    /* The value of the symbol as NSNumber, 0 for a REF */
+FOUNDATION_EXPORT XDTDebugInfoKey const XDTDebugInfoSymbolLocation; /* The line index of a label like in the locations of xas99 as NSNumber, missing for other symbols */
+FOUNDATION_EXPORT XDTDebugInfoKey const XDTDebugInfoDefinition;     /* A BOOL NSNumber, YES for a symbol of DEF */
+FOUNDATION_EXPORT XDTDebugInfoKey const XDTDebugInfoReference;      /* A BOOL NSNumber, YES for a symbol of REF */
+
+
+/**
+ The debug information of an assembled program in a versioned binary file: the symbol table, the XOPs, the REF and
+ DEF flags of the symbols and the address map of the source lines.
+
+ All tables are stored sorted in records of fixed size, so a reader maps the file into memory and looks up symbols
+ by name or address, XOPs by name and source lines by address and back by a binary search, without parsing and
+ without copying the tables. Opening checks only the header and that every table lies within the file, so it takes
+ the same time for any size, and a file which does not pass fails with XDTErrorCodeDebugInfo. The lookups check each
+ index they read, a damaged index just yields no result. The file names and the address map are built on first use.
+
+ File layout (version 1, little endian, every table aligned to 8 bytes):
+    header      "XDT99DBG", version (uint16), header size (uint16), flags (uint32, 0), and offset and count (uint32
+                each) of the tables: strings, files, symbols, symbols by value, XOPs, ranges, address order
+    strings     UTF-8 names, each terminated by a zero byte
+    files       string offset (uint32) of each source file name, in the order of the listing
+    symbols     name (uint32 string offset), location (uint32, 0xFFFFFFFF if none), value (uint16), flags (uint16,
+                1 = DEF, 2 = REF), sorted by the bytes of the name
+    by value    index (uint32) of each symbol, sorted by value and name
+    XOPs        name (uint32 string offset), number (uint32), sorted by the bytes of the name
+    ranges      line (uint32), file (uint16), bank (uint16), address (uint16), length (uint16), sorted by file, line and address
+    address     index (uint32) of each range, sorted by bank and address
+ */
+@interface XDTDebugInfo : NSObject
+
+@property (readonly) NSUInteger version;
+@property (readonly) NSArray<NSString *> *fileNames;    /* The source file and all copied files in the order of the listing */
+@property (readonly) NSUInteger symbolCount;
+@property (readonly) NSUInteger xopCount;
+@property (readonly) NSUInteger byteCount;              /* Size of the file */
+@property (readonly) XDTAddressMap *addressMap;         /* Searches the ranges of the file in place */
+
+/* The content of a debug info file. Symbols of refdefs with a value are DEF, symbols without a value REF. */
++ (NSData *)dataWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(nullable NSArray<NSString *> *)refdefs xops:(nullable NSDictionary<NSString *, NSNumber *> *)xops locations:(nullable NSDictionary<NSString *, NSNumber *> *)locations addressMap:(nullable XDTAddressMap *)addressMap;
+
+/* Maps the file into memory */
++ (nullable instancetype)debugInfoWithContentsOfURL:(NSURL *)url error:(NSError **)error;
++ (nullable instancetype)debugInfoWithData:(NSData *)data error:(NSError **)error;
+
+- (nullable NSDictionary<XDTDebugInfoKey, id> *)symbolNamed:(NSString *)name;
+/* The symbol with the greatest value at or below the address, of several with this value the first by name */
+- (nullable NSDictionary<XDTDebugInfoKey, id> *)symbolAtAddress:(NSUInteger)address;
+/* NSNotFound for an unknown XOP */
+- (NSUInteger)numberOfXop:(NSString *)name;
+
+@end
+
+NS_ASSUME_NONNULL_END
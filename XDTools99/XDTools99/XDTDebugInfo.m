@@ -0,0 +1,481 @@
+//
+//  XDTDebugInfo.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTDebugInfo.h"
+
+#import "XDTObject.h"
+#import "XDTAddressMap.h"
+
+
+#define XDTDebugInfoMagic "XDT99DBG"
+#define XDTDebugInfoVersion 1
+#define XDTDebugInfoTableAlignment 8
+#define XDTDebugInfoNoLocation UINT32_MAX
+
+#define XDTDebugInfoFlagDefinition 0x0001
+#define XDTDebugInfoFlagReference 0x0002
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+XDTDebugInfoKey const XDTDebugInfoSymbolName = @"XDTDebugInfoSymbolName";
+XDTDebugInfoKey const XDTDebugInfoSymbolValue = @"XDTDebugInfoSymbolValue";
+XDTDebugInfoKey const XDTDebugInfoSymbolLocation = @"XDTDebugInfoSymbolLocation";
+XDTDebugInfoKey const XDTDebugInfoDefinition = @"XDTDebugInfoDefinition";
+XDTDebugInfoKey const XDTDebugInfoReference = @"XDTDebugInfoReference";
+
+
+/* Offset in bytes from the start of the file and number of entries, bytes for the strings */
+typedef struct {
+    uint32_t offset;
+    uint32_t count;
+} XDTDebugInfoTable;
+
+
+typedef struct {
+    char magic[8];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t flags;
+    XDTDebugInfoTable strings;
+    XDTDebugInfoTable files;
+    XDTDebugInfoTable symbols;
+    XDTDebugInfoTable symbolsByValue;
+    XDTDebugInfoTable xops;
+    XDTDebugInfoTable ranges;
+    XDTDebugInfoTable addressOrder;
+} XDTDebugInfoHeader;
+
+
+typedef struct {
+    uint32_t name;      /* Offset into the strings */
+    uint32_t location;
+    uint16_t value;
+    uint16_t flags;
+} XDTDebugInfoSymbol;
+
+
+typedef struct {
+    uint32_t name;
+    uint32_t number;
+} XDTDebugInfoXop;
+
+
+/* The layout of the ranges of XDTAddressMap, which searches them in place */
+typedef struct {
+    uint32_t line;
+    uint16_t file;
+    uint16_t bank;
+    uint16_t address;
+    uint16_t length;
+} XDTDebugInfoRange;
+
+
+@interface XDTAddressMap ()
+
+- (instancetype)initWithFileNames:(NSArray<NSString *> *)fileNames sortedRanges:(NSData *)ranges addressOrder:(NSData *)addressOrder storage:(NSData *)storage;
+- (NSData *)rangeData;
+- (NSData *)addressOrderData;
+
+@end
+
+
+@interface XDTDebugInfo () {
+    NSData *_data;
+    const XDTDebugInfoHeader *_header;
+    NSArray<NSString *> *_fileNames;
+    XDTAddressMap *_addressMap;
+}
+
+- (nullable instancetype)initWithData:(NSData *)data error:(NSError **)error;
+
+- (const char *)stringAtOffset:(uint32_t)offset;
+- (NSDictionary<XDTDebugInfoKey, id> *)entryOfSymbol:(const XDTDebugInfoSymbol *)symbol;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static NSError *XDTDebugInfoError(void)
+{
+    NSBundle *myBundle = [NSBundle bundleForClass:[XDTDebugInfo class]];
+    return [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeDebugInfo
+                           userInfo:@{
+                                      NSLocalizedDescriptionKey: NSLocalizedStringFromTableInBundle(@"Invalid debug info file", nil, myBundle, @"Description for an error object, discribing that a debug info file is damaged or of an unknown version."),
+                                      NSLocalizedRecoverySuggestionErrorKey: NSLocalizedStringFromTableInBundle(@"The file is damaged or was written by a newer version of XDTools99.", nil, myBundle, @"Recovery suggestion for an error object, which explains why a debug info file cannot be read.")
+                                      }];
+}
+
+
+/* Names are sorted by their UTF-8 bytes, which is the order of strcmp() in the reader */
+static NSComparisonResult XDTDebugInfoCompareNames(NSString *nameA, NSString *nameB)
+{
+    const int retVal = strcmp([nameA UTF8String], [nameB UTF8String]);
+    return (0 > retVal)? NSOrderedAscending : ((0 < retVal)? NSOrderedDescending : NSOrderedSame);
+}
+
+
+static uint32_t XDTDebugInfoAppendString(NSMutableData *strings, NSString *string)
+{
+    const uint32_t retVal = (uint32_t)[strings length];
+    const char *utf8String = [string UTF8String];
+    [strings appendBytes:utf8String length:strlen(utf8String) + 1];
+    return retVal;
+}
+
+
+static XDTDebugInfoTable XDTDebugInfoAppendTable(NSMutableData *data, NSData *table, NSUInteger count)
+{
+    const NSUInteger padding = (XDTDebugInfoTableAlignment - [data length] % XDTDebugInfoTableAlignment) % XDTDebugInfoTableAlignment;
+    [data increaseLengthBy:padding];
+    const XDTDebugInfoTable retVal = {(uint32_t)[data length], (uint32_t)count};
+    [data appendData:table];
+    return retVal;
+}
+
+
+/* The table lies within the file and is aligned for its entries */
+static BOOL XDTDebugInfoIsValidTable(XDTDebugInfoTable table, size_t entrySize, NSUInteger fileLength)
+{
+    return 0 == table.offset % 4 && (uint64_t)table.offset + (uint64_t)table.count * entrySize <= fileLength;
+}
+
+
+@implementation XDTDebugInfo
+
+#pragma mark Initializers
+
++ (NSData *)dataWithSymbols:(NSDictionary<NSString *, NSNumber *> *)symbols refdefs:(NSArray<NSString *> *)refdefs xops:(NSDictionary<NSString *, NSNumber *> *)xops locations:(NSDictionary<NSString *, NSNumber *> *)locations addressMap:(XDTAddressMap *)addressMap
+{
+    NSMutableData *strings = [NSMutableData data];
+    NSSet<NSString *> *definitions = [NSSet setWithArray:(nil == refdefs)? @[] : refdefs];
+
+    NSArray<NSString *> *fileNames = (nil == addressMap)? @[] : [addressMap fileNames];
+    NSMutableData *files = [NSMutableData dataWithCapacity:[fileNames count] * sizeof(uint32_t)];
+    for (NSString *fileName in fileNames) {
+        const uint32_t name = XDTDebugInfoAppendString(strings, fileName);
+        [files appendBytes:&name length:sizeof(name)];
+    }
+
+    /* symbols without a 16 bit value are the REF symbols of xas99, the wrapper returns them as -1 */
+    NSArray<NSString *> *symbolNames = [[symbols allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString *nameA, NSString *nameB) {
+        return XDTDebugInfoCompareNames(nameA, nameB);
+    }];
+    const NSUInteger symbolCount = [symbolNames count];
+    NSMutableData *symbolTable = [NSMutableData dataWithLength:symbolCount * sizeof(XDTDebugInfoSymbol)];
+    XDTDebugInfoSymbol *symbol = [symbolTable mutableBytes];
+    NSMutableData *valueOrder = [NSMutableData dataWithCapacity:symbolCount * sizeof(uint32_t)];
+    for (NSUInteger i = 0; i < symbolCount; i++) {
+        NSString *name = [symbolNames objectAtIndex:i];
+        const long value = [[symbols objectForKey:name] longValue];
+        NSNumber *location = [locations objectForKey:name];
+        symbol[i].name = XDTDebugInfoAppendString(strings, name);
+        symbol[i].location = (nil == location)? XDTDebugInfoNoLocation : (uint32_t)[location unsignedIntegerValue];
+        if (0 <= value && UINT16_MAX >= value) {
+            symbol[i].value = (uint16_t)value;
+            symbol[i].flags = [definitions containsObject:name]? XDTDebugInfoFlagDefinition : 0;
+            const uint32_t index = (uint32_t)i;
+            [valueOrder appendBytes:&index length:sizeof(index)];
+        } else {
+            symbol[i].value = 0;
+            symbol[i].flags = XDTDebugInfoFlagReference;
+        }
+    }
+    /* the symbols are sorted by name, so the index is the tie breaker of equal values */
+    const NSUInteger valueCount = [valueOrder length] / sizeof(uint32_t);
+    qsort_b([valueOrder mutableBytes], valueCount, sizeof(uint32_t), ^int(const void *a, const void *b) {
+        const uint32_t indexA = *(const uint32_t *)a;
+        const uint32_t indexB = *(const uint32_t *)b;
+        if (symbol[indexA].value != symbol[indexB].value) {
+            return (symbol[indexA].value < symbol[indexB].value)? -1 : 1;
+        }
+        return (indexA < indexB)? -1 : ((indexA > indexB)? 1 : 0);
+    });
+
+    NSArray<NSString *> *xopNames = [[xops allKeys] sortedArrayUsingComparator:^NSComparisonResult(NSString *nameA, NSString *nameB) {
+        return XDTDebugInfoCompareNames(nameA, nameB);
+    }];
+    NSMutableData *xopTable = [NSMutableData dataWithCapacity:[xopNames count] * sizeof(XDTDebugInfoXop)];
+    for (NSString *name in xopNames) {
+        const XDTDebugInfoXop xop = {XDTDebugInfoAppendString(strings, name), (uint32_t)[[xops objectForKey:name] unsignedIntegerValue]};
+        [xopTable appendBytes:&xop length:sizeof(xop)];
+    }
+
+    NSData *ranges = (nil == addressMap)? [NSData data] : [addressMap rangeData];
+    NSData *addressOrder = (nil == addressMap)? [NSData data] : [addressMap addressOrderData];
+
+    XDTDebugInfoHeader header = {XDTDebugInfoMagic, XDTDebugInfoVersion, sizeof(XDTDebugInfoHeader), 0};
+    NSMutableData *retVal = [NSMutableData dataWithLength:sizeof(XDTDebugInfoHeader)];
+    header.strings = XDTDebugInfoAppendTable(retVal, strings, [strings length]);
+    header.files = XDTDebugInfoAppendTable(retVal, files, [fileNames count]);
+    header.symbols = XDTDebugInfoAppendTable(retVal, symbolTable, symbolCount);
+    header.symbolsByValue = XDTDebugInfoAppendTable(retVal, valueOrder, valueCount);
+    header.xops = XDTDebugInfoAppendTable(retVal, xopTable, [xopNames count]);
+    header.ranges = XDTDebugInfoAppendTable(retVal, ranges, [ranges length] / sizeof(XDTDebugInfoRange));
+    header.addressOrder = XDTDebugInfoAppendTable(retVal, addressOrder, [addressOrder length] / sizeof(uint32_t));
+    [retVal replaceBytesInRange:NSMakeRange(0, sizeof(header)) withBytes:&header];
+
+    return retVal;
+}
+
+
++ (instancetype)debugInfoWithContentsOfURL:(NSURL *)url error:(NSError **)error
+{
+    NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:error];
+    if (nil == data) {
+        return nil;
+    }
+    return [self debugInfoWithData:data error:error];
+}
+
+
++ (instancetype)debugInfoWithData:(NSData *)data error:(NSError **)error
+{
+    XDTDebugInfo *retVal = [[XDTDebugInfo alloc] initWithData:data error:error];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    /* the file was written by a little endian Mac, only the tables are checked, every lookup checks the indexes it reads */
+    _data = [data copy];
+    const NSUInteger length = [_data length];
+    const uint8_t *bytes = [_data bytes];
+    const XDTDebugInfoHeader *header = (const XDTDebugInfoHeader *)bytes;
+    const BOOL isValid = NS_LittleEndian == NSHostByteOrder() && sizeof(XDTDebugInfoHeader) <= length &&
+                         0 == memcmp(header->magic, XDTDebugInfoMagic, sizeof(header->magic)) &&
+                         XDTDebugInfoVersion == header->version && sizeof(XDTDebugInfoHeader) <= header->headerSize &&
+                         XDTDebugInfoIsValidTable(header->strings, 1, length) &&
+                         XDTDebugInfoIsValidTable(header->files, sizeof(uint32_t), length) &&
+                         XDTDebugInfoIsValidTable(header->symbols, sizeof(XDTDebugInfoSymbol), length) &&
+                         XDTDebugInfoIsValidTable(header->symbolsByValue, sizeof(uint32_t), length) &&
+                         XDTDebugInfoIsValidTable(header->xops, sizeof(XDTDebugInfoXop), length) &&
+                         XDTDebugInfoIsValidTable(header->ranges, sizeof(XDTDebugInfoRange), length) &&
+                         XDTDebugInfoIsValidTable(header->addressOrder, sizeof(uint32_t), length) &&
+                         (0 == header->strings.count || '\0' == bytes[header->strings.offset + header->strings.count - 1]);
+    if (!isValid) {
+        if (nil != error) {
+            *error = XDTDebugInfoError();
+        }
+#if !__has_feature(objc_arc)
+        [self release];
+#endif
+        return nil;
+    }
+
+    _header = header;
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_data release];
+    [_fileNames release];
+    [_addressMap release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSUInteger)version
+{
+    return _header->version;
+}
+
+
+- (NSUInteger)symbolCount
+{
+    return _header->symbols.count;
+}
+
+
+- (NSUInteger)xopCount
+{
+    return _header->xops.count;
+}
+
+
+- (NSUInteger)byteCount
+{
+    return [_data length];
+}
+
+
+/* Built on first use, so opening does not depend on the number of files */
+- (NSArray<NSString *> *)fileNames
+{
+    @synchronized (self) {
+        if (nil == _fileNames) {
+            const uint32_t *fileNameOffsets = (const uint32_t *)((const uint8_t *)[_data bytes] + _header->files.offset);
+            NSMutableArray<NSString *> *fileNames = [NSMutableArray arrayWithCapacity:_header->files.count];
+            for (uint32_t i = 0; i < _header->files.count; i++) {
+                NSString *fileName = [NSString stringWithUTF8String:[self stringAtOffset:fileNameOffsets[i]]];
+                [fileNames addObject:(nil == fileName)? @"" : fileName];
+            }
+            _fileNames = [fileNames copy];
+        }
+        return _fileNames;
+    }
+}
+
+
+/* The address map searches the tables in the file, which it keeps alive */
+- (XDTAddressMap *)addressMap
+{
+    NSArray<NSString *> *fileNames = [self fileNames];
+    @synchronized (self) {
+        if (nil == _addressMap) {
+            const uint8_t *bytes = [_data bytes];
+            NSData *rangeData = [NSData dataWithBytesNoCopy:(void *)(bytes + _header->ranges.offset) length:_header->ranges.count * sizeof(XDTDebugInfoRange) freeWhenDone:NO];
+            NSData *addressOrderData = [NSData dataWithBytesNoCopy:(void *)(bytes + _header->addressOrder.offset) length:_header->addressOrder.count * sizeof(uint32_t) freeWhenDone:NO];
+            _addressMap = [[XDTAddressMap alloc] initWithFileNames:fileNames sortedRanges:rangeData addressOrder:addressOrderData storage:_data];
+        }
+        return _addressMap;
+    }
+}
+
+
+- (NSDictionary<XDTDebugInfoKey, id> *)symbolNamed:(NSString *)name
+{
+    const char *utf8Name = [name UTF8String];
+    const XDTDebugInfoSymbol *symbols = (const XDTDebugInfoSymbol *)((const uint8_t *)[_data bytes] + _header->symbols.offset);
+    NSUInteger low = 0, high = _header->symbols.count;
+    while (low < high) {
+        const NSUInteger mid = (low + high) / 2;
+        const int comparison = strcmp([self stringAtOffset:symbols[mid].name], utf8Name);
+        if (0 == comparison) {
+            return [self entryOfSymbol:&symbols[mid]];
+        }
+        if (0 > comparison) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nil;
+}
+
+
+- (NSDictionary<XDTDebugInfoKey, id> *)symbolAtAddress:(NSUInteger)address
+{
+    if (UINT16_MAX < address) {
+        address = UINT16_MAX;
+    }
+
+    /* the first symbol of the greatest value at or below the address */
+    const uint8_t *bytes = [_data bytes];
+    const XDTDebugInfoSymbol *symbols = (const XDTDebugInfoSymbol *)(bytes + _header->symbols.offset);
+    const uint32_t *order = (const uint32_t *)(bytes + _header->symbolsByValue.offset);
+    const uint32_t symbolCount = _header->symbols.count;
+    NSUInteger low = 0, high = _header->symbolsByValue.count;
+    while (low < high) {
+        const NSUInteger mid = (low + high) / 2;
+        if (symbolCount <= order[mid]) {
+            return nil;     /* damaged file */
+        }
+        if (symbols[order[mid]].value <= address) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (0 == low || symbolCount <= order[low - 1]) {
+        return nil;
+    }
+    const uint16_t value = symbols[order[low - 1]].value;
+    while (0 < low - 1 && symbolCount > order[low - 2] && symbols[order[low - 2]].value == value) {
+        low--;
+    }
+    return [self entryOfSymbol:&symbols[order[low - 1]]];
+}
+
+
+- (NSUInteger)numberOfXop:(NSString *)name
+{
+    const char *utf8Name = [name UTF8String];
+    const XDTDebugInfoXop *xops = (const XDTDebugInfoXop *)((const uint8_t *)[_data bytes] + _header->xops.offset);
+    NSUInteger low = 0, high = _header->xops.count;
+    while (low < high) {
+        const NSUInteger mid = (low + high) / 2;
+        const int comparison = strcmp([self stringAtOffset:xops[mid].name], utf8Name);
+        if (0 == comparison) {
+            return xops[mid].number;
+        }
+        if (0 > comparison) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return NSNotFound;
+}
+
+
+#pragma mark - Private Methods
+
+
+/* The string table ends with a zero byte, so every offset within it is a terminated string */
+- (const char *)stringAtOffset:(uint32_t)offset
+{
+    if (_header->strings.count <= offset) {
+        return "";
+    }
+    return (const char *)[_data bytes] + _header->strings.offset + offset;
+}
+
+
+- (NSDictionary<XDTDebugInfoKey, id> *)entryOfSymbol:(const XDTDebugInfoSymbol *)symbol
+{
+    NSString *name = [NSString stringWithUTF8String:[self stringAtOffset:symbol->name]];
+    NSMutableDictionary<XDTDebugInfoKey, id> *retVal = [NSMutableDictionary dictionaryWithDictionary:@{
+             XDTDebugInfoSymbolName: (nil == name)? @"" : name,
+             XDTDebugInfoSymbolValue: [NSNumber numberWithUnsignedShort:symbol->value],
+             XDTDebugInfoDefinition: [NSNumber numberWithBool:0 != (symbol->flags & XDTDebugInfoFlagDefinition)],
+             XDTDebugInfoReference: [NSNumber numberWithBool:0 != (symbol->flags & XDTDebugInfoFlagReference)]
+             }];
+    if (XDTDebugInfoNoLocation != symbol->location) {
+        [retVal setObject:[NSNumber numberWithUnsignedInt:symbol->location] forKey:XDTDebugInfoSymbolLocation];
+    }
+    return retVal;
+}
+
+@end
@@ -0,0 +1,85 @@
+//
+//  XDTDiskImage.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+typedef NS_ENUM(NSUInteger, XDTDiskFormat) {
+    XDTDiskFormatSSSD = 360,    /* Single sided, single density, 40 tracks with 9 sectors (90 KiB) */
+    XDTDiskFormatDSSD = 720,    /* Double sided, single density, 40 tracks with 9 sectors (180 KiB) */
+    XDTDiskFormatDSDD = 1440,   /* Double sided, double density, 40 tracks with 18 sectors (360 KiB) */
+};
+
+typedef NS_ENUM(NSUInteger, XDTDiskFileType) {
+    XDTDiskFileTypeProgram,             /* PROGRAM, memory images like E/A option 5 or BASIC programs in internal format */
+    XDTDiskFileTypeDisplayFixed,        /* DIS/FIX, i.e. object code for E/A option 3 in records of 80 bytes */
+    XDTDiskFileTypeDisplayVariable,     /* DIS/VAR, i.e. source code in records of 80 bytes */
+    XDTDiskFileTypeInternalFixed,       /* INT/FIX */
+    XDTDiskFileTypeInternalVariable,    /* INT/VAR, i.e. BASIC programs in long format in records of 254 bytes */
+};
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A sector dump of a TI disk (V9T9 or PC99 format without track data), which is read and written without Python.
+
+ Files are written straight into the sectors of the image with the layout of the TI disk controller: sector 0 holds
+ the volume information block with the allocation bitmap, sector 1 the alphabetically sorted index of the file
+ descriptor records (FDR), which are allocated from sector 2 on, while the data of the files is allocated from
+ sector 34 on. Writing a file with the name of an existing file replaces it.
+
+ An image which was read from a file remembers its modified sectors, so writing it back to the same file only
+ writes these sectors.
+ */
+@interface XDTDiskImage : NSObject
+
+@property (readonly) NSString *volumeName;
+@property (readonly) NSUInteger totalSectors;
+@property (readonly) NSUInteger freeSectors;
+@property (readonly) NSArray<NSString *> *fileNames;
+
++ (instancetype)diskImageWithVolumeName:(NSString *)volumeName format:(XDTDiskFormat)format;
++ (nullable instancetype)diskImageWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+- (BOOL)writeProgramFile:(NSString *)fileName data:(NSData *)data error:(NSError **)error;
+- (BOOL)writeFile:(NSString *)fileName type:(XDTDiskFileType)type recordLength:(NSUInteger)recordLength records:(NSArray<NSData *> *)records error:(NSError **)error;
+- (BOOL)removeFile:(NSString *)fileName error:(NSError **)error;
+
+/* Output of -[XDTAs99Objcode generateImageAt:error:], the name of each following image is incremented at its last character */
+- (BOOL)writeProgramImages:(NSArray<NSData *> *)images fileName:(NSString *)fileName error:(NSError **)error;
+/* Output of -[XDTAs99Objcode generateObjCode:error:] as DIS/FIX 80 file */
+- (BOOL)writeObjectCode:(NSData *)objectCode fileName:(NSString *)fileName error:(NSError **)error;
+/* Output of -[XDTBasic getImageUsingLongFormat:error:], the long format is written as INT/VAR 254 file */
+- (BOOL)writeBasicProgram:(NSData *)program longFormat:(BOOL)useLongFormat fileName:(NSString *)fileName error:(NSError **)error;
+
+/* The file with a TIFILES header of 128 bytes, as it is used to transfer files of TI disks on other file systems */
+- (nullable NSData *)tifilesDataOfFile:(NSString *)fileName error:(NSError **)error;
+
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,720 @@
+//
+//  XDTDiskImage.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTDiskImage.h"
+
+#import "XDTObject.h"
+
+#include <libkern/OSByteOrder.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+
+#define XDTDiskSectorSize 256
+#define XDTDiskFirstFDRSector 2
+#define XDTDiskFirstDataSector 34
+#define XDTDiskMaxFiles 127
+#define XDTDiskMaxClusters 76
+#define XDTDiskNameLength 10
+#define XDTDiskBitmapOffset 56
+#define XDTDiskMaxSectors (200 * 8)     /* The allocation bitmap has 200 bytes */
+
+#define XDTDiskFlagProgram 0x01
+#define XDTDiskFlagInternal 0x02
+#define XDTDiskFlagVariable 0x80
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface XDTDiskImage () {
+    NSMutableData *_image;
+    NSMutableIndexSet *_modifiedSectors;
+    NSURL *_imageURL;
+}
+
+- (instancetype)initWithVolumeName:(NSString *)volumeName format:(XDTDiskFormat)format;
+- (nullable instancetype)initWithData:(NSData *)data url:(NSURL *)url error:(NSError **)error;
+
+- (uint8_t *)bytesOfSector:(NSUInteger)sector;
+- (BOOL)isAllocatedSector:(NSUInteger)sector;
+- (void)setSector:(NSUInteger)sector allocated:(BOOL)allocated;
+- (nullable NSArray<NSValue *> *)allocateSectors:(NSUInteger)count;
+- (NSUInteger)allocateFDR;
+
+- (NSMutableArray<NSNumber *> *)fdrIndex;
+- (void)setFDRIndex:(NSArray<NSNumber *> *)fdrIndex;
+- (NSUInteger)fdrOfFile:(NSString *)fileName;
+- (nullable NSArray<NSNumber *> *)dataSectorsOfFDR:(NSUInteger)fdr;
+- (void)removeFDR:(NSUInteger)fdr;
+
+- (BOOL)writeFile:(NSString *)fileName flags:(uint8_t)flags recordsPerSector:(uint8_t)recordsPerSector recordLength:(uint8_t)recordLength eofOffset:(uint8_t)eofOffset level3Records:(uint16_t)level3Records sectors:(NSData *)sectors error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static NSError *XDTDiskImageError(NSString *description, NSString *suggestion)
+{
+    return [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeDiskImage
+                           userInfo:@{NSLocalizedDescriptionKey: description, NSLocalizedRecoverySuggestionErrorKey: suggestion}];
+}
+
+
+/* Returns the name padded with spaces to the 10 bytes of the FDR, or nil if it is no valid file name of a TI disk. */
+static NSData *XDTDiskNameData(NSString *name)
+{
+    NSData *nameData = [name dataUsingEncoding:NSASCIIStringEncoding allowLossyConversion:NO];
+    if (nil == nameData || 0 == [nameData length] || XDTDiskNameLength < [nameData length] ||
+        NSNotFound != [name rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@". "]].location) {
+        return nil;
+    }
+    NSMutableData *retVal = [NSMutableData dataWithData:nameData];
+    [retVal appendBytes:"          " length:XDTDiskNameLength - [nameData length]];
+    return retVal;
+}
+
+
+static NSString *XDTDiskNameString(const uint8_t *bytes)
+{
+    NSString *name = [[NSString alloc] initWithBytes:bytes length:XDTDiskNameLength encoding:NSASCIIStringEncoding];
+#if !__has_feature(objc_arc)
+    [name autorelease];
+#endif
+    return [name stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+}
+
+
+@implementation XDTDiskImage
+
+#pragma mark Initializers
+
++ (instancetype)diskImageWithVolumeName:(NSString *)volumeName format:(XDTDiskFormat)format
+{
+    XDTDiskImage *retVal = [[XDTDiskImage alloc] initWithVolumeName:volumeName format:format];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
++ (instancetype)diskImageWithContentsOfURL:(NSURL *)url error:(NSError **)error
+{
+    NSData *data = [NSData dataWithContentsOfURL:url options:0 error:error];
+    if (nil == data) {
+        return nil;
+    }
+    XDTDiskImage *retVal = [[XDTDiskImage alloc] initWithData:data url:url error:error];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithVolumeName:(NSString *)volumeName format:(XDTDiskFormat)format
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _totalSectors = format;
+    _image = [[NSMutableData alloc] initWithLength:format * XDTDiskSectorSize];
+    _modifiedSectors = [[NSMutableIndexSet alloc] initWithIndexesInRange:NSMakeRange(0, format)];
+
+    /* Volume information block, the name is cut to a valid length like the disk manager of the TI does it */
+    uint8_t *vib = [self bytesOfSector:0];
+    NSData *nameData = [volumeName dataUsingEncoding:NSASCIIStringEncoding allowLossyConversion:YES];
+    memset(vib, ' ', XDTDiskNameLength);
+    memcpy(vib, [nameData bytes], MIN([nameData length], XDTDiskNameLength));
+    OSWriteBigInt16(vib, 10, format);
+    vib[12] = (XDTDiskFormatDSDD == format)? 18 : 9;
+    memcpy(vib + 13, "DSK", 3);
+    vib[16] = ' ';
+    vib[17] = 40;
+    vib[18] = (XDTDiskFormatSSSD == format)? 1 : 2;
+    vib[19] = (XDTDiskFormatDSDD == format)? 2 : 1;
+    for (NSUInteger sector = format; sector < XDTDiskMaxSectors; sector++) {
+        vib[XDTDiskBitmapOffset + sector / 8] |= 1 << (sector % 8);
+    }
+    [self setSector:0 allocated:YES];
+    [self setSector:1 allocated:YES];
+
+    return self;
+}
+
+
+- (instancetype)initWithData:(NSData *)data url:(NSURL *)url error:(NSError **)error
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    const uint8_t *vib = [data bytes];
+    const NSUInteger totalSectors = (2 * XDTDiskSectorSize <= [data length])? OSReadBigInt16(vib, 10) : 0;
+    if (2 > totalSectors || 0 != [data length] % XDTDiskSectorSize || 0 != memcmp(vib + 13, "DSK", 3) ||
+        XDTDiskMaxSectors < totalSectors || [data length] < totalSectors * XDTDiskSectorSize) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            *error = XDTDiskImageError(NSLocalizedStringFromTableInBundle(@"Invalid disk image", nil, myBundle, @"Description for an error object, discribing that a file is not a disk image."),
+                                       NSLocalizedStringFromTableInBundle(@"The file is not a sector dump of a TI disk.", nil, myBundle, @"Recovery suggestion for an error object, which explains the expected format of disk images."));
+        }
+#if !__has_feature(objc_arc)
+        [self release];
+#endif
+        return nil;
+    }
+
+    _totalSectors = totalSectors;
+    _image = [data mutableCopy];
+    _modifiedSectors = [[NSMutableIndexSet alloc] init];
+    _imageURL = [[url URLByStandardizingPath] copy];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_image release];
+    [_modifiedSectors release];
+    [_imageURL release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSString *)volumeName
+{
+    return XDTDiskNameString([self bytesOfSector:0]);
+}
+
+
+- (NSUInteger)freeSectors
+{
+    NSUInteger retVal = 0;
+    for (NSUInteger sector = 0; sector < _totalSectors; sector++) {
+        if (![self isAllocatedSector:sector]) {
+            retVal++;
+        }
+    }
+    return retVal;
+}
+
+
+- (NSArray<NSString *> *)fileNames
+{
+    NSMutableArray<NSString *> *retVal = [NSMutableArray array];
+    for (NSNumber *fdr in [self fdrIndex]) {
+        [retVal addObject:XDTDiskNameString([self bytesOfSector:[fdr unsignedIntegerValue]])];
+    }
+    return retVal;
+}
+
+
+#pragma mark - File Methods
+
+
+- (BOOL)writeProgramFile:(NSString *)fileName data:(NSData *)data error:(NSError **)error
+{
+    const NSUInteger sectorCount = ([data length] + XDTDiskSectorSize - 1) / XDTDiskSectorSize;
+    NSMutableData *sectors = [NSMutableData dataWithData:data];
+    [sectors setLength:sectorCount * XDTDiskSectorSize];
+    return [self writeFile:fileName flags:XDTDiskFlagProgram recordsPerSector:0 recordLength:0
+                 eofOffset:[data length] % XDTDiskSectorSize level3Records:0 sectors:sectors error:error];
+}
+
+
+/*
+ Fixed records never span sectors, the rest of a sector is left empty. Variable records are stored with a leading
+ length byte, also without spanning sectors, and the last record of each sector is followed by the byte 0xff.
+ The FDR counts the records of fixed files but the sectors of variable files.
+ */
+- (BOOL)writeFile:(NSString *)fileName type:(XDTDiskFileType)type recordLength:(NSUInteger)recordLength records:(NSArray<NSData *> *)records error:(NSError **)error
+{
+    if (XDTDiskFileTypeProgram == type) {
+        NSMutableData *data = [NSMutableData data];
+        for (NSData *record in records) {
+            [data appendData:record];
+        }
+        return [self writeProgramFile:fileName data:data error:error];
+    }
+
+    const BOOL isVariable = XDTDiskFileTypeDisplayVariable == type || XDTDiskFileTypeInternalVariable == type;
+    NSNumber *longestRecord = [records valueForKeyPath:@"@max.length"];
+    if (0 == recordLength || (isVariable? 254 : 255) < recordLength || recordLength < [longestRecord unsignedIntegerValue]) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            *error = XDTDiskImageError(NSLocalizedStringFromTableInBundle(@"Invalid record length", nil, myBundle, @"Description for an error object, discribing that the records do not fit into a file of a disk image."),
+                                       NSLocalizedStringFromTableInBundle(@"Records of files on TI disks have 1 to 255 bytes, variable records up to 254 bytes, and every record must fit into the record length of its file.", nil, myBundle, @"Recovery suggestion for an error object, which explains the valid record lengths of disk files."));
+        }
+        return NO;
+    }
+
+    const uint8_t flags = (isVariable? XDTDiskFlagVariable : 0) | ((XDTDiskFileTypeInternalFixed == type || XDTDiskFileTypeInternalVariable == type)? XDTDiskFlagInternal : 0);
+    NSMutableData *sectors = [NSMutableData data];
+    if (!isVariable) {
+        const NSUInteger recordsPerSector = MIN(255, XDTDiskSectorSize / recordLength);
+        [sectors setLength:([records count] + recordsPerSector - 1) / recordsPerSector * XDTDiskSectorSize];
+        uint8_t *bytes = [sectors mutableBytes];
+        NSUInteger recordIndex = 0;
+        for (NSData *record in records) {
+            const NSUInteger offset = recordIndex / recordsPerSector * XDTDiskSectorSize + recordIndex % recordsPerSector * recordLength;
+            memcpy(bytes + offset, [record bytes], [record length]);
+            recordIndex++;
+        }
+        return [self writeFile:fileName flags:flags recordsPerSector:recordsPerSector recordLength:recordLength
+                     eofOffset:0 level3Records:[records count] sectors:sectors error:error];
+    }
+
+    uint8_t sector[XDTDiskSectorSize];
+    NSUInteger position = 0;
+    memset(sector, 0, sizeof(sector));
+    for (NSData *record in records) {
+        if (XDTDiskSectorSize - 1 < position + 1 + [record length]) {
+            sector[position] = 0xff;
+            [sectors appendBytes:sector length:sizeof(sector)];
+            memset(sector, 0, sizeof(sector));
+            position = 0;
+        }
+        sector[position] = [record length];
+        memcpy(sector + position + 1, [record bytes], [record length]);
+        position += 1 + [record length];
+    }
+    if (0 < [records count]) {
+        sector[position] = 0xff;
+        [sectors appendBytes:sector length:sizeof(sector)];
+    }
+    return [self writeFile:fileName flags:flags recordsPerSector:(XDTDiskSectorSize - 1) / (recordLength + 1) recordLength:recordLength
+                 eofOffset:position level3Records:[sectors length] / XDTDiskSectorSize sectors:sectors error:error];
+}
+
+
+- (BOOL)removeFile:(NSString *)fileName error:(NSError **)error
+{
+    const NSUInteger fdr = [self fdrOfFile:fileName];
+    if (NSNotFound == fdr) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            *error = XDTDiskImageError(NSLocalizedStringFromTableInBundle(@"File not found", nil, myBundle, @"Description for an error object, discribing that a file is missing on a disk image."),
+                                       [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"The disk image does not contain a file named '%@'.", nil, myBundle, @"Recovery suggestion for an error object, which names the file missing on a disk image."), fileName]);
+        }
+        return NO;
+    }
+    [self removeFDR:fdr];
+    return YES;
+}
+
+
+- (BOOL)writeProgramImages:(NSArray<NSData *> *)images fileName:(NSString *)fileName error:(NSError **)error
+{
+    NSString *imageName = fileName;
+    for (NSData *data in images) {
+        if (![self writeProgramFile:imageName data:data error:error]) {
+            return NO;
+        }
+        unichar nextChar = [imageName characterAtIndex:[imageName length] - 1] + 1;
+        imageName = [[imageName substringToIndex:[imageName length] - 1] stringByAppendingFormat:@"%C", nextChar];
+    }
+    return YES;
+}
+
+
+/*
+ xas99 ends every record of 80 columns with a line feed. Compressed object code may contain line feeds inside of
+ its records, so the records are taken by their length whenever every 81st byte is a line feed.
+ */
+- (BOOL)writeObjectCode:(NSData *)objectCode fileName:(NSString *)fileName error:(NSError **)error
+{
+    const NSUInteger recordLength = 80;
+    const uint8_t *bytes = [objectCode bytes];
+    const NSUInteger length = [objectCode length];
+    BOOL hasFixedRecords = 0 == length % (recordLength + 1);
+    for (NSUInteger offset = recordLength; hasFixedRecords && offset < length; offset += recordLength + 1) {
+        hasFixedRecords = '\n' == bytes[offset];
+    }
+
+    NSMutableArray<NSData *> *records = [NSMutableArray array];
+    NSUInteger start = 0;
+    while (start < length) {
+        NSUInteger end = start;
+        if (hasFixedRecords) {
+            end += recordLength;
+        } else {
+            while (end < length && '\n' != bytes[end]) {
+                end++;
+            }
+        }
+        [records addObject:[objectCode subdataWithRange:NSMakeRange(start, MIN(end - start, recordLength))]];
+        start = end + 1;
+    }
+    return [self writeFile:fileName type:XDTDiskFileTypeDisplayFixed recordLength:recordLength records:records error:error];
+}
+
+
+/* xbas99 returns a program in long format as a sequence of records, each with a leading length byte */
+- (BOOL)writeBasicProgram:(NSData *)program longFormat:(BOOL)useLongFormat fileName:(NSString *)fileName error:(NSError **)error
+{
+    if (!useLongFormat) {
+        return [self writeProgramFile:fileName data:program error:error];
+    }
+
+    NSMutableArray<NSData *> *records = [NSMutableArray array];
+    const uint8_t *bytes = [program bytes];
+    NSUInteger offset = 0;
+    while (offset < [program length]) {
+        const NSUInteger recordLength = MIN((NSUInteger)bytes[offset], [program length] - offset - 1);
+        [records addObject:[program subdataWithRange:NSMakeRange(offset + 1, recordLength)]];
+        offset += 1 + recordLength;
+    }
+    return [self writeFile:fileName type:XDTDiskFileTypeInternalVariable recordLength:254 records:records error:error];
+}
+
+
+- (NSData *)tifilesDataOfFile:(NSString *)fileName error:(NSError **)error
+{
+    const NSUInteger fdr = [self fdrOfFile:fileName];
+    NSArray<NSNumber *> *dataSectors = (NSNotFound == fdr)? nil : [self dataSectorsOfFDR:fdr];
+    if (nil == dataSectors) {
+        if (nil != error) {
+            NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+            *error = XDTDiskImageError(NSLocalizedStringFromTableInBundle(@"File not found", nil, myBundle, @"Description for an error object, discribing that a file is missing on a disk image."),
+                                       [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"The disk image does not contain a file named '%@'.", nil, myBundle, @"Recovery suggestion for an error object, which names the file missing on a disk image."), fileName]);
+        }
+        return nil;
+    }
+
+    /* The header contains the fields of the FDR in another order, followed by the file name */
+    const uint8_t *fdrBytes = [self bytesOfSector:fdr];
+    NSMutableData *retVal = [NSMutableData dataWithCapacity:128 + [dataSectors count] * XDTDiskSectorSize];
+    uint8_t header[128];
+    memset(header, 0, sizeof(header));
+    memcpy(header, "\x07TIFILES", 8);
+    memcpy(header + 8, fdrBytes + 14, 2);   /* sector count */
+    memcpy(header + 10, fdrBytes + 12, 2);  /* flags and records per sector */
+    memcpy(header + 12, fdrBytes + 16, 4);  /* EOF offset, record length and number of level 3 records */
+    memcpy(header + 16, fdrBytes, XDTDiskNameLength);
+    [retVal appendBytes:header length:sizeof(header)];
+    for (NSNumber *sector in dataSectors) {
+        [retVal appendBytes:[self bytesOfSector:[sector unsignedIntegerValue]] length:XDTDiskSectorSize];
+    }
+    return retVal;
+}
+
+
+- (BOOL)writeToURL:(NSURL *)url error:(NSError **)error
+{
+    NSURL *standardizedURL = [url URLByStandardizingPath];
+    if (nil != _imageURL && [_imageURL isEqual:standardizedURL]) {
+        /* Only the modified sectors are written back into the image file, if it still has the same size */
+        const int fd = open([[standardizedURL path] fileSystemRepresentation], O_WRONLY);
+        if (0 <= fd && (off_t)[_image length] == lseek(fd, 0, SEEK_END)) {
+            const uint8_t *bytes = [_image bytes];
+            __block BOOL isWritten = YES;
+            [_modifiedSectors enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+                const size_t length = range.length * XDTDiskSectorSize;
+                const off_t offset = range.location * XDTDiskSectorSize;
+                if ((ssize_t)length != pwrite(fd, bytes + offset, length, offset)) {
+                    isWritten = NO;
+                    *stop = YES;
+                }
+            }];
+            if (isWritten) {
+                isWritten = 0 == close(fd);
+            } else {
+                const int writeError = errno;
+                close(fd);
+                errno = writeError;
+            }
+            if (!isWritten) {
+                if (nil != error) {
+                    *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSURLErrorKey: url}];
+                }
+                return NO;
+            }
+            [_modifiedSectors removeAllIndexes];
+            return YES;
+        }
+        if (0 <= fd) {
+            close(fd);
+        }
+    }
+
+    if (![_image writeToURL:url options:NSDataWritingAtomic error:error]) {
+        return NO;
+    }
+#if !__has_feature(objc_arc)
+    [_imageURL release];
+#endif
+    _imageURL = [standardizedURL copy];
+    [_modifiedSectors removeAllIndexes];
+    return YES;
+}
+
+
+#pragma mark - Private Methods
+
+
+- (uint8_t *)bytesOfSector:(NSUInteger)sector
+{
+    return (uint8_t *)[_image mutableBytes] + sector * XDTDiskSectorSize;
+}
+
+
+- (BOOL)isAllocatedSector:(NSUInteger)sector
+{
+    const uint8_t *vib = [self bytesOfSector:0];
+    return 0 != (vib[XDTDiskBitmapOffset + sector / 8] & (1 << (sector % 8)));
+}
+
+
+- (void)setSector:(NSUInteger)sector allocated:(BOOL)allocated
+{
+    uint8_t *vib = [self bytesOfSector:0];
+    if (allocated) {
+        vib[XDTDiskBitmapOffset + sector / 8] |= 1 << (sector % 8);
+    } else {
+        vib[XDTDiskBitmapOffset + sector / 8] &= ~(1 << (sector % 8));
+    }
+    [_modifiedSectors addIndex:0];
+}
+
+
+/*
+ Allocates the sectors like the disk controller does, from sector 34 on and then the sectors left free for FDRs.
+ Returns the ranges of the allocated clusters, or nil if there are not enough free sectors or they are spread over
+ more clusters than an FDR can hold. Nothing is allocated in that case.
+ */
+- (NSArray<NSValue *> *)allocateSectors:(NSUInteger)count
+{
+    NSMutableArray<NSValue *> *retVal = [NSMutableArray array];
+    NSUInteger remaining = count;
+    for (NSUInteger i = 0; 0 < remaining && i < _totalSectors - XDTDiskFirstFDRSector; i++) {
+        const NSUInteger sector = (XDTDiskFirstDataSector + i < _totalSectors)? XDTDiskFirstDataSector + i : XDTDiskFirstFDRSector + i - (_totalSectors - XDTDiskFirstDataSector);
+        if ([self isAllocatedSector:sector]) {
+            continue;
+        }
+        NSRange lastCluster = [[retVal lastObject] rangeValue];
+        if (nil != [retVal lastObject] && NSMaxRange(lastCluster) == sector) {
+            lastCluster.length++;
+            [retVal replaceObjectAtIndex:[retVal count] - 1 withObject:[NSValue valueWithRange:lastCluster]];
+        } else {
+            [retVal addObject:[NSValue valueWithRange:NSMakeRange(sector, 1)]];
+        }
+        remaining--;
+    }
+    if (0 < remaining || XDTDiskMaxClusters < [retVal count]) {
+        return nil;
+    }
+
+    for (NSValue *cluster in retVal) {
+        const NSRange range = [cluster rangeValue];
+        for (NSUInteger sector = range.location; sector < NSMaxRange(range); sector++) {
+            [self setSector:sector allocated:YES];
+        }
+    }
+    return retVal;
+}
+
+
+- (NSUInteger)allocateFDR
+{
+    for (NSUInteger i = 0; i < _totalSectors - XDTDiskFirstFDRSector; i++) {
+        const NSUInteger sector = XDTDiskFirstFDRSector + i;
+        if (![self isAllocatedSector:sector]) {
+            [self setSector:sector allocated:YES];
+            return sector;
+        }
+    }
+    return NSNotFound;
+}
+
+
+/* The index in sector 1 contains the sector numbers of all FDRs, sorted by the file names and ended by 0. */
+- (NSMutableArray<NSNumber *> *)fdrIndex
+{
+    NSMutableArray<NSNumber *> *retVal = [NSMutableArray array];
+    const uint8_t *bytes = [self bytesOfSector:1];
+    for (NSUInteger i = 0; i < XDTDiskMaxFiles; i++) {
+        const NSUInteger fdr = OSReadBigInt16(bytes, 2 * i);
+        if (XDTDiskFirstFDRSector > fdr || _totalSectors <= fdr) {
+            break;
+        }
+        [retVal addObject:[NSNumber numberWithUnsignedInteger:fdr]];
+    }
+    return retVal;
+}
+
+
+- (void)setFDRIndex:(NSArray<NSNumber *> *)fdrIndex
+{
+    NSArray<NSNumber *> *sortedIndex = [fdrIndex sortedArrayUsingComparator:^NSComparisonResult(NSNumber *fdr1, NSNumber *fdr2) {
+        const int result = memcmp([self bytesOfSector:[fdr1 unsignedIntegerValue]], [self bytesOfSector:[fdr2 unsignedIntegerValue]], XDTDiskNameLength);
+        return (0 > result)? NSOrderedAscending : (0 < result)? NSOrderedDescending : NSOrderedSame;
+    }];
+    uint8_t *bytes = [self bytesOfSector:1];
+    memset(bytes, 0, XDTDiskSectorSize);
+    for (NSUInteger i = 0; i < [sortedIndex count]; i++) {
+        OSWriteBigInt16(bytes, 2 * i, [[sortedIndex objectAtIndex:i] unsignedShortValue]);
+    }
+    [_modifiedSectors addIndex:1];
+}
+
+
+- (NSUInteger)fdrOfFile:(NSString *)fileName
+{
+    NSData *nameData = XDTDiskNameData(fileName);
+    if (nil == nameData) {
+        return NSNotFound;
+    }
+    for (NSNumber *fdr in [self fdrIndex]) {
+        if (0 == memcmp([self bytesOfSector:[fdr unsignedIntegerValue]], [nameData bytes], XDTDiskNameLength)) {
+            return [fdr unsignedIntegerValue];
+        }
+    }
+    return NSNotFound;
+}
+
+
+/*
+ The data chain of an FDR starts at byte 28 with blocks of 3 bytes. Each block contains the first sector of a
+ cluster and the offset of the last sector of that cluster within the file, both with 12 bits:
+    first sector = byte0 | (byte1 & 0x0f) << 8, last offset = byte1 >> 4 | byte2 << 4
+ Returns nil, if the chain is inconsistent with the sector count of the FDR.
+ */
+- (NSArray<NSNumber *> *)dataSectorsOfFDR:(NSUInteger)fdr
+{
+    const uint8_t *fdrBytes = [self bytesOfSector:fdr];
+    const NSUInteger sectorCount = OSReadBigInt16(fdrBytes, 14);
+    NSMutableArray<NSNumber *> *retVal = [NSMutableArray arrayWithCapacity:sectorCount];
+    for (NSUInteger i = 0; i < XDTDiskMaxClusters && [retVal count] < sectorCount; i++) {
+        const uint8_t *block = fdrBytes + 28 + 3 * i;
+        const NSUInteger firstSector = block[0] | (block[1] & 0x0f) << 8;
+        const NSUInteger lastOffset = block[1] >> 4 | block[2] << 4;
+        if (0 == firstSector || lastOffset < [retVal count] || _totalSectors <= firstSector + lastOffset - [retVal count]) {
+            return nil;
+        }
+        for (NSUInteger sector = firstSector; [retVal count] <= lastOffset; sector++) {
+            [retVal addObject:[NSNumber numberWithUnsignedInteger:sector]];
+        }
+    }
+    return (sectorCount == [retVal count])? retVal : nil;
+}
+
+
+- (void)removeFDR:(NSUInteger)fdr
+{
+    for (NSNumber *sector in [self dataSectorsOfFDR:fdr]) {
+        [self setSector:[sector unsignedIntegerValue] allocated:NO];
+    }
+    memset([self bytesOfSector:fdr], 0, XDTDiskSectorSize);
+    [_modifiedSectors addIndex:fdr];
+    [self setSector:fdr allocated:NO];
+
+    NSMutableArray<NSNumber *> *fdrIndex = [self fdrIndex];
+    [fdrIndex removeObject:[NSNumber numberWithUnsignedInteger:fdr]];
+    [self setFDRIndex:fdrIndex];
+}
+
+
+- (BOOL)writeFile:(NSString *)fileName flags:(uint8_t)flags recordsPerSector:(uint8_t)recordsPerSector recordLength:(uint8_t)recordLength eofOffset:(uint8_t)eofOffset level3Records:(uint16_t)level3Records sectors:(NSData *)sectors error:(NSError **)error
+{
+    NSBundle *myBundle = [NSBundle bundleForClass:[self class]];
+    NSData *nameData = XDTDiskNameData(fileName);
+    if (nil == nameData) {
+        if (nil != error) {
+            *error = XDTDiskImageError(NSLocalizedStringFromTableInBundle(@"Invalid file name", nil, myBundle, @"Description for an error object, discribing that a file name is not valid on a disk image."),
+                                       NSLocalizedStringFromTableInBundle(@"File names on TI disks have 1 to 10 characters without spaces and periods.", nil, myBundle, @"Recovery suggestion for an error object, which explains the valid file names of disk images."));
+        }
+        return NO;
+    }
+
+    /* A file which replaces another one may need its sectors, so the image is restored if the new file does not fit */
+    NSData *previousImage = [_image copy];
+    NSIndexSet *previousModifiedSectors = [_modifiedSectors copy];
+#if !__has_feature(objc_arc)
+    [previousImage autorelease];
+    [previousModifiedSectors autorelease];
+#endif
+    const NSUInteger previousFDR = [self fdrOfFile:fileName];
+    if (NSNotFound != previousFDR) {
+        [self removeFDR:previousFDR];
+    }
+
+    const NSUInteger sectorCount = [sectors length] / XDTDiskSectorSize;
+    NSMutableArray<NSNumber *> *fdrIndex = [self fdrIndex];
+    const NSUInteger fdr = (XDTDiskMaxFiles > [fdrIndex count])? [self allocateFDR] : NSNotFound;
+    NSArray<NSValue *> *clusters = (NSNotFound == fdr)? nil : [self allocateSectors:sectorCount];
+    if (nil == clusters) {
+        [_image setData:previousImage];
+        [_modifiedSectors removeAllIndexes];
+        [_modifiedSectors addIndexes:previousModifiedSectors];
+        if (nil != error) {
+            *error = XDTDiskImageError(NSLocalizedStringFromTableInBundle(@"Disk full", nil, myBundle, @"Description for an error object, discribing that a file does not fit on a disk image."),
+                                       [NSString stringWithFormat:NSLocalizedStringFromTableInBundle(@"The disk image has not enough free sectors for the file '%@' or already contains 127 files.", nil, myBundle, @"Recovery suggestion for an error object, which explains why a file does not fit on a disk image."), fileName]);
+        }
+        return NO;
+    }
+
+    uint8_t *fdrBytes = [self bytesOfSector:fdr];
+    memset(fdrBytes, 0, XDTDiskSectorSize);
+    memcpy(fdrBytes, [nameData bytes], XDTDiskNameLength);
+    fdrBytes[12] = flags;
+    fdrBytes[13] = recordsPerSector;
+    OSWriteBigInt16(fdrBytes, 14, sectorCount);
+    fdrBytes[16] = eofOffset;
+    fdrBytes[17] = recordLength;
+    OSWriteLittleInt16(fdrBytes, 18, level3Records);
+
+    const uint8_t *sectorBytes = [sectors bytes];
+    uint8_t *block = fdrBytes + 28;
+    NSUInteger fileOffset = 0;
+    for (NSValue *cluster in clusters) {
+        const NSRange range = [cluster rangeValue];
+        memcpy([self bytesOfSector:range.location], sectorBytes + fileOffset * XDTDiskSectorSize, range.length * XDTDiskSectorSize);
+        [_modifiedSectors addIndexesInRange:range];
+        fileOffset += range.length;
+        block[0] = range.location & 0xff;
+        block[1] = (range.location >> 8 & 0x0f) | ((fileOffset - 1) & 0x0f) << 4;
+        block[2] = (fileOffset - 1) >> 4 & 0xff;
+        block += 3;
+    }
+    [_modifiedSectors addIndex:fdr];
+
+    [fdrIndex addObject:[NSNumber numberWithUnsignedInteger:fdr]];
+    [self setFDRIndex:fdrIndex];
+    return YES;
+}
+
+@end
@@ -0,0 +1,107 @@
+//
+//  XDTInstrumentation.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTInstrumentationCategory NS_EXTENSIBLE_STRING_ENUM;
+
+FOUNDATION_EXPORT XDTInstrumentationCategory const XDTInstrumentationCategoryImport;       /* Importing a Python module */
+FOUNDATION_EXPORT XDTInstrumentationCategory const XDTInstrumentationCategoryPython;       /* Calling a constructor or method of a Python object */
+FOUNDATION_EXPORT XDTInstrumentationCategory const XDTInstrumentationCategoryConversion;   /* Converting Python results into Foundation objects */
+
+
+@class XDTInstrumentation, XDTPythonProfiler;
+
+
+/**
+ A single recorded phase. All times are in nanoseconds, the start time is relative to the creation of the
+ instrumentation object which recorded the phase.
+ */
+@interface XDTInstrumentationPhase : NSObject
+
+@property (readonly) NSString *name;
+@property (readonly) XDTInstrumentationCategory category;
+@property (readonly) uint64_t startTime;
+@property (readonly) uint64_t duration;
+@property (readonly) uint64_t threadID;
+@property (readonly) NSUInteger bytesToPython;     /* Payload of strings passed as arguments into Python */
+@property (readonly) NSUInteger bytesFromPython;   /* Payload of strings in the result returned by Python */
+@property (readonly) NSUInteger objectCount;       /* Python objects returned or Foundation objects created */
+
+@end
+
+
+@protocol XDTInstrumentationDelegate <NSObject>
+
+/* Called on the thread which has finished the phase. */
+- (void)instrumentation:(XDTInstrumentation *)instrumentation didRecordPhase:(XDTInstrumentationPhase *)phase;
+
+@end
+
+
+/**
+ Opt-in recorder for the phases of the tool wrappers.
+
+ Set an instance to the instrumentation property of any XDTObject, or pass it with the instrumentation option key
+ to the factory method of a tool, to include the module import and the constructor. Objcode objects inherit the
+ instrumentation of the assembler which created them. Without an instrumentation object the wrappers only send
+ messages to nil, so nothing is measured.
+
+ The recorded phases can be observed by KVO on the phases property or by a delegate, and written as a trace file
+ in the Chrome trace event format which can be loaded into chrome://tracing or Perfetto.
+ */
+@interface XDTInstrumentation : NSObject
+
+@property (nullable, weak) id<XDTInstrumentationDelegate> delegate;
+/* Profiles the Python code during the import and Python phases, when set */
+@property (nullable, retain) XDTPythonProfiler *pythonProfiler;
+
+@property (readonly) NSArray<XDTInstrumentationPhase *> *phases;   /* KVO compliant, insertions are notified */
+@property (readonly) uint64_t totalDuration;
+@property (readonly) NSUInteger totalBytesToPython;
+@property (readonly) NSUInteger totalBytesFromPython;
+@property (readonly) NSUInteger totalObjectCount;
+
++ (instancetype)instrumentation;
+
+- (void)reset;
+
+/* Returns nil when called on nil, so the calls in the wrappers need no checks. */
+- (nullable XDTInstrumentationPhase *)beginPhase:(NSString *)name category:(XDTInstrumentationCategory)category;
+/*
+ The result and the NULL terminated arguments are PyObjects like for PyObject_CallMethodObjArgs(). The strings in
+ them are counted as bytes and the objects of the result are counted, but only when the phase is recorded.
+ */
+- (void)endPhase:(nullable XDTInstrumentationPhase *)phase returning:(nullable void *)result passing:(nullable void *)argument, ... NS_REQUIRES_NIL_TERMINATION;
+- (void)endPhase:(nullable XDTInstrumentationPhase *)phase convertingObjects:(NSUInteger)objectCount;
+
+- (NSData *)chromeTraceData;
+- (BOOL)writeChromeTraceToURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,369 @@
+//
+//  XDTInstrumentation.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTInstrumentation.h"
+
+#import <Python/Python.h>
+
+#import "XDTPythonGIL.h"
+#import "XDTPythonProfiler.h"
+
+#include <mach/mach_time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+
+/* Nested lists of tuples are the deepest results of the wrapped methods, so there is no need to walk deeper. */
+#define XDTInstrumentationMaxDepth 4
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+XDTInstrumentationCategory const XDTInstrumentationCategoryImport = @"import";
+XDTInstrumentationCategory const XDTInstrumentationCategoryPython = @"python";
+XDTInstrumentationCategory const XDTInstrumentationCategoryConversion = @"conversion";
+
+
+@interface XDTInstrumentationPhase ()
+
+@property NSString *name;
+@property XDTInstrumentationCategory category;
+@property uint64_t startTime;
+@property uint64_t duration;
+@property uint64_t threadID;
+@property NSUInteger bytesToPython;
+@property NSUInteger bytesFromPython;
+@property NSUInteger objectCount;
+@property (nullable) XDTPythonProfiler *pythonProfiler;   /* the profiler which records this phase */
+
+@end
+
+
+@interface XDTPythonProfiler ()
+
+- (BOOL)beginPhase:(NSString *)name;
+- (void)endPhase;
+
+@end
+
+
+@interface XDTInstrumentation () {
+    NSMutableArray<XDTInstrumentationPhase *> *_phases;
+    uint64_t _originTime;
+    mach_timebase_info_data_t _timebase;
+}
+
+- (uint64_t)currentTime;
+- (void)recordPhase:(XDTInstrumentationPhase *)phase;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+/* Sums up the payload of all strings in a Python result and counts the visited objects. */
+static void XDTInstrumentationMeasurePythonObject(PyObject *object, NSUInteger depth, NSUInteger *bytes, NSUInteger *objects)
+{
+    if (NULL == object) {
+        return;
+    }
+    *objects += 1;
+    if (PyString_Check(object)) {
+        *bytes += (NSUInteger)PyString_GET_SIZE(object);
+    } else if (PyUnicode_Check(object)) {
+        *bytes += (NSUInteger)PyUnicode_GET_DATA_SIZE(object);
+    } else if (XDTInstrumentationMaxDepth > depth) {
+        if (PyTuple_Check(object)) {
+            const Py_ssize_t count = PyTuple_GET_SIZE(object);
+            for (Py_ssize_t i = 0; i < count; i++) {
+                XDTInstrumentationMeasurePythonObject(PyTuple_GET_ITEM(object, i), depth + 1, bytes, objects);
+            }
+        } else if (PyList_Check(object)) {
+            const Py_ssize_t count = PyList_GET_SIZE(object);
+            for (Py_ssize_t i = 0; i < count; i++) {
+                XDTInstrumentationMeasurePythonObject(PyList_GET_ITEM(object, i), depth + 1, bytes, objects);
+            }
+        } else if (PyDict_Check(object)) {
+            Py_ssize_t i = 0;
+            PyObject *key = NULL;
+            PyObject *value = NULL;
+            while (PyDict_Next(object, &i, &key, &value)) {
+                XDTInstrumentationMeasurePythonObject(key, depth + 1, bytes, objects);
+                XDTInstrumentationMeasurePythonObject(value, depth + 1, bytes, objects);
+            }
+        }
+    }
+}
+
+
+@implementation XDTInstrumentationPhase
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"%@ %@.%@: %llu ns, %lu bytes to Python, %lu bytes from Python, %lu objects",
+            [super description], _category, _name, _duration, (unsigned long)_bytesToPython, (unsigned long)_bytesFromPython, (unsigned long)_objectCount];
+}
+
+@end
+
+
+@implementation XDTInstrumentation
+
+#pragma mark Initializers
+
++ (instancetype)instrumentation
+{
+    XDTInstrumentation *retVal = [[XDTInstrumentation alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _phases = [NSMutableArray array];
+    mach_timebase_info(&_timebase);
+    _originTime = mach_absolute_time();
+
+    return self;
+}
+
+
+#pragma mark - Accessors
+
+
++ (BOOL)automaticallyNotifiesObserversOfPhases
+{
+    return NO;
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingTotalDuration
+{
+    return [NSSet setWithObject:NSStringFromSelector(@selector(phases))];
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingTotalBytesToPython
+{
+    return [NSSet setWithObject:NSStringFromSelector(@selector(phases))];
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingTotalBytesFromPython
+{
+    return [NSSet setWithObject:NSStringFromSelector(@selector(phases))];
+}
+
+
++ (NSSet<NSString *> *)keyPathsForValuesAffectingTotalObjectCount
+{
+    return [NSSet setWithObject:NSStringFromSelector(@selector(phases))];
+}
+
+
+- (NSArray<XDTInstrumentationPhase *> *)phases
+{
+    @synchronized (self) {
+        return [NSArray arrayWithArray:_phases];
+    }
+}
+
+
+- (uint64_t)totalDuration
+{
+    return [[self.phases valueForKeyPath:@"@sum.duration"] unsignedLongLongValue];
+}
+
+
+- (NSUInteger)totalBytesToPython
+{
+    return [[self.phases valueForKeyPath:@"@sum.bytesToPython"] unsignedIntegerValue];
+}
+
+
+- (NSUInteger)totalBytesFromPython
+{
+    return [[self.phases valueForKeyPath:@"@sum.bytesFromPython"] unsignedIntegerValue];
+}
+
+
+- (NSUInteger)totalObjectCount
+{
+    return [[self.phases valueForKeyPath:@"@sum.objectCount"] unsignedIntegerValue];
+}
+
+
+- (uint64_t)currentTime
+{
+    return (mach_absolute_time() - _originTime) * _timebase.numer / _timebase.denom;
+}
+
+
+#pragma mark - Recording
+
+
+- (void)reset
+{
+    NSString *key = NSStringFromSelector(@selector(phases));
+    @synchronized (self) {
+        [self willChangeValueForKey:key];
+        [_phases removeAllObjects];
+        _originTime = mach_absolute_time();
+        [self didChangeValueForKey:key];
+    }
+}
+
+
+- (XDTInstrumentationPhase *)beginPhase:(NSString *)name category:(XDTInstrumentationCategory)category
+{
+    XDTInstrumentationPhase *retVal = [[XDTInstrumentationPhase alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    retVal.name = name;
+    retVal.category = category;
+    uint64_t threadID = 0;
+    pthread_threadid_np(NULL, &threadID);
+    retVal.threadID = threadID;
+    XDTPythonProfiler *pythonProfiler = self.pythonProfiler;
+    if (nil != pythonProfiler && ([XDTInstrumentationCategoryPython isEqualToString:category] || [XDTInstrumentationCategoryImport isEqualToString:category]) &&
+        [pythonProfiler beginPhase:name]) {
+        retVal.pythonProfiler = pythonProfiler;
+    }
+    retVal.startTime = [self currentTime];  /* as late as possible, so the set up is not part of the phase */
+
+    return retVal;
+}
+
+
+- (void)endPhase:(XDTInstrumentationPhase *)phase returning:(void *)result passing:(void *)argument, ...
+{
+    const uint64_t endTime = [self currentTime];
+    if (nil == phase) {
+        return;
+    }
+    XDTAcquireGIL();
+    [phase.pythonProfiler endPhase];
+    phase.pythonProfiler = nil;
+
+    NSUInteger bytesToPython = 0;
+    NSUInteger argumentObjects = 0;
+    va_list arguments;
+    va_start(arguments, argument);
+    for (void *object = argument; NULL != object; object = va_arg(arguments, void *)) {
+        XDTInstrumentationMeasurePythonObject((PyObject *)object, 0, &bytesToPython, &argumentObjects);
+    }
+    va_end(arguments);
+
+    NSUInteger bytesFromPython = 0;
+    NSUInteger resultObjects = 0;
+    XDTInstrumentationMeasurePythonObject((PyObject *)result, 0, &bytesFromPython, &resultObjects);
+
+    phase.duration = endTime - phase.startTime;
+    phase.bytesToPython = bytesToPython;
+    phase.bytesFromPython = bytesFromPython;
+    phase.objectCount = resultObjects;
+    [self recordPhase:phase];
+}
+
+
+- (void)endPhase:(XDTInstrumentationPhase *)phase convertingObjects:(NSUInteger)objectCount
+{
+    const uint64_t endTime = [self currentTime];
+    if (nil == phase) {
+        return;
+    }
+    [phase.pythonProfiler endPhase];
+    phase.pythonProfiler = nil;
+
+    phase.duration = endTime - phase.startTime;
+    phase.objectCount = objectCount;
+    [self recordPhase:phase];
+}
+
+
+- (void)recordPhase:(XDTInstrumentationPhase *)phase
+{
+    NSString *key = NSStringFromSelector(@selector(phases));
+    @synchronized (self) {
+        NSIndexSet *indexes = [NSIndexSet indexSetWithIndex:[_phases count]];
+        [self willChange:NSKeyValueChangeInsertion valuesAtIndexes:indexes forKey:key];
+        [_phases addObject:phase];
+        [self didChange:NSKeyValueChangeInsertion valuesAtIndexes:indexes forKey:key];
+    }
+
+    [self.delegate instrumentation:self didRecordPhase:phase];
+}
+
+
+#pragma mark - Chrome Trace Export
+
+
+/*
+ The trace is a JSON object of the Chrome trace event format with complete events ("ph": "X"), their time stamps and
+ durations are in microseconds:
+    {"traceEvents": [{"name": "assemble", "cat": "python", "ph": "X", "ts": 12.3, "dur": 4.5, "pid": 1, "tid": 2,
+                      "args": {"bytesToPython": 0, "bytesFromPython": 0, "objectCount": 0}}, ...],
+     "displayTimeUnit": "ms"}
+ */
+- (NSData *)chromeTraceData
+{
+    NSArray<XDTInstrumentationPhase *> *phases = self.phases;
+    NSMutableArray<NSDictionary<NSString *, id> *> *traceEvents = [NSMutableArray arrayWithCapacity:[phases count]];
+    NSNumber *processID = [NSNumber numberWithInt:getpid()];
+    for (XDTInstrumentationPhase *phase in phases) {
+        [traceEvents addObject:@{
+                                 @"name": phase.name,
+                                 @"cat": phase.category,
+                                 @"ph": @"X",
+                                 @"ts": [NSNumber numberWithDouble:phase.startTime / 1000.0],
+                                 @"dur": [NSNumber numberWithDouble:phase.duration / 1000.0],
+                                 @"pid": processID,
+                                 @"tid": [NSNumber numberWithUnsignedLongLong:phase.threadID],
+                                 @"args": @{
+                                         @"bytesToPython": [NSNumber numberWithUnsignedInteger:phase.bytesToPython],
+                                         @"bytesFromPython": [NSNumber numberWithUnsignedInteger:phase.bytesFromPython],
+                                         @"objectCount": [NSNumber numberWithUnsignedInteger:phase.objectCount]
+                                         }
+                                 }];
+    }
+
+    return [NSJSONSerialization dataWithJSONObject:@{@"traceEvents": traceEvents, @"displayTimeUnit": @"ms"} options:0 error:nil];
+}
+
+
+- (BOOL)writeChromeTraceToURL:(NSURL *)url error:(NSError **)error
+{
+    return [[self chromeTraceData] writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+@end
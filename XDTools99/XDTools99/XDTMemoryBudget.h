@@ -0,0 +1,76 @@
+//
+//  XDTMemoryBudget.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTObject.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NSString * XDTMemoryUsageKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry */
+
+FOUNDATION_EXPORT XDTMemoryUsageKey const XDTMemoryUsageClassName;      /* Class of the wrapper object as NSString */
+FOUNDATION_EXPORT XDTMemoryUsageKey const XDTMemoryUsagePythonObjects;  /* Number of reachable Python objects as NSNumber */
+FOUNDATION_EXPORT XDTMemoryUsageKey const XDTMemoryUsagePythonBytes;    /* Bytes of the reachable Python objects as NSNumber */
+FOUNDATION_EXPORT XDTMemoryUsageKey const XDTMemoryUsageNativeBytes;    /* Bytes of the native outputs and tables as NSNumber */
+FOUNDATION_EXPORT XDTMemoryUsageKey const XDTMemoryUsageLastUse;        /* Date of the last assembling or generated output as NSDate */
+FOUNDATION_EXPORT XDTMemoryUsageKey const XDTMemoryUsageDetachable;     /* Object code which still holds Python objects as NSNumber with a BOOL */
+
+
+/**
+ The memory of all living wrapper objects, and a limit for it.
+
+ The tools and the object code note their use, so the budget knows every wrapper object which may hold Python
+ objects, without keeping it alive. The usage report is for monitoring, e.g. by a debug view of an application.
+
+ The usage of each object is measured once and kept until the object is used again, so only the objects which have
+ changed are walked again. A Python object which is reachable from several wrapper objects, like the symbols of an
+ assembler and of its object code, is counted once for the object which was measured first.
+
+ Whenever the assemblers have created a new object code and the usage of all wrapper objects is above the limit,
+ the captured outputs of the least recently used object codes and the source caches of the assemblers are removed
+ first, because they are generated or read again at their next use. If that is not enough, the least recently used
+ object code is detached until the usage is below the limit again. Detached object code keeps its generated outputs,
+ so only outputs which were not captured at that time become unavailable. Otherwise the tools are counted, but never
+ changed, they release their Python objects when they are released.
+ */
+@interface XDTMemoryBudget : NSObject
+
+@property NSUInteger byteLimit;                 /* Python and native bytes of all wrapper objects, 0 is unlimited (the default) */
+@property (readonly) NSUInteger detachCount;    /* Number of object codes detached to keep the limit */
+@property (readonly) NSUInteger evictionCount;  /* Number of times captured outputs or cached sources were removed to keep the limit */
+
++ (instancetype)sharedBudget;
+
+- (void)noteUseOfObject:(XDTObject *)object;
+
+- (XDTMemoryUsage)totalUsage;
+- (NSArray<NSDictionary<XDTMemoryUsageKey, id> *> *)usageReport;     /* The most recently used object first */
+
+/* Returns the number of detached object codes, the spared object is never detached, e.g. the one just assembled */
+- (NSUInteger)enforceLimitSparingObject:(nullable XDTObject *)sparedObject;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,439 @@
+//
+//  XDTMemoryBudget.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTMemoryBudget.h"
+
+#import <Python/Python.h>
+
+#import "XDTAs99Objcode.h"
+#import "XDTAssembler.h"
+#import "XDTGa99Objcode.h"
+#import "XDTPythonGIL.h"
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+XDTMemoryUsageKey const XDTMemoryUsageClassName = @"XDTMemoryUsageClassName";
+XDTMemoryUsageKey const XDTMemoryUsagePythonObjects = @"XDTMemoryUsagePythonObjects";
+XDTMemoryUsageKey const XDTMemoryUsagePythonBytes = @"XDTMemoryUsagePythonBytes";
+XDTMemoryUsageKey const XDTMemoryUsageNativeBytes = @"XDTMemoryUsageNativeBytes";
+XDTMemoryUsageKey const XDTMemoryUsageLastUse = @"XDTMemoryUsageLastUse";
+XDTMemoryUsageKey const XDTMemoryUsageDetachable = @"XDTMemoryUsageDetachable";
+
+
+@interface XDTObject ()
+
+- (XDTMemoryUsage)memoryUsageCollectingPythonObjects:(NSHashTable *)pythonObjects excludingPythonObjects:(NSArray<NSHashTable *> *)excludedObjects
+                                        sharesPythonObjects:(nullable BOOL *)sharesPythonObjects;
+
+@end
+
+
+/* The usage of a wrapper object when it was measured, and the Python objects which were counted for it */
+@interface XDTMeasuredUsage : NSObject
+
+@property XDTMemoryUsage usage;
+@property (readonly) NSHashTable *pythonObjects;   /* Opaque pointers, valid as long as the object is not used again */
+@property BOOL sharesPythonObjects;     /* Skipped Python objects which were counted for another object */
+
+@end
+
+
+@interface XDTMemoryBudget () {
+    NSMapTable<XDTObject *, NSDate *> *_lastUses;     /* Weak keys, so the budget keeps no object alive */
+    NSMapTable<XDTObject *, XDTMeasuredUsage *> *_measuredUsages;   /* Weak keys, removed when the object is used */
+    NSUInteger _measuredObjectCount;    /* Measured usages added and not removed, more than the living ones after a release */
+}
+
+@property (readwrite) NSUInteger detachCount;
+@property (readwrite) NSUInteger evictionCount;
+
+/* Pairs of each living object and the date of its last use, the least recently used first */
+- (NSArray<NSArray *> *)objectsByLastUse;
+
++ (BOOL)isDetachableObject:(XDTObject *)object;
+
+/* The usage of each entry, with the GIL held */
+- (NSData *)usagesOfEntries:(NSArray<NSArray *> *)entries;
+- (XDTMemoryUsage)measureObject:(XDTObject *)object;
+- (void)forgetUsageOfObject:(XDTObject *)object;
+- (void)forgetSharingUsages;
+- (void)removeNativeBytes:(NSUInteger)byteCount fromUsageOfObject:(XDTObject *)object;
+
+/* Returns the freed bytes of the captured outputs of object code or the source cache of an assembler */
++ (NSUInteger)removeRegenerableBytesOfObject:(XDTObject *)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+@implementation XDTMeasuredUsage
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _pythonObjects = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality capacity:1024];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_pythonObjects release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+@implementation XDTMemoryBudget
+
++ (instancetype)sharedBudget
+{
+    static XDTMemoryBudget *sharedBudget = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedBudget = [[XDTMemoryBudget alloc] init];
+    });
+    return sharedBudget;
+}
+
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _byteLimit = 0;
+    _detachCount = 0;
+    _evictionCount = 0;
+    _lastUses = [NSMapTable weakToStrongObjectsMapTable];
+    _measuredUsages = [NSMapTable weakToStrongObjectsMapTable];
+    _measuredObjectCount = 0;
+#if !__has_feature(objc_arc)
+    [_lastUses retain];
+    [_measuredUsages retain];
+#endif
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_lastUses release];
+    [_measuredUsages release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Accounting
+
+
+- (void)noteUseOfObject:(XDTObject *)object
+{
+    @synchronized (self) {
+        [_lastUses setObject:[NSDate date] forKey:object];
+        [self forgetUsageOfObject:object];
+    }
+}
+
+
+- (NSArray<NSArray *> *)objectsByLastUse
+{
+    NSMutableArray<NSArray *> *retVal = [NSMutableArray array];
+    @synchronized (self) {
+        for (XDTObject *object in _lastUses) {
+            NSDate *lastUse = [_lastUses objectForKey:object];
+            if (nil != lastUse) {
+                [retVal addObject:@[object, lastUse]];
+            }
+        }
+    }
+    [retVal sortUsingComparator:^NSComparisonResult(NSArray *entry1, NSArray *entry2) {
+        return [(NSDate *)entry1[1] compare:(NSDate *)entry2[1]];
+    }];
+    return retVal;
+}
+
+
++ (BOOL)isDetachableObject:(XDTObject *)object
+{
+    if ([object isKindOfClass:[XDTAs99Objcode class]]) {
+        return ![(XDTAs99Objcode *)object isDetached];
+    }
+    if ([object isKindOfClass:[XDTGa99Objcode class]]) {
+        return ![(XDTGa99Objcode *)object isDetached];
+    }
+    return NO;
+}
+
+
++ (NSUInteger)removeRegenerableBytesOfObject:(XDTObject *)object
+{
+    if ([object isKindOfClass:[XDTAs99Objcode class]]) {
+        return [(XDTAs99Objcode *)object removeRegenerableOutputs];
+    }
+    if ([object isKindOfClass:[XDTGa99Objcode class]]) {
+        return [(XDTGa99Objcode *)object removeRegenerableOutputs];
+    }
+    if ([object isKindOfClass:[XDTAssembler class]]) {
+        return [(XDTAssembler *)object removeCachedSources];
+    }
+    return 0;
+}
+
+
+/*
+ The objects which skipped Python objects may have skipped some of the forgotten object, so they are forgotten, too.
+ Has to be called within @synchronized (self), like forgetSharingUsages.
+ */
+- (void)forgetUsageOfObject:(XDTObject *)object
+{
+    if (nil != [_measuredUsages objectForKey:object]) {
+        [_measuredUsages removeObjectForKey:object];
+        _measuredObjectCount--;
+        [self forgetSharingUsages];
+    }
+}
+
+
+- (void)forgetSharingUsages
+{
+    for (XDTObject *measuredObject in [[_measuredUsages keyEnumerator] allObjects]) {
+        if ([_measuredUsages objectForKey:measuredObject].sharesPythonObjects) {
+            [_measuredUsages removeObjectForKey:measuredObject];
+            _measuredObjectCount--;
+        }
+    }
+}
+
+
+/* Removing regenerable outputs and cached sources frees only native bytes, the Python objects are unchanged */
+- (void)removeNativeBytes:(NSUInteger)byteCount fromUsageOfObject:(XDTObject *)object
+{
+    @synchronized (self) {
+        XDTMeasuredUsage *measuredUsage = [_measuredUsages objectForKey:object];
+        XDTMemoryUsage usage = measuredUsage.usage;
+        usage.nativeByteCount -= MIN(byteCount, usage.nativeByteCount);
+        measuredUsage.usage = usage;
+    }
+}
+
+
+/*
+ Walks the Python objects of the object without those which are counted for any other measured object, so a Python
+ object which is reachable from several wrapper objects is only counted for the one which was measured first.
+ */
+- (XDTMemoryUsage)measureObject:(XDTObject *)object
+{
+    NSMutableArray<NSHashTable *> *excludedObjects = [NSMutableArray array];
+    @synchronized (self) {
+        [self forgetUsageOfObject:object];
+        for (XDTObject *measuredObject in _measuredUsages) {
+            XDTMeasuredUsage *measuredUsage = [_measuredUsages objectForKey:measuredObject];
+            if (nil != measuredUsage) {
+                [excludedObjects addObject:measuredUsage.pythonObjects];
+            }
+        }
+    }
+
+    XDTMeasuredUsage *measuredUsage = [[XDTMeasuredUsage alloc] init];
+    BOOL sharesPythonObjects = NO;
+    measuredUsage.usage = [object memoryUsageCollectingPythonObjects:measuredUsage.pythonObjects excludingPythonObjects:excludedObjects
+                                                  sharesPythonObjects:&sharesPythonObjects];
+    measuredUsage.sharesPythonObjects = sharesPythonObjects;
+    @synchronized (self) {
+        [_measuredUsages setObject:measuredUsage forKey:object];
+        _measuredObjectCount++;
+    }
+#if !__has_feature(objc_arc)
+    [measuredUsage autorelease];
+#endif
+    return measuredUsage.usage;
+}
+
+
+/*
+ Only the objects which have been used since they were measured are walked again, the others keep their measured
+ usage. When a measured object has been released, the Python objects counted for it may still be reachable from
+ the objects which skipped them, so these are measured again.
+ */
+- (NSData *)usagesOfEntries:(NSArray<NSArray *> *)entries
+{
+    @synchronized (self) {
+        NSUInteger livingCount = 0;
+        for (NSArray *entry in entries) {
+            if (nil != [_measuredUsages objectForKey:entry[0]]) {
+                livingCount++;
+            }
+        }
+        if (livingCount < _measuredObjectCount) {
+            _measuredObjectCount = livingCount;
+            [self forgetSharingUsages];
+        }
+    }
+
+    NSMutableData *retVal = [NSMutableData dataWithLength:[entries count] * sizeof(XDTMemoryUsage)];
+    XDTMemoryUsage *usages = [retVal mutableBytes];
+    for (NSUInteger i = 0; i < [entries count]; i++) {
+        XDTObject *object = entries[i][0];
+        XDTMeasuredUsage *measuredUsage = nil;
+        @synchronized (self) {
+            measuredUsage = [_measuredUsages objectForKey:object];
+        }
+        usages[i] = (nil != measuredUsage)? measuredUsage.usage : [self measureObject:object];
+    }
+    return retVal;
+}
+
+
+- (XDTMemoryUsage)totalUsage
+{
+    XDTMemoryUsage retVal = {0, 0, 0};
+
+    XDTAcquireGIL();
+    NSArray<NSArray *> *entries = [self objectsByLastUse];
+    const XDTMemoryUsage *usages = [[self usagesOfEntries:entries] bytes];
+    for (NSUInteger i = 0; i < [entries count]; i++) {
+        retVal.pythonObjectCount += usages[i].pythonObjectCount;
+        retVal.pythonByteCount += usages[i].pythonByteCount;
+        retVal.nativeByteCount += usages[i].nativeByteCount;
+    }
+    return retVal;
+}
+
+
+- (NSArray<NSDictionary<XDTMemoryUsageKey, id> *> *)usageReport
+{
+    NSMutableArray<NSDictionary<XDTMemoryUsageKey, id> *> *retVal = [NSMutableArray array];
+
+    XDTAcquireGIL();
+    NSArray<NSArray *> *entries = [self objectsByLastUse];
+    const XDTMemoryUsage *usages = [[self usagesOfEntries:entries] bytes];
+    for (NSUInteger i = [entries count]; 0 < i--;) {
+        NSArray *entry = entries[i];
+        XDTObject *object = entry[0];
+        XDTMemoryUsage usage = usages[i];
+        [retVal addObject:@{
+                            XDTMemoryUsageClassName: NSStringFromClass([object class]),
+                            XDTMemoryUsagePythonObjects: [NSNumber numberWithUnsignedInteger:usage.pythonObjectCount],
+                            XDTMemoryUsagePythonBytes: [NSNumber numberWithUnsignedInteger:usage.pythonByteCount],
+                            XDTMemoryUsageNativeBytes: [NSNumber numberWithUnsignedInteger:usage.nativeByteCount],
+                            XDTMemoryUsageLastUse: entry[1],
+                            XDTMemoryUsageDetachable: [NSNumber numberWithBool:[XDTMemoryBudget isDetachableObject:object]]
+                            }];
+    }
+    return retVal;
+}
+
+
+#pragma mark - Limiting
+
+
+/*
+ The GIL is held for the whole time, so no other thread changes the Python objects between measuring and detaching.
+ Only the objects used since the last call are measured again, usually the assembler and its new object code. Only
+ the bytes which are actually freed are taken off the measured usage, so objects which cannot shrink any further
+ never count as freed. Detaching generates the listings, which notes a use of the object code, so the date of its
+ last use is restored and the detached object code is measured again.
+ */
+- (NSUInteger)enforceLimitSparingObject:(XDTObject *)sparedObject
+{
+    NSUInteger byteLimit = self.byteLimit;
+    if (0 == byteLimit) {
+        return 0;
+    }
+
+    XDTAcquireGIL();
+    NSArray<NSArray *> *entries = [self objectsByLastUse];
+    const XDTMemoryUsage *usages = [[self usagesOfEntries:entries] bytes];
+    NSMutableData *byteCounts = [NSMutableData dataWithLength:[entries count] * sizeof(NSUInteger)];
+    NSUInteger *entryByteCounts = [byteCounts mutableBytes];
+    NSUInteger totalByteCount = 0;
+    for (NSUInteger i = 0; i < [entries count]; i++) {
+        entryByteCounts[i] = usages[i].pythonByteCount + usages[i].nativeByteCount;
+        totalByteCount += entryByteCounts[i];
+    }
+
+    /* removing what is generated or read again loses nothing, so that is tried first for all objects */
+    NSUInteger evictionCount = 0;
+    for (NSUInteger i = 0; i < [entries count] && byteLimit < totalByteCount; i++) {
+        XDTObject *object = entries[i][0];
+        if (sparedObject == object) {
+            continue;
+        }
+        NSUInteger freedByteCount = MIN([XDTMemoryBudget removeRegenerableBytesOfObject:object], entryByteCounts[i]);
+        if (0 < freedByteCount) {
+            [self removeNativeBytes:freedByteCount fromUsageOfObject:object];
+            entryByteCounts[i] -= freedByteCount;
+            totalByteCount -= freedByteCount;
+            evictionCount++;
+        }
+    }
+
+    NSUInteger retVal = 0;
+    for (NSUInteger i = 0; i < [entries count] && byteLimit < totalByteCount; i++) {
+        XDTObject *object = entries[i][0];
+        if (sparedObject == object || ![XDTMemoryBudget isDetachableObject:object]) {
+            continue;
+        }
+        BOOL isDetached = [object isKindOfClass:[XDTAs99Objcode class]]? [(XDTAs99Objcode *)object materializeAndDetach:nil] :
+                                                                         [(XDTGa99Objcode *)object materializeAndDetach:nil];
+        @synchronized (self) {
+            [_lastUses setObject:entries[i][1] forKey:object];
+        }
+        if (!isDetached) {
+            continue;
+        }
+        XDTMemoryUsage usage = [self measureObject:object];
+        totalByteCount = totalByteCount - entryByteCounts[i] + usage.pythonByteCount + usage.nativeByteCount;
+        retVal++;
+    }
+
+    if (0 < retVal || 0 < evictionCount) {
+        @synchronized (self) {
+            self.detachCount += retVal;
+            self.evictionCount += evictionCount;
+        }
+    }
+    return retVal;
+}
+
+@end
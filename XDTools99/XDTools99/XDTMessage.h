@@ -47,23 +47,61 @@ FOUNDATION_EXPORT XDTMessageTypeKey const XDTMessageLineNumber; /* The line numb
 FOUNDATION_EXPORT XDTMessageTypeKey const XDTMessageCodeLine;   /* The text of the line of code pointed by the line number as NSString */
 FOUNDATION_EXPORT XDTMessageTypeKey const XDTMessageText;       /* Text of the message, any error or warning messages as NSString */
 FOUNDATION_EXPORT XDTMessageTypeKey const XDTMessageType;       /* Kind of message: XDTMessageTypeValue NSNumber */
+FOUNDATION_EXPORT XDTMessageTypeKey const XDTMessageCount;      /* Only in aggregated messages: Number of messages of the group as NSNumber */
+FOUNDATION_EXPORT XDTMessageTypeKey const XDTMessageLocations;  /* Only in aggregated messages: NSArray of the first locations of the group, dictionaries with file URL, pass number, line number and code line */
+
+typedef NSString * XDTMessageAggregationKey NS_EXTENSIBLE_STRING_ENUM; /* Keys for use in the NSDictionry of the aggregation options */
+
+FOUNDATION_EXPORT XDTMessageAggregationKey const XDTMessageAggregationLocationLimit; /* (NSNumber) Number of locations kept for each group, default is 8 */
+FOUNDATION_EXPORT XDTMessageAggregationKey const XDTMessageAggregationMemoryLimit;   /* (NSNumber) Estimated bytes of all groups and locations, messages beyond are only counted, default is 1 MiB */
 
 typedef void (^XDTMessageEnumBlock)(NSDictionary<XDTMessageTypeKey, id> *obj, BOOL *stop);
 
+@class XDTMessage;
+
+/* A tool which still holds the list of its aggregated messages and converts it again for their full detail */
+@protocol XDTMessageSource <NSObject>
+
+/* The messages of the list one by one, or nil when the tool has run again since it collected them */
+- (nullable XDTMessage *)expandedMessagesOfMessages:(XDTMessage *)messages;
+
+@end
+
 
 @interface XDTMessage : NSObject
 
 + (instancetype)messageWithPythonList:(PyObject *)messageList;
 + (instancetype)messageWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)type;
++ (instancetype)messageWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)type aggregation:(nullable NSDictionary<XDTMessageAggregationKey, id> *)aggregation;
 + (instancetype)messageWithMessages:(XDTMessage *)messages;
 
 - (XDTMessage *)messagesOfType:(XDTMessageTypeValue)type;
 - (XDTMessage *)sortedByPriorityAscendingType;
 - (XDTMessage *)sortedByPriorityDecendingType;
 
+/*
+ Aggregated messages keep one dictionary for each group of messages with the same type and the same text, where
+ numbers are ignored. Such a dictionary is the first message of its group, extended by the number of messages and
+ their first locations. Counting always counts the single messages, also those not kept beyond the memory limit.
+ */
+@property (readonly, getter=isAggregated) BOOL aggregated;
+@property (readonly) NSUInteger droppedCount;   /* Messages which are only counted because the memory limit was reached */
+
 @property (readonly) NSUInteger count;
 - (NSUInteger)countOfType:(XDTMessageTypeValue)type;
 
+/*
+ The tool which has collected aggregated messages, if it can convert them again. Filtered and sorted copies of the
+ messages refer to the same source, unless other messages were added to them.
+ */
+@property (nullable, weak) id<XDTMessageSource> messageSource;
+
+/*
+ All messages one by one. Aggregated messages are converted again by their source, with the same filter and order,
+ otherwise, or when the source has run again, there is one message for each kept location.
+ */
+- (XDTMessage *)expandedMessages;
+
 - (void)enumerateMessagesUsingBlock:(NS_NOESCAPE XDTMessageEnumBlock)block;
 - (void)enumerateMessagesOfType:(XDTMessageTypeValue)type usingBlock:(NS_NOESCAPE XDTMessageEnumBlock)block;
 
@@ -25,6 +25,13 @@
 #import "XDTMessage.h"
 
 #import "NSSetPythonAdditions.h"
+#import "NSArrayPythonAdditions.h"
+#import "NSStringPythonAdditions.h"
+#import "XDTPythonGIL.h"
+
+
+#define XDTMessageDefaultLocationLimit 8
+#define XDTMessageDefaultMemoryLimit (1024 * 1024)
 
 
 NS_ASSUME_NONNULL_BEGIN
@@ -35,11 +42,18 @@ XDTMessageTypeKey const XDTMessageLineNumber = @"XDTMessageLineNumber";
 XDTMessageTypeKey const XDTMessageCodeLine = @"XDTMessageCodeLine";
 XDTMessageTypeKey const XDTMessageText = @"XDTMessageText";
 XDTMessageTypeKey const XDTMessageType = @"XDTMessageType";
+XDTMessageTypeKey const XDTMessageCount = @"XDTMessageCount";
+XDTMessageTypeKey const XDTMessageLocations = @"XDTMessageLocations";
+
+XDTMessageAggregationKey const XDTMessageAggregationLocationLimit = @"XDTMessageAggregationLocationLimit";
+XDTMessageAggregationKey const XDTMessageAggregationMemoryLimit = @"XDTMessageAggregationMemoryLimit";
 
 
 static NSRegularExpression *warningRegex;
 static NSRegularExpression *errorRegex;
 static NSRegularExpression *basicRegex;
+static NSRegularExpression *numberRegex;
+static NSRegularExpression *spaceRegex;
 
 static NSArray<NSSortDescriptor *> *sortDescriptorsAscendingType;
 static NSArray<NSSortDescriptor *> *sortDescriptorsDecendingType;
@@ -49,16 +63,46 @@ static NSArray<NSSortDescriptor *> *sortDescriptorsDecendingType;
     @protected
     NSMutableOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *_messages;
     NSArray<NSSortDescriptor *> *_usedSortDescriptors;
+
+    BOOL _aggregated;
+    __weak XDTMessage *_origin;         /* The messages of the source which these are copied from, nil if these are */
+    XDTMessageTypeValue _expandedType;  /* Filter of the expanded messages, when the groups are filtered by type */
+    NSUInteger _droppedCounts[XDTMessageTypeDebug + 1];
 }
 
 - (instancetype)initWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)type;
+- (instancetype)initWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)type aggregation:(nullable NSDictionary<XDTMessageAggregationKey, id> *)aggregation;
 - (instancetype)initWithSet:(NSOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *)messageArray;
 
+- (nullable NSDictionary<XDTMessageTypeKey, id> *)messageOfString:(NSString *)messageString treatingAs:(XDTMessageTypeValue)treatingType;
+- (nullable NSDictionary<XDTMessageTypeKey, id> *)messageOfTuple:(NSArray *)messageItem treatingAs:(XDTMessageTypeValue)treatingType;
+- (NSString *)groupKeyOfMessage:(NSDictionary<XDTMessageTypeKey, id> *)message;
+- (void)adoptAggregationOfMessages:(XDTMessage *)messages filteringType:(XDTMessageTypeValue)type;
+- (void)giveUpMessageSource;
+
 @end
 
 NS_ASSUME_NONNULL_END
 
 
+/* A rough estimate of the memory of a message dictionary: the dictionary, its boxed values and the UTF-16 characters of its strings */
+static NSUInteger XDTMessageEstimatedSize(NSDictionary<XDTMessageTypeKey, id> *message)
+{
+    NSUInteger retVal = 64 + 16 * [message count];
+    for (XDTMessageTypeKey key in @[XDTMessageText, XDTMessageCodeLine]) {
+        NSString *text = [message objectForKey:key];
+        if ([text isKindOfClass:[NSString class]]) {
+            retVal += 2 * [text length];
+        }
+    }
+    NSURL *fileURL = [message objectForKey:XDTMessageFileURL];
+    if ([fileURL isKindOfClass:[NSURL class]]) {
+        retVal += 32 + [[fileURL relativeString] length];
+    }
+    return retVal;
+}
+
+
 @implementation XDTMessage
 
 + (void)initialize
@@ -77,6 +121,11 @@ NS_ASSUME_NONNULL_END
          Missing line number: [15] GOTO 500
          */
         basicRegex = [NSRegularExpression regularExpressionWithPattern:@"(.+):\\s\\[(\\d+)\\]\\s(.*)" options:0 error:nil];
+        /*
+         Value out of range: >1A0, Unknown symbol: LOOP2 -> Value out of range: #, Unknown symbol: LOOP#
+         */
+        numberRegex = [NSRegularExpression regularExpressionWithPattern:@">[0-9A-Fa-f]+|[0-9]+" options:0 error:nil];
+        spaceRegex = [NSRegularExpression regularExpressionWithPattern:@"\\s+" options:0 error:nil];
         sortDescriptorsAscendingType = @[
                                          [NSSortDescriptor sortDescriptorWithKey:[NSString stringWithFormat:@"self.%@.path", XDTMessageFileURL] ascending:YES],
                                          [NSSortDescriptor sortDescriptorWithKey:XDTMessageLineNumber ascending:YES],
@@ -101,7 +150,14 @@ NS_ASSUME_NONNULL_END
 
 + (instancetype)messageWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)type
 {
-    id retVal = [[[self class] alloc] initWithPythonList:messageList treatingAs:type];
+    return [self messageWithPythonList:messageList treatingAs:type aggregation:nil];
+}
+
+
++ (instancetype)messageWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)type aggregation:(NSDictionary<XDTMessageAggregationKey, id> *)aggregation
+{
+    XDTAcquireGIL();
+    id retVal = [[[self class] alloc] initWithPythonList:messageList treatingAs:type aggregation:aggregation];
 #if !__has_feature(objc_arc)
     [retVal autorelease];
 #endif
@@ -111,6 +167,13 @@ NS_ASSUME_NONNULL_END
 
 - (instancetype)initWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)treatingType
 {
+    return [self initWithPythonList:messageList treatingAs:treatingType aggregation:nil];
+}
+
+
+- (instancetype)initWithPythonList:(PyObject *)messageList treatingAs:(XDTMessageTypeValue)treatingType aggregation:(NSDictionary<XDTMessageAggregationKey, id> *)aggregation
+{
+    XDTAcquireGIL();
     assert(NULL != messageList);
 
     self = [super init];
@@ -119,109 +182,109 @@ NS_ASSUME_NONNULL_END
     }
 
     _messages = nil;
+    _expandedType = XDTMessageTypeAll;
     const Py_ssize_t messageCount = PyList_Size(messageList);
     if (0 >= messageCount) {
         return self;
     }
 
-    /* Check if the messageList comes from xbas99, which delivers its messages in an array of strings, not an array of tuples like the other does. */
-    NSMutableOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *newMessages = [NSMutableOrderedSet orderedSetWithCapacity:messageCount];
-    NSSet<NSString *> *messageStrings = [NSSet setWithPyListOfString:messageList];
-    if (nil != messageStrings) {
-        // I'm still the old and ugly style of message exchange, that xbas99 still uses.
-        [messageStrings enumerateObjectsUsingBlock:^(NSString *obj, BOOL *stop) {
-            NSDictionary<XDTMessageTypeKey, id> *msg = nil;
-
-            NSRange range = NSMakeRange(0, [obj length]);
-            NSTextCheckingResult *match = [warningRegex firstMatchInString:obj options:0 range:range];
-            if (nil != match) {
-                /* Assembler warnings */
-                msg = @{
-                        XDTMessageFileURL: [NSURL fileURLWithPath:[obj substringWithRange:[match rangeAtIndex:1]]],
-                        XDTMessagePassNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:2]] integerValue]],
-                        XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:3]] integerValue]],
-                        //XDTMessageCodeLine:nil;
-                        XDTMessageText: [obj substringWithRange:[match rangeAtIndex:4]],
-                        XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeWarning]
-                        };
-            } else {
-                match = [errorRegex firstMatchInString:obj options:0 range:range];
-                if (nil != match) {
-                    /* Assembler errors */
-                    msg = @{
-                            XDTMessageFileURL: [NSURL fileURLWithPath:[obj substringWithRange:[match rangeAtIndex:1]]],
-                            XDTMessagePassNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:2]] integerValue]],
-                            XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:3]] integerValue]],
-                            XDTMessageCodeLine: [obj substringWithRange:[match rangeAtIndex:4]],
-                            XDTMessageText: [obj substringWithRange:[match rangeAtIndex:5]],
-                            XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeError]
-                            };
-                } else {
-                    /* Basic warnings */
-                    match = [basicRegex firstMatchInString:obj options:0 range:range];
-                    if (nil != match) {
-                        msg = @{
-                                //XDTMessageFileURL: nil,
-                                //XDTMessagePassNumber: nil,
-                                XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:2]] integerValue] + 1],
-                                XDTMessageCodeLine: [obj substringWithRange:[match rangeAtIndex:3]],
-                                XDTMessageText: [obj substringWithRange:[match rangeAtIndex:1]],
-                                XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeWarning]
-                                };
-                    } else {
-                        /* old school style of Assembler warnings */
-                        msg = @{
-                                //XDTMessageFileURL: nil,
-                                XDTMessagePassNumber: @2,
-                                //XDTMessageLineNumber: nil,
-                                //XDTMessageCodeLine: @"",
-                                XDTMessageText: obj,
-                                XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeError]
-                                };
-                    }
+    NSMutableOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *newMessages = nil;
+    if (nil == aggregation) {
+        /* Check if the messageList comes from xbas99, which delivers its messages in an array of strings, not an array of tuples like the other does. */
+        newMessages = [NSMutableOrderedSet orderedSetWithCapacity:messageCount];
+        NSSet<NSString *> *messageStrings = [NSSet setWithPyListOfString:messageList];
+        if (nil != messageStrings) {
+            // I'm still the old and ugly style of message exchange, that xbas99 still uses.
+            [messageStrings enumerateObjectsUsingBlock:^(NSString *obj, BOOL *stop) {
+                NSDictionary<XDTMessageTypeKey, id> *msg = [self messageOfString:obj treatingAs:treatingType];
+                [newMessages addObject:msg];
+            }];
+        } else {
+            NSSet<NSArray *> *messageTupel = [NSSet setWithPyListOfTuple:messageList];
+            [messageTupel enumerateObjectsUsingBlock:^(NSArray *messageItem, BOOL *stop) {
+                NSDictionary<XDTMessageTypeKey, id> *msg = [self messageOfTuple:messageItem treatingAs:treatingType];
+                if (nil != msg) {
+                    [newMessages addObject:msg];
                 }
-            }
-            [newMessages addObject:msg];
-        }];
+            }];
+        }
     } else {
-        NSSet<NSArray *> *messageTupel = [NSSet setWithPyListOfTuple:messageList];
-        [messageTupel enumerateObjectsUsingBlock:^(NSArray *messageItem, BOOL *stop) {
-            NSDictionary<XDTMessageTypeKey, id> *msg = nil;
-
-            NSString *typeString = [[NSString alloc] initWithData:[messageItem objectAtIndex:0] encoding:NSUTF8StringEncoding].uppercaseString;  /* Message type: E=Error; W=Warning */
-            XDTMessageTypeValue typeValue = treatingType;
-            if (XDTMessageTypeAll == treatingType) {
-                if ([@"E" isEqualToString:typeString]) {
-                    typeValue = XDTMessageTypeError;
-                } else if ([@"W" isEqualToString:typeString]) {
-                    typeValue = XDTMessageTypeWarning;
+        /*
+         Every message is converted on its own and merged into the group of its type and normalized text right away,
+         so the memory grows with the number of distinct messages and not with the number of all messages. Nothing of
+         the list of the tool is kept, only the groups and their first locations within the memory limit. The full
+         detail is converted again by the message source, as long as the tool still holds its list.
+         */
+        NSNumber *limit = [aggregation objectForKey:XDTMessageAggregationLocationLimit];
+        const NSUInteger locationLimit = (nil == limit)? XDTMessageDefaultLocationLimit : [limit unsignedIntegerValue];
+        limit = [aggregation objectForKey:XDTMessageAggregationMemoryLimit];
+        const NSUInteger memoryLimit = (nil == limit)? XDTMessageDefaultMemoryLimit : [limit unsignedIntegerValue];
+        NSUInteger memoryUsed = 0;
+
+        NSMutableDictionary<NSString *, NSMutableDictionary<XDTMessageTypeKey, id> *> *groups = [NSMutableDictionary dictionary];
+        NSMutableArray<NSMutableDictionary<XDTMessageTypeKey, id> *> *orderedGroups = [NSMutableArray array];
+        for (Py_ssize_t i = 0; i < messageCount; i++) {
+            @autoreleasepool {
+                PyObject *messageItem = PyList_GetItem(messageList, i);  /* borrowed reference */
+                NSDictionary<XDTMessageTypeKey, id> *msg = nil;
+                if (PyString_Check(messageItem)) {
+                    NSString *messageString = [NSString stringWithPythonString:messageItem encoding:NSUTF8StringEncoding];
+                    if (nil != messageString) {
+                        msg = [self messageOfString:messageString treatingAs:treatingType];
+                    }
+                } else if (PyTuple_Check(messageItem)) {
+                    NSArray *messageTuple = [NSArray arrayWithPyTuple:messageItem];
+                    if (nil != messageTuple) {
+                        msg = [self messageOfTuple:messageTuple treatingAs:treatingType];
+                    }
+                }
+                if (nil == msg) {
+                    continue;
+                }
+
+                const NSUInteger messageSize = XDTMessageEstimatedSize(msg);
+                NSString *groupKey = [self groupKeyOfMessage:msg];
+                NSMutableDictionary<XDTMessageTypeKey, id> *group = [groups objectForKey:groupKey];
+                if (nil == group) {
+                    if (memoryLimit < memoryUsed + messageSize) {
+                        const NSUInteger typeValue = [[msg objectForKey:XDTMessageType] unsignedIntegerValue];
+                        if (XDTMessageTypeDebug >= typeValue) {
+                            _droppedCounts[typeValue]++;
+                        }
+                        continue;
+                    }
+                    memoryUsed += messageSize;
+                    group = [NSMutableDictionary dictionaryWithDictionary:msg];
+                    [group setObject:[NSMutableArray arrayWithObject:msg] forKey:XDTMessageLocations];
+                    [group setObject:@1 forKey:XDTMessageCount];
+                    [groups setObject:group forKey:groupKey];
+                    [orderedGroups addObject:group];
                 } else {
-                    NSLog(@"Warning: unknown message type: %@", typeString);
+                    NSNumber *count = [group objectForKey:XDTMessageCount];
+                    [group setObject:[NSNumber numberWithUnsignedInteger:[count unsignedIntegerValue] + 1] forKey:XDTMessageCount];
+                    NSMutableArray<NSDictionary<XDTMessageTypeKey, id> *> *locations = [group objectForKey:XDTMessageLocations];
+                    if (locationLimit > [locations count] && memoryLimit >= memoryUsed + messageSize) {
+                        memoryUsed += messageSize;
+                        [locations addObject:msg];
+                    }
                 }
             }
-
-            NSData *stringData = [messageItem objectAtIndex:1];
-            NSString *fileName = [[NSNull null] isEqual:stringData]? @"" : [[NSString alloc] initWithData:stringData encoding:NSUTF8StringEncoding];  /* Name of te Source file. */
-            NSNumber *passNum = [messageItem objectAtIndex:2];  /* Number of the Assembler pass. */
-            NSNumber *lineNum = [messageItem objectAtIndex:3];  /* Number of the line in source code. */
-            stringData = [messageItem objectAtIndex:4];
-            NSString *sourceLine = [[NSNull null] isEqualTo:stringData]? @"" : [[NSString alloc] initWithData:stringData encoding:NSUTF8StringEncoding];  /* Line of source code where the line number points to. */
-            NSString *message = [[NSString alloc] initWithData:[messageItem objectAtIndex:5] encoding:NSUTF8StringEncoding];  /* Text of the generated message. */
-
-            if (nil == message || 0 >= message.length) {
-                NSLog(@"Warning: XDT Message without text!");
-                return;
+        }
+
+        newMessages = [NSMutableOrderedSet orderedSetWithCapacity:[orderedGroups count]];
+        for (NSMutableDictionary<XDTMessageTypeKey, id> *group in orderedGroups) {
+            /* The locations only need file, pass, line and code line, the text and type are those of the group */
+            NSArray<NSDictionary<XDTMessageTypeKey, id> *> *locations = [group objectForKey:XDTMessageLocations];
+            NSMutableArray<NSDictionary<XDTMessageTypeKey, id> *> *strippedLocations = [NSMutableArray arrayWithCapacity:[locations count]];
+            for (NSDictionary<XDTMessageTypeKey, id> *location in locations) {
+                NSMutableDictionary<XDTMessageTypeKey, id> *strippedLocation = [NSMutableDictionary dictionaryWithDictionary:location];
+                [strippedLocation removeObjectsForKeys:@[XDTMessageText, XDTMessageType]];
+                [strippedLocations addObject:strippedLocation];
             }
-            msg = @{
-                    XDTMessageFileURL: [NSURL fileURLWithPath:fileName],
-                    XDTMessagePassNumber: passNum,
-                    XDTMessageLineNumber: (nil == lineNum)? [NSNull null] : lineNum,
-                    XDTMessageCodeLine: (nil == sourceLine)? @"" : sourceLine,
-                    XDTMessageText: message,
-                    XDTMessageType: [NSNumber numberWithUnsignedInteger:typeValue]
-                    };
-            [newMessages addObject:msg];
-        }];
+            [group setObject:strippedLocations forKey:XDTMessageLocations];
+            [newMessages addObject:[NSDictionary dictionaryWithDictionary:group]];
+        }
+        _aggregated = YES;
     }
     _messages = newMessages;
     _usedSortDescriptors = nil;
@@ -235,6 +298,7 @@ NS_ASSUME_NONNULL_END
     XDTMessage *retVal = [[XDTMessage alloc] init];
     retVal->_messages = [NSMutableOrderedSet orderedSetWithOrderedSet:messages->_messages];
     retVal->_usedSortDescriptors = messages->_usedSortDescriptors;
+    [retVal adoptAggregationOfMessages:messages filteringType:XDTMessageTypeAll];
     return retVal;
 }
 
@@ -249,11 +313,18 @@ NS_ASSUME_NONNULL_END
     }
 
     _messages = nil;
+    _expandedType = XDTMessageTypeAll;
     if (0 >= [messageSet count]) {
         return self;
     }
     _messages = [NSMutableOrderedSet orderedSetWithOrderedSet:messageSet];
     _usedSortDescriptors = nil;
+    for (NSDictionary<XDTMessageTypeKey,id> *message in messageSet) {
+        if (nil != [message objectForKey:XDTMessageCount]) {
+            _aggregated = YES;
+            break;
+        }
+    }
 
     return self;
 }
@@ -261,7 +332,6 @@ NS_ASSUME_NONNULL_END
 
 - (void)dealloc
 {
-    //Py_CLEAR(objectcodePythonClass);
 #if !__has_feature(objc_arc)
     [_messages release];
     [super dealloc];
@@ -269,6 +339,134 @@ NS_ASSUME_NONNULL_END
 }
 
 
+#pragma mark - Conversion Methods
+
+
+- (NSDictionary<XDTMessageTypeKey, id> *)messageOfString:(NSString *)obj treatingAs:(XDTMessageTypeValue)treatingType
+{
+    NSDictionary<XDTMessageTypeKey, id> *msg = nil;
+
+    NSRange range = NSMakeRange(0, [obj length]);
+    NSTextCheckingResult *match = [warningRegex firstMatchInString:obj options:0 range:range];
+    if (nil != match) {
+        /* Assembler warnings */
+        msg = @{
+                XDTMessageFileURL: [NSURL fileURLWithPath:[obj substringWithRange:[match rangeAtIndex:1]]],
+                XDTMessagePassNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:2]] integerValue]],
+                XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:3]] integerValue]],
+                //XDTMessageCodeLine:nil;
+                XDTMessageText: [obj substringWithRange:[match rangeAtIndex:4]],
+                XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeWarning]
+                };
+    } else {
+        match = [errorRegex firstMatchInString:obj options:0 range:range];
+        if (nil != match) {
+            /* Assembler errors */
+            msg = @{
+                    XDTMessageFileURL: [NSURL fileURLWithPath:[obj substringWithRange:[match rangeAtIndex:1]]],
+                    XDTMessagePassNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:2]] integerValue]],
+                    XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:3]] integerValue]],
+                    XDTMessageCodeLine: [obj substringWithRange:[match rangeAtIndex:4]],
+                    XDTMessageText: [obj substringWithRange:[match rangeAtIndex:5]],
+                    XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeError]
+                    };
+        } else {
+            /* Basic warnings */
+            match = [basicRegex firstMatchInString:obj options:0 range:range];
+            if (nil != match) {
+                msg = @{
+                        //XDTMessageFileURL: nil,
+                        //XDTMessagePassNumber: nil,
+                        XDTMessageLineNumber: [NSNumber numberWithUnsignedInteger:[[obj substringWithRange:[match rangeAtIndex:2]] integerValue] + 1],
+                        XDTMessageCodeLine: [obj substringWithRange:[match rangeAtIndex:3]],
+                        XDTMessageText: [obj substringWithRange:[match rangeAtIndex:1]],
+                        XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeWarning]
+                        };
+            } else {
+                /* old school style of Assembler warnings */
+                msg = @{
+                        //XDTMessageFileURL: nil,
+                        XDTMessagePassNumber: @2,
+                        //XDTMessageLineNumber: nil,
+                        //XDTMessageCodeLine: @"",
+                        XDTMessageText: obj,
+                        XDTMessageType: [NSNumber numberWithUnsignedInteger:(XDTMessageTypeAll != treatingType)? treatingType : XDTMessageTypeError]
+                        };
+            }
+        }
+    }
+    return msg;
+}
+
+
+- (NSDictionary<XDTMessageTypeKey, id> *)messageOfTuple:(NSArray *)messageItem treatingAs:(XDTMessageTypeValue)treatingType
+{
+    NSString *typeString = [[NSString alloc] initWithData:[messageItem objectAtIndex:0] encoding:NSUTF8StringEncoding].uppercaseString;  /* Message type: E=Error; W=Warning */
+    XDTMessageTypeValue typeValue = treatingType;
+    if (XDTMessageTypeAll == treatingType) {
+        if ([@"E" isEqualToString:typeString]) {
+            typeValue = XDTMessageTypeError;
+        } else if ([@"W" isEqualToString:typeString]) {
+            typeValue = XDTMessageTypeWarning;
+        } else {
+            NSLog(@"Warning: unknown message type: %@", typeString);
+        }
+    }
+
+    NSData *stringData = [messageItem objectAtIndex:1];
+    NSString *fileName = [[NSNull null] isEqual:stringData]? @"" : [[NSString alloc] initWithData:stringData encoding:NSUTF8StringEncoding];  /* Name of te Source file. */
+    NSNumber *passNum = [messageItem objectAtIndex:2];  /* Number of the Assembler pass. */
+    NSNumber *lineNum = [messageItem objectAtIndex:3];  /* Number of the line in source code. */
+    stringData = [messageItem objectAtIndex:4];
+    NSString *sourceLine = [[NSNull null] isEqualTo:stringData]? @"" : [[NSString alloc] initWithData:stringData encoding:NSUTF8StringEncoding];  /* Line of source code where the line number points to. */
+    NSString *message = [[NSString alloc] initWithData:[messageItem objectAtIndex:5] encoding:NSUTF8StringEncoding];  /* Text of the generated message. */
+
+    if (nil == message || 0 >= message.length) {
+        NSLog(@"Warning: XDT Message without text!");
+        return nil;
+    }
+    return @{
+             XDTMessageFileURL: [NSURL fileURLWithPath:fileName],
+             XDTMessagePassNumber: passNum,
+             XDTMessageLineNumber: (nil == lineNum)? [NSNull null] : lineNum,
+             XDTMessageCodeLine: (nil == sourceLine)? @"" : sourceLine,
+             XDTMessageText: message,
+             XDTMessageType: [NSNumber numberWithUnsignedInteger:typeValue]
+             };
+}
+
+
+/* Messages of the same type belong to the same group, when their texts only differ in numbers and white space. */
+- (NSString *)groupKeyOfMessage:(NSDictionary<XDTMessageTypeKey, id> *)message
+{
+    NSMutableString *text = [NSMutableString stringWithString:[message objectForKey:XDTMessageText]];
+    [numberRegex replaceMatchesInString:text options:0 range:NSMakeRange(0, [text length]) withTemplate:@"#"];
+    [spaceRegex replaceMatchesInString:text options:0 range:NSMakeRange(0, [text length]) withTemplate:@" "];
+    return [NSString stringWithFormat:@"%@:%@", [message objectForKey:XDTMessageType], [text stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]];
+}
+
+
+- (void)adoptAggregationOfMessages:(XDTMessage *)messages filteringType:(XDTMessageTypeValue)type
+{
+    _aggregated = messages->_aggregated;
+    XDTMessage *origin = messages->_origin;
+    _origin = (nil != origin)? origin : messages;
+    _expandedType = (XDTMessageTypeAll == type)? messages->_expandedType : type;
+    for (NSUInteger typeValue = XDTMessageTypeAll; XDTMessageTypeDebug >= typeValue; typeValue++) {
+        _droppedCounts[typeValue] = (XDTMessageTypeAll == type || typeValue == type)? messages->_droppedCounts[typeValue] : 0;
+    }
+}
+
+
+/* The list of the source does not contain messages added from elsewhere, so the kept locations are the best detail */
+- (void)giveUpMessageSource
+{
+    _origin = nil;
+    _expandedType = XDTMessageTypeAll;
+    self.messageSource = nil;
+}
+
+
 #pragma mark - Accessor Methods
 
 
@@ -280,6 +478,7 @@ NS_ASSUME_NONNULL_END
 #if !__has_feature(objc_arc)
     [retVal autorelease];
 #endif
+    [retVal adoptAggregationOfMessages:self filteringType:type];
     return retVal;
 }
 
@@ -292,6 +491,7 @@ NS_ASSUME_NONNULL_END
         [retVal autorelease];
 #endif
         retVal->_usedSortDescriptors = _usedSortDescriptors;
+        [retVal adoptAggregationOfMessages:self filteringType:XDTMessageTypeAll];
         return retVal;
     }
 
@@ -301,6 +501,7 @@ NS_ASSUME_NONNULL_END
     [retVal autorelease];
 #endif
     retVal->_usedSortDescriptors = sortDescriptorsAscendingType;
+    [retVal adoptAggregationOfMessages:self filteringType:XDTMessageTypeAll];
     return retVal;
 }
 
@@ -313,6 +514,7 @@ NS_ASSUME_NONNULL_END
         [retVal autorelease];
 #endif
         retVal->_usedSortDescriptors = _usedSortDescriptors;
+        [retVal adoptAggregationOfMessages:self filteringType:XDTMessageTypeAll];
         return retVal;
     }
 
@@ -322,25 +524,102 @@ NS_ASSUME_NONNULL_END
     [retVal autorelease];
 #endif
     retVal->_usedSortDescriptors = sortDescriptorsDecendingType;
+    [retVal adoptAggregationOfMessages:self filteringType:XDTMessageTypeAll];
+    return retVal;
+}
+
+
+- (BOOL)isAggregated
+{
+    return _aggregated;
+}
+
+
+- (NSUInteger)droppedCount
+{
+    NSUInteger retVal = 0;
+    for (NSUInteger typeValue = XDTMessageTypeAll; XDTMessageTypeDebug >= typeValue; typeValue++) {
+        retVal += _droppedCounts[typeValue];
+    }
     return retVal;
 }
 
 
 - (NSUInteger)count
 {
-    return _messages.count;
+    return [self countOfType:XDTMessageTypeAll];
 }
 
 
 - (NSUInteger)countOfType:(XDTMessageTypeValue)type
 {
-    if (XDTMessageTypeAll == type) {
-        return _messages.count;
+    if (!_aggregated) {
+        if (XDTMessageTypeAll == type) {
+            return _messages.count;
+        }
+
+        NSPredicate *p = [NSPredicate predicateWithFormat:@"%K == %d", XDTMessageType, type];
+        NSOrderedSet<NSDictionary<XDTMessageTypeKey,id> *> *filtered = [_messages filteredOrderedSetUsingPredicate:p];
+        return filtered.count;
     }
 
-    NSPredicate *p = [NSPredicate predicateWithFormat:@"%K == %d", XDTMessageType, type];
-    NSOrderedSet<NSDictionary<XDTMessageTypeKey,id> *> *filtered = [_messages filteredOrderedSetUsingPredicate:p];
-    return filtered.count;
+    /* Every group counts all of its messages, and the messages beyond the memory limit are counted too */
+    NSUInteger retVal = (XDTMessageTypeAll == type)? [self droppedCount] : _droppedCounts[type];
+    for (NSDictionary<XDTMessageTypeKey,id> *message in _messages) {
+        if (XDTMessageTypeAll != type && type != [[message objectForKey:XDTMessageType] unsignedIntegerValue]) {
+            continue;
+        }
+        NSNumber *groupCount = [message objectForKey:XDTMessageCount];
+        retVal += (nil == groupCount)? 1 : [groupCount unsignedIntegerValue];
+    }
+    return retVal;
+}
+
+
+- (XDTMessage *)expandedMessages
+{
+    if (!_aggregated) {
+        return [XDTMessage messageWithMessages:self];
+    }
+
+    XDTMessage *origin = _origin;
+    if (nil == origin) {
+        origin = self;
+    }
+    XDTMessage *converted = [origin.messageSource expandedMessagesOfMessages:origin];
+    if (nil != converted) {
+        if (XDTMessageTypeAll != _expandedType) {
+            converted = [converted messagesOfType:_expandedType];
+        }
+        if (sortDescriptorsAscendingType == _usedSortDescriptors) {
+            converted = [converted sortedByPriorityAscendingType];
+        } else if (sortDescriptorsDecendingType == _usedSortDescriptors) {
+            converted = [converted sortedByPriorityDecendingType];
+        }
+        return converted;
+    }
+
+    NSMutableOrderedSet<NSDictionary<XDTMessageTypeKey, id> *> *expanded = [NSMutableOrderedSet orderedSetWithCapacity:[_messages count]];
+    for (NSDictionary<XDTMessageTypeKey, id> *message in _messages) {
+        NSArray<NSDictionary<XDTMessageTypeKey, id> *> *locations = [message objectForKey:XDTMessageLocations];
+        if (nil == locations) {
+            [expanded addObject:message];
+            continue;
+        }
+        for (NSDictionary<XDTMessageTypeKey, id> *location in locations) {
+            NSMutableDictionary<XDTMessageTypeKey, id> *expandedMessage = [NSMutableDictionary dictionaryWithDictionary:location];
+            [expandedMessage setObject:[message objectForKey:XDTMessageText] forKey:XDTMessageText];
+            [expandedMessage setObject:[message objectForKey:XDTMessageType] forKey:XDTMessageType];
+            [expanded addObject:expandedMessage];
+        }
+    }
+
+    XDTMessage *retVal = [[XDTMessage alloc] initWithSet:expanded];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    retVal->_usedSortDescriptors = _usedSortDescriptors;
+    return retVal;
 }
 
 
@@ -373,6 +652,15 @@ NS_ASSUME_NONNULL_END
 - (void)addMessages:(XDTMessage *)messages
 {
     [self willChangeValueForKey:NSStringFromSelector(@selector(count))];
+    if (0 >= [_messages count]) {
+        [self adoptAggregationOfMessages:messages filteringType:XDTMessageTypeAll];
+    } else {
+        [self giveUpMessageSource];
+        _aggregated |= messages->_aggregated;
+        for (NSUInteger typeValue = XDTMessageTypeAll; XDTMessageTypeDebug >= typeValue; typeValue++) {
+            _droppedCounts[typeValue] += messages->_droppedCounts[typeValue];
+        }
+    }
     [_messages unionOrderedSet:messages->_messages];
     [self didChangeValueForKey:NSStringFromSelector(@selector(count))];
 }
@@ -386,6 +674,11 @@ NS_ASSUME_NONNULL_END
     p = [NSPredicate predicateWithFormat:@"%K != %d", XDTMessageType, type];
 
     [self willChangeValueForKey:NSStringFromSelector(@selector(count))];
+    [self giveUpMessageSource];
+    _aggregated |= (nil != messages && messages->_aggregated);
+    if (XDTMessageTypeDebug >= type) {
+        _droppedCounts[type] = (nil == messages)? 0 : messages->_droppedCounts[type];
+    }
     [_messages filterUsingPredicate:p];
     [_messages unionOrderedSet:messagesOfSameType];
     [self didChangeValueForKey:NSStringFromSelector(@selector(count))];
@@ -32,11 +32,53 @@ typedef NS_ENUM(NSInteger, XDTErrorCode) {
     XDTErrorCodeToolException = 1,
     XDTErrorCodePythonError = 2,
     XDTErrorCodePythonException = 3,
+    XDTErrorCodeDetachedObject = 4,
+    XDTErrorCodeDiskImage = 5,
+    XDTErrorCodeCartridge = 6,
+    XDTErrorCodeDebugInfo = 7,
 };
 
 
+@class XDTInstrumentation;
+
+
+/*
+ Memory kept alive by a wrapper object: the Python objects reachable from the Python objects it holds, without
+ modules, classes, functions and code which are shared by all objects, and the Foundation buffers of its outputs.
+ Objects which are reachable from several wrapper objects are counted for each of them, only XDTMemoryBudget counts
+ them once.
+ */
+typedef struct {
+    NSUInteger pythonObjectCount;
+    NSUInteger pythonByteCount;
+    NSUInteger nativeByteCount;
+} XDTMemoryUsage;
+
+
 @interface XDTObject : NSObject
 
+/* Opt-in recorder of the phase timings and counters, nothing is measured as long as it is nil. */
+@property (nullable, retain) XDTInstrumentation *instrumentation;
+
+/* Reinitializing finalizes the running Python, so no other thread may use any of the tools meanwhile. */
 + (void)reinitializeWithXDTModulePath:(NSString *)modulePath;
++ (void)reinitializeWithXDTModuleBundle:(NSString *)bundlePath;
+
+/*
+ Several releases of xdt99 can be used side by side in the running Python. The modules of a registered version are
+ loaded beside the modules of the framework under names with the version, e.g. xas99_2_0_1, when a tool is created
+ with this version in its module version option. Tools without this option, or with a version which is not
+ registered, use the modules of the framework. Reloading executes modules which are already loaded again, so changed
+ sources are used without finalizing Python. Wrapper objects created before keep the modules they were created with.
+ The modules of a registered version keep the version of their own release, which is not checked. Only releases
+ whose modules import nothing but the standard library can be registered, a module which imports another module of
+ xdt99 fails to load.
+ */
++ (BOOL)registerXDTModulePath:(NSString *)modulePath forVersion:(NSString *)version error:(NSError **)error;    /* A directory or a module bundle */
++ (BOOL)reloadXDTModulesOfVersion:(nullable NSString *)version error:(NSError **)error;   /* nil reloads the modules of the framework */
++ (NSArray<NSString *> *)registeredXDTModuleVersions;
+
+/* Walks the held Python objects, so it costs about as much as copying them. */
+- (XDTMemoryUsage)memoryUsage;
 
 @end
@@ -25,6 +25,211 @@
 #import "XDTObject.h"
 
 #import <Python/Python.h>
+#import <objc/runtime.h>
+
+#import "XDTPythonGIL.h"
+#import "NSErrorPythonAdditions.h"
+
+
+/* The precompiled modules build by Scripts/bundle-xdt99.py */
+#define XDTModuleBundleName @"xdt99"
+#define XDTModuleBundleType @"zip"
+
+/* Overrides the location of the modules, either a directory or a module bundle */
+#define XDTModulePathEnvironmentKey "XDTOOLS99_MODULE_PATH"
+
+
+/* Thread state of the thread which has initialized Python, the GIL is released as long as Python runs */
+static PyThreadState *XDTInitializingThreadState = NULL;
+
+
+/* Takes the GIL back from the other threads, Python needs it to finalize */
+static void XDTFinalizePython(void)
+{
+    if (NULL != XDTInitializingThreadState) {
+        PyEval_RestoreThread(XDTInitializingThreadState);
+        XDTInitializingThreadState = NULL;
+    }
+    Py_Finalize();
+}
+
+
+/* Every thread takes the GIL by XDTAcquireGIL() when it needs Python, also the initializing thread */
+static void XDTReleaseInitializedPython(void)
+{
+    PyEval_InitThreads();
+    XDTInitializingThreadState = PyEval_SaveThread();
+}
+
+
+/* Module paths of the registered versions of xdt99, by their version, only used while holding the GIL */
+static NSMutableDictionary<NSString *, NSString *> *XDTRegisteredModulePathes = nil;
+
+
+/* The name in sys.modules of a module of a registered version, e.g. xas99_2_0_1 */
+static NSString *XDTVersionedModuleName(const char *moduleName, NSString *version)
+{
+    NSString *suffix = [[version componentsSeparatedByCharactersInSet:[[NSCharacterSet alphanumericCharacterSet] invertedSet]] componentsJoinedByString:@"_"];
+    return [NSString stringWithFormat:@"%s_%@", moduleName, suffix];
+}
+
+
+/*
+ Takes or releases the import lock of Python, which serializes loading modules. Waiting for it releases the GIL, so
+ unlike an Objective-C lock it cannot deadlock with a thread that holds the GIL. Returns NO with a Python error set.
+ */
+static BOOL XDTCallImportLock(const char *functionName)
+{
+    PyObject *pImpModule = PyImport_ImportModule("imp");
+    PyObject *pResult = (NULL == pImpModule)? NULL : PyObject_CallMethod(pImpModule, (char *)functionName, NULL);
+    Py_XDECREF(pImpModule);
+    Py_XDECREF(pResult);
+    return NULL != pResult;
+}
+
+
+/*
+ Executes the source or byte code of a module from a directory or a module bundle under another name. Only the
+ module itself gets a name with the version, any module it imports is shared with the framework. So releases whose
+ modules only import the standard library are supported. A module which imports another module of xdt99, like the
+ shared xcommon of later releases, would run with the module of the framework instead of its own release, so it
+ fails with an ImportError. Returns a new reference, the caller holds the import lock.
+ */
+static PyObject *XDTLoadVersionedModule(const char *moduleName, NSString *versionedName, NSString *modulePath)
+{
+    static const char *xdtModuleNames[] = {"xcommon", "xas99", "xga99", "xbas99", "xdm99", "xhm99", "xvm99", "xda99", "xdg99"};
+
+    PyObject *pCode = NULL;
+    NSString *filePath = nil;
+    if ([[modulePath pathExtension] isEqualToString:XDTModuleBundleType]) {
+        PyObject *pZipModule = PyImport_ImportModuleNoBlock("zipimport");
+        PyObject *pImporter = (NULL == pZipModule)? NULL : PyObject_CallMethod(pZipModule, "zipimporter", "s", modulePath.fileSystemRepresentation);
+        pCode = (NULL == pImporter)? NULL : PyObject_CallMethod(pImporter, "get_code", "s", moduleName);
+        filePath = [modulePath stringByAppendingPathComponent:[NSString stringWithFormat:@"%s.pyc", moduleName]];
+        Py_XDECREF(pImporter);
+        Py_XDECREF(pZipModule);
+    } else {
+        filePath = [modulePath stringByAppendingPathComponent:[NSString stringWithFormat:@"%s.py", moduleName]];
+        NSData *source = [NSData dataWithContentsOfFile:filePath];
+        if (nil == source) {
+            PyErr_Format(PyExc_ImportError, "No module named %s in %s", moduleName, modulePath.fileSystemRepresentation);
+            return NULL;
+        }
+        NSMutableData *terminatedSource = [NSMutableData dataWithData:source];
+        [terminatedSource appendBytes:"\n" length:2];
+        pCode = Py_CompileString([terminatedSource bytes], filePath.fileSystemRepresentation, Py_file_input);
+    }
+    if (NULL == pCode) {
+        return NULL;
+    }
+
+    PyObject *retVal = PyImport_ExecCodeModuleEx((char *)versionedName.UTF8String, pCode, (char *)filePath.fileSystemRepresentation);
+    Py_DECREF(pCode);
+
+    PyObject *pKey = NULL;
+    PyObject *pValue = NULL;
+    Py_ssize_t position = 0;
+    while (NULL != retVal && PyDict_Next(PyModule_GetDict(retVal), &position, &pKey, &pValue)) {
+        const char *importedName = PyModule_Check(pValue)? PyModule_GetName(pValue) : NULL;
+        if (NULL == importedName) {
+            PyErr_Clear();
+            continue;
+        }
+        for (size_t i = 0; i < sizeof(xdtModuleNames) / sizeof(xdtModuleNames[0]); i++) {
+            if (0 == strcmp(importedName, xdtModuleNames[i])) {
+                PyErr_Format(PyExc_ImportError, "Module %s of %s imports %s, which cannot be loaded side by side with other versions",
+                             moduleName, modulePath.fileSystemRepresentation, importedName);
+                PyDict_DelItemString(PyImport_GetModuleDict(), versionedName.UTF8String);
+                Py_CLEAR(retVal);
+                break;
+            }
+        }
+    }
+    return retVal;
+}
+
+
+/* Objects still to visit, all visited objects and the objects to skip of a walk through the Python objects held by a wrapper */
+typedef struct {
+    __unsafe_unretained NSHashTable *visited;
+    __unsafe_unretained NSMutableData *pending;
+    __unsafe_unretained NSArray<NSHashTable *> *excluded;
+    BOOL hasSkippedExcluded;
+} XDTPythonObjectWalk;
+
+
+/* Modules, classes, functions and code are shared by all objects, so they are neither counted nor walked through */
+static BOOL XDTIsSharedPythonObject(PyObject *object)
+{
+    return Py_None == object || PyModule_Check(object) || PyType_Check(object) || PyClass_Check(object) ||
+           PyFunction_Check(object) || PyCFunction_Check(object) || PyMethod_Check(object) || PyCode_Check(object) ||
+           PyFrame_Check(object) || PyFile_Check(object);
+}
+
+
+static int XDTVisitPythonObject(PyObject *object, void *context)
+{
+    XDTPythonObjectWalk *walk = (XDTPythonObjectWalk *)context;
+    if (NULL == object || XDTIsSharedPythonObject(object)) {
+        return 0;
+    }
+    for (NSHashTable *excludedObjects in walk->excluded) {
+        if (NULL != NSHashGet(excludedObjects, object)) {
+            walk->hasSkippedExcluded = YES;
+            return 0;
+        }
+    }
+    if (NULL != NSHashInsertIfAbsent(walk->visited, object)) {
+        return 0;
+    }
+    [walk->pending appendBytes:&object length:sizeof(PyObject *)];
+    return 0;
+}
+
+
+/* Like sys.getsizeof(), but the most frequent objects are sized without calling __sizeof__() */
+static NSUInteger XDTSizeOfPythonObject(PyObject *object)
+{
+    PyTypeObject *type = Py_TYPE(object);
+    NSUInteger retVal = type->tp_basicsize;
+    if (PyString_CheckExact(object) || PyTuple_CheckExact(object) || PyLong_CheckExact(object)) {
+        retVal += labs(Py_SIZE(object)) * type->tp_itemsize;
+    } else if (!PyInt_CheckExact(object) && !PyFloat_CheckExact(object) && !PyInstance_Check(object)) {
+        PyObject *pSize = PyObject_CallMethod(object, "__sizeof__", NULL);
+        Py_ssize_t size = (NULL == pSize)? -1 : PyInt_AsSsize_t(pSize);
+        Py_XDECREF(pSize);
+        if (0 < size) {
+            retVal = size;
+        } else {
+            PyErr_Clear();
+        }
+    }
+    if (PyObject_IS_GC(object)) {
+        retVal += sizeof(PyGC_Head);
+    }
+    return retVal;
+}
+
+
+@interface XDTObject ()
+
+/* Overridden by the subclasses which hold Python objects or native outputs */
+- (NSArray<NSValue *> *)heldPythonObjects;
+- (NSUInteger)nativeByteCount;
+
+/*
+ Adds the counted Python objects to the opaque hash table, the objects in the excluded tables are neither counted nor
+ walked through. Tells whether any reachable object was excluded, i.e. shared with the objects of these tables.
+ */
+- (XDTMemoryUsage)memoryUsageCollectingPythonObjects:(NSHashTable *)pythonObjects excludingPythonObjects:(NSArray<NSHashTable *> *)excludedObjects
+                                        sharesPythonObjects:(nullable BOOL *)sharesPythonObjects;
+
++ (NSUInteger)nativeByteCountOfObject:(nullable id)object;
+
+/* Imports the module of the registered version, or the module of the framework, with the GIL held */
++ (nullable PyObject *)importXDTModule:(const char *)moduleName version:(nullable NSString *)version;
+
+@end
 
 
 @implementation XDTObject
@@ -35,6 +240,27 @@
     if (Py_IsInitialized()) {
         return;
     }
+
+    const char *environmentPath = getenv(XDTModulePathEnvironmentKey);
+    if (NULL != environmentPath && '\0' != *environmentPath) {
+        NSString *modulePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:environmentPath length:strlen(environmentPath)];
+        if ([[modulePath pathExtension] isEqualToString:XDTModuleBundleType]) {
+            [self reinitializeWithXDTModuleBundle:modulePath];
+        } else {
+            [self reinitializeWithXDTModulePath:modulePath];
+        }
+        return;
+    }
+
+    /* A module bundle needs neither a module search over the whole Python path nor compiling, so it is preferred. */
+    for (NSBundle *bundle in @[[NSBundle mainBundle], [NSBundle bundleForClass:[self class]]]) {
+        NSString *bundlePath = [bundle pathForResource:XDTModuleBundleName ofType:XDTModuleBundleType];
+        if (nil != bundlePath) {
+            [self reinitializeWithXDTModuleBundle:bundlePath];
+            return;
+        }
+    }
+
     NSArray<NSString *>* modulPathes = @[[[NSBundle mainBundle] resourcePath], [[NSBundle bundleForClass:[self class]] resourcePath]];
     [self reinitializeWithXDTModulePath:[modulPathes componentsJoinedByString:@":"]];
 }
@@ -43,19 +269,267 @@
 + (void)reinitializeWithXDTModulePath:(NSString *)modulePath
 {
     @synchronized (self) {
-        Py_Finalize();
+        XDTFinalizePython();
+        Py_NoSiteFlag = 0;
+        Py_DontWriteBytecodeFlag = 0;
         Py_Initialize();
 
         NSString *pyModulePath = [NSString stringWithFormat:@"%s:%s", Py_GetPath(), [modulePath fileSystemRepresentation]];
         PySys_SetPath((char *)pyModulePath.UTF8String);
+        XDTReleaseInitializedPython();
     }
 }
 
 
+/*
+ The bundle is a zip archive with the byte code of the xdt99 modules and of the pure Python modules of the standard
+ library they need. So the path only contains the bundle, the directory of the extension modules and, as fallback for
+ modules which are not bundled, the standard library. The site module is skipped, it only adds the site-packages.
+ */
++ (void)reinitializeWithXDTModuleBundle:(NSString *)bundlePath
+{
+    @synchronized (self) {
+        XDTFinalizePython();
+        Py_NoSiteFlag = 1;
+        Py_DontWriteBytecodeFlag = 1;
+        Py_Initialize();
+
+        NSMutableArray<NSString *> *pathes = [NSMutableArray arrayWithObject:bundlePath];
+        NSArray<NSString *> *defaultPathes = [[NSString stringWithUTF8String:Py_GetPath()] componentsSeparatedByString:@":"];
+        for (NSString *path in defaultPathes) {
+            if ([[path lastPathComponent] isEqualToString:@"lib-dynload"]) {
+                [pathes addObject:path];
+                [pathes addObject:[path stringByDeletingLastPathComponent]];
+            }
+        }
+        NSString *pyModulePath = [pathes componentsJoinedByString:@":"];
+        PySys_SetPath((char *)pyModulePath.fileSystemRepresentation);
+        XDTReleaseInitializedPython();
+    }
+}
+
+
+#pragma mark - Module Versions
+
+
++ (BOOL)registerXDTModulePath:(NSString *)modulePath forVersion:(NSString *)version error:(NSError **)error
+{
+    BOOL isDirectory = NO;
+    if (![[NSFileManager defaultManager] fileExistsAtPath:modulePath isDirectory:&isDirectory] ||
+        (!isDirectory && ![[modulePath pathExtension] isEqualToString:XDTModuleBundleType])) {
+        if (nil != error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadNoSuchFileError userInfo:@{NSFilePathErrorKey: modulePath}];
+        }
+        return NO;
+    }
+
+    BOOL hasChangedPath = NO;
+    {
+        XDTAcquireGIL();
+        if (nil == XDTRegisteredModulePathes) {
+            XDTRegisteredModulePathes = [[NSMutableDictionary alloc] init];
+        }
+        NSString *oldPath = [XDTRegisteredModulePathes objectForKey:version];
+        hasChangedPath = nil != oldPath && ![oldPath isEqualToString:modulePath];
+        [XDTRegisteredModulePathes setObject:modulePath forKey:version];
+    }
+
+    /* Modules already loaded from the old path are replaced */
+    return !hasChangedPath || [self reloadXDTModulesOfVersion:version error:error];
+}
+
+
++ (NSArray<NSString *> *)registeredXDTModuleVersions
+{
+    XDTAcquireGIL();
+    return [[XDTRegisteredModulePathes allKeys] sortedArrayUsingSelector:@selector(compare:)];
+}
+
+
+/*
+ The registered versions are guarded by the GIL, and loading modules by the import lock of Python, which releases
+ the GIL while it waits. An Objective-C lock must not be used here: module code may hand the GIL to another thread,
+ which would then wait for the lock while holding the GIL.
+ */
++ (BOOL)reloadXDTModulesOfVersion:(NSString *)version error:(NSError **)error
+{
+    static const char *moduleNames[] = {"xas99", "xga99", "xbas99"};
+
+    XDTAcquireGIL();
+    NSString *modulePath = (nil == version)? nil : [XDTRegisteredModulePathes objectForKey:version];
+    const BOOL isLocked = XDTCallImportLock("acquire_lock");
+    BOOL retVal = isLocked;
+    PyObject *pModules = PyImport_GetModuleDict();
+    for (size_t i = 0; retVal && i < sizeof(moduleNames) / sizeof(moduleNames[0]); i++) {
+        PyObject *pNewModule = NULL;
+        if (nil == modulePath) {
+            PyObject *pModule = PyDict_GetItemString(pModules, moduleNames[i]);
+            if (NULL == pModule) {
+                continue;
+            }
+            pNewModule = PyImport_ReloadModule(pModule);
+        } else {
+            NSString *versionedName = XDTVersionedModuleName(moduleNames[i], version);
+            if (NULL == PyDict_GetItemString(pModules, versionedName.UTF8String)) {
+                continue;
+            }
+            /* A new module object, so wrapper objects of the old one are left unchanged */
+            PyDict_DelItemString(pModules, versionedName.UTF8String);
+            pNewModule = XDTLoadVersionedModule(moduleNames[i], versionedName, modulePath);
+        }
+        if (NULL == pNewModule) {
+            NSLog(@"%s ERROR: Reloading module '%s' failed! Version: %@", __FUNCTION__, moduleNames[i], (nil == version)? @"of the framework" : version);
+            retVal = NO;
+            break;
+        }
+        Py_DECREF(pNewModule);
+    }
+
+    PyObject *exception = PyErr_Occurred();
+    if (NULL != exception) {
+        if (nil != error) {
+            *error = [NSError errorWithPythonError:exception localizedRecoverySuggestion:nil];
+        }
+        PyErr_Print();
+    }
+    if (isLocked) {
+        XDTCallImportLock("release_lock");
+    }
+    return retVal;
+}
+
+
++ (PyObject *)importXDTModule:(const char *)moduleName version:(NSString *)version
+{
+    NSString *modulePath = (nil == version)? nil : [XDTRegisteredModulePathes objectForKey:version];
+    if (nil == modulePath) {
+        return PyImport_ImportModuleNoBlock(moduleName);
+    }
+
+    NSString *versionedName = XDTVersionedModuleName(moduleName, version);
+    if (!XDTCallImportLock("acquire_lock")) {
+        return NULL;
+    }
+    PyObject *retVal = PyDict_GetItemString(PyImport_GetModuleDict(), versionedName.UTF8String);
+    if (NULL != retVal) {
+        Py_INCREF(retVal);
+    } else {
+        retVal = XDTLoadVersionedModule(moduleName, versionedName, modulePath);
+    }
+
+    /* Releasing must not replace the error of loading the module */
+    PyObject *pType = NULL, *pValue = NULL, *pTraceback = NULL;
+    PyErr_Fetch(&pType, &pValue, &pTraceback);
+    XDTCallImportLock("release_lock");
+    PyErr_Restore(pType, pValue, pTraceback);
+    return retVal;
+}
+
+
+#pragma mark - Memory Accounting
+
+
+- (NSArray<NSValue *> *)heldPythonObjects
+{
+    return @[];
+}
+
+
+- (NSUInteger)nativeByteCount
+{
+    return 0;
+}
+
+
+/* Foundation objects of the outputs, containers with their elements, any other object by the size of its instance */
++ (NSUInteger)nativeByteCountOfObject:(id)object
+{
+    if (nil == object) {
+        return 0;
+    }
+    if ([object isKindOfClass:[NSData class]]) {
+        return [(NSData *)object length];
+    }
+    if ([object isKindOfClass:[NSString class]]) {
+        return [(NSString *)object length] * sizeof(unichar);
+    }
+    if ([object isKindOfClass:[XDTObject class]]) {
+        return [(XDTObject *)object nativeByteCount];
+    }
+
+    NSUInteger retVal = class_getInstanceSize([object class]);
+    if ([object isKindOfClass:[NSArray class]]) {
+        for (id element in (NSArray *)object) {
+            retVal += sizeof(id) + [self nativeByteCountOfObject:element];
+        }
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = (NSDictionary *)object;
+        for (id key in dictionary) {
+            retVal += 2 * sizeof(id) + [self nativeByteCountOfObject:key] + [self nativeByteCountOfObject:[dictionary objectForKey:key]];
+        }
+    }
+    return retVal;
+}
+
+
+- (XDTMemoryUsage)memoryUsage
+{
+    NSHashTable *visited = [[NSHashTable alloc] initWithOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality capacity:1024];
+    XDTMemoryUsage retVal = [self memoryUsageCollectingPythonObjects:visited excludingPythonObjects:@[] sharesPythonObjects:NULL];
+#if !__has_feature(objc_arc)
+    [visited release];
+#endif
+    return retVal;
+}
+
+
+- (XDTMemoryUsage)memoryUsageCollectingPythonObjects:(NSHashTable *)visited excludingPythonObjects:(NSArray<NSHashTable *> *)excludedObjects
+                                        sharesPythonObjects:(BOOL *)sharesPythonObjects
+{
+    XDTMemoryUsage retVal = {0, 0, [self nativeByteCount]};
+    if (NULL != sharesPythonObjects) {
+        *sharesPythonObjects = NO;
+    }
+
+    XDTAcquireGIL();
+    NSArray<NSValue *> *heldObjects = [self heldPythonObjects];
+    if (0 == [heldObjects count] || !xdtGILScope.isHeld) {
+        return retVal;
+    }
+
+    /* Depth first through the references which the garbage collector knows, each object is counted once */
+    NSMutableData *pending = [[NSMutableData alloc] initWithCapacity:1024 * sizeof(PyObject *)];
+    XDTPythonObjectWalk walk = {visited, pending, excludedObjects, NO};
+    for (NSValue *heldObject in heldObjects) {
+        XDTVisitPythonObject((PyObject *)[heldObject pointerValue], &walk);
+    }
+    while (0 < [pending length]) {
+        NSUInteger lastOffset = [pending length] - sizeof(PyObject *);
+        PyObject *object = *(PyObject **)((const char *)[pending bytes] + lastOffset);
+        [pending setLength:lastOffset];
+
+        retVal.pythonObjectCount++;
+        retVal.pythonByteCount += XDTSizeOfPythonObject(object);
+        traverseproc traverse = Py_TYPE(object)->tp_traverse;
+        if (PyObject_IS_GC(object) && NULL != traverse) {
+            traverse(object, XDTVisitPythonObject, &walk);
+        }
+    }
+#if !__has_feature(objc_arc)
+    [pending release];
+#endif
+
+    if (NULL != sharesPythonObjects) {
+        *sharesPythonObjects = walk.hasSkippedExcluded;
+    }
+    return retVal;
+}
+
+
 /* This calss method is deprecated from macOS 10.8 on, but where should it be placed else? */
 + (void)finalize
 {
-    Py_Finalize();
+    XDTFinalizePython();
 }
 
 @end
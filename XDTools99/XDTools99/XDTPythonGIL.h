@@ -0,0 +1,80 @@
+//
+//  XDTPythonGIL.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Python/Python.h>
+
+
+/*
+ The threading model of the framework: every method which touches Python objects takes the GIL first and releases
+ it when it returns, so the wrapper objects may be used from any thread. Nested calls of the same thread just keep
+ the GIL. Native work in between, like the native assemblers or building cross references, runs between
+ XDTBeginNativeWork() and XDTEndNativeWork(), so other threads may call Python meanwhile.
+
+ Messages, detached symbols, cross references, address maps and all captured outputs are immutable Foundation
+ objects, which any number of threads may query at the same time. Only the mutable variants like XDTMutableMessage
+ belong to one thread.
+
+ Applications which call the Python API themselves, e.g. to install a profiler or to build a list for XDTMessage,
+ use XDTAcquireGIL() the same way.
+ */
+
+typedef struct {
+    int isHeld;
+    PyGILState_STATE state;
+} XDTGILScope;
+
+
+/* Without a running Python there are no Python objects, so e.g. messages of the build client need no GIL */
+static inline XDTGILScope XDTEnterGILScope(void)
+{
+    XDTGILScope retVal = {Py_IsInitialized(), PyGILState_UNLOCKED};
+    if (retVal.isHeld) {
+        retVal.state = PyGILState_Ensure();
+    }
+    return retVal;
+}
+
+
+static inline void XDTLeaveGILScope(XDTGILScope *scope)
+{
+    if (scope->isHeld) {
+        PyGILState_Release(scope->state);
+    }
+}
+
+
+/* Takes the GIL for the rest of the enclosing scope, it is released by any way of leaving the scope */
+#define XDTAcquireGIL() \
+    XDTGILScope xdtGILScope __attribute__((cleanup(XDTLeaveGILScope), unused)) = XDTEnterGILScope()
+
+
+/*
+ Releases the GIL taken by XDTAcquireGIL() of the same scope until XDTEndNativeWork(), like Py_BEGIN_ALLOW_THREADS.
+ The code in between must not touch any Python object, results are assigned to variables declared before.
+ */
+#define XDTBeginNativeWork() \
+    { PyThreadState *xdtSavedThreadState = (xdtGILScope.isHeld) ? PyEval_SaveThread() : NULL;
+#define XDTEndNativeWork() \
+    if (NULL != xdtSavedThreadState) { PyEval_RestoreThread(xdtSavedThreadState); } }
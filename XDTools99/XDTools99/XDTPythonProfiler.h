@@ -0,0 +1,79 @@
+//
+//  XDTPythonProfiler.h
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Aggregated times of one Python function or built-in function. Times are in nanoseconds, the total time of
+ recursive functions counts only the outermost calls.
+ */
+@interface XDTPythonProfileFunction : NSObject
+
+@property (readonly) NSString *name;          /* Name of the function, directives of xas99 and xga99 are named like them */
+@property (readonly, nullable) NSString *fileName;  /* Last path component of the module file, nil for built-in functions */
+@property (readonly) NSUInteger lineNumber;   /* First line of the function, 0 for built-in functions */
+@property (readonly) NSUInteger callCount;
+@property (readonly) uint64_t totalTime;      /* Including the called functions */
+@property (readonly) uint64_t selfTime;       /* Without the called functions */
+
+@end
+
+
+/**
+ Opt-in profiler of the Python code which runs in the embedded interpreter.
+
+ The profiler is installed by an XDTInstrumentation object which has it set, for the duration of every phase which
+ calls Python, like assembling, parsing or generating an output. Pass it with the Python profiler option key of a
+ tool, which sets it to the instrumentation of the tool and all objects the tool creates. It records a call tree
+ below the names of the phases, so the same functions of different phases are kept apart, and from all threads.
+
+ The functions are resolved by the code objects only at their first call, any other call costs a lookup among the
+ callees of the caller and two clock readings.
+ */
+@interface XDTPythonProfiler : NSObject
+
+@property BOOL profilesBuiltinFunctions;   /* Also records calls of built-in functions and methods, default is YES */
+
++ (instancetype)pythonProfiler;
+
+- (void)reset;
+
+/* Sorted by descending self time */
+- (NSArray<XDTPythonProfileFunction *> *)functions;
+
+/*
+ Folded stacks for flame graph tools like flamegraph.pl or speedscope, one line for each path of the call tree with
+ its self time in microseconds:
+    assemble;assemble (xas99.py:1843);DATA (xas99.py:611) 1234
+ */
+- (NSData *)foldedStacksData;
+- (BOOL)writeFoldedStacksToURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,557 @@
+//
+//  XDTPythonProfiler.m
+//  XDTools99
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTPythonProfiler.h"
+
+#import <Python/Python.h>
+#import <Python/frameobject.h>
+
+#import "XDTPythonGIL.h"
+
+#include <mach/mach_time.h>
+#include <stdlib.h>
+
+
+#define XDTPythonProfilerCapsuleName "XDTools99.XDTPythonProfiler"
+#define XDTPythonProfilerRootNode 0
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/* A node of the call tree, times are in mach absolute time units */
+typedef struct {
+    const void *key;            /* code object, method definition of a built-in function or the name of a phase */
+    NSUInteger functionIndex;
+    NSUInteger parent;
+    NSUInteger firstChild;
+    NSUInteger nextSibling;
+    NSUInteger callCount;
+    uint64_t totalTime;
+} XDTPythonProfilerNode;
+
+
+typedef struct {
+    NSUInteger node;
+    uint64_t startTime;
+    BOOL isPhase;
+} XDTPythonProfilerFrame;
+
+
+/* The call stack of one thread, owned by the capsule which is installed as the profile object of the thread state */
+typedef struct {
+    __unsafe_unretained XDTPythonProfiler *profiler;
+    XDTPythonProfilerFrame *frames;
+    NSUInteger depth;
+    NSUInteger capacity;
+    BOOL profilesBuiltinFunctions;
+    Py_tracefunc previousFunction;  /* e.g. the call counter of xdt99bench, which is called further on */
+    PyObject *previousObject;
+} XDTPythonProfilerActivation;
+
+
+@interface XDTPythonProfileFunction ()
+
+@property NSString *name;
+@property (nullable) NSString *fileName;
+@property NSUInteger lineNumber;
+@property NSUInteger callCount;
+@property uint64_t totalTime;
+@property uint64_t selfTime;
+
+@end
+
+
+@interface XDTPythonProfiler () {
+    NSMutableData *_nodeData;
+    XDTPythonProfilerNode *_nodes;  /* the bytes of _nodeData, updated whenever it grows */
+    NSUInteger _nodeCount;
+    NSMapTable *_functionIndexes;   /* key of a node to its function index + 1 */
+    NSMutableDictionary<NSString *, NSNumber *> *_phaseIndexes;
+    NSMutableArray<NSString *> *_functionNames;
+    NSMutableArray<id> *_fileNames;  /* NSNull for built-in functions and phases */
+    NSMutableArray<NSNumber *> *_lineNumbers;
+    PyObject *_codeObjects;         /* keeps the code objects alive, so their addresses stay unique */
+    mach_timebase_info_data_t _timebase;
+}
+
+- (NSUInteger)functionIndexForKey:(const void *)key function:(PyObject *)function;
+- (NSUInteger)childOfNode:(NSUInteger)parent key:(const void *)key function:(nullable PyObject *)function;
+
+/* Used by XDTInstrumentation around the phases which call Python, the caller holds the GIL */
+- (BOOL)beginPhase:(NSString *)name;
+- (void)endPhase;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+static void XDTPythonProfilerFreeActivation(PyObject *capsule)
+{
+    XDTPythonProfilerActivation *activation = PyCapsule_GetPointer(capsule, XDTPythonProfilerCapsuleName);
+    if (NULL != activation) {
+        free(activation->frames);
+        free(activation);
+    }
+}
+
+
+static void XDTPythonProfilerPushFrame(XDTPythonProfilerActivation *activation, NSUInteger node, uint64_t startTime, BOOL isPhase)
+{
+    if (activation->depth == activation->capacity) {
+        activation->capacity = (0 == activation->capacity)? 64 : 2 * activation->capacity;
+        activation->frames = reallocf(activation->frames, activation->capacity * sizeof(XDTPythonProfilerFrame));
+        if (NULL == activation->frames) {
+            activation->depth = activation->capacity = 0;
+            return;
+        }
+    }
+    activation->frames[activation->depth++] = (XDTPythonProfilerFrame){node, startTime, isPhase};
+}
+
+
+@implementation XDTPythonProfileFunction
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"%@ %@ (%@:%lu): %lu calls, %llu ns total, %llu ns self", [super description],
+            _name, _fileName, (unsigned long)_lineNumber, (unsigned long)_callCount, _totalTime, _selfTime];
+}
+
+@end
+
+
+@implementation XDTPythonProfiler
+
+/* Calls of one function are only matched by its key, so unpaired events of a profiler set up in a call are ignored. */
+static void XDTPythonProfilerEnter(XDTPythonProfilerActivation *activation, const void *key, PyObject *function, uint64_t now)
+{
+    __unsafe_unretained XDTPythonProfiler *profiler = activation->profiler;
+    if (0 == activation->depth || activation->frames[activation->depth - 1].node >= profiler->_nodeCount) {
+        return;
+    }
+    const NSUInteger node = [profiler childOfNode:activation->frames[activation->depth - 1].node key:key function:function];
+    profiler->_nodes[node].callCount++;
+    XDTPythonProfilerPushFrame(activation, node, now, NO);
+}
+
+
+static void XDTPythonProfilerLeave(XDTPythonProfilerActivation *activation, const void *key, uint64_t now)
+{
+    __unsafe_unretained XDTPythonProfiler *profiler = activation->profiler;
+    if (0 == activation->depth) {
+        return;
+    }
+    const XDTPythonProfilerFrame frame = activation->frames[activation->depth - 1];
+    if (frame.isPhase || frame.node >= profiler->_nodeCount || key != profiler->_nodes[frame.node].key) {
+        return;
+    }
+    profiler->_nodes[frame.node].totalTime += now - frame.startTime;
+    activation->depth--;
+}
+
+
+static int XDTPythonProfilerTrace(PyObject *object, PyFrameObject *frame, int what, PyObject *arg)
+{
+    XDTPythonProfilerActivation *activation = PyCapsule_GetPointer(object, XDTPythonProfilerCapsuleName);
+    const uint64_t now = mach_absolute_time();
+    switch (what) {
+        case PyTrace_CALL:
+            XDTPythonProfilerEnter(activation, frame->f_code, (PyObject *)frame->f_code, now);
+            break;
+        case PyTrace_RETURN:
+            XDTPythonProfilerLeave(activation, frame->f_code, now);
+            break;
+        case PyTrace_C_CALL:
+            if (activation->profilesBuiltinFunctions && PyCFunction_Check(arg)) {
+                XDTPythonProfilerEnter(activation, ((PyCFunctionObject *)arg)->m_ml, arg, now);
+            }
+            break;
+        case PyTrace_C_RETURN:
+        case PyTrace_C_EXCEPTION:
+            if (activation->profilesBuiltinFunctions && PyCFunction_Check(arg)) {
+                XDTPythonProfilerLeave(activation, ((PyCFunctionObject *)arg)->m_ml, now);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (NULL != activation->previousFunction) {
+        return activation->previousFunction(activation->previousObject, frame, what, arg);
+    }
+    return 0;
+}
+
+
+#pragma mark Initializers
+
+
++ (instancetype)pythonProfiler
+{
+    XDTPythonProfiler *retVal = [[XDTPythonProfiler alloc] init];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)init
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _profilesBuiltinFunctions = YES;
+    mach_timebase_info(&_timebase);
+    _nodeData = [[NSMutableData alloc] init];
+    _functionIndexes = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality
+                                                 valueOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsIntegerPersonality
+                                                     capacity:256];
+    _phaseIndexes = [[NSMutableDictionary alloc] init];
+    _functionNames = [[NSMutableArray alloc] init];
+    _fileNames = [[NSMutableArray alloc] init];
+    _lineNumbers = [[NSMutableArray alloc] init];
+    [self reset];
+
+    return self;
+}
+
+
+- (void)dealloc
+{
+    XDTAcquireGIL();
+    Py_CLEAR(_codeObjects);
+#if !__has_feature(objc_arc)
+    [_nodeData release];
+    [_functionIndexes release];
+    [_phaseIndexes release];
+    [_functionNames release];
+    [_fileNames release];
+    [_lineNumbers release];
+
+    [super dealloc];
+#endif
+}
+
+
+#pragma mark - Recording
+
+
+/* Must not be called while a phase is profiled */
+- (void)reset
+{
+    XDTAcquireGIL();
+    [_functionIndexes removeAllObjects];
+    [_phaseIndexes removeAllObjects];
+    [_functionNames removeAllObjects];
+    [_fileNames removeAllObjects];
+    [_lineNumbers removeAllObjects];
+    Py_CLEAR(_codeObjects);
+    if (Py_IsInitialized()) {
+        _codeObjects = PyList_New(0);
+    }
+
+    XDTPythonProfilerNode root = {NULL, NSNotFound, NSNotFound, NSNotFound, NSNotFound, 0, 0};
+    [_nodeData setLength:0];
+    [_nodeData appendBytes:&root length:sizeof(root)];
+    _nodes = [_nodeData mutableBytes];
+    _nodeCount = 1;
+}
+
+
+- (NSUInteger)functionIndexForKey:(const void *)key function:(PyObject *)function
+{
+    const NSUInteger storedIndex = (NSUInteger)NSMapGet(_functionIndexes, key);
+    if (0 != storedIndex) {
+        return storedIndex - 1;
+    }
+
+    NSString *name = nil;
+    id fileName = [NSNull null];
+    NSUInteger lineNumber = 0;
+    if (PyCode_Check(function)) {
+        PyCodeObject *code = (PyCodeObject *)function;
+        name = [NSString stringWithUTF8String:PyString_AsString(code->co_name)];
+        fileName = [[NSString stringWithUTF8String:PyString_AsString(code->co_filename)] lastPathComponent];
+        lineNumber = (NSUInteger)code->co_firstlineno;
+        if (NULL != _codeObjects) {
+            PyList_Append(_codeObjects, function);
+        }
+    } else {
+        PyCFunctionObject *builtin = (PyCFunctionObject *)function;
+        if (NULL == builtin->m_self || PyModule_Check(builtin->m_self)) {
+            name = [NSString stringWithFormat:@"<built-in function %s>", builtin->m_ml->ml_name];
+        } else {
+            name = [NSString stringWithFormat:@"<method '%s' of '%s' objects>", builtin->m_ml->ml_name, Py_TYPE(builtin->m_self)->tp_name];
+        }
+    }
+
+    const NSUInteger retVal = [_functionNames count];
+    [_functionNames addObject:(nil == name)? @"?" : name];
+    [_fileNames addObject:(nil == fileName)? [NSNull null] : fileName];
+    [_lineNumbers addObject:[NSNumber numberWithUnsignedInteger:lineNumber]];
+    NSMapInsert(_functionIndexes, key, (const void *)(retVal + 1));
+    return retVal;
+}
+
+
+- (NSUInteger)childOfNode:(NSUInteger)parent key:(const void *)key function:(PyObject *)function
+{
+    for (NSUInteger child = _nodes[parent].firstChild; NSNotFound != child; child = _nodes[child].nextSibling) {
+        if (key == _nodes[child].key) {
+            return child;
+        }
+    }
+
+    /* phases have no function object, their key is the name registered by beginPhase: */
+    const NSUInteger functionIndex = (NULL == function)? (NSUInteger)NSMapGet(_functionIndexes, key) - 1 : [self functionIndexForKey:key function:function];
+    XDTPythonProfilerNode node = {key, functionIndex, parent, NSNotFound, _nodes[parent].firstChild, 0, 0};
+    [_nodeData appendBytes:&node length:sizeof(node)];
+    _nodes = [_nodeData mutableBytes];
+    _nodes[parent].firstChild = _nodeCount;
+    return _nodeCount++;
+}
+
+
+- (BOOL)beginPhase:(NSString *)name
+{
+    XDTAcquireGIL();
+    if (!Py_IsInitialized()) {
+        return NO;
+    }
+    const uint64_t now = mach_absolute_time();
+
+    PyThreadState *threadState = PyThreadState_GET();
+    XDTPythonProfilerActivation *activation = NULL;
+    if (XDTPythonProfilerTrace == threadState->c_profilefunc) {
+        activation = PyCapsule_GetPointer(threadState->c_profileobj, XDTPythonProfilerCapsuleName);
+        if (self != activation->profiler) {
+            return NO;  /* another profiler records this thread already */
+        }
+    } else {
+        activation = calloc(1, sizeof(XDTPythonProfilerActivation));
+        if (NULL == activation) {
+            return NO;
+        }
+        PyObject *capsule = PyCapsule_New(activation, XDTPythonProfilerCapsuleName, XDTPythonProfilerFreeActivation);
+        if (NULL == capsule) {
+            free(activation);
+            PyErr_Clear();
+            return NO;
+        }
+        activation->profiler = self;
+        activation->profilesBuiltinFunctions = _profilesBuiltinFunctions;
+        activation->previousFunction = threadState->c_profilefunc;
+        activation->previousObject = threadState->c_profileobj;
+        Py_XINCREF(activation->previousObject);
+        PyEval_SetProfile(XDTPythonProfilerTrace, capsule);
+        Py_DECREF(capsule);
+    }
+
+    NSNumber *phaseIndex = [_phaseIndexes objectForKey:name];
+    if (nil == phaseIndex) {
+        phaseIndex = [NSNumber numberWithUnsignedInteger:[_functionNames count]];
+        [_phaseIndexes setObject:phaseIndex forKey:name];
+        [_functionNames addObject:name];
+        [_fileNames addObject:[NSNull null]];
+        [_lineNumbers addObject:@0];
+        NSMapInsert(_functionIndexes, (__bridge const void *)[_functionNames lastObject], (const void *)([phaseIndex unsignedIntegerValue] + 1));
+    }
+    const void *key = (__bridge const void *)[_functionNames objectAtIndex:[phaseIndex unsignedIntegerValue]];
+    const NSUInteger parent = (0 == activation->depth)? XDTPythonProfilerRootNode : activation->frames[activation->depth - 1].node;
+    const NSUInteger node = [self childOfNode:(parent < _nodeCount)? parent : XDTPythonProfilerRootNode key:key function:NULL];
+    _nodes[node].callCount++;
+    XDTPythonProfilerPushFrame(activation, node, now, YES);
+    return YES;
+}
+
+
+- (void)endPhase
+{
+    XDTAcquireGIL();
+    const uint64_t now = mach_absolute_time();
+    PyThreadState *threadState = PyThreadState_GET();
+    if (XDTPythonProfilerTrace != threadState->c_profilefunc) {
+        return;
+    }
+    XDTPythonProfilerActivation *activation = PyCapsule_GetPointer(threadState->c_profileobj, XDTPythonProfilerCapsuleName);
+    if (self != activation->profiler) {
+        return;
+    }
+
+    /* frames left open by an exception end with their phase */
+    while (0 < activation->depth) {
+        const XDTPythonProfilerFrame frame = activation->frames[--activation->depth];
+        if (frame.node < _nodeCount) {
+            _nodes[frame.node].totalTime += now - frame.startTime;
+        }
+        if (frame.isPhase) {
+            break;
+        }
+    }
+
+    if (0 == activation->depth) {
+        /* replacing the capsule frees the activation */
+        Py_tracefunc previousFunction = activation->previousFunction;
+        PyObject *previousObject = activation->previousObject;
+        PyEval_SetProfile(previousFunction, previousObject);
+        Py_XDECREF(previousObject);
+    }
+}
+
+
+#pragma mark - Results
+
+
+- (uint64_t)nanosecondsOfTime:(uint64_t)time
+{
+    return time * _timebase.numer / _timebase.denom;
+}
+
+
+- (uint64_t)selfTimeOfNode:(NSUInteger)node
+{
+    uint64_t retVal = _nodes[node].totalTime;
+    for (NSUInteger child = _nodes[node].firstChild; NSNotFound != child; child = _nodes[child].nextSibling) {
+        retVal -= MIN(retVal, _nodes[child].totalTime);
+    }
+    return retVal;
+}
+
+
+/* Adds the times of a node and its sub tree, the total time only when the function is not on the path already */
+- (void)accumulateNode:(NSUInteger)node callCounts:(NSUInteger *)callCounts totalTimes:(uint64_t *)totalTimes selfTimes:(uint64_t *)selfTimes activeCounts:(NSUInteger *)activeCounts
+{
+    const NSUInteger functionIndex = _nodes[node].functionIndex;
+    callCounts[functionIndex] += _nodes[node].callCount;
+    selfTimes[functionIndex] += [self selfTimeOfNode:node];
+    if (0 == activeCounts[functionIndex]) {
+        totalTimes[functionIndex] += _nodes[node].totalTime;
+    }
+    activeCounts[functionIndex]++;
+    for (NSUInteger child = _nodes[node].firstChild; NSNotFound != child; child = _nodes[child].nextSibling) {
+        [self accumulateNode:child callCounts:callCounts totalTimes:totalTimes selfTimes:selfTimes activeCounts:activeCounts];
+    }
+    activeCounts[functionIndex]--;
+}
+
+
+- (NSArray<XDTPythonProfileFunction *> *)functions
+{
+    XDTAcquireGIL();
+    const NSUInteger functionCount = [_functionNames count];
+    NSUInteger *callCounts = calloc(MAX(functionCount, 1), sizeof(NSUInteger));
+    NSUInteger *activeCounts = calloc(MAX(functionCount, 1), sizeof(NSUInteger));
+    uint64_t *totalTimes = calloc(MAX(functionCount, 1), sizeof(uint64_t));
+    uint64_t *selfTimes = calloc(MAX(functionCount, 1), sizeof(uint64_t));
+    NSMutableArray<XDTPythonProfileFunction *> *retVal = [NSMutableArray arrayWithCapacity:functionCount];
+    if (NULL != callCounts && NULL != activeCounts && NULL != totalTimes && NULL != selfTimes) {
+        for (NSUInteger child = _nodes[XDTPythonProfilerRootNode].firstChild; NSNotFound != child; child = _nodes[child].nextSibling) {
+            [self accumulateNode:child callCounts:callCounts totalTimes:totalTimes selfTimes:selfTimes activeCounts:activeCounts];
+        }
+
+        NSSet<NSNumber *> *phaseIndexes = [NSSet setWithArray:[_phaseIndexes allValues]];
+        for (NSUInteger functionIndex = 0; functionIndex < functionCount; functionIndex++) {
+            if (0 == callCounts[functionIndex] || [phaseIndexes containsObject:[NSNumber numberWithUnsignedInteger:functionIndex]]) {
+                continue;
+            }
+            XDTPythonProfileFunction *function = [[XDTPythonProfileFunction alloc] init];
+#if !__has_feature(objc_arc)
+            [function autorelease];
+#endif
+            function.name = [_functionNames objectAtIndex:functionIndex];
+            id fileName = [_fileNames objectAtIndex:functionIndex];
+            function.fileName = ([NSNull null] == fileName)? nil : fileName;
+            function.lineNumber = [[_lineNumbers objectAtIndex:functionIndex] unsignedIntegerValue];
+            function.callCount = callCounts[functionIndex];
+            function.totalTime = [self nanosecondsOfTime:totalTimes[functionIndex]];
+            function.selfTime = [self nanosecondsOfTime:selfTimes[functionIndex]];
+            [retVal addObject:function];
+        }
+    }
+    free(callCounts);
+    free(activeCounts);
+    free(totalTimes);
+    free(selfTimes);
+
+    [retVal sortUsingComparator:^NSComparisonResult(XDTPythonProfileFunction *function1, XDTPythonProfileFunction *function2) {
+        if (function1.selfTime == function2.selfTime) {
+            return NSOrderedSame;
+        }
+        return (function1.selfTime > function2.selfTime)? NSOrderedAscending : NSOrderedDescending;
+    }];
+    return retVal;
+}
+
+
+#pragma mark - Folded Stacks Export
+
+
+- (NSString *)frameNameOfNode:(NSUInteger)node
+{
+    const NSUInteger functionIndex = _nodes[node].functionIndex;
+    NSString *name = [_functionNames objectAtIndex:functionIndex];
+    id fileName = [_fileNames objectAtIndex:functionIndex];
+    if ([NSNull null] == fileName) {
+        return [name stringByReplacingOccurrencesOfString:@";" withString:@","];
+    }
+    return [NSString stringWithFormat:@"%@ (%@:%@)", name, fileName, [_lineNumbers objectAtIndex:functionIndex]];
+}
+
+
+- (void)appendFoldedStacksOfNode:(NSUInteger)node path:(NSString *)path toString:(NSMutableString *)foldedStacks
+{
+    NSString *nodePath = (nil == path)? [self frameNameOfNode:node] : [NSString stringWithFormat:@"%@;%@", path, [self frameNameOfNode:node]];
+    const uint64_t selfMicroseconds = [self nanosecondsOfTime:[self selfTimeOfNode:node]] / 1000;
+    if (0 < selfMicroseconds) {
+        [foldedStacks appendFormat:@"%@ %llu\n", nodePath, selfMicroseconds];
+    }
+    for (NSUInteger child = _nodes[node].firstChild; NSNotFound != child; child = _nodes[child].nextSibling) {
+        [self appendFoldedStacksOfNode:child path:nodePath toString:foldedStacks];
+    }
+}
+
+
+- (NSData *)foldedStacksData
+{
+    XDTAcquireGIL();
+    NSMutableString *foldedStacks = [NSMutableString string];
+    for (NSUInteger child = _nodes[XDTPythonProfilerRootNode].firstChild; NSNotFound != child; child = _nodes[child].nextSibling) {
+        [self appendFoldedStacksOfNode:child path:nil toString:foldedStacks];
+    }
+    return [foldedStacks dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+
+- (BOOL)writeFoldedStacksToURL:(NSURL *)url error:(NSError **)error
+{
+    return [[self foldedStacksData] writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
+@end
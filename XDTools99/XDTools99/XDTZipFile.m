@@ -27,6 +27,7 @@
 #import <Python/Python.h>
 
 #import "NSErrorPythonAdditions.h"
+#import "XDTPythonGIL.h"
 
 
 #define XDTModuleNameZipFile "zipfile"
@@ -47,6 +48,7 @@
 
 + (instancetype)zipFileForWritingToURL:(NSURL *)url error:(NSError * _Nullable __autoreleasing *)error
 {
+    XDTAcquireGIL();
     PyObject *pName = PyString_FromString(XDTModuleNameZipFile);
     PyObject *pModule = PyImport_Import(pName);
     Py_XDECREF(pName);
@@ -69,6 +71,7 @@
 
 - (instancetype)initForWritingToURL:(NSURL *)url forModule:(PyObject *)pModule error:(NSError *__autoreleasing  _Nullable *)error
 {
+    XDTAcquireGIL();
     self = [super init];
     if (nil == self) {
         return nil;
@@ -128,6 +131,7 @@
 
 - (void)dealloc
 {
+    XDTAcquireGIL();
     Py_CLEAR(zipfilePythonClass);
     Py_CLEAR(zipfilePythonModule);
 
@@ -139,6 +143,7 @@
 
 - (BOOL)writeFile:(NSString *)fileName withData:(NSData *)data error:(NSError **)error
 {
+    XDTAcquireGIL();
     /*
      Function call in Python:
      writestr("layout.xml", layout)
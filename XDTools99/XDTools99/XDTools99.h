@@ -35,3 +35,11 @@ FOUNDATION_EXPORT const unsigned char xdt99wrapperVersionString[];
 #import "XDAssembler.h"
 #import "XDBasic.h"
 #import "XDGPL.h"
+#import "XDTDiskImage.h"
+#import "XDTCrossReference.h"
+#import "XDTAddressMap.h"
+#import "XDTDebugInfo.h"
+#import "XDTMemoryBudget.h"
+#import "XDTBuildMessage.h"
+#import "XDTBuildClient.h"
+#import "XDTPythonGIL.h"
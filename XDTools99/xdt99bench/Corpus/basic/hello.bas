@@ -0,0 +1,19 @@
+100 REM BENCHMARK CORPUS
+110 CALL CLEAR
+120 DIM A(20)
+130 FOR I=1 TO 20
+140 A(I)=INT(RND*100)
+150 NEXT I
+160 FOR I=1 TO 19
+170 FOR J=I+1 TO 20
+180 IF A(I)<=A(J) THEN 220
+190 T=A(I)
+200 A(I)=A(J)
+210 A(J)=T
+220 NEXT J
+230 NEXT I
+240 FOR I=1 TO 20
+250 PRINT A(I);
+260 NEXT I
+270 PRINT "DONE"
+280 END
@@ -0,0 +1,78 @@
+//
+//  XDTBenchmark.h
+//  xdt99bench
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+#import <XDTools99/XDTools99.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Runs the phases of the XDTools99 framework over a corpus of sources and binaries and measures them.
+
+ The corpus directory contains the sub directories asm (*.a99), gpl (*.gpl), basic (*.bas) and bin (*.img). Only the
+ files at the top level of these directories are benchmarked, so sub directories can hold files for COPY directives.
+
+ Every file is processed once as warm-up with the Python profiler hook installed, this run counts the Python calls of
+ each phase. The following iterations are timed without the hook. The result is a dictionary which is ready for
+ NSJSONSerialization.
+
+ When an instrumentation object is set, it records the phases of the framework classes during the warm-up run.
+
+ The phase assemble.native assembles each assembler source natively with a new assembler, assemble.session with one
+ assembler for all sources and runs, which parses copied files only once as long as they are unchanged. The sources
+ at the top level of asm share the large files in asm/include, so the difference of both is the saving of the cache.
+
+ For each path in coldStartModulePaths the tool is started once per iteration in a new process, which assembles the
+ first assembler source of the corpus with the modules at that path. A path is either a directory with the sources
+ of the xdt99 modules or a module bundle (xdt99.zip) as it is built for the framework.
+
+ The phase interpret runs the image of each GPL source in XDTGPLInterpreter from the program of its GROM header for
+ a fixed number of cycles. The number of executed instructions of each label is the same in every run, so the report
+ lists it once for each file under gplProfiles.
+
+ With verifiesNativeAssembly set, every assembler source is also assembled natively and by xas99 and their program
+ images, raw binaries and symbols are compared, GPL sources likewise with xga99 by their byte code and image. A
+ generated source of more than 9999 lines checks that its address map covers the lines with five digit numbers. Each
+ difference is reported as a failure.
+ */
+@interface XDTBenchmark : NSObject
+
+@property (readonly) NSURL *corpusURL;
+@property (readonly) NSUInteger iterations;
+@property (nullable, retain) XDTInstrumentation *instrumentation;
+@property (nullable, copy) NSArray<NSString *> *coldStartModulePaths;
+@property BOOL verifiesNativeAssembly;
+
++ (instancetype)benchmarkWithCorpusURL:(NSURL *)corpusURL iterations:(NSUInteger)iterations;
+
+/* Runs in the new process of a cold start, Python must not be initialized before. */
++ (nullable NSDictionary<NSString *, NSNumber *> *)coldStartWithCorpusURL:(NSURL *)corpusURL error:(NSError **)error;
+
+- (nullable NSDictionary<NSString *, id> *)run:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
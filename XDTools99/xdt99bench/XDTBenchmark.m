@@ -0,0 +1,1022 @@
+//
+//  XDTBenchmark.m
+//  xdt99bench
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import "XDTBenchmark.h"
+
+#import <Python/Python.h>
+#import <XDTools99/XDTools99.h>
+
+#include <mach/mach_time.h>
+#include <malloc/malloc.h>
+#include <sys/resource.h>
+#include <sys/sysctl.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+
+/* Cycles the GPL interpreter runs each program, programs which wait for a key never exit */
+static const unsigned long long XDTBenchGPLCycleLimit = 1000000;
+
+
+typedef BOOL (^XDTBenchPhaseBlock)(NSMutableDictionary<NSString *, id> *context, NSError **error);
+typedef void (^XDTBenchTeardownBlock)(NSMutableDictionary<NSString *, id> *context);
+
+/* Measured values of a single run of a phase */
+typedef struct {
+    double wallTime;        /* milliseconds */
+    double cpuTime;         /* milliseconds, user and system time */
+    int64_t allocatedBlocks;
+    int64_t allocatedBytes;
+} XDTBenchSample;
+
+
+/* A phase is a pair of its name and the block that runs it */
+static NSArray *XDTBenchPhase(NSString *name, XDTBenchPhaseBlock block)
+{
+    return @[name, [block copy]];
+}
+
+
+/* The setup runs before and the teardown after the measured block, also if the setup or the block fails */
+static NSArray *XDTBenchPhaseWithSetup(NSString *name, XDTBenchPhaseBlock setup, XDTBenchPhaseBlock block, XDTBenchTeardownBlock teardown)
+{
+    return @[name, [block copy], [setup copy], [teardown copy]];
+}
+
+
+static unsigned long long XDTBenchPythonCalls = 0;
+static unsigned long long XDTBenchPythonBuiltinCalls = 0;
+
+
+/* Profiler hook of the Python interpreter, only installed during the warm-up run */
+static int XDTBenchProfile(PyObject *obj, PyFrameObject *frame, int what, PyObject *arg)
+{
+    if (PyTrace_CALL == what) {
+        XDTBenchPythonCalls++;
+    } else if (PyTrace_C_CALL == what) {
+        XDTBenchPythonBuiltinCalls++;
+    }
+    return 0;
+}
+
+
+static double XDTBenchCurrentWallTime(void)
+{
+    static mach_timebase_info_data_t timebase;
+    if (0 == timebase.denom) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / 1.0e6;
+}
+
+
+/* Milliseconds since the start of this process, taken from the kernel as wall clock time. */
+static double XDTBenchTimeSinceLaunch(void)
+{
+    int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_PID, getpid()};
+    struct kinfo_proc info;
+    size_t size = sizeof(info);
+    if (0 != sysctl(mib, 4, &info, &size, NULL, 0)) {
+        return 0.0;
+    }
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - info.kp_proc.p_starttime.tv_sec) * 1.0e3 + (now.tv_usec - info.kp_proc.p_starttime.tv_usec) / 1.0e3;
+}
+
+
+static double XDTBenchCurrentCPUTime(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1.0e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1.0e3;
+}
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface XDTBenchmark ()
+
+@property NSMutableDictionary<NSString *, NSMutableData *> *samples;        /* key is "file phase", value is an array of XDTBenchSample */
+@property NSMutableDictionary<NSString *, NSArray<NSNumber *> *> *pythonCalls;
+@property NSMutableArray<NSArray<NSString *> *> *phaseOrder;                /* pairs of file and phase in order of the first run */
+@property NSMutableArray<NSDictionary<NSString *, NSString *> *> *failures;
+@property (nullable) XDTInstrumentation *activeInstrumentation;            /* the instrumentation while the warm-up runs, else nil */
+@property (nullable) NSArray<NSDictionary<NSString *, id> *> *coldStarts;
+@property (nullable) NSArray<NSDictionary<NSString *, id> *> *verification;
+@property (nullable) XDTAssembler *sessionAssembler;                        /* shared by all assembler sources, see assemble.session */
+@property NSMutableDictionary<NSString *, NSDictionary<NSString *, id> *> *gplProfiles;    /* key is the file, see interpret */
+
++ (nullable NSURL *)firstAssemblerSourceInCorpus:(NSURL *)corpusURL;
+- (nullable NSArray<NSDictionary<NSString *, id> *> *)measureColdStarts:(NSError **)error;
+- (NSArray<NSDictionary<NSString *, id> *> *)verifyNativeAssemblyOfCorpus:(NSArray<NSArray *> *)corpus;
+- (NSDictionary<NSString *, id> *)verifyNativeAssemblyOfGPLSource:(NSArray *)item;
+- (BOOL)verifyAddressMapOfLargeSource:(NSError **)error;
+
+- (instancetype)initWithCorpusURL:(NSURL *)corpusURL iterations:(NSUInteger)iterations;
+
+- (NSDictionary *)options:(NSDictionary *)options withInstrumentationForKey:(NSString *)key;
+- (nullable XDTAssembler *)sessionAssemblerForSourceFile:(NSURL *)fileURL;
+- (NSArray<NSArray *> *)phasesForFile:(NSURL *)fileURL ofKind:(NSString *)kind;
+- (NSArray<NSArray *> *)phasesForAssemblerSource:(NSURL *)fileURL;
+- (NSArray<NSArray *> *)phasesForGPLSource:(NSURL *)fileURL;
+- (NSArray<NSArray *> *)phasesForBasicSource:(NSURL *)fileURL;
+- (NSArray<NSArray *> *)phasesForProgramImage:(NSURL *)fileURL;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+@implementation XDTBenchmark
+
++ (instancetype)benchmarkWithCorpusURL:(NSURL *)corpusURL iterations:(NSUInteger)iterations
+{
+    XDTBenchmark *retVal = [[XDTBenchmark alloc] initWithCorpusURL:corpusURL iterations:iterations];
+#if !__has_feature(objc_arc)
+    return [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithCorpusURL:(NSURL *)corpusURL iterations:(NSUInteger)iterations
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _corpusURL = corpusURL;
+    _iterations = MAX(iterations, 1);
+    _samples = [NSMutableDictionary dictionary];
+    _pythonCalls = [NSMutableDictionary dictionary];
+    _phaseOrder = [NSMutableArray array];
+    _failures = [NSMutableArray array];
+    _gplProfiles = [NSMutableDictionary dictionary];
+
+    return self;
+}
+
+
+#pragma mark - Running
+
+
+- (NSDictionary<NSString *, id> *)run:(NSError **)error
+{
+    NSDictionary<NSString *, NSString *> *kinds = @{
+                                                    @"asm": @"a99",
+                                                    @"gpl": @"gpl",
+                                                    @"basic": @"bas",
+                                                    @"bin": @"img"
+                                                    };
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableArray<NSArray *> *corpus = [NSMutableArray array];
+    for (NSString *kind in @[@"asm", @"gpl", @"basic", @"bin"]) {
+        NSURL *directoryURL = [_corpusURL URLByAppendingPathComponent:kind isDirectory:YES];
+        NSArray<NSURL *> *fileURLs = [fileManager contentsOfDirectoryAtURL:directoryURL includingPropertiesForKeys:nil options:NSDirectoryEnumerationSkipsHiddenFiles error:nil];
+        fileURLs = [fileURLs sortedArrayUsingComparator:^NSComparisonResult(NSURL *url1, NSURL *url2) {
+            return [[url1 lastPathComponent] compare:[url2 lastPathComponent]];
+        }];
+        for (NSURL *fileURL in fileURLs) {
+            if (![[kinds objectForKey:kind] isEqualToString:[fileURL pathExtension]]) {
+                continue;
+            }
+            NSString *name = [NSString stringWithFormat:@"%@/%@", kind, [fileURL lastPathComponent]];
+            [corpus addObject:@[name, fileURL, kind]];
+        }
+    }
+    if (0 == [corpus count]) {
+        if (nil != error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadNoSuchFileError
+                                     userInfo:@{
+                                                NSLocalizedDescriptionKey: [NSString stringWithFormat:@"The corpus at '%@' contains no files to benchmark.", [_corpusURL path]],
+                                                NSURLErrorKey: _corpusURL
+                                                }];
+        }
+        return nil;
+    }
+
+    /* The first run is a warm-up which also counts the Python calls, it is not part of the timing. */
+    [XDTObject class];
+    for (NSUInteger iteration = 0; iteration <= _iterations; iteration++) {
+        BOOL isWarmUp = 0 == iteration;
+        self.activeInstrumentation = isWarmUp? _instrumentation : nil;
+        for (NSArray *item in corpus) {
+            @autoreleasepool {
+                NSArray<NSArray *> *phases = [self phasesForFile:item[1] ofKind:item[2]];
+                [self runPhases:phases forFile:item[0] countingPythonCalls:isWarmUp];
+            }
+        }
+    }
+
+    self.activeInstrumentation = nil;
+
+    if (_verifiesNativeAssembly) {
+        self.verification = [self verifyNativeAssemblyOfCorpus:corpus];
+        NSError *addressMapError = nil;
+        if (![self verifyAddressMapOfLargeSource:&addressMapError]) {
+            [_failures addObject:@{@"file": @"table.a99", @"phase": @"verify.addressmap", @"message": (nil != addressMapError)? [addressMapError localizedDescription] : @""}];
+        }
+    }
+
+    if (0 < [_coldStartModulePaths count]) {
+        self.coldStarts = [self measureColdStarts:error];
+        if (nil == _coldStarts) {
+            return nil;
+        }
+    }
+
+    return [self report];
+}
+
+
+- (void)runPhases:(NSArray<NSArray *> *)phases forFile:(NSString *)fileName countingPythonCalls:(BOOL)shouldCount
+{
+    NSMutableDictionary<NSString *, id> *context = [NSMutableDictionary dictionary];
+    for (NSArray *phase in phases) {
+        NSString *phaseName = phase[0];
+        XDTBenchPhaseBlock block = phase[1];
+        XDTBenchPhaseBlock setup = (2 < [phase count])? phase[2] : nil;
+        XDTBenchTeardownBlock teardown = (3 < [phase count])? phase[3] : nil;
+        NSString *key = [NSString stringWithFormat:@"%@ %@", fileName, phaseName];
+
+        NSError *error = nil;
+        BOOL success = nil == setup || setup(context, &error);
+        if (!success) {
+            /* nothing to measure without the setup */
+        } else if (shouldCount) {
+            XDTBenchPythonCalls = XDTBenchPythonBuiltinCalls = 0;
+            /* the profile function stays installed at the thread state of this thread while the GIL is released */
+            {
+                XDTAcquireGIL();
+                PyEval_SetProfile(XDTBenchProfile, NULL);
+            }
+            success = block(context, &error);
+            {
+                XDTAcquireGIL();
+                PyEval_SetProfile(NULL, NULL);
+            }
+            [_pythonCalls setObject:@[@(XDTBenchPythonCalls), @(XDTBenchPythonBuiltinCalls)] forKey:key];
+            [_phaseOrder addObject:@[fileName, phaseName]];
+        } else {
+            XDTBenchSample sample;
+            malloc_statistics_t mallocBefore, mallocAfter;
+            @autoreleasepool {
+                /* The allocation statistics are taken before the pool drains, so they also count autoreleased objects. */
+                malloc_zone_statistics(NULL, &mallocBefore);
+                double cpuTime = XDTBenchCurrentCPUTime();
+                double wallTime = XDTBenchCurrentWallTime();
+                success = block(context, &error);
+                sample.wallTime = XDTBenchCurrentWallTime() - wallTime;
+                sample.cpuTime = XDTBenchCurrentCPUTime() - cpuTime;
+                malloc_zone_statistics(NULL, &mallocAfter);
+#if !__has_feature(objc_arc)
+                [error retain];
+#endif
+            }
+#if !__has_feature(objc_arc)
+            [error autorelease];
+#endif
+            sample.allocatedBlocks = (int64_t)mallocAfter.blocks_in_use - (int64_t)mallocBefore.blocks_in_use;
+            sample.allocatedBytes = (int64_t)mallocAfter.size_in_use - (int64_t)mallocBefore.size_in_use;
+
+            NSMutableData *samples = [_samples objectForKey:key];
+            if (nil == samples) {
+                samples = [NSMutableData dataWithCapacity:_iterations * sizeof(XDTBenchSample)];
+                [_samples setObject:samples forKey:key];
+            }
+            [samples appendBytes:&sample length:sizeof(sample)];
+        }
+        if (nil != teardown) {
+            teardown(context);
+        }
+
+        if (!success) {
+            /* Subsequent phases depend on the result of this one, so they are skipped. */
+            if (shouldCount) {
+                NSString *message = (nil != error)? [error localizedDescription] : @"unknown error";
+                [_failures addObject:@{@"file": fileName, @"phase": phaseName, @"message": message}];
+            }
+            break;
+        }
+    }
+}
+
+
+#pragma mark - Reporting
+
+
+static int XDTBenchCompareDoubles(const void *value1, const void *value2)
+{
+    double d1 = *(const double *)value1, d2 = *(const double *)value2;
+    return (d1 < d2)? -1 : (d1 > d2)? 1 : 0;
+}
+
+
+static NSDictionary<NSString *, NSNumber *> *XDTBenchStatistics(double *values, NSUInteger count)
+{
+    qsort(values, count, sizeof(double), XDTBenchCompareDoubles);
+    double sum = 0.0;
+    for (NSUInteger i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    double median = (0 == count % 2)? (values[count / 2 - 1] + values[count / 2]) / 2.0 : values[count / 2];
+    return @{
+             @"min": @(values[0]),
+             @"median": @(median),
+             @"mean": @(sum / count),
+             @"max": @(values[count - 1])
+             };
+}
+
+
+- (NSDictionary<NSString *, id> *)report
+{
+    NSMutableArray<NSDictionary<NSString *, id> *> *results = [NSMutableArray arrayWithCapacity:[_phaseOrder count]];
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *totals = [NSMutableDictionary dictionary];
+    for (NSArray<NSString *> *filePhase in _phaseOrder) {
+        NSString *key = [filePhase componentsJoinedByString:@" "];
+        NSData *sampleData = [_samples objectForKey:key];
+        NSArray<NSNumber *> *calls = [_pythonCalls objectForKey:key];
+        NSUInteger count = [sampleData length] / sizeof(XDTBenchSample);
+        if (0 == count) {
+            continue;
+        }
+
+        const XDTBenchSample *samples = [sampleData bytes];
+        double *wallTimes = malloc(count * sizeof(double));
+        double *cpuTimes = malloc(count * sizeof(double));
+        double allocatedBlocks = 0.0, allocatedBytes = 0.0;
+        for (NSUInteger i = 0; i < count; i++) {
+            wallTimes[i] = samples[i].wallTime;
+            cpuTimes[i] = samples[i].cpuTime;
+            allocatedBlocks += samples[i].allocatedBlocks;
+            allocatedBytes += samples[i].allocatedBytes;
+        }
+        NSDictionary<NSString *, NSNumber *> *wallTime = XDTBenchStatistics(wallTimes, count);
+        NSDictionary<NSString *, NSNumber *> *cpuTime = XDTBenchStatistics(cpuTimes, count);
+        free(wallTimes);
+        free(cpuTimes);
+
+        [results addObject:@{
+                             @"file": filePhase[0],
+                             @"phase": filePhase[1],
+                             @"iterations": @(count),
+                             @"wallTime": wallTime,
+                             @"cpuTime": cpuTime,
+                             @"allocatedBlocks": @(allocatedBlocks / count),
+                             @"allocatedBytes": @(allocatedBytes / count),
+                             @"pythonCalls": calls[0],
+                             @"pythonBuiltinCalls": calls[1]
+                             }];
+
+        NSMutableDictionary<NSString *, NSNumber *> *total = [totals objectForKey:filePhase[1]];
+        if (nil == total) {
+            total = [NSMutableDictionary dictionaryWithDictionary:@{@"wallTime": @0.0, @"cpuTime": @0.0, @"pythonCalls": @0}];
+            [totals setObject:total forKey:filePhase[1]];
+        }
+        [total setObject:@([total[@"wallTime"] doubleValue] + [wallTime[@"mean"] doubleValue]) forKey:@"wallTime"];
+        [total setObject:@([total[@"cpuTime"] doubleValue] + [cpuTime[@"mean"] doubleValue]) forKey:@"cpuTime"];
+        [total setObject:@([total[@"pythonCalls"] unsignedLongLongValue] + [calls[0] unsignedLongLongValue]) forKey:@"pythonCalls"];
+    }
+
+    NSMutableArray<NSDictionary<NSString *, id> *> *gplProfiles = [NSMutableArray arrayWithCapacity:[_gplProfiles count]];
+    for (NSString *fileName in [[_gplProfiles allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        [gplProfiles addObject:[_gplProfiles objectForKey:fileName]];
+    }
+
+    NSDateFormatter *dateFormatter = [NSDateFormatter new];
+    [dateFormatter setLocale:[NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"]];
+    [dateFormatter setDateFormat:@"yyyy-MM-dd'T'HH:mm:ssZZZZZ"];
+    NSString *frameworkVersion = [[NSBundle bundleForClass:[XDTObject class]] objectForInfoDictionaryKey:@"CFBundleShortVersionString"];
+
+    return @{
+             @"date": [dateFormatter stringFromDate:[NSDate date]],
+             @"corpus": [_corpusURL path],
+             @"iterations": @(_iterations),
+             @"units": @{@"time": @"ms", @"allocations": @"net blocks and bytes in use at the end of a phase"},
+             @"versions": @{
+                     @"framework": (nil != frameworkVersion)? frameworkVersion : @"",
+                     @"python": [NSString stringWithUTF8String:Py_GetVersion()]
+                     },
+             @"results": results,
+             @"totals": totals,
+             @"coldStart": (nil != _coldStarts)? _coldStarts : @[],
+             @"verification": (nil != _verification)? _verification : @[],
+             @"gplProfiles": gplProfiles,
+             @"failures": _failures
+             };
+}
+
+
+#pragma mark - Cold Start
+
+
++ (NSURL *)firstAssemblerSourceInCorpus:(NSURL *)corpusURL
+{
+    NSURL *directoryURL = [corpusURL URLByAppendingPathComponent:@"asm" isDirectory:YES];
+    NSArray<NSURL *> *fileURLs = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:directoryURL includingPropertiesForKeys:nil options:NSDirectoryEnumerationSkipsHiddenFiles error:nil];
+    fileURLs = [fileURLs sortedArrayUsingComparator:^NSComparisonResult(NSURL *url1, NSURL *url2) {
+        return [[url1 lastPathComponent] compare:[url2 lastPathComponent]];
+    }];
+    for (NSURL *fileURL in fileURLs) {
+        if ([@"a99" isEqualToString:[fileURL pathExtension]]) {
+            return fileURL;
+        }
+    }
+    return nil;
+}
+
+
+/*
+ Measures the time from the start of the process until the first object code is assembled:
+    launch: loading of the tool and its frameworks until this method is called
+    initialize: starting Python by the initializer of XDTObject, with the modules given by XDTOOLS99_MODULE_PATH
+    firstObject: importing xas99, creating the assembler and assembling the first source of the corpus
+ */
++ (NSDictionary<NSString *, NSNumber *> *)coldStartWithCorpusURL:(NSURL *)corpusURL error:(NSError **)error
+{
+    const double launchTime = XDTBenchTimeSinceLaunch();
+    NSURL *sourceURL = [self firstAssemblerSourceInCorpus:corpusURL];
+    if (nil == sourceURL) {
+        if (nil != error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadNoSuchFileError
+                                     userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"The corpus at '%@' contains no assembler source.", [corpusURL path]]}];
+        }
+        return nil;
+    }
+
+    double wallTime = XDTBenchCurrentWallTime();
+    [XDTAssembler class];
+    const double initializeTime = XDTBenchCurrentWallTime() - wallTime;
+
+    wallTime = XDTBenchCurrentWallTime();
+    NSDictionary *options = @{
+                              XDTAs99OptionRegister: @YES,
+                              XDTAs99OptionStrict: @NO,
+                              XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTAs99TargetTypeProgramImage],
+                              XDTAs99OptionWarnings: @YES
+                              };
+    XDTAssembler *assembler = [XDTAssembler assemblerWithOptions:options includeURL:sourceURL];
+    XDTAs99Objcode *objcode = [assembler assembleSourceFile:sourceURL error:error];
+    const double firstObjectTime = XDTBenchCurrentWallTime() - wallTime;
+    if (nil == objcode) {
+        return nil;
+    }
+
+    return @{
+             @"launch": @(launchTime),
+             @"initialize": @(initializeTime),
+             @"firstObject": @(firstObjectTime),
+             @"total": @(launchTime + initializeTime + firstObjectTime)
+             };
+}
+
+
+- (NSArray<NSDictionary<NSString *, id> *> *)measureColdStarts:(NSError **)error
+{
+    NSString *executablePath = [[NSBundle mainBundle] executablePath];
+    NSArray<NSString *> *keys = @[@"launch", @"initialize", @"firstObject", @"total"];
+    NSMutableArray<NSDictionary<NSString *, id> *> *retVal = [NSMutableArray arrayWithCapacity:[_coldStartModulePaths count]];
+    for (NSString *modulePath in _coldStartModulePaths) {
+        NSMutableDictionary<NSString *, id> *environment = [NSMutableDictionary dictionaryWithDictionary:[[NSProcessInfo processInfo] environment]];
+        [environment setObject:modulePath forKey:@"XDTOOLS99_MODULE_PATH"];
+
+        double *values = malloc(_iterations * [keys count] * sizeof(double));
+        for (NSUInteger iteration = 0; iteration < _iterations; iteration++) {
+            NSPipe *pipe = [NSPipe pipe];
+            NSTask *task = [NSTask new];
+            [task setLaunchPath:executablePath];
+            [task setArguments:@[@"-S", @"-c", [_corpusURL path]]];
+            [task setEnvironment:environment];
+            [task setStandardOutput:pipe];
+            [task launch];
+            NSData *output = [[pipe fileHandleForReading] readDataToEndOfFile];
+            [task waitUntilExit];
+
+            NSDictionary<NSString *, NSNumber *> *coldStart = nil;
+            if (0 == [task terminationStatus]) {
+                coldStart = [NSJSONSerialization JSONObjectWithData:output options:0 error:nil];
+            }
+            if (![coldStart isKindOfClass:[NSDictionary class]]) {
+                free(values);
+                if (nil != error) {
+                    *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSExecutableLoadError
+                                             userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"The cold start with the modules at '%@' failed.", modulePath]}];
+                }
+                return nil;
+            }
+            [keys enumerateObjectsUsingBlock:^(NSString *key, NSUInteger idx, BOOL *stop) {
+                values[idx * _iterations + iteration] = [[coldStart objectForKey:key] doubleValue];
+            }];
+        }
+
+        NSMutableDictionary<NSString *, id> *result = [NSMutableDictionary dictionaryWithObject:modulePath forKey:@"modules"];
+        [keys enumerateObjectsUsingBlock:^(NSString *key, NSUInteger idx, BOOL *stop) {
+            [result setObject:XDTBenchStatistics(values + idx * _iterations, _iterations) forKey:key];
+        }];
+        free(values);
+        [retVal addObject:result];
+    }
+
+    return retVal;
+}
+
+
+#pragma mark - Native Assembly
+
+
+/*
+ Assembles every assembler source of the corpus with and without the native assembly option. Sources which the
+ native assembler hands over to xas99 are listed with the reason, all others must result in the same program image
+ at >A000, the same raw binaries and symbols and no messages of xas99. GPL sources are compared the same way.
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)verifyNativeAssemblyOfCorpus:(NSArray<NSArray *> *)corpus
+{
+    NSMutableArray<NSDictionary<NSString *, id> *> *retVal = [NSMutableArray array];
+    for (NSArray *item in corpus) {
+        if ([@"gpl" isEqualToString:item[2]]) {
+            @autoreleasepool {
+                [retVal addObject:[self verifyNativeAssemblyOfGPLSource:item]];
+            }
+            continue;
+        }
+        if (![@"asm" isEqualToString:item[2]]) {
+            continue;
+        }
+        @autoreleasepool {
+            NSURL *fileURL = item[1];
+            NSMutableDictionary *options = [NSMutableDictionary dictionaryWithDictionary:@{
+                                                                                           XDTAs99OptionRegister: @YES,
+                                                                                           XDTAs99OptionStrict: @NO,
+                                                                                           XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTAs99TargetTypeProgramImage],
+                                                                                           XDTAs99OptionWarnings: @YES
+                                                                                           }];
+            XDTAssembler *pythonAssembler = [XDTAssembler assemblerWithOptions:options includeURL:fileURL];
+            [options setObject:@YES forKey:XDTAs99OptionNativeAssembly];
+            XDTAssembler *nativeAssembler = [XDTAssembler assemblerWithOptions:options includeURL:fileURL];
+            XDTAs99Objcode *pythonObjcode = [pythonAssembler assembleSourceFile:fileURL error:nil];
+            XDTAs99Objcode *nativeObjcode = [nativeAssembler assembleSourceFile:fileURL error:nil];
+
+            NSMutableDictionary<NSString *, id> *result = [NSMutableDictionary dictionaryWithDictionary:@{@"file": item[0], @"native": @([nativeObjcode isNative])}];
+            if (![nativeObjcode isNative]) {
+                NSString *reason = nativeAssembler.nativeFallbackReason;
+                [result setObject:(nil != reason)? reason : @"" forKey:@"reason"];
+                [retVal addObject:result];
+                continue;
+            }
+
+            NSMutableArray<NSString *> *mismatches = [NSMutableArray array];
+            if (nil == pythonObjcode) {
+                [mismatches addObject:@"assemble"];
+            } else {
+                if (![[pythonObjcode generateImageAt:0xa000 error:nil] isEqual:[nativeObjcode generateImageAt:0xa000 error:nil]]) {
+                    [mismatches addObject:@"image"];
+                }
+                if (![[pythonObjcode generateRawBinaryAt:0xa000 error:nil] isEqual:[nativeObjcode generateRawBinaryAt:0xa000 error:nil]]) {
+                    [mismatches addObject:@"binaries"];
+                }
+                if (![[[pythonObjcode symbols] symbols] isEqual:[[nativeObjcode symbols] symbols]] ||
+                    ![[[pythonObjcode symbols] refdefs] isEqual:[[nativeObjcode symbols] refdefs]]) {
+                    [mismatches addObject:@"symbols"];
+                }
+                if (0 < [[pythonAssembler messages] count]) {
+                    [mismatches addObject:@"messages"];
+                }
+            }
+            [result setObject:mismatches forKey:@"mismatches"];
+            if (0 < [mismatches count]) {
+                [_failures addObject:@{@"file": item[0], @"phase": @"verify.native", @"message": [mismatches componentsJoinedByString:@", "]}];
+            }
+            [retVal addObject:result];
+        }
+    }
+    return retVal;
+}
+
+
+/* GPL sources must result in the same byte code, the same image and no messages of xga99 */
+- (NSDictionary<NSString *, id> *)verifyNativeAssemblyOfGPLSource:(NSArray *)item
+{
+    NSURL *fileURL = item[1];
+    NSMutableDictionary *options = [NSMutableDictionary dictionaryWithDictionary:@{
+                                                                                   XDTGa99OptionAORG: @0x0030,
+                                                                                   XDTGa99OptionGROM: @0x6000,
+                                                                                   XDTGa99OptionStyle: [NSNumber numberWithUnsignedInteger:XDTGa99SyntaxTypeNativeXDT99],
+                                                                                   XDTGa99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTGa99TargetTypeHeaderedByteCode],
+                                                                                   XDTGa99OptionWarnings: @YES
+                                                                                   }];
+    XDTGPLAssembler *pythonAssembler = [XDTGPLAssembler gplAssemblerWithOptions:options includeURL:fileURL];
+    [options setObject:@YES forKey:XDTGa99OptionNativeAssembly];
+    XDTGPLAssembler *nativeAssembler = [XDTGPLAssembler gplAssemblerWithOptions:options includeURL:fileURL];
+    XDTGa99Objcode *pythonObjcode = [pythonAssembler assembleSourceFile:fileURL error:nil];
+    XDTGa99Objcode *nativeObjcode = [nativeAssembler assembleSourceFile:fileURL error:nil];
+
+    NSMutableDictionary<NSString *, id> *retVal = [NSMutableDictionary dictionaryWithDictionary:@{@"file": item[0], @"native": @([nativeObjcode isNative])}];
+    if (![nativeObjcode isNative]) {
+        NSString *reason = nativeAssembler.nativeFallbackReason;
+        [retVal setObject:(nil != reason)? reason : @"" forKey:@"reason"];
+        return retVal;
+    }
+
+    NSMutableArray<NSString *> *mismatches = [NSMutableArray array];
+    if (nil == pythonObjcode) {
+        [mismatches addObject:@"assemble"];
+    } else {
+        if (![[pythonObjcode generateByteCode:nil] isEqual:[nativeObjcode generateByteCode:nil]]) {
+            [mismatches addObject:@"bytecode"];
+        }
+        if (![[pythonObjcode generateImageWithName:@"BENCHMARK" error:nil] isEqual:[nativeObjcode generateImageWithName:@"BENCHMARK" error:nil]]) {
+            [mismatches addObject:@"image"];
+        }
+        if (0 < [[pythonAssembler messages] count]) {
+            [mismatches addObject:@"messages"];
+        }
+    }
+    [retVal setObject:mismatches forKey:@"mismatches"];
+    if (0 < [mismatches count]) {
+        [_failures addObject:@{@"file": item[0], @"phase": @"verify.native", @"message": [mismatches componentsJoinedByString:@", "]}];
+    }
+    return retVal;
+}
+
+
+/*
+ Listings of more than 9999 lines have line numbers of five digits. The source is generated for this check only, so
+ the corpus keeps its size and the timed phases stay comparable with earlier runs.
+ */
+- (BOOL)verifyAddressMapOfLargeSource:(NSError **)error
+{
+    const NSUInteger tableLength = 10000;
+    NSMutableString *source = [NSMutableString stringWithString:@"       DEF  START\n"
+                                                                 "START  LI   R0,TABLE\n"
+                                                                 "       LI   R1,TABEND-TABLE\n"
+                                                                 "LOOP   CLR  *R0+\n"
+                                                                 "       DECT R1\n"
+                                                                 "       JNE  LOOP\n"
+                                                                 "       B    *R11\n"
+                                                                 "TABLE\n"];
+    for (NSUInteger i = 0; i < tableLength; i++) {
+        [source appendFormat:@"       DATA >%04lX\n", (unsigned long)((i * 0x9E37) & 0xFFFF)];
+    }
+    [source appendString:@"TABEND\n       END\n"];
+    const NSUInteger lastLine = [[source componentsSeparatedByString:@"\n"] count] - 3;
+
+    NSURL *fileURL = [[NSURL fileURLWithPath:NSTemporaryDirectory() isDirectory:YES] URLByAppendingPathComponent:[NSString stringWithFormat:@"xdt99bench.%d.table.a99", getpid()]];
+    if (![source writeToURL:fileURL atomically:NO encoding:NSUTF8StringEncoding error:error]) {
+        return NO;
+    }
+    NSDictionary *options = @{
+                              XDTAs99OptionRegister: @YES,
+                              XDTAs99OptionStrict: @NO,
+                              XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTAs99TargetTypeProgramImage],
+                              XDTAs99OptionWarnings: @YES
+                              };
+    XDTAssembler *assembler = [XDTAssembler assemblerWithOptions:options includeURL:fileURL];
+    XDTAs99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+    XDTAddressMap *addressMap = [objcode addressMap:error];
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+    if (nil == addressMap) {
+        return NO;
+    }
+    if (0 == [[addressMap rangesOfLine:lastLine fileName:nil] count]) {
+        if (nil != error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError
+                                     userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"The address map has no address of line %lu.", (unsigned long)lastLine]}];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+
+#pragma mark - Phases
+
+
+/*
+ The session assembler is kept for the whole benchmark, like the sessions of xdt99d, and is created without the
+ instrumentation, so it measures the same work in the warm-up and the timed runs.
+ */
+- (XDTAssembler *)sessionAssemblerForSourceFile:(NSURL *)fileURL
+{
+    if (nil == _sessionAssembler) {
+        NSDictionary *options = @{
+                                  XDTAs99OptionNativeAssembly: @YES,
+                                  XDTAs99OptionRegister: @YES,
+                                  XDTAs99OptionStrict: @NO,
+                                  XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTAs99TargetTypeProgramImage],
+                                  XDTAs99OptionWarnings: @YES
+                                  };
+        self.sessionAssembler = [XDTAssembler assemblerWithOptions:options includeURL:[fileURL URLByDeletingLastPathComponent]];
+    }
+    return _sessionAssembler;
+}
+
+
+- (NSDictionary *)options:(NSDictionary *)options withInstrumentationForKey:(NSString *)key
+{
+    if (nil == _activeInstrumentation) {
+        return options;
+    }
+    NSMutableDictionary *retVal = [NSMutableDictionary dictionaryWithDictionary:options];
+    [retVal setObject:_activeInstrumentation forKey:key];
+    return retVal;
+}
+
+
+- (NSArray<NSArray *> *)phasesForFile:(NSURL *)fileURL ofKind:(NSString *)kind
+{
+    if ([@"asm" isEqualToString:kind]) {
+        return [self phasesForAssemblerSource:fileURL];
+    } else if ([@"gpl" isEqualToString:kind]) {
+        return [self phasesForGPLSource:fileURL];
+    } else if ([@"basic" isEqualToString:kind]) {
+        return [self phasesForBasicSource:fileURL];
+    } else if ([@"bin" isEqualToString:kind]) {
+        return [self phasesForProgramImage:fileURL];
+    }
+    return @[];
+}
+
+
+/*
+ Builds a console list in the format of xas99 and xga99 with a warning for every line of the source file. The list
+ is used to benchmark the message conversion independent from the number of messages the corpus actually produces.
+ */
+- (nullable NSValue *)pythonConsoleListForSourceFile:(NSURL *)fileURL
+{
+    NSString *source = [NSString stringWithContentsOfURL:fileURL encoding:NSUTF8StringEncoding error:nil];
+    if (nil == source) {
+        return nil;
+    }
+    NSArray<NSString *> *lines = [source componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]];
+    XDTAcquireGIL();
+    PyObject *consoleList = PyList_New(0);
+    [lines enumerateObjectsUsingBlock:^(NSString *line, NSUInteger idx, BOOL *stop) {
+        PyObject *pItem = Py_BuildValue("(ssiiss)", (0 == idx % 8)? "E" : "W", [[fileURL path] UTF8String], 2, (int)idx + 1, [line UTF8String], "Benchmark message");
+        if (NULL != pItem) {
+            PyList_Append(consoleList, pItem);
+            Py_DECREF(pItem);
+        }
+    }];
+    return [NSValue valueWithPointer:consoleList];
+}
+
+
+- (NSArray<NSArray *> *)messagePhasesForSourceFile:(NSURL *)fileURL
+{
+    return @[
+             XDTBenchPhaseWithSetup(@"messages.convert", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 /* building the list in Python is not part of the conversion */
+                 NSValue *consoleList = [self pythonConsoleListForSourceFile:fileURL];
+                 if (nil == consoleList) {
+                     return NO;
+                 }
+                 [context setObject:consoleList forKey:@"console"];
+                 return YES;
+             }, ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 XDTMessage *messages = [XDTMessage messageWithPythonList:[[context objectForKey:@"console"] pointerValue]];
+                 [context setObject:messages forKey:@"messages"];
+                 return 0 < [messages count];
+             }, ^(NSMutableDictionary<NSString *, id> *context) {
+                 PyObject *consoleList = [[context objectForKey:@"console"] pointerValue];
+                 [context removeObjectForKey:@"console"];
+                 XDTAcquireGIL();
+                 Py_XDECREF(consoleList);
+             }),
+             XDTBenchPhase(@"messages.format", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 /* The same work the log view of the IDE does for each document */
+                 XDTMessage *messages = [[context objectForKey:@"messages"] sortedByPriorityAscendingType];
+                 __block NSUInteger length = 0;
+                 [messages enumerateMessagesUsingBlock:^(NSDictionary<XDTMessageTypeKey, id> *obj, BOOL *stop) {
+                     NSString *entry = [NSString stringWithFormat:@"%@ <%@> %@ - %@\n%@", [[obj objectForKey:XDTMessageFileURL] lastPathComponent],
+                                        [obj objectForKey:XDTMessagePassNumber], [obj objectForKey:XDTMessageLineNumber],
+                                        [obj objectForKey:XDTMessageCodeLine], [obj objectForKey:XDTMessageText]];
+                     length += [entry length];
+                 }];
+                 return 0 < length && 0 < [messages countOfType:XDTMessageTypeWarning];
+             }),
+             ];
+}
+
+
+- (NSArray<NSArray *> *)phasesForAssemblerSource:(NSURL *)fileURL
+{
+    NSArray<NSArray *> *phases = @[
+                                   XDTBenchPhase(@"assemble", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       NSDictionary *options = @{
+                                                                 XDTAs99OptionRegister: @YES,
+                                                                 XDTAs99OptionStrict: @NO,
+                                                                 XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTAs99TargetTypeProgramImage],
+                                                                 XDTAs99OptionWarnings: @YES
+                                                                 };
+                                       options = [self options:options withInstrumentationForKey:XDTAs99OptionInstrumentation];
+                                       XDTAssembler *assembler = [XDTAssembler assemblerWithOptions:options includeURL:fileURL];
+                                       XDTAs99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+                                       if (nil == objcode) {
+                                           return NO;
+                                       }
+                                       [context setObject:objcode forKey:@"objcode"];
+                                       return YES;
+                                   }),
+                                   XDTBenchPhase(@"generate.image", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateImageAt:0xa000 error:error];
+                                   }),
+                                   XDTBenchPhase(@"generate.objcode", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateObjCode:YES error:error];
+                                   }),
+                                   XDTBenchPhase(@"generate.listing", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateListing:YES error:error];
+                                   }),
+                                   XDTBenchPhase(@"generate.symbols", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateSymbols:YES error:error];
+                                   }),
+                                   XDTBenchPhase(@"detach", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return [[context objectForKey:@"objcode"] materializeAndDetach:error];
+                                   }),
+                                   XDTBenchPhase(@"assemble.native", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       /* Sources beyond the subset of the native assembler are assembled by xas99 */
+                                       NSDictionary *options = @{
+                                                                 XDTAs99OptionNativeAssembly: @YES,
+                                                                 XDTAs99OptionRegister: @YES,
+                                                                 XDTAs99OptionStrict: @NO,
+                                                                 XDTAs99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTAs99TargetTypeProgramImage],
+                                                                 XDTAs99OptionWarnings: @YES
+                                                                 };
+                                       options = [self options:options withInstrumentationForKey:XDTAs99OptionInstrumentation];
+                                       XDTAssembler *assembler = [XDTAssembler assemblerWithOptions:options includeURL:fileURL];
+                                       XDTAs99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+                                       return nil != [objcode generateImageAt:0xa000 error:error];
+                                   }),
+                                   XDTBenchPhase(@"assemble.session", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       /* Like assemble.native, but unchanged copied files are parsed only once for all sources and runs */
+                                       XDTAs99Objcode *objcode = [[self sessionAssemblerForSourceFile:fileURL] assembleSourceFile:fileURL error:error];
+                                       return nil != [objcode generateImageAt:0xa000 error:error];
+                                   }),
+                                   ];
+    return [phases arrayByAddingObjectsFromArray:[self messagePhasesForSourceFile:fileURL]];
+}
+
+
+- (NSArray<NSArray *> *)phasesForGPLSource:(NSURL *)fileURL
+{
+    NSArray<NSArray *> *phases = @[
+                                   XDTBenchPhase(@"assemble", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       NSDictionary *options = @{
+                                                                 XDTGa99OptionAORG: @0x0030,
+                                                                 XDTGa99OptionGROM: @0x6000,
+                                                                 XDTGa99OptionStyle: [NSNumber numberWithUnsignedInteger:XDTGa99SyntaxTypeNativeXDT99],
+                                                                 XDTGa99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTGa99TargetTypeHeaderedByteCode],
+                                                                 XDTGa99OptionWarnings: @YES
+                                                                 };
+                                       options = [self options:options withInstrumentationForKey:XDTGa99OptionInstrumentation];
+                                       XDTGPLAssembler *assembler = [XDTGPLAssembler gplAssemblerWithOptions:options includeURL:fileURL];
+                                       XDTGa99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+                                       if (nil == objcode) {
+                                           return NO;
+                                       }
+                                       [context setObject:objcode forKey:@"objcode"];
+                                       return YES;
+                                   }),
+                                   XDTBenchPhase(@"generate.bytecode", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateByteCode:error];
+                                   }),
+                                   XDTBenchPhase(@"generate.image", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateImageWithName:@"BENCHMARK" error:error];
+                                   }),
+                                   XDTBenchPhase(@"generate.listing", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return nil != [[context objectForKey:@"objcode"] generateListing:YES error:error];
+                                   }),
+                                   XDTBenchPhase(@"detach", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       return [[context objectForKey:@"objcode"] materializeAndDetach:error];
+                                   }),
+                                   XDTBenchPhase(@"assemble.native", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       /* Sources beyond the subset of the native assembler are assembled by xga99 */
+                                       NSDictionary *options = @{
+                                                                 XDTGa99OptionAORG: @0x0030,
+                                                                 XDTGa99OptionGROM: @0x6000,
+                                                                 XDTGa99OptionNativeAssembly: @YES,
+                                                                 XDTGa99OptionStyle: [NSNumber numberWithUnsignedInteger:XDTGa99SyntaxTypeNativeXDT99],
+                                                                 XDTGa99OptionTarget: [NSNumber numberWithUnsignedInteger:XDTGa99TargetTypeHeaderedByteCode],
+                                                                 XDTGa99OptionWarnings: @YES
+                                                                 };
+                                       options = [self options:options withInstrumentationForKey:XDTGa99OptionInstrumentation];
+                                       XDTGPLAssembler *assembler = [XDTGPLAssembler gplAssemblerWithOptions:options includeURL:fileURL];
+                                       XDTGa99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+                                       return nil != [objcode generateImageWithName:@"BENCHMARK" error:error];
+                                   }),
+                                   XDTBenchPhase(@"interpret", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                                       /* The image and the symbols were captured before detaching */
+                                       XDTGa99Objcode *objcode = [context objectForKey:@"objcode"];
+                                       NSData *image = [objcode generateImageWithName:@"BENCHMARK" error:error];
+                                       NSData *symbols = [objcode generateSymbols:NO error:error];
+                                       XDTGPLInterpreter *interpreter = [XDTGPLInterpreter interpreter];
+                                       if (nil == image || nil == symbols || ![interpreter loadImage:image atGROMAddress:0x6000 error:error]) {
+                                           return NO;
+                                       }
+                                       [interpreter loadSymbols:symbols];
+                                       const NSUInteger entryAddress = [interpreter entryAddressOfImage];
+                                       const XDTGPLInterpreterState state = (NSNotFound == entryAddress)? XDTGPLInterpreterStateUnsupported :
+                                                                            [interpreter runFromAddress:entryAddress maximumCycles:XDTBenchGPLCycleLimit];
+                                       if (XDTGPLInterpreterStateUnsupported == state || 0 == interpreter.instructions) {
+                                           if (nil != error) {
+                                               NSString *reason = (nil != interpreter.stateDescription)? interpreter.stateDescription : @"The image has no program in its GROM header.";
+                                               *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError
+                                                                        userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"The GPL interpreter stopped: %@", reason]}];
+                                           }
+                                           return NO;
+                                       }
+                                       /* the same program and cycle limit give the same counts in every run */
+                                       [self.gplProfiles setObject:@{
+                                                                     @"file": [NSString stringWithFormat:@"gpl/%@", [fileURL lastPathComponent]],
+                                                                     @"state": (nil != interpreter.stateDescription)? interpreter.stateDescription : @"Exited",
+                                                                     @"instructions": @(interpreter.instructions),
+                                                                     @"cycles": @(interpreter.cycles),
+                                                                     @"executionsPerLabel": [interpreter executionCountsPerLabel]
+                                                                     }
+                                                            forKey:[fileURL lastPathComponent]];
+                                       return YES;
+                                   }),
+                                   ];
+    return [phases arrayByAddingObjectsFromArray:[self messagePhasesForSourceFile:fileURL]];
+}
+
+
+- (NSArray<NSArray *> *)phasesForBasicSource:(NSURL *)fileURL
+{
+    return @[
+             XDTBenchPhase(@"parse", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 NSString *source = [NSString stringWithContentsOfURL:fileURL encoding:NSUTF8StringEncoding error:error];
+                 XDTBasic *basic = [XDTBasic basicWithOptions:[self options:@{XDTBasicOptionProtectFile: @NO, XDTBasicOptionJoinLines: @NO} withInstrumentationForKey:XDTBasicOptionInstrumentation]];
+                 if (nil == source || nil == basic || ![basic parseSourceCode:source error:error]) {
+                     return NO;
+                 }
+                 [context setObject:basic forKey:@"basic"];
+                 return YES;
+             }),
+             XDTBenchPhase(@"save", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 NSData *image = [[context objectForKey:@"basic"] getImageUsingLongFormat:NO error:error];
+                 if (nil == image) {
+                     return NO;
+                 }
+                 [context setObject:image forKey:@"image"];
+                 return YES;
+             }),
+             XDTBenchPhase(@"load", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 XDTBasic *basic = [XDTBasic basicWithOptions:[self options:@{XDTBasicOptionProtectFile: @NO, XDTBasicOptionJoinLines: @NO} withInstrumentationForKey:XDTBasicOptionInstrumentation]];
+                 if (nil == basic || ![basic loadProgramData:[context objectForKey:@"image"] error:error]) {
+                     return NO;
+                 }
+                 [context setObject:basic forKey:@"basic"];
+                 return YES;
+             }),
+             XDTBenchPhase(@"list", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 return nil != [[context objectForKey:@"basic"] getSource:error];
+             }),
+             ];
+}
+
+
+- (NSArray<NSArray *> *)phasesForProgramImage:(NSURL *)fileURL
+{
+    return @[
+             XDTBenchPhase(@"disassemble", ^BOOL(NSMutableDictionary<NSString *, id> *context, NSError **error) {
+                 NSData *image = [NSData dataWithContentsOfURL:fileURL options:0 error:error];
+                 if (nil == image) {
+                     return NO;
+                 }
+                 XDTDisassembler *disassembler = [XDTDisassembler disassemblerWithOptions:@{XDTDisassemblerOptionRegister: @YES}];
+                 NSData *source = [disassembler disassembleProgramImage:image error:error];
+                 if (nil == source) {
+                     return NO;
+                 }
+                 [context setObject:source forKey:@"source"];
+                 return YES;
+             }),
+             ];
+}
+
+@end
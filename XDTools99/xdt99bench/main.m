@@ -0,0 +1,178 @@
+//
+//  main.m
+//  xdt99bench
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+#import <Foundation/Foundation.h>
+
+#import <XDTools99/XDTools99.h>
+
+#import "XDTBenchmark.h"
+
+#include <getopt.h>
+
+
+/* Both paths are set by the build settings of the target, so the tool runs from Xcode without any arguments. */
+#ifndef XDTBENCH_CORPUS_PATH
+#define XDTBENCH_CORPUS_PATH "Corpus"
+#endif
+#ifndef XDTBENCH_MODULE_PATH
+#define XDTBENCH_MODULE_PATH "xdt99"
+#endif
+
+
+static void usage(const char *toolName)
+{
+    fprintf(stderr, "usage: %s [-c corpus] [-m modules] [-b bundle.zip] [-n iterations] [-s] [-v] [-o output.json] [-t trace.json] [-p stacks.txt]\n"
+            "  -c corpus      directory with the sub directories asm, gpl, basic and bin (default: %s)\n"
+            "  -m modules     directory of the xdt99 Python modules (default: %s)\n"
+            "  -b bundle      precompiled module bundle built for the framework, cold starts are also measured with it\n"
+            "  -s             measure cold starts in new processes, until the first object code is assembled\n"
+            "  -S             run a single cold start and print its times (used by -s)\n"
+            "  -n iterations  number of timed runs for each file (default: 10)\n"
+            "  -v             compare the results of the native assemblers with xas99 and xga99 for all sources\n"
+            "  -o output      file to write the JSON result to (default: standard output)\n"
+            "  -t trace       file to write a Chrome trace of the framework phases of the warm-up run to\n"
+            "  -p stacks      file to write the folded stacks of the Python code of the warm-up run to, for flame graphs\n",
+            toolName, XDTBENCH_CORPUS_PATH, XDTBENCH_MODULE_PATH);
+}
+
+
+int main(int argc, char * const argv[])
+{
+    @autoreleasepool {
+        NSString *corpusPath = @XDTBENCH_CORPUS_PATH;
+        NSString *modulePath = @XDTBENCH_MODULE_PATH;
+        NSString *outputPath = nil;
+        NSString *tracePath = nil;
+        NSString *stacksPath = nil;
+        NSString *bundlePath = nil;
+        BOOL measureColdStart = NO;
+        BOOL isColdStart = NO;
+        BOOL verifiesNativeAssembly = NO;
+        NSUInteger iterations = 10;
+
+        int option;
+        while (-1 != (option = getopt(argc, argv, "b:c:m:n:o:p:sSt:vh"))) {
+            switch (option) {
+                case 'b':
+                    bundlePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    measureColdStart = YES;
+                    break;
+                case 'c':
+                    corpusPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 'm':
+                    modulePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 'n':
+                    iterations = (NSUInteger)strtoul(optarg, NULL, 10);
+                    break;
+                case 'o':
+                    outputPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 'p':
+                    stacksPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 's':
+                    measureColdStart = YES;
+                    break;
+                case 'S':
+                    isColdStart = YES;
+                    break;
+                case 't':
+                    tracePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 'v':
+                    verifiesNativeAssembly = YES;
+                    break;
+
+                default:
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+            }
+        }
+        if (optind < argc || 0 == iterations) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        NSError *error = nil;
+        NSURL *corpusURL = [NSURL fileURLWithPath:[corpusPath stringByStandardizingPath] isDirectory:YES];
+        if (isColdStart) {
+            /* Python is started by XDTObject itself, with the modules given by the environment of the parent process. */
+            NSDictionary<NSString *, NSNumber *> *coldStart = [XDTBenchmark coldStartWithCorpusURL:corpusURL error:&error];
+            NSData *json = (nil == coldStart)? nil : [NSJSONSerialization dataWithJSONObject:coldStart options:0 error:&error];
+            if (nil == json) {
+                fprintf(stderr, "%s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
+                return EXIT_FAILURE;
+            }
+            [[NSFileHandle fileHandleWithStandardOutput] writeData:json];
+            return EXIT_SUCCESS;
+        }
+
+        [XDTObject reinitializeWithXDTModulePath:[modulePath stringByStandardizingPath]];
+        if (![XDTAssembler checkRequiredModuleVersion] || ![XDTGPLAssembler checkRequiredModuleVersion] || ![XDTBasic checkRequiredModuleVersion]) {
+            fprintf(stderr, "%s: the xdt99 modules at %s do not match the versions required by the framework\n", argv[0], [modulePath fileSystemRepresentation]);
+            return EXIT_FAILURE;
+        }
+
+        XDTBenchmark *benchmark = [XDTBenchmark benchmarkWithCorpusURL:corpusURL iterations:iterations];
+        if (measureColdStart) {
+            NSMutableArray<NSString *> *coldStartModulePaths = [NSMutableArray arrayWithObject:[modulePath stringByStandardizingPath]];
+            if (nil != bundlePath) {
+                [coldStartModulePaths addObject:[bundlePath stringByStandardizingPath]];
+            }
+            benchmark.coldStartModulePaths = coldStartModulePaths;
+        }
+        benchmark.verifiesNativeAssembly = verifiesNativeAssembly;
+        if (nil != tracePath || nil != stacksPath) {
+            benchmark.instrumentation = [XDTInstrumentation instrumentation];
+        }
+        if (nil != stacksPath) {
+            benchmark.instrumentation.pythonProfiler = [XDTPythonProfiler pythonProfiler];
+        }
+        NSDictionary<NSString *, id> *result = [benchmark run:&error];
+        if (nil != result && nil != tracePath && ![benchmark.instrumentation writeChromeTraceToURL:[NSURL fileURLWithPath:tracePath] error:&error]) {
+            fprintf(stderr, "%s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
+            return EXIT_FAILURE;
+        }
+        if (nil != result && nil != stacksPath && ![benchmark.instrumentation.pythonProfiler writeFoldedStacksToURL:[NSURL fileURLWithPath:stacksPath] error:&error]) {
+            fprintf(stderr, "%s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
+            return EXIT_FAILURE;
+        }
+        NSData *json = (nil == result)? nil : [NSJSONSerialization dataWithJSONObject:result options:NSJSONWritingPrettyPrinted error:&error];
+        if (nil == json) {
+            fprintf(stderr, "%s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
+            return EXIT_FAILURE;
+        }
+
+        if (nil == outputPath) {
+            [[NSFileHandle fileHandleWithStandardOutput] writeData:json];
+            fputc('\n', stdout);
+        } else if (![json writeToFile:outputPath options:NSDataWritingAtomic error:&error]) {
+            fprintf(stderr, "%s: %s\n", argv[0], [[error localizedDescription] UTF8String]);
+            return EXIT_FAILURE;
+        }
+        return (0 == [(NSArray *)[result objectForKey:@"failures"] count])? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
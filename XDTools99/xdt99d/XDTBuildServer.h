@@ -0,0 +1,66 @@
+//
+//  XDTBuildServer.h
+//  xdt99d
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+#import <XDTools99/XDTools99.h>
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The build server listens on a Unix domain socket for requests of XDTBuildClient objects and runs them with
+ XDTAssembler, XDTGPLAssembler and XDTBasic in one warm Python interpreter.
+
+ Every connection reads its requests and writes its replies on its own queue, and is dropped when its client takes
+ longer than five seconds to send a request or to read a reply. The replies are built on the main queue, one request
+ after another, so Python is only used by the thread which started it. Assembler sessions are kept for each combination of tool, options and source directory, XDTBasic
+ objects are created for each request, as xbas99 keeps the state of the last program. Successful replies are
+ kept in a cache whose key is a SHA-256 digest of the request and of the content of the source file. A cached reply
+ is only used while the files which the build has read have the same sizes and modification dates, so an included
+ file which changed is assembled again. These are the source and all copied files of the native assemblers, or all
+ files below the directory of the source, when xas99 or xga99 has assembled it. In that case requests for
+ directories with more than 512 entries are not cached at all.
+
+ The socket file is created with the permissions 0600. A stale socket file of a server which did not terminate is
+ replaced, while a socket with a server that is still running lets the initializer fail with EADDRINUSE.
+ */
+@interface XDTBuildServer : NSObject
+
+@property (readonly) NSString *socketPath;
+@property (readonly) NSUInteger resultCacheLimit;   /* Maximum size of all cached replies in bytes */
+@property (readonly) NSDictionary<NSString *, NSNumber *> *status;
+
++ (nullable instancetype)buildServerWithSocketPath:(NSString *)socketPath resultCacheLimit:(NSUInteger)cacheLimit error:(NSError **)error;
+
+/* Closes all connections and removes the socket file. */
+- (void)invalidate;
+
+/* Reloads the xdt99 modules of the framework and of all registered versions, and drops all sessions and results. */
+- (BOOL)reloadModules:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
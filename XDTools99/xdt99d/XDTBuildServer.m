@@ -0,0 +1,780 @@
+//
+//  XDTBuildServer.m
+//  xdt99d
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import "XDTBuildServer.h"
+
+#include <CommonCrypto/CommonDigest.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+
+
+#define XDTBuildServerMaxSessions 16
+#define XDTBuildServerMaxDigestEntries 512
+#define XDTBuildServerReceiveTimeout 5   /* seconds a client may take to send the rest of a started request */
+#define XDTBuildServerSendTimeout 5      /* seconds a client may take to read the rest of a reply */
+
+
+NS_ASSUME_NONNULL_BEGIN
+
+/* A reply of the cache with the files the build has read, and their sizes and modification dates at that time. */
+@interface XDTBuildCachedReply : NSObject
+
+@property (readonly) XDTBuildMessage *reply;
+@property (readonly) NSArray<NSURL *> *readFiles;
+@property (readonly) NSData *fileStamps;
+
++ (instancetype)cachedReply:(XDTBuildMessage *)reply readFiles:(NSArray<NSURL *> *)readFiles fileStamps:(NSData *)fileStamps;
+
+@end
+
+
+@interface XDTBuildServer () {
+    int _listenSocket;
+    dispatch_source_t _listenSource;
+    NSMutableSet *_connectionSources;
+    NSCache<id, id> *_sessions;
+    NSCache<NSData *, XDTBuildCachedReply *> *_resultCache;
+    NSDate *_startDate;
+    NSArray<NSURL *> *_readFiles;     /* Set by the tool methods, when the files their build has read are known */
+
+    NSUInteger _connectionCount;
+    NSUInteger _requestCount;
+    NSUInteger _cacheHitCount;
+    NSUInteger _failureCount;
+}
+
+- (nullable instancetype)initWithSocketPath:(NSString *)socketPath resultCacheLimit:(NSUInteger)cacheLimit error:(NSError **)error;
+
+- (void)acceptConnection;
+- (BOOL)serveConnection:(int)clientSocket;
+- (XDTBuildMessage *)replyToRequest:(XDTBuildMessage *)request;
+- (nullable NSData *)cacheKeyOfRequest:(XDTBuildMessage *)request fileURL:(NSURL *)fileURL;
+
+- (BOOL)assembleSourceFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error;
+- (BOOL)assembleGPLSourceFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error;
+- (BOOL)parseBasicSourceFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error;
+- (BOOL)loadBasicProgramFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+
+/* Returns the options without the keys of the build server, which are not known by the tools. */
+static NSDictionary<NSString *, id> *XDTBuildToolOptions(NSDictionary<NSString *, id> *options)
+{
+    NSMutableDictionary<NSString *, id> *retVal = [NSMutableDictionary dictionaryWithDictionary:options];
+    [retVal removeObjectsForKeys:@[XDTBuildOptionBaseAddress, XDTBuildOptionCartridgeName, XDTBuildOptionCompressObjectCode, XDTBuildOptionTextMode, XDTBuildOptionListing]];
+    return retVal;
+}
+
+
+/* Returns a digest of the paths, sizes and modification dates of the files, a missing file has neither of both. */
+static NSData *XDTBuildFileStamps(NSArray<NSURL *> *files)
+{
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    NSArray<NSString *> *propertyKeys = @[NSURLFileSizeKey, NSURLContentModificationDateKey];
+    for (NSURL *file in files) {
+        [file removeAllCachedResourceValues];
+        NSDictionary<NSString *, id> *properties = [file resourceValuesForKeys:propertyKeys error:nil];
+        const char *filePath = [[file path] fileSystemRepresentation];
+        const int64_t fileSize = [[properties objectForKey:NSURLFileSizeKey] longLongValue];
+        const double fileDate = [[properties objectForKey:NSURLContentModificationDateKey] timeIntervalSinceReferenceDate];
+        CC_SHA256_Update(&context, filePath, (CC_LONG)strlen(filePath) + 1);
+        CC_SHA256_Update(&context, &fileSize, sizeof(fileSize));
+        CC_SHA256_Update(&context, &fileDate, sizeof(fileDate));
+    }
+
+    NSMutableData *retVal = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final([retVal mutableBytes], &context);
+    return retVal;
+}
+
+
+/* Returns all entries below the include directories, or nil when there are too many of them to check. */
+static NSArray<NSURL *> *XDTBuildFilesBelowURLs(NSArray<NSURL *> *includeURLs)
+{
+    NSMutableArray<NSURL *> *retVal = [NSMutableArray array];
+    for (NSURL *includeURL in includeURLs) {
+        NSDirectoryEnumerator<NSURL *> *entries = [[NSFileManager defaultManager] enumeratorAtURL:includeURL
+                                                                       includingPropertiesForKeys:@[NSURLFileSizeKey, NSURLContentModificationDateKey]
+                                                                                          options:0
+                                                                                     errorHandler:nil];
+        for (NSURL *entry in entries) {
+            if (XDTBuildServerMaxDigestEntries <= [retVal count]) {
+                return nil;
+            }
+            [retVal addObject:entry];
+        }
+    }
+    return retVal;
+}
+
+
+static void XDTBuildAddOutput(XDTBuildMessage *reply, NSData *data, NSString *name)
+{
+    [reply addField:XDTBuildFieldOutput data:data];
+    [reply addField:XDTBuildFieldOutputName string:name];
+}
+
+
+static NSError *XDTBuildMissingSessionError(void)
+{
+    return [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodePythonError
+                           userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(@"The xdt99 module could not be loaded by the build server.", @"Description for an error, when the tool of a request is not available.")}];
+}
+
+
+@implementation XDTBuildCachedReply
+
++ (instancetype)cachedReply:(XDTBuildMessage *)reply readFiles:(NSArray<NSURL *> *)readFiles fileStamps:(NSData *)fileStamps
+{
+    XDTBuildCachedReply *retVal = [[XDTBuildCachedReply alloc] init];
+    retVal->_reply = reply;
+    retVal->_readFiles = [readFiles copy];
+    retVal->_fileStamps = fileStamps;
+#if !__has_feature(objc_arc)
+    [retVal->_reply retain];
+    [retVal->_fileStamps retain];
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    [_reply release];
+    [_readFiles release];
+    [_fileStamps release];
+
+    [super dealloc];
+#endif
+}
+
+@end
+
+
+@implementation XDTBuildServer
+
+#pragma mark Initializers
+
++ (instancetype)buildServerWithSocketPath:(NSString *)socketPath resultCacheLimit:(NSUInteger)cacheLimit error:(NSError **)error
+{
+    XDTBuildServer *retVal = [[XDTBuildServer alloc] initWithSocketPath:socketPath resultCacheLimit:cacheLimit error:error];
+#if !__has_feature(objc_arc)
+    [retVal autorelease];
+#endif
+    return retVal;
+}
+
+
+- (instancetype)initWithSocketPath:(NSString *)socketPath resultCacheLimit:(NSUInteger)cacheLimit error:(NSError **)error
+{
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _socketPath = [socketPath copy];
+    _resultCacheLimit = cacheLimit;
+    _listenSocket = -1;
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    const char *path = [socketPath fileSystemRepresentation];
+    if (sizeof(address.sun_path) <= strlen(path)) {
+        errno = ENAMETOOLONG;
+    } else {
+        strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+
+        /* Only a stale socket file is removed, the socket of a running server still accepts connections */
+        int probeSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        const BOOL isRunning = 0 <= probeSocket && 0 == connect(probeSocket, (struct sockaddr *)&address, sizeof(address));
+        if (0 <= probeSocket) {
+            close(probeSocket);
+        }
+        if (isRunning) {
+            errno = EADDRINUSE;
+        } else {
+            unlink(path);
+            _listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (0 <= _listenSocket &&
+                0 == bind(_listenSocket, (struct sockaddr *)&address, sizeof(address)) &&
+                0 == chmod(path, S_IRUSR | S_IWUSR) &&
+                0 == listen(_listenSocket, SOMAXCONN)) {
+                const int listenSocket = _listenSocket;
+                _listenSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, listenSocket, 0, dispatch_get_main_queue());
+                dispatch_source_set_event_handler(_listenSource, ^{
+                    [self acceptConnection];
+                });
+                dispatch_source_set_cancel_handler(_listenSource, ^{
+                    close(listenSocket);
+                });
+                dispatch_resume(_listenSource);
+
+                _connectionSources = [[NSMutableSet alloc] init];
+                _sessions = [[NSCache alloc] init];
+                [_sessions setCountLimit:XDTBuildServerMaxSessions];
+                _resultCache = [[NSCache alloc] init];
+                [_resultCache setTotalCostLimit:cacheLimit];
+                _startDate = [[NSDate alloc] init];
+                return self;
+            }
+        }
+    }
+
+    if (nil != error) {
+        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSFilePathErrorKey: socketPath}];
+    }
+    if (0 <= _listenSocket) {
+        close(_listenSocket);
+    }
+#if !__has_feature(objc_arc)
+    [self release];
+#endif
+    return nil;
+}
+
+
+- (void)dealloc
+{
+#if !__has_feature(objc_arc)
+    if (nil != _listenSource) {
+        dispatch_release(_listenSource);
+    }
+    [_connectionSources release];
+    [_sessions release];
+    [_resultCache release];
+    [_startDate release];
+    [_readFiles release];
+    [_socketPath release];
+
+    [super dealloc];
+#endif
+}
+
+
+- (void)invalidate
+{
+    if (nil == _listenSource) {
+        return;
+    }
+    dispatch_source_cancel(_listenSource);
+    for (dispatch_source_t source in [_connectionSources allObjects]) {
+        dispatch_source_cancel(source);
+    }
+    [_connectionSources removeAllObjects];
+    unlink([_socketPath fileSystemRepresentation]);
+}
+
+
+/* Sessions and cached results were made by the old modules, so all of them are built again by the reloaded ones */
+- (BOOL)reloadModules:(NSError **)error
+{
+    if (![XDTObject reloadXDTModulesOfVersion:nil error:error]) {
+        return NO;
+    }
+    for (NSString *version in [XDTObject registeredXDTModuleVersions]) {
+        if (![XDTObject reloadXDTModulesOfVersion:version error:error]) {
+            return NO;
+        }
+    }
+    [_sessions removeAllObjects];
+    [_resultCache removeAllObjects];
+    return YES;
+}
+
+
+#pragma mark - Accessor Methods
+
+
+- (NSDictionary<NSString *, NSNumber *> *)status
+{
+    return @{
+             @"pid": [NSNumber numberWithInt:getpid()],
+             @"uptime": [NSNumber numberWithDouble:-[_startDate timeIntervalSinceNow]],
+             @"connections": [NSNumber numberWithUnsignedInteger:_connectionCount],
+             @"activeConnections": [NSNumber numberWithUnsignedInteger:[_connectionSources count]],
+             @"requests": [NSNumber numberWithUnsignedInteger:_requestCount],
+             @"cacheHits": [NSNumber numberWithUnsignedInteger:_cacheHitCount],
+             @"failures": [NSNumber numberWithUnsignedInteger:_failureCount],
+             @"resultCacheLimit": [NSNumber numberWithUnsignedInteger:_resultCacheLimit]
+             };
+}
+
+
+#pragma mark - Connection Methods
+
+
+- (void)acceptConnection
+{
+    const int clientSocket = accept(_listenSocket, NULL, NULL);
+    if (0 > clientSocket) {
+        return;
+    }
+    const struct timeval receiveTimeout = { XDTBuildServerReceiveTimeout, 0 };
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, &receiveTimeout, sizeof(receiveTimeout));
+    const struct timeval sendTimeout = { XDTBuildServerSendTimeout, 0 };
+    setsockopt(clientSocket, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+    const int noSigPipe = 1;
+    setsockopt(clientSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+
+    /*
+     Every connection reads and writes on its own queue, so a client which is slow to send or to read blocks only
+     itself. The handlers are released by the cancellation, which also breaks the reference of the source to itself.
+     */
+    dispatch_queue_t queue = dispatch_queue_create("xdt99d.connection", DISPATCH_QUEUE_SERIAL);
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, clientSocket, 0, queue);
+#if !__has_feature(objc_arc)
+    dispatch_release(queue);
+#endif
+    dispatch_source_set_event_handler(source, ^{
+        if (![self serveConnection:clientSocket]) {
+            dispatch_source_cancel(source);
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [_connectionSources removeObject:source];
+            });
+        }
+    });
+    dispatch_source_set_cancel_handler(source, ^{
+        close(clientSocket);
+    });
+    [_connectionSources addObject:source];
+    _connectionCount++;
+    dispatch_resume(source);
+#if !__has_feature(objc_arc)
+    dispatch_release(source);
+#endif
+}
+
+
+/*
+ Runs on the queue of the connection and returns NO when the connection is closed by the client or is not usable
+ anymore, also when the client has not sent or read a message within the timeouts. The reply is built on the main
+ queue, which serializes all requests on the sessions and the caches.
+ */
+- (BOOL)serveConnection:(int)clientSocket
+{
+    @autoreleasepool {
+        NSError *error = nil;
+        XDTBuildMessage *request = [XDTBuildMessage messageReadFromSocket:clientSocket error:&error];
+        if (nil == request) {
+            if (![NSPOSIXErrorDomain isEqualToString:[error domain]] || ECONNRESET != [error code]) {
+                NSLog(@"%s ERROR: Reading a request failed: %@", __FUNCTION__, error);
+            }
+            return NO;
+        }
+
+        __block XDTBuildMessage *reply = nil;
+        dispatch_sync(dispatch_get_main_queue(), ^{
+            reply = [self replyToRequest:request];
+#if !__has_feature(objc_arc)
+            [reply retain];
+#endif
+        });
+#if !__has_feature(objc_arc)
+        [reply autorelease];
+#endif
+        if (![reply writeToSocket:clientSocket error:&error]) {
+            NSLog(@"%s ERROR: Writing the reply to request %u failed: %@", __FUNCTION__, request.requestID, error);
+            return NO;
+        }
+    }
+    return YES;
+}
+
+
+#pragma mark - Request Methods
+
+
+- (XDTBuildMessage *)replyToRequest:(XDTBuildMessage *)request
+{
+    _requestCount++;
+    XDTBuildMessage *reply = [XDTBuildMessage messageWithType:XDTBuildMessageTypeReply requestID:request.requestID];
+    if (XDTBuildMessageTypeStatus == request.type) {
+        NSData *status = [NSPropertyListSerialization dataWithPropertyList:[self status] format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+        [reply addField:XDTBuildFieldStatus data:status];
+        return reply;
+    }
+
+    NSString *path = [request stringOfField:XDTBuildFieldSourcePath];
+    if (nil == path || 0 == [path length]) {
+        _failureCount++;
+        [reply addError:[NSError errorWithDomain:NSPOSIXErrorDomain code:EINVAL userInfo:nil]];
+        return reply;
+    }
+    NSURL *fileURL = [NSURL fileURLWithPath:path];
+
+    NSData *cacheKey = [self cacheKeyOfRequest:request fileURL:fileURL];
+    XDTBuildCachedReply *cachedReply = (nil == cacheKey)? nil : [_resultCache objectForKey:cacheKey];
+    if (nil != cachedReply) {
+        if ([cachedReply.fileStamps isEqualToData:XDTBuildFileStamps(cachedReply.readFiles)]) {
+            _cacheHitCount++;
+            reply = [XDTBuildMessage messageWithMessage:cachedReply.reply requestID:request.requestID];
+            [reply addField:XDTBuildFieldCached integer:1];
+            return reply;
+        }
+        [_resultCache removeObjectForKey:cacheKey];
+    }
+
+    /* Without knowing the files read by xas99 or xga99, all files which they could have included are checked */
+    NSArray<NSURL *> *includedFiles = XDTBuildFilesBelowURLs(@[[fileURL URLByDeletingLastPathComponent]]);
+    NSData *includedStamps = (nil == includedFiles)? nil : XDTBuildFileStamps(includedFiles);
+#if !__has_feature(objc_arc)
+    [_readFiles release];
+#endif
+    _readFiles = nil;
+
+    NSDictionary<NSString *, id> *options = [request options];
+    NSError *error = nil;
+    BOOL isGenerated = NO;
+    switch (request.type) {
+        case XDTBuildMessageTypeAssemble:
+            isGenerated = [self assembleSourceFile:fileURL options:options reply:reply error:&error];
+            break;
+        case XDTBuildMessageTypeAssembleGPL:
+            isGenerated = [self assembleGPLSourceFile:fileURL options:options reply:reply error:&error];
+            break;
+        case XDTBuildMessageTypeParseBasic:
+            isGenerated = [self parseBasicSourceFile:fileURL options:options reply:reply error:&error];
+            break;
+        case XDTBuildMessageTypeLoadBasic:
+            isGenerated = [self loadBasicProgramFile:fileURL options:options reply:reply error:&error];
+            break;
+
+        default:
+            error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOTSUP userInfo:nil];
+            break;
+    }
+
+    if (!isGenerated) {
+        _failureCount++;
+        [reply addError:(nil == error)? [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException userInfo:nil] : error];
+    } else if (nil != cacheKey && nil != _readFiles) {
+        [_resultCache setObject:[XDTBuildCachedReply cachedReply:reply readFiles:_readFiles fileStamps:XDTBuildFileStamps(_readFiles)]
+                         forKey:cacheKey cost:reply.payloadLength];
+    } else if (nil != cacheKey && nil != includedStamps) {
+        [_resultCache setObject:[XDTBuildCachedReply cachedReply:reply readFiles:includedFiles fileStamps:includedStamps]
+                         forKey:cacheKey cost:reply.payloadLength];
+    }
+    return reply;
+}
+
+
+/*
+ The key of a result is the digest of the request type, the options, the path and the content of the source file.
+ The files which the build has read are checked separately by their sizes and modification dates, before a cached
+ result is used. Returns nil, when the result should not be cached.
+ */
+- (NSData *)cacheKeyOfRequest:(XDTBuildMessage *)request fileURL:(NSURL *)fileURL
+{
+    NSData *content = [NSData dataWithContentsOfURL:fileURL options:NSDataReadingMappedIfSafe error:nil];
+    if (nil == content) {
+        return nil;
+    }
+
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    const uint16_t type = request.type;
+    CC_SHA256_Update(&context, &type, sizeof(type));
+    for (NSData *option in [request dataOfField:XDTBuildFieldOption]) {
+        const uint32_t length = (uint32_t)[option length];
+        CC_SHA256_Update(&context, &length, sizeof(length));
+        CC_SHA256_Update(&context, [option bytes], length);
+    }
+    const char *path = [[fileURL path] fileSystemRepresentation];
+    CC_SHA256_Update(&context, path, (CC_LONG)strlen(path) + 1);
+    CC_SHA256_Update(&context, [content bytes], (CC_LONG)[content length]);
+
+    NSMutableData *retVal = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final([retVal mutableBytes], &context);
+    return retVal;
+}
+
+
+#pragma mark - Tool Methods
+
+
+- (BOOL)assembleSourceFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error
+{
+    NSDictionary<NSString *, id> *toolOptions = XDTBuildToolOptions(options);
+    NSURL *directoryURL = [fileURL URLByDeletingLastPathComponent];
+    NSArray *sessionKey = @[@"xas99", toolOptions, directoryURL];
+    XDTAssembler *assembler = [_sessions objectForKey:sessionKey];
+    if (nil == assembler) {
+        assembler = [XDTAssembler assemblerWithOptions:toolOptions includeURL:directoryURL];
+        if (nil == assembler) {
+            *error = XDTBuildMissingSessionError();
+            return NO;
+        }
+        [_sessions setObject:assembler forKey:sessionKey];
+    }
+
+    XDTAs99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+    [reply addMessages:assembler.messages];
+    if (nil == objcode || nil != *error) {
+        return NO;
+    }
+    _readFiles = [objcode.sourceFiles copy];    /* only known for the native assembler */
+
+    NSNumber *baseAddressOption = [options objectForKey:XDTBuildOptionBaseAddress];
+    const NSUInteger baseAddress = (nil == baseAddressOption)? 0xa000 : [baseAddressOption unsignedIntegerValue];
+    NSString *cartridgeName = [options objectForKey:XDTBuildOptionCartridgeName];
+    if (nil == cartridgeName || 0 == [cartridgeName length]) {
+        cartridgeName = [[fileURL lastPathComponent] stringByDeletingPathExtension];
+    }
+    switch ([[toolOptions objectForKey:XDTAs99OptionTarget] unsignedIntegerValue]) {
+        case XDTAs99TargetTypeProgramImage: {
+            NSArray<NSData *> *images = [objcode generateImageAt:baseAddress error:error];
+            for (NSData *data in images) {
+                XDTBuildAddOutput(reply, data, @"");
+            }
+            break;
+        }
+        case XDTAs99TargetTypeRawBinary: {
+            NSArray<NSArray<id> *> *binaries = [objcode generateRawBinaryAt:baseAddress error:error];
+            for (NSArray<id> *element in binaries) {
+                NSNumber *address = [element objectAtIndex:0];
+                NSNumber *bank = [element objectAtIndex:1];
+                NSString *fileNameAddition = nil;
+                if ([bank isMemberOfClass:[NSNull class]]) {
+                    fileNameAddition = [NSString stringWithFormat:@"_%04x", (unsigned int)[address longValue]];
+                } else {
+                    fileNameAddition = [NSString stringWithFormat:@"_%04x_b%d", (unsigned int)[address longValue], (int)[bank longValue]];
+                }
+                XDTBuildAddOutput(reply, [element objectAtIndex:2], fileNameAddition);
+            }
+            break;
+        }
+        case XDTAs99TargetTypeTextBinaryAsm:
+        case XDTAs99TargetTypeTextBinaryBas:
+        case XDTAs99TargetTypeTextBinaryC: {
+            const XDTGenerateTextMode mode = [[options objectForKey:XDTBuildOptionTextMode] unsignedIntegerValue];
+            NSString *text = [objcode generateTextAt:baseAddress withMode:mode error:error];
+            if (nil != text) {
+                XDTBuildAddOutput(reply, [text dataUsingEncoding:NSUTF8StringEncoding], @"");
+            }
+            break;
+        }
+        case XDTAs99TargetTypeObjectCode: {
+            NSData *data = [objcode generateObjCode:[[options objectForKey:XDTBuildOptionCompressObjectCode] boolValue] error:error];
+            if (nil != data) {
+                XDTBuildAddOutput(reply, data, @"");
+            }
+            break;
+        }
+        case XDTAs99TargetTypeEmbededXBasic: {
+            NSData *data = [objcode generateBasicLoader:error];
+            if (nil != data) {
+                XDTBuildAddOutput(reply, data, @"");
+            }
+            break;
+        }
+        case XDTAs99TargetTypeMESSCartridge: {
+            NSDictionary<NSString *, NSData *> *tripel = [objcode generateMESSCartridgeWithName:cartridgeName error:error];
+            for (NSString *fName in [[tripel allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+                XDTBuildAddOutput(reply, [tripel objectForKey:fName], fName);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    if (nil != *error) {
+        return NO;
+    }
+
+    if ([[options objectForKey:XDTBuildOptionListing] boolValue]) {
+        NSData *listing = [objcode generateListing:NO error:error];
+        if (nil == listing) {
+            return NO;
+        }
+        [reply addField:XDTBuildFieldListing data:listing];
+    }
+    return YES;
+}
+
+
+- (BOOL)assembleGPLSourceFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error
+{
+    NSDictionary<NSString *, id> *toolOptions = XDTBuildToolOptions(options);
+    NSURL *directoryURL = [fileURL URLByDeletingLastPathComponent];
+    NSArray *sessionKey = @[@"xga99", toolOptions, directoryURL];
+    XDTGPLAssembler *assembler = [_sessions objectForKey:sessionKey];
+    if (nil == assembler) {
+        assembler = [XDTGPLAssembler gplAssemblerWithOptions:toolOptions includeURL:directoryURL];
+        if (nil == assembler) {
+            *error = XDTBuildMissingSessionError();
+            return NO;
+        }
+        [_sessions setObject:assembler forKey:sessionKey];
+    }
+
+    XDTGa99Objcode *objcode = [assembler assembleSourceFile:fileURL error:error];
+    [reply addMessages:assembler.messages];
+    if (nil == objcode || nil != *error) {
+        return NO;
+    }
+    _readFiles = [objcode.sourceFiles copy];    /* only known for the native assembler */
+
+    NSString *cartridgeName = [options objectForKey:XDTBuildOptionCartridgeName];
+    if (nil == cartridgeName || 0 == [cartridgeName length]) {
+        cartridgeName = [[fileURL lastPathComponent] stringByDeletingPathExtension];
+    }
+    switch ([[toolOptions objectForKey:XDTGa99OptionTarget] unsignedIntegerValue]) {
+        case XDTGa99TargetTypePlainByteCode: {
+            NSArray<NSArray<id> *> *byteCode = [objcode generateByteCode:error];
+            for (NSArray<id> *element in byteCode) {
+                NSNumber *address = [element objectAtIndex:0];
+                NSNumber *base = [element objectAtIndex:1];
+                NSString *fileNameAddition = nil;
+                if ([base isMemberOfClass:[NSNull class]]) {
+                    fileNameAddition = [NSString stringWithFormat:@"_%04x", (unsigned int)[address longValue]];
+                } else {
+                    fileNameAddition = [NSString stringWithFormat:@"_%04x_b%d", (unsigned int)[address longValue], (int)[base longValue]];
+                }
+                XDTBuildAddOutput(reply, [element objectAtIndex:2], fileNameAddition);
+            }
+            break;
+        }
+        case XDTGa99TargetTypeHeaderedByteCode: {
+            NSData *data = [objcode generateImageWithName:cartridgeName error:error];
+            if (nil != data) {
+                XDTBuildAddOutput(reply, data, @"");
+            }
+            break;
+        }
+        case XDTGa99TargetTypeMESSCartridge: {
+            NSDictionary<NSString *, NSData *> *tripel = [objcode generateMESSCartridgeWithName:cartridgeName error:error];
+            for (NSString *fName in [[tripel allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+                XDTBuildAddOutput(reply, [tripel objectForKey:fName], fName);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    if (nil != *error) {
+        return NO;
+    }
+
+    if ([[options objectForKey:XDTBuildOptionListing] boolValue]) {
+        NSData *listing = [objcode generateListing:NO error:error];
+        if (nil == listing) {
+            return NO;
+        }
+        [reply addField:XDTBuildFieldListing data:listing];
+    }
+    return YES;
+}
+
+
+- (BOOL)parseBasicSourceFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error
+{
+    NSString *sourceCode = [NSString stringWithContentsOfURL:fileURL encoding:NSUTF8StringEncoding error:error];
+    if (nil == sourceCode) {
+        return NO;
+    }
+    _readFiles = [@[fileURL] copy];
+    XDTBasic *basic = [XDTBasic basicWithOptions:options];
+    if (nil == basic) {
+        *error = XDTBuildMissingSessionError();
+        return NO;
+    }
+
+    const BOOL isParsed = [basic parseSourceCode:sourceCode error:error];
+    [reply addMessages:basic.messages];
+    if (!isParsed) {
+        return NO;
+    }
+
+    NSData *data = nil;
+    switch (basic.targetType) {
+        case XDTBasicTargetTypeInternalFormat:
+            data = [basic getImageUsingLongFormat:NO error:error];
+            break;
+        case XDTBasicTargetTypeLongFormat:
+            data = [basic getImageUsingLongFormat:YES error:error];
+            break;
+
+        default:
+            *error = [NSError errorWithDomain:XDTErrorDomain code:XDTErrorCodeToolException
+                                     userInfo:@{NSLocalizedDescriptionKey: NSLocalizedString(@"Operation not supported", @"Description for an error, when a BASIC program is requested in a format xbas99 cannot create.")}];
+            break;
+    }
+    if (nil == data) {
+        return NO;
+    }
+    XDTBuildAddOutput(reply, data, @"");
+    return YES;
+}
+
+
+- (BOOL)loadBasicProgramFile:(NSURL *)fileURL options:(NSDictionary<NSString *, id> *)options reply:(XDTBuildMessage *)reply error:(NSError **)error
+{
+    NSData *data = [NSData dataWithContentsOfURL:fileURL options:0 error:error];
+    if (nil == data) {
+        return NO;
+    }
+    _readFiles = [@[fileURL] copy];
+    XDTBasic *basic = [XDTBasic basicWithOptions:options];
+    if (nil == basic) {
+        *error = XDTBuildMissingSessionError();
+        return NO;
+    }
+
+    /* The format of the program is given by the file extension, like the sample IDE does it */
+    NSString *fileExtension = [fileURL pathExtension];
+    BOOL isLoaded = NO;
+    if ([@"iv254" isEqualToString:fileExtension]) {
+        isLoaded = [basic loadLongData:data error:error];
+    } else if ([@"dv163" isEqualToString:fileExtension]) {
+        isLoaded = [basic loadMergedData:data error:error];
+    } else {
+        isLoaded = [basic loadProgramData:data error:error];
+    }
+    [reply addMessages:basic.messages];
+    if (!isLoaded || nil != *error) {
+        return NO;
+    }
+
+    NSString *sourceCode = [basic getSource:error];
+    if (nil == sourceCode) {
+        return NO;
+    }
+    XDTBuildAddOutput(reply, [sourceCode dataUsingEncoding:NSUTF8StringEncoding], @"");
+    return YES;
+}
+
+@end
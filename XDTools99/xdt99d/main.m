@@ -0,0 +1,154 @@
+//
+//  main.m
+//  xdt99d
+//
+//  Created by Henrik Wedekind on 19.10.26.
+//
+//  XDTools99.framework a collection of Objective-C wrapper for xdt99
+//  Copyright © 2026 Henrik Wedekind (aka hackmac). All rights reserved.
+//
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU Lesser General Public License as
+//  published by the Free Software Foundation; either version 2.1 of the
+//  License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this program; if not, see <http://www.gnu.org/licenses/>
+//
+
+
+#import <Foundation/Foundation.h>
+
+#import <XDTools99/XDTools99.h>
+
+#import "XDTBuildServer.h"
+
+#include <getopt.h>
+#include <signal.h>
+
+
+#define XDTBuildServerDefaultCacheLimit (64 * 1024 * 1024)
+
+
+static void usage(const char *toolName)
+{
+    fprintf(stderr, "usage: %s [-s socket] [-c bytes] [-m modules] [-V version=modules ...]\n"
+            "  -s socket   path of the Unix domain socket to listen on (default: %s)\n"
+            "  -c bytes    maximum size of all cached results (default: %d)\n"
+            "  -m modules  directory or bundle of the xdt99 Python modules (default: the modules of the framework)\n"
+            "  -V version=modules\n"
+            "              directory or bundle of another version of xdt99, chosen by the module version option of a request\n"
+            "Sending SIGHUP reloads all modules and drops the sessions and cached results.\n",
+            toolName, [[XDTBuildClient defaultSocketPath] fileSystemRepresentation], XDTBuildServerDefaultCacheLimit);
+}
+
+
+int main(int argc, char * const argv[])
+{
+    @autoreleasepool {
+        NSString *socketPath = [XDTBuildClient defaultSocketPath];
+        NSString *modulePath = nil;
+        NSUInteger cacheLimit = XDTBuildServerDefaultCacheLimit;
+        NSMutableDictionary<NSString *, NSString *> *versionPathes = [NSMutableDictionary dictionary];
+
+        int option;
+        while (-1 != (option = getopt(argc, argv, "c:m:s:V:h"))) {
+            switch (option) {
+                case 'c':
+                    cacheLimit = (NSUInteger)strtoul(optarg, NULL, 10);
+                    break;
+                case 'm':
+                    modulePath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 's':
+                    socketPath = [[NSFileManager defaultManager] stringWithFileSystemRepresentation:optarg length:strlen(optarg)];
+                    break;
+                case 'V': {
+                    const char *separator = strchr(optarg, '=');
+                    if (NULL == separator || optarg == separator || '\0' == separator[1]) {
+                        usage(argv[0]);
+                        return EXIT_FAILURE;
+                    }
+                    NSString *version = [[NSString alloc] initWithBytes:optarg length:separator - optarg encoding:NSUTF8StringEncoding];
+                    [versionPathes setObject:[[NSFileManager defaultManager] stringWithFileSystemRepresentation:separator + 1 length:strlen(separator + 1)] forKey:version];
+#if !__has_feature(objc_arc)
+                    [version release];
+#endif
+                    break;
+                }
+
+                default:
+                    usage(argv[0]);
+                    return EXIT_FAILURE;
+            }
+        }
+        if (optind < argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        /* Python is started here, before the first client connects, so even the first request is served warm */
+        if (nil != modulePath) {
+            [XDTObject reinitializeWithXDTModulePath:[modulePath stringByStandardizingPath]];
+        }
+        if (![XDTAssembler checkRequiredModuleVersion] || ![XDTGPLAssembler checkRequiredModuleVersion] || ![XDTBasic checkRequiredModuleVersion]) {
+            fprintf(stderr, "%s: the xdt99 modules do not match the versions required by the framework\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        NSError *error = nil;
+        for (NSString *version in versionPathes) {
+            NSString *versionPath = [[versionPathes objectForKey:version] stringByStandardizingPath];
+            if (![XDTObject registerXDTModulePath:versionPath forVersion:version error:&error]) {
+                fprintf(stderr, "%s: %s: %s\n", argv[0], [versionPath fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+                return EXIT_FAILURE;
+            }
+        }
+        XDTBuildServer *server = [XDTBuildServer buildServerWithSocketPath:[socketPath stringByStandardizingPath] resultCacheLimit:cacheLimit error:&error];
+        if (nil == server) {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], [socketPath fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+            return EXIT_FAILURE;
+        }
+
+        /* Terminating removes the socket file, so the next server does not have to find out that it is stale */
+        signal(SIGPIPE, SIG_IGN);
+        NSMutableArray *signalSources = [NSMutableArray arrayWithCapacity:3];
+        for (NSNumber *signalNumber in @[@SIGINT, @SIGTERM]) {
+            signal([signalNumber intValue], SIG_IGN);
+            dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_SIGNAL, [signalNumber unsignedLongValue], 0, dispatch_get_main_queue());
+            dispatch_source_set_event_handler(source, ^{
+                [server invalidate];
+                exit(EXIT_SUCCESS);
+            });
+            dispatch_resume(source);
+            [signalSources addObject:source];
+#if !__has_feature(objc_arc)
+            dispatch_release(source);
+#endif
+        }
+
+        /* Changed xdt99 sources are used without restarting the server and its Python */
+        signal(SIGHUP, SIG_IGN);
+        dispatch_source_t reloadSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_SIGNAL, SIGHUP, 0, dispatch_get_main_queue());
+        dispatch_source_set_event_handler(reloadSource, ^{
+            NSError *reloadError = nil;
+            if (![server reloadModules:&reloadError]) {
+                fprintf(stderr, "%s: reloading the xdt99 modules failed: %s\n", argv[0], [[reloadError localizedDescription] UTF8String]);
+            }
+        });
+        dispatch_resume(reloadSource);
+        [signalSources addObject:reloadSource];
+#if !__has_feature(objc_arc)
+        dispatch_release(reloadSource);
+#endif
+
+        /* Never returns, so the server and the signal sources stay alive */
+        dispatch_main();
+    }
+}